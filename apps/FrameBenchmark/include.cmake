@@ -0,0 +1 @@
+set(DEFAULT_APPLICATION OFF)
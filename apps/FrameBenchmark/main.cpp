@@ -0,0 +1,323 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/engine/configuration.h>
+#include <openspace/engine/globals.h>
+#include <openspace/engine/openspaceengine.h>
+#include <openspace/engine/windowdelegate.h>
+#include <ghoul/ghoul.h>
+#include <ghoul/cmdparser/commandlineparser.h>
+#include <ghoul/cmdparser/singlecommand.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/logging/logmanager.h>
+#include <json/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+//
+// This application drives the OpenSpace engine without a window or an OpenGL context to
+// measure the CPU cost of the update side of the frame loop (scene graph, navigation,
+// time, scripts, etc). The profile is loaded in the first frame and the engine is then
+// stepped with a fixed delta time for a number of frames. For each phase of the frame,
+// the timing distribution is written as JSON either to the console or to a file.
+//
+// Renderables are never initialized for OpenGL in this mode, which means that they are
+// not updated either; all transformations of the scene graph nodes are updated however.
+//
+
+namespace {
+    constexpr const char* _loggerCat = "FrameBenchmark";
+
+    constexpr const int DefaultNumberOfFrames = 1000;
+    constexpr const int DefaultNumberOfWarmupFrames = 60;
+    constexpr const double DefaultDeltaTime = 1.0 / 60.0;
+
+    // The state that the stub window delegate reports back to the engine. The window
+    // delegate consists of function pointers, so this has to live in global scope
+    struct {
+        double deltaTime = DefaultDeltaTime;
+        uint64_t frameNumber = 0;
+        bool shouldTerminate = false;
+    } windowState;
+
+    // Size of the imaginary window, used for example for the aspect ratio of the camera
+    const glm::ivec2 WindowSize = glm::ivec2(1920, 1080);
+
+    void setHeadlessWindowDelegate(openspace::WindowDelegate& delegate) {
+        delegate.terminate = []() { windowState.shouldTerminate = true; };
+        delegate.deltaTime = []() { return windowState.deltaTime; };
+        delegate.averageDeltaTime = []() { return windowState.deltaTime; };
+        delegate.minDeltaTime = []() { return windowState.deltaTime; };
+        delegate.maxDeltaTime = []() { return windowState.deltaTime; };
+        delegate.deltaTimeStandardDeviation = []() { return 0.0; };
+        delegate.applicationTime = []() {
+            return static_cast<double>(windowState.frameNumber) * windowState.deltaTime;
+        };
+        delegate.currentWindowSize = []() { return WindowSize; };
+        delegate.currentSubwindowSize = []() { return WindowSize; };
+        delegate.currentDrawBufferResolution = []() { return WindowSize; };
+        delegate.currentViewportSize = []() { return WindowSize; };
+        delegate.isMaster = []() { return true; };
+        delegate.isHeadless = []() { return true; };
+        delegate.nWindows = []() { return 1; };
+        delegate.swapGroupFrameNumber = []() { return windowState.frameNumber; };
+    }
+
+    struct Phase {
+        std::string name;
+        std::vector<double> timings; // in milliseconds
+    };
+
+    template <typename Func>
+    double measure(Func&& func) {
+        using namespace std::chrono;
+        const high_resolution_clock::time_point t0 = high_resolution_clock::now();
+        func();
+        const high_resolution_clock::time_point t1 = high_resolution_clock::now();
+        return duration_cast<duration<double, std::milli>>(t1 - t0).count();
+    }
+
+    // Nearest-rank percentile of an already sorted list of values
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const double rank = std::ceil(p / 100.0 * static_cast<double>(sorted.size()));
+        const size_t index = std::clamp<size_t>(
+            static_cast<size_t>(rank),
+            1,
+            sorted.size()
+        );
+        return sorted[index - 1];
+    }
+
+    nlohmann::json statistics(std::vector<double> timings) {
+        std::sort(timings.begin(), timings.end());
+
+        nlohmann::json res;
+        res["mean"] = timings.empty() ?
+            0.0 :
+            std::accumulate(timings.begin(), timings.end(), 0.0) / timings.size();
+        res["min"] = timings.empty() ? 0.0 : timings.front();
+        res["p50"] = percentile(timings, 50.0);
+        res["p90"] = percentile(timings, 90.0);
+        res["p95"] = percentile(timings, 95.0);
+        res["p99"] = percentile(timings, 99.0);
+        res["max"] = timings.empty() ? 0.0 : timings.back();
+        return res;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace openspace;
+
+    ghoul::logging::LogManager::initialize(
+        ghoul::logging::LogLevel::Info,
+        ghoul::logging::LogManager::ImmediateFlush::Yes
+    );
+    ghoul::initialize();
+    global::create();
+
+    ghoul::cmdparser::CommandlineParser commandlineParser(
+        "OpenSpace FrameBenchmark",
+        ghoul::cmdparser::CommandlineParser::AllowUnknownCommands::Yes
+    );
+
+    std::string profile;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<std::string>>(
+            profile,
+            "--profile",
+            "-p",
+            "The profile that is loaded. If no profile is provided, the profile from the "
+            "configuration file is used"
+        )
+    );
+
+    int nFrames = DefaultNumberOfFrames;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<int>>(
+            nFrames,
+            "--frames",
+            "-n",
+            "The number of frames that are measured"
+        )
+    );
+
+    int nWarmupFrames = DefaultNumberOfWarmupFrames;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<int>>(
+            nWarmupFrames,
+            "--warmup",
+            "-w",
+            "The number of frames after loading the profile that are not measured"
+        )
+    );
+
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<double>>(
+            windowState.deltaTime,
+            "--deltatime",
+            "-d",
+            "The fixed delta time in seconds that is reported for each frame"
+        )
+    );
+
+    std::string outputPath;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<std::string>>(
+            outputPath,
+            "--output",
+            "-o",
+            "The file to which the results are written. If no file is provided, the "
+            "results are printed to the console"
+        )
+    );
+
+    commandlineParser.setCommandLine({ argv, argv + argc });
+    commandlineParser.execute();
+
+    // Register the path of the executable,
+    // to make it possible to find other files in the same directory.
+    FileSys.registerPathToken(
+        "${BIN}",
+        std::filesystem::path(argv[0]).parent_path(),
+        ghoul::filesystem::FileSystem::Override::Yes
+    );
+
+    std::filesystem::path configFile = configuration::findConfiguration();
+
+    // Register the base path as the directory where the configuration file lives
+    std::filesystem::path base = configFile.parent_path();
+    constexpr const char* BasePathToken = "${BASE}";
+    FileSys.registerPathToken(BasePathToken, base);
+
+    *global::configuration = configuration::loadConfigurationFromFile(
+        configFile.string(),
+        ""
+    );
+    if (!profile.empty()) {
+        global::configuration->profile = profile;
+    }
+    if (global::configuration->profile.empty()) {
+        LFATAL("Cannot run the benchmark with an empty profile");
+        global::destroy();
+        ghoul::deinitialize();
+        return EXIT_FAILURE;
+    }
+
+    setHeadlessWindowDelegate(*global::windowDelegate);
+
+    global::openSpaceEngine->registerPathTokens();
+    global::openSpaceEngine->initialize();
+
+    std::vector<Phase> phases = {
+        { "preSynchronization", {} },
+        { "postSynchronizationPreDraw", {} },
+        { "postDraw", {} },
+        { "frame", {} }
+    };
+    for (Phase& phase : phases) {
+        phase.timings.reserve(nFrames);
+    }
+
+    // The first frame is special as the profile is loaded as part of it
+    LINFO(fmt::format("Loading profile '{}'", global::configuration->profile));
+    const double loadTime = measure([]() {
+        global::openSpaceEngine->preSynchronization();
+        global::openSpaceEngine->postSynchronizationPreDraw();
+        global::openSpaceEngine->postDraw();
+    });
+    windowState.frameNumber++;
+
+    LINFO(fmt::format(
+        "Running {} warmup frames and {} measured frames", nWarmupFrames, nFrames
+    ));
+    for (int i = 0; i < nWarmupFrames + nFrames; ++i) {
+        if (windowState.shouldTerminate) {
+            LERROR(fmt::format("Engine requested termination in frame {}", i));
+            break;
+        }
+
+        const double preSync = measure([]() {
+            global::openSpaceEngine->preSynchronization();
+        });
+        const double postSync = measure([]() {
+            global::openSpaceEngine->postSynchronizationPreDraw();
+        });
+        const double postDraw = measure([]() {
+            global::openSpaceEngine->postDraw();
+        });
+        windowState.frameNumber++;
+
+        if (i >= nWarmupFrames) {
+            phases[0].timings.push_back(preSync);
+            phases[1].timings.push_back(postSync);
+            phases[2].timings.push_back(postDraw);
+            phases[3].timings.push_back(preSync + postSync + postDraw);
+        }
+    }
+
+    nlohmann::json result;
+    result["profile"] = global::configuration->profile;
+    result["frames"] = phases[0].timings.size();
+    result["warmupFrames"] = nWarmupFrames;
+    result["deltaTime"] = windowState.deltaTime;
+    result["unit"] = "ms";
+    result["loadTime"] = loadTime;
+    for (const Phase& phase : phases) {
+        result["phases"][phase.name] = statistics(phase.timings);
+    }
+
+    int exitCode = windowState.shouldTerminate ? EXIT_FAILURE : EXIT_SUCCESS;
+    if (outputPath.empty()) {
+        std::cout << result.dump(2) << std::endl;
+    }
+    else {
+        std::ofstream file(outputPath);
+        if (file.good()) {
+            file << result.dump(2) << std::endl;
+            LINFO(fmt::format("Results written to '{}'", outputPath));
+        }
+        else {
+            LERROR(fmt::format("Could not open file '{}' for writing", outputPath));
+            exitCode = EXIT_FAILURE;
+        }
+    }
+
+    // No OpenGL resources were created, so there is nothing to deinitialize for them
+    global::openSpaceEngine->deinitialize();
+    global::destroy();
+    ghoul::deinitialize();
+
+    return exitCode;
+}
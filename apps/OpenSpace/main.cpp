@@ -671,10 +671,12 @@ std::vector<std::byte> mainEncodeFun() {
     ZoneScoped
     LTRACE("main::mainEncodeFun(begin)");
 
-    std::vector<std::byte> data = global::openSpaceEngine->encode();
+    // SGCT takes ownership of the frame, so this is the only place where it is copied
+    const SyncBuffer::View data = global::openSpaceEngine->encode();
+    std::vector<std::byte> res(data.data, data.data + data.size);
 
     LTRACE("main::mainEncodeFun(end)");
-    return data;
+    return res;
 }
 
 
@@ -683,7 +685,7 @@ void mainDecodeFun(const std::vector<std::byte>& data, unsigned int) {
     ZoneScoped
     LTRACE("main::mainDecodeFun(begin)");
 
-    global::openSpaceEngine->decode(data);
+    global::openSpaceEngine->decode({ data.data(), data.size() });
 
     LTRACE("main::mainDecodeFun(end)");
 }
@@ -27,6 +27,7 @@
 #include <ghoul/cmdparser/commandlineparser.h>
 #include <ghoul/cmdparser/singlecommand.h>
 #include <ghoul/logging/logmanager.h>
+#include <cstdlib>
 #include <iomanip>
 
 namespace {
@@ -117,7 +118,14 @@ int main(int argc, char** argv) {
     }
 
     ParallelServer server;
-    server.start(port, settings.password, settings.changeHostPassword);
+    const bool success = server.start(
+        port,
+        settings.password,
+        settings.changeHostPassword
+    );
+    if (!success) {
+        return EXIT_FAILURE;
+    }
     server.setDefaultHostAddress("127.0.0.1");
     LINFO(fmt::format("Server listening to port {}", port));
 
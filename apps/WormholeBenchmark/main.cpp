@@ -0,0 +1,582 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/network/messagestructures.h>
+#include <openspace/network/nativesocket.h>
+#include <openspace/network/parallelconnection.h>
+#include <openspace/network/parallelserver.h>
+#include <ghoul/fmt.h>
+#include <ghoul/glm.h>
+#include <ghoul/cmdparser/commandlineparser.h>
+#include <ghoul/cmdparser/singlecommand.h>
+#include <ghoul/logging/logmanager.h>
+#include <json/json.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// This application measures how the ParallelServer fans out messages to many peers. It
+// simulates a host and a number of peers on localhost that speak the same protocol as
+// the ParallelPeer. The host sends camera keyframes at a fixed rate and a script once a
+// second, and each peer measures the time between the sending of a camera keyframe and
+// its arrival. Some of the peers are slow and read only a small amount of data a few
+// times a second; they show whether a slow peer delays the others and whether the
+// superseding of camera keyframes allows them to keep up. Scripts must never be lost.
+//
+// All peers are handled on a single thread, so the measured latencies include the time
+// it takes this application to get to the peer. By default a server is started in the
+// same process, but an external server can be tested by providing its address.
+//
+
+namespace {
+    constexpr const char* _loggerCat = "WormholeBenchmark";
+
+    constexpr const int DefaultPort = 25002;
+    constexpr const int DefaultNumberOfPeers = 100;
+    constexpr const int DefaultNumberOfSlowPeers = 5;
+    constexpr const double DefaultDuration = 10.0;
+    constexpr const double DefaultKeyframeRate = 60.0;
+    constexpr const char* DefaultPassword = "benchmark";
+
+    // Slow peers read at most SlowReadSize bytes every SlowReadInterval seconds, which
+    // is less than the camera keyframes of the host require
+    constexpr const size_t SlowReadSize = 1024;
+    constexpr const double SlowReadInterval = 0.25;
+
+    // The time after the host stops sending during which the peers receive the
+    // remaining messages
+    constexpr const double DrainTime = 2.0;
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point StartTime = Clock::now();
+
+    double now() {
+        return std::chrono::duration<double>(Clock::now() - StartTime).count();
+    }
+
+    struct SimulatedPeer {
+        std::string name;
+        openspace::NativeSocket socket;
+        bool isSlow = false;
+        bool isLost = false;
+        openspace::ParallelConnection::Status status =
+            openspace::ParallelConnection::Status::Connecting;
+
+        std::vector<char> buffer;
+        double nextRead = 0.0;
+        size_t nKeyframes = 0;
+        size_t nScripts = 0;
+        std::vector<double> latencies; // in milliseconds
+    };
+
+    // Sends a message as a whole, waiting for the socket if necessary
+    bool send(SimulatedPeer& peer, openspace::ParallelConnection::MessageType type,
+              std::vector<char> content)
+    {
+        using namespace openspace;
+
+        const std::vector<char> data = ParallelConnection::encodeMessage(
+            ParallelConnection::Message(type, std::move(content))
+        );
+        size_t offset = 0;
+        while (offset < data.size()) {
+            const std::ptrdiff_t n = peer.socket.send(
+                data.data() + offset,
+                data.size() - offset
+            );
+            if (n < 0) {
+                peer.isLost = true;
+                return false;
+            }
+            if (n == 0) {
+                std::vector<NativeSocket::PollItem> item = {
+                    { &peer.socket, NativeSocket::Writable }
+                };
+                NativeSocket::poll(item, 10);
+            }
+            offset += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    template <typename T>
+    void append(std::vector<char>& buffer, const T& value) {
+        buffer.insert(
+            buffer.end(),
+            reinterpret_cast<const char*>(&value),
+            reinterpret_cast<const char*>(&value) + sizeof(T)
+        );
+    }
+
+    template <typename T>
+    T read(const char* data) {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    void handleMessage(SimulatedPeer& peer,
+                       openspace::ParallelConnection::MessageType type,
+                       const char* content, size_t size, double time)
+    {
+        using namespace openspace;
+        using namespace openspace::datamessagestructures;
+
+        if (type == ParallelConnection::MessageType::ConnectionStatus &&
+            size >= sizeof(uint32_t))
+        {
+            peer.status = static_cast<ParallelConnection::Status>(
+                read<uint32_t>(content)
+            );
+        }
+        else if (type == ParallelConnection::MessageType::Data &&
+                 size >= sizeof(uint32_t) + sizeof(double))
+        {
+            const Type dataType = static_cast<Type>(read<uint32_t>(content));
+            const double timestamp = read<double>(content + sizeof(uint32_t));
+            if (dataType == Type::CameraData) {
+                peer.nKeyframes++;
+                if (!peer.isSlow) {
+                    peer.latencies.push_back((time - timestamp) * 1000.0);
+                }
+            }
+            else if (dataType == Type::ScriptData) {
+                peer.nScripts++;
+            }
+        }
+    }
+
+    // Receives up to maxBytes bytes and handles all messages that are complete
+    void receive(SimulatedPeer& peer, size_t maxBytes) {
+        using namespace openspace;
+
+        static std::array<char, 64 * 1024> chunk;
+        size_t nReceived = 0;
+        while (nReceived < maxBytes) {
+            const std::ptrdiff_t n = peer.socket.receive(
+                chunk.data(),
+                std::min(chunk.size(), maxBytes - nReceived)
+            );
+            if (n < 0) {
+                peer.isLost = true;
+                break;
+            }
+            if (n == 0) {
+                break;
+            }
+            peer.buffer.insert(peer.buffer.end(), chunk.data(), chunk.data() + n);
+            nReceived += static_cast<size_t>(n);
+        }
+
+        const double time = now();
+        size_t offset = 0;
+        while (peer.buffer.size() - offset >= ParallelConnection::HeaderSize) {
+            const char* header = peer.buffer.data() + offset;
+            const uint32_t type = read<uint32_t>(header + 2 + sizeof(uint32_t));
+            const uint32_t size = read<uint32_t>(header + 2 + 2 * sizeof(uint32_t));
+            if (peer.buffer.size() - offset < ParallelConnection::HeaderSize + size) {
+                break;
+            }
+            handleMessage(
+                peer,
+                static_cast<ParallelConnection::MessageType>(type),
+                header + ParallelConnection::HeaderSize,
+                size,
+                time
+            );
+            offset += ParallelConnection::HeaderSize + size;
+        }
+        peer.buffer.erase(peer.buffer.begin(), peer.buffer.begin() + offset);
+    }
+
+    bool connect(SimulatedPeer& peer, const std::string& address, int port,
+                 const std::string& password)
+    {
+        using namespace openspace;
+
+        peer.socket = NativeSocket::connect(address, port);
+        if (!peer.socket.isValid()) {
+            return false;
+        }
+        if (peer.isSlow) {
+            peer.socket.setReceiveBufferSize(static_cast<int>(SlowReadSize));
+        }
+
+        std::vector<char> authentication;
+        append(authentication, static_cast<uint64_t>(std::hash<std::string>{}(password)));
+        append(authentication, static_cast<uint32_t>(peer.name.size()));
+        authentication.insert(authentication.end(), peer.name.begin(), peer.name.end());
+        return send(
+            peer,
+            ParallelConnection::MessageType::Authentication,
+            std::move(authentication)
+        );
+    }
+
+    // Handles the incoming messages of all peers until the predicate is fulfilled or
+    // the timeout in seconds has passed
+    template <typename Predicate>
+    bool waitFor(std::vector<std::unique_ptr<SimulatedPeer>>& peers, double timeout,
+                 Predicate predicate)
+    {
+        const double end = now() + timeout;
+        while (now() < end) {
+            for (std::unique_ptr<SimulatedPeer>& peer : peers) {
+                receive(*peer, std::numeric_limits<size_t>::max());
+            }
+            if (predicate()) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    // Nearest-rank percentile of an already sorted list of values
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const double rank = std::ceil(p / 100.0 * static_cast<double>(sorted.size()));
+        const size_t index = std::clamp<size_t>(
+            static_cast<size_t>(rank),
+            1,
+            sorted.size()
+        );
+        return sorted[index - 1];
+    }
+
+    nlohmann::json statistics(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+
+        nlohmann::json res;
+        res["mean"] = values.empty() ?
+            0.0 :
+            std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+        res["min"] = values.empty() ? 0.0 : values.front();
+        res["p50"] = percentile(values, 50.0);
+        res["p90"] = percentile(values, 90.0);
+        res["p99"] = percentile(values, 99.0);
+        res["max"] = values.empty() ? 0.0 : values.back();
+        return res;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace openspace;
+
+    ghoul::logging::LogManager::initialize(
+        ghoul::logging::LogLevel::Info,
+        ghoul::logging::LogManager::ImmediateFlush::Yes
+    );
+
+    ghoul::cmdparser::CommandlineParser commandlineParser(
+        "OpenSpace WormholeBenchmark",
+        ghoul::cmdparser::CommandlineParser::AllowUnknownCommands::Yes
+    );
+
+    std::string address;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<std::string>>(
+            address,
+            "--address",
+            "-a",
+            "The address of the server that is tested. If no address is provided, a "
+            "server is started in this process"
+        )
+    );
+
+    int port = DefaultPort;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<int>>(
+            port,
+            "--port",
+            "-p",
+            "The port of the server"
+        )
+    );
+
+    std::string password = DefaultPassword;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<std::string>>(
+            password,
+            "--password",
+            "-l",
+            "The password of the server, which is also used as the host password"
+        )
+    );
+
+    int nPeers = DefaultNumberOfPeers;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<int>>(
+            nPeers,
+            "--peers",
+            "-n",
+            "The number of simulated peers in addition to the host"
+        )
+    );
+
+    int nSlowPeers = DefaultNumberOfSlowPeers;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<int>>(
+            nSlowPeers,
+            "--slow",
+            "-s",
+            "The number of the simulated peers that only read slowly"
+        )
+    );
+
+    double duration = DefaultDuration;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<double>>(
+            duration,
+            "--duration",
+            "-d",
+            "The time in seconds during which the host sends messages"
+        )
+    );
+
+    double keyframeRate = DefaultKeyframeRate;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<double>>(
+            keyframeRate,
+            "--rate",
+            "-r",
+            "The number of camera keyframes that the host sends per second"
+        )
+    );
+
+    std::string outputPath;
+    commandlineParser.addCommand(
+        std::make_unique<ghoul::cmdparser::SingleCommand<std::string>>(
+            outputPath,
+            "--output",
+            "-o",
+            "The file to which the results are written. If no file is provided, the "
+            "results are printed to the console"
+        )
+    );
+
+    commandlineParser.setCommandLine({ argv, argv + argc });
+    commandlineParser.execute();
+
+    std::unique_ptr<ParallelServer> server;
+    if (address.empty()) {
+        address = "127.0.0.1";
+        server = std::make_unique<ParallelServer>();
+        if (!server->start(port, password, password)) {
+            return EXIT_FAILURE;
+        }
+        server->setDefaultHostAddress(address);
+    }
+
+    // Connect the host first and make sure it becomes the host even if the server has a
+    // different default host address
+    std::vector<std::unique_ptr<SimulatedPeer>> host;
+    host.push_back(std::make_unique<SimulatedPeer>());
+    host[0]->name = "Host";
+    if (!connect(*host[0], address, port, password)) {
+        LFATAL(fmt::format("Could not connect to {}:{}", address, port));
+        return EXIT_FAILURE;
+    }
+    std::vector<char> hostshipRequest;
+    append(hostshipRequest, static_cast<uint64_t>(std::hash<std::string>{}(password)));
+    send(*host[0], ParallelConnection::MessageType::HostshipRequest, hostshipRequest);
+    const bool isHost = waitFor(host, 5.0, [&]() {
+        return host[0]->status == ParallelConnection::Status::Host;
+    });
+    if (!isHost) {
+        LFATAL("Could not become the host of the session");
+        return EXIT_FAILURE;
+    }
+
+    LINFO(fmt::format("Connecting {} peers, {} of which are slow", nPeers, nSlowPeers));
+    std::vector<std::unique_ptr<SimulatedPeer>> peers;
+    for (int i = 0; i < nPeers; ++i) {
+        std::unique_ptr<SimulatedPeer> peer = std::make_unique<SimulatedPeer>();
+        peer->name = fmt::format("Peer {}", i);
+        peer->isSlow = i < nSlowPeers;
+        if (!connect(*peer, address, port, password)) {
+            LFATAL(fmt::format("Could not connect peer {}", i));
+            return EXIT_FAILURE;
+        }
+        peers.push_back(std::move(peer));
+    }
+    const bool areConnected = waitFor(peers, 10.0, [&]() {
+        return std::all_of(
+            peers.begin(),
+            peers.end(),
+            [](const std::unique_ptr<SimulatedPeer>& p) {
+                return p->status == ParallelConnection::Status::ClientWithHost;
+            }
+        );
+    });
+    if (!areConnected) {
+        LFATAL("Not all peers were accepted by the server");
+        return EXIT_FAILURE;
+    }
+    for (std::unique_ptr<SimulatedPeer>& peer : peers) {
+        peer->nKeyframes = 0;
+        peer->nScripts = 0;
+    }
+
+    LINFO(fmt::format(
+        "Sending {} camera keyframes per second for {} seconds", keyframeRate, duration
+    ));
+    datamessagestructures::CameraKeyframe keyframe;
+    keyframe._focusNode = "Earth";
+    size_t nKeyframesSent = 0;
+    size_t nScriptsSent = 0;
+    double nextKeyframe = now();
+    double nextScript = now();
+    const double stopSending = now() + duration;
+    const double end = stopSending + DrainTime;
+
+    std::vector<NativeSocket::PollItem> items;
+    std::vector<SimulatedPeer*> polledPeers;
+    while (now() < end) {
+        const double time = now();
+        if (time < stopSending && time >= nextKeyframe) {
+            std::vector<char> data;
+            append(data, static_cast<uint32_t>(datamessagestructures::Type::CameraData));
+            append(data, time);
+            keyframe._position = glm::dvec3(std::cos(time), std::sin(time), 0.0);
+            keyframe._timestamp = time;
+            keyframe.serialize(data);
+            send(*host[0], ParallelConnection::MessageType::Data, std::move(data));
+            nKeyframesSent++;
+            nextKeyframe += 1.0 / keyframeRate;
+        }
+        if (time < stopSending && time >= nextScript) {
+            std::vector<char> data;
+            append(data, static_cast<uint32_t>(datamessagestructures::Type::ScriptData));
+            append(data, time);
+            datamessagestructures::ScriptMessage script;
+            script._script = fmt::format("openspace.printInfo('{}')", nScriptsSent);
+            script.serialize(data);
+            send(*host[0], ParallelConnection::MessageType::Data, std::move(data));
+            nScriptsSent++;
+            nextScript += 1.0;
+        }
+
+        items.clear();
+        polledPeers.clear();
+        for (std::unique_ptr<SimulatedPeer>& peer : peers) {
+            if (!peer->isLost && peer->nextRead <= time) {
+                items.push_back({ &peer->socket, NativeSocket::Readable });
+                polledPeers.push_back(peer.get());
+            }
+        }
+        items.push_back({ &host[0]->socket, NativeSocket::Readable });
+        polledPeers.push_back(host[0].get());
+
+        const int timeout = static_cast<int>(
+            std::clamp((nextKeyframe - now()) * 1000.0, 0.0, 1.0)
+        );
+        if (NativeSocket::poll(items, timeout) <= 0) {
+            continue;
+        }
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (items[i].revents == 0) {
+                continue;
+            }
+            SimulatedPeer& peer = *polledPeers[i];
+            if (peer.isSlow) {
+                receive(peer, SlowReadSize);
+                peer.nextRead = now() + SlowReadInterval;
+            }
+            else {
+                receive(peer, std::numeric_limits<size_t>::max());
+            }
+        }
+    }
+
+    // Gather the results
+    std::vector<double> latencies;
+    std::vector<double> keyframesFast;
+    std::vector<double> keyframesSlow;
+    size_t nLostPeers = 0;
+    size_t nMissingScripts = 0;
+    for (const std::unique_ptr<SimulatedPeer>& peer : peers) {
+        if (peer->isLost) {
+            nLostPeers++;
+            continue;
+        }
+        latencies.insert(latencies.end(), peer->latencies.begin(), peer->latencies.end());
+        if (peer->isSlow) {
+            keyframesSlow.push_back(static_cast<double>(peer->nKeyframes));
+        }
+        else {
+            keyframesFast.push_back(static_cast<double>(peer->nKeyframes));
+            nMissingScripts += nScriptsSent - std::min(peer->nScripts, nScriptsSent);
+        }
+    }
+
+    nlohmann::json result;
+    result["peers"] = nPeers;
+    result["slowPeers"] = nSlowPeers;
+    result["duration"] = duration;
+    result["keyframesSent"] = nKeyframesSent;
+    result["scriptsSent"] = nScriptsSent;
+    result["lostPeers"] = nLostPeers;
+    result["missingScripts"] = nMissingScripts;
+    result["latency"] = statistics(latencies);
+    result["latency"]["unit"] = "ms";
+    result["keyframesReceived"]["fast"] = statistics(keyframesFast);
+    result["keyframesReceived"]["slow"] = statistics(keyframesSlow);
+    if (server) {
+        const ParallelServer::Statistics stats = server->statistics();
+        result["server"]["supersededKeyframes"] = stats.nSupersededKeyframes;
+        result["server"]["overflows"] = stats.nOverflows;
+        result["server"]["maxQueuedBytes"] = stats.maxQueuedBytes;
+        server->stop();
+    }
+
+    if (outputPath.empty()) {
+        std::cout << result.dump(2) << std::endl;
+    }
+    else {
+        std::ofstream file(outputPath);
+        if (!file.good()) {
+            LERROR(fmt::format("Could not open file '{}' for writing", outputPath));
+            return EXIT_FAILURE;
+        }
+        file << result.dump(2) << std::endl;
+        LINFO(fmt::format("Results written to '{}'", outputPath));
+    }
+
+    return (nLostPeers == 0 && nMissingScripts == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
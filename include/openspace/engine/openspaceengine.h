@@ -30,6 +30,7 @@
 #include <openspace/scene/profile.h>
 #include <openspace/util/keys.h>
 #include <openspace/util/mouse.h>
+#include <openspace/util/syncbuffer.h>
 #include <openspace/util/touch.h>
 #include <openspace/util/versionchecker.h>
 #include <ghoul/glm.h>
@@ -89,8 +90,8 @@ public:
     void touchUpdateCallback(TouchInput input);
     void touchExitCallback(TouchInput input);
     void handleDragDrop(const std::string& file);
-    std::vector<std::byte> encode();
-    void decode(std::vector<std::byte> data);
+    SyncBuffer::View encode();
+    void decode(SyncBuffer::View data);
 
     void toggleShutdownMode();
 
@@ -38,11 +38,28 @@ class Syncable;
 /**
  * Manages a collection of <code>Syncable</code>s and ensures they are synchronized
  * over SGCT nodes. Encoding/Decoding order is handles internally.
+ *
+ * Every frame starts with the number of Syncables and a bitmask with one bit per
+ * Syncable that is set if the Syncable is dirty and its data follows. Syncables that
+ * did not change since the last frame are thus skipped on all nodes.
  */
 class SyncEngine {
 public:
     BooleanType(IsMaster);
 
+    struct Statistics {
+        /// The number of bytes that were encoded or decoded in the last frame
+        size_t nBytes = 0;
+        /// The largest number of bytes that were encoded or decoded in any frame
+        size_t nBytesMax = 0;
+        /// The number of Syncables that were skipped in the last frame
+        size_t nSkipped = 0;
+        /// The time in seconds that the last encoding took
+        double encodeTime = 0.0;
+        /// The time in seconds that the last decoding took
+        double decodeTime = 0.0;
+    };
+
     /**
      * Creates a new SyncEngine which a buffer size of \p syncBufferSize
      * \pre syncBufferSize must be bigger than 0
@@ -50,16 +67,18 @@ public:
     SyncEngine(unsigned int syncBufferSize);
 
     /**
-     * Encodes all added Syncables in the injected <code>SyncBuffer</code>.
-     * This method is only called on the SGCT master node
+     * Encodes all added Syncables that are dirty in the injected <code>SyncBuffer</code>.
+     * This method is only called on the SGCT master node. The returned view points into
+     * the <code>SyncBuffer</code> and is valid until the next call to this method
      */
-    std::vector<std::byte> encodeSyncables();
+    SyncBuffer::View encodeSyncables();
 
     /**
-     * Decodes the <code>SyncBuffer</code> into the added Syncables.
+     * Decodes the \p data into the added Syncables. The data is read in place and is not
+     * referenced after this method returns.
      * This method is only called on the SGCT slave nodes
      */
-    void decodeSyncables(std::vector<std::byte> data);
+    void decodeSyncables(SyncBuffer::View data);
 
     /**
      * Invokes the presync method of all added Syncables
@@ -93,6 +112,11 @@ public:
     */
     void removeSyncables(const std::vector<Syncable*>& syncables);
 
+    /**
+     * Returns the size of and the time taken by the last encoded or decoded frame
+     */
+    const Statistics& statistics() const;
+
 private:
     /**
      * Vector of Syncables. The vectors ensures consistent encode/decode order
@@ -103,6 +127,13 @@ private:
      * Databuffer used in encoding/decoding
      */
     SyncBuffer _syncBuffer;
+
+    /**
+     * The bitmask of the Syncables that are present in the current frame
+     */
+    std::vector<uint8_t> _presence;
+
+    Statistics _statistics;
 };
 
 } // namespace openspace
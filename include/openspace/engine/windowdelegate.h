@@ -70,6 +70,10 @@ struct WindowDelegate {
 
     bool (*isMaster)() = []() { return true; };
 
+    // A headless window delegate has no OpenGL context, so the engine only performs the
+    // update steps of each frame and skips all OpenGL initialization and rendering
+    bool (*isHeadless)() = []() { return false; };
+
     glm::mat4 (*modelMatrix)() = []() { return glm::mat4(1.f); };
 
     void (*setNearFarClippingPlane)(float near, float far) = [](float, float) {};
@@ -26,11 +26,14 @@
 #define __OPENSPACE_CORE___SESSIONRECORDING___H__
 
 #include <openspace/interaction/externinteraction.h>
+#include <openspace/interaction/sessionrecordingindex.h>
+#include <openspace/interaction/sessionrecordingwriter.h>
 #include <openspace/navigation/keyframenavigator.h>
 #include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/scripting/lualibrary.h>
 #include <vector>
 #include <chrono>
+#include <sstream>
 
 namespace openspace::interaction {
 
@@ -232,6 +235,18 @@ public:
      */
     void setPlaybackPause(bool pause);
 
+    /**
+     * Moves the playback in progress to the provided point in the recording. Keyframes
+     * between the current position and the new position are not executed. For indexed
+     * recordings, the position is found with a binary search over the index, so the
+     * cost of seeking does not depend on the length of the recording.
+     *
+     * \param recordedTime the number of seconds since the start of the recording
+     *
+     * \return \c true if a playback is in progress and its position was changed
+     */
+    bool seekPlayback(double recordedTime);
+
     /**
      * Enables that rendered frames should be saved during playback
      * \param fps Number of frames per second.
@@ -406,21 +421,21 @@ public:
      * \param times reference to a timestamps structure which contains recorded times
      * \param kf reference to a camera keyframe which contains the camera details
      * \param kfBuffer a buffer temporarily used for preparing data to be written
-     * \param file an ofstream reference to the recording file being written-to
+     * \param file an ostream reference to the recording file being written-to
      */
     void saveCameraKeyframeBinary(Timestamps& times,
         datamessagestructures::CameraKeyframe& kf, unsigned char* kfBuffer,
-        std::ofstream& file);
+        std::ostream& file);
 
     /**
      * Writes a camera keyframe to an ascii format recording file using a CameraKeyframe
      *
      * \param times reference to a timestamps structure which contains recorded times
      * \param kf reference to a camera keyframe which contains the camera details
-     * \param file an ofstream reference to the recording file being written-to
+     * \param file an ostream reference to the recording file being written-to
      */
     void saveCameraKeyframeAscii(Timestamps& times,
-        datamessagestructures::CameraKeyframe& kf, std::ofstream& file);
+        datamessagestructures::CameraKeyframe& kf, std::ostream& file);
 
     /**
      * Writes a time keyframe to a binary format recording file using a TimeKeyframe
@@ -428,21 +443,21 @@ public:
      * \param times reference to a timestamps structure which contains recorded times
      * \param kf reference to a time keyframe which contains the time details
      * \param kfBuffer a buffer temporarily used for preparing data to be written
-     * \param file an ofstream reference to the recording file being written-to
+     * \param file an ostream reference to the recording file being written-to
      */
     void saveTimeKeyframeBinary(Timestamps& times,
         datamessagestructures::TimeKeyframe& kf, unsigned char* kfBuffer,
-        std::ofstream& file);
+        std::ostream& file);
 
     /**
      * Writes a time keyframe to an ascii format recording file using a TimeKeyframe
      *
      * \param times reference to a timestamps structure which contains recorded times
      * \param kf reference to a time keyframe which contains the time details
-     * \param file an ofstream reference to the recording file being written-to
+     * \param file an ostream reference to the recording file being written-to
      */
     void saveTimeKeyframeAscii(Timestamps& times,
-        datamessagestructures::TimeKeyframe& kf, std::ofstream& file);
+        datamessagestructures::TimeKeyframe& kf, std::ostream& file);
 
     /**
      * Writes a script keyframe to a binary format recording file using a ScriptMessage
@@ -450,21 +465,21 @@ public:
      * \param times reference to a timestamps structure which contains recorded times
      * \param sm reference to a ScriptMessage object which contains the script details
      * \param smBuffer a buffer temporarily used for preparing data to be written
-     * \param file an ofstream reference to the recording file being written-to
+     * \param file an ostream reference to the recording file being written-to
      */
     void saveScriptKeyframeBinary(Timestamps& times,
         datamessagestructures::ScriptMessage& sm, unsigned char* smBuffer,
-        std::ofstream& file);
+        std::ostream& file);
 
     /**
      * Writes a script keyframe to an ascii format recording file using a ScriptMessage
      *
      * \param times reference to a timestamps structure which contains recorded times
      * \param sm reference to a ScriptMessage which contains the script details
-     * \param file an ofstream reference to the recording file being written-to
+     * \param file an ostream reference to the recording file being written-to
      */
     void saveScriptKeyframeAscii(Timestamps& times,
-        datamessagestructures::ScriptMessage& sm, std::ofstream& file);
+        datamessagestructures::ScriptMessage& sm, std::ostream& file);
 
     /**
      * Since session recordings only record changes, the initial conditions aren't
@@ -522,9 +537,9 @@ public:
      * Saves a keyframe to an ascii recording file
      *
      * \param entry the ascii string version of the keyframe (any type)
-     * \param file ofstream object to write to
+     * \param file ostream object to write to
      */
-    static void saveKeyframeToFile(std::string entry, std::ofstream& file);
+    static void saveKeyframeToFile(std::string entry, std::ostream& file);
 
     /**
      * Checks if a specified recording file ends with a particular file extension
@@ -578,7 +593,8 @@ public:
 
     /*
      * Determines a filename for the conversion result based on the original filename
-     * and the file format version number.
+     * and the file format version number. The result is placed in the conversion
+     * directory (see #setConversionDirectory) or in the recordings folder by default.
      *
      * \param filename source filename to be converted
      *
@@ -586,6 +602,14 @@ public:
      */
     std::string determineConversionOutFilename(const std::string filename, DataMode mode);
 
+    /*
+     * Sets the directory into which the results of file format conversions are written.
+     * If the directory is empty, the recordings folder is used.
+     *
+     * \param directory the directory for conversion results
+     */
+    void setConversionDirectory(std::filesystem::path directory);
+
 protected:
     properties::BoolProperty _renderPlaybackInformation;
     properties::BoolProperty _ignoreRecordedScale;
@@ -601,6 +625,17 @@ protected:
         unsigned int idxIntoKeyframeTypeArray;
         Timestamps t3stamps;
     };
+    struct PlaybackKeyframe {
+        timelineEntry entry;
+        interaction::KeyframeNavigator::CameraPose camera;
+        std::string script;
+    };
+    /// A contiguous range of keyframes that was read from an indexed recording
+    struct PlaybackPage {
+        size_t first = 0;
+        std::vector<PlaybackKeyframe> keyframes;
+        uint64_t lastUsed = 0;
+    };
     ExternInteraction _externInteract;
     double _timestampRecordStarted = 0.0;
     Timestamps _timestamps3RecordStarted;
@@ -625,9 +660,9 @@ protected:
     bool findFirstCameraKeyframeInTimeline();
     Timestamps generateCurrentTimestamp3(double keyframeTime);
     static void saveStringToFile(const std::string& s, unsigned char* kfBuffer,
-        size_t& idx, std::ofstream& file);
+        size_t& idx, std::ostream& file);
     static void saveKeyframeToFileBinary(unsigned char* bufferSource, size_t size,
-        std::ofstream& file);
+        std::ostream& file);
 
     bool addKeyframe(Timestamps t3stamps,
         interaction::KeyframeNavigator::CameraPose keyframe, int lineNum);
@@ -654,21 +689,36 @@ protected:
         Timestamps& times, DataMode mode, std::ifstream& file,
         std::string& inLine, const int lineNum);
     void saveSingleKeyframeCamera(datamessagestructures::CameraKeyframe& kf,
-        Timestamps& times, DataMode mode, std::ofstream& file, unsigned char* buffer);
+        Timestamps& times, DataMode mode, std::ostream& file, unsigned char* buffer);
     bool readSingleKeyframeTime(datamessagestructures::TimeKeyframe& kf,
         Timestamps& times, DataMode mode, std::ifstream& file, std::string& inLine,
         const int lineNum);
     void saveSingleKeyframeTime(datamessagestructures::TimeKeyframe& kf,
-        Timestamps& times, DataMode mode, std::ofstream& file, unsigned char* buffer);
+        Timestamps& times, DataMode mode, std::ostream& file, unsigned char* buffer);
     bool readSingleKeyframeScript(datamessagestructures::ScriptMessage& kf,
         Timestamps& times, DataMode mode, std::ifstream& file, std::string& inLine,
         const int lineNum);
     void saveSingleKeyframeScript(datamessagestructures::ScriptMessage& kf,
-        Timestamps& times, DataMode mode, std::ofstream& file, unsigned char* buffer);
+        Timestamps& times, DataMode mode, std::ostream& file, unsigned char* buffer);
     void saveScriptKeyframeToPropertiesBaseline(std::string script);
+    void appendKeyframeToRecording(char type, const Timestamps& times);
     bool isPropertyAllowedForBaseline(const std::string& propString);
     unsigned int findIndexOfLastCameraKeyframeInTimeline();
-    bool doesTimelineEntryContainCamera(unsigned int index) const;
+    bool doesTimelineEntryContainCamera(unsigned int index);
+
+    // During playback, all access to the timeline and the keyframes goes through these
+    // functions. For indexed recordings, the keyframes are read from the file on demand
+    // instead of being stored in _timeline and the per-type keyframe vectors; in this
+    // case idxIntoKeyframeTypeArray is the ordinal of a keyframe among its type
+    size_t timelineSize() const;
+    unsigned int lastTimelineIndex() const;
+    size_t numKeyframes(RecordedType type) const;
+    timelineEntry timelineEntryAt(unsigned int index);
+    interaction::KeyframeNavigator::CameraPose cameraKeyframeAt(unsigned int index);
+    std::string scriptKeyframeAt(unsigned int index);
+    const PlaybackKeyframe* playbackKeyframe(unsigned int index);
+    bool loadPlaybackPage(size_t first, PlaybackPage& page);
+    unsigned int timelineIndexAtRecordedTime(double recordedTime);
     std::vector<std::pair<CallbackHandle, StateChangeCallback>> _stateChangeCallbacks;
     bool doesStartWithSubstring(const std::string& s, const std::string& matchSubstr);
     void trimCommandsFromScriptIfFound(std::string& script);
@@ -688,6 +738,7 @@ protected:
     virtual bool convertScript(std::stringstream& inStream, DataMode mode, int lineNum,
         std::string& inputLine, std::ofstream& outFile, unsigned char* buff);
     DataMode readModeFromHeader(std::string filename);
+    std::string readVersionFromHeader(const std::string& filename);
     void readPlaybackHeader_stream(std::stringstream& conversionInStream,
         std::string& version, DataMode& mode);
     void populateListofLoadedSceneGraphNodes();
@@ -712,9 +763,10 @@ protected:
     std::string _playbackFilename;
     std::ifstream _playbackFile;
     std::string _playbackLineParsing;
-    std::ofstream _recordFile;
+    std::unique_ptr<SessionRecordingWriter> _recordWriter;
+    std::filesystem::path _recordFilename;
+    std::ostringstream _recordKeyframe;
     int _playbackLineNum = 1;
-    int _recordingEntryNum = 1;
     KeyframeTimeRef _playbackTimeReferenceMode;
     datamessagestructures::CameraKeyframe _prevRecordedCameraKeyframe;
     bool _playbackActive_camera = false;
@@ -746,6 +798,11 @@ protected:
     std::vector<std::string> _keyframesScript;
     std::vector<timelineEntry> _timeline;
 
+    std::unique_ptr<SessionRecordingIndex> _playbackIndex;
+    std::vector<PlaybackPage> _playbackPages;
+    uint64_t _playbackPageAccess = 0;
+    bool _playbackStreamFailed = false;
+
     std::vector<std::string> _keyframesSavePropertiesBaseline_scripts;
     std::vector<timelineEntry> _keyframesSavePropertiesBaseline_timeline;
     std::vector<std::string> _propertyBaselinesSaved;
@@ -800,6 +857,7 @@ protected:
     int _nextCallbackHandle = 0;
 
     DataMode _conversionDataMode = DataMode::Binary;
+    std::filesystem::path _conversionDirectory;
     int _conversionLineNum = 1;
     const int _maximumRecursionDepth = 50;
 };
@@ -820,8 +878,8 @@ protected:
 // 4. Override TargetConvertVersion with the version # with the new changes. This
 //    is now the version that this legacy subclass converts up to.
 // 5. Override getLegacyConversionResult method so that it creates an instance of
-//    the new version subclass. This is how the current version looks back to the
-//    legacy version that preceded it.
+//    the new version subclass and passes on the conversion directory. This is how
+//    the current version looks back to the legacy version that preceded it.
 // 6. The convert method for frame types that changed will need to be changed
 //    (for example SessionRecording_legacy_0085::convertScript uses its own
 //    override of script keyframe for the conversion functionality).
@@ -0,0 +1,161 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#ifndef __OPENSPACE_CORE___SESSIONRECORDINGINDEX___H__
+#define __OPENSPACE_CORE___SESSIONRECORDINGINDEX___H__
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace openspace::interaction {
+
+/**
+ * Random access index over the keyframes of a session recording file. Each entry stores
+ * the three timestamps of a keyframe, its type, its ordinal within the keyframes of the
+ * same type, and the byte offset in the recording at which the keyframe starts. The
+ * entries are sorted by recording order and are kept on disk; only the trailer is read
+ * when the index is loaded, so loading takes constant time regardless of the length of
+ * the recording.
+ *
+ * The index is stored in the cache directory rather than in or next to the recording
+ * (see #cachePath), so that the recording files themselves are unchanged and stay
+ * readable by versions that do not know about the index. The index file consists of the
+ * packed entries followed by a fixed-size trailer that also identifies the version of
+ * the recording it was built for.
+ */
+class SessionRecordingIndex {
+public:
+    struct Entry {
+        double timeOs = 0.0;
+        double timeRec = 0.0;
+        double timeSim = 0.0;
+        /// Byte offset of the start of the keyframe in the recording file
+        uint64_t offset = 0;
+        /// Ordinal of this keyframe among all keyframes of the same type
+        uint32_t typeIndex = 0;
+        /// One of the binary keyframe header characters ('c', 't', or 's')
+        char type = 0;
+    };
+
+    /// The number of bytes a single entry occupies on disk
+    static constexpr const size_t EntrySize = 3 * sizeof(double) + sizeof(uint64_t) +
+        sizeof(uint32_t) + sizeof(char);
+
+    /// The number of bytes of the trailer that concludes an index
+    static constexpr const size_t TrailerSize = 2 * sizeof(uint64_t) + sizeof(int64_t) +
+        3 * sizeof(uint32_t) + 8;
+
+    /**
+     * Loads the index of the recording at \p recording from the cache directory. Only
+     * the trailer of the index is read. The index is only used if it was built for a
+     * recording with the same size and modification time as the current file.
+     *
+     * \param recording The path to the session recording file
+     * \return The index, or \c nullptr if the recording is not indexed
+     */
+    static std::unique_ptr<SessionRecordingIndex> load(
+        const std::filesystem::path& recording);
+
+    /**
+     * Scans the entire recording at \p recording and saves an index for it. This is used
+     * for recordings that were not indexed when they were written and is meant to be run
+     * once, in the background.
+     *
+     * \param recording The path to the session recording file
+     * \return \c true if the index was saved successfully
+     */
+    static bool build(const std::filesystem::path& recording);
+
+    /**
+     * Saves the \p entries as the index of the finished recording at \p recording. The
+     * file is written to a temporary location first and renamed afterwards so that a
+     * partially written index is never picked up.
+     *
+     * \return \c true if the index was saved successfully
+     */
+    static bool save(const std::filesystem::path& recording,
+        const std::vector<Entry>& entries);
+
+    /**
+     * Returns the path in the cache directory of the index that belongs to the recording
+     * at \p recording, or an empty path if there is no cache directory.
+     */
+    static std::filesystem::path cachePath(const std::filesystem::path& recording);
+
+    /**
+     * Returns the number of keyframes in the recording.
+     */
+    size_t size() const;
+
+    /**
+     * Returns the number of keyframes of the provided \p type, which is one of the binary
+     * keyframe header characters.
+     */
+    size_t numEntries(char type) const;
+
+    /**
+     * Returns the entry with index \p i, reading the block of entries containing it from
+     * disk if it is not already cached.
+     */
+    Entry entry(size_t i);
+
+    /**
+     * Reads \p count consecutive entries starting at \p first in a single operation.
+     */
+    std::vector<Entry> entries(size_t first, size_t count);
+
+    /**
+     * Returns the index of the first entry whose \p timestamp is not less than \p time,
+     * or #size if there is no such entry. This performs a binary search over the
+     * entries on disk and assumes that \p timestamp does not decrease throughout the
+     * recording.
+     */
+    size_t lowerBound(double time, double Entry::* timestamp);
+
+private:
+    SessionRecordingIndex() = default;
+
+    bool open(const std::filesystem::path& file, uint64_t fileSize,
+        uint64_t recordingSize, int64_t recordingTime);
+
+    static constexpr const size_t BlockSize = 256;
+
+    std::ifstream _file;
+    uint64_t _nEntries = 0;
+    uint32_t _nCamera = 0;
+    uint32_t _nTime = 0;
+    uint32_t _nScript = 0;
+
+    size_t _cachedBlock = std::numeric_limits<size_t>::max();
+    std::vector<Entry> _blockCache;
+};
+
+} // namespace openspace::interaction
+
+#endif // __OPENSPACE_CORE___SESSIONRECORDINGINDEX___H__
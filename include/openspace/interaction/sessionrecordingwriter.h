@@ -0,0 +1,169 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___SESSIONRECORDINGWRITER___H__
+#define __OPENSPACE_CORE___SESSIONRECORDINGWRITER___H__
+
+#include <openspace/interaction/sessionrecordingindex.h>
+#include <ghoul/misc/boolean.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace openspace::interaction {
+
+/**
+ * Writes the keyframes of a session recording to disk while the recording is in
+ * progress. The caller serializes each keyframe and appends it to an in-memory block.
+ * Once a block is full, it is written to a spool file next to the recording by a task on
+ * the IO threads of the global TaskScheduler, while the next block is filled. The number
+ * and the size of the blocks are fixed, so apart from the index entries (see
+ * SessionRecordingIndex) the memory used does not grow with the length of the recording.
+ *
+ * If the writing falls behind so far that no empty block is available, camera keyframes
+ * are dropped, since the camera path is interpolated between the remaining keyframes
+ * anyway. All other keyframes wait until a block has been written instead.
+ *
+ * The recording file itself is assembled in #finish, as the property baselines that
+ * precede all keyframes in the file are only known once the recording is stopped.
+ */
+class SessionRecordingWriter {
+public:
+    struct Stats {
+        /// The number of keyframes that were appended
+        uint64_t nKeyframes = 0;
+        /// The number of camera keyframes that were dropped as no block was available
+        uint64_t nDropped = 0;
+        /// The number of blocks that were written to the spool file
+        uint64_t nBlocksWritten = 0;
+        /// The number of full blocks that could not be exchanged for an empty one right
+        /// away, because all other blocks were still waiting to be written
+        uint64_t nBlocksLate = 0;
+        /// The number of bytes that were written to the spool file
+        uint64_t bytesWritten = 0;
+    };
+
+    static constexpr const size_t DefaultBlockSize = 256 * 1024;
+    static constexpr const size_t DefaultNumBlocks = 2;
+
+    /// The file extension of the spool file that holds the keyframes while recording
+    static constexpr const char* SpoolExtension = ".osrecspool";
+
+    /**
+     * Creates a writer for a new session recording at \p recording. Nothing is written to
+     * \p recording until #finish is called.
+     *
+     * \param recording The path of the session recording that is written
+     * \param blockSize The size of each of the in-memory blocks in bytes
+     * \param nBlocks The total number of in-memory blocks, which has to be at least 2
+     */
+    SessionRecordingWriter(std::filesystem::path recording,
+        size_t blockSize = DefaultBlockSize, size_t nBlocks = DefaultNumBlocks);
+
+    /**
+     * Waits for the blocks that are being written and removes the spool file. If #finish
+     * was not called before, the recording is discarded.
+     */
+    ~SessionRecordingWriter();
+
+    /**
+     * Returns whether the spool file could be created. If this is \c false, no
+     * keyframes can be recorded.
+     */
+    bool isOpen() const;
+
+    /**
+     * Appends a single serialized keyframe to the recording. The \p keyframe has to be
+     * in the format in which it ends up in the recording file.
+     *
+     * \param entry The index entry of the keyframe. Only the timestamps and the type are
+     *        used, the offset and the type index are determined by the writer
+     * \param keyframe The serialized keyframe
+     * \return \c false if the keyframe was dropped
+     */
+    bool append(SessionRecordingIndex::Entry entry, std::string_view keyframe);
+
+    /**
+     * Writes all remaining blocks and assembles the recording file from the \p prefix
+     * followed by all appended keyframes. The index of the recording is saved to the
+     * cache directory (see SessionRecordingIndex::save).
+     * The recording file is synced to disk before this function returns and the spool
+     * file is removed afterwards.
+     *
+     * \param prefix The data preceding the keyframes in the file, which is the file
+     *        header and the property baselines
+     * \param prefixEntries The index entries of the keyframes contained in \p prefix,
+     *        with offsets relative to the start of the file
+     * \return \c true if the recording was written successfully
+     */
+    bool finish(std::string_view prefix,
+        std::vector<SessionRecordingIndex::Entry> prefixEntries);
+
+    /**
+     * Returns statistics about the keyframes and blocks written so far. This function
+     * must be called from the same thread that appends the keyframes.
+     */
+    Stats stats() const;
+
+private:
+    bool submitCurrentBlock(bool canWait);
+    void startWriting();
+    void stopWriting();
+    void closeSpool();
+    void writeBlocks();
+
+    const std::filesystem::path _recording;
+    std::filesystem::path _spoolPath;
+    std::FILE* _spool = nullptr;
+    const size_t _blockSize;
+
+    // Only accessed by the thread that appends the keyframes
+    std::vector<char> _currentBlock;
+    std::vector<SessionRecordingIndex::Entry> _entries;
+    uint64_t _dataSize = 0;
+    uint64_t _nKeyframes = 0;
+    uint64_t _nDropped = 0;
+    bool _isStopped = true;
+
+    // Shared with the task that writes the blocks
+    mutable std::mutex _mutex;
+    std::condition_variable _hasFreeBlock;
+    std::condition_variable _isIdle;
+    std::deque<std::vector<char>> _fullBlocks;
+    std::vector<std::vector<char>> _freeBlocks;
+    bool _isWriting = false;
+    bool _hasError = false;
+    uint64_t _nBlocksWritten = 0;
+    uint64_t _nBlocksLate = 0;
+    uint64_t _bytesWritten = 0;
+};
+
+} // namespace openspace::interaction
+
+#endif // __OPENSPACE_CORE___SESSIONRECORDINGWRITER___H__
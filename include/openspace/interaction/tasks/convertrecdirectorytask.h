@@ -0,0 +1,61 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___CONVERTRECDIRECTORYTASK___H__
+#define __OPENSPACE_CORE___CONVERTRECDIRECTORYTASK___H__
+
+#include <openspace/util/task.h>
+
+#include <filesystem>
+#include <string>
+
+namespace openspace::interaction {
+
+/**
+ * Converts all session recordings in a directory tree to the current file format version
+ * in binary format and saves their indices to the cache. The recordings are converted
+ * in parallel on the IO threads of the global TaskScheduler. Every keyframe of a
+ * recording is parsed and thereby validated before it is written, and recordings of
+ * older versions are first upgraded through the same legacy converters that are used
+ * when such a recording is played back. The output mirrors the directory structure of
+ * the input, and a summary with the result and the time taken for each recording is
+ * logged and optionally written to a CSV file.
+ */
+class ConvertRecDirectoryTask : public Task {
+public:
+    ConvertRecDirectoryTask(const ghoul::Dictionary& dictionary);
+    std::string description() override;
+    void perform(const Task::ProgressCallback& progressCallback) override;
+    static documentation::Documentation documentation();
+
+private:
+    std::filesystem::path _inDirectory;
+    std::filesystem::path _outDirectory;
+    std::filesystem::path _summaryFile;
+    bool _overwrite = false;
+};
+
+} // namespace openspace::interaction
+
+#endif // __OPENSPACE_CORE___CONVERTRECDIRECTORYTASK___H__
@@ -0,0 +1,139 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___NATIVESOCKET___H__
+#define __OPENSPACE_CORE___NATIVESOCKET___H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * A thin wrapper around a non-blocking TCP socket of the operating system. It is meant
+ * for servers that multiplex many connections on a single thread using #poll. Unlike
+ * the ghoul sockets, it does not start any threads and does not buffer any data, which
+ * leaves the buffering and flow control to the user.
+ */
+class NativeSocket {
+public:
+    /// The type of the native socket handle, a SOCKET on Windows and a file descriptor
+    /// on all other platforms
+    using Handle = std::uintptr_t;
+    static constexpr Handle InvalidHandle = ~Handle(0);
+
+    /// Flags for the events that are waited for and that occurred in a call to #poll
+    enum Event {
+        Readable = 1 << 0,
+        Writable = 1 << 1,
+        Error = 1 << 2
+    };
+
+    struct PollItem {
+        NativeSocket* socket = nullptr;
+        /// The events that are waited for
+        int events = 0;
+        /// The events that occurred
+        int revents = 0;
+    };
+
+    /**
+     * Creates a socket that listens for incoming connections on all IPv4 interfaces.
+     *
+     * \param port The port to listen on
+     * \return The listening socket, which is invalid if the port could not be bound
+     */
+    static NativeSocket listen(int port);
+
+    /**
+     * Connects to a server and makes the socket non-blocking once the connection has
+     * been established.
+     *
+     * \param address The IPv4 address of the server
+     * \param port The port of the server
+     * \return The connected socket, which is invalid if the connection failed
+     */
+    static NativeSocket connect(const std::string& address, int port);
+
+    /**
+     * Waits for at least one of the \p items to become ready or for \p timeout
+     * milliseconds to pass and sets the revents of all items.
+     *
+     * \return The number of items that are ready, or -1 if an error occurred
+     */
+    static int poll(std::vector<PollItem>& items, int timeout);
+
+    NativeSocket() = default;
+    NativeSocket(NativeSocket&& other) noexcept;
+    NativeSocket& operator=(NativeSocket&& other) noexcept;
+    NativeSocket(const NativeSocket&) = delete;
+    NativeSocket& operator=(const NativeSocket&) = delete;
+    ~NativeSocket();
+
+    bool isValid() const;
+    Handle handle() const;
+
+    /**
+     * Accepts a pending connection on a listening socket.
+     *
+     * \param address Will contain the IPv4 address of the remote end
+     * \return The accepted socket, which is invalid if no connection is pending
+     */
+    NativeSocket accept(std::string& address);
+
+    /**
+     * Sends up to \p size bytes from \p data without blocking.
+     *
+     * \return The number of bytes that were sent, which is 0 if the socket would block,
+     *         or -1 if the connection failed
+     */
+    std::ptrdiff_t send(const char* data, size_t size);
+
+    /**
+     * Receives up to \p size bytes into \p data without blocking.
+     *
+     * \return The number of bytes that were received, 0 if no data was available, or -1
+     *         if the connection was closed or failed
+     */
+    std::ptrdiff_t receive(char* data, size_t size);
+
+    /**
+     * Sets the size of the receive buffer of the operating system. This is mainly
+     * useful to simulate slow connections.
+     */
+    void setReceiveBufferSize(int size);
+
+    void close();
+
+private:
+    explicit NativeSocket(Handle handle);
+
+    Handle _handle = InvalidHandle;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___NATIVESOCKET___H__
@@ -0,0 +1,108 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___OUTBOUNDMESSAGEQUEUE___H__
+#define __OPENSPACE_CORE___OUTBOUNDMESSAGEQUEUE___H__
+
+#include <ghoul/misc/boolean.h>
+#include <deque>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * The queue of messages that are waiting to be sent to a single peer of a server. The
+ * messages are fully encoded and shared between the queues of all peers that they are
+ * sent to. Supersedable messages, such as camera keyframes, are only of interest until a
+ * newer one is available, so a waiting supersedable message is replaced by a newer one,
+ * which lets a slow peer catch up. The size of the queue is bounded, so that a peer that
+ * cannot keep up at all is detected instead of the queue growing without limit.
+ */
+class OutboundMessageQueue {
+public:
+    BooleanType(IsSupersedable);
+
+    using Message = std::shared_ptr<const std::vector<char>>;
+
+    /**
+     * Creates an empty queue that holds at most \p maxBytes bytes.
+     */
+    explicit OutboundMessageQueue(size_t maxBytes);
+
+    /**
+     * Adds the \p message to the end of the queue. If the message is supersedable, a
+     * waiting supersedable message of which nothing has been sent yet is removed first.
+     *
+     * \param message The message that is added to the queue
+     * \param isSupersedable Whether the message is made obsolete by the next message that
+     *        is supersedable
+     * \return \c false if the message did not fit into the queue. A message always fits
+     *         into an empty queue, regardless of its size
+     */
+    bool push(Message message, IsSupersedable isSupersedable);
+
+    /**
+     * Returns the bytes of the first message in the queue that have not been sent yet,
+     * or an empty view if the queue is empty.
+     */
+    std::string_view front() const;
+
+    /**
+     * Marks the first \p nBytes bytes of #front as sent and removes the first message
+     * once all of it has been sent.
+     *
+     * \pre \p nBytes must not be larger than the size of #front
+     */
+    void pop(size_t nBytes);
+
+    bool isEmpty() const;
+
+    /**
+     * Returns the number of bytes that are waiting to be sent.
+     */
+    size_t nBytes() const;
+
+    /**
+     * Returns the number of messages that were removed as they were superseded.
+     */
+    size_t nSuperseded() const;
+
+private:
+    struct Entry {
+        Message message;
+        bool isSupersedable = false;
+    };
+
+    std::deque<Entry> _entries;
+    const size_t _maxBytes;
+    size_t _nBytes = 0;
+    size_t _frontOffset = 0;
+    size_t _nSuperseded = 0;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___OUTBOUNDMESSAGEQUEUE___H__
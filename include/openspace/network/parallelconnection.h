@@ -84,7 +84,15 @@ public:
 
     ParallelConnection::Message receiveMessage();
 
+    /**
+     * Returns the \p message with the header that precedes it on the wire
+     */
+    static std::vector<char> encodeMessage(const ParallelConnection::Message& message);
+
     static const unsigned int ProtocolVersion;
+
+    /// 'OS', followed by the protocol version, the message type, and the message size
+    static constexpr size_t HeaderSize = 2 * sizeof(char) + 3 * sizeof(uint32_t);
 private:
     std::unique_ptr<ghoul::io::TcpSocket> _socket;
 };
@@ -27,39 +27,77 @@
 
 #include <openspace/network/parallelconnection.h>
 
-#include <openspace/util/concurrentqueue.h>
-#include <ghoul/io/socket/tcpsocketserver.h>
+#include <openspace/network/nativesocket.h>
+#include <openspace/network/outboundmessagequeue.h>
 #include <atomic>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 
 namespace openspace {
 
+/**
+ * The server that relays the messages between the peers of a parallel session. All
+ * connections are multiplexed on a single thread that waits for the sockets to become
+ * ready, so a slow peer never blocks the others. Each peer has its own queue of outgoing
+ * messages, and messages that are sent to many peers are encoded only once. Camera
+ * keyframes that are still waiting to be sent to a peer are replaced by newer ones, and
+ * a peer that still cannot keep up and whose queue overflows is disconnected.
+ */
 class ParallelServer {
 public:
-    void start(int port, const std::string& password,
+    struct Statistics {
+        /// The number of camera keyframes that were superseded before they were sent
+        size_t nSupersededKeyframes = 0;
+        /// The number of peers that were disconnected since they could not keep up
+        size_t nOverflows = 0;
+        /// The largest number of bytes that were waiting to be sent to a single peer
+        size_t maxQueuedBytes = 0;
+    };
+
+    ~ParallelServer();
+
+    /**
+     * Starts listening on the \p port and handling the peers on a separate thread.
+     *
+     * \return \c false if the port could not be opened
+     */
+    bool start(int port, const std::string& password,
         const std::string& changeHostPassword);
 
     void setDefaultHostAddress(std::string defaultHostAddress);
 
     std::string defaultHostAddress() const;
 
+    /**
+     * Disconnects all peers and stops the server. This function blocks until the thread
+     * that handles the peers has finished.
+     */
     void stop();
 
     size_t nConnections() const;
 
+    Statistics statistics() const;
+
 private:
     struct Peer {
+        Peer(size_t id_, NativeSocket socket_, std::string address_);
+
         size_t id;
         std::string name;
-        ParallelConnection parallelConnection;
-        ParallelConnection::Status status;
-        std::thread thread;
-    };
-
-    struct PeerMessage {
-        size_t peerId;
-        ParallelConnection::Message message;
+        std::string address;
+        NativeSocket socket;
+        ParallelConnection::Status status = ParallelConnection::Status::Connecting;
+        /// Set if sending or receiving failed; the peer is disconnected at the end of
+        /// the current iteration of the event loop
+        bool isLost = false;
+        bool isDisconnected = false;
+
+        /// Received data that does not yet form a complete message
+        std::vector<char> inputBuffer;
+        OutboundMessageQueue outputQueue;
     };
 
     bool isConnected(const Peer& peer) const;
@@ -70,33 +108,34 @@ private:
     void sendMessageToAll(ParallelConnection::MessageType messageType,
         const std::vector<char>& message);
 
-    void sendMessageToClients(ParallelConnection::MessageType messageType,
-        const std::vector<char>& message);
+    void sendEncodedMessage(Peer& peer, OutboundMessageQueue::Message message,
+        OutboundMessageQueue::IsSupersedable isSupersedable);
 
     void disconnect(Peer& peer);
     void setName(Peer& peer, std::string name);
-    void assignHost(std::shared_ptr<Peer> newHost);
+    void assignHost(Peer& newHost);
     void setToClient(Peer& peer);
     void setNConnections(size_t nConnections);
     void sendConnectionStatus(Peer& peer);
 
-    void handleAuthentication(std::shared_ptr<Peer> peer, std::vector<char> message);
-    void handleData(const Peer& peer, std::vector<char> data);
-    void handleHostshipRequest(std::shared_ptr<Peer> peer, std::vector<char> message);
+    void handleAuthentication(Peer& peer, std::string_view message);
+    void handleData(const Peer& peer, std::string_view encodedMessage);
+    void handleHostshipRequest(Peer& peer, std::string_view message);
     void handleHostshipResignation(Peer& peer);
 
-    void handleNewPeers();
     void eventLoop();
-    std::shared_ptr<Peer> peer(size_t id);
-    void handlePeer(size_t id);
-    void handlePeerMessage(PeerMessage peerMessage);
+    void acceptPeers();
+    void receive(Peer& peer);
+    void flush(Peer& peer);
+    void handlePeerMessage(Peer& peer, ParallelConnection::MessageType type,
+        std::string_view encodedMessage);
+    void removeDisconnectedPeers();
+    Peer* peer(size_t id);
 
-    std::unordered_map<size_t, std::shared_ptr<Peer>> _peers;
-    mutable std::mutex _peerListMutex;
+    std::unordered_map<size_t, std::unique_ptr<Peer>> _peers;
 
-    std::thread _serverThread;
     std::thread _eventLoopThread;
-    ghoul::io::TcpSocketServer _socketServer;
+    NativeSocket _listenSocket;
     size_t _passwordHash;
     size_t _changeHostPasswordHash;
     size_t _nextConnectionId = 1;
@@ -109,7 +148,9 @@ private:
     std::string _hostName;
     std::string _defaultHostAddress;
 
-    ConcurrentQueue<PeerMessage> _incomingMessages;
+    std::atomic_size_t _nSupersededKeyframes = 0;
+    std::atomic_size_t _nOverflows = 0;
+    std::atomic_size_t _maxQueuedBytes = 0;
 };
 
 } // namespace openspace
@@ -28,6 +28,7 @@
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/misc/easing.h>
 #include <any>
+#include <atomic>
 #include <functional>
 #include <string>
 
@@ -493,6 +494,15 @@ public:
      */
     void resetToUnchanged();
 
+    /**
+     * Returns a counter that is incremented whenever the value of any Property changes.
+     * Comparing two values of this counter is a cheap way to determine whether any
+     * Property might have been changed in the meantime.
+     *
+     * \return The number of value changes of all Property%s so far
+     */
+    static uint64_t changeGeneration();
+
 protected:
     static const char* IdentifierKey;
     static const char* NameKey;
@@ -535,6 +545,8 @@ protected:
 private:
     void notifyDeleteListeners();
 
+    static std::atomic<uint64_t> ChangeGeneration;
+
     OnChangeHandle _currentHandleValue = 0;
 
 #ifdef _DEBUG
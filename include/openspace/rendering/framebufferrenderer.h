@@ -27,6 +27,7 @@
 
 #include <openspace/rendering/raycasterlistener.h>
 #include <openspace/rendering/deferredcasterlistener.h>
+#include <openspace/util/framearena.h>
 
 #include <ghoul/glm.h>
 #include <ghoul/misc/dictionary.h>
@@ -81,9 +82,9 @@ public:
     void setDisableHDR(bool disable);
 
     void update();
-    void performRaycasterTasks(const std::vector<RaycasterTask>& tasks,
+    void performRaycasterTasks(const FrameVector<RaycasterTask>& tasks,
         const glm::ivec4& viewport);
-    void performDeferredTasks(const std::vector<DeferredcasterTask>& tasks,
+    void performDeferredTasks(const FrameVector<DeferredcasterTask>& tasks,
         const glm::ivec4& viewport);
     void render(Scene* scene, Camera* camera, float blackoutFactor);
 
@@ -53,6 +53,10 @@ public:
     virtual glm::dmat3 matrix(const UpdateData& time) const = 0;
     virtual void update(const UpdateData& data);
 
+    /// Returns whether the rotation can be updated concurrently to other scene graph
+    /// nodes, see Translation::isThreadSafe
+    virtual bool isThreadSafe() const;
+
     static documentation::Documentation Documentation();
 
 protected:
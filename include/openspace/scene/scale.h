@@ -53,6 +53,10 @@ public:
     virtual glm::dvec3 scaleValue(const UpdateData& data) const = 0;
     virtual void update(const UpdateData& data);
 
+    /// Returns whether the scale can be updated concurrently to other scene graph nodes,
+    /// see Translation::isThreadSafe
+    virtual bool isThreadSafe() const;
+
     static documentation::Documentation Documentation();
 
 protected:
@@ -27,6 +27,8 @@
 
 #include <openspace/properties/propertyowner.h>
 
+#include <openspace/properties/scalar/boolproperty.h>
+#include <openspace/properties/scalar/intproperty.h>
 #include <openspace/scene/profile.h>
 #include <openspace/scene/scenegraphnode.h>
 #include <ghoul/lua/luastate.h>
@@ -111,7 +113,15 @@ public:
     Camera* camera() const;
 
     /**
-     * Updates all SceneGraphNodes relative positions
+     * Updates all SceneGraphNodes relative positions. If neither the simulation time nor
+     * any Property has changed since the last call, this function does nothing, so it
+     * can be called multiple times per frame without incurring additional costs.
+     *
+     * The transformations are updated level by level, where the nodes of each level only
+     * depend on nodes in previous levels through their parent or their dependencies.
+     * Nodes of the same level whose transformations are thread-safe are updated in
+     * parallel, which produces the same results as a serial update. The renderables of
+     * all nodes are updated afterwards on the calling thread in topological order.
      */
     void update(const UpdateData& data);
 
@@ -318,6 +328,18 @@ private:
 
     std::unique_ptr<Camera> _camera;
     std::vector<SceneGraphNode*> _topologicallySortedNodes;
+
+    // The nodes in the order in which their transformations are updated. The nodes are
+    // grouped into levels so that each node only depends on nodes of previous levels.
+    // Within each level, the nodes in [begin, parallelEnd) can be updated concurrently,
+    // the nodes in [parallelEnd, end) have to be updated serially
+    struct UpdateLevel {
+        size_t begin = 0;
+        size_t parallelEnd = 0;
+        size_t end = 0;
+    };
+    std::vector<SceneGraphNode*> _updateOrder;
+    std::vector<UpdateLevel> _updateLevels;
     std::vector<SceneGraphNode*> _circularNodes;
     std::unordered_map<std::string, SceneGraphNode*> _nodesByIdentifier;
     bool _dirtyNodeRegistry = false;
@@ -341,6 +363,27 @@ private:
     std::vector<PropertyInterpolationInfo> _propertyInterpolationInfos;
 
     ghoul::MemoryPool<4096> _memoryPool;
+
+    // The inputs of the last call to update. If they are the same in the next call, all
+    // nodes would compute the same values again, so the update can be skipped
+    struct {
+        double time = 0.0;
+        double previousFrameTime = 0.0;
+        uint64_t propertyGeneration = 0;
+        bool isValid = false;
+    } _lastUpdate;
+
+    // Counts how many nodes recomputed their world transform in the current frame and
+    // how many could reuse their cached values
+    struct {
+        uint64_t frameNumber = 0;
+        int nRecomputed = 0;
+        int nSkipped = 0;
+    } _updateStatistics;
+
+    properties::BoolProperty _parallelUpdate;
+    properties::IntProperty _nNodesRecomputed;
+    properties::IntProperty _nNodesSkipped;
 };
 
 } // namespace openspace
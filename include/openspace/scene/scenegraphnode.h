@@ -93,7 +93,46 @@ public:
 
     void traversePreOrder(const std::function<void(SceneGraphNode*)>& fn);
     void traversePostOrder(const std::function<void(SceneGraphNode*)>& fn);
-    void update(const UpdateData& data);
+
+    /**
+     * Updates the transformations and the renderable of this node. The world transform
+     * is only recomputed if the local transformation of this node or the world transform
+     * of its parent has changed since the last call. This is equivalent to calling
+     * #updateTransform followed by #updateRenderable.
+     *
+     * \param data The update information for the current frame
+     * \return \c true if the world transform of this node was recomputed, \c false if
+     *         the node was not updated or the cached world transform was still valid
+     */
+    bool update(const UpdateData& data);
+
+    /**
+     * Updates the transformations and the cached world transform of this node. The world
+     * transforms of the parent and all dependencies have to be updated before this
+     * function is called. If #isTransformThreadSafe returns \c true, this function can
+     * be called concurrently for nodes that do not depend on each other.
+     *
+     * \param data The update information for the current frame
+     * \return \c true if the world transform of this node was recomputed, \c false if
+     *         the node was not updated or the cached world transform was still valid
+     */
+    bool updateTransform(const UpdateData& data);
+
+    /**
+     * Updates the renderable of this node with the world transform that was computed in
+     * the last call to #updateTransform. The renderable is not updated if the node was
+     * not active in that call. This function must be called from the main thread.
+     *
+     * \param data The update information for the current frame
+     */
+    void updateRenderable(const UpdateData& data);
+
+    /**
+     * Returns whether the translation, rotation, and scale of this node can be updated
+     * concurrently to other scene graph nodes.
+     */
+    bool isTransformThreadSafe() const;
+
     void render(const RenderData& data, RendererTasks& tasks);
 
     void attachChild(ghoul::mm_unique_ptr<SceneGraphNode> child);
@@ -194,6 +233,24 @@ private:
 
     glm::dmat4 _modelTransformCached = glm::dmat4(1.0);
 
+    // The inputs that were used in the last computation of the cached world transform. If
+    // none of these changed, the cached values are still valid. The generation is
+    // increased every time the world transform is recomputed so that child nodes can
+    // detect a change in their parent
+    struct {
+        glm::dvec3 position = glm::dvec3(0.0);
+        glm::dmat3 rotation = glm::dmat3(1.0);
+        glm::dvec3 scale = glm::dvec3(1.0);
+        const SceneGraphNode* parent = nullptr;
+        uint64_t parentGeneration = 0;
+        bool isValid = false;
+    } _worldTransformInputs;
+    uint64_t _worldTransformGeneration = 0;
+
+    // Whether the node was initialized and inside its time frame in the last call to
+    // updateTransform. Only in that case the renderable will be updated
+    bool _isActiveInUpdate = false;
+
     properties::DoubleProperty _boundingSphere;
     properties::DoubleProperty _interactionSphere;
     properties::DoubleProperty _approachFactor;
@@ -55,6 +55,16 @@ public:
 
     virtual glm::dvec3 position(const UpdateData& data) const = 0;
 
+    /**
+     * Returns whether the update of this translation can be executed concurrently to the
+     * update of other scene graph nodes. This is only the case if the position depends
+     * on nothing but the state of this object and the passed UpdateData, but not on any
+     * shared state, such as the SPICE kernel pool or a Lua state.
+     *
+     * \return \c true if the update can be executed on any thread, \c false otherwise
+     */
+    virtual bool isThreadSafe() const;
+
     // Registers a callback that gets called when a significant change has been made that
     // invalidates potentially stored points, for example in trails
     void onParameterChange(std::function<void()> callback);
@@ -28,7 +28,8 @@
 #include <openspace/util/concurrentqueue.h>
 #include <openspace/util/threadpool.h>
 
-#include <mutex>
+#include <memory>
+#include <vector>
 
 namespace openspace {
 
@@ -41,7 +42,8 @@ template <typename T> struct Job;
 template<typename P>
 class ConcurrentJobManager {
 public:
-    ConcurrentJobManager(ThreadPool pool);
+    ConcurrentJobManager(ThreadPool pool, size_t maxFinishedJobs = 1024);
+    ~ConcurrentJobManager();
 
     void enqueueJob(std::shared_ptr<Job<P>> job);
 
@@ -49,11 +51,16 @@ public:
 
     std::shared_ptr<Job<P>> popFinishedJob();
 
+    /// Returns all jobs that have finished since the last call in the order in which they
+    /// finished
+    std::vector<std::shared_ptr<Job<P>>> popFinishedJobs();
+
     size_t numFinishedJobs() const;
 
 private:
-    ConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
-    std::mutex _finishedJobsMutex;
+    /// Workers push their results here. Once twice \c maxFinishedJobs results are
+    /// waiting to be popped, the workers wait before pushing more
+    OverflowingConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
     ThreadPool threadPool;
 };
 
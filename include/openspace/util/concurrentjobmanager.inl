@@ -28,15 +28,21 @@
 namespace openspace {
 
 template<typename P>
-ConcurrentJobManager<P>::ConcurrentJobManager(ThreadPool pool)
-    : threadPool(pool)
+ConcurrentJobManager<P>::ConcurrentJobManager(ThreadPool pool, size_t maxFinishedJobs)
+    : _finishedJobs(maxFinishedJobs)
+    , threadPool(pool)
 {}
 
+template<typename P>
+ConcurrentJobManager<P>::~ConcurrentJobManager() {
+    // Workers that wait for room must not keep the thread pool from shutting down
+    _finishedJobs.close();
+}
+
 template<typename P>
 void ConcurrentJobManager<P>::enqueueJob(std::shared_ptr<Job<P>> job) {
     threadPool.enqueue([this, job]() {
         job->execute();
-        std::lock_guard lock(_finishedJobsMutex);
         _finishedJobs.push(job);
     });
 }
@@ -48,10 +54,16 @@ void ConcurrentJobManager<P>::clearEnqueuedJobs() {
 
 template<typename P>
 std::shared_ptr<Job<P>> ConcurrentJobManager<P>::popFinishedJob() {
-    ghoul_assert(!_finishedJobs.empty(), "There is no finished job to pop!");
+    ghoul_assert(numFinishedJobs() > 0, "There is no finished job to pop!");
 
-    std::lock_guard lock(_finishedJobsMutex);
-    return _finishedJobs.pop();
+    std::shared_ptr<Job<P>> job;
+    _finishedJobs.tryPop(job);
+    return job;
+}
+
+template<typename P>
+std::vector<std::shared_ptr<Job<P>>> ConcurrentJobManager<P>::popFinishedJobs() {
+    return _finishedJobs.popAll();
 }
 
 template<typename P>
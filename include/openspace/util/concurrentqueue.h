@@ -25,9 +25,13 @@
 #ifndef __OPENSPACE_CORE___CONCURRENT_QUEUE___H__
 #define __OPENSPACE_CORE___CONCURRENT_QUEUE___H__
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 namespace openspace {
 
@@ -45,6 +49,13 @@ public:
 
     void push(T&& item);
 
+    /// Pops the first item into \p item if there is one and returns \c true. Returns
+    /// \c false without waiting if the queue is empty
+    bool tryPop(T& item);
+
+    /// Removes all items that are currently in the queue and returns them in order
+    std::vector<T> popAll();
+
     size_t size() const;
 
     bool empty() const;
@@ -55,6 +66,126 @@ private:
     mutable std::condition_variable _cond;
 };
 
+/**
+ * Lock-free variant of the ConcurrentQueue with a fixed capacity for multiple producers
+ * and multiple consumers. The items are stored in a ring buffer in which each cell
+ * carries a sequence number that tells producers and consumers whether the cell is ready
+ * to be written or read, so that a push or pop only needs a single compare-and-swap on
+ * the shared position in the common case (see Dmitry Vyukov's bounded MPMC queue).
+ *
+ * The tryPush and tryPop functions never block. The blocking push and pop functions
+ * spin and yield while the queue is full or empty, respectively, instead of waiting on a
+ * condition variable, so they are only suited for threads that expect to make progress
+ * soon. The type \c T has to be default-constructible and move-assignable.
+ */
+template <typename T>
+class BoundedConcurrentQueue {
+public:
+    /// Creates the queue with room for at least \p capacity items. The capacity is
+    /// rounded up to the next power of two
+    explicit BoundedConcurrentQueue(size_t capacity = 1024);
+
+    BoundedConcurrentQueue(const BoundedConcurrentQueue&) = delete;
+    BoundedConcurrentQueue& operator=(const BoundedConcurrentQueue&) = delete;
+
+    T pop();
+
+    void pop(T& item);
+
+    void push(const T& item);
+
+    void push(T&& item);
+
+    /// Pushes the \p item if there is room and returns \c true. Returns \c false
+    /// without modifying \p item if the queue is full
+    bool tryPush(T&& item);
+    bool tryPush(const T& item);
+
+    /// Pops the first item into \p item if there is one and returns \c true. Returns
+    /// \c false without waiting if the queue is empty
+    bool tryPop(T& item);
+
+    /// Removes all items that are in the queue when this function is called and returns
+    /// them in order. Items that are pushed concurrently might or might not be included
+    std::vector<T> popAll();
+
+    /// Returns the number of items in the queue. If other threads are pushing or popping
+    /// concurrently, the value is only a snapshot
+    size_t size() const;
+
+    bool empty() const;
+
+    size_t capacity() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    template <typename U>
+    bool tryPushImpl(U&& item);
+
+    // Avoid false sharing between the producer and the consumer position
+    static constexpr const size_t CacheLineSize = 64;
+
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _buffer;
+    alignas(CacheLineSize) std::atomic<size_t> _enqueuePosition = 0;
+    alignas(CacheLineSize) std::atomic<size_t> _dequeuePosition = 0;
+};
+
+/**
+ * Queue that hands items from multiple producers to a single consumer, such as the
+ * results of jobs that finish on worker threads. Items are pushed into a
+ * BoundedConcurrentQueue and, once that is full, into an overflow list of the same
+ * capacity. The producers move overflowing items back into the lock-free queue as soon
+ * as there is room. A producer that still finds the overflow list full waits until the
+ * consumer has popped items, so the queue never holds more than twice its capacity.
+ *
+ * The producers push while holding a mutex so that an item only bypasses the overflow
+ * list while that list is empty. This guarantees that items are popped in the order in
+ * which they were pushed. The consumer does not take the mutex unless items have
+ * overflowed or a push is still in progress.
+ */
+template <typename T>
+class OverflowingConcurrentQueue {
+public:
+    /// Creates the queue with room for at least \p capacity items in the lock-free queue
+    /// and as many items in the overflow list
+    explicit OverflowingConcurrentQueue(size_t capacity = 1024);
+
+    /// Pushes the \p item, waiting while the queue is full. Returns \c false and drops
+    /// the item if the queue has been closed
+    bool push(T item);
+
+    /// Pops the oldest item into \p item if there is one and returns \c true. Returns
+    /// \c false without waiting if the queue is empty. Must only be called by one thread
+    bool tryPop(T& item);
+
+    /// Removes all items that are currently in the queue and returns them in order. Must
+    /// only be called by one thread
+    std::vector<T> popAll();
+
+    /// Returns the number of items in the queue. If other threads are pushing or popping
+    /// concurrently, the value is only a snapshot
+    size_t size() const;
+
+    /// Wakes up all producers that are waiting for room and makes all further pushes
+    /// fail. This has to be called before waiting for the producers to finish if the
+    /// consumer might have stopped popping items
+    void close();
+
+private:
+    BoundedConcurrentQueue<T> _queue;
+    std::deque<T> _overflow;
+    const size_t _overflowCapacity;
+    std::atomic<size_t> _nOverflow = 0;
+    bool _isClosed = false;
+    std::mutex _mutex;
+    std::condition_variable _hasRoom;
+};
+
 } // namespace openspace
 
 #include "concurrentqueue.inl"
@@ -22,8 +22,33 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
 namespace openspace {
 
+namespace concurrentqueue::detail {
+    // Spins shortly before yielding the time slice, used while a bounded queue is full or
+    // empty and the caller requested a blocking operation
+    inline void backoff(int& iteration) {
+        if (iteration < 64) {
+            iteration++;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+
+    inline size_t nextPowerOfTwo(size_t v) {
+        size_t result = 2;
+        while (result < v) {
+            result <<= 1;
+        }
+        return result;
+    }
+} // namespace concurrentqueue::detail
+
 template <typename T>
 T ConcurrentQueue<T>::pop() {
     std::unique_lock<std::mutex> mlock(_mutex);
@@ -61,6 +86,29 @@ void ConcurrentQueue<T>::push(T&& item) {
     _cond.notify_one();
 }
 
+template <typename T>
+bool ConcurrentQueue<T>::tryPop(T& item) {
+    std::lock_guard lock(_mutex);
+    if (_queue.empty()) {
+        return false;
+    }
+    item = std::move(_queue.front());
+    _queue.pop();
+    return true;
+}
+
+template <typename T>
+std::vector<T> ConcurrentQueue<T>::popAll() {
+    std::lock_guard lock(_mutex);
+    std::vector<T> result;
+    result.reserve(_queue.size());
+    while (!_queue.empty()) {
+        result.push_back(std::move(_queue.front()));
+        _queue.pop();
+    }
+    return result;
+}
+
 template <typename T>
 size_t ConcurrentQueue<T>::size() const {
     std::unique_lock<std::mutex> mlock(_mutex);
@@ -76,4 +124,245 @@ bool ConcurrentQueue<T>::empty() const {
 }
 
 
+
+template <typename T>
+BoundedConcurrentQueue<T>::BoundedConcurrentQueue(size_t capacity)
+    : _mask(concurrentqueue::detail::nextPowerOfTwo(capacity) - 1)
+    , _buffer(std::make_unique<Cell[]>(_mask + 1))
+{
+    for (size_t i = 0; i <= _mask; ++i) {
+        _buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+template <typename U>
+bool BoundedConcurrentQueue<T>::tryPushImpl(U&& item) {
+    size_t pos = _enqueuePosition.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = _buffer[pos & _mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+            static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+        if (diff == 0) {
+            // The cell is free for this position, try to claim it
+            if (_enqueuePosition.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed
+               ))
+            {
+                cell.data = std::forward<U>(item);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The cell still contains an item from the previous lap; the queue is full
+            return false;
+        }
+        else {
+            // Another producer claimed this position first
+            pos = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::tryPush(T&& item) {
+    return tryPushImpl(std::move(item));
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::tryPush(const T& item) {
+    return tryPushImpl(item);
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::tryPop(T& item) {
+    size_t pos = _dequeuePosition.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = _buffer[pos & _mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff =
+            static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+        if (diff == 0) {
+            if (_dequeuePosition.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed
+               ))
+            {
+                item = std::move(cell.data);
+                // Release whatever the item was holding on to before the cell is reused
+                cell.data = T();
+                cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The producer for this position has not finished yet; the queue is empty
+            return false;
+        }
+        else {
+            pos = _dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+T BoundedConcurrentQueue<T>::pop() {
+    T item;
+    pop(item);
+    return item;
+}
+
+template <typename T>
+void BoundedConcurrentQueue<T>::pop(T& item) {
+    int iteration = 0;
+    while (!tryPop(item)) {
+        concurrentqueue::detail::backoff(iteration);
+    }
+}
+
+template <typename T>
+void BoundedConcurrentQueue<T>::push(const T& item) {
+    int iteration = 0;
+    while (!tryPushImpl(item)) {
+        concurrentqueue::detail::backoff(iteration);
+    }
+}
+
+template <typename T>
+void BoundedConcurrentQueue<T>::push(T&& item) {
+    // tryPushImpl only moves from the item when it succeeds
+    int iteration = 0;
+    while (!tryPushImpl(std::move(item))) {
+        concurrentqueue::detail::backoff(iteration);
+    }
+}
+
+template <typename T>
+std::vector<T> BoundedConcurrentQueue<T>::popAll() {
+    // Only drain what was there when we started so that a steady stream of producers
+    // cannot keep the caller in here forever
+    size_t n = size();
+    std::vector<T> result;
+    result.reserve(n);
+    T item;
+    while (n > 0 && tryPop(item)) {
+        result.push_back(std::move(item));
+        n--;
+    }
+    return result;
+}
+
+template <typename T>
+size_t BoundedConcurrentQueue<T>::size() const {
+    const size_t dequeue = _dequeuePosition.load(std::memory_order_acquire);
+    const size_t enqueue = _enqueuePosition.load(std::memory_order_acquire);
+    // The two loads are not atomic together, so clamp the result to the valid range
+    if (enqueue <= dequeue) {
+        return 0;
+    }
+    return std::min(enqueue - dequeue, _mask + 1);
+}
+
+template <typename T>
+bool BoundedConcurrentQueue<T>::empty() const {
+    return size() == 0;
+}
+
+template <typename T>
+size_t BoundedConcurrentQueue<T>::capacity() const {
+    return _mask + 1;
+}
+
+template <typename T>
+OverflowingConcurrentQueue<T>::OverflowingConcurrentQueue(size_t capacity)
+    : _queue(capacity)
+    , _overflowCapacity(_queue.capacity())
+{}
+
+template <typename T>
+bool OverflowingConcurrentQueue<T>::push(T item) {
+    std::unique_lock lock(_mutex);
+    _hasRoom.wait(lock, [this]() {
+        // The overflowing items are older than anything in the queue that is pushed
+        // later, so they can be moved to its end as soon as the consumer made room
+        while (!_overflow.empty() && _queue.tryPush(std::move(_overflow.front()))) {
+            _overflow.pop_front();
+        }
+        _nOverflow = _overflow.size();
+        return _isClosed || _overflow.size() < _overflowCapacity;
+    });
+    if (_isClosed) {
+        return false;
+    }
+
+    // If items are waiting in the overflow list, this item has to go behind them
+    if (_overflow.empty() && _queue.tryPush(std::move(item))) {
+        return true;
+    }
+    _overflow.push_back(std::move(item));
+    _nOverflow = _overflow.size();
+    return true;
+}
+
+template <typename T>
+bool OverflowingConcurrentQueue<T>::tryPop(T& item) {
+    if (_queue.tryPop(item)) {
+        return true;
+    }
+    if (_nOverflow == 0 && _queue.empty()) {
+        return false;
+    }
+
+    std::lock_guard lock(_mutex);
+    // A producer might have finished pushing into the queue after our first attempt. Any
+    // item in the queue is older than the items in the overflow list
+    if (_queue.tryPop(item)) {
+        return true;
+    }
+    if (_overflow.empty()) {
+        return false;
+    }
+    item = std::move(_overflow.front());
+    _overflow.pop_front();
+    _nOverflow = _overflow.size();
+    _hasRoom.notify_one();
+    return true;
+}
+
+template <typename T>
+std::vector<T> OverflowingConcurrentQueue<T>::popAll() {
+    if (_nOverflow == 0) {
+        // Items that overflow while we are draining the queue are newer than all items
+        // in it, so they can be left for the next call
+        return _queue.popAll();
+    }
+
+    std::lock_guard lock(_mutex);
+    std::vector<T> result = _queue.popAll();
+    result.insert(
+        result.end(),
+        std::make_move_iterator(_overflow.begin()),
+        std::make_move_iterator(_overflow.end())
+    );
+    _overflow.clear();
+    _nOverflow = 0;
+    _hasRoom.notify_all();
+    return result;
+}
+
+template <typename T>
+size_t OverflowingConcurrentQueue<T>::size() const {
+    return _queue.size() + _nOverflow;
+}
+
+template <typename T>
+void OverflowingConcurrentQueue<T>::close() {
+    std::lock_guard lock(_mutex);
+    _isClosed = true;
+    _hasRoom.notify_all();
+}
+
 } // namespace openspace
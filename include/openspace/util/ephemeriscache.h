@@ -0,0 +1,208 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___EPHEMERISCACHE___H__
+#define __OPENSPACE_CORE___EPHEMERISCACHE___H__
+
+#include <ghoul/glm.h>
+#include <glm/gtc/quaternion.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * This class caches samples of a position or an orientation that changes smoothly over
+ * time and serves interpolated values in between these samples. Positions are
+ * interpolated with cubic Hermite splines using the sampled velocities, orientations are
+ * interpolated spherically between the sampled quaternions.
+ *
+ * The time axis is split into segments of a fixed length. The first time a value inside
+ * a segment is requested, the segment is sampled at its boundaries and the interval that
+ * contains the requested time is bisected until the interpolation error, measured at two
+ * test points inside the interval, is below the tolerance or the interval is shorter than
+ * the minimum step. Only the intervals on the way to the requested times are refined, so
+ * the number of samples depends on the times that are actually used. The samples that
+ * are taken only depend on the sampled function and the parameters of the cache, but not
+ * on the order in which values are requested, which means that the returned values are
+ * deterministic, even if segments have been evicted in between or if the cache is used
+ * from multiple threads.
+ *
+ * All public functions are thread-safe. Lookups of intervals that have already been
+ * refined only require a shared lock, the sample function is only ever called by a
+ * single thread at a time.
+ */
+class EphemerisCache {
+public:
+    enum class Type {
+        Position,
+        Rotation
+    };
+
+    struct Sample {
+        /// The position; only used for Type::Position
+        glm::dvec3 position = glm::dvec3(0.0);
+        /// The time derivative of the position; only used for Type::Position
+        glm::dvec3 velocity = glm::dvec3(0.0);
+        /// The orientation; only used for Type::Rotation
+        glm::dquat rotation = glm::dquat(1.0, 0.0, 0.0, 0.0);
+    };
+
+    /// The function that provides the exact sample at a specific time or std::nullopt
+    /// if no value is available for that time
+    using SampleFunction = std::function<std::optional<Sample>(double)>;
+
+    struct Statistics {
+        /// The number of requests that could be answered from existing samples
+        uint64_t nHits = 0;
+        /// The number of requests that required new samples
+        uint64_t nMisses = 0;
+        /// The number of times the sample function was called
+        uint64_t nEvaluations = 0;
+        /// The number of segments that are currently stored
+        size_t nSegments = 0;
+    };
+
+    /**
+     * Creates a new cache that samples the provided \p function.
+     *
+     * \param type Determines whether the positions or the rotations of the samples are
+     *        interpolated
+     * \param function The function that is called to retrieve the exact samples
+     * \param tolerance The maximum interpolation error in the units of the position or
+     *        in radians for the rotation
+     * \param segmentLength The length of each segment in seconds
+     * \param minimumStep The length in seconds below which intervals are not bisected
+     *        anymore, even if the tolerance is not met
+     * \param maxSegments The maximum number of segments that are kept in memory. If more
+     *        segments are required, the least recently used ones are evicted
+     *
+     * \pre \p function must not be empty
+     * \pre \p tolerance must be positive
+     * \pre \p segmentLength must be bigger than \p minimumStep
+     * \pre \p minimumStep must be positive
+     * \pre \p maxSegments must be at least 1
+     */
+    EphemerisCache(Type type, SampleFunction function, double tolerance,
+        double segmentLength, double minimumStep = 1.0, size_t maxSegments = 32);
+
+    /**
+     * Returns the interpolated sample at the provided \p time. If the sample function
+     * did not return a value for any time that was needed for the interpolation,
+     * std::nullopt is returned instead and the caller has to compute the value in a
+     * different way.
+     *
+     * \param time The time in seconds for which the sample is requested
+     * \return The interpolated sample at \p time or std::nullopt if no interpolated
+     *         value is available for this time
+     */
+    std::optional<Sample> value(double time);
+
+    /**
+     * Makes sure that the samples for the \p nSteps times \p time + i * \p deltaTime are
+     * available, so that later requests in the direction in which time is moving do not
+     * have to call the sample function. This is only done if the cache has been used
+     * since the last call to this function so that unused caches do not cost anything.
+     *
+     * \param time The current time in seconds
+     * \param deltaTime The change in time per step, which might be negative
+     * \param nSteps The number of steps that should be prefetched
+     */
+    void prefetch(double time, double deltaTime, int nSteps);
+
+    /// Removes all stored samples, for example if the underlying data has changed
+    void clear();
+
+    /**
+     * Sets a new tolerance for the interpolation error. As the samples depend on the
+     * tolerance, all stored samples are removed.
+     *
+     * \param tolerance The new tolerance
+     * \pre \p tolerance must be positive
+     */
+    void setTolerance(double tolerance);
+
+    /// Returns the statistics of this cache
+    Statistics statistics() const;
+
+    /// Returns whether this cache interpolates positions or rotations
+    Type type() const;
+
+private:
+    struct Interval {
+        enum class State {
+            Unrefined,
+            Valid,
+            NoData
+        };
+
+        double begin = 0.0;
+        double end = 0.0;
+        size_t beginSample = 0;
+        size_t endSample = 0;
+        int firstChild = -1;
+        State state = State::Unrefined;
+    };
+
+    struct Segment {
+        std::vector<Sample> samples;
+        std::vector<Interval> intervals;
+        std::atomic_uint64_t lastUse = 0;
+    };
+
+    std::optional<Sample> lookup(double time);
+    static size_t findLeaf(const Segment& segment, double time);
+    Segment& createSegment(int64_t key);
+    void refine(Segment& segment, size_t interval);
+    Sample interpolate(const Segment& segment, const Interval& interval,
+        double time) const;
+    double error(const Sample& interpolated, const Sample& exact) const;
+    std::optional<Sample> evaluate(double time);
+    void evictSegments(int64_t keep);
+
+    const Type _type;
+    const SampleFunction _function;
+    const double _segmentLength;
+    const double _minimumStep;
+    const size_t _maxSegments;
+    double _tolerance;
+
+    mutable std::shared_mutex _mutex;
+    std::map<int64_t, Segment> _segments;
+
+    std::atomic_uint64_t _useCounter = 0;
+    std::atomic_bool _wasUsed = false;
+    std::atomic_uint64_t _nHits = 0;
+    std::atomic_uint64_t _nMisses = 0;
+    std::atomic_uint64_t _nEvaluations = 0;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___EPHEMERISCACHE___H__
@@ -0,0 +1,175 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___FRAMEARENA___H__
+#define __OPENSPACE_CORE___FRAMEARENA___H__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+namespace openspace {
+
+#ifdef __cpp_lib_memory_resource
+using FrameMemoryResource = std::pmr::memory_resource;
+using FrameAllocator = std::pmr::polymorphic_allocator<std::byte>;
+template <typename T> using FrameVector = std::pmr::vector<T>;
+using FrameString = std::pmr::string;
+#else // ^^^ __cpp_lib_memory_resource / !__cpp_lib_memory_resource vvv
+/**
+ * The subset of the std::pmr::memory_resource interface that is used by the FrameArena,
+ * for standard libraries that do not provide memory resources. On these, the FrameVector
+ * and FrameString containers fall back to the heap, while direct allocations from the
+ * arena work the same on all platforms.
+ */
+class FrameMemoryResource {
+public:
+    virtual ~FrameMemoryResource() = default;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        return do_allocate(bytes, alignment);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        do_deallocate(p, bytes, alignment);
+    }
+
+    bool is_equal(const FrameMemoryResource& other) const noexcept {
+        return do_is_equal(other);
+    }
+
+private:
+    virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+    virtual bool do_is_equal(const FrameMemoryResource& other) const noexcept = 0;
+};
+using FrameAllocator = std::allocator<std::byte>;
+template <typename T> using FrameVector = std::vector<T>;
+using FrameString = std::string;
+#endif // __cpp_lib_memory_resource
+
+/**
+ * A linear (bump-pointer) allocator whose memory is valid until the next call to #reset,
+ * which the engine performs once at the beginning of every frame. Allocations are
+ * lock-free and can be performed concurrently from multiple threads; deallocations are
+ * ignored. Requests that do not fit into the remaining arena are served from the
+ * upstream heap and are freed at the next reset. These overflows are counted so that the
+ * arena can be sized to cover the high-water mark of the application.
+ *
+ * Where the standard library provides it, the class is a `std::pmr::memory_resource`, so
+ * the FrameVector and FrameString containers that are created with the #allocator of the
+ * arena use per-frame memory without heap traffic.
+ */
+class FrameArena : public FrameMemoryResource {
+public:
+    /**
+     * Creates a new arena that can serve up to \p capacity bytes per frame before falling
+     * back to the heap.
+     *
+     * \param capacity The number of bytes that are preallocated for the arena
+     */
+    explicit FrameArena(size_t capacity);
+
+    /// Frees the arena memory and all outstanding overflow allocations
+    ~FrameArena() override;
+
+    /**
+     * Releases all allocations made since the last call and records the usage of the
+     * frame that just ended. If a different capacity was requested through
+     * #setCapacity, the arena is reallocated at this point. This function must not be
+     * called while other threads are allocating from the arena.
+     */
+    void reset();
+
+    /**
+     * Requests that the arena uses \p capacity bytes. The change is applied at the next
+     * call to #reset so that memory handed out in the current frame stays valid.
+     *
+     * \param capacity The new size of the arena in bytes
+     */
+    void setCapacity(size_t capacity);
+
+    /// Returns an allocator for FrameVector and FrameString that uses this arena
+    FrameAllocator allocator();
+
+    /// Returns the number of bytes that the arena can serve without overflowing
+    size_t capacity() const;
+
+    /// Returns the number of bytes that have been requested in the current frame so far
+    size_t usage() const;
+
+    /// Returns the number of bytes that were requested in the previous frame
+    size_t lastFrameUsage() const;
+
+    /// Returns the largest number of bytes that were requested in any finished frame
+    size_t highWaterMark() const;
+
+    /// Returns the number of allocations that had to be served by the upstream heap in
+    /// the previous frame
+    size_t lastFrameOverflows() const;
+
+    /// Returns the total number of allocations that had to be served by the upstream
+    /// heap since the creation of the arena
+    size_t totalOverflows() const;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const FrameMemoryResource& other) const noexcept override;
+
+    void* allocateOverflow(size_t bytes, size_t alignment);
+    void releaseOverflows();
+
+    struct OverflowAllocation {
+        void* pointer;
+        size_t alignment;
+    };
+
+    std::unique_ptr<std::byte[]> _buffer;
+    size_t _capacity = 0;
+    std::atomic_size_t _requestedCapacity = 0;
+
+    std::atomic_size_t _offset = 0;
+    std::atomic_size_t _overflowBytes = 0;
+
+    std::mutex _overflowMutex;
+    std::vector<OverflowAllocation> _overflows;
+
+    size_t _lastFrameUsage = 0;
+    size_t _highWaterMark = 0;
+    size_t _lastFrameOverflows = 0;
+    size_t _totalOverflows = 0;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___FRAMEARENA___H__
@@ -25,17 +25,35 @@
 #ifndef __OPENSPACE_CORE___MEMORYMANAGER___H__
 #define __OPENSPACE_CORE___MEMORYMANAGER___H__
 
+#include <openspace/properties/propertyowner.h>
+
+#include <openspace/properties/scalar/intproperty.h>
+#include <openspace/util/framearena.h>
 #include <ghoul/misc/memorypool.h>
 
 namespace openspace {
 
-class MemoryManager {
+class MemoryManager : public properties::PropertyOwner {
 public:
+    MemoryManager();
+
+    /**
+     * Releases all memory that was handed out by the TemporaryMemory during the last
+     * frame and updates the usage statistics that are exposed as properties. This
+     * function has to be called exactly once at the beginning of each frame.
+     */
+    void resetTemporaryMemory();
+
     ghoul::MemoryPool<8 * 1024 * 1024> PersistentMemory;
 
-    // This should be replaced with a std::pmr::memory_resource wrapper around our own
-    // Memory pool so that we can get a high-water mark out of it
-    ghoul::MemoryPool<100 * 4096, false, true> TemporaryMemory;
+    /// Per-frame memory that is valid until the beginning of the next frame
+    FrameArena TemporaryMemory;
+
+private:
+    properties::IntProperty _temporaryMemorySize;
+    properties::IntProperty _temporaryMemoryUsage;
+    properties::IntProperty _temporaryMemoryHighWaterMark;
+    properties::IntProperty _temporaryMemoryOverflows;
 };
 
 } // namespace openspace
@@ -25,13 +25,19 @@
 #ifndef __OPENSPACE_CORE___SPICEMANAGER___H__
 #define __OPENSPACE_CORE___SPICEMANAGER___H__
 
+#include <openspace/util/ephemeriscache.h>
+
 #include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/boolean.h>
 #include <ghoul/misc/exception.h>
 #include <array>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 #include <set>
@@ -845,6 +851,88 @@ public:
         const std::string& destinationFrame, double ephemerisTimeFrom,
         double ephemerisTimeTo) const;
 
+    /**
+     * Returns the position of the \p target relative to the \p observer in the
+     * \p referenceFrame without any aberration correction. If the ephemeris cache is
+     * enabled, the position is interpolated from cached samples of the state of the
+     * \p target. If the cache is disabled or no samples are available at the
+     * \p ephemerisTime, the result of #targetPosition is returned instead.
+     *
+     * Contrary to the other methods of this class, this method can be called from
+     * multiple threads concurrently, as all accesses to SPICE are serialized.
+     *
+     * \param target The target body name or the target body's NAIF ID
+     * \param observer The observing body name or the observing body's NAIF ID
+     * \param referenceFrame The reference frame of the output position vector
+     * \param ephemerisTime The time at which the position is to be queried
+     * \return The position of the \p target relative to the \p observer in the
+     *         specified \p referenceFrame
+     *
+     * \throw SpiceException If the position could not be retrieved from the cache and
+     *        #targetPosition throws an exception
+     * \pre \p target must not be empty.
+     * \pre \p observer must not be empty.
+     * \pre \p referenceFrame must not be empty.
+     */
+    glm::dvec3 cachedTargetPosition(const std::string& target,
+        const std::string& observer, const std::string& referenceFrame,
+        double ephemerisTime) const;
+
+    /**
+     * Returns the matrix that transforms position vectors from the \p sourceFrame to the
+     * \p destinationFrame at the \p ephemerisTime. If the ephemeris cache is enabled,
+     * the matrix is interpolated from cached samples of the orientation. Otherwise or if
+     * no samples are available, the result of #positionTransformMatrix is returned. This
+     * method can be called from multiple threads concurrently.
+     *
+     * \param sourceFrame The name of the source reference frame
+     * \param destinationFrame The name of the destination reference frame
+     * \param ephemerisTime The time at which the transformation matrix is to be queried
+     * \return The transformation matrix that defines the transformation from the
+     *         \p sourceFrame to the \p destinationFrame
+     *
+     * \throw SpiceException If the matrix could not be retrieved from the cache and
+     *        #positionTransformMatrix throws an exception
+     * \pre \p sourceFrame must not be empty
+     * \pre \p destinationFrame must not be empty
+     */
+    glm::dmat3 cachedPositionTransformMatrix(const std::string& sourceFrame,
+        const std::string& destinationFrame, double ephemerisTime) const;
+
+    /// The settings that control the #cachedTargetPosition and
+    /// #cachedPositionTransformMatrix methods
+    struct EphemerisCacheSettings {
+        /// If this is \c false, the cached methods always call SPICE directly
+        bool isEnabled = true;
+        /// The maximum interpolation error of positions in km
+        double positionTolerance = 1e-3;
+        /// The maximum interpolation error of rotations in radians
+        double rotationTolerance = 1e-7;
+    };
+
+    /**
+     * Sets new settings for the ephemeris cache. If the tolerances changed, all cached
+     * samples are discarded.
+     *
+     * \param settings The new settings for the ephemeris cache
+     * \pre The tolerances of \p settings must be positive
+     */
+    void setEphemerisCacheSettings(EphemerisCacheSettings settings);
+
+    /**
+     * Samples the positions and rotations that were requested through the cached methods
+     * since the last call for the times following \p ephemerisTime, assuming that time
+     * keeps changing by \p deltaTime per frame. This should be called once per frame
+     * from the main thread before the scene is updated.
+     *
+     * \param ephemerisTime The current time
+     * \param deltaTime The change of time between the last frame and the current frame
+     */
+    void prefetchEphemerides(double ephemerisTime, double deltaTime);
+
+    /// Discards all cached samples of positions and rotations
+    void clearEphemerisCache();
+
     /// The structure returned by the #fieldOfView methods
     struct FieldOfViewResult {
         /// The rough shape of the returned field of view
@@ -1072,6 +1160,14 @@ private:
     glm::dmat3 getEstimatedTransformMatrix(const std::string& fromFrame,
         const std::string& toFrame, double time) const;
 
+    /**
+     * Returns the EphemerisCache for the position of \p from relative to \p to in the
+     * \p frame or for the rotation from the frame \p from to the frame \p to. The
+     * cache is created if it does not exist yet.
+     */
+    EphemerisCache& ephemerisCache(EphemerisCache::Type type, const std::string& from,
+        const std::string& to, const std::string& frame) const;
+
     /// A list of all loaded kernels
     std::vector<KernelInformation> _loadedKernels;
 
@@ -1087,6 +1183,17 @@ private:
     /// The last assigned kernel-id, used to determine the next free kernel id
     KernelHandle _lastAssignedKernel = KernelHandle(0);
 
+    /// Serializes the calls into SPICE that are made from the cached methods and the
+    /// loading and unloading of kernels, as SPICE is not thread-safe
+    mutable std::mutex _spiceMutex;
+
+    /// Protects the _ephemerisCaches map and the tolerances in _ephemerisCacheSettings
+    mutable std::shared_mutex _ephemerisCacheMutex;
+    /// The ephemeris caches for each combination of bodies and frames that were used
+    mutable std::map<std::string, std::unique_ptr<EphemerisCache>> _ephemerisCaches;
+    EphemerisCacheSettings _ephemerisCacheSettings;
+    std::atomic_bool _isEphemerisCacheEnabled = true;
+
     static SpiceManager* _instance;
 };
 
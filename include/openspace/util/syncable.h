@@ -44,6 +44,13 @@ protected:
     friend class SyncEngine;
 
     virtual void preSync(bool /*isMaster*/) {};
+
+    /**
+     * Returns whether this Syncable has to be encoded in the current frame. Syncables
+     * that are not dirty are skipped by the SyncEngine and are not decoded on the other
+     * nodes either, which therefore keep the state they received last
+     */
+    virtual bool isDirty() { return true; };
     virtual void encode(SyncBuffer* /*syncBuffer*/) = 0;
     virtual void decode(SyncBuffer* /*syncBuffer*/) = 0;
     virtual void postSync(bool /*isMaster*/) {};
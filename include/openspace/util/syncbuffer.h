@@ -34,6 +34,15 @@ namespace openspace {
 
 class SyncBuffer {
 public:
+    /**
+     * A non-owning view of the bytes that were encoded into a SyncBuffer or that are
+     * decoded from it.
+     */
+    struct View {
+        const std::byte* data = nullptr;
+        size_t size = 0;
+    };
+
     SyncBuffer(size_t n);
 
     ~SyncBuffer();
@@ -57,19 +66,34 @@ public:
     template <typename T>
     void decode(T& value);
 
+    /**
+     * Resets the encoding and decoding positions to the beginning. The memory that was
+     * allocated for encoding is kept, so that a buffer that is reused every frame does
+     * not allocate once it has grown to the size of the largest frame.
+     */
     void reset();
 
-    //void write();
-    //void read();
+    /**
+     * Sets the data that is decoded by the following calls to decode. The data is not
+     * copied, so it has to stay valid until the next call to #reset.
+     */
+    void setData(View data);
 
-    void setData(std::vector<std::byte> data);
-    std::vector<std::byte> data();
+    /**
+     * Returns the bytes that have been encoded since the last call to #reset. The view
+     * is valid until the next call to encode or #reset.
+     */
+    View encodedData() const;
 
 private:
+    /// Grows the encoding storage so that \p size more bytes fit behind the offset
+    void ensureCapacity(size_t size);
+
     size_t _n;
     size_t _encodeOffset = 0;
     size_t _decodeOffset = 0;
     std::vector<std::byte> _dataStream;
+    View _decodeData;
 };
 
 } // namespace openspace
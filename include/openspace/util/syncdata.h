@@ -76,12 +76,15 @@ public:
     const T& data() const;
 
 protected:
+    virtual bool isDirty() override;
     virtual void encode(SyncBuffer* syncBuffer) override;
     virtual void decode(SyncBuffer* syncBuffer) override;
     virtual void postSync(bool isMaster) override;
 
     T _data;
     T _doubleBufferedData;
+    T _lastEncodedData;
+    bool _hasEncodedData = false;
     std::mutex _mutex;
 };
 
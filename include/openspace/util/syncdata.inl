@@ -23,6 +23,8 @@
  ****************************************************************************************/
 
 #include <openspace/util/syncbuffer.h>
+#include <cstring>
+#include <type_traits>
 
 namespace openspace {
 
@@ -58,10 +60,28 @@ const T& SyncData<T>::data() const {
     return _data;
 }
 
+template<class T>
+bool SyncData<T>::isDirty() {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        // The data is encoded as its raw bytes, so comparing those is exactly the test
+        // whether the other nodes would receive something different from last time
+        _mutex.lock();
+        const bool isDirty = !_hasEncodedData ||
+            std::memcmp(&_data, &_lastEncodedData, sizeof(T)) != 0;
+        _mutex.unlock();
+        return isDirty;
+    }
+    else {
+        return true;
+    }
+}
+
 template<class T>
 void SyncData<T>::encode(SyncBuffer* syncBuffer) {
     _mutex.lock();
     syncBuffer->encode(_data);
+    _lastEncodedData = _data;
+    _hasEncodedData = true;
     _mutex.unlock();
 }
 
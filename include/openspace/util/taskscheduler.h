@@ -0,0 +1,200 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___TASKSCHEDULER___H__
+#define __OPENSPACE_CORE___TASKSCHEDULER___H__
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * The TaskScheduler is the process-wide executor for CPU and IO work. It owns a fixed
+ * number of worker threads, each of which has its own deque of tasks per priority level.
+ * A worker pushes and pops tasks that it spawns itself at the back of its own deque
+ * (LIFO, which keeps the working set hot in its cache), while idle workers steal tasks
+ * from the front of the other workers' deques. Tasks that are submitted from a thread
+ * that is not part of the scheduler are distributed round-robin across the workers.
+ *
+ * Higher priority tasks are always picked before lower priority tasks, first from the
+ * worker's own deque and then from the other workers. Priority::Low is meant for long
+ * running background computations and is only ever executed by the worker threads
+ * themselves. Fork/join parallelism is provided by the TaskGroup class and the
+ * #parallelFor function.
+ *
+ * All work that might block, such as file or network IO, has to be enqueued with
+ * Priority::IO. These tasks form a separate lane that is executed in FIFO order by a
+ * second set of IO threads owned by the scheduler. Neither the workers nor threads that
+ * help out in #runPendingTask or TaskGroup::wait ever execute an IO task, so a blocking
+ * call can never stall a frame that waits on compute work. This is the only place in
+ * which threads for blocking work are created; components that need to limit or order
+ * their IO, such as the ThreadPool, do so on top of this lane rather than owning threads.
+ */
+class TaskScheduler {
+public:
+    enum class Priority {
+        High = 0,
+        Normal,
+        Low,
+        IO
+    };
+    /// The number of priority levels of compute tasks, which excludes Priority::IO
+    static constexpr const int NumPriorities = 3;
+
+    /**
+     * Creates the scheduler and starts \p nThreads worker threads and \p nIoThreads IO
+     * threads. If \p nThreads is 0, one worker per hardware thread is started. If
+     * \p nIoThreads is 0, twice as many IO threads as workers are started, as they spend
+     * most of their time waiting.
+     */
+    explicit TaskScheduler(unsigned int nThreads = 0, unsigned int nIoThreads = 0);
+
+    /**
+     * Stops all workers and IO threads. Tasks that have not started executing yet are
+     * discarded, tasks that are currently executing are finished before the destructor
+     * returns.
+     */
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * Enqueues the \p task with the provided \p priority. If this function is called from
+     * one of the worker threads, the task is placed in that worker's deque, otherwise the
+     * workers are used in a round-robin fashion. Tasks with Priority::IO are placed in
+     * the queue of the IO threads instead.
+     */
+    void enqueue(std::function<void()> task, Priority priority = Priority::Normal);
+
+    /**
+     * Executes one pending task on the calling thread, if there is any with a priority
+     * of at least \p lowestPriority. This is used by threads that are waiting for other
+     * tasks to finish so that they can help out rather than block. Threads that are not
+     * workers of this scheduler never execute tasks with Priority::Low, as these might
+     * run for a long time. Tasks with Priority::IO are never executed by this function.
+     *
+     * \return \c true if a task was executed, \c false if there was no pending task
+     */
+    bool runPendingTask(Priority lowestPriority = Priority::Normal);
+
+    /**
+     * Executes \p function for all indices in the range [\p begin, \p end) in parallel,
+     * split into chunks of at most \p grainSize indices. The function returns when all
+     * indices have been processed. The calling thread participates in the work.
+     */
+    template <typename Func>
+    void parallelFor(size_t begin, size_t end, size_t grainSize, Func&& function);
+
+    /// Returns the number of worker threads of this scheduler
+    unsigned int numThreads() const;
+
+    /// Returns the number of threads that execute the tasks with Priority::IO
+    unsigned int numIoThreads() const;
+
+    /// Returns the number of tasks that are currently waiting to be executed
+    size_t numPendingTasks() const;
+
+    /// Returns the number of tasks that were executed by a worker other than the one that
+    /// the task was initially assigned to
+    size_t numStolenTasks() const;
+
+    /// Returns the index of the worker that is executing the calling thread or -1 if the
+    /// calling thread is not a worker thread of this scheduler
+    int currentWorkerIndex() const;
+
+private:
+    struct Worker {
+        std::array<std::deque<std::function<void()>>, NumPriorities> tasks;
+        std::mutex mutex;
+        std::thread thread;
+    };
+
+    void workerLoop(int index);
+    void ioLoop();
+    bool popTask(int index, std::function<void()>& task, int lowestPriority);
+    bool stealTask(int thief, std::function<void()>& task, int lowestPriority);
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::atomic<unsigned int> _nextWorker = 0;
+    std::atomic<size_t> _nPendingTasks = 0;
+    std::atomic<size_t> _nStolenTasks = 0;
+    std::atomic<int> _nSleepingWorkers = 0;
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeUp;
+    std::atomic_bool _shouldStop = false;
+
+    std::vector<std::thread> _ioThreads;
+    std::deque<std::function<void()>> _ioTasks;
+    std::atomic<size_t> _nPendingIoTasks = 0;
+    std::mutex _ioMutex;
+    std::condition_variable _ioWakeUp;
+};
+
+/**
+ * A TaskGroup collects a number of tasks that are executed on a TaskScheduler and
+ * provides the join point for them. Calling #wait will block until all tasks that were
+ * added to this group have finished, executing other pending tasks that are at least as
+ * important as the group's tasks on the calling thread in the meantime. If a task throws
+ * an exception, the first exception is rethrown from #wait. The destructor waits for all
+ * outstanding tasks, so that tasks can safely refer to variables that have the same
+ * lifetime as the group.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler,
+        TaskScheduler::Priority priority = TaskScheduler::Priority::Normal);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    TaskScheduler& _scheduler;
+    const TaskScheduler::Priority _priority;
+
+    std::atomic<int> _nPendingTasks = 0;
+    std::mutex _mutex;
+    std::condition_variable _finished;
+    std::exception_ptr _exception;
+};
+
+} // namespace openspace
+
+#include "taskscheduler.inl"
+
+#endif // __OPENSPACE_CORE___TASKSCHEDULER___H__
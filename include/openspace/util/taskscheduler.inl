@@ -0,0 +1,62 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <algorithm>
+
+namespace openspace {
+
+template <typename Func>
+void TaskScheduler::parallelFor(size_t begin, size_t end, size_t grainSize,
+                                Func&& function)
+{
+    if (begin >= end) {
+        return;
+    }
+    grainSize = std::max<size_t>(grainSize, 1);
+
+    if (end - begin <= grainSize) {
+        for (size_t i = begin; i < end; ++i) {
+            function(i);
+        }
+        return;
+    }
+
+    TaskGroup group(*this);
+    // The first chunk is kept for the calling thread so that it does not idle
+    for (size_t chunkBegin = begin + grainSize; chunkBegin < end; chunkBegin += grainSize)
+    {
+        const size_t chunkEnd = std::min(chunkBegin + grainSize, end);
+        group.run([&function, chunkBegin, chunkEnd]() {
+            for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                function(i);
+            }
+        });
+    }
+    for (size_t i = begin; i < begin + grainSize; ++i) {
+        function(i);
+    }
+    group.wait();
+}
+
+} // namespace openspace
@@ -25,31 +25,30 @@
 #ifndef __OPENSPACE_CORE___THREAD_POOL___H__
 #define __OPENSPACE_CORE___THREAD_POOL___H__
 
+#include <openspace/util/taskscheduler.h>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <queue>
-#include <thread>
-#include <vector>
-
-// Implementation based on http://progsch.net/wordpress/?p=81
 
 namespace openspace {
 
-class ThreadPool;
-
-class Worker {
-public:
-    Worker(ThreadPool& p);
-    void operator()();
-
-private:
-    ThreadPool& pool;
-};
-
+/**
+ * A ThreadPool is a queue of tasks that are executed on the process-wide TaskScheduler
+ * with at most \c numThreads of them running at the same time. It does not own any
+ * threads itself, so creating many pools does not oversubscribe the machine. With a
+ * concurrency of 1, the tasks are executed in the order in which they were enqueued.
+ * Pools whose tasks might block on file or network IO have to be created with
+ * TaskScheduler::Priority::IO so that their tasks run on the IO threads of the scheduler.
+ *
+ * The destructor waits for the tasks that are currently running, so a pool must not be
+ * destroyed from within one of its own tasks.
+ */
 class ThreadPool {
 public:
-    ThreadPool(size_t numThreads);
+    ThreadPool(size_t numThreads,
+        TaskScheduler::Priority priority = TaskScheduler::Priority::Normal);
     ThreadPool(const ThreadPool& toCopy);
     ~ThreadPool();
 
@@ -57,16 +56,21 @@ public:
     void clearTasks();
 
 private:
-    friend class Worker;
-
-    std::vector<std::thread> workers;
+    // The state is shared with the tasks that are in flight on the scheduler
+    struct State {
+        std::deque<std::function<void()>> tasks;
+        size_t nRunning = 0;
+        bool stop = false;
+        TaskScheduler::Priority priority = TaskScheduler::Priority::Normal;
 
-    std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable idle;
+    };
 
-    std::mutex queue_mutex;
-    std::condition_variable condition;
+    static void runNext(std::shared_ptr<State> state);
 
-    bool stop;
+    size_t _maxConcurrency;
+    std::shared_ptr<State> _state;
 };
 
 } // namespace openspace
@@ -26,6 +26,7 @@
 #define __OPENSPACE_CORE___UPDATESTRUCTURES___H__
 
 #include <openspace/camera/camera.h>
+#include <openspace/util/framearena.h>
 #include <openspace/util/time.h>
 
 namespace openspace {
@@ -64,9 +65,14 @@ struct DeferredcasterTask {
     RenderData renderData;
 };
 
+/**
+ * The tasks that are collected while rendering the scene and that are executed after all
+ * renderables have been drawn. As these lists are recreated every frame, the renderer
+ * allocates them from the per-frame temporary memory.
+ */
 struct RendererTasks {
-    std::vector<RaycasterTask> raycasterTasks;
-    std::vector<DeferredcasterTask> deferredcasterTasks;
+    FrameVector<RaycasterTask> raycasterTasks;
+    FrameVector<DeferredcasterTask> deferredcasterTasks;
 };
 
 struct RaycastData {
@@ -27,6 +27,7 @@
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
 #include <openspace/engine/globals.h>
+#include <openspace/util/memorymanager.h>
 #include <openspace/util/spicemanager.h>
 #include <openspace/util/timemanager.h>
 #include <ghoul/font/font.h>
@@ -34,6 +35,7 @@
 #include <ghoul/font/fontrenderer.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/profiling.h>
+#include <iterator>
 
 namespace {
     constexpr openspace::properties::Property::PropertyInfo FormatStringInfo = {
@@ -91,7 +93,9 @@ void DashboardItemDate::render(glm::vec2& penPosition) {
     );
 
     try {
-        RenderFont(*_font, penPosition, fmt::format(_formatString.value().c_str(), time));
+        FrameString text(global::memoryManager->TemporaryMemory.allocator());
+        fmt::format_to(std::back_inserter(text), _formatString.value().c_str(), time);
+        RenderFont(*_font, penPosition, text);
     }
     catch (const fmt::format_error&) {
         LERRORC("DashboardItemDate", "Illegal format string");
@@ -103,7 +107,9 @@ glm::vec2 DashboardItemDate::size() const {
     ZoneScoped
 
     std::string_view time = global::timeManager->time().UTC();
-    return _font->boundingBox(fmt::format(_formatString.value().c_str(), time));
+    FrameString text(global::memoryManager->TemporaryMemory.allocator());
+    fmt::format_to(std::back_inserter(text), _formatString.value().c_str(), time);
+    return _font->boundingBox(text);
 }
 
 } // namespace openspace
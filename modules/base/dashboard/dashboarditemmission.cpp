@@ -29,16 +29,21 @@
 #include <openspace/engine/globals.h>
 #include <openspace/mission/mission.h>
 #include <openspace/mission/missionmanager.h>
+#include <openspace/util/memorymanager.h>
 #include <openspace/util/timemanager.h>
 #include <ghoul/font/font.h>
 #include <ghoul/font/fontmanager.h>
 #include <ghoul/font/fontrenderer.h>
 #include <ghoul/misc/profiling.h>
+#include <iterator>
 #include <stack>
 
 namespace {
-    std::string progressToStr(int size, double t) {
-        std::string progress = "|";
+    openspace::FrameString progressToStr(int size, double t) {
+        openspace::FrameString progress(
+            "|",
+            openspace::global::memoryManager->TemporaryMemory.allocator()
+        );
         int g = static_cast<int>((t * (size - 1)) + 1);
         g = std::max(g, 0);
         for (int i = 0; i < g; i++) {
@@ -95,33 +100,34 @@ void DashboardItemMission::render(glm::vec2& penPosition) {
 
     if (!phaseTrace.empty()) {
         const MissionPhase& phase = phaseTrace.back().get();
-        const std::string title = "Current Mission Phase: " + phase.name();
+        FrameString title(
+            "Current Mission Phase: ",
+            global::memoryManager->TemporaryMemory.allocator()
+        );
+        title.append(phase.name());
         penPosition.y -= _font->height();
         RenderFont(*_font, penPosition, title, missionProgressColor);
         double remaining = phase.timeRange().end - currentTime;
         float t = static_cast<float>(
             1.0 - remaining / phase.timeRange().duration()
         );
-        std::string progress = progressToStr(25, t);
-        penPosition.y -= _font->height();
-        RenderFont(
-            *_font,
-            penPosition,
-            fmt::format("{:.0f} s {:s} {:.1f} %", remaining, progress, t * 100),
-            missionProgressColor
+        FrameString progress = progressToStr(25, t);
+        FrameString text(global::memoryManager->TemporaryMemory.allocator());
+        fmt::format_to(
+            std::back_inserter(text),
+            "{:.0f} s {:s} {:.1f} %", remaining, std::string_view(progress), t * 100
         );
+        penPosition.y -= _font->height();
+        RenderFont(*_font, penPosition, text, missionProgressColor);
     }
     else {
         penPosition.y -= _font->height();
         RenderFont(*_font, penPosition, "Next Mission:", nextMissionColor);
         const double remaining = mission.timeRange().start - currentTime;
         penPosition.y -= _font->height();
-        RenderFont(
-            *_font,
-            penPosition,
-            fmt::format("{:.0f} s", remaining),
-            nextMissionColor
-        );
+        FrameString text(global::memoryManager->TemporaryMemory.allocator());
+        fmt::format_to(std::back_inserter(text), "{:.0f} s", remaining);
+        RenderFont(*_font, penPosition, text, nextMissionColor);
     }
 
     bool showAllPhases = false;
@@ -144,16 +150,13 @@ void DashboardItemMission::render(glm::vec2& penPosition) {
             const float t = static_cast<float>(
                 1.0 - remaining / phase->timeRange().duration()
             );
-            const std::string progress = progressToStr(25, t);
-            RenderFont(
-                *_font,
-                penPosition,
-                fmt::format(
-                    "{:s}  {:s} {:.1f} %",
-                    phase->name(),progress,t * 100
-                ),
-                currentMissionColor
+            const FrameString progress = progressToStr(25, t);
+            FrameString text(global::memoryManager->TemporaryMemory.allocator());
+            fmt::format_to(
+                std::back_inserter(text),
+                "{:s}  {:s} {:.1f} %", phase->name(), std::string_view(progress), t * 100
             );
+            RenderFont(*_font, penPosition, text, currentMissionColor);
             penPosition.y -= _font->height();
         }
         else {
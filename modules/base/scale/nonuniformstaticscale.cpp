@@ -69,4 +69,8 @@ NonUniformStaticScale::NonUniformStaticScale(const ghoul::Dictionary& dictionary
     _scaleValue = p.scale;
 }
 
+bool NonUniformStaticScale::isThreadSafe() const {
+    return true;
+}
+
 } // namespace openspace
@@ -73,4 +73,8 @@ glm::dvec3 StaticTranslation::position(const UpdateData&) const {
     return _position;
 }
 
+bool StaticTranslation::isThreadSafe() const {
+    return true;
+}
+
 } // namespace openspace
@@ -528,12 +528,16 @@ RenderableBillboardsCloud::RenderableBillboardsCloud(const ghoul::Dictionary& di
         const int colorMapInUse =
             _hasColorMapFile ? _dataset.index(_colorOptionString) : 0;
 
+        const float* colors = _dataset.column(colorMapInUse);
+        if (!colors) {
+            return;
+        }
+
         float minValue = std::numeric_limits<float>::max();
         float maxValue = -std::numeric_limits<float>::max();
-        for (const speck::Dataset::Entry& e : _dataset.entries) {
-            float color = e.data[colorMapInUse];
-            minValue = std::min(minValue, color);
-            maxValue = std::max(maxValue, color);
+        for (size_t i = 0; i < _dataset.nEntries(); i++) {
+            minValue = std::min(minValue, colors[i]);
+            maxValue = std::max(maxValue, colors[i]);
         }
 
         _optionColorRangeData = glm::vec2(minValue, maxValue);
@@ -546,14 +550,14 @@ RenderableBillboardsCloud::RenderableBillboardsCloud(const ghoul::Dictionary& di
 }
 
 bool RenderableBillboardsCloud::isReady() const {
-    return (_program && (!_dataset.entries.empty())) || (!_labelset.entries.empty());
+    return (_program && (_dataset.nEntries() > 0)) || (!_labelset.entries.empty());
 }
 
 void RenderableBillboardsCloud::initialize() {
     ZoneScoped
 
     if (_hasSpeckFile) {
-        _dataset = speck::data::loadFileWithCache(_speckFile);
+        _dataset = speck::data::loadColumnarFileWithCache(_speckFile);
     }
 
     if (_hasColorMapFile) {
@@ -717,7 +721,7 @@ void RenderableBillboardsCloud::renderBillboards(const RenderData& data,
     _program->setUniform(_uniformCache.hasColormap, _hasColorMapFile);
 
     glBindVertexArray(_vao);
-    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(_dataset.entries.size()));
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(_dataset.nEntries()));
     glBindVertexArray(0);
     _program->deactivate();
 
@@ -961,16 +965,16 @@ void RenderableBillboardsCloud::update(const UpdateData&) {
 std::vector<float> RenderableBillboardsCloud::createDataSlice() {
     ZoneScoped
 
-    if (_dataset.entries.empty()) {
+    if (_dataset.nEntries() == 0) {
         return std::vector<float>();
     }
 
     std::vector<float> result;
     if (_hasColorMapFile) {
-        result.reserve(8 * _dataset.entries.size());
+        result.reserve(8 * _dataset.nEntries());
     }
     else {
-        result.reserve(4 * _dataset.entries.size());
+        result.reserve(4 * _dataset.nEntries());
     }
 
     // what datavar in use for the index color
@@ -980,25 +984,30 @@ std::vector<float> RenderableBillboardsCloud::createDataSlice() {
     int sizeScalingInUse =
         _hasDatavarSize ? _dataset.index(_datavarSizeOptionString) : -1;
 
+    // The slice is built directly from the columns of the dataset
+    const glm::vec3* positions = _dataset.positions();
+    const float* colors = _dataset.column(colorMapInUse);
+    const float* sizes = _dataset.column(sizeScalingInUse);
+
     float minColorIdx = std::numeric_limits<float>::max();
     float maxColorIdx = -std::numeric_limits<float>::max();
-    for (const speck::Dataset::Entry& e : _dataset.entries) {
-        if (e.data.size() > 0) {
-            float color = e.data[colorMapInUse];
-            minColorIdx = std::min(color, minColorIdx);
-            maxColorIdx = std::max(color, maxColorIdx);
-        } else {
-            minColorIdx = 0;
-            maxColorIdx = 0;
+    if (colors) {
+        for (size_t i = 0; i < _dataset.nEntries(); i++) {
+            minColorIdx = std::min(colors[i], minColorIdx);
+            maxColorIdx = std::max(colors[i], maxColorIdx);
         }
     }
+    else {
+        minColorIdx = 0;
+        maxColorIdx = 0;
+    }
 
     double maxRadius = 0.0;
 
     float biggestCoord = -1.f;
-    for (const speck::Dataset::Entry& e : _dataset.entries) {
+    for (size_t i = 0; i < _dataset.nEntries(); i++) {
         glm::vec3 transformedPos = glm::vec3(_transformationMatrix * glm::vec4(
-            e.position, 1.0
+            positions[i], 1.0
         ));
 
         float unitValue = 0.f;
@@ -1043,7 +1052,7 @@ std::vector<float> RenderableBillboardsCloud::createDataSlice() {
             biggestCoord = std::max(biggestCoord, glm::compMax(position));
             // Note: if exact colormap option is not selected, the first color and the
             // last color in the colormap file are the outliers colors.
-            float variableColor = e.data[colorMapInUse];
+            float variableColor = colors ? colors[i] : 0.f;
 
             float cmax, cmin;
             if (_colorRangeData.empty()) {
@@ -1103,11 +1112,11 @@ std::vector<float> RenderableBillboardsCloud::createDataSlice() {
             }
 
             if (_hasDatavarSize) {
-                result.push_back(e.data[sizeScalingInUse]);
+                result.push_back(sizes ? sizes[i] : 0.f);
             }
         }
         else if (_hasDatavarSize) {
-            result.push_back(e.data[sizeScalingInUse]);
+            result.push_back(sizes ? sizes[i] : 0.f);
             for (int j = 0; j < 4; ++j) {
                 result.push_back(position[j]);
             }
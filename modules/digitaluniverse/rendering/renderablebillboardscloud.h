@@ -141,7 +141,7 @@ private:
 
     DistanceUnit _unit = DistanceUnit::Parsec;
 
-    speck::Dataset _dataset;
+    speck::ColumnarDataset _dataset;
     speck::Labelset _labelset;
     speck::ColorMap _colorMap;
 
@@ -0,0 +1,206 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/gaia/rendering/nodeioscheduler.h>
+
+#include <openspace/engine/globals.h>
+#include <openspace/util/taskscheduler.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <exception>
+
+namespace {
+    constexpr const char* _loggerCat = "NodeIoScheduler";
+} // namespace
+
+namespace openspace {
+
+bool NodeIoScheduler::QueueEntry::operator<(const QueueEntry& rhs) const {
+    // std::priority_queue keeps the largest element on top, but the request with the
+    // smallest priority value should be executed first
+    return priority > rhs.priority;
+}
+
+NodeIoScheduler::NodeIoScheduler(unsigned int nThreads)
+    : _maxConcurrency(nThreads)
+{
+    ghoul_assert(nThreads > 0, "Need at least one concurrent request");
+    ghoul_assert(global::taskScheduler, "No task scheduler");
+}
+
+NodeIoScheduler::~NodeIoScheduler() {
+    // The requests that are executing might refer to the owner of the scheduler
+    std::unique_lock lock(_mutex);
+    _shouldStop = true;
+    _pending.clear();
+    _queue = std::priority_queue<QueueEntry>();
+    _isIdle.wait(lock, [this]() { return _nRunning == 0; });
+}
+
+void NodeIoScheduler::enqueue(unsigned long long key, double priority, Request request) {
+    {
+        std::lock_guard lock(_mutex);
+        auto it = _pending.find(key);
+        if (it != _pending.end()) {
+            PendingRequest& pending = it->second;
+            pending.pass = _currentPass;
+            _stats.nCoalesced++;
+            if (priority >= pending.priority) {
+                return;
+            }
+
+            // The old queue entry becomes outdated with the new version
+            pending.priority = priority;
+            pending.version = _nextVersion++;
+            _queue.push({ priority, key, pending.version });
+            return;
+        }
+
+        const unsigned int version = _nextVersion++;
+        _pending[key] = { std::move(request), priority, _currentPass, version };
+        _queue.push({ priority, key, version });
+
+        if (_nRunning >= _maxConcurrency) {
+            // One of the running tasks picks up the request once it is done
+            return;
+        }
+        _nRunning++;
+    }
+
+    global::taskScheduler->enqueue([this]() { runNext(); }, TaskScheduler::Priority::IO);
+}
+
+void NodeIoScheduler::beginPass() {
+    std::lock_guard lock(_mutex);
+    _currentPass++;
+}
+
+size_t NodeIoScheduler::cancelStaleRequests() {
+    std::lock_guard lock(_mutex);
+    size_t nCancelled = 0;
+    for (auto it = _pending.begin(); it != _pending.end();) {
+        if (it->second.pass != _currentPass) {
+            it = _pending.erase(it);
+            nCancelled++;
+        }
+        else {
+            ++it;
+        }
+    }
+    _stats.nCancelled += nCancelled;
+
+    // Don't let the outdated entries pile up in the queue if many requests are dropped
+    if (_queue.size() > 2 * _pending.size() + 64) {
+        std::vector<QueueEntry> entries;
+        entries.reserve(_pending.size());
+        for (const std::pair<const unsigned long long, PendingRequest>& p : _pending) {
+            entries.push_back({ p.second.priority, p.first, p.second.version });
+        }
+        _queue = std::priority_queue<QueueEntry>(
+            std::less<QueueEntry>(),
+            std::move(entries)
+        );
+    }
+
+    if (_pending.empty() && _nInFlight == 0) {
+        _isIdle.notify_all();
+    }
+    return nCancelled;
+}
+
+void NodeIoScheduler::cancelAll() {
+    std::lock_guard lock(_mutex);
+    _stats.nCancelled += _pending.size();
+    _pending.clear();
+    _queue = std::priority_queue<QueueEntry>();
+    if (_nInFlight == 0) {
+        _isIdle.notify_all();
+    }
+}
+
+void NodeIoScheduler::waitUntilIdle() {
+    std::unique_lock lock(_mutex);
+    _isIdle.wait(lock, [this]() { return _pending.empty() && _nInFlight == 0; });
+}
+
+NodeIoScheduler::Stats NodeIoScheduler::stats() const {
+    std::lock_guard lock(_mutex);
+    Stats res = _stats;
+    res.nQueued = _pending.size();
+    res.nInFlight = _nInFlight;
+    return res;
+}
+
+void NodeIoScheduler::runNext() {
+    std::unique_lock lock(_mutex);
+
+    // Skip the entries of requests that were cancelled or got a new priority
+    auto it = _pending.end();
+    QueueEntry entry;
+    while (!_shouldStop && !_pending.empty() && it == _pending.end()) {
+        entry = _queue.top();
+        _queue.pop();
+        it = _pending.find(entry.key);
+        if (it != _pending.end() && it->second.version != entry.version) {
+            it = _pending.end();
+        }
+    }
+
+    if (it == _pending.end()) {
+        // The notification has to happen under the lock as the scheduler might be
+        // destroyed as soon as the destructor sees that nothing is running anymore
+        _nRunning--;
+        _isIdle.notify_all();
+        return;
+    }
+
+    Request request = std::move(it->second.request);
+    _pending.erase(it);
+    _nInFlight++;
+
+    lock.unlock();
+    size_t nBytes = 0;
+    try {
+        nBytes = request();
+    }
+    catch (const std::exception& e) {
+        LERROR(fmt::format("Error loading node {}: {}", entry.key, e.what()));
+    }
+    lock.lock();
+
+    _nInFlight--;
+    _stats.nCompleted++;
+    _stats.bytesRead += nBytes;
+    if (_pending.empty() && _nInFlight == 0) {
+        _isIdle.notify_all();
+    }
+    lock.unlock();
+
+    // Instead of looping here, the continuation is handed back to the scheduler so that
+    // the other users of the IO threads get their turn
+    global::taskScheduler->enqueue([this]() { runNext(); }, TaskScheduler::Priority::IO);
+}
+
+} // namespace openspace
@@ -0,0 +1,154 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GAIA___NODEIOSCHEDULER___H__
+#define __OPENSPACE_MODULE_GAIA___NODEIOSCHEDULER___H__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Executes the requests for loading octree nodes from disk on the IO threads of the
+ * global TaskScheduler (TaskScheduler::Priority::IO), with at most a fixed number of them
+ * executing at the same time. Pending requests are identified by the octree position
+ * index of the node, so requesting a node that is already waiting does not create a
+ * second request but only updates the priority of the existing one. Requests with a
+ * lower priority value are executed first.
+ *
+ * Requests are grouped into passes. All requests that were made before the latest call
+ * to #beginPass and have not been made again since then can be dropped with
+ * #cancelStaleRequests. Requests that are already executing are never interrupted.
+ */
+class NodeIoScheduler {
+public:
+    /// A request reads the data of one node and returns the number of bytes it read
+    using Request = std::function<size_t()>;
+
+    struct Stats {
+        /// The number of requests that are waiting to be executed
+        size_t nQueued = 0;
+        /// The number of requests that are currently executing
+        size_t nInFlight = 0;
+        /// The number of requests that have finished since the scheduler was created
+        size_t nCompleted = 0;
+        /// The number of requests that were dropped before they started executing
+        size_t nCancelled = 0;
+        /// The number of requests that were merged into an already waiting request
+        size_t nCoalesced = 0;
+        /// The total number of bytes read by all finished requests
+        size_t bytesRead = 0;
+    };
+
+    /**
+     * Creates a scheduler that executes at most \p nThreads requests at the same time.
+     */
+    explicit NodeIoScheduler(unsigned int nThreads);
+
+    /**
+     * Drops all waiting requests and waits for the executing requests to finish.
+     */
+    ~NodeIoScheduler();
+
+    NodeIoScheduler(const NodeIoScheduler&) = delete;
+    NodeIoScheduler& operator=(const NodeIoScheduler&) = delete;
+
+    /**
+     * Adds the \p request for the node with the octree position index \p key. If a
+     * request for the same key is already waiting, it is kept and assigned the lower of
+     * the two priorities, and it becomes part of the current pass.
+     */
+    void enqueue(unsigned long long key, double priority, Request request);
+
+    /**
+     * Starts a new pass of requests. See #cancelStaleRequests.
+     */
+    void beginPass();
+
+    /**
+     * Drops all waiting requests that have not been enqueued since the last call to
+     * #beginPass.
+     *
+     * \return The number of requests that were dropped
+     */
+    size_t cancelStaleRequests();
+
+    /**
+     * Drops all waiting requests.
+     */
+    void cancelAll();
+
+    /**
+     * Blocks until no request is waiting or executing anymore.
+     */
+    void waitUntilIdle();
+
+    Stats stats() const;
+
+private:
+    struct PendingRequest {
+        Request request;
+        double priority = 0.0;
+        unsigned int pass = 0;
+        // Identifies the newest entry for this request in the priority queue. Versions
+        // are never reused, so an entry of a dropped request can't match a new request
+        unsigned int version = 0;
+    };
+
+    struct QueueEntry {
+        double priority = 0.0;
+        unsigned long long key = 0;
+        unsigned int version = 0;
+
+        bool operator<(const QueueEntry& rhs) const;
+    };
+
+    void runNext();
+
+    // The priority queue can contain outdated entries for requests that were cancelled
+    // or whose priority has changed. They are skipped when they reach the top.
+    std::priority_queue<QueueEntry> _queue;
+    std::unordered_map<unsigned long long, PendingRequest> _pending;
+    unsigned int _currentPass = 0;
+    unsigned int _nextVersion = 0;
+    size_t _nInFlight = 0;
+    Stats _stats;
+
+    // The number of tasks on the TaskScheduler that execute the requests
+    const unsigned int _maxConcurrency;
+    unsigned int _nRunning = 0;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _isIdle;
+    bool _shouldStop = false;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_GAIA___NODEIOSCHEDULER___H__
@@ -26,7 +26,7 @@
 #define __OPENSPACE_MODULE_GAIA___OCTREECULLER___H__
 
 #include <modules/globebrowsing/src/basictypes.h>
-#include <vector>
+#include <array>
 
 // TODO: Move /geometry/* to libOpenSpace so as not to depend on globebrowsing.
 
@@ -53,19 +53,20 @@ public:
     /**
      * \return true if any part of the node is visible in the current view.
      */
-    bool isVisible(const std::vector<glm::dvec4>& corners, const glm::dmat4& mvp);
+    bool isVisible(const std::array<glm::dvec4, 8>& corners, const glm::dmat4& mvp);
 
     /**
      * \return the size [in pixels] of the node in clipping space.
      */
-    glm::vec2 getNodeSizeInPixels(const std::vector<glm::dvec4>& corners,
+    glm::vec2 getNodeSizeInPixels(const std::array<glm::dvec4, 8>& corners,
         const glm::dmat4& mvp, const glm::vec2& screenSize);
 
 private:
     /**
      * Creates an axis-aligned bounding box containing all \p corners in clipping space.
      */
-    void createNodeBounds(const std::vector<glm::dvec4>& corners, const glm::dmat4& mvp);
+    void createNodeBounds(const std::array<glm::dvec4, 8>& corners,
+        const glm::dmat4& mvp);
 
     const globebrowsing::AABB3 _viewFrustum;
     globebrowsing::AABB3 _nodeBounds;
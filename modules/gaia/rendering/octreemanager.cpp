@@ -29,31 +29,277 @@
 #include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <numeric>
 #include <thread>
 
+#ifdef WIN32
+#include <windows.h>
+#else // ^^^^ WIN32 // !WIN32 vvvv
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
 namespace {
     constexpr const char* _loggerCat = "OctreeManager";
+
+    // Capacity of the smallest slots in the star data arena
+    constexpr const size_t MinSlotStars = 64;
+
+    // Approximate size of the first page of every size class in the star data arena. The
+    // following pages of a size class double in size
+    constexpr const size_t FirstPageBytes = 1 << 20;
+
+    // Returns the page that contains the slot and the index of the slot in the page
+    std::pair<size_t, size_t> pageOfSlot(size_t slot, size_t firstPageSlots) {
+        size_t page = 0;
+        size_t pageSize = firstPageSlots;
+        while (slot >= pageSize) {
+            slot -= pageSize;
+            pageSize *= 2;
+            page++;
+        }
+        return { page, slot };
+    }
+
+    // Reading the node files is limited by the disk rather than the CPU, so a few
+    // concurrent reads are enough to keep the disk busy
+    constexpr const unsigned int MaxConcurrentReads = 4;
+
+    // Read-only memory mapping of a whole file. The mapping is empty if the file could
+    // not be opened or is empty
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path) {
+#ifdef WIN32
+            HANDLE file = CreateFileA(
+                path.c_str(),
+                GENERIC_READ,
+                FILE_SHARE_READ,
+                nullptr,
+                OPEN_EXISTING,
+                FILE_FLAG_SEQUENTIAL_SCAN,
+                nullptr
+            );
+            if (file == INVALID_HANDLE_VALUE) {
+                return;
+            }
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+                CloseHandle(file);
+                return;
+            }
+
+            HANDLE mapping = CreateFileMappingA(
+                file,
+                nullptr,
+                PAGE_READONLY,
+                0,
+                0,
+                nullptr
+            );
+            CloseHandle(file);
+            if (!mapping) {
+                return;
+            }
+
+            void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            // The view keeps a reference to the mapping, so we can close our handle here
+            CloseHandle(mapping);
+            if (!data) {
+                return;
+            }
+            _data = static_cast<const std::byte*>(data);
+            _size = static_cast<size_t>(fileSize.QuadPart);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+            const int file = open(path.c_str(), O_RDONLY);
+            if (file == -1) {
+                return;
+            }
+
+            struct stat fileStat;
+            if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+                close(file);
+                return;
+            }
+
+            const size_t size = static_cast<size_t>(fileStat.st_size);
+            void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+            // The mapping keeps a reference to the file, so we can close it here
+            close(file);
+            if (data == MAP_FAILED) {
+                return;
+            }
+            // The whole file is copied right away, so ask for all of it at once
+            madvise(data, size, MADV_WILLNEED);
+            _data = static_cast<const std::byte*>(data);
+            _size = size;
+#endif // WIN32
+        }
+
+        ~MappedFile() {
+            if (!_data) {
+                return;
+            }
+#ifdef WIN32
+            UnmapViewOfFile(_data);
+#else // ^^^^ WIN32 // !WIN32 vvvv
+            munmap(const_cast<std::byte*>(_data), _size);
+#endif // WIN32
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const std::byte* data() const {
+            return _data;
+        }
+
+        size_t size() const {
+            return _size;
+        }
+
+    private:
+        const std::byte* _data = nullptr;
+        size_t _size = 0;
+    };
+
+    // Squared distance from the point to the closest point of the axis aligned cube
+    float squaredDistanceToNode(const glm::vec3& p, const glm::vec3& origin,
+                                float halfDimension)
+    {
+        const glm::vec3 d = glm::max(
+            glm::abs(p - origin) - glm::vec3(halfDimension),
+            glm::vec3(0.f)
+        );
+        return d.x * d.x + d.y * d.y + d.z * d.z;
+    }
 } // namespace
 
 namespace openspace {
 
+OctreeManager::OctreeNode::OctreeNode(const OctreeNode& other) {
+    *this = other;
+}
+
+OctreeManager::OctreeNode& OctreeManager::OctreeNode::operator=(const OctreeNode& other)
+{
+    originX = other.originX;
+    originY = other.originY;
+    originZ = other.originZ;
+    halfDimension = other.halfDimension;
+    octreePositionIndex = other.octreePositionIndex;
+    firstChild = other.firstChild;
+    dataSlot = other.dataSlot;
+    dataClass = other.dataClass;
+    numStars = other.numStars;
+    lodThreshold = other.lodThreshold;
+    bufferIndex = other.bufferIndex;
+    loadState = other.loadState.load();
+    hasLoadedDescendant = other.hasLoadedDescendant.load();
+    return *this;
+}
+
+bool OctreeManager::OctreeNode::isLeaf() const {
+    return firstChild == -1;
+}
+
+bool OctreeManager::OctreeNode::isLoaded() const {
+    return loadState.load(std::memory_order_acquire) == LoadState::Loaded;
+}
+
+void OctreeManager::StarArena::initialize(size_t maxStarsPerSlot, size_t valuesPerStar) {
+    std::lock_guard lock(_mutex);
+    _classes.clear();
+
+    size_t capacity = std::min(MinSlotStars, maxStarsPerSlot);
+    while (true) {
+        SizeClass sizeClass;
+        sizeClass.capacity = capacity;
+        sizeClass.slotSize = capacity * valuesPerStar;
+        sizeClass.firstPageSlots = std::max<size_t>(
+            FirstPageBytes / (sizeClass.slotSize * sizeof(float)),
+            1
+        );
+        _classes.push_back(std::move(sizeClass));
+
+        if (capacity >= maxStarsPerSlot) {
+            break;
+        }
+        capacity = std::min(capacity * 2, maxStarsPerSlot);
+    }
+}
+
+uint8_t OctreeManager::StarArena::sizeClassFor(size_t nStars) const {
+    uint8_t sizeClass = 0;
+    while (sizeClass < _classes.size() - 1 && _classes[sizeClass].capacity < nStars) {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+size_t OctreeManager::StarArena::capacity(uint8_t sizeClass) const {
+    return _classes[sizeClass].capacity;
+}
+
+int32_t OctreeManager::StarArena::allocate(uint8_t sizeClass) {
+    std::lock_guard lock(_mutex);
+    SizeClass& c = _classes[sizeClass];
+    if (!c.freeSlots.empty()) {
+        const int32_t slot = c.freeSlots.back();
+        c.freeSlots.pop_back();
+        return slot;
+    }
+
+    const int32_t slot = static_cast<int32_t>(c.nSlots);
+    const size_t page = pageOfSlot(c.nSlots, c.firstPageSlots).first;
+    ghoul_assert(page < MaxPages, "Star data arena is full");
+    if (!c.pages[page]) {
+        // The values are written before they are read, so they are left uninitialized
+        const size_t nValues = (c.firstPageSlots << page) * c.slotSize;
+        c.pages[page] = std::unique_ptr<float[]>(new float[nValues]);
+    }
+    c.nSlots++;
+    return slot;
+}
+
+void OctreeManager::StarArena::release(uint8_t sizeClass, int32_t slot) {
+    std::lock_guard lock(_mutex);
+    _classes[sizeClass].freeSlots.push_back(slot);
+}
+
+float* OctreeManager::StarArena::data(uint8_t sizeClass, int32_t slot) const {
+    const SizeClass& c = _classes[sizeClass];
+    const auto [page, index] = pageOfSlot(static_cast<size_t>(slot), c.firstPageSlots);
+    return c.pages[page].get() + index * c.slotSize;
+}
+
 void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStarsPerNode) {
-    if (_root) {
+    // Requests that are still waiting or executing refer to the nodes of the old Octree
+    if (_ioScheduler) {
+        _ioScheduler->cancelAll();
+        _ioScheduler->waitUntilIdle();
+    }
+
+    if (!_nodes[0].empty()) {
         LDEBUG("Clear existing Octree");
         clearAllData();
     }
 
     LDEBUG("Initializing new Octree");
-    _root = std::make_shared<OctreeNode>();
-    _root->octreePositionIndex = 8;
 
     // Initialize the culler. The NDC.z of the comparing corners are always -1 or 1.
     globebrowsing::AABB3 box;
     box.min = glm::vec3(-1.f, -1.f, 0.f);
     box.max = glm::vec3(1.f, 1.f, 100.f);
     _culler = std::make_unique<OctreeCuller>(box);
-    _removedKeysInPrevCall = std::set<int>();
+    _removedKeysInPrevCall.clear();
     _leastRecentlyFetchedNodes = std::queue<unsigned long long>();
 
     // Reset default values when rebuilding the Octree during runtime.
@@ -61,6 +307,10 @@ void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStars
     _numLeafNodes = 0;
     _totalDepth = 0;
     _valuesPerStar = POS_SIZE + COL_SIZE + VEL_SIZE;
+    {
+        std::lock_guard lock(_encodingReportMutex);
+        _encodingReport = gaia::EncodingReport();
+    }
     _maxCpuRamBudget = cpuRamBudget;
     _cpuRamBudget = cpuRamBudget;
     _parentNodeOfCamera = 8;
@@ -71,30 +321,24 @@ void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStars
     if (maxStarsPerNode > 0) {
         MAX_STARS_PER_NODE = static_cast<size_t>(maxStarsPerNode);
     }
+    // Inner nodes collect up to twice the number of stars in their LOD cache
+    _arena.initialize(2 * MAX_STARS_PER_NODE, _valuesPerStar);
 
     for (size_t i = 0; i < 8; ++i) {
         _numLeafNodes++;
-        _root->Children[i] = std::make_shared<OctreeNode>();
-        _root->Children[i]->posData = std::vector<float>();
-        _root->Children[i]->colData = std::vector<float>();
-        _root->Children[i]->velData = std::vector<float>();
-        _root->Children[i]->magOrder = std::vector<std::pair<float, size_t>>();
-        _root->Children[i]->isLeaf = true;
-        _root->Children[i]->isLoaded = false;
-        _root->Children[i]->hasLoadedDescendant = false;
-        _root->Children[i]->bufferIndex = DEFAULT_INDEX;
-        _root->Children[i]->octreePositionIndex = 80 + i;
-        _root->Children[i]->numStars = 0;
-        _root->Children[i]->halfDimension = MAX_DIST / 2.f;
-        _root->Children[i]->originX = (i % 2 == 0) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
-        _root->Children[i]->originY = (i % 4 < 2) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
-        _root->Children[i]->originZ = (i < 4) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
+        _nodes[i] = std::vector<OctreeNode>(1);
+        OctreeNode& branchRoot = _nodes[i][0];
+        branchRoot.octreePositionIndex = 80 + i;
+        branchRoot.halfDimension = MAX_DIST / 2.f;
+        branchRoot.originX = (i % 2 == 0) ?
+            branchRoot.halfDimension :
+            -branchRoot.halfDimension;
+        branchRoot.originY = (i % 4 < 2) ?
+            branchRoot.halfDimension :
+            -branchRoot.halfDimension;
+        branchRoot.originZ = (i < 4) ?
+            branchRoot.halfDimension :
+            -branchRoot.halfDimension;
     }
 }
 
@@ -103,7 +347,7 @@ void OctreeManager::initBufferIndexStack(long long maxNodes, bool useVBO,
 {
     // Clear stack if we've used it before.
     _biggestChunkIndexInUse = 0;
-    _freeSpotsInBuffer = std::stack<int>();
+    _freeSpotsInBuffer = std::stack<int, std::vector<int>>();
     _rebuildBuffer = true;
     _useVBO = useVBO;
     _datasetFitInMemory = datasetFitInMemory;
@@ -113,22 +357,23 @@ void OctreeManager::initBufferIndexStack(long long maxNodes, bool useVBO,
         _freeSpotsInBuffer.push(static_cast<int>(idx));
     }
     _maxStackSize = _freeSpotsInBuffer.size();
+    _chunkUpdateOfBufferIndex.assign(_maxStackSize, -1);
     LINFO("StackSize: " + std::to_string(maxNodes));
 }
 
 void OctreeManager::insert(const std::vector<float>& starValues) {
     size_t index = getChildIndex(starValues[0], starValues[1], starValues[2]);
 
-    insertInNode(*_root->Children[index], starValues);
+    insertInNode({ static_cast<int>(index), 0 }, starValues.data());
 }
 
 void OctreeManager::sliceLodData(size_t branchIndex) {
     if (branchIndex != 8) {
-        sliceNodeLodCache(*_root->Children[branchIndex]);
+        sliceNodeLodCache({ static_cast<int>(branchIndex), 0 });
     }
     else {
-        for (int i = 0; i < 7; ++i) {
-            sliceNodeLodCache(*_root->Children[i]);
+        for (int i = 0; i < 8; ++i) {
+            sliceNodeLodCache({ i, 0 });
         }
     }
 }
@@ -138,7 +383,7 @@ void OctreeManager::printStarsPerNode() const {
 
     for (int i = 0; i < 8; ++i) {
         std::string prefix = "{" + std::to_string(i);
-        accumulatedString += printStarsPerNode(*_root->Children[i], prefix);
+        accumulatedString += printStarsPerNode({ i, 0 }, prefix);
     }
     LINFO(fmt::format("Number of stars per node: \n{}", accumulatedString));
     LINFO(fmt::format("Number of leaf nodes: {}", std::to_string(_numLeafNodes)));
@@ -150,41 +395,28 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
                                           size_t chunkSizeInBytes,
                                           const glm::ivec2& additionalNodes)
 {
+    glm::vec3 fCameraPos = static_cast<glm::vec3>(
+        cameraPos / (1000.0 * distanceconstants::Parsec)
+    );
+    _cameraPosition = fCameraPos;
 
     // If entire dataset fits in RAM then load the entire dataset asynchronously now.
     // Nodes will be rendered when they've been made available.
     if (_datasetFitInMemory) {
-        // Only traverse Octree once!
+        // Only traverse Octree once! The nodes closest to the camera are loaded first
         if (_parentNodeOfCamera == 8) {
-            // Fetch first layer of children
-            fetchChildrenNodes(*_root, 0);
-
-            for (int i = 0; i < 8; ++i) {
-                // Check so branch doesn't have a single layer.
-                if (_root->Children[i]->isLeaf) {
-                    continue;
-                }
-
-                // Use multithreading to load files and detach thread from main execution
-                // so it can execute independently. Thread will be destroyed when
-                // finished!
-                std::thread([this, n = _root->Children[i]]() {
-                    fetchChildrenNodes(*n, -1);
-                }).detach();
-            }
+            fetchChildrenNodes(NodeId(), -1);
             _parentNodeOfCamera = 0;
         }
         return;
     }
 
     // Get leaf node in which the camera resides.
-    glm::vec3 fCameraPos = static_cast<glm::vec3>(
-        cameraPos / (1000.0 * distanceconstants::Parsec)
-    );
     size_t idx = getChildIndex(fCameraPos.x, fCameraPos.y, fCameraPos.z);
-    std::shared_ptr<OctreeNode> node = _root->Children[idx];
+    const std::vector<OctreeNode>& branch = _nodes[idx];
+    const OctreeNode* node = &branch[0];
 
-    while (!node->isLeaf) {
+    while (!node->isLeaf()) {
         idx = getChildIndex(
             fCameraPos.x,
             fCameraPos.y,
@@ -193,7 +425,7 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
             node->originY,
             node->originZ
         );
-        node = node->Children[idx];
+        node = &branch[node->firstChild + idx];
     }
     unsigned long long leafId = node->octreePositionIndex;
     unsigned long long firstParentId = leafId / 10;
@@ -219,6 +451,9 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
         additionalLevelsToFetch++;
     }
 
+    // Requests for nodes that are no longer close to the camera are dropped at the end
+    _ioScheduler->beginPass();
+
     // Get the 3^3 closest parents and load all their (eventual) children.
     for (int x = -1; x <= 1; x += 1) {
         for (int y = -2; y <= 2; y += 2) {
@@ -274,22 +509,27 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
         }
     }
 
+    _ioScheduler->cancelStaleRequests();
+
     // Check if we should remove any nodes from RAM.
     long long tenthOfRamBudget = _maxCpuRamBudget / 10;
     if (_cpuRamBudget < tenthOfRamBudget) {
         long long bytesToTenthOfRam = tenthOfRamBudget - _cpuRamBudget;
         size_t nNodesToRemove = static_cast<size_t>(bytesToTenthOfRam / chunkSizeInBytes);
         std::vector<unsigned long long> nodesToRemove;
-        while (nNodesToRemove > 0) {
-            // Dequeue nodes that were least recently fetched by findAndFetchNeighborNode.
-            nodesToRemove.push_back(_leastRecentlyFetchedNodes.front());
-            _leastRecentlyFetchedNodes.pop();
-            nNodesToRemove--;
-        }
-        // Use asynchronous removal.
-        if (!nodesToRemove.empty()) {
-            std::thread(&OctreeManager::removeNodesFromRam, this, nodesToRemove).detach();
+        {
+            std::lock_guard g(_leastRecentlyFetchedNodesMutex);
+            while (nNodesToRemove > 0 && !_leastRecentlyFetchedNodes.empty()) {
+                // Dequeue nodes that were least recently fetched.
+                nodesToRemove.push_back(_leastRecentlyFetchedNodes.front());
+                _leastRecentlyFetchedNodes.pop();
+                nNodesToRemove--;
+            }
         }
+        // Removing a node only returns its memory to the arena, so this is cheap enough
+        // to do right away. It also guarantees that no node is removed while the Octree
+        // is being traversed.
+        removeNodesFromRam(nodesToRemove);
     }
 }
 
@@ -301,7 +541,7 @@ void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, i
 
     // Fetch first layer children if we're already at root.
     if (parentId == 8) {
-        fetchChildrenNodes(*_root, 0);
+        fetchChildrenNodes(NodeId(), 0);
         return;
     }
 
@@ -377,32 +617,43 @@ void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, i
     }
 
     // Traverse to that parent node (as long as such a child exists!).
-    std::shared_ptr<OctreeNode> node = _root;
-    while (!indexStack.empty() && !node->Children[indexStack.top()]->isLeaf) {
-        node = node->Children[indexStack.top()];
-        node->hasLoadedDescendant = true;
+    NodeId parent;
+    while (!indexStack.empty()) {
+        const NodeId child = childOf(parent, indexStack.top());
+        if (node(child).isLeaf()) {
+            break;
+        }
+        parent = child;
+        node(parent).hasLoadedDescendant = true;
         indexStack.pop();
     }
 
-    // Fetch all children nodes from found parent. Use multithreading to load files
-    // asynchronously! Detach thread from main execution so it can execute independently.
-    // Thread will then be destroyed when it has finished!
-    std::thread([this, node, additionalLevelsToFetch]() {
-        fetchChildrenNodes(*node, additionalLevelsToFetch);
-    }).detach();
+    // Fetch all children nodes from found parent. The files are loaded asynchronously
+    fetchChildrenNodes(parent, additionalLevelsToFetch);
 }
 
-std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4& mvp,
+const OctreeManager::BufferUpdates& OctreeManager::traverseData(const glm::dmat4& mvp,
                                                               const glm::vec2& screenSize,
-                                                              int& deltaStars,
-                                                              gaia::RenderOption option,
-                                                              float lodPixelThreshold)
+                                                                          int& deltaStars,
+                                                                gaia::RenderOption option,
+                                                                  float lodPixelThreshold)
 {
-    auto renderData = std::map<int, std::vector<float>>();
+    // Forget the updates of the previous render call but keep their memory.
+    for (const ChunkUpdate& update : _bufferUpdates.chunks) {
+        _chunkUpdateOfBufferIndex[update.bufferIndex] = -1;
+    }
+    _bufferUpdates.chunks.clear();
+    _bufferUpdates.stagingData.clear();
+
     bool innerRebuild = false;
     _minTotalPixelsLod = lodPixelThreshold;
 
     // Reclaim indices from previous render call.
+    std::sort(_removedKeysInPrevCall.begin(), _removedKeysInPrevCall.end());
+    _removedKeysInPrevCall.erase(
+        std::unique(_removedKeysInPrevCall.begin(), _removedKeysInPrevCall.end()),
+        _removedKeysInPrevCall.end()
+    );
     for (auto removedKey = _removedKeysInPrevCall.rbegin();
          removedKey != _removedKeysInPrevCall.rend(); ++removedKey) {
 
@@ -417,9 +668,7 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         _freeSpotsInBuffer.push(*removedKey);
     }
     // Clear cache of removed keys before next render call.
-    if (!_removedKeysInPrevCall.empty()) {
-        _removedKeysInPrevCall.clear();
-    }
+    _removedKeysInPrevCall.clear();
 
     // Rebuild VBO from scratch if we're not using most of it but have a high max index.
     if ((_biggestChunkIndexInUse > _maxStackSize * 4 / 5) &&
@@ -435,7 +684,7 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
     }
 
     // Check if entire tree is too small to see, and if so remove it.
-    std::vector<glm::dvec4> corners(8);
+    std::array<glm::dvec4, 8> corners;
     float fMaxDist = static_cast<float>(MAX_DIST);
     for (int i = 0; i < 8; ++i) {
         float x = (i % 2 == 0) ? fMaxDist : -fMaxDist;
@@ -445,20 +694,16 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         corners[i] = glm::dvec4(pos, 1.0);
     }
     if (!_culler->isVisible(corners, mvp)) {
-        return renderData;
+        return _bufferUpdates;
     }
     glm::vec2 nodeSize = _culler->getNodeSizeInPixels(corners, mvp, screenSize);
     float totalPixels = nodeSize.x * nodeSize.y;
     if (totalPixels < _minTotalPixelsLod * 2) {
         // Remove LOD from first layer of children.
         for (int i = 0; i < 8; ++i) {
-            std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *_root->Children[i],
-                deltaStars
-            );
-            renderData.insert(tmpData.begin(), tmpData.end());
+            removeNodeFromCache({ i, 0 }, deltaStars);
         }
-        return renderData;
+        return _bufferUpdates;
     }
 
     for (size_t i = 0; i < 8; ++i) {
@@ -466,8 +711,8 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
             continue;
         }
 
-        std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *_root->Children[i],
+        checkNodeIntersection(
+            { static_cast<int>(i), 0 },
             mvp,
             screenSize,
             deltaStars,
@@ -477,27 +722,17 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         // Avoid freezing when switching render mode for large datasets by only fetching
         // one branch at a time when rebuilding buffer.
         if (_rebuildBuffer) {
-            //renderData = std::move(tmpData);
             _traversedBranchesInRenderCall++;
-            //break;
         }
-
-        // Observe that if there exists identical keys in renderData then those values in
-        // tmpData will be ignored! Thus we store the removed keys until next render call!
-        renderData.insert(tmpData.begin(), tmpData.end());
     }
 
     if (_rebuildBuffer) {
         if (_useVBO) {
             // We need to overwrite bigger indices that had data before! No need for SSBO.
-            std::map<int, std::vector<float>> idxToRemove;
+            // Chunks that got new data in this call are not cleared.
             for (int idx : _removedKeysInPrevCall) {
-                idxToRemove[idx] = std::vector<float>();
+                recordChunkRemoval(idx);
             }
-
-            // This will only insert indices that doesn't already exist in map
-            // (i.e. > biggestIdx).
-            renderData.insert(idxToRemove.begin(), idxToRemove.end());
         }
         if (innerRebuild) {
             deltaStars = 0;
@@ -518,15 +753,14 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
             _traversedBranchesInRenderCall = 0;
         }
     }
-    return renderData;
+    return _bufferUpdates;
 }
 
 std::vector<float> OctreeManager::getAllData(gaia::RenderOption option) {
     std::vector<float> fullData;
 
-    for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*_root->Children[i], option);
-        fullData.insert(fullData.end(), tmpData.begin(), tmpData.end());
+    for (int i = 0; i < 8; ++i) {
+        appendNodeData({ i, 0 }, option, fullData);
     }
     return fullData;
 }
@@ -534,16 +768,24 @@ std::vector<float> OctreeManager::getAllData(gaia::RenderOption option) {
 void OctreeManager::clearAllData(int branchIndex) {
     // Don't clear everything if not needed.
     if (branchIndex != -1) {
-        clearNodeData(*_root->Children[branchIndex]);
+        clearNodeData({ branchIndex, 0 });
     }
     else {
-        for (size_t i = 0; i < 8; ++i) {
-            clearNodeData(*_root->Children[i]);
+        for (int i = 0; i < 8; ++i) {
+            clearNodeData({ i, 0 });
         }
     }
 }
 
 void OctreeManager::writeToFile(std::ofstream& outFileStream, bool writeData) {
+    // Files with the original encoding keep the original header so that older versions
+    // can still read them
+    if (_starEncoding != gaia::StarEncoding::Float32) {
+        const int32_t version = -gaia::EncodedFileVersion;
+        const int32_t encoding = static_cast<int32_t>(_starEncoding);
+        outFileStream.write(reinterpret_cast<const char*>(&version), sizeof(int32_t));
+        outFileStream.write(reinterpret_cast<const char*>(&encoding), sizeof(int32_t));
+    }
     outFileStream.write(reinterpret_cast<const char*>(&_valuesPerStar), sizeof(int32_t));
     outFileStream.write(
         reinterpret_cast<const char*>(&MAX_STARS_PER_NODE),
@@ -552,42 +794,190 @@ void OctreeManager::writeToFile(std::ofstream& outFileStream, bool writeData) {
     outFileStream.write(reinterpret_cast<const char*>(&MAX_DIST), sizeof(int32_t));
 
     // Use pre-traversal (Morton code / Z-order).
-    for (size_t i = 0; i < 8; ++i) {
-        writeNodeToFile(outFileStream, *_root->Children[i], writeData);
+    for (int i = 0; i < 8; ++i) {
+        writeNodeToFile(outFileStream, { i, 0 }, writeData);
     }
 }
 
-void OctreeManager::writeNodeToFile(std::ofstream& outFileStream, const OctreeNode& node,
+void OctreeManager::writeNodeToFile(std::ofstream& outFileStream, NodeId id,
                                     bool writeData)
 {
+    const OctreeNode& n = node(id);
+
     // Write node structure.
-    bool isLeaf = node.isLeaf;
-    int32_t numStars = static_cast<int32_t>(node.numStars);
+    bool isLeaf = n.isLeaf();
+    int32_t numStars = static_cast<int32_t>(n.numStars);
     outFileStream.write(reinterpret_cast<const char*>(&isLeaf), sizeof(bool));
     outFileStream.write(reinterpret_cast<const char*>(&numStars), sizeof(int32_t));
 
     // Write node data if specified
     if (writeData) {
-        std::vector<float> nodeData = node.posData;
-        nodeData.insert(nodeData.end(), node.colData.begin(), node.colData.end());
-        nodeData.insert(nodeData.end(), node.velData.begin(), node.velData.end());
-        int32_t nDataSize = static_cast<int32_t>(nodeData.size());
-        size_t nBytes = nDataSize * sizeof(nodeData[0]);
-
-        outFileStream.write(reinterpret_cast<const char*>(&nDataSize), sizeof(int32_t));
-        if (nDataSize > 0) {
-            outFileStream.write(reinterpret_cast<const char*>(nodeData.data()), nBytes);
-        }
+        writeNodeData(outFileStream, n);
     }
 
     // Write children to file (in Morton order) if we're in an inner node.
-    if (!node.isLeaf) {
+    if (!isLeaf) {
         for (size_t i = 0; i < 8; ++i) {
-            writeNodeToFile(outFileStream, *node.Children[i], writeData);
+            writeNodeToFile(outFileStream, childOf(id, i), writeData);
         }
     }
 }
 
+void OctreeManager::writeNodeData(std::ofstream& outFileStream, const OctreeNode& node) {
+    const size_t nStars = (node.dataSlot != -1) ? node.numStars : 0;
+    int32_t nDataSize = static_cast<int32_t>(nStars * _valuesPerStar);
+    outFileStream.write(reinterpret_cast<const char*>(&nDataSize), sizeof(int32_t));
+    if (nStars == 0) {
+        return;
+    }
+
+    if (_starEncoding == gaia::StarEncoding::Quantized) {
+        std::vector<std::byte> buffer(gaia::encodedNodeSize(_starEncoding, nStars));
+        gaia::EncodingReport report;
+        gaia::encodeQuantizedNode(
+            positions(node),
+            colors(node),
+            velocities(node),
+            nStars,
+            buffer.data(),
+            &report
+        );
+        outFileStream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+        std::lock_guard lock(_encodingReportMutex);
+        _encodingReport.merge(report);
+        return;
+    }
+
+    outFileStream.write(
+        reinterpret_cast<const char*>(positions(node)),
+        nStars * POS_SIZE * sizeof(float)
+    );
+    outFileStream.write(
+        reinterpret_cast<const char*>(colors(node)),
+        nStars * COL_SIZE * sizeof(float)
+    );
+    outFileStream.write(
+        reinterpret_cast<const char*>(velocities(node)),
+        nStars * VEL_SIZE * sizeof(float)
+    );
+}
+
+bool OctreeManager::readNodeData(std::ifstream& inFileStream, OctreeNode& node) {
+    int32_t nDataSize = 0;
+    inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
+    if (!inFileStream.good() || nDataSize < 0) {
+        return false;
+    }
+
+    const size_t starsInNode = static_cast<size_t>(nDataSize) / _valuesPerStar;
+    if (starsInNode > MAX_STARS_PER_NODE) {
+        LERROR(fmt::format(
+            "Node {} has more stars than the octree allows per node",
+            node.octreePositionIndex
+        ));
+        inFileStream.seekg(nodeDataBytes(nDataSize), std::ios::cur);
+        return false;
+    }
+    if (starsInNode == 0) {
+        inFileStream.seekg(nodeDataBytes(nDataSize), std::ios::cur);
+        return inFileStream.good();
+    }
+
+    reserveNodeData(node, starsInNode);
+    if (_starEncoding == gaia::StarEncoding::Quantized) {
+        std::vector<std::byte> buffer(nodeDataBytes(nDataSize));
+        inFileStream.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        const bool success = inFileStream.good() && gaia::decodeQuantizedNode(
+            buffer.data(),
+            buffer.size(),
+            starsInNode,
+            positions(node),
+            colors(node),
+            velocities(node)
+        );
+        node.numStars = static_cast<uint32_t>(starsInNode);
+        return success;
+    }
+
+    inFileStream.read(
+        reinterpret_cast<char*>(positions(node)),
+        starsInNode * POS_SIZE * sizeof(float)
+    );
+    inFileStream.read(
+        reinterpret_cast<char*>(colors(node)),
+        starsInNode * COL_SIZE * sizeof(float)
+    );
+    inFileStream.read(
+        reinterpret_cast<char*>(velocities(node)),
+        starsInNode * VEL_SIZE * sizeof(float)
+    );
+
+    // Skip potential values that are not part of our render parameters.
+    const size_t nRemaining = nDataSize - starsInNode * (POS_SIZE + COL_SIZE + VEL_SIZE);
+    if (nRemaining > 0) {
+        inFileStream.seekg(nRemaining * sizeof(float), std::ios::cur);
+    }
+    node.numStars = static_cast<uint32_t>(starsInNode);
+    return inFileStream.good();
+}
+
+bool OctreeManager::readNodeData(const std::byte* data, size_t size, OctreeNode& node) {
+    int32_t nDataSize = 0;
+    if (size < sizeof(int32_t)) {
+        return false;
+    }
+    std::memcpy(&nDataSize, data, sizeof(int32_t));
+    data += sizeof(int32_t);
+
+    if (nDataSize < 0 || size < sizeof(int32_t) + nodeDataBytes(nDataSize)) {
+        return false;
+    }
+
+    const size_t starsInNode = static_cast<size_t>(nDataSize) / _valuesPerStar;
+    if (starsInNode > MAX_STARS_PER_NODE) {
+        LERROR(fmt::format(
+            "Node {} has more stars than the octree allows per node",
+            node.octreePositionIndex
+        ));
+        return false;
+    }
+    if (starsInNode == 0) {
+        return true;
+    }
+
+    reserveNodeData(node, starsInNode);
+    if (_starEncoding == gaia::StarEncoding::Quantized) {
+        // The quantized values are expanded straight into the arena
+        const bool success = gaia::decodeQuantizedNode(
+            data,
+            size - sizeof(int32_t),
+            starsInNode,
+            positions(node),
+            colors(node),
+            velocities(node)
+        );
+        node.numStars = static_cast<uint32_t>(starsInNode);
+        return success;
+    }
+
+    std::memcpy(positions(node), data, starsInNode * POS_SIZE * sizeof(float));
+    data += starsInNode * POS_SIZE * sizeof(float);
+    std::memcpy(colors(node), data, starsInNode * COL_SIZE * sizeof(float));
+    data += starsInNode * COL_SIZE * sizeof(float);
+    std::memcpy(velocities(node), data, starsInNode * VEL_SIZE * sizeof(float));
+
+    node.numStars = static_cast<uint32_t>(starsInNode);
+    return true;
+}
+
+size_t OctreeManager::nodeDataBytes(int32_t nDataSize) const {
+    if (_starEncoding == gaia::StarEncoding::Quantized) {
+        return gaia::encodedNodeSize(_starEncoding, nDataSize / _valuesPerStar);
+    }
+    return nDataSize * sizeof(float);
+}
+
 int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
                                 const std::string& folderPath)
 {
@@ -598,10 +988,37 @@ int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
     _streamOctree = !readData;
     if (_streamOctree) {
         _streamFolderPath = folderPath;
+        if (!_ioScheduler) {
+            _ioScheduler = std::make_unique<NodeIoScheduler>(MaxConcurrentReads);
+        }
     }
-
-    _valuesPerStar = 0;
-    inFileStream.read(reinterpret_cast<char*>(&_valuesPerStar), sizeof(int32_t));
+    if (_ioScheduler) {
+        _ioScheduler->cancelAll();
+        _ioScheduler->waitUntilIdle();
+    }
+
+    int32_t valuesPerStar = 0;
+    inFileStream.read(reinterpret_cast<char*>(&valuesPerStar), sizeof(int32_t));
+    _starEncoding = gaia::StarEncoding::Float32;
+    if (valuesPerStar < 0) {
+        // Files that start with a negative value have a version and an encoding
+        const int32_t version = -valuesPerStar;
+        int32_t encoding = 0;
+        inFileStream.read(reinterpret_cast<char*>(&encoding), sizeof(int32_t));
+        if (version > gaia::EncodedFileVersion ||
+            encoding < static_cast<int32_t>(gaia::StarEncoding::Float32) ||
+            encoding > static_cast<int32_t>(gaia::StarEncoding::Quantized))
+        {
+            LERROR(fmt::format(
+                "Unsupported octree file version {} with star encoding {}",
+                version, encoding
+            ));
+            return 0;
+        }
+        _starEncoding = static_cast<gaia::StarEncoding>(encoding);
+        inFileStream.read(reinterpret_cast<char*>(&valuesPerStar), sizeof(int32_t));
+    }
+    _valuesPerStar = static_cast<size_t>(valuesPerStar);
     inFileStream.read(reinterpret_cast<char*>(&MAX_STARS_PER_NODE), sizeof(int32_t));
     inFileStream.read(reinterpret_cast<char*>(&MAX_DIST), sizeof(int32_t));
 
@@ -613,31 +1030,45 @@ int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
     // Octree Manager root halfDistance must be updated before any nodes are created!
     if (static_cast<int>(MAX_DIST) != oldMaxdist) {
         for (size_t i = 0; i < 8; ++i) {
-            _root->Children[i]->halfDimension = MAX_DIST / 2.f;
-            _root->Children[i]->originX = (i % 2 == 0) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
-            _root->Children[i]->originY = (i % 4 < 2) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
-            _root->Children[i]->originZ = (i < 4) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
+            OctreeNode& branchRoot = _nodes[i][0];
+            branchRoot.halfDimension = MAX_DIST / 2.f;
+            branchRoot.originX = (i % 2 == 0) ?
+                branchRoot.halfDimension :
+                -branchRoot.halfDimension;
+            branchRoot.originY = (i % 4 < 2) ?
+                branchRoot.halfDimension :
+                -branchRoot.halfDimension;
+            branchRoot.originZ = (i < 4) ?
+                branchRoot.halfDimension :
+                -branchRoot.halfDimension;
         }
     }
 
     if (_valuesPerStar != (POS_SIZE + COL_SIZE + VEL_SIZE)) {
         LERROR("Read file doesn't have the same structure of render parameters!");
+        if (_starEncoding != gaia::StarEncoding::Float32) {
+            // The encoded nodes can't hold any additional values that could be skipped
+            return 0;
+        }
+    }
+
+    // Replace potential earlier branches. The size classes of the arena depend on the
+    // number of stars per node, so it is initialized again as well
+    for (int i = 0; i < 8; ++i) {
+        clearNodeData({ i, 0 });
+        _nodes[i].resize(1);
+        _nodes[i][0].firstChild = -1;
     }
+    _arena.initialize(2 * MAX_STARS_PER_NODE, POS_SIZE + COL_SIZE + VEL_SIZE);
 
     // Use the same technique to construct octree from file.
-    for (size_t i = 0; i < 8; ++i) {
-        nStarsRead += readNodeFromFile(inFileStream, *_root->Children[i], readData);
+    for (int i = 0; i < 8; ++i) {
+        nStarsRead += readNodeFromFile(inFileStream, { i, 0 }, readData);
     }
     return nStarsRead;
 }
 
-int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& node,
+int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, NodeId id,
                                     bool readData)
 {
     // Read node structure.
@@ -647,36 +1078,20 @@ int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& nod
     inFileStream.read(reinterpret_cast<char*>(&isLeaf), sizeof(bool));
     inFileStream.read(reinterpret_cast<char*>(&numStars), sizeof(int32_t));
 
-    node.isLeaf = isLeaf;
-    node.numStars = numStars;
+    OctreeNode& n = node(id);
+    n.numStars = numStars;
 
     // Read node data if specified.
-    if (readData) {
-        int32_t nDataSize = 0;
-        inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
-
-        if (nDataSize > 0) {
-            std::vector<float> fetchedData(nDataSize, 0.0f);
-            size_t nBytes = nDataSize * sizeof(fetchedData[0]);
-
-            inFileStream.read(reinterpret_cast<char*>(&fetchedData[0]), nBytes);
-
-            int starsInNode = static_cast<int>(nDataSize / _valuesPerStar);
-            auto posEnd = fetchedData.begin() + (starsInNode * POS_SIZE);
-            auto colEnd = posEnd + (starsInNode * COL_SIZE);
-            auto velEnd = colEnd + (starsInNode * VEL_SIZE);
-            node.posData = std::vector<float>(fetchedData.begin(), posEnd);
-            node.colData = std::vector<float>(posEnd, colEnd);
-            node.velData = std::vector<float>(colEnd, velEnd);
-        }
+    if (readData && !readNodeData(inFileStream, n)) {
+        LERROR(fmt::format("Error reading data of node {}", n.octreePositionIndex));
     }
 
     // Create children if we're in an inner node and read from the corresponding nodes.
-    if (!node.isLeaf) {
+    if (!isLeaf) {
         numStars = 0;
-        createNodeChildren(node);
+        createNodeChildren(id);
         for (size_t i = 0; i < 8; ++i) {
-            numStars += readNodeFromFile(inFileStream, *node.Children[i], readData);
+            numStars += readNodeFromFile(inFileStream, childOf(id, i), readData);
         }
     }
 
@@ -687,39 +1102,30 @@ int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& nod
 void OctreeManager::writeToMultipleFiles(const std::string& outFolderPath,
                                          size_t branchIndex)
 {
+    const NodeId branchRoot = { static_cast<int>(branchIndex), 0 };
+
     // Write entire branch to disc, with one file per node.
     std::string outFilePrefix = outFolderPath + std::to_string(branchIndex);
     // More threads doesn't make it much faster, disk speed still the limiter.
-    writeNodeToMultipleFiles(outFilePrefix, *_root->Children[branchIndex], false);
+    writeNodeToMultipleFiles(outFilePrefix, branchRoot, false);
 
     // Clear all data in branch.
     LINFO(fmt::format("Clear all data from branch {} in octree", branchIndex));
-    clearNodeData(*_root->Children[branchIndex]);
+    clearNodeData(branchRoot);
 }
 
-void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
-                                             OctreeNode& node, bool threadWrites)
+void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix, NodeId id,
+                                             bool threadWrites)
 {
-    // Prepare node data, save nothing else.
-    std::vector<float> nodeData = node.posData;
-    nodeData.insert(nodeData.end(), node.colData.begin(), node.colData.end());
-    nodeData.insert(nodeData.end(), node.velData.begin(), node.velData.end());
-    int32_t nDataSize = static_cast<int32_t>(nodeData.size());
-    size_t nBytes = nDataSize * sizeof(nodeData[0]);
+    const OctreeNode& n = node(id);
 
     // Only open output stream if we have any values to write.
-    if (nDataSize > 0) {
+    if (n.dataSlot != -1 && n.numStars > 0) {
         // Use Morton code to name file (placement in Octree).
         std::string outPath = outFilePrefix + BINARY_SUFFIX;
         std::ofstream outFileStream(outPath, std::ofstream::binary);
         if (outFileStream.good()) {
-            // LINFO("Write " + std::to_string(nDataSize) + " values to " + outPath);
-            outFileStream.write(
-                reinterpret_cast<const char*>(&nDataSize),
-                sizeof(int32_t)
-            );
-            outFileStream.write(reinterpret_cast<const char*>(nodeData.data()), nBytes);
-
+            writeNodeData(outFileStream, n);
             outFileStream.close();
         }
         else {
@@ -728,21 +1134,22 @@ void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
     }
 
     // Recursively write children to file (in Morton order) if we're in an inner node.
-    if (!node.isLeaf) {
+    if (!n.isLeaf()) {
         std::vector<std::thread> writeThreads(8);
         for (size_t i = 0; i < 8; ++i) {
             std::string newOutFilePrefix = outFilePrefix + std::to_string(i);
+            const NodeId child = childOf(id, i);
             if (threadWrites) {
                 // Divide writing to new threads to speed up the process.
                 std::thread t(
-                    [this, newOutFilePrefix, n = node.Children[i]]() {
-                        writeNodeToMultipleFiles(newOutFilePrefix, *n, false);
+                    [this, newOutFilePrefix, child]() {
+                        writeNodeToMultipleFiles(newOutFilePrefix, child, false);
                     }
                 );
                 writeThreads[i] = std::move(t);
             }
             else {
-                writeNodeToMultipleFiles(newOutFilePrefix, *node.Children[i], false);
+                writeNodeToMultipleFiles(newOutFilePrefix, child, false);
             }
         }
         if (threadWrites) {
@@ -754,71 +1161,79 @@ void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
     }
 }
 
-void OctreeManager::fetchChildrenNodes(OctreeNode& parentNode,
-                                       int additionalLevelsToFetch)
-{
-    // Lock node to make sure nobody else are trying to load the same children.
-    std::lock_guard lock(parentNode.loadingLock);
+void OctreeManager::fetchChildrenNodes(NodeId parent, int additionalLevelsToFetch) {
+    for (size_t i = 0; i < 8; ++i) {
+        const NodeId childId = childOf(parent, i);
+        OctreeNode& child = node(childId);
 
-    for (int i = 0; i < 8; ++i) {
         // Fetch node data if we're streaming and it doesn't exist in RAM yet.
         // (As long as there is any RAM budget left and node actually has any data!)
-        if (!parentNode.Children[i]->isLoaded &&
-            (parentNode.Children[i]->numStars > 0) &&
-            _cpuRamBudget > static_cast<long long>(parentNode.Children[i]->numStars
-            * (POS_SIZE + COL_SIZE + VEL_SIZE) * 4))
+        const long long nBytes = static_cast<long long>(
+            child.numStars * (POS_SIZE + COL_SIZE + VEL_SIZE) * sizeof(float)
+        );
+        if (child.loadState == OctreeNode::LoadState::Unloaded && child.numStars > 0 &&
+            _cpuRamBudget > nBytes)
         {
-            fetchNodeDataFromFile(*parentNode.Children[i]);
+            const float priority = squaredDistanceToNode(
+                _cameraPosition,
+                glm::vec3(child.originX, child.originY, child.originZ),
+                child.halfDimension
+            );
+            _ioScheduler->enqueue(
+                child.octreePositionIndex,
+                priority,
+                [this, childId, nBytes]() -> size_t {
+                    // Other requests might have used up the budget while this one waited
+                    if (_cpuRamBudget <= nBytes) {
+                        return 0;
+                    }
+                    return fetchNodeDataFromFile(node(childId));
+                }
+            );
         }
 
         // Fetch all Children's Children if recursive is set to true!
-        if (additionalLevelsToFetch != 0 && !parentNode.Children[i]->isLeaf) {
-            fetchChildrenNodes(*parentNode.Children[i], --additionalLevelsToFetch);
+        if (additionalLevelsToFetch != 0 && !child.isLeaf()) {
+            fetchChildrenNodes(childId, --additionalLevelsToFetch);
         }
     }
 }
 
-void OctreeManager::fetchNodeDataFromFile(OctreeNode& node) {
+size_t OctreeManager::fetchNodeDataFromFile(OctreeNode& node) {
+    // Claim the node so that nobody else tries to load the same node.
+    OctreeNode::LoadState unloaded = OctreeNode::LoadState::Unloaded;
+    if (!node.loadState.compare_exchange_strong(unloaded,
+                                                OctreeNode::LoadState::Loading))
+    {
+        return 0;
+    }
+
     // Remove root ID ("8") from index before loading file.
     std::string posId = std::to_string(node.octreePositionIndex);
     posId.erase(posId.begin());
 
     std::string inFilePath = _streamFolderPath + posId + BINARY_SUFFIX;
-    std::ifstream inFileStream(inFilePath, std::ifstream::binary);
-    // LINFO("Fetch node data file: " + inFilePath);
-
-    if (inFileStream.good()) {
-        // Read node data.
-        int32_t nDataSize = 0;
-
-        // Octree knows if we have any data in this node = it exists.
-        // Otherwise don't call this function!
-        inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
+    const MappedFile file(inFilePath);
 
-        std::vector<float> readData(nDataSize, 0.f);
-        int nBytes = nDataSize * sizeof(readData[0]);
-        if (nDataSize > 0) {
-            inFileStream.read(reinterpret_cast<char*>(&readData[0]), nBytes);
-        }
-
-        int starsInNode = static_cast<int>(nDataSize / _valuesPerStar);
-        auto posEnd = readData.begin() + (starsInNode * POS_SIZE);
-        auto colEnd = posEnd + (starsInNode * COL_SIZE);
-        auto velEnd = colEnd + (starsInNode * VEL_SIZE);
-        node.posData = std::vector<float>(readData.begin(), posEnd);
-        node.colData = std::vector<float>(posEnd, colEnd);
-        node.velData = std::vector<float>(colEnd, velEnd);
+    // Octree knows if we have any data in this node = it exists.
+    // Otherwise don't call this function!
+    if (file.data() && readNodeData(file.data(), file.size(), node)) {
+        const long long nBytes = node.numStars * _valuesPerStar * sizeof(float);
 
         // Keep track of nodes that are loaded and update CPU RAM budget.
-        node.isLoaded = true;
+        node.loadState.store(OctreeNode::LoadState::Loaded, std::memory_order_release);
         if (!_datasetFitInMemory) {
             std::lock_guard g(_leastRecentlyFetchedNodesMutex);
             _leastRecentlyFetchedNodes.push(node.octreePositionIndex);
         }
         _cpuRamBudget -= nBytes;
+        return file.size();
     }
     else {
         LERROR("Error opening node data file: " + inFilePath);
+        releaseNodeData(node);
+        node.loadState = OctreeNode::LoadState::Unloaded;
+        return 0;
     }
 }
 
@@ -836,67 +1251,51 @@ void OctreeManager::removeNodesFromRam(
         }
 
         // Traverse to node and remove it.
-        std::shared_ptr<OctreeNode> node = _root;
-        std::vector<std::shared_ptr<OctreeNode>> ancestors;
+        NodeId id;
+        std::vector<NodeId> ancestors;
         while (!indexStack.empty()) {
-            ancestors.push_back(node);
-            node = node->Children[indexStack.top()];
+            ancestors.push_back(id);
+            id = childOf(id, indexStack.top());
             indexStack.pop();
         }
-        removeNode(*node);
+        removeNode(node(id));
 
         propagateUnloadedNodes(ancestors);
     }
 }
 
 void OctreeManager::removeNode(OctreeNode& node) {
-    // Lock node to make sure nobody else is trying to access it while removing.
-    std::lock_guard lock(node.loadingLock);
+    // Make sure that the node is not loading while we're removing it.
+    OctreeNode::LoadState loaded = OctreeNode::LoadState::Loaded;
+    if (!node.loadState.compare_exchange_strong(loaded, OctreeNode::LoadState::Unloaded))
+    {
+        return;
+    }
 
-    int nBytes = static_cast<int>(
-        node.numStars * _valuesPerStar * sizeof(node.posData[0])
-    );
     // Keep track of which nodes that are loaded and update CPU RAM budget.
-    node.isLoaded = false;
-    _cpuRamBudget += nBytes;
+    const size_t nBytes = node.numStars * _valuesPerStar * sizeof(float);
+    _cpuRamBudget += static_cast<long long>(nBytes);
 
-    // Clear data
-    node.posData.clear();
-    node.posData.shrink_to_fit();
-    node.colData.clear();
-    node.colData.shrink_to_fit();
-    node.velData.clear();
-    node.velData.shrink_to_fit();
+    // Return the memory to the arena.
+    releaseNodeData(node);
 }
 
-void OctreeManager::propagateUnloadedNodes(
-                                   std::vector<std::shared_ptr<OctreeNode>> ancestorNodes)
-{
-    std::shared_ptr<OctreeNode> parentNode = ancestorNodes.back();
-    while (parentNode->octreePositionIndex != 8) {
+void OctreeManager::propagateUnloadedNodes(std::vector<NodeId> ancestorNodes) {
+    NodeId parent = ancestorNodes.back();
+    while (parent.branch != -1) {
         // Check if any children of inner node is still loaded, or has loaded descendants.
-        if (parentNode->Children[0]->isLoaded || parentNode->Children[1]->isLoaded ||
-            parentNode->Children[2]->isLoaded || parentNode->Children[3]->isLoaded ||
-            parentNode->Children[4]->isLoaded || parentNode->Children[5]->isLoaded ||
-            parentNode->Children[6]->isLoaded || parentNode->Children[7]->isLoaded ||
-            parentNode->Children[0]->hasLoadedDescendant ||
-            parentNode->Children[1]->hasLoadedDescendant ||
-            parentNode->Children[2]->hasLoadedDescendant ||
-            parentNode->Children[3]->hasLoadedDescendant ||
-            parentNode->Children[4]->hasLoadedDescendant ||
-            parentNode->Children[5]->hasLoadedDescendant ||
-            parentNode->Children[6]->hasLoadedDescendant ||
-            parentNode->Children[7]->hasLoadedDescendant)
-        {
-            return;
+        for (size_t i = 0; i < 8; ++i) {
+            const OctreeNode& child = node(childOf(parent, i));
+            if (child.isLoaded() || child.hasLoadedDescendant) {
+                return;
+            }
         }
         // Else all children has been unloaded and we can update parent flag.
-        parentNode->hasLoadedDescendant = false;
-        // LINFO("Removed ancestor: " + std::to_string(parentNode->octreePositionIndex));
+        node(parent).hasLoadedDescendant = false;
 
         // Propagate change upwards.
         ancestorNodes.pop_back();
-        parentNode = ancestorNodes.back();
+        parent = ancestorNodes.back();
     }
 }
 
@@ -936,6 +1335,23 @@ long long OctreeManager::cpuRamBudget() const {
     return _cpuRamBudget;
 }
 
+void OctreeManager::setStarEncoding(gaia::StarEncoding encoding) {
+    _starEncoding = encoding;
+}
+
+gaia::StarEncoding OctreeManager::starEncoding() const {
+    return _starEncoding;
+}
+
+gaia::EncodingReport OctreeManager::encodingReport() const {
+    std::lock_guard lock(_encodingReportMutex);
+    return _encodingReport;
+}
+
+NodeIoScheduler::Stats OctreeManager::ioStats() const {
+    return _ioScheduler ? _ioScheduler->stats() : NodeIoScheduler::Stats();
+}
+
 bool OctreeManager::isRebuildOngoing() const {
     return _rebuildBuffer;
 }
@@ -956,159 +1372,300 @@ size_t OctreeManager::getChildIndex(float posX, float posY, float posZ, float or
     return index;
 }
 
-bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& starValues,
-                                 int depth)
-{
-    if (node.isLeaf && node.numStars < MAX_STARS_PER_NODE) {
-        // Node is a leaf and it's not yet full -> insert star.
-        storeStarData(node, starValues);
+OctreeManager::OctreeNode& OctreeManager::node(NodeId id) {
+    ghoul_assert(id.branch >= 0 && id.branch < 8, "Node must not be the root");
+    return _nodes[id.branch][id.index];
+}
 
-        if (depth > static_cast<int>(_totalDepth)) {
-            _totalDepth = depth;
-        }
-        return true;
+const OctreeManager::OctreeNode& OctreeManager::node(NodeId id) const {
+    ghoul_assert(id.branch >= 0 && id.branch < 8, "Node must not be the root");
+    return _nodes[id.branch][id.index];
+}
+
+OctreeManager::NodeId OctreeManager::childOf(NodeId parent, size_t childIndex) const {
+    if (parent.branch == -1) {
+        return { static_cast<int>(childIndex), 0 };
     }
-    else if (node.isLeaf) {
-        // Too many stars in leaf node, subdivide into 8 new nodes.
-        // Create children and clean up parent.
-        createNodeChildren(node);
-
-        // Distribute stars from parent node into children.
-        for (size_t n = 0; n < MAX_STARS_PER_NODE; ++n) {
-            // Position data.
-            auto posBegin = node.posData.begin() + n * POS_SIZE;
-            auto posEnd = posBegin + POS_SIZE;
-            std::vector<float> tmpValues(posBegin, posEnd);
-            // Color data.
-            auto colBegin = node.colData.begin() + n * COL_SIZE;
-            auto colEnd = colBegin + COL_SIZE;
-            tmpValues.insert(tmpValues.end(), colBegin, colEnd);
-            // Velocity data.
-            auto velBegin = node.velData.begin() + n * VEL_SIZE;
-            auto velEnd = velBegin + VEL_SIZE;
-            tmpValues.insert(tmpValues.end(), velBegin, velEnd);
-
-            // Find out which child that will inherit the data and store it.
-            size_t index = getChildIndex(
-                tmpValues[0],
-                tmpValues[1],
-                tmpValues[2],
-                node.originX,
-                node.originY,
-                node.originZ
-            );
-            insertInNode(*node.Children[index], tmpValues, depth);
-        }
+    const OctreeNode& n = node(parent);
+    ghoul_assert(!n.isLeaf(), "Node must be an inner node");
+    return { parent.branch, n.firstChild + static_cast<int32_t>(childIndex) };
+}
+
+float* OctreeManager::positions(const OctreeNode& node) const {
+    return _arena.data(node.dataClass, node.dataSlot);
+}
+
+float* OctreeManager::colors(const OctreeNode& node) const {
+    const size_t capacity = _arena.capacity(node.dataClass);
+    return _arena.data(node.dataClass, node.dataSlot) + capacity * POS_SIZE;
+}
+
+float* OctreeManager::velocities(const OctreeNode& node) const {
+    const size_t capacity = _arena.capacity(node.dataClass);
+    return _arena.data(node.dataClass, node.dataSlot) +
+        capacity * (POS_SIZE + COL_SIZE);
+}
+
+void OctreeManager::reserveNodeData(OctreeNode& node, size_t nStars) {
+    if (node.dataSlot != -1 && _arena.capacity(node.dataClass) >= nStars) {
+        return;
+    }
+
+    const uint8_t sizeClass = _arena.sizeClassFor(nStars);
+    const int32_t slot = _arena.allocate(sizeClass);
+    if (node.dataSlot != -1) {
+        // Move the stars that are already stored to the bigger slot.
+        const size_t capacity = _arena.capacity(sizeClass);
+        float* data = _arena.data(sizeClass, slot);
+        std::memcpy(data, positions(node), node.numStars * POS_SIZE * sizeof(float));
+        std::memcpy(
+            data + capacity * POS_SIZE,
+            colors(node),
+            node.numStars * COL_SIZE * sizeof(float)
+        );
+        std::memcpy(
+            data + capacity * (POS_SIZE + COL_SIZE),
+            velocities(node),
+            node.numStars * VEL_SIZE * sizeof(float)
+        );
+        _arena.release(node.dataClass, node.dataSlot);
+    }
+    node.dataClass = sizeClass;
+    node.dataSlot = slot;
+}
 
-        // Sort magnitudes in inner node.
-        // (The last value will be used as comparison for what to store in LOD cache.)
-        std::sort(node.magOrder.begin(), node.magOrder.end());
+void OctreeManager::releaseNodeData(OctreeNode& node) {
+    if (node.dataSlot != -1) {
+        _arena.release(node.dataClass, node.dataSlot);
+        node.dataSlot = -1;
+        node.dataClass = 0;
     }
+}
 
-    // Node is an inner node, keep recursion going.
-    // This will also take care of the new star when a subdivision has taken place.
-    size_t index = getChildIndex(
-        starValues[0],
-        starValues[1],
-        starValues[2],
-        node.originX,
-        node.originY,
-        node.originZ
+void OctreeManager::writeStar(const OctreeNode& node, size_t index,
+                              const float* starValues)
+{
+    std::copy_n(starValues, POS_SIZE, positions(node) + index * POS_SIZE);
+    std::copy_n(starValues + POS_SIZE, COL_SIZE, colors(node) + index * COL_SIZE);
+    std::copy_n(
+        starValues + POS_SIZE + COL_SIZE,
+        VEL_SIZE,
+        velocities(node) + index * VEL_SIZE
     );
+}
+
+bool OctreeManager::insertInNode(NodeId id, const float* starValues, int depth) {
+    // Nodes are addressed by index as the node array grows when a leaf is subdivided.
+    while (true) {
+        OctreeNode& n = node(id);
+        if (n.isLeaf() && n.numStars < MAX_STARS_PER_NODE) {
+            // Node is a leaf and it's not yet full -> insert star.
+            storeStarData(n, starValues);
 
-    // Determine if new star should be kept in our LOD cache.
-    // Keeps track of the brightest nodes in children.
-    if (starValues[POS_SIZE] < node.magOrder[MAX_STARS_PER_NODE - 1].first) {
-        storeStarData(node, starValues);
-    }
-
-    return insertInNode(*node.Children[index], starValues, ++depth);
-}
-
-void OctreeManager::sliceNodeLodCache(OctreeNode& node) {
-    // Slice stored LOD data in inner nodes.
-    if (!node.isLeaf) {
-        // Sort by magnitude. Inverse relation (i.e. a lower magnitude means a brighter
-        // star!)
-        std::sort(node.magOrder.begin(), node.magOrder.end());
-        node.magOrder.resize(MAX_STARS_PER_NODE);
-
-        std::vector<float> tmpPos;
-        std::vector<float> tmpCol;
-        std::vector<float> tmpVel;
-        // Ordered map contain the MAX_STARS_PER_NODE brightest stars in all children!
-        for (auto const &[absMag, placement] : node.magOrder) {
-            auto posBegin = node.posData.begin() + placement * POS_SIZE;
-            auto colBegin = node.colData.begin() + placement * COL_SIZE;
-            auto velBegin = node.velData.begin() + placement * VEL_SIZE;
-            tmpPos.insert(tmpPos.end(), posBegin, posBegin + POS_SIZE);
-            tmpCol.insert(tmpCol.end(), colBegin, colBegin + COL_SIZE);
-            tmpVel.insert(tmpVel.end(), velBegin, velBegin + VEL_SIZE);
+            if (depth > static_cast<int>(_totalDepth)) {
+                _totalDepth = depth;
+            }
+            return true;
         }
-        node.posData = std::move(tmpPos);
-        node.colData = std::move(tmpCol);
-        node.velData = std::move(tmpVel);
-        node.numStars = node.magOrder.size(); // = MAX_STARS_PER_NODE
+        else if (n.isLeaf()) {
+            // Too many stars in leaf node, subdivide into 8 new nodes.
+            createNodeChildren(id);
+            const OctreeNode& parent = node(id);
+
+            // Distribute stars from parent node into children. The stars stay in the
+            // parent as its LOD cache.
+            std::vector<float> tmpValues(POS_SIZE + COL_SIZE + VEL_SIZE);
+            for (size_t i = 0; i < MAX_STARS_PER_NODE; ++i) {
+                std::copy_n(positions(parent) + i * POS_SIZE, POS_SIZE, &tmpValues[0]);
+                std::copy_n(
+                    colors(parent) + i * COL_SIZE,
+                    COL_SIZE,
+                    &tmpValues[POS_SIZE]
+                );
+                std::copy_n(
+                    velocities(parent) + i * VEL_SIZE,
+                    VEL_SIZE,
+                    &tmpValues[POS_SIZE + COL_SIZE]
+                );
 
-        for (int i = 0; i < 8; ++i) {
-            sliceNodeLodCache(*node.Children[i]);
+                // Find out which child that will inherit the data and store it. The
+                // children can't overflow as they share the stars of one full node.
+                size_t index = getChildIndex(
+                    tmpValues[0],
+                    tmpValues[1],
+                    tmpValues[2],
+                    parent.originX,
+                    parent.originY,
+                    parent.originZ
+                );
+                storeStarData(node(childOf(id, index)), tmpValues.data());
+            }
+            if (depth + 1 > static_cast<int>(_totalDepth)) {
+                _totalDepth = depth + 1;
+            }
+
+            // Only stars that are brighter than the dimmest star will enter the cache.
+            const float* mags = colors(parent);
+            float threshold = mags[0];
+            for (size_t i = 1; i < parent.numStars; ++i) {
+                threshold = std::max(threshold, mags[i * COL_SIZE]);
+            }
+            node(id).lodThreshold = threshold;
         }
+
+        // Node is an inner node, keep traversal going.
+        // This will also take care of the new star when a subdivision has taken place.
+        OctreeNode& inner = node(id);
+        size_t index = getChildIndex(
+            starValues[0],
+            starValues[1],
+            starValues[2],
+            inner.originX,
+            inner.originY,
+            inner.originZ
+        );
+
+        // Determine if new star should be kept in our LOD cache.
+        // Keeps track of the brightest nodes in children.
+        storeLodStarData(inner, starValues);
+
+        id = childOf(id, index);
+        ++depth;
     }
 }
 
-void OctreeManager::storeStarData(OctreeNode& node, const std::vector<float>& starValues)
-{
-    // Insert star data at the back of vectors and store a vector with pairs consisting of
-    // star magnitude and insert index for later sorting and slicing of LOD cache.
-    float mag = starValues[POS_SIZE];
-    node.magOrder.insert(node.magOrder.end(), std::make_pair(mag, node.numStars));
+void OctreeManager::sliceNodeLodCache(NodeId id) {
+    OctreeNode& n = node(id);
+    if (n.isLeaf()) {
+        return;
+    }
+
+    // Sort by magnitude. Inverse relation (i.e. a lower magnitude means a brighter
+    // star!) Stars with the same magnitude stay in the order they were inserted.
+    if (n.dataSlot != -1) {
+        const float* mags = colors(n);
+        std::vector<uint32_t> order(n.numStars);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(
+            order.begin(),
+            order.end(),
+            [mags, this](uint32_t lhs, uint32_t rhs) {
+                const float lhsMag = mags[lhs * COL_SIZE];
+                const float rhsMag = mags[rhs * COL_SIZE];
+                return lhsMag < rhsMag || (lhsMag == rhsMag && lhs < rhs);
+            }
+        );
+        order.resize(std::min(order.size(), MAX_STARS_PER_NODE));
+
+        // Move the MAX_STARS_PER_NODE brightest stars to a slot that fits them.
+        auto gather = [&order](const float* values, size_t valuesPerStar) {
+            std::vector<float> res(order.size() * valuesPerStar);
+            for (size_t i = 0; i < order.size(); ++i) {
+                std::copy_n(
+                    values + order[i] * valuesPerStar,
+                    valuesPerStar,
+                    &res[i * valuesPerStar]
+                );
+            }
+            return res;
+        };
+        const std::vector<float> pos = gather(positions(n), POS_SIZE);
+        const std::vector<float> col = gather(colors(n), COL_SIZE);
+        const std::vector<float> vel = gather(velocities(n), VEL_SIZE);
+
+        releaseNodeData(n);
+        n.numStars = static_cast<uint32_t>(order.size());
+        reserveNodeData(n, n.numStars);
+        std::copy(pos.begin(), pos.end(), positions(n));
+        std::copy(col.begin(), col.end(), colors(n));
+        std::copy(vel.begin(), vel.end(), velocities(n));
+    }
+
+    for (size_t i = 0; i < 8; ++i) {
+        sliceNodeLodCache(childOf(id, i));
+    }
+}
+
+void OctreeManager::storeStarData(OctreeNode& node, const float* starValues) {
+    reserveNodeData(node, node.numStars + 1);
+    writeStar(node, node.numStars, starValues);
     node.numStars++;
+}
+
+void OctreeManager::storeLodStarData(OctreeNode& node, const float* starValues) {
+    if (!(starValues[POS_SIZE] < node.lodThreshold)) {
+        return;
+    }
+
+    storeStarData(node, starValues);
 
-    // If LOD is growing too large then sort it and resize to [chunk size] to avoid too
-    // much RAM usage and increase threshold for adding new stars.
-    if (node.magOrder.size() > MAX_STARS_PER_NODE * 2) {
-        std::sort(node.magOrder.begin(), node.magOrder.end());
-        node.magOrder.resize(MAX_STARS_PER_NODE);
+    // If LOD is growing too large then slice it to avoid too much RAM usage and
+    // increase threshold for adding new stars.
+    if (node.numStars >= MAX_STARS_PER_NODE * 2) {
+        trimLodCache(node, MAX_STARS_PER_NODE);
     }
+}
 
-    auto posEnd = starValues.begin() + POS_SIZE;
-    auto colEnd = posEnd + COL_SIZE;
-    node.posData.insert(node.posData.end(), starValues.begin(), posEnd);
-    node.colData.insert(node.colData.end(), posEnd, colEnd);
-    node.velData.insert(node.velData.end(), colEnd, starValues.end());
+void OctreeManager::trimLodCache(OctreeNode& node, size_t nStars) {
+    const float* mags = colors(node);
+    std::vector<uint32_t> order(node.numStars);
+    std::iota(order.begin(), order.end(), 0);
+    std::nth_element(
+        order.begin(),
+        order.begin() + (nStars - 1),
+        order.end(),
+        [mags, this](uint32_t lhs, uint32_t rhs) {
+            const float lhsMag = mags[lhs * COL_SIZE];
+            const float rhsMag = mags[rhs * COL_SIZE];
+            return lhsMag < rhsMag || (lhsMag == rhsMag && lhs < rhs);
+        }
+    );
+    node.lodThreshold = mags[order[nStars - 1] * COL_SIZE];
+
+    // Compact the kept stars in insertion order. Every star moves to a lower or the same
+    // position, so it can be done in place.
+    std::sort(order.begin(), order.begin() + nStars);
+    float* pos = positions(node);
+    float* col = colors(node);
+    float* vel = velocities(node);
+    for (size_t i = 0; i < nStars; ++i) {
+        std::copy_n(pos + order[i] * POS_SIZE, POS_SIZE, pos + i * POS_SIZE);
+        std::copy_n(col + order[i] * COL_SIZE, COL_SIZE, col + i * COL_SIZE);
+        std::copy_n(vel + order[i] * VEL_SIZE, VEL_SIZE, vel + i * VEL_SIZE);
+    }
+    node.numStars = static_cast<uint32_t>(nStars);
 }
 
-std::string OctreeManager::printStarsPerNode(const OctreeNode& node,
-                                             const std::string& prefix) const
+std::string OctreeManager::printStarsPerNode(NodeId id, const std::string& prefix) const
 {
+    const OctreeNode& n = node(id);
 
     // Print both inner and leaf nodes.
-    auto str = prefix + "} : " + std::to_string(node.numStars);
+    auto str = prefix + "} : " + std::to_string(n.numStars);
 
-    if (node.isLeaf) {
+    if (n.isLeaf()) {
         return str + " - [Leaf] \n";
     }
     else {
-        str += fmt::format("LOD: {} - [Parent]\n", node.posData.size() / POS_SIZE);
-        for (int i = 0; i < 8; ++i) {
+        const size_t nLod = (n.dataSlot != -1) ? n.numStars : 0;
+        str += fmt::format("LOD: {} - [Parent]\n", nLod);
+        for (size_t i = 0; i < 8; ++i) {
             auto pref = prefix + "->" + std::to_string(i);
-            str += printStarsPerNode(*node.Children[i], pref);
+            str += printStarsPerNode(childOf(id, i), pref);
         }
         return str;
     }
 }
 
-std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNode& node,
-                                                                    const glm::dmat4& mvp,
-                                                              const glm::vec2& screenSize,
-                                                                          int& deltaStars,
-                                                                gaia::RenderOption option)
+void OctreeManager::checkNodeIntersection(NodeId id, const glm::dmat4& mvp,
+                                          const glm::vec2& screenSize, int& deltaStars,
+                                          gaia::RenderOption option)
 {
-    std::map<int, std::vector<float>> fetchedData;
+    OctreeNode& node = this->node(id);
     //int depth  = static_cast<int>(log2( MAX_DIST / node->halfDimension ));
 
     // Calculate the corners of the node.
-    std::vector<glm::dvec4> corners(8);
+    std::array<glm::dvec4, 8> corners;
     for (int i = 0; i < 8; ++i) {
         const float x = (i % 2 == 0) ?
             node.originX + node.halfDimension :
@@ -1127,21 +1684,21 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
     if (!(_culler->isVisible(corners, mvp))) {
         // Check if this node or any of its children existed in cache previously.
         // If so, then remove them from cache and add those indices to stack.
-        fetchedData = removeNodeFromCache(node, deltaStars);
-        return fetchedData;
+        removeNodeFromCache(id, deltaStars);
+        return;
     }
 
     // Remove node if it has been unloaded while still in view.
     // (While streaming big datasets.)
-    if (node.bufferIndex != DEFAULT_INDEX && !node.isLoaded && _streamOctree &&
+    if (node.bufferIndex != DEFAULT_INDEX && !node.isLoaded() && _streamOctree &&
         !_datasetFitInMemory)
     {
-        fetchedData = removeNodeFromCache(node, deltaStars);
-        return fetchedData;
+        removeNodeFromCache(id, deltaStars);
+        return;
     }
 
     // Take care of inner nodes.
-    if (!(node.isLeaf)) {
+    if (!(node.isLeaf())) {
         glm::vec2 nodeSize = _culler->getNodeSizeInPixels(corners, mvp, screenSize);
         float totalPixels = nodeSize.x * nodeSize.y;
 
@@ -1150,33 +1707,25 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
         // (as long as it doesn't have loaded children because then we should traverse to
         // lowest loaded level and render it instead)!
         if ((totalPixels < _minTotalPixelsLod) || (_streamOctree &&
-            !_datasetFitInMemory && node.isLoaded && !node.hasLoadedDescendant))
+            !_datasetFitInMemory && node.isLoaded() && !node.hasLoadedDescendant))
         {
             // Get correct insert index from stack if node didn't exist already. Otherwise
             // we will overwrite the old data. Key merging is not a problem here.
             if ((node.bufferIndex == DEFAULT_INDEX) || _rebuildBuffer) {
                 // Return empty if we couldn't claim a buffer stream index.
                 if (!updateBufferIndex(node)) {
-                    return fetchedData;
+                    return;
                 }
 
                 // We're in an inner node, remove indices from potential children in cache
-                for (int i = 0; i < 8; ++i) {
-                    std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                        *node.Children[i],
-                        deltaStars
-                    );
-                    fetchedData.insert(tmpData.begin(), tmpData.end());
+                for (size_t i = 0; i < 8; ++i) {
+                    removeNodeFromCache(childOf(id, i), deltaStars);
                 }
 
                 // Insert data and adjust stars added in this frame.
-                fetchedData[node.bufferIndex] = constructInsertData(
-                    node,
-                    option,
-                    deltaStars
-                );
+                recordChunkInsert(node, option, deltaStars);
             }
-            return fetchedData;
+            return;
         }
     }
     // Return node data if node is a leaf.
@@ -1185,56 +1734,36 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
         if ((node.bufferIndex == DEFAULT_INDEX) || _rebuildBuffer) {
             // Return empty if we couldn't claim a buffer stream index.
             if (!updateBufferIndex(node)) {
-                return fetchedData;
+                return;
             }
 
             // Insert data and adjust stars added in this frame.
-            fetchedData[node.bufferIndex] = constructInsertData(
-                node,
-                option,
-                deltaStars
-            );
+            recordChunkInsert(node, option, deltaStars);
         }
-        return fetchedData;
+        return;
     }
 
     // We're in a big, visible inner node -> remove it from cache if it existed.
     // But not its children -> set recursive check to false.
-    fetchedData = removeNodeFromCache(node, deltaStars, false);
+    removeNodeFromCache(id, deltaStars, false);
 
     // Recursively check if children should be rendered.
     for (size_t i = 0; i < 8; ++i) {
-        // Observe that if there exists identical keys in fetchedData then those values in
-        // tmpData will be ignored! Thus we store the removed keys until next render call!
-        std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *node.Children[i],
-            mvp,
-            screenSize,
-            deltaStars,
-            option
-        );
-        fetchedData.insert(tmpData.begin(), tmpData.end());
+        checkNodeIntersection(childOf(id, i), mvp, screenSize, deltaStars, option);
     }
-    return fetchedData;
 }
 
-std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode& node,
-                                                                     int& deltaStars,
-                                                                     bool recursive)
-{
-    std::map<int, std::vector<float>> keysToRemove;
-
-    // If we're in rebuilding mode then there is no need to remove any nodes.
-    //if (_rebuildBuffer) return keysToRemove;
+void OctreeManager::removeNodeFromCache(NodeId id, int& deltaStars, bool recursive) {
+    OctreeNode& node = this->node(id);
 
     // Check if this node was rendered == had a specified index.
     if (node.bufferIndex != DEFAULT_INDEX) {
 
         // Reclaim that index. We need to wait until next render call to use it again!
-        _removedKeysInPrevCall.insert(node.bufferIndex);
+        _removedKeysInPrevCall.push_back(node.bufferIndex);
 
-        // Insert dummy node at offset index that should be removed from render.
-        keysToRemove[node.bufferIndex] = std::vector<float>();
+        // Clear the chunk at the index of the node.
+        recordChunkRemoval(node.bufferIndex);
 
         // Reset index and adjust stars removed this frame.
         node.bufferIndex = DEFAULT_INDEX;
@@ -1242,90 +1771,101 @@ std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode&
     }
 
     // Check children recursively if we're in an inner node.
-    if (!(node.isLeaf) && recursive) {
-        for (int i = 0; i < 8; ++i) {
-            std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *node.Children[i],
-                deltaStars
-            );
-            keysToRemove.insert(tmpData.begin(), tmpData.end());
+    if (!(node.isLeaf()) && recursive) {
+        for (size_t i = 0; i < 8; ++i) {
+            removeNodeFromCache(childOf(id, i), deltaStars);
         }
     }
-    return keysToRemove;
 }
 
-std::vector<float> OctreeManager::getNodeData(const OctreeNode& node,
-                                              gaia::RenderOption option)
+void OctreeManager::recordChunkRemoval(int bufferIndex) {
+    int32_t& updateIndex = _chunkUpdateOfBufferIndex[bufferIndex];
+    if (updateIndex != -1) {
+        return;
+    }
+
+    updateIndex = static_cast<int32_t>(_bufferUpdates.chunks.size());
+    ChunkUpdate update;
+    update.bufferIndex = bufferIndex;
+    _bufferUpdates.chunks.push_back(update);
+}
+
+void OctreeManager::recordChunkInsert(const OctreeNode& node, gaia::RenderOption option,
+                                      int& deltaStars)
 {
-    // Return node data if node is a leaf.
-    if (node.isLeaf) {
-        int dStars = 0;
-        return constructInsertData(node, option, dStars);
+    ChunkUpdate update;
+    update.bufferIndex = node.bufferIndex;
+    update.nStars = (node.dataSlot != -1) ? node.numStars : 0;
+    update.offset = _bufferUpdates.stagingData.size();
+    update.nValues = appendInsertData(node, option, _bufferUpdates.stagingData);
+
+    // A removal of the same chunk in this call is replaced by the new data.
+    int32_t& updateIndex = _chunkUpdateOfBufferIndex[node.bufferIndex];
+    if (updateIndex == -1) {
+        updateIndex = static_cast<int32_t>(_bufferUpdates.chunks.size());
+        _bufferUpdates.chunks.push_back(update);
+    }
+    else {
+        _bufferUpdates.chunks[updateIndex] = update;
+    }
+
+    // Update deltaStars.
+    deltaStars += static_cast<int>(node.numStars);
+}
+
+void OctreeManager::appendNodeData(NodeId id, gaia::RenderOption option,
+                                   std::vector<float>& data) const
+{
+    const OctreeNode& node = this->node(id);
+
+    // Append node data if node is a leaf.
+    if (node.isLeaf()) {
+        appendInsertData(node, option, data);
+        return;
     }
 
     // If we're not in a leaf, get data from all children recursively.
-    auto nodeData = std::vector<float>();
     for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*node.Children[i], option);
-        nodeData.insert(nodeData.end(), tmpData.begin(), tmpData.end());
+        appendNodeData(childOf(id, i), option, data);
     }
-    return nodeData;
 }
 
-void OctreeManager::clearNodeData(OctreeNode& node) {
-    // Clear data and its allocated memory.
-    node.posData.clear();
-    node.posData.shrink_to_fit();
-    node.colData.clear();
-    node.colData.shrink_to_fit();
-    node.velData.clear();
-    node.velData.shrink_to_fit();
-
-    // Clear magnitudes as well!
-    //std::vector<std::pair<float, size_t>>().swap(node->magOrder);
-    node.magOrder.clear();
+void OctreeManager::clearNodeData(NodeId id) {
+    // Return the memory of all nodes in the subtree to the arena.
+    OctreeNode& node = this->node(id);
+    releaseNodeData(node);
 
-    if (!node.isLeaf) {
+    if (!node.isLeaf()) {
         // Remove data from all children recursively.
         for (size_t i = 0; i < 8; ++i) {
-            clearNodeData(*node.Children[i]);
+            clearNodeData(childOf(id, i));
         }
     }
 }
 
-void OctreeManager::createNodeChildren(OctreeNode& node) {
+void OctreeManager::createNodeChildren(NodeId id) {
+    std::vector<OctreeNode>& branch = _nodes[id.branch];
+    const int32_t firstChild = static_cast<int32_t>(branch.size());
+    branch.resize(branch.size() + 8);
+
+    const OctreeNode& parent = branch[id.index];
     for (size_t i = 0; i < 8; ++i) {
         _numLeafNodes++;
-        node.Children[i] = std::make_shared<OctreeNode>();
-        node.Children[i]->isLeaf = true;
-        node.Children[i]->isLoaded = false;
-        node.Children[i]->hasLoadedDescendant = false;
-        node.Children[i]->bufferIndex = DEFAULT_INDEX;
-        node.Children[i]->octreePositionIndex = (node.octreePositionIndex * 10) + i;
-        node.Children[i]->numStars = 0;
-        node.Children[i]->posData = std::vector<float>();
-        node.Children[i]->colData = std::vector<float>();
-        node.Children[i]->velData = std::vector<float>();
-        node.Children[i]->magOrder = std::vector<std::pair<float, size_t>>();
-        node.Children[i]->halfDimension = node.halfDimension / 2.f;
+        OctreeNode& child = branch[firstChild + i];
+        child.octreePositionIndex = (parent.octreePositionIndex * 10) + i;
+        child.halfDimension = parent.halfDimension / 2.f;
 
         // Calculate new origin.
-        node.Children[i]->originX = node.originX;
-        node.Children[i]->originX += (i % 2 == 0) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
-        node.Children[i]->originY = node.originY;
-        node.Children[i]->originY += (i % 4 < 2) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
-        node.Children[i]->originZ = node.originZ;
-        node.Children[i]->originZ += (i < 4) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
+        child.originX = parent.originX;
+        child.originX += (i % 2 == 0) ? child.halfDimension : -child.halfDimension;
+        child.originY = parent.originY;
+        child.originY += (i % 4 < 2) ? child.halfDimension : -child.halfDimension;
+        child.originZ = parent.originZ;
+        child.originZ += (i < 4) ? child.halfDimension : -child.halfDimension;
     }
 
     // Clean up parent.
-    node.isLeaf = false;
+    branch[id.index].firstChild = firstChild;
     _numLeafNodes--;
     _numInnerNodes++;
 }
@@ -1333,15 +1873,12 @@ void OctreeManager::createNodeChildren(OctreeNode& node) {
 bool OctreeManager::updateBufferIndex(OctreeNode& node) {
     if (node.bufferIndex != DEFAULT_INDEX) {
         // If we're rebuilding Buffer Index Cache then store indices to overwrite later.
-        _removedKeysInPrevCall.insert(node.bufferIndex);
+        _removedKeysInPrevCall.push_back(node.bufferIndex);
     }
 
-    // Make sure node isn't loading/unloading as we're checking isLoaded flag.
-    std::lock_guard lock(node.loadingLock);
-
     // Return false if there are no more spots in our buffer, or if we're streaming and
     // node isn't loaded yet, or if node doesn't have any stars.
-    if (_freeSpotsInBuffer.empty() || (_streamOctree && !node.isLoaded) ||
+    if (_freeSpotsInBuffer.empty() || (_streamOctree && !node.isLoaded()) ||
         node.numStars == 0)
     {
         return false;
@@ -1361,39 +1898,51 @@ bool OctreeManager::updateBufferIndex(OctreeNode& node) {
     return true;
 }
 
-std::vector<float> OctreeManager::constructInsertData(const OctreeNode& node,
-                                                      gaia::RenderOption option,
-                                                      int& deltaStars)
+size_t OctreeManager::appendInsertData(const OctreeNode& node,
+                                       gaia::RenderOption option,
+                                       std::vector<float>& data) const
 {
     // Return early if node doesn't contain any stars!
     if (node.numStars == 0) {
-        return std::vector<float>();
+        return 0;
     }
 
+    // Nodes that are streamed may have been unloaded since the check in
+    // updateBufferIndex, in which case there is no data to insert.
+    const size_t nStars = (node.dataSlot != -1) ? node.numStars : 0;
+    const size_t start = data.size();
+
     // Fill chunk by appending zeroes to data so we overwrite possible earlier values.
     // And more importantly so our attribute pointers knows where to read!
-    auto insertData = std::vector<float>(node.posData.begin(), node.posData.end());
+    if (nStars > 0) {
+        const float* pos = positions(node);
+        data.insert(data.end(), pos, pos + nStars * POS_SIZE);
+    }
     if (_useVBO) {
-        insertData.resize(POS_SIZE * MAX_STARS_PER_NODE, 0.f);
+        data.resize(start + POS_SIZE * MAX_STARS_PER_NODE, 0.f);
     }
     if (option != gaia::RenderOption::Static) {
-        insertData.insert(insertData.end(), node.colData.begin(), node.colData.end());
+        if (nStars > 0) {
+            const float* col = colors(node);
+            data.insert(data.end(), col, col + nStars * COL_SIZE);
+        }
         if (_useVBO) {
-            insertData.resize((POS_SIZE + COL_SIZE) * MAX_STARS_PER_NODE, 0.f);
+            data.resize(start + (POS_SIZE + COL_SIZE) * MAX_STARS_PER_NODE, 0.f);
         }
         if (option == gaia::RenderOption::Motion) {
-            insertData.insert(insertData.end(), node.velData.begin(), node.velData.end());
+            if (nStars > 0) {
+                const float* vel = velocities(node);
+                data.insert(data.end(), vel, vel + nStars * VEL_SIZE);
+            }
             if (_useVBO) {
-                insertData.resize(
-                    (POS_SIZE + COL_SIZE + VEL_SIZE) * MAX_STARS_PER_NODE, 0.f
+                data.resize(
+                    start + (POS_SIZE + COL_SIZE + VEL_SIZE) * MAX_STARS_PER_NODE,
+                    0.f
                 );
             }
         }
     }
-
-    // Update deltaStars.
-    deltaStars += static_cast<int>(node.numStars);
-    return insertData;
+    return data.size() - start;
 }
 
 }  // namespace openspace
@@ -26,9 +26,14 @@
 #define __OPENSPACE_MODULE_GAIA___OCTREEMANAGER___H__
 
 #include <modules/gaia/rendering/gaiaoptions.h>
+#include <modules/gaia/rendering/nodeioscheduler.h>
+#include <modules/gaia/rendering/starencoding.h>
 #include <ghoul/glm.h>
 #include <ghoul/opengl/ghoul_gl.h>
-#include <map>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <stack>
@@ -40,23 +45,80 @@ class OctreeCuller;
 
 class OctreeManager {
 public:
+    /**
+     * A node of the octree. Nodes do not own any memory: the children of an inner node
+     * are the eight consecutive nodes starting at \c firstChild in the node array of the
+     * branch that the node belongs to, and the stars of the node are stored in a slot of
+     * the star data arena.
+     */
     struct OctreeNode {
-        std::shared_ptr<OctreeNode> Children[8];
-        std::vector<float> posData;
-        std::vector<float> colData;
-        std::vector<float> velData;
-        std::vector<std::pair<float, size_t>> magOrder;
-        float originX;
-        float originY;
-        float originZ;
-        float halfDimension;
-        size_t numStars;
-        bool isLeaf;
-        bool isLoaded;
-        bool hasLoadedDescendant;
-        std::mutex loadingLock;
-        int bufferIndex;
-        unsigned long long octreePositionIndex;
+        enum class LoadState : int8_t {
+            Unloaded = 0,
+            Loading,
+            Loaded
+        };
+
+        OctreeNode() = default;
+
+        // Nodes are only copied while the node array of a branch grows, which never
+        // happens at the same time as node data is streamed in or out
+        OctreeNode(const OctreeNode& other);
+        OctreeNode& operator=(const OctreeNode& other);
+
+        bool isLeaf() const;
+        bool isLoaded() const;
+
+        float originX = 0.f;
+        float originY = 0.f;
+        float originZ = 0.f;
+        float halfDimension = 0.f;
+        unsigned long long octreePositionIndex = 0;
+
+        // Index of the first child in the node array of the branch, -1 for a leaf
+        int32_t firstChild = -1;
+
+        // Slot and size class in the star data arena, the slot is -1 if the node does
+        // not have any data in memory
+        int32_t dataSlot = -1;
+        uint8_t dataClass = 0;
+
+        uint32_t numStars = 0;
+
+        // Only stars brighter than this are stored in the LOD cache of an inner node
+        // while the octree is constructed
+        float lodThreshold = 0.f;
+
+        int bufferIndex = -1;
+
+        // Written by the threads that stream node data and read during the traversal
+        std::atomic<LoadState> loadState = LoadState::Unloaded;
+        std::atomic_bool hasLoadedDescendant = false;
+    };
+
+    /**
+     * The change of one chunk in the render buffer(s) that was found by
+     * <code>traverseData()</code>.
+     */
+    struct ChunkUpdate {
+        /// The index of the chunk in the render buffer(s)
+        int bufferIndex = -1;
+        /// The number of stars in the chunk after the update, 0 if the chunk was cleared
+        uint32_t nStars = 0;
+        /// The index of the first value of the chunk in the staging data
+        size_t offset = 0;
+        /// The number of values of the chunk in the staging data
+        size_t nValues = 0;
+    };
+
+    /**
+     * All chunks that changed in one call to <code>traverseData()</code> together with
+     * the values that should be written to them. Every chunk occurs at most once. The
+     * vectors keep their memory between calls, so no memory is allocated once they have
+     * grown to fit the largest update.
+     */
+    struct BufferUpdates {
+        std::vector<ChunkUpdate> chunks;
+        std::vector<float> stagingData;
     };
 
     OctreeManager() = default;
@@ -111,16 +173,16 @@ public:
         const glm::ivec2& additionalNodes);
 
     /**
-     * Builds render data structure by traversing the Octree and checking for intersection
-     * with view frustum. Every vector in map contains data for one node.
-     * The corresponding integer key is the index where chunk should be inserted into
-     * streaming buffer. Calls <code>checkNodeIntersection()</code> for every branch.
+     * Traverses the Octree and checks for intersection with view frustum to find the
+     * chunks of the streaming buffer that have to be updated since the previous call.
+     * Chunks that were cleared have no values, chunks that were added hold the data of
+     * one node. Calls <code>checkNodeIntersection()</code> for every branch.
      * \pdeltaStars keeps track of how many stars that were added/removed this render
      * call.
+     * \returns the updates, which stay valid until the next call to this function.
      */
-    std::map<int, std::vector<float>> traverseData(const glm::dmat4& mvp,
-        const glm::vec2& screenSize, int& deltaStars, gaia::RenderOption option,
-        float lodPixelThreshold);
+    const BufferUpdates& traverseData(const glm::dmat4& mvp, const glm::vec2& screenSize,
+        int& deltaStars, gaia::RenderOption option, float lodPixelThreshold);
 
     /**
      * Builds full render data structure by traversing all leaves in the Octree.
@@ -158,6 +220,20 @@ public:
      */
     void writeToMultipleFiles(const std::string& outFolderPath, size_t branchIndex);
 
+    /**
+     * Sets the encoding of the star data that is written by <code>writeToFile()</code>
+     * and <code>writeToMultipleFiles()</code>. <code>readFromFile()</code> replaces it
+     * with the encoding of the read file, which is also used for the streamed nodes.
+     */
+    void setStarEncoding(gaia::StarEncoding encoding);
+    gaia::StarEncoding starEncoding() const;
+
+    /**
+     * \returns the errors of all nodes that have been written with
+     *          gaia::StarEncoding::Quantized since the octree was initialized.
+     */
+    gaia::EncodingReport encodingReport() const;
+
     /**
      * Getters.
      */
@@ -176,6 +252,11 @@ public:
      */
     long long cpuRamBudget() const;
 
+    /**
+     * \returns the statistics of the requests for streaming node data from files.
+     */
+    NodeIoScheduler::Stats ioStats() const;
+
 private:
     const size_t POS_SIZE = 3;
     const size_t COL_SIZE = 2;
@@ -199,12 +280,107 @@ private:
     const int DEFAULT_INDEX = -1;
     const std::string BINARY_SUFFIX = ".bin";
 
+    /**
+     * Identifies a node by the branch it belongs to and its index in the node array of
+     * that branch. The root of the octree is not stored in any branch and is identified
+     * by a branch of -1.
+     */
+    struct NodeId {
+        int branch = -1;
+        int32_t index = -1;
+    };
+
+    /**
+     * Pooled storage for the star data of all nodes. Every slot holds the positions,
+     * colors, and velocities of its stars as three consecutive arrays (structure of
+     * arrays). Slots come in size classes whose capacity doubles up to
+     * MAX_STARS_PER_NODE so that sparse leaves don't reserve a full chunk. The slots of a
+     * size class live in pages that are never moved or freed before the arena is
+     * initialized again, so one thread can fill a slot while other slots are read.
+     */
+    class StarArena {
+    public:
+        /**
+         * Releases all slots and prepares the size classes for nodes holding up to
+         * \p maxStarsPerSlot stars of \p valuesPerStar values each.
+         */
+        void initialize(size_t maxStarsPerSlot, size_t valuesPerStar);
+
+        /**
+         * \returns the smallest size class that fits \p nStars stars.
+         */
+        uint8_t sizeClassFor(size_t nStars) const;
+
+        /**
+         * \returns the number of stars that fit in a slot of \p sizeClass.
+         */
+        size_t capacity(uint8_t sizeClass) const;
+
+        int32_t allocate(uint8_t sizeClass);
+        void release(uint8_t sizeClass, int32_t slot);
+
+        /**
+         * \returns the first value of \p slot. The slot has to be allocated.
+         */
+        float* data(uint8_t sizeClass, int32_t slot) const;
+
+    private:
+        static constexpr const size_t MaxPages = 32;
+
+        struct SizeClass {
+            size_t capacity = 0;
+            size_t slotSize = 0;
+            size_t firstPageSlots = 0;
+            size_t nSlots = 0;
+            std::array<std::unique_ptr<float[]>, MaxPages> pages;
+            std::vector<int32_t> freeSlots;
+        };
+
+        std::vector<SizeClass> _classes;
+        mutable std::mutex _mutex;
+    };
+
     /**
      * \returns the correct index of child node. Maps [1,1,1] to 0 and [-1,-1,-1] to 7.
      */
     size_t getChildIndex(float posX, float posY, float posZ, float origX = 0.f,
         float origY = 0.f, float origZ = 0.f);
 
+    /**
+     * \returns the node identified by \p id, which must not be the root.
+     */
+    OctreeNode& node(NodeId id);
+    const OctreeNode& node(NodeId id) const;
+
+    /**
+     * \returns the child with index \p childIndex of \p parent, which can be the root.
+     */
+    NodeId childOf(NodeId parent, size_t childIndex) const;
+
+    /**
+     * Accessors for the star data of a node in the arena. Must only be called for nodes
+     * that have a data slot.
+     */
+    float* positions(const OctreeNode& node) const;
+    float* colors(const OctreeNode& node) const;
+    float* velocities(const OctreeNode& node) const;
+
+    /**
+     * Makes sure that the data slot of \p node has room for \p nStars stars. Already
+     * stored stars are kept if the node is moved to a bigger slot.
+     */
+    void reserveNodeData(OctreeNode& node, size_t nStars);
+
+    /**
+     * Returns the data slot of \p node to the arena.
+     */
+    void releaseNodeData(OctreeNode& node);
+
+    /**
+     * Overwrites star \p index in the data slot of \p node with \p starValues.
+     */
+    void writeStar(const OctreeNode& node, size_t index, const float* starValues);
+
     /**
      * Private help function for <code>insert()</code>. Inserts star into node if leaf and
      * numStars < MAX_STARS_PER_NODE. If a leaf goes above the threshold it is subdivided
@@ -212,28 +388,40 @@ private:
      * If node is an inner node, then star is stores in LOD cache if it is among the
      * brightest stars in all children.
      */
-    bool insertInNode(OctreeNode& node, const std::vector<float>& starValues,
-        int depth = 1);
+    bool insertInNode(NodeId id, const float* starValues, int depth = 1);
 
     /**
-     * Slices LOD cache data in node to the MAX_STARS_PER_NODE brightest stars. This needs
-     * to be called after the last star has been inserted into Octree but before it is
-     * saved to file(s). Slices all descendants recursively.
+     * Slices LOD cache data in node to the MAX_STARS_PER_NODE brightest stars, sorted by
+     * magnitude. This needs to be called after the last star has been inserted into
+     * Octree but before it is saved to file(s). Slices all descendants recursively.
      */
-    void sliceNodeLodCache(OctreeNode& node);
+    void sliceNodeLodCache(NodeId id);
 
     /**
-     * Private help function for <code>insertInNode()</code>. Stores star data in node and
-     * keeps track of the brightest stars all children.
+     * Private help function for <code>insertInNode()</code>. Appends star data to a
+     * node.
      */
-    void storeStarData(OctreeNode& node, const std::vector<float>& starValues);
+    void storeStarData(OctreeNode& node, const float* starValues);
+
+    /**
+     * Private help function for <code>insertInNode()</code>. Stores the star in the LOD
+     * cache of an inner node if it is brighter than the threshold of the node. The cache
+     * has room for twice MAX_STARS_PER_NODE stars and is trimmed to the brightest
+     * MAX_STARS_PER_NODE stars, which raises the threshold, whenever it is full.
+     */
+    void storeLodStarData(OctreeNode& node, const float* starValues);
+
+    /**
+     * Keeps the \p nStars brightest stars in the LOD cache of \p node, in the order in
+     * which they were inserted, and updates the LOD threshold of the node.
+     */
+    void trimLodCache(OctreeNode& node, size_t nStars);
 
     /**
      * Private help function for <code>printStarsPerNode()</code>. \returns an accumulated
      * string containing all descendant nodes.
      */
-    std::string printStarsPerNode(const OctreeNode& node,
-        const std::string& prefix) const;
+    std::string printStarsPerNode(NodeId id, const std::string& prefix) const;
 
     /**
      * Private help function for <code>traverseData()</code>. Recursively checks which
@@ -242,9 +430,8 @@ private:
      * loaded (if streaming). \param deltaStars keeps track of how many stars that were
      * added/removed this render call.
      */
-    std::map<int, std::vector<float>> checkNodeIntersection(OctreeNode& node,
-        const glm::dmat4& mvp, const glm::vec2& screenSize, int& deltaStars,
-        gaia::RenderOption option);
+    void checkNodeIntersection(NodeId id, const glm::dmat4& mvp,
+        const glm::vec2& screenSize, int& deltaStars, gaia::RenderOption option);
 
     /**
      * Checks if specified node existed in cache, and removes it if that's the case.
@@ -252,23 +439,41 @@ private:
      * long as \param recursive is not set to false. \param deltaStars keeps track of how
      * many stars that were removed.
      */
-    std::map<int, std::vector<float>> removeNodeFromCache(OctreeNode& node,
-        int& deltaStars, bool recursive = true);
+    void removeNodeFromCache(NodeId id, int& deltaStars, bool recursive = true);
+
+    /**
+     * Records that the chunk at \p bufferIndex should be cleared, unless data has been
+     * inserted into the same chunk in this render call.
+     */
+    void recordChunkRemoval(int bufferIndex);
+
+    /**
+     * Records that the data of \p node should be inserted into the chunk at its buffer
+     * index and copies the data to the staging data. Replaces a removal of the same
+     * chunk in this render call.
+     *
+     * \param deltaStars keeps track of how many stars that were added.
+     */
+    void recordChunkInsert(const OctreeNode& node, gaia::RenderOption option,
+        int& deltaStars);
 
     /**
-     * Get data in node and its descendants regardless if they are visible or not.
+     * Append data in node and its descendants to \p data regardless if they are visible
+     * or not.
      */
-    std::vector<float> getNodeData(const OctreeNode& node, gaia::RenderOption option);
+    void appendNodeData(NodeId id, gaia::RenderOption option,
+        std::vector<float>& data) const;
 
     /**
-     * Clear data from node and its descendants and shrink vectors to deallocate memory.
+     * Clear data from node and its descendants and return their slots to the arena.
      */
-    void clearNodeData(OctreeNode& node);
+    void clearNodeData(NodeId id);
 
     /**
-     * Contruct default children nodes for specified node.
+     * Contruct default children nodes for specified node. This grows the node array of
+     * the branch, so references to nodes of that branch are invalidated.
      */
-    void createNodeChildren(OctreeNode& node);
+    void createNodeChildren(NodeId id);
 
     /**
      * Checks if node should be inserted into stream or not. \returns true if it should,
@@ -278,35 +483,58 @@ private:
     bool updateBufferIndex(OctreeNode& node);
 
     /**
-     * Node should be inserted into stream. This function \returns the data to be
-     * inserted. If VBOs are used then the chunks will be appended by zeros, otherwise
+     * Node should be inserted into stream. This function appends the data to be inserted
+     * to \p data. If VBOs are used then the chunks will be appended by zeros, otherwise
      * only the star data corresponding to RenderOption \param option will be inserted.
      *
-     * \param deltaStars keeps track of how many stars that were added.
+     * \returns the number of values that were appended.
      */
-    std::vector<float> constructInsertData(const OctreeNode& node,
-        gaia::RenderOption option, int& deltaStars);
+    size_t appendInsertData(const OctreeNode& node, gaia::RenderOption option,
+        std::vector<float>& data) const;
 
     /**
      * Write a node to outFileStream. \param writeData defines if data should be included
      * or if only structure should be written.
      */
-    void writeNodeToFile(std::ofstream& outFileStream, const OctreeNode& node,
-        bool writeData);
+    void writeNodeToFile(std::ofstream& outFileStream, NodeId id, bool writeData);
+
+    /**
+     * Write the star data of \p node as one block of positions, colors, and velocities.
+     */
+    void writeNodeData(std::ofstream& outFileStream, const OctreeNode& node);
+
+    /**
+     * Read the star data of \p node that was written by <code>writeNodeData()</code>.
+     * \returns false if the data could not be read.
+     */
+    bool readNodeData(std::ifstream& inFileStream, OctreeNode& node);
+
+    /**
+     * Copy the star data of \p node from the \p size bytes at \p data, which hold the
+     * contents of a file that was written by <code>writeNodeData()</code>.
+     * \returns false if the data is not a valid node.
+     */
+    bool readNodeData(const std::byte* data, size_t size, OctreeNode& node);
+
+    /**
+     * \returns the number of bytes of the star data in a node file that has the value
+     *          count \p nDataSize with the current star encoding.
+     */
+    size_t nodeDataBytes(int32_t nDataSize) const;
 
     /**
      * Read a node from file and its potential children. \param readData defines if full
      * data or only structure should be read.
      * \returns accumulated sum of all read stars in node and its descendants.
      */
-    int readNodeFromFile(std::ifstream& inFileStream, OctreeNode& node, bool readData);
+    int readNodeFromFile(std::ifstream& inFileStream, NodeId id, bool readData);
 
     /**
      * Write node data to a file. \param outFilePrefix specifies the accumulated path
      * and name of the file. If \param threadWrites is set to true then one new thread
      * will be created for each child to write its descendents.
      */
-    void writeNodeToMultipleFiles(const std::string& outFilePrefix, OctreeNode& node,
+    void writeNodeToMultipleFiles(const std::string& outFilePrefix, NodeId id,
         bool threadWrites);
 
     /**
@@ -319,21 +547,23 @@ private:
         int additionalLevelsToFetch);
 
     /**
-     * Fetches data from all children of \param parentNode, as long as it's not already
+     * Fetches data from all children of \param parent, as long as it's not already
      * fetched, it exists and it can fit in RAM.
      * \param additionalLevelsToFetch determines how many levels of descendants to fetch.
      * If it is set to 0 no additional level will be fetched.
      * If it is set to a negative value then all descendants will be fetched recursively.
-     * Calls <code>fetchNodeDataFromFile()</code> for every child that passes the tests.
+     * Enqueues a request that calls <code>fetchNodeDataFromFile()</code> for every child
+     * that passes the tests. Children closer to the camera are loaded first.
      */
-    void fetchChildrenNodes(OctreeNode& parentNode, int additionalLevelsToFetch);
+    void fetchChildrenNodes(NodeId parent, int additionalLevelsToFetch);
 
     /**
      * Fetches data for specified node from file.
-     * OBS! Only call if node file exists (i.e. node has any data, node->numStars > 0)
-     * and is not already loaded.
+     * OBS! Only call if node file exists (i.e. node has any data, node->numStars > 0).
+     * Nodes that are already loaded or loading are skipped.
+     * \returns the number of bytes that were read from the file.
      */
-    void fetchNodeDataFromFile(OctreeNode& node);
+    size_t fetchNodeDataFromFile(OctreeNode& node);
 
     /**
     * Loops though all nodes in \param nodesToRemove and clears them from RAM.
@@ -353,12 +583,20 @@ private:
      * loaded descendants left. If not, then flag <code>hasLoadedDescendant</code> will be
      * set to false for that parent node and next parent in line will be checked.
      */
-    void propagateUnloadedNodes(std::vector<std::shared_ptr<OctreeNode>> ancestorNodes);
+    void propagateUnloadedNodes(std::vector<NodeId> ancestorNodes);
 
-    std::shared_ptr<OctreeNode> _root;
+    // One node array per child of the root. Branches are constructed, written, and
+    // cleared independently of each other, so they are kept in separate arrays
+    std::array<std::vector<OctreeNode>, 8> _nodes;
+    StarArena _arena;
     std::unique_ptr<OctreeCuller> _culler;
-    std::stack<int> _freeSpotsInBuffer;
-    std::set<int> _removedKeysInPrevCall;
+    std::stack<int, std::vector<int>> _freeSpotsInBuffer;
+    std::vector<int> _removedKeysInPrevCall;
+
+    // The updates of the current render call and, for every buffer index, the position
+    // of its update in the list or -1 if the chunk has not changed in this call
+    BufferUpdates _bufferUpdates;
+    std::vector<int32_t> _chunkUpdateOfBufferIndex;
     std::queue<unsigned long long> _leastRecentlyFetchedNodes;
     std::mutex _leastRecentlyFetchedNodesMutex;
 
@@ -369,17 +607,29 @@ private:
     size_t _valuesPerStar = 0;
     float _minTotalPixelsLod = 0.f;
 
+    gaia::StarEncoding _starEncoding = gaia::StarEncoding::Float32;
+    // Branches are written to multiple files from several threads
+    gaia::EncodingReport _encodingReport;
+    mutable std::mutex _encodingReportMutex;
+
     size_t _maxStackSize = 0;
     bool _rebuildBuffer = false;
     bool _useVBO = false;
     bool _streamOctree = false;
     bool _datasetFitInMemory = false;
-    long long _cpuRamBudget = 0;
+    std::atomic<long long> _cpuRamBudget = 0;
     long long _maxCpuRamBudget = 0;
     unsigned long long _parentNodeOfCamera = 8;
     std::string _streamFolderPath;
     size_t _traversedBranchesInRenderCall = 0;
 
+    // Position of the camera [kPc] when the surrounding nodes were last fetched
+    glm::vec3 _cameraPosition = glm::vec3(0.f);
+
+    // Loads node data while streaming. Declared last so that the requests that are still
+    // executing have finished before any other member is destroyed
+    std::unique_ptr<NodeIoScheduler> _ioScheduler;
+
 }; // class OctreeManager
 
 }  // namespace openspace
@@ -44,8 +44,10 @@
 #include <ghoul/opengl/textureunit.h>
 #include <ghoul/systemcapabilities/generalcapabilitiescomponent.h>
 #include <array>
+#include <chrono>
 #include <fstream>
 #include <cstdint>
+#include <limits>
 
 namespace {
     constexpr const char* _loggerCat = "RenderableGaiaStars";
@@ -225,6 +227,32 @@ namespace {
         "additional stars."
     };
 
+    constexpr openspace::properties::Property::PropertyInfo IoQueuedRequestsInfo = {
+        "IoQueuedRequests",
+        "Queued File Requests",
+        "The number of node data files that are waiting to be loaded while streaming."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo IoInFlightRequestsInfo = {
+        "IoInFlightRequests",
+        "File Requests In Flight",
+        "The number of node data files that are currently being loaded while streaming."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo IoThroughputInfo = {
+        "IoThroughput",
+        "File Throughput",
+        "The number of bytes per second that were read from node data files during the "
+        "last second of streaming."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo IoCancelledRequestsInfo = {
+        "IoCancelledRequests",
+        "Cancelled File Requests",
+        "The total number of node data files that were not loaded because the camera "
+        "moved away from the node before it was its turn."
+    };
+
     constexpr openspace::properties::Property::PropertyInfo LodPixelThresholdInfo = {
         "LodPixelThreshold",
         "LOD Pixel Threshold",
@@ -451,6 +479,15 @@ RenderableGaiaStars::RenderableGaiaStars(const ghoul::Dictionary& dictionary)
     , _nRenderedStars(NumRenderedStarsInfo, 0, 0, 2000000000) // 2 Billion stars
     , _cpuRamBudgetProperty(CpuRamBudgetInfo, 0.f, 0.f, 1.f)
     , _gpuStreamBudgetProperty(GpuStreamBudgetInfo, 0.f, 0.f, 1.f)
+    , _ioQueuedRequests(IoQueuedRequestsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _ioInFlightRequests(IoInFlightRequestsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _ioThroughput(IoThroughputInfo, 0.f, 0.f, std::numeric_limits<float>::max())
+    , _ioCancelledRequests(
+        IoCancelledRequestsInfo,
+        0,
+        0,
+        std::numeric_limits<int>::max()
+    )
     , _maxGpuMemoryPercent(MaxGpuMemoryPercentInfo, 0.45f, 0.f, 1.f)
     , _maxCpuMemoryPercent(MaxCpuMemoryPercentInfo, 0.5f, 0.f, 1.f)
     , _reportGlErrors(ReportGlErrorsInfo, false)
@@ -635,6 +672,18 @@ RenderableGaiaStars::RenderableGaiaStars(const ghoul::Dictionary& dictionary)
     addProperty(_cpuRamBudgetProperty);
     _gpuStreamBudgetProperty.setReadOnly(true);
     addProperty(_gpuStreamBudgetProperty);
+
+    // Add the statistics of the node file requests if we're streaming.
+    if (_fileReaderOption == gaia::FileReaderOption::StreamOctree) {
+        _ioQueuedRequests.setReadOnly(true);
+        addProperty(_ioQueuedRequests);
+        _ioInFlightRequests.setReadOnly(true);
+        addProperty(_ioInFlightRequests);
+        _ioThroughput.setReadOnly(true);
+        addProperty(_ioThroughput);
+        _ioCancelledRequests.setReadOnly(true);
+        addProperty(_ioCancelledRequests);
+    }
 }
 
 bool RenderableGaiaStars::isReady() const {
@@ -949,18 +998,34 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
 
         // Update CPU Budget property.
         _cpuRamBudgetProperty = static_cast<float>(_octreeManager.cpuRamBudget());
+
+        // Update the file request properties, the throughput once per second.
+        const NodeIoScheduler::Stats ioStats = _octreeManager.ioStats();
+        _ioQueuedRequests = static_cast<int>(ioStats.nQueued);
+        _ioInFlightRequests = static_cast<int>(ioStats.nInFlight);
+        _ioCancelledRequests = static_cast<int>(ioStats.nCancelled);
+
+        const auto now = std::chrono::steady_clock::now();
+        const std::chrono::duration<float> dt = now - _ioThroughputTimestamp;
+        if (dt.count() >= 1.f) {
+            const size_t nBytes = ioStats.bytesRead - _ioBytesReadAtTimestamp;
+            _ioThroughput = static_cast<float>(nBytes) / dt.count();
+            _ioBytesReadAtTimestamp = ioStats.bytesRead;
+            _ioThroughputTimestamp = now;
+        }
     }
 
-    // Traverse Octree and build a map with new nodes to render, uses mvp matrix to decide
+    // Traverse Octree and find the chunks that changed, uses mvp matrix to decide
     const int renderOption = _renderOption;
     int deltaStars = 0;
-    std::map<int, std::vector<float>> updateData = _octreeManager.traverseData(
+    const OctreeManager::BufferUpdates& updates = _octreeManager.traverseData(
         modelViewProjMat,
         screenSize,
         deltaStars,
         gaia::RenderOption(renderOption),
         _lodPixelThreshold
     );
+    const float* stagingData = updates.stagingData.data();
 
     // Update number of rendered stars.
     _nStarsToRender += deltaStars;
@@ -986,15 +1051,19 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         int lastValue = _accumulatedIndices.back();
         _accumulatedIndices.resize(nChunksToRender + 1, lastValue);
 
-        // Update vector with accumulated indices.
-        for (const auto& [offset, subData] : updateData) {
-            int newValue = static_cast<int>(subData.size() / _nRenderValuesPerStar) +
-                           _accumulatedIndices[offset];
-            int changeInValue = newValue - _accumulatedIndices[offset + 1];
-            _accumulatedIndices[offset + 1] = newValue;
-            // Propagate change.
-            for (int i = offset + 1; i < nChunksToRender; ++i) {
-                _accumulatedIndices[i + 1] += changeInValue;
+        // Update vector with accumulated indices. Turn it into the number of stars per
+        // chunk, apply all changes, and accumulate again.
+        if (!updates.chunks.empty()) {
+            for (int i = nChunksToRender; i > 0; --i) {
+                _accumulatedIndices[i] -= _accumulatedIndices[i - 1];
+            }
+            for (const OctreeManager::ChunkUpdate& update : updates.chunks) {
+                if (update.bufferIndex < nChunksToRender) {
+                    _accumulatedIndices[update.bufferIndex + 1] = update.nStars;
+                }
+            }
+            for (int i = 0; i < nChunksToRender; ++i) {
+                _accumulatedIndices[i + 1] += _accumulatedIndices[i];
             }
         }
 
@@ -1024,17 +1093,16 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
             GL_STREAM_DRAW
         );
 
-        // Update SSBO with one insert per chunk/node.
-        // The key in map holds the offset index.
-        for (const auto &[offset, subData] : updateData) {
+        // Update SSBO with one insert per changed chunk/node.
+        for (const OctreeManager::ChunkUpdate& update : updates.chunks) {
             // We don't need to fill chunk with zeros for SSBOs!
             // Just check if we have any values to update.
-            if (!subData.empty()) {
+            if (update.nValues > 0) {
                 glBufferSubData(
                     GL_SHADER_STORAGE_BUFFER,
-                    offset * _chunkSize * sizeof(GLfloat),
-                    subData.size() * sizeof(GLfloat),
-                    subData.data()
+                    update.bufferIndex * _chunkSize * sizeof(GLfloat),
+                    update.nValues * sizeof(GLfloat),
+                    stagingData + update.offset
                 );
             }
         }
@@ -1064,19 +1132,20 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
             GL_STREAM_DRAW
         );
 
-        // Update buffer with one insert per chunk/node.
-        //The key in map holds the offset index.
-        for (const auto& [offset, subData] : updateData) {
-            // Fill chunk by appending zeroes so we overwrite possible earlier values.
-            // Only required when removing nodes because chunks are filled up in octree
-            // fetch on add.
-            std::vector<float> vectorData(subData.begin(), subData.end());
-            vectorData.resize(posChunkSize, 0.f);
+        // Chunks are filled up with zeroes by the octree when nodes are added. Removed
+        // chunks have no values and are overwritten with zeroes instead.
+        _zeroChunk.resize(_chunkSize, 0.f);
+        auto chunkValues = [&](const OctreeManager::ChunkUpdate& update) {
+            return (update.nValues > 0) ? stagingData + update.offset : _zeroChunk.data();
+        };
+
+        // Update buffer with one insert per changed chunk/node.
+        for (const OctreeManager::ChunkUpdate& update : updates.chunks) {
             glBufferSubData(
                 GL_ARRAY_BUFFER,
-                offset * posChunkSize * sizeof(GLfloat),
+                update.bufferIndex * posChunkSize * sizeof(GLfloat),
                 posChunkSize * sizeof(GLfloat),
-                vectorData.data()
+                chunkValues(update)
             );
         }
 
@@ -1097,17 +1166,13 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
                 GL_STREAM_DRAW
             );
 
-            // Update buffer with one insert per chunk/node.
-            //The key in map holds the offset index.
-            for (const auto& [offset, subData] : updateData) {
-                // Fill chunk by appending zeroes so we overwrite possible earlier values.
-                std::vector<float> vectorData(subData.begin(), subData.end());
-                vectorData.resize(posChunkSize + colChunkSize, 0.f);
+            // Update buffer with one insert per changed chunk/node.
+            for (const OctreeManager::ChunkUpdate& update : updates.chunks) {
                 glBufferSubData(
                     GL_ARRAY_BUFFER,
-                    offset * colChunkSize * sizeof(GLfloat),
+                    update.bufferIndex * colChunkSize * sizeof(GLfloat),
                     colChunkSize * sizeof(GLfloat),
-                    vectorData.data() + posChunkSize
+                    chunkValues(update) + posChunkSize
                 );
             }
 
@@ -1129,17 +1194,13 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
                     GL_STREAM_DRAW
                 );
 
-                // Update buffer with one insert per chunk/node.
-                //The key in map holds the offset index.
-                for (const auto& [offset, subData] : updateData) {
-                    // Fill chunk by appending zeroes.
-                    std::vector<float> vectorData(subData.begin(), subData.end());
-                    vectorData.resize(_chunkSize, 0.f);
+                // Update buffer with one insert per changed chunk/node.
+                for (const OctreeManager::ChunkUpdate& update : updates.chunks) {
                     glBufferSubData(
                         GL_ARRAY_BUFFER,
-                        offset * velChunkSize * sizeof(GLfloat),
+                        update.bufferIndex * velChunkSize * sizeof(GLfloat),
                         velChunkSize * sizeof(GLfloat),
-                        vectorData.data() + posChunkSize + colChunkSize
+                        chunkValues(update) + posChunkSize + colChunkSize
                     );
                 }
             }
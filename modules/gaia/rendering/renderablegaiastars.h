@@ -39,6 +39,7 @@
 #include <ghoul/opengl/bufferbinding.h>
 #include <ghoul/opengl/ghoul_gl.h>
 #include <ghoul/opengl/uniformcache.h>
+#include <chrono>
 
 namespace ghoul::filesystem { class File; }
 namespace ghoul::opengl {
@@ -161,6 +162,10 @@ private:
     // LongLongProperty doesn't show up in menu, use FloatProperty instead.
     properties::FloatProperty _cpuRamBudgetProperty;
     properties::FloatProperty _gpuStreamBudgetProperty;
+    properties::IntProperty _ioQueuedRequests;
+    properties::IntProperty _ioInFlightRequests;
+    properties::FloatProperty _ioThroughput;
+    properties::IntProperty _ioCancelledRequests;
     properties::FloatProperty _maxGpuMemoryPercent;
     properties::FloatProperty _maxCpuMemoryPercent;
 
@@ -188,6 +193,8 @@ private:
         ghoul::opengl::bufferbinding::Buffer::ShaderStorage>> _ssboDataBinding;
 
     std::vector<int> _accumulatedIndices;
+    // Written to the chunks of the VBOs whose node has been removed
+    std::vector<float> _zeroChunk;
     size_t _nRenderValuesPerStar = 0;
     int _nStarsToRender = 0;
     bool _firstDrawCalls = true;
@@ -198,6 +205,8 @@ private:
     long long _gpuMemoryBudgetInBytes = 0;
     long long _maxStreamingBudgetInBytes = 0;
     size_t _chunkSize = 0;
+    std::chrono::steady_clock::time_point _ioThroughputTimestamp;
+    size_t _ioBytesReadAtTimestamp = 0;
 
     GLuint _vao = 0;
     GLuint _vaoEmpty = 0;
@@ -0,0 +1,307 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/gaia/rendering/starencoding.h>
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+    constexpr const float MaxQuantized = 65535.f;
+    constexpr const float MaxHalf = 65504.f;
+
+    // The smallest value that is stored as a normalized 16-bit float
+    constexpr const float MinNormalHalf = 6.103515625e-05f;
+
+    template <size_t N>
+    struct Range {
+        std::array<float, N> min;
+        std::array<float, N> scale;
+    };
+
+    // The quantized payload of a node starts with the ranges that the positions and the
+    // colors were quantized to, followed by the quantized values themselves
+    constexpr const size_t HeaderSize = sizeof(Range<3>) + sizeof(Range<2>);
+
+    constexpr const size_t ValuesPerStar = 8;
+
+    template <size_t N>
+    Range<N> rangeOf(const float* values, size_t nStars) {
+        std::array<float, N> lo;
+        std::array<float, N> hi;
+        lo.fill(std::numeric_limits<float>::max());
+        hi.fill(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < nStars; ++i) {
+            for (size_t c = 0; c < N; ++c) {
+                const float v = values[i * N + c];
+                if (std::isfinite(v)) {
+                    lo[c] = std::min(lo[c], v);
+                    hi[c] = std::max(hi[c], v);
+                }
+            }
+        }
+
+        Range<N> res;
+        for (size_t c = 0; c < N; ++c) {
+            if (lo[c] > hi[c]) {
+                // There are no finite values at all
+                lo[c] = 0.f;
+                hi[c] = 0.f;
+            }
+            res.min[c] = lo[c];
+            res.scale[c] = (hi[c] - lo[c]) / MaxQuantized;
+        }
+        return res;
+    }
+
+    template <size_t N>
+    void quantize(const float* values, size_t nStars, const Range<N>& range,
+                  uint16_t* out)
+    {
+        for (size_t i = 0; i < nStars; ++i) {
+            for (size_t c = 0; c < N; ++c) {
+                float q = 0.f;
+                if (range.scale[c] > 0.f) {
+                    q = std::round((values[i * N + c] - range.min[c]) / range.scale[c]);
+                }
+                // The negated comparison also catches NaN
+                if (!(q >= 0.f)) {
+                    q = 0.f;
+                }
+                out[i * N + c] = static_cast<uint16_t>(std::min(q, MaxQuantized));
+            }
+        }
+    }
+
+    template <size_t N>
+    void dequantize(const uint16_t* values, size_t nStars, const Range<N>& range,
+                    float* out)
+    {
+        // N is known at compile time, so the inner loop is unrolled and the outer loop
+        // is vectorized over the interleaved components
+        for (size_t i = 0; i < nStars; ++i) {
+            for (size_t c = 0; c < N; ++c) {
+                out[i * N + c] = range.min[c] + values[i * N + c] * range.scale[c];
+            }
+        }
+    }
+
+    template <typename T>
+    T* writeTo(std::byte*& out, size_t n) {
+        T* res = reinterpret_cast<T*>(out);
+        out += n * sizeof(T);
+        return res;
+    }
+
+    template <typename T>
+    const T* readFrom(const std::byte*& in, size_t n) {
+        const T* res = reinterpret_cast<const T*>(in);
+        in += n * sizeof(T);
+        return res;
+    }
+
+    template <typename T>
+    void readValue(const std::byte*& in, T& value) {
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+    }
+} // namespace
+
+namespace openspace::gaia {
+
+void EncodingReport::merge(const EncodingReport& other) {
+    nStars += other.nStars;
+    nFloatBytes += other.nFloatBytes;
+    nEncodedBytes += other.nEncodedBytes;
+    maxPositionError = std::max(maxPositionError, other.maxPositionError);
+    maxMagnitudeError = std::max(maxMagnitudeError, other.maxMagnitudeError);
+    maxColorError = std::max(maxColorError, other.maxColorError);
+    maxVelocityError = std::max(maxVelocityError, other.maxVelocityError);
+    maxRelativeVelocityError = std::max(
+        maxRelativeVelocityError,
+        other.maxRelativeVelocityError
+    );
+}
+
+size_t encodedNodeSize(StarEncoding encoding, size_t nStars) {
+    switch (encoding) {
+        case StarEncoding::Float32:
+            return nStars * ValuesPerStar * sizeof(float);
+        case StarEncoding::Quantized:
+            if (nStars == 0) {
+                return 0;
+            }
+            return HeaderSize + nStars * ValuesPerStar * sizeof(uint16_t);
+        default:
+            throw ghoul::MissingCaseException();
+    }
+}
+
+void encodeQuantizedNode(const float* positions, const float* colors,
+                       const float* velocities, size_t nStars, std::byte* out,
+                       EncodingReport* report)
+{
+    if (nStars == 0) {
+        return;
+    }
+
+    const Range<3> positionRange = rangeOf<3>(positions, nStars);
+    const Range<2> colorRange = rangeOf<2>(colors, nStars);
+    std::memcpy(out, &positionRange, sizeof(Range<3>));
+    out += sizeof(Range<3>);
+    std::memcpy(out, &colorRange, sizeof(Range<2>));
+    out += sizeof(Range<2>);
+
+    uint16_t* qPositions = writeTo<uint16_t>(out, 3 * nStars);
+    uint16_t* qColors = writeTo<uint16_t>(out, 2 * nStars);
+    uint16_t* qVelocities = writeTo<uint16_t>(out, 3 * nStars);
+    quantize<3>(positions, nStars, positionRange, qPositions);
+    quantize<2>(colors, nStars, colorRange, qColors);
+    for (size_t i = 0; i < 3 * nStars; ++i) {
+        qVelocities[i] = floatToHalf(velocities[i]);
+    }
+
+    if (!report) {
+        return;
+    }
+
+    // Measure the errors on the values that will actually be seen after loading
+    std::vector<float> decoded(ValuesPerStar * nStars);
+    float* dPositions = decoded.data();
+    float* dColors = dPositions + 3 * nStars;
+    float* dVelocities = dColors + 2 * nStars;
+    dequantize<3>(qPositions, nStars, positionRange, dPositions);
+    dequantize<2>(qColors, nStars, colorRange, dColors);
+    halfToFloat(qVelocities, 3 * nStars, dVelocities);
+
+    EncodingReport r;
+    r.nStars = nStars;
+    r.nFloatBytes = encodedNodeSize(StarEncoding::Float32, nStars);
+    r.nEncodedBytes = encodedNodeSize(StarEncoding::Quantized, nStars);
+    for (size_t i = 0; i < 3 * nStars; ++i) {
+        const float error = std::abs(dPositions[i] - positions[i]);
+        r.maxPositionError = std::max(r.maxPositionError, error);
+    }
+    for (size_t i = 0; i < nStars; ++i) {
+        const float magError = std::abs(dColors[2 * i] - colors[2 * i]);
+        const float colError = std::abs(dColors[2 * i + 1] - colors[2 * i + 1]);
+        r.maxMagnitudeError = std::max(r.maxMagnitudeError, magError);
+        r.maxColorError = std::max(r.maxColorError, colError);
+    }
+    for (size_t i = 0; i < 3 * nStars; ++i) {
+        const float v = std::clamp(velocities[i], -MaxHalf, MaxHalf);
+        const float error = std::abs(dVelocities[i] - v);
+        r.maxVelocityError = std::max(r.maxVelocityError, error);
+        if (std::abs(v) >= MinNormalHalf) {
+            const float relError = error / std::abs(v);
+            r.maxRelativeVelocityError = std::max(r.maxRelativeVelocityError, relError);
+        }
+    }
+    report->merge(r);
+}
+
+bool decodeQuantizedNode(const std::byte* data, size_t size, size_t nStars,
+                       float* positions, float* colors, float* velocities)
+{
+    if (nStars == 0) {
+        return true;
+    }
+    if (size < encodedNodeSize(StarEncoding::Quantized, nStars)) {
+        return false;
+    }
+
+    Range<3> positionRange;
+    Range<2> colorRange;
+    readValue(data, positionRange);
+    readValue(data, colorRange);
+
+    // The payload follows a 4 byte value count and a 40 byte header in the file, so the
+    // 16-bit values are always aligned
+    const uint16_t* qPositions = readFrom<uint16_t>(data, 3 * nStars);
+    const uint16_t* qColors = readFrom<uint16_t>(data, 2 * nStars);
+    const uint16_t* qVelocities = readFrom<uint16_t>(data, 3 * nStars);
+    dequantize<3>(qPositions, nStars, positionRange, positions);
+    dequantize<2>(qColors, nStars, colorRange, colors);
+    halfToFloat(qVelocities, 3 * nStars, velocities);
+    return true;
+}
+
+uint16_t floatToHalf(float value) {
+    // Clamping first means that the result is never infinite, which the decoder relies
+    // on. The negated comparison maps NaN to 0
+    if (!(std::abs(value) <= MaxHalf)) {
+        value = std::isnan(value) ? 0.f : std::copysign(MaxHalf, value);
+    }
+
+    uint32_t f;
+    std::memcpy(&f, &value, sizeof(float));
+    const uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+
+    uint16_t res;
+    if (f < (113u << 23)) {
+        // Subnormal half floats or zero. Adding 0.5 shifts the mantissa into place and
+        // rounds it to nearest even in the floating point addition
+        constexpr const uint32_t MagicBits = ((127 - 15) + (23 - 10) + 1) << 23;
+        float magic;
+        std::memcpy(&magic, &MagicBits, sizeof(float));
+        float shifted;
+        std::memcpy(&shifted, &f, sizeof(float));
+        shifted += magic;
+        uint32_t bits;
+        std::memcpy(&bits, &shifted, sizeof(float));
+        res = static_cast<uint16_t>(bits - MagicBits);
+    }
+    else {
+        // Rebias the exponent and round the mantissa to nearest even
+        const uint32_t mantissaOdd = (f >> 13) & 1;
+        f += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff + mantissaOdd;
+        res = static_cast<uint16_t>(f >> 13);
+    }
+    return static_cast<uint16_t>(res | (sign >> 16));
+}
+
+void halfToFloat(const uint16_t* values, size_t n, float* out) {
+    // Moving exponent and mantissa into place and scaling by 2^112 rebiases the exponent
+    // and normalizes subnormal values in a single multiplication. There are no infinite
+    // or NaN values to take care of, so the loop has no branches and is vectorized
+    constexpr const float Rebias = 5.192296858534828e+33f; // 2^112
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t h = values[i];
+        uint32_t bits = (h & 0x7fffu) << 13;
+        float f;
+        std::memcpy(&f, &bits, sizeof(float));
+        f *= Rebias;
+        std::memcpy(&bits, &f, sizeof(float));
+        bits |= (h & 0x8000u) << 16;
+        std::memcpy(&out[i], &bits, sizeof(float));
+    }
+}
+
+} // namespace openspace::gaia
@@ -0,0 +1,120 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GAIA___STARENCODING___H__
+#define __OPENSPACE_MODULE_GAIA___STARENCODING___H__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace openspace::gaia {
+
+/**
+ * The ways in which the star data of the octree nodes can be stored in files. The
+ * encoding of an octree is stored in its index file (or the single file that contains
+ * the whole octree) and applies to all of its nodes. The encoding only affects the files:
+ * stars are always decoded to 32-bit floats when a node is read, so the memory that the
+ * loaded nodes use and the data that is uploaded to the GPU are the same for all
+ * encodings.
+ */
+enum class StarEncoding : int32_t {
+    /// Positions, colors, and velocities as 32-bit floats
+    Float32 = 0,
+    /// Positions, magnitudes, and colors quantized to 16 bits within the range of the
+    /// values in the node, and velocities as 16-bit floats. The files take half the
+    /// space on disk, so streaming a node reads half as many bytes
+    Quantized = 1
+};
+
+/**
+ * The version of octree files that store the encoding of their stars. These files start
+ * with the negated version followed by the encoding in front of the header of the older
+ * files, which started with the (positive) number of values per star and always used
+ * StarEncoding::Float32.
+ */
+constexpr const int32_t EncodedFileVersion = 2;
+
+/**
+ * The largest errors that were introduced by encoding stars with StarEncoding::Quantized
+ * together with the number of bytes that were saved.
+ */
+struct EncodingReport {
+    size_t nStars = 0;
+    /// The number of bytes that the stars would have needed as 32-bit floats
+    size_t nFloatBytes = 0;
+    /// The number of bytes of the encoded stars
+    size_t nEncodedBytes = 0;
+
+    /// The largest error of a position component [kPc]
+    float maxPositionError = 0.f;
+    float maxMagnitudeError = 0.f;
+    float maxColorError = 0.f;
+    /// The largest error of a velocity component
+    float maxVelocityError = 0.f;
+    /// The largest error of a velocity component relative to the component itself, for
+    /// all components that are large enough to be stored as normalized 16-bit floats
+    float maxRelativeVelocityError = 0.f;
+
+    void merge(const EncodingReport& other);
+};
+
+/**
+ * \return the number of bytes that \p nStars stars take up in a node file with the
+ *         provided \p encoding, not including the number of values in front of them
+ */
+size_t encodedNodeSize(StarEncoding encoding, size_t nStars);
+
+/**
+ * Encodes the positions (3 values per star), colors (2 values per star), and velocities
+ * (3 values per star) of \p nStars stars with StarEncoding::Quantized into \p out, which
+ * must have room for <code>encodedNodeSize(StarEncoding::Quantized, nStars)</code> bytes.
+ * If a \p report is provided, the stars are decoded again and the errors are added to it.
+ */
+void encodeQuantizedNode(const float* positions, const float* colors,
+    const float* velocities, size_t nStars, std::byte* out,
+    EncodingReport* report = nullptr);
+
+/**
+ * Decodes \p nStars stars that were encoded with <code>encodeQuantizedNode</code> from
+ * the \p size bytes at \p data into 32-bit floats.
+ *
+ * \return false if \p size is too small for the stars
+ */
+bool decodeQuantizedNode(const std::byte* data, size_t size, size_t nStars,
+    float* positions, float* colors, float* velocities);
+
+/**
+ * \return the 16-bit float that is closest to \p value. Values outside of the range of
+ *         16-bit floats are clamped to the largest finite value and NaN becomes 0.
+ */
+uint16_t floatToHalf(float value);
+
+/**
+ * Converts \p n 16-bit floats written by <code>floatToHalf</code> to 32-bit floats.
+ */
+void halfToFloat(const uint16_t* values, size_t n, float* out);
+
+} // namespace openspace::gaia
+
+#endif // __OPENSPACE_MODULE_GAIA___STARENCODING___H__
@@ -24,12 +24,17 @@
 
 #include <modules/gaia/tasks/constructoctreetask.h>
 
+#include <modules/gaia/tasks/octreebuilder.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
+#include <openspace/engine/globals.h>
+#include <openspace/util/taskscheduler.h>
 #include <ghoul/fmt.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <thread>
@@ -37,6 +42,24 @@
 namespace {
     constexpr const char* _loggerCat = "ConstructOctreeTask";
 
+    void logEncodingReport(const openspace::gaia::EncodingReport& report) {
+        if (report.nStars == 0) {
+            return;
+        }
+
+        LINFO(fmt::format(
+            "Wrote {} stars in {} instead of {} bytes of files ({:.1f}%)",
+            report.nStars, report.nEncodedBytes, report.nFloatBytes,
+            100.0 * report.nEncodedBytes / report.nFloatBytes
+        ));
+        LINFO(fmt::format(
+            "Largest encoding errors - Position: {} kPc - Magnitude: {} - Color: {} - "
+            "Velocity: {} ({:.3f}%)",
+            report.maxPositionError, report.maxMagnitudeError, report.maxColorError,
+            report.maxVelocityError, 100.f * report.maxRelativeVelocityError
+        ));
+    }
+
     struct [[codegen::Dictionary(ConstructOctreeTask)]] Parameters {
         // If SingleFileInput is set to true then this specifies the path to a single BIN
         // file containing a full dataset. Otherwise this specifies the path to a folder
@@ -59,6 +82,29 @@ namespace {
         // folder and output multiple files for the Octree
         std::optional<bool> singleFileInput;
 
+        // If true then the Octree is constructed without keeping all stars in memory.
+        // The stars of the input folder are sorted into temporary files on disk and the
+        // branches of the Octree are constructed in parallel. This requires
+        // SingleFileInput to be false and writes the same files as the default folder
+        // mode
+        std::optional<bool> outOfCore;
+
+        // The amount of memory [MB] that is used for the stars that are kept in memory
+        // when OutOfCore is true
+        std::optional<int> memoryBudget [[codegen::greater(0)]];
+
+        // The folder for the temporary files when OutOfCore is true. It needs room for
+        // about twice the size of the input files. Defaults to the output folder
+        std::optional<std::string> spillFolderPath;
+
+        // If true then the octree files are written in half the space by quantizing
+        // positions, magnitudes, and colors to 16 bits within the range of each node and
+        // storing velocities as 16-bit floats. The stars are decoded to 32-bit floats
+        // when they are loaded, so this does not reduce the memory usage while
+        // rendering. The largest errors are reported when the construction is done.
+        // Files written this way can't be read by older versions
+        std::optional<bool> quantizedFileEncoding;
+
         // If defined then only stars with Position X values between [min, max] will be
         // inserted into Octree (if min is set to 0.0 it is read as -Inf, if max is set to
         // 0.0 it is read as +Inf). If min = max then all values equal min|max will be
@@ -216,6 +262,14 @@ ConstructOctreeTask::ConstructOctreeTask(const ghoul::Dictionary& dictionary) {
     _maxDist = p.maxDist.value_or(_maxDist);
     _maxStarsPerNode = p.maxStarsPerNode.value_or(_maxStarsPerNode);
     _singleFileInput = p.singleFileInput.value_or(_singleFileInput);
+    _outOfCore = p.outOfCore.value_or(_outOfCore);
+    _memoryBudget = p.memoryBudget.value_or(_memoryBudget);
+    _spillFolderPath = p.spillFolderPath.has_value() ?
+        absPath(*p.spillFolderPath) :
+        _outFileOrFolderPath;
+    if (p.quantizedFileEncoding.value_or(false)) {
+        _starEncoding = gaia::StarEncoding::Quantized;
+    }
 
     _octreeManager = std::make_shared<OctreeManager>();
     _indexOctreeManager = std::make_shared<OctreeManager>();
@@ -304,7 +358,15 @@ std::string ConstructOctreeTask::description() {
 void ConstructOctreeTask::perform(const Task::ProgressCallback& onProgress) {
     onProgress(0.f);
 
-    if (_singleFileInput) {
+    if (_outOfCore) {
+        if (_singleFileInput) {
+            LERROR("Out-of-core construction requires a folder as input");
+        }
+        else {
+            constructOctreeOutOfCore(onProgress);
+        }
+    }
+    else if (_singleFileInput) {
         constructOctreeFromSingleFile(onProgress);
     }
     else {
@@ -324,6 +386,7 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
     int nTotalStars = 0;
 
     _octreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
+    _octreeManager->setStarEncoding(_starEncoding);
 
     LINFO(fmt::format("Reading data file: {}", _inFileOrFolderPath));
 
@@ -423,6 +486,7 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
         _octreeManager->writeToFile(outFileStream, true);
 
         outFileStream.close();
+        logEncodingReport(_octreeManager->encodingReport());
     }
     else {
         LERROR(fmt::format(
@@ -467,6 +531,7 @@ void ConstructOctreeTask::constructOctreeFromFolder(
     auto writeThreads = std::vector<std::thread>(8);
 
     _indexOctreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
+    _indexOctreeManager->setStarEncoding(_starEncoding);
 
     float processOneFile = 1.f / allInputFiles.size();
 
@@ -611,6 +676,78 @@ void ConstructOctreeTask::constructOctreeFromFolder(
     for (int i = 0; i < 8; ++i) {
         writeThreads[i].join();
     }
+    logEncodingReport(_indexOctreeManager->encodingReport());
+}
+
+void ConstructOctreeTask::constructOctreeOutOfCore(
+                                           const Task::ProgressCallback& progressCallback)
+{
+    // Files are read in a fixed order, as it decides which of two equally bright stars
+    // ends up in the LOD cache
+    std::vector<std::filesystem::path> allInputFiles;
+    if (std::filesystem::is_directory(_inFileOrFolderPath)) {
+        namespace fs = std::filesystem;
+        for (const fs::directory_entry& e : fs::directory_iterator(_inFileOrFolderPath)) {
+            if (e.is_regular_file()) {
+                allInputFiles.push_back(e.path());
+            }
+        }
+    }
+    std::sort(allInputFiles.begin(), allInputFiles.end());
+
+    std::string outFolderPath = _outFileOrFolderPath.string();
+    if (!outFolderPath.empty() && outFolderPath.back() != '/' &&
+        outFolderPath.back() != '\\')
+    {
+        outFolderPath += '/';
+    }
+    std::filesystem::create_directories(_outFileOrFolderPath);
+
+    // The initialization sets the default values if they were not specified
+    _indexOctreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
+    const int maxDist = static_cast<int>(_indexOctreeManager->maxDist());
+    const int maxStarsPerNode = static_cast<int>(_indexOctreeManager->maxStarsPerNode());
+    LINFO(fmt::format(
+        "MAX DIST: {} - MAX STARS PER NODE: {}", maxDist, maxStarsPerNode
+    ));
+
+    OctreeBuilder builder(
+        *global::taskScheduler,
+        maxDist,
+        maxStarsPerNode,
+        static_cast<size_t>(_memoryBudget) * 1024 * 1024,
+        _spillFolderPath,
+        _starEncoding
+    );
+    try {
+        const OctreeBuilder::Result res = builder.build(
+            allInputFiles,
+            outFolderPath,
+            [this](const std::vector<float>& values) { return checkAllFilters(values); },
+            progressCallback
+        );
+
+        LINFO(fmt::format("{} stars were filtered", res.nFilteredStars));
+        LINFO(fmt::format(
+            "A total of {} stars were distributed into {} total nodes",
+            res.nStars, res.nInnerNodes + res.nLeafNodes
+        ));
+        LINFO(fmt::format(
+            "Number leaf nodes: {}\n Number inner nodes: {}\n Total depth of tree: {}",
+            res.nLeafNodes, res.nInnerNodes, res.totalDepth
+        ));
+        LINFO(fmt::format("{} bytes were written to spill files", res.nSpilledBytes));
+        if (res.nDroppedStars > 0) {
+            LWARNING(fmt::format(
+                "{} stars were dropped as they did not fit in the deepest nodes",
+                res.nDroppedStars
+            ));
+        }
+        logEncodingReport(res.encodingReport);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        LERROR(fmt::format("Error constructing octree: {}", e.message));
+    }
 }
 
 bool ConstructOctreeTask::checkAllFilters(const std::vector<float>& filterValues) {
@@ -29,6 +29,7 @@
 
 #include <modules/gaia/rendering/octreeculler.h>
 #include <modules/gaia/rendering/octreemanager.h>
+#include <modules/gaia/rendering/starencoding.h>
 #include <filesystem>
 
 namespace openspace {
@@ -63,6 +64,13 @@ private:
      */
     void constructOctreeFromFolder(const Task::ProgressCallback& progressCallback);
 
+    /**
+     * Constructs the same files as <code>constructOctreeFromFolder</code> with an
+     * OctreeBuilder, which sorts the stars into temporary files on disk rather than
+     * keeping them in memory and constructs the branches of the octree in parallel.
+     */
+    void constructOctreeOutOfCore(const Task::ProgressCallback& progressCallback);
+
     /**
      * Checks all defined filter ranges and \returns true if any of the corresponding
      * <code>filterValues</code> are outside of the defined range.
@@ -84,6 +92,10 @@ private:
     int _maxDist = 0;
     int _maxStarsPerNode = 0;
     bool _singleFileInput = false;
+    bool _outOfCore = false;
+    int _memoryBudget = 1024;
+    std::filesystem::path _spillFolderPath;
+    gaia::StarEncoding _starEncoding = gaia::StarEncoding::Float32;
 
     std::shared_ptr<OctreeManager> _octreeManager;
     std::shared_ptr<OctreeManager> _indexOctreeManager;
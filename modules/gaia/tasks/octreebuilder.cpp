@@ -0,0 +1,633 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/gaia/tasks/octreebuilder.h>
+
+#include <openspace/util/taskscheduler.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+
+namespace {
+    constexpr const char* _loggerCat = "OctreeBuilder";
+
+    constexpr const char* SpillFilePrefix = "gaiaoctree_";
+    constexpr const char* SpillFileSuffix = ".spill";
+
+    // Number of stars that are read from an input or spill file at once
+    constexpr const size_t StarsPerBlock = 1 << 16;
+
+    // Subtrees with fewer stars than this are constructed by the thread that partitioned
+    // their parent, as a new task would cost more than it saves
+    constexpr const size_t MinStarsPerTask = 1 << 14;
+
+    // Index of the magnitude in the render values of a star
+    constexpr const size_t MagnitudeIndex = 3;
+
+    // Returns the child index on level \p depth that is stored in the Morton code
+    size_t digitAt(uint64_t code, int depth) {
+        const int shift = 3 * (openspace::OctreeBuilder::MaxDepth - depth);
+        return static_cast<size_t>((code >> shift) & 7);
+    }
+
+    // Collects records that are appended by multiple threads in one file
+    class SpillWriter {
+    public:
+        explicit SpillWriter(const std::filesystem::path& path)
+            : _stream(path, std::ofstream::binary)
+            , _path(path)
+        {
+            if (!_stream.good()) {
+                throw ghoul::RuntimeError(fmt::format(
+                    "Error creating spill file {}", _path
+                ), "OctreeBuilder");
+            }
+        }
+
+        void write(const void* data, size_t nBytes) {
+            if (nBytes == 0) {
+                return;
+            }
+            std::lock_guard lock(_mutex);
+            _stream.write(reinterpret_cast<const char*>(data), nBytes);
+            if (!_stream.good()) {
+                throw ghoul::RuntimeError(fmt::format(
+                    "Error writing spill file {}", _path
+                ), "OctreeBuilder");
+            }
+            _nBytes += nBytes;
+        }
+
+        size_t nBytes() const {
+            return _nBytes;
+        }
+
+    private:
+        std::ofstream _stream;
+        std::filesystem::path _path;
+        std::mutex _mutex;
+        size_t _nBytes = 0;
+    };
+
+    // Reads the number of values per star and the number of stars of a file that was
+    // written by ReadFitsTask
+    std::pair<int32_t, size_t> readInputHeader(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ifstream::binary);
+        int32_t nValuesPerStar = 0;
+        file.read(reinterpret_cast<char*>(&nValuesPerStar), sizeof(int32_t));
+        if (!file.good() ||
+            nValuesPerStar < openspace::OctreeBuilder::RenderValues)
+        {
+            throw ghoul::RuntimeError(fmt::format(
+                "Error reading star file {}", path
+            ), "OctreeBuilder");
+        }
+
+        const size_t nBytes = std::filesystem::file_size(path) - sizeof(int32_t);
+        return { nValuesPerStar, nBytes / (nValuesPerStar * sizeof(float)) };
+    }
+} // namespace
+
+namespace openspace {
+
+OctreeBuilder::OctreeBuilder(TaskScheduler& scheduler, int maxDist, int maxStarsPerNode,
+                             size_t memoryBudget, std::filesystem::path spillFolder,
+                             gaia::StarEncoding encoding)
+    : _scheduler(scheduler)
+    , _maxDist(maxDist)
+    , _maxStarsPerNode(static_cast<size_t>(maxStarsPerNode))
+    , _maxStarsInMemory(std::max(
+        memoryBudget / sizeof(StarRecord) / std::max(scheduler.numThreads(), 1u),
+        8 * static_cast<size_t>(maxStarsPerNode)
+    ))
+    , _spillFolder(std::move(spillFolder))
+    , _encoding(encoding)
+{
+    ghoul_assert(maxDist > 0, "The octree must have a size");
+    ghoul_assert(maxStarsPerNode > 0, "Nodes must be able to hold stars");
+}
+
+OctreeBuilder::Result OctreeBuilder::build(
+                                     const std::vector<std::filesystem::path>& inputFiles,
+                                                         const std::string& outFolderPath,
+                                                                     const Filter& filter,
+                                                         const ProgressCallback& progress)
+{
+    _outFolderPath = outFolderPath;
+    _progress = progress;
+    _nDroppedStars = 0;
+    _nInnerNodes = 0;
+    _nLeafNodes = 0;
+    _totalDepth = 0;
+    _nSpilledBytes = 0;
+    _nStarsWritten = 0;
+    _nStarsTotal = 0;
+    _encodingReport = gaia::EncodingReport();
+
+    std::filesystem::create_directories(_spillFolder);
+
+    // Spill files are deleted as soon as they have been read, but that doesn't happen for
+    // the subtrees that were not started when an error occurs
+    struct SpillCleanup {
+        const std::filesystem::path& folder;
+        ~SpillCleanup() {
+            namespace fs = std::filesystem;
+            std::error_code ec;
+            for (const fs::directory_entry& e : fs::directory_iterator(folder, ec)) {
+                const std::string name = e.path().filename().string();
+                if (name.rfind(SpillFilePrefix, 0) == 0 &&
+                    e.path().extension() == SpillFileSuffix)
+                {
+                    fs::remove(e.path(), ec);
+                }
+            }
+        }
+    } cleanup = { _spillFolder };
+
+    Result result;
+    std::array<size_t, 8> nStarsPerBranch = {};
+    result.nFilteredStars = partitionInput(inputFiles, filter, nStarsPerBranch);
+    for (size_t n : nStarsPerBranch) {
+        result.nStars += n;
+    }
+    _nStarsTotal = result.nStars;
+
+    std::array<Subtree, 8> branches;
+    {
+        TaskGroup group(_scheduler);
+        for (size_t i = 0; i < 8; ++i) {
+            group.run([this, i, &branches, &nStarsPerBranch]() {
+                const std::string digits = std::to_string(i);
+                branches[i] = buildSpilledNode(
+                    spillPath(digits),
+                    nStarsPerBranch[i],
+                    1,
+                    digits
+                );
+            });
+        }
+        group.wait();
+    }
+
+    // Same layout as OctreeManager::writeToFile without data
+    const std::string indexPath = _outFolderPath + "index.bin";
+    std::ofstream index(indexPath, std::ofstream::binary);
+    const int32_t valuesPerStar = RenderValues;
+    const int32_t maxStarsPerNode = static_cast<int32_t>(_maxStarsPerNode);
+    const int32_t maxDist = _maxDist;
+    if (_encoding != gaia::StarEncoding::Float32) {
+        const int32_t version = -gaia::EncodedFileVersion;
+        const int32_t encoding = static_cast<int32_t>(_encoding);
+        index.write(reinterpret_cast<const char*>(&version), sizeof(int32_t));
+        index.write(reinterpret_cast<const char*>(&encoding), sizeof(int32_t));
+    }
+    index.write(reinterpret_cast<const char*>(&valuesPerStar), sizeof(int32_t));
+    index.write(reinterpret_cast<const char*>(&maxStarsPerNode), sizeof(int32_t));
+    index.write(reinterpret_cast<const char*>(&maxDist), sizeof(int32_t));
+    for (const Subtree& branch : branches) {
+        for (const NodeEntry& node : branch.nodes) {
+            index.write(reinterpret_cast<const char*>(&node.isLeaf), sizeof(bool));
+            index.write(reinterpret_cast<const char*>(&node.numStars), sizeof(int32_t));
+        }
+    }
+    if (!index.good()) {
+        throw ghoul::RuntimeError(fmt::format(
+            "Error writing index file {}", indexPath
+        ), "OctreeBuilder");
+    }
+
+    result.nDroppedStars = _nDroppedStars;
+    result.nStars -= result.nDroppedStars;
+    result.nInnerNodes = _nInnerNodes;
+    result.nLeafNodes = _nLeafNodes;
+    result.totalDepth = _totalDepth;
+    result.nSpilledBytes = _nSpilledBytes;
+    result.encodingReport = _encodingReport;
+    if (_progress) {
+        _progress(1.f);
+    }
+    return result;
+}
+
+bool OctreeBuilder::isBrighter(const StarRecord& lhs, const StarRecord& rhs) {
+    // A lower magnitude means a brighter star. Stars with the same magnitude keep the
+    // order in which they were read
+    const float lhsMag = lhs.values[MagnitudeIndex];
+    const float rhsMag = rhs.values[MagnitudeIndex];
+    return lhsMag < rhsMag || (lhsMag == rhsMag && lhs.sequence < rhs.sequence);
+}
+
+uint64_t OctreeBuilder::mortonCode(const float* position) const {
+    // Same origins and comparisons as the children that the OctreeManager creates, so
+    // that stars on the border of a node end up in the same child
+    float origin[3] = { 0.f, 0.f, 0.f };
+    float halfDimension = static_cast<float>(_maxDist);
+    uint64_t code = 0;
+    for (int depth = 1; depth <= MaxDepth; ++depth) {
+        // The child index of random positions is unpredictable, so it is computed
+        // without branches
+        const bool negX = position[0] < origin[0];
+        const bool negY = position[1] < origin[1];
+        const bool negZ = position[2] < origin[2];
+        code = (code << 3) | (negX | (negY << 1) | (negZ << 2));
+
+        halfDimension /= 2.f;
+        origin[0] += negX ? -halfDimension : halfDimension;
+        origin[1] += negY ? -halfDimension : halfDimension;
+        origin[2] += negZ ? -halfDimension : halfDimension;
+    }
+    return code;
+}
+
+size_t OctreeBuilder::partitionInput(const std::vector<std::filesystem::path>& inputFiles,
+                                     const Filter& filter,
+                                     std::array<size_t, 8>& nStarsPerBranch)
+{
+    struct Block {
+        size_t file = 0;
+        int32_t nValuesPerStar = 0;
+        size_t firstStar = 0;
+        size_t nStars = 0;
+    };
+
+    // Split all files into blocks that are read by independent tasks
+    std::vector<Block> blocks;
+    size_t nInputStars = 0;
+    for (size_t i = 0; i < inputFiles.size(); ++i) {
+        const auto [nValuesPerStar, nStars] = readInputHeader(inputFiles[i]);
+        for (size_t first = 0; first < nStars; first += StarsPerBlock) {
+            blocks.push_back({
+                i,
+                nValuesPerStar,
+                first,
+                std::min(StarsPerBlock, nStars - first)
+            });
+        }
+        nInputStars += nStars;
+        LINFO(fmt::format("Reading {} stars from {}", nStars, inputFiles[i]));
+    }
+
+    std::array<std::unique_ptr<SpillWriter>, 8> branches;
+    for (size_t i = 0; i < 8; ++i) {
+        branches[i] = std::make_unique<SpillWriter>(spillPath(std::to_string(i)));
+    }
+
+    size_t nReadStars = 0;
+    std::atomic<size_t> nFilteredStars = 0;
+    _scheduler.parallelFor(0, blocks.size(), 1, [&](size_t b) {
+        const Block& block = blocks[b];
+        std::ifstream file(inputFiles[block.file], std::ifstream::binary);
+        const size_t starSize = block.nValuesPerStar * sizeof(float);
+        file.seekg(sizeof(int32_t) + block.firstStar * starSize);
+        std::vector<float> values(block.nStars * block.nValuesPerStar);
+        file.read(reinterpret_cast<char*>(values.data()), block.nStars * starSize);
+        if (!file.good()) {
+            throw ghoul::RuntimeError(fmt::format(
+                "Error reading star file {}", inputFiles[block.file]
+            ), "OctreeBuilder");
+        }
+
+        std::array<std::vector<StarRecord>, 8> records;
+        std::vector<float> filterValues(block.nValuesPerStar);
+        size_t nFiltered = 0;
+        for (size_t i = 0; i < block.nStars; ++i) {
+            const float* star = &values[i * block.nValuesPerStar];
+            if (filter) {
+                std::copy_n(star, block.nValuesPerStar, filterValues.begin());
+                if (filter(filterValues)) {
+                    nFiltered++;
+                    continue;
+                }
+            }
+
+            StarRecord record;
+            record.code = mortonCode(star);
+            record.sequence = (static_cast<uint64_t>(block.file) << 40) |
+                (block.firstStar + i);
+            std::copy_n(star, RenderValues, record.values.begin());
+            records[digitAt(record.code, 1)].push_back(record);
+        }
+
+        for (size_t i = 0; i < 8; ++i) {
+            branches[i]->write(
+                records[i].data(),
+                records[i].size() * sizeof(StarRecord)
+            );
+        }
+        nFilteredStars += nFiltered;
+
+        std::lock_guard lock(_progressMutex);
+        nReadStars += block.nStars;
+        if (_progress) {
+            _progress(0.5f * nReadStars / nInputStars);
+        }
+    });
+
+    for (size_t i = 0; i < 8; ++i) {
+        nStarsPerBranch[i] = branches[i]->nBytes() / sizeof(StarRecord);
+        _nSpilledBytes += branches[i]->nBytes();
+    }
+    return nFilteredStars;
+}
+
+OctreeBuilder::Subtree OctreeBuilder::buildSpilledNode(
+                                                   const std::filesystem::path& spillFile,
+                                                                 size_t nStars, int depth,
+                                                                const std::string& digits)
+{
+    if (nStars <= _maxStarsInMemory || depth == MaxDepth) {
+        if (nStars > _maxStarsInMemory) {
+            LWARNING(fmt::format(
+                "Node {} on the deepest level has {} stars, which exceeds the memory "
+                "budget", digits, nStars
+            ));
+        }
+
+        std::vector<StarRecord> stars(nStars);
+        {
+            std::ifstream file(spillFile, std::ifstream::binary);
+            file.read(
+                reinterpret_cast<char*>(stars.data()),
+                nStars * sizeof(StarRecord)
+            );
+            if (!file.good()) {
+                throw ghoul::RuntimeError(fmt::format(
+                    "Error reading spill file {}", spillFile
+                ), "OctreeBuilder");
+            }
+        }
+        std::filesystem::remove(spillFile);
+        return buildNode(stars.data(), stars.data() + stars.size(), depth, digits);
+    }
+
+    // Too many stars to keep in memory, distribute them into one file per child
+    std::array<std::unique_ptr<SpillWriter>, 8> children;
+    for (size_t i = 0; i < 8; ++i) {
+        children[i] = std::make_unique<SpillWriter>(
+            spillPath(digits + std::to_string(i))
+        );
+    }
+    {
+        std::ifstream file(spillFile, std::ifstream::binary);
+        std::vector<StarRecord> block(StarsPerBlock);
+        std::array<std::vector<StarRecord>, 8> records;
+        for (size_t first = 0; first < nStars; first += StarsPerBlock) {
+            const size_t n = std::min(StarsPerBlock, nStars - first);
+            file.read(reinterpret_cast<char*>(block.data()), n * sizeof(StarRecord));
+            if (!file.good()) {
+                throw ghoul::RuntimeError(fmt::format(
+                    "Error reading spill file {}", spillFile
+                ), "OctreeBuilder");
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                records[digitAt(block[i].code, depth + 1)].push_back(block[i]);
+            }
+            for (size_t i = 0; i < 8; ++i) {
+                children[i]->write(
+                    records[i].data(),
+                    records[i].size() * sizeof(StarRecord)
+                );
+                records[i].clear();
+            }
+        }
+    }
+    std::filesystem::remove(spillFile);
+
+    std::array<Subtree, 8> subtrees;
+    TaskGroup group(_scheduler);
+    for (size_t i = 0; i < 8; ++i) {
+        _nSpilledBytes += children[i]->nBytes();
+        const size_t nChildStars = children[i]->nBytes() / sizeof(StarRecord);
+        // Close the file before it is read
+        children[i] = nullptr;
+
+        group.run([this, i, nChildStars, depth, &digits, &subtrees]() {
+            const std::string childDigits = digits + std::to_string(i);
+            subtrees[i] = buildSpilledNode(
+                spillPath(childDigits),
+                nChildStars,
+                depth + 1,
+                childDigits
+            );
+        });
+    }
+    group.wait();
+
+    return mergeChildren(std::move(subtrees), digits);
+}
+
+OctreeBuilder::Subtree OctreeBuilder::buildNode(StarRecord* begin, StarRecord* end,
+                                                int depth, const std::string& digits)
+{
+    const size_t nStars = static_cast<size_t>(end - begin);
+    size_t previousDepth = _totalDepth;
+    while (previousDepth < static_cast<size_t>(depth) &&
+           !_totalDepth.compare_exchange_weak(previousDepth, depth))
+    {}
+
+    if (nStars <= _maxStarsPerNode || depth == MaxDepth) {
+        if (nStars > _maxStarsPerNode) {
+            std::nth_element(begin, begin + _maxStarsPerNode, end, isBrighter);
+            _nDroppedStars += nStars - _maxStarsPerNode;
+            end = begin + _maxStarsPerNode;
+        }
+        const size_t nLeafStars = static_cast<size_t>(end - begin);
+
+        // A leaf holds its stars in the order they were read. Moving the records around
+        // costs more than sorting pointers to them
+        std::vector<const StarRecord*> order(nLeafStars);
+        for (size_t i = 0; i < nLeafStars; ++i) {
+            order[i] = begin + i;
+        }
+        std::sort(
+            order.begin(),
+            order.end(),
+            [](const StarRecord* lhs, const StarRecord* rhs) {
+                return lhs->sequence < rhs->sequence;
+            }
+        );
+        writeNodeFile(_outFolderPath + digits + ".bin", order);
+        _nLeafNodes++;
+
+        std::sort(
+            order.begin(),
+            order.end(),
+            [](const StarRecord* lhs, const StarRecord* rhs) {
+                return isBrighter(*lhs, *rhs);
+            }
+        );
+        Subtree res;
+        res.nodes.push_back({ true, static_cast<int32_t>(nLeafStars) });
+        res.brightest.reserve(nLeafStars);
+        for (const StarRecord* star : order) {
+            res.brightest.push_back(*star);
+        }
+
+        std::lock_guard lock(_progressMutex);
+        _nStarsWritten += nLeafStars;
+        if (_progress && _nStarsTotal > 0) {
+            _progress(0.5f + 0.5f * _nStarsWritten / _nStarsTotal);
+        }
+        return res;
+    }
+
+    // Split the stars into the children by the three bits of the next level
+    auto digitIs = [depth](size_t bit) {
+        return [depth, bit](const StarRecord& star) {
+            return (digitAt(star.code, depth + 1) & bit) == 0;
+        };
+    };
+    std::array<StarRecord*, 9> bounds;
+    bounds[0] = begin;
+    bounds[4] = std::partition(begin, end, digitIs(4));
+    bounds[8] = end;
+    for (size_t i : { 0, 4 }) {
+        bounds[i + 2] = std::partition(bounds[i], bounds[i + 4], digitIs(2));
+    }
+    for (size_t i : { 0, 2, 4, 6 }) {
+        bounds[i + 1] = std::partition(bounds[i], bounds[i + 2], digitIs(1));
+    }
+
+    std::array<Subtree, 8> children;
+    TaskGroup group(_scheduler);
+    for (size_t i = 0; i < 8; ++i) {
+        auto buildChild = [this, i, depth, &bounds, &digits, &children]() {
+            children[i] = buildNode(
+                bounds[i],
+                bounds[i + 1],
+                depth + 1,
+                digits + std::to_string(i)
+            );
+        };
+        if (static_cast<size_t>(bounds[i + 1] - bounds[i]) >= MinStarsPerTask) {
+            group.run(buildChild);
+        }
+        else {
+            buildChild();
+        }
+    }
+    group.wait();
+
+    return mergeChildren(std::move(children), digits);
+}
+
+OctreeBuilder::Subtree OctreeBuilder::mergeChildren(std::array<Subtree, 8> children,
+                                                    const std::string& digits)
+{
+    Subtree res;
+    size_t nNodes = 1;
+    for (const Subtree& child : children) {
+        nNodes += child.nodes.size();
+    }
+
+    // The brightest stars of the subtree are among the brightest stars of the children,
+    // which are sorted already
+    std::vector<StarRecord> merged;
+    for (const Subtree& child : children) {
+        merged.resize(res.brightest.size() + child.brightest.size());
+        std::merge(
+            res.brightest.begin(),
+            res.brightest.end(),
+            child.brightest.begin(),
+            child.brightest.end(),
+            merged.begin(),
+            isBrighter
+        );
+        merged.resize(std::min(merged.size(), _maxStarsPerNode));
+        std::swap(res.brightest, merged);
+    }
+
+    std::vector<const StarRecord*> lod(res.brightest.size());
+    for (size_t i = 0; i < lod.size(); ++i) {
+        lod[i] = &res.brightest[i];
+    }
+    writeNodeFile(_outFolderPath + digits + ".bin", lod);
+    _nInnerNodes++;
+
+    res.nodes.reserve(nNodes);
+    res.nodes.push_back({ false, static_cast<int32_t>(lod.size()) });
+    for (const Subtree& child : children) {
+        res.nodes.insert(res.nodes.end(), child.nodes.begin(), child.nodes.end());
+    }
+    return res;
+}
+
+void OctreeBuilder::writeNodeFile(const std::string& path,
+                                  const std::vector<const StarRecord*>& stars)
+{
+    const size_t nStars = stars.size();
+    // Nodes without stars don't have a file
+    if (nStars == 0) {
+        return;
+    }
+
+    // Same layout as OctreeManager::writeNodeData, with all positions, then all colors,
+    // and then all velocities
+    const int32_t nDataSize = static_cast<int32_t>(nStars * RenderValues);
+    std::vector<float> data(nDataSize);
+    for (size_t i = 0; i < nStars; ++i) {
+        const std::array<float, RenderValues>& v = stars[i]->values;
+        std::copy_n(&v[0], 3, &data[i * 3]);
+        std::copy_n(&v[3], 2, &data[nStars * 3 + i * 2]);
+        std::copy_n(&v[5], 3, &data[nStars * 5 + i * 3]);
+    }
+
+    std::ofstream file(path, std::ofstream::binary);
+    file.write(reinterpret_cast<const char*>(&nDataSize), sizeof(int32_t));
+    if (_encoding == gaia::StarEncoding::Quantized) {
+        std::vector<std::byte> encoded(gaia::encodedNodeSize(_encoding, nStars));
+        gaia::EncodingReport report;
+        gaia::encodeQuantizedNode(
+            &data[0],
+            &data[nStars * 3],
+            &data[nStars * 5],
+            nStars,
+            encoded.data(),
+            &report
+        );
+        file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+
+        std::lock_guard lock(_encodingReportMutex);
+        _encodingReport.merge(report);
+    }
+    else {
+        file.write(reinterpret_cast<const char*>(data.data()), nDataSize * sizeof(float));
+    }
+    if (!file.good()) {
+        throw ghoul::RuntimeError(fmt::format(
+            "Error writing node file {}", path
+        ), "OctreeBuilder");
+    }
+}
+
+std::filesystem::path OctreeBuilder::spillPath(const std::string& digits) const {
+    return _spillFolder / fmt::format("{}{}{}", SpillFilePrefix, digits, SpillFileSuffix);
+}
+
+} // namespace openspace
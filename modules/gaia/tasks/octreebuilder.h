@@ -0,0 +1,220 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GAIA___OCTREEBUILDER___H__
+#define __OPENSPACE_MODULE_GAIA___OCTREEBUILDER___H__
+
+#include <modules/gaia/rendering/starencoding.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace openspace {
+
+class TaskScheduler;
+
+/**
+ * Constructs a streamable octree from star files that don't have to fit in memory. The
+ * result is the same index file and node files that <code>OctreeManager</code> writes
+ * with <code>writeToFile</code> and <code>writeToMultipleFiles</code>, so it can be read
+ * with <code>OctreeManager::readFromFile</code> and streamed from the node files.
+ *
+ * Every star is assigned the Morton code of the deepest octree node that contains it.
+ * Sorting by this code orders the stars the same way as a pre-order traversal of the
+ * octree, so every node covers a contiguous range of codes. The stars are sorted with an
+ * external most-significant-digit radix sort: the input files are distributed into one
+ * spill file per branch of the octree, and every spill file that doesn't fit in memory
+ * is distributed again into one spill file per child. All nodes that fit in memory are
+ * partitioned in place. Subtrees are constructed in parallel on a TaskScheduler.
+ *
+ * A node is a leaf if it has at most the maximum number of stars per node. The LOD cache
+ * of an inner node holds the brightest stars of its subtree, which are taken from the
+ * LOD caches and leaves of its children. Stars keep the order in which they were read,
+ * so the octree is identical to the one constructed by inserting the same stars into an
+ * <code>OctreeManager</code> one by one.
+ */
+class OctreeBuilder {
+public:
+    /// Returns true if the star with the provided values should not be part of the
+    /// octree. The function is called from multiple threads at the same time
+    using Filter = std::function<bool(const std::vector<float>& values)>;
+
+    /// Called with the fraction of the construction that has been completed
+    using ProgressCallback = std::function<void(float)>;
+
+    /// The number of render values of a star: position, magnitude, color, and velocity
+    static constexpr const int RenderValues = 8;
+
+    /// The deepest level of the octree, which is limited by the number of digits of the
+    /// position index of a node in an unsigned long long
+    static constexpr const int MaxDepth = 18;
+
+    struct Result {
+        /// The number of stars in the octree
+        size_t nStars = 0;
+        /// The number of stars that were removed by the filter
+        size_t nFilteredStars = 0;
+        /// The number of stars that didn't fit in the nodes on the deepest level
+        size_t nDroppedStars = 0;
+        size_t nInnerNodes = 0;
+        size_t nLeafNodes = 0;
+        size_t totalDepth = 0;
+        /// The total number of bytes that were written to spill files
+        size_t nSpilledBytes = 0;
+        /// The errors of the node files if they were written with
+        /// gaia::StarEncoding::Quantized
+        gaia::EncodingReport encodingReport;
+    };
+
+    /**
+     * Creates a builder for an octree with a root that covers [-maxDist, maxDist] [kPc]
+     * along every axis and at most \p maxStarsPerNode stars per node.
+     *
+     * \param scheduler The scheduler that executes the partitioning and construction
+     * \param memoryBudget The number of bytes that can be used for the stars that are
+     *        kept in memory. The budget is shared by the threads of the scheduler
+     * \param spillFolder The folder for temporary files, which is created if it doesn't
+     *        exist and needs room for about twice the size of the input files
+     * \param encoding The encoding of the stars in the node files
+     */
+    OctreeBuilder(TaskScheduler& scheduler, int maxDist, int maxStarsPerNode,
+        size_t memoryBudget, std::filesystem::path spillFolder,
+        gaia::StarEncoding encoding = gaia::StarEncoding::Float32);
+
+    /**
+     * Reads all stars from \p inputFiles, which have the format written by ReadFitsTask,
+     * and writes the octree to \p outFolderPath. The index file is called index.bin and
+     * the name of every node file is its position index without the root. Just like the
+     * <code>readFromFile</code> function of the OctreeManager, the path is used as a
+     * prefix, so it needs to end with a separator for the files to end up in the folder.
+     *
+     * \throw ghoul::RuntimeError If any of the input, spill, or output files can't be
+     *        read or written
+     */
+    Result build(const std::vector<std::filesystem::path>& inputFiles,
+        const std::string& outFolderPath, const Filter& filter,
+        const ProgressCallback& progress);
+
+    /**
+     * \return the Morton code of the star at \p position, which holds the child index
+     *         of every level from the root down to MaxDepth with three bits per level.
+     *         The child indices match <code>OctreeManager</code>.
+     */
+    uint64_t mortonCode(const float* position) const;
+
+private:
+    struct StarRecord {
+        uint64_t code = 0;
+        // Position of the star in the input, which decides the order of stars that are
+        // otherwise equal
+        uint64_t sequence = 0;
+        std::array<float, RenderValues> values;
+    };
+
+    // Structure of one node in the index file
+    struct NodeEntry {
+        bool isLeaf = true;
+        int32_t numStars = 0;
+    };
+
+    struct Subtree {
+        // All nodes of the subtree in pre-order
+        std::vector<NodeEntry> nodes;
+        // The brightest stars of the subtree, sorted by magnitude
+        std::vector<StarRecord> brightest;
+    };
+
+    static bool isBrighter(const StarRecord& lhs, const StarRecord& rhs);
+
+    /**
+     * Reads and filters all stars of \p inputFiles in parallel and writes them to the
+     * spill file of their branch.
+     *
+     * \return The number of stars that were removed by the filter
+     */
+    size_t partitionInput(const std::vector<std::filesystem::path>& inputFiles,
+        const Filter& filter, std::array<size_t, 8>& nStarsPerBranch);
+
+    /**
+     * Constructs the subtree of the node at \p depth whose position index without the
+     * root is \p digits from the \p nStars stars in \p spillFile. The stars are loaded
+     * if they fit in memory, otherwise they are distributed to the spill files of the
+     * children first. The spill file is deleted afterwards.
+     */
+    Subtree buildSpilledNode(const std::filesystem::path& spillFile, size_t nStars,
+        int depth, const std::string& digits);
+
+    /**
+     * Constructs the subtree of the node at \p depth from the stars in [\p begin,
+     * \p end), which are reordered in the process.
+     */
+    Subtree buildNode(StarRecord* begin, StarRecord* end, int depth,
+        const std::string& digits);
+
+    /**
+     * Creates the inner node with the 8 \p children and writes its LOD cache.
+     */
+    Subtree mergeChildren(std::array<Subtree, 8> children, const std::string& digits);
+
+    /**
+     * Writes \p stars in the order of the vector in the format that is read by
+     * <code>OctreeManager::readNodeData</code>.
+     */
+    void writeNodeFile(const std::string& path,
+        const std::vector<const StarRecord*>& stars);
+
+    std::filesystem::path spillPath(const std::string& digits) const;
+
+    TaskScheduler& _scheduler;
+    const int _maxDist;
+    const size_t _maxStarsPerNode;
+    // The most stars that one task keeps in memory
+    const size_t _maxStarsInMemory;
+    const std::filesystem::path _spillFolder;
+    const gaia::StarEncoding _encoding;
+    std::string _outFolderPath;
+
+    std::atomic<size_t> _nDroppedStars = 0;
+    std::atomic<size_t> _nInnerNodes = 0;
+    std::atomic<size_t> _nLeafNodes = 0;
+    std::atomic<size_t> _totalDepth = 0;
+    std::atomic<size_t> _nSpilledBytes = 0;
+    size_t _nStarsTotal = 0;
+    ProgressCallback _progress;
+    // Protects the progress callback and the number of stars in the written leaves
+    std::mutex _progressMutex;
+    size_t _nStarsWritten = 0;
+
+    std::mutex _encodingReportMutex;
+    gaia::EncodingReport _encodingReport;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_GAIA___OCTREEBUILDER___H__
@@ -180,7 +180,7 @@ void ReadFitsTask::readAllFitsFilesFromFolder(const Task::ProgressCallback&) {
 
     // Create Threadpool and JobManager.
     LINFO("Threads in pool: " + std::to_string(_threadsToUse));
-    ThreadPool threadPool(_threadsToUse);
+    ThreadPool threadPool(_threadsToUse, TaskScheduler::Priority::IO);
     ConcurrentJobManager<std::vector<std::vector<float>>> jobManager(threadPool);
 
     // Get all files in specified folder.
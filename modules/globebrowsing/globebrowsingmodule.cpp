@@ -26,6 +26,7 @@
 
 #include <modules/globebrowsing/src/basictypes.h>
 #include <modules/globebrowsing/src/dashboarditemglobelocation.h>
+#include <modules/globebrowsing/src/disktilecache.h>
 #include <modules/globebrowsing/src/gdalwrapper.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
 #include <modules/globebrowsing/src/globelabelscomponent.h>
@@ -117,6 +118,43 @@ namespace {
         "The maximum size of the MemoryAwareTileCache, on the CPU and GPU."
     };
 
+    constexpr const openspace::properties::Property::PropertyInfo
+    DiskTileCacheEnabledInfo = {
+        "DiskTileCacheEnabled",
+        "Disk Tile Cache Enabled",
+        "Determines whether tiles are stored on disk after they have been read and "
+        "processed, so that they don't have to be read through GDAL again when they are "
+        "needed after having been removed from the tile cache in memory. Changing the "
+        "value of this property only has an effect after a restart."
+    };
+
+    constexpr const openspace::properties::Property::PropertyInfo
+    DiskTileCacheLocationInfo = {
+        "DiskTileCacheLocation",
+        "Disk Tile Cache Location",
+        "The location of the cache folder for processed tiles. Changing the value of "
+        "this property only has an effect after a restart."
+    };
+
+    constexpr const openspace::properties::Property::PropertyInfo
+    DiskTileCacheSizeInfo = {
+        "DiskTileCacheSize",
+        "Disk Tile Cache Size",
+        "The maximum size (in MB) of all processed tiles on disk. The least recently used "
+        "tiles are removed when the cache exceeds this size. Changing the value of this "
+        "property only has an effect after a restart."
+    };
+
+    constexpr const openspace::properties::Property::PropertyInfo
+    MaxConcurrentTileReadsInfo = {
+        "MaxConcurrentTileReads",
+        "Max Concurrent Tile Reads",
+        "The maximum number of tiles of a single layer that are read at the same time. "
+        "Each concurrent read uses its own GDAL dataset. Layers of local files are also "
+        "limited by the number of processor cores. Changing the value of this property "
+        "only affects layers that are created or reset afterwards."
+    };
+
 
     openspace::GlobeBrowsingModule::Capabilities
     parseSubDatasets(char** subDatasets, int nSubdatasets)
@@ -190,6 +228,18 @@ namespace {
         // [[codegen::verbatim(TileCacheSizeInfo.description)]]
         std::optional<int> tileCacheSize;
 
+        // [[codegen::verbatim(DiskTileCacheEnabledInfo.description)]]
+        std::optional<bool> diskTileCacheEnabled;
+
+        // [[codegen::verbatim(DiskTileCacheLocationInfo.description)]]
+        std::optional<std::string> diskTileCacheLocation;
+
+        // [[codegen::verbatim(DiskTileCacheSizeInfo.description)]]
+        std::optional<int> diskTileCacheSize [[codegen::greater(0)]];
+
+        // [[codegen::verbatim(MaxConcurrentTileReadsInfo.description)]]
+        std::optional<int> maxConcurrentTileReads [[codegen::inrange(1, 32)]];
+
         // If you know what you are doing and you have WMS caching *disabled* but offline
         // mode *enabled*, you can set this value to 'true' to silence a warning that you
         // would otherwise get at startup
@@ -207,12 +257,20 @@ GlobeBrowsingModule::GlobeBrowsingModule()
     , _wmsCacheLocation(WMSCacheLocationInfo, "${BASE}/cache_gdal")
     , _wmsCacheSizeMB(WMSCacheSizeInfo, 1024)
     , _tileCacheSizeMB(TileCacheSizeInfo, 1024)
+    , _diskTileCacheEnabled(DiskTileCacheEnabledInfo, false)
+    , _diskTileCacheLocation(DiskTileCacheLocationInfo, "${BASE}/cache_tiles")
+    , _diskTileCacheSizeMB(DiskTileCacheSizeInfo, 4096)
+    , _maxConcurrentTileReads(MaxConcurrentTileReadsInfo, 4, 1, 32)
 {
     addProperty(_wmsCacheEnabled);
     addProperty(_offlineMode);
     addProperty(_wmsCacheLocation);
     addProperty(_wmsCacheSizeMB);
     addProperty(_tileCacheSizeMB);
+    addProperty(_diskTileCacheEnabled);
+    addProperty(_diskTileCacheLocation);
+    addProperty(_diskTileCacheSizeMB);
+    addProperty(_maxConcurrentTileReads);
 }
 
 void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
@@ -224,6 +282,10 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
     _wmsCacheLocation = p.cacheLocation.value_or(_wmsCacheLocation);
     _wmsCacheSizeMB = p.wmsCacheSize.value_or(_wmsCacheSizeMB);
     _tileCacheSizeMB = p.tileCacheSize.value_or(_tileCacheSizeMB);
+    _diskTileCacheEnabled = p.diskTileCacheEnabled.value_or(_diskTileCacheEnabled);
+    _diskTileCacheLocation = p.diskTileCacheLocation.value_or(_diskTileCacheLocation);
+    _diskTileCacheSizeMB = p.diskTileCacheSize.value_or(_diskTileCacheSizeMB);
+    _maxConcurrentTileReads = p.maxConcurrentTileReads.value_or(_maxConcurrentTileReads);
     const bool noWarning = p.noWarning.value_or(false);
 
     if (!_wmsCacheEnabled && _offlineMode && !noWarning) {
@@ -236,6 +298,14 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
         );
     }
 
+    // The tile readers are created after the module is initialized, so they all see the
+    // same cache
+    if (_diskTileCacheEnabled) {
+        _diskTileCache = std::make_unique<cache::DiskTileCache>(
+            absPath(_diskTileCacheLocation),
+            static_cast<uint64_t>(_diskTileCacheSizeMB) * 1024 * 1024
+        );
+    }
 
     // Initialize
     global::callback::initializeGL->emplace_back([&]() {
@@ -342,6 +412,10 @@ globebrowsing::cache::MemoryAwareTileCache* GlobeBrowsingModule::tileCache() {
     return _tileCache.get();
 }
 
+globebrowsing::cache::DiskTileCache* GlobeBrowsingModule::diskTileCache() {
+    return _diskTileCache.get();
+}
+
 scripting::LuaLibrary GlobeBrowsingModule::luaLibrary() const {
     std::string listLayerGroups = layerGroupNamesList();
 
@@ -825,4 +899,8 @@ uint64_t GlobeBrowsingModule::wmsCacheSize() const {
     return size * 1024 * 1024;
 }
 
+int GlobeBrowsingModule::maxConcurrentTileReads() const {
+    return _maxConcurrentTileReads;
+}
+
 } // namespace openspace
@@ -27,6 +27,7 @@
 
 #include <openspace/properties/stringproperty.h>
 #include <openspace/properties/scalar/boolproperty.h>
+#include <openspace/properties/scalar/intproperty.h>
 #include <openspace/properties/scalar/uintproperty.h>
 #include <openspace/util/openspacemodule.h>
 
@@ -40,7 +41,10 @@ namespace openspace::globebrowsing {
     struct Geodetic2;
     struct Geodetic3;
 
-    namespace cache { class MemoryAwareTileCache; }
+    namespace cache {
+        class DiskTileCache;
+        class MemoryAwareTileCache;
+    } // namespace cache
 } // namespace openspace::globebrowsing
 
 namespace openspace {
@@ -64,6 +68,11 @@ public:
         double latitude, double longitude, double altitude);
 
     globebrowsing::cache::MemoryAwareTileCache* tileCache();
+
+    /**
+     * \return the cache of processed tiles on disk, or nullptr if it is disabled
+     */
+    globebrowsing::cache::DiskTileCache* diskTileCache();
     scripting::LuaLibrary luaLibrary() const override;
     std::vector<documentation::Documentation> documentations() const override;
 
@@ -94,6 +103,7 @@ public:
     bool isInOfflineMode() const;
     std::string wmsCacheLocation() const;
     uint64_t wmsCacheSize() const; // bytes
+    int maxConcurrentTileReads() const;
 
 protected:
     void internalInitialize(const ghoul::Dictionary&) override;
@@ -127,8 +137,13 @@ private:
     properties::StringProperty _wmsCacheLocation;
     properties::UIntProperty _wmsCacheSizeMB;
     properties::UIntProperty _tileCacheSizeMB;
+    properties::BoolProperty _diskTileCacheEnabled;
+    properties::StringProperty _diskTileCacheLocation;
+    properties::UIntProperty _diskTileCacheSizeMB;
+    properties::IntProperty _maxConcurrentTileReads;
 
     std::unique_ptr<globebrowsing::cache::MemoryAwareTileCache> _tileCache;
+    std::unique_ptr<globebrowsing::cache::DiskTileCache> _diskTileCache;
 
     // name -> capabilities
     std::map<std::string, std::future<Capabilities>> _inFlightCapabilitiesMap;
@@ -32,18 +32,52 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/profiling.h>
 #include <ghoul/opengl/ghoul_gl.h>
+#include <algorithm>
+#include <cmath>
 
 namespace openspace::globebrowsing {
 
 namespace {
     constexpr const char* _loggerCat = "AsyncTileDataProvider";
+
+    // The number of tile requests that can wait for execution before the ones with the
+    // lowest priority are dropped
+    constexpr const size_t MaxQueuedTileRequests = 32;
+
+    // The priority and chunk level of the innermost TileRequestPriority on this thread
+    thread_local float CurrentPriority = 0.f;
+    thread_local int CurrentLevel = 0;
 } // namespace
 
+TileRequestPriority::TileRequestPriority(float priority, int level)
+    : _previousPriority(CurrentPriority)
+    , _previousLevel(CurrentLevel)
+{
+    CurrentPriority = priority;
+    CurrentLevel = level;
+}
+
+TileRequestPriority::~TileRequestPriority() {
+    CurrentPriority = _previousPriority;
+    CurrentLevel = _previousLevel;
+}
+
+float TileRequestPriority::priorityForTile(const TileIndex& tileIndex) {
+    const int levelsUp = std::max(CurrentLevel - static_cast<int>(tileIndex.level), 0);
+    // Each level up covers four times the area
+    return std::ldexp(CurrentPriority, 2 * levelsUp);
+}
+
 AsyncTileDataProvider::AsyncTileDataProvider(std::string name,
                                     std::unique_ptr<RawTileDataReader> rawTileDataReader)
     : _name(std::move(name))
     , _rawTileDataReader(std::move(rawTileDataReader))
-    , _concurrentJobManager(LRUThreadPool<TileIndex::TileHashKey>(1, 10))
+    , _concurrentJobManager(
+        PriorityThreadPool<TileIndex::TileHashKey>(
+            _rawTileDataReader->maxConcurrentReads(),
+            MaxQueuedTileRequests
+        )
+    )
 {
     ZoneScoped
 
@@ -57,9 +91,12 @@ const RawTileDataReader& AsyncTileDataProvider::rawTileDataReader() const {
 bool AsyncTileDataProvider::enqueueTileIO(const TileIndex& tileIndex) {
     ZoneScoped
 
-    if (_resetMode == ResetMode::ShouldNotReset && satisfiesEnqueueCriteria(tileIndex)) {
+    const float priority = TileRequestPriority::priorityForTile(tileIndex);
+    if (_resetMode == ResetMode::ShouldNotReset &&
+        satisfiesEnqueueCriteria(tileIndex, priority))
+    {
         auto job = std::make_unique<TileLoadJob>(*_rawTileDataReader, tileIndex);
-        _concurrentJobManager.enqueueJob(std::move(job), tileIndex.hashKey());
+        _concurrentJobManager.enqueueJob(std::move(job), tileIndex.hashKey(), priority);
         _enqueuedTileRequests.insert(tileIndex.hashKey());
         return true;
     }
@@ -67,9 +104,11 @@ bool AsyncTileDataProvider::enqueueTileIO(const TileIndex& tileIndex) {
 }
 
 void AsyncTileDataProvider::clearTiles() {
-    std::optional<RawTile> finishedJob = popFinishedRawTile();
-    while (finishedJob) {
-        finishedJob = popFinishedRawTile();
+    std::vector<std::shared_ptr<Job<RawTile>>> finishedJobs =
+        _concurrentJobManager.popFinishedJobs();
+    for (const std::shared_ptr<Job<RawTile>>& job : finishedJobs) {
+        // The tile data is discarded, the tile is just no longer enqueued
+        _enqueuedTileRequests.erase(job->product().tileIndex.hashKey());
     }
 }
 
@@ -94,11 +133,15 @@ std::optional<RawTile> AsyncTileDataProvider::popFinishedRawTile() {
     }
 }
 
-bool AsyncTileDataProvider::satisfiesEnqueueCriteria(const TileIndex& tileIndex) {
+bool AsyncTileDataProvider::satisfiesEnqueueCriteria(const TileIndex& tileIndex,
+                                                     float priority)
+{
     ZoneScoped
 
-    // Only satisfies if it is not already enqueued. Also bumps the request to the top.
-    const bool alreadyEnqueued = _concurrentJobManager.touch(tileIndex.hashKey());
+    // Only satisfies if it is not already enqueued. Also updates the priority of the
+    // request and keeps it from being cancelled as stale
+    const bool alreadyEnqueued =
+        _concurrentJobManager.touch(tileIndex.hashKey(), priority);
     // Early out so we don't need to check the already enqueued requests
     if (alreadyEnqueued) {
         return false;
@@ -131,8 +174,19 @@ void AsyncTileDataProvider::endEnqueuedJobs() {
 }
 
 void AsyncTileDataProvider::update() {
+    // Requests that were not repeated during the last frame are no longer needed
+    _concurrentJobManager.beginFrame();
     endUnfinishedJobs();
 
+    // The reader lowers the number of concurrent reads if it fails to open another
+    // dataset and recomputes it when it is reset. The reads must never wait for a
+    // dataset inside the pool, so we only run as many of them as there are datasets
+    const int maxConcurrentReads = _rawTileDataReader->maxConcurrentReads();
+    if (maxConcurrentReads != _maxConcurrentReads) {
+        _concurrentJobManager.setMaxConcurrency(maxConcurrentReads);
+        _maxConcurrentReads = maxConcurrentReads;
+    }
+
     // May reset
     switch (_resetMode) {
         case ResetMode::ShouldResetAll: {
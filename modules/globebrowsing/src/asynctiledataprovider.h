@@ -37,6 +37,27 @@ namespace openspace::globebrowsing {
 
 struct RawTile;
 
+/**
+ * Sets the priority of all tile requests that are issued on the calling thread while this
+ * object is alive. The \p priority is the projected screen-space area of the chunk at
+ * \p level that is being updated or rendered. Tiles that are requested at coarser levels
+ * as a fallback for that chunk cover four times the area per level and get a
+ * correspondingly higher priority, so the coarse tiles are always loaded first.
+ */
+class TileRequestPriority {
+public:
+    TileRequestPriority(float priority, int level);
+    ~TileRequestPriority();
+
+    /// Returns the priority for \p tileIndex given the innermost active scope on the
+    /// calling thread, or 0 if there is no active scope
+    static float priorityForTile(const TileIndex& tileIndex);
+
+private:
+    const float _previousPriority;
+    const int _previousLevel;
+};
+
 /**
  * The responsibility of this class is to enqueue tile requests and fetching finished
  * <code>RawTile</code>s that has been asynchronously loaded.
@@ -51,7 +72,8 @@ public:
         std::unique_ptr<RawTileDataReader> rawTileDataReader);
 
     /**
-     * Creates a job which asynchronously loads a raw tile. This job is enqueued.
+     * Creates a job which asynchronously loads a raw tile. This job is enqueued with the
+     * priority of the currently active TileRequestPriority.
      */
     bool enqueueTileIO(const TileIndex& tileIndex);
 
@@ -82,7 +104,7 @@ protected:
     /**
      * \returns true if tile of index <code>tileIndex</code> is not already enqueued.
      */
-    bool satisfiesEnqueueCriteria(const TileIndex& tileIndex);
+    bool satisfiesEnqueueCriteria(const TileIndex& tileIndex, float priority);
 
     /**
      * An unfinished job is a load tile job that has been popped from the thread pool due
@@ -104,6 +126,8 @@ private:
 
     PrioritizingConcurrentJobManager<RawTile, TileIndex::TileHashKey>
         _concurrentJobManager;
+    /// The number of concurrent reads that was last passed to the job manager
+    int _maxConcurrentReads = 0;
 
     std::set<TileIndex::TileHashKey> _enqueuedTileRequests;
 
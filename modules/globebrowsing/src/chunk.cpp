@@ -0,0 +1,434 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <modules/globebrowsing/src/chunk.h>
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <modules/globebrowsing/src/ellipsoid.h>
+#include <openspace/util/taskscheduler.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/profiling.h>
+#include <cmath>
+
+namespace {
+    // Global flags to modify the chunk evaluation
+    constexpr const bool LimitLevelByAvailableData = true;
+    constexpr const bool PerformFrustumCulling = true;
+    constexpr const bool PreformHorizonCulling = true;
+
+    constexpr const int MinSplitDepth = 2;
+    constexpr const int MaxSplitDepth = 22;
+
+    // The number of chunks that are evaluated in one task. The evaluation of a chunk
+    // takes in the order of a microsecond, so smaller batches would spend more time on
+    // the scheduling than on the work
+    constexpr const size_t EvaluationGrainSize = 64;
+
+    const openspace::globebrowsing::AABB3 CullingFrustum{
+        glm::vec3(-1.f, -1.f, 0.f),
+        glm::vec3( 1.f,  1.f, 1e35f)
+    };
+
+    void expand(openspace::globebrowsing::AABB3& bb, const glm::vec3& p) {
+        bb.min = glm::min(bb.min, p);
+        bb.max = glm::max(bb.max, p);
+    }
+
+    bool intersects(const openspace::globebrowsing::AABB3& bb,
+                    const openspace::globebrowsing::AABB3& o)
+    {
+        return (bb.min.x <= o.max.x) && (o.min.x <= bb.max.x)
+            && (bb.min.y <= o.max.y) && (o.min.y <= bb.max.y)
+            && (bb.min.z <= o.max.z) && (o.min.z <= bb.max.z);
+    }
+} // namespace
+
+namespace openspace::globebrowsing {
+
+namespace {
+
+bool isCullableByFrustum(const Chunk& chunk, const glm::dmat4& mvp) {
+    ZoneScoped
+
+    const std::array<glm::dvec4, 8>& corners = chunk.corners;
+
+    // Create a bounding box that fits the patch corners
+    AABB3 bounds; // in screen space
+    for (size_t i = 0; i < 8; ++i) {
+        const glm::dvec4 cornerClippingSpace = mvp * corners[i];
+        const glm::dvec3 ndc = glm::dvec3(
+            (1.f / glm::abs(cornerClippingSpace.w)) * cornerClippingSpace
+        );
+        expand(bounds, ndc);
+    }
+
+    return !(intersects(CullingFrustum, bounds));
+}
+
+bool isCullableByHorizon(const Chunk& chunk, const BoundingHeights& heights,
+                         const ChunkEvaluationContext& context)
+{
+    ZoneScoped
+
+    const Ellipsoid& ellipsoid = *context.ellipsoid;
+    const GeodeticPatch& patch = chunk.surfacePatch;
+    const float maxHeight = heights.max;
+    const glm::dvec3 globePos = glm::dvec3(0.0, 0.0, 0.0); // In model space it is 0
+    const double minimumGlobeRadius = ellipsoid.minimumRadius();
+
+    const glm::dvec3 cameraPos = context.cameraPosition;
+
+    const glm::dvec3 globeToCamera = cameraPos;
+
+    const Geodetic2 camPosOnGlobe = ellipsoid.cartesianToGeodetic2(globeToCamera);
+    const Geodetic2 closestPatchPoint = patch.closestPoint(camPosOnGlobe);
+    glm::dvec3 objectPos = ellipsoid.cartesianSurfacePosition(closestPatchPoint);
+
+    // objectPosition is closest in latlon space but not guaranteed to be closest in
+    // castesian coordinates. Therefore we compare it to the corners and pick the
+    // real closest point,
+    std::array<glm::dvec3, 4> corners = {
+        ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(NORTH_WEST)),
+        ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(NORTH_EAST)),
+        ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(SOUTH_WEST)),
+        ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(SOUTH_EAST))
+    };
+
+    for (int i = 0; i < 4; ++i) {
+        const double distance = glm::length(cameraPos - corners[i]);
+        if (distance < glm::length(cameraPos - objectPos)) {
+            objectPos = corners[i];
+        }
+    }
+
+
+    const double objectP = pow(length(objectPos - globePos), 2);
+    const double horizonP = pow(minimumGlobeRadius - maxHeight, 2);
+    if (objectP < horizonP) {
+        return false;
+    }
+
+    const double cameraP = pow(length(cameraPos - globePos), 2);
+    const double minR = pow(minimumGlobeRadius, 2);
+    if (cameraP < minR) {
+        return false;
+    }
+
+    const double minimumAllowedDistanceToObjectFromHorizon = sqrt(objectP - horizonP);
+    const double distanceToHorizon = sqrt(cameraP - minR);
+
+    // Minimum allowed for the object to be occluded
+    const double minimumAllowedDistanceToObjectSquared =
+        pow(distanceToHorizon + minimumAllowedDistanceToObjectFromHorizon, 2) +
+        pow(maxHeight, 2);
+
+    const double distanceToObjectSquared = pow(
+        length(objectPos - cameraPos),
+        2
+    );
+    return distanceToObjectSquared > minimumAllowedDistanceToObjectSquared;
+}
+
+bool isCullable(const Chunk& chunk, const BoundingHeights& heights,
+                const ChunkEvaluationContext& context)
+{
+    ZoneScoped
+
+    return (PreformHorizonCulling && isCullableByHorizon(chunk, heights, context)) ||
+           (PerformFrustumCulling && isCullableByFrustum(chunk, context.mvp));
+}
+
+int desiredLevelByDistance(const Chunk& chunk, const BoundingHeights& heights,
+                           const ChunkEvaluationContext& context)
+{
+    ZoneScoped
+
+    const Ellipsoid& ellipsoid = *context.ellipsoid;
+    const glm::dvec3 cameraPosition = context.cameraPosition;
+
+    const Geodetic2 pointOnPatch = chunk.surfacePatch.closestPoint(
+        ellipsoid.cartesianToGeodetic2(cameraPosition)
+    );
+    const glm::dvec3 patchNormal = ellipsoid.geodeticSurfaceNormal(pointOnPatch);
+    glm::dvec3 patchPosition = ellipsoid.cartesianSurfacePosition(pointOnPatch);
+
+    const double heightToChunk = heights.min;
+
+    // Offset position according to height
+    patchPosition += patchNormal * heightToChunk;
+
+    const glm::dvec3 cameraToChunk = patchPosition - cameraPosition;
+
+    // Calculate desired level based on distance
+    const double distanceToPatch = glm::length(cameraToChunk);
+    const double distance = distanceToPatch;
+
+    const double scaleFactor = context.lodScaleFactor * ellipsoid.minimumRadius();
+    const double projectedScaleFactor = scaleFactor / distance;
+    const int desiredLevel = static_cast<int>(ceil(log2(projectedScaleFactor)));
+    return desiredLevel;
+}
+
+double projectedChunkArea(const Chunk& chunk, const BoundingHeights& heights,
+                          const ChunkEvaluationContext& context)
+{
+    ZoneScoped
+
+    const Ellipsoid& ellipsoid = *context.ellipsoid;
+    const glm::dvec3 cameraPosition = context.cameraPosition;
+
+    // Approach:
+    // The projected area of the chunk will be calculated based on a small area that
+    // is close to the camera, and the scaled up to represent the full area.
+    // The advantage of doing this is that it will better handle the cases where the
+    // full patch is very curved (e.g. stretches from latitude 0 to 90 deg).
+
+    const Geodetic2 closestCorner = chunk.surfacePatch.closestCorner(
+        ellipsoid.cartesianToGeodetic2(cameraPosition)
+    );
+
+    //  Camera
+    //  |
+    //  V
+    //
+    //  oo
+    // [  ]<
+    //                     *geodetic space*
+    //
+    //   closestCorner
+    //    +-----------------+  <-- north east corner
+    //    |                 |
+    //    |      center     |
+    //    |                 |
+    //    +-----------------+  <-- south east corner
+
+    const Geodetic2 center = chunk.surfacePatch.center();
+    const Geodetic3 c = { center, heights.min };
+    const Geodetic3 c1 = { Geodetic2{ center.lat, closestCorner.lon }, heights.min };
+    const Geodetic3 c2 = { Geodetic2{ closestCorner.lat, center.lon }, heights.min };
+
+    //  Camera
+    //  |
+    //  V
+    //
+    //  oo
+    // [  ]<
+    //                     *geodetic space*
+    //
+    //    +--------c2-------+  <-- north east corner
+    //    |                 |
+    //    c1       c        |
+    //    |                 |
+    //    +-----------------+  <-- south east corner
+
+
+    // Go from geodetic to cartesian space and project onto unit sphere
+    const glm::dvec3 camToCenter = -cameraPosition;
+    const glm::dvec3 A = glm::normalize(camToCenter + ellipsoid.cartesianPosition(c));
+    const glm::dvec3 B = glm::normalize(camToCenter + ellipsoid.cartesianPosition(c1));
+    const glm::dvec3 C = glm::normalize(camToCenter + ellipsoid.cartesianPosition(c2));
+
+    // Camera                      *cartesian space*
+    // |                    +--------+---+
+    // V             __--''   __--''    /
+    //              C-------A--------- +
+    // oo          /       /          /
+    //[  ]<       +-------B----------+
+    //
+
+    // If the geodetic patch is small (i.e. has small width), that means the patch in
+    // cartesian space will be almost flat, and in turn, the triangle ABC will roughly
+    // correspond to 1/8 of the full area
+    const glm::dvec3 AB = B - A;
+    const glm::dvec3 AC = C - A;
+    const double areaABC = 0.5 * glm::length(glm::cross(AC, AB));
+    const double projectedChunkAreaApprox = 8 * areaABC;
+
+    const double scaledArea = context.lodScaleFactor * projectedChunkAreaApprox;
+    return scaledArea;
+}
+
+int desiredLevelByProjectedArea(const Chunk& chunk, const BoundingHeights& heights,
+                                const ChunkEvaluationContext& context)
+{
+    ZoneScoped
+
+    const double scaledArea = projectedChunkArea(chunk, heights, context);
+    return chunk.tileIndex.level + static_cast<int>(round(scaledArea - 1));
+}
+
+int desiredLevel(const ChunkEvaluation& evaluation,
+                 const ChunkEvaluationContext& context)
+{
+    ZoneScoped
+
+    const Chunk& chunk = *evaluation.chunk;
+    const int desiredLevel = context.levelByProjectedArea ?
+        desiredLevelByProjectedArea(chunk, evaluation.heights, context) :
+        desiredLevelByDistance(chunk, evaluation.heights, context);
+    const int levelByAvailableData = evaluation.levelByAvailableData;
+
+    if (LimitLevelByAvailableData &&
+        (levelByAvailableData != ChunkEvaluation::UnknownDesiredLevel))
+    {
+        const int l = glm::min(desiredLevel, levelByAvailableData);
+        return glm::clamp(l, MinSplitDepth, MaxSplitDepth);
+    }
+    else {
+        return glm::clamp(desiredLevel, MinSplitDepth, MaxSplitDepth);
+    }
+}
+
+} // namespace
+
+Chunk::Chunk(const TileIndex& ti)
+    : tileIndex(ti)
+    , surfacePatch(ti)
+    , status(Status::DoNothing)
+{}
+
+std::array<glm::dvec4, 8> boundingCornersForChunk(const Chunk& chunk,
+                                                  const Ellipsoid& ellipsoid,
+                                                  const BoundingHeights& heights)
+{
+    ZoneScoped
+
+    // assume worst case
+    const double patchCenterRadius = ellipsoid.maximumRadius();
+
+    const double maxCenterRadius = patchCenterRadius + heights.max;
+    Geodetic2 halfSize = chunk.surfacePatch.halfSize();
+
+    // As the patch is curved, the maximum height offsets at the corners must be long
+    // enough to cover large enough to cover a heights.max at the center of the
+    // patch.
+    // Approximating scaleToCoverCenter by assuming the latitude and longitude angles
+    // of "halfSize" are equal to the angles they create from the center of the
+    // globe to the patch corners. This is true for the longitude direction when
+    // the ellipsoid can be approximated as a sphere and for the latitude for patches
+    // close to the equator. Close to the pole this will lead to a bigger than needed
+    // value for scaleToCoverCenter. However, this is a simple calculation and a good
+    // Approximation.
+    const double y1 = tan(halfSize.lat);
+    const double y2 = tan(halfSize.lon);
+    const double scaleToCoverCenter = sqrt(1 + pow(y1, 2) + pow(y2, 2));
+
+    const double maxCornerHeight = maxCenterRadius * scaleToCoverCenter -
+        patchCenterRadius;
+
+    const bool chunkIsNorthOfEquator = chunk.surfacePatch.isNorthern();
+
+    // The minimum height offset, however, we can simply
+    const double minCornerHeight = heights.min;
+    std::array<glm::dvec4, 8> corners;
+
+    const double latCloseToEquator = chunk.surfacePatch.edgeLatitudeNearestEquator();
+    const Geodetic3 p1Geodetic = {
+        { latCloseToEquator, chunk.surfacePatch.minLon() },
+        maxCornerHeight
+    };
+    const Geodetic3 p2Geodetic = {
+        { latCloseToEquator, chunk.surfacePatch.maxLon() },
+        maxCornerHeight
+    };
+
+    const glm::vec3 p1 = ellipsoid.cartesianPosition(p1Geodetic);
+    const glm::vec3 p2 = ellipsoid.cartesianPosition(p2Geodetic);
+    const glm::vec3 p = 0.5f * (p1 + p2);
+    const Geodetic2 pGeodetic = ellipsoid.cartesianToGeodetic2(p);
+    const double latDiff = latCloseToEquator - pGeodetic.lat;
+
+    for (size_t i = 0; i < 8; ++i) {
+        const Quad q = static_cast<Quad>(i % 4);
+        const double cornerHeight = i < 4 ? minCornerHeight : maxCornerHeight;
+        Geodetic3 cornerGeodetic = { chunk.surfacePatch.corner(q), cornerHeight };
+
+        const bool cornerIsNorthern = !((i / 2) % 2);
+        const bool cornerCloseToEquator = chunkIsNorthOfEquator ^ cornerIsNorthern;
+        if (cornerCloseToEquator) {
+            cornerGeodetic.geodetic2.lat += latDiff;
+        }
+
+        corners[i] = glm::dvec4(ellipsoid.cartesianPosition(cornerGeodetic), 1.0);
+    }
+
+    return corners;
+}
+
+void evaluateChunk(const ChunkEvaluation& evaluation,
+                   const ChunkEvaluationContext& context)
+{
+    ZoneScoped
+
+    ghoul_assert(evaluation.chunk, "No chunk provided");
+    ghoul_assert(context.ellipsoid, "No ellipsoid provided");
+
+    Chunk& chunk = *evaluation.chunk;
+    const BoundingHeights& heights = evaluation.heights;
+
+    if (context.updateCorners) {
+        chunk.corners = boundingCornersForChunk(chunk, *context.ellipsoid, heights);
+    }
+
+    if (isCullable(chunk, heights, context)) {
+        chunk.isVisible = false;
+        chunk.status = Chunk::Status::WantMerge;
+    }
+    else {
+        chunk.isVisible = true;
+    }
+
+    // Tiles for chunks that cover a larger part of the screen are loaded first
+    chunk.tileRequestPriority = chunk.isVisible ?
+        static_cast<float>(projectedChunkArea(chunk, heights, context)) :
+        0.f;
+
+    const int dl = desiredLevel(evaluation, context);
+
+    if (dl < chunk.tileIndex.level) {
+        chunk.status = Chunk::Status::WantMerge;
+    }
+    else if (chunk.tileIndex.level < dl) {
+        chunk.status = Chunk::Status::WantSplit;
+    }
+    else {
+        chunk.status = Chunk::Status::DoNothing;
+    }
+}
+
+void evaluateChunks(const std::vector<ChunkEvaluation>& evaluations,
+                    const ChunkEvaluationContext& context, TaskScheduler& scheduler)
+{
+    ZoneScoped
+
+    scheduler.parallelFor(
+        0,
+        evaluations.size(),
+        EvaluationGrainSize,
+        [&evaluations, &context](size_t i) { evaluateChunk(evaluations[i], context); }
+    );
+}
+
+} // namespace openspace::globebrowsing
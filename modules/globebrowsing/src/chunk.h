@@ -0,0 +1,123 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___CHUNK___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___CHUNK___H__
+
+#include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <ghoul/glm.h>
+#include <array>
+#include <vector>
+
+namespace openspace { class TaskScheduler; }
+
+namespace openspace::globebrowsing {
+
+class Ellipsoid;
+
+struct BoundingHeights {
+    float min;
+    float max;
+    bool available;
+    bool tileOK;
+};
+
+struct Chunk {
+    enum class Status : uint8_t {
+        DoNothing,
+        WantMerge,
+        WantSplit
+    };
+
+    Chunk(const TileIndex& tileIndex);
+
+    const TileIndex tileIndex;
+    const GeodeticPatch surfacePatch;
+
+    Status status;
+
+    bool isVisible = true;
+    bool colorTileOK = false;
+    bool heightTileOK = false;
+
+    /// The priority of the tile requests that are issued for this chunk; this is the
+    /// projected area of the chunk as of the last time it was updated, 0 if it is culled
+    float tileRequestPriority = 0.f;
+
+    std::array<glm::dvec4, 8> corners;
+    std::array<Chunk*, 4> children = { { nullptr, nullptr, nullptr, nullptr } };
+};
+
+/**
+ * The view-dependent state that is needed to decide whether the chunks of a globe should
+ * be split or merged. All positions are given in the model space of the globe.
+ */
+struct ChunkEvaluationContext {
+    const Ellipsoid* ellipsoid = nullptr;
+    glm::dvec3 cameraPosition = glm::dvec3(0.0);
+    glm::dmat4 mvp = glm::dmat4(1.0);
+    double lodScaleFactor = 1.0;
+    bool levelByProjectedArea = true;
+    bool updateCorners = false;
+};
+
+/**
+ * A chunk together with the information about it that depends on the loaded tiles. The
+ * tile providers must not be accessed concurrently, so this information has to be
+ * gathered before the chunks are evaluated.
+ */
+struct ChunkEvaluation {
+    static constexpr const int UnknownDesiredLevel = -1;
+
+    Chunk* chunk = nullptr;
+    BoundingHeights heights = { 0.f, 0.f, false, true };
+
+    /// The highest level that the available tile data supports, or UnknownDesiredLevel
+    /// if the level is not limited by the data
+    int levelByAvailableData = UnknownDesiredLevel;
+};
+
+std::array<glm::dvec4, 8> boundingCornersForChunk(const Chunk& chunk,
+    const Ellipsoid& ellipsoid, const BoundingHeights& heights);
+
+/**
+ * Updates the corners (if requested), visibility, tile request priority, and status of
+ * the chunk in \p evaluation for the camera described by \p context. Only the chunk
+ * itself is accessed, so different chunks can be evaluated concurrently.
+ */
+void evaluateChunk(const ChunkEvaluation& evaluation,
+    const ChunkEvaluationContext& context);
+
+/**
+ * Evaluates all chunks in \p evaluations in parallel batches on the \p scheduler. The
+ * results are the same as calling evaluateChunk for each of them in sequence.
+ */
+void evaluateChunks(const std::vector<ChunkEvaluation>& evaluations,
+    const ChunkEvaluationContext& context, TaskScheduler& scheduler);
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___CHUNK___H__
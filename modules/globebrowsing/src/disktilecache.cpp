@@ -0,0 +1,369 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/disktilecache.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+    constexpr const char* _loggerCat = "DiskTileCache";
+
+    constexpr const uint32_t Magic = 0x4354534f; // "OSTC"
+    constexpr const uint32_t Version = 1;
+    constexpr const char* TileSuffix = ".tile";
+    constexpr const char* TemporarySuffix = ".tmp";
+
+    // Stored at the end of every file after the image data and the TileMetaData
+    struct Footer {
+        uint32_t magic = Magic;
+        uint32_t version = Version;
+        uint64_t provider = 0;
+        uint64_t initDataHash = 0;
+        uint64_t imageSize = 0;
+        uint32_t metaDataSize = 0;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint8_t level = 0;
+        uint8_t padding[3] = { 0, 0, 0 };
+        // Covers the image data, the TileMetaData, and all previous members
+        uint64_t checksum = 0;
+    };
+    static_assert(sizeof(Footer) == 56, "Footer must not have implicit padding");
+
+    uint64_t footerChecksum(const Footer& footer, const std::byte* imageData,
+                            const openspace::globebrowsing::TileMetaData& metaData)
+    {
+        using openspace::globebrowsing::cache::DiskTileCache;
+        uint64_t res = DiskTileCache::checksum(imageData, footer.imageSize);
+        res = DiskTileCache::checksum(&metaData, sizeof(metaData), res);
+        return DiskTileCache::checksum(&footer, offsetof(Footer, checksum), res);
+    }
+} // namespace
+
+namespace openspace::globebrowsing::cache {
+
+DiskTileCache::DiskTileCache(std::filesystem::path folder, uint64_t maxSize)
+    : _folder(std::move(folder))
+    , _maxSize(maxSize)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    fs::create_directories(_folder, ec);
+    if (ec) {
+        LERROR(fmt::format(
+            "Error creating tile cache folder {}: {}", _folder, ec.message()
+        ));
+        return;
+    }
+
+    struct StoredTile {
+        std::string name;
+        uint64_t size;
+        fs::file_time_type lastUse;
+    };
+    std::vector<StoredTile> tiles;
+    for (const fs::directory_entry& e : fs::recursive_directory_iterator(_folder, ec)) {
+        if (!e.is_regular_file(ec)) {
+            continue;
+        }
+        const fs::path& path = e.path();
+        if (path.extension() == TemporarySuffix) {
+            // Left behind by a session that ended while writing a tile
+            fs::remove(path, ec);
+        }
+        else if (path.extension() == TileSuffix) {
+            tiles.push_back({
+                fs::relative(path, _folder, ec).generic_string(),
+                e.file_size(ec),
+                e.last_write_time(ec)
+            });
+        }
+    }
+
+    // Register the most recently used tiles last so that they end up in front
+    std::sort(
+        tiles.begin(),
+        tiles.end(),
+        [](const StoredTile& lhs, const StoredTile& rhs) {
+            return lhs.lastUse < rhs.lastUse;
+        }
+    );
+    for (StoredTile& tile : tiles) {
+        _entries.push_front({ std::move(tile.name), tile.size, _nextGeneration++ });
+        _index[_entries.front().name] = _entries.begin();
+        _size += tile.size;
+    }
+
+    evictEntries();
+
+    LINFO(fmt::format(
+        "Found {} tiles with {} MB in {}", _entries.size(), _size / (1024 * 1024), _folder
+    ));
+}
+
+std::optional<RawTile> DiskTileCache::get(uint64_t provider, const TileIndex& tileIndex,
+                                          const TileTextureInitData& initData)
+{
+    const std::string name = fileName(provider, tileIndex);
+    uint64_t generation = 0;
+    {
+        std::lock_guard lock(_mutex);
+        auto it = _index.find(name);
+        if (it == _index.end()) {
+            _stats.nMisses++;
+            return std::nullopt;
+        }
+        generation = it->second->generation;
+        _entries.splice(_entries.begin(), _entries, it->second);
+    }
+
+    const std::filesystem::path path = _folder / name;
+    const size_t imageSize = initData.totalNumBytes;
+    const size_t dataSize = imageSize + sizeof(TileMetaData);
+    const size_t fileSize = dataSize + sizeof(Footer);
+
+    // The file is read in one go into the buffer that becomes the image data, which is
+    // why the image data comes first in the file
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.good()) {
+        // The file was evicted since we looked it up
+        std::lock_guard lock(_mutex);
+        forget(name, generation);
+        _stats.nMisses++;
+        return std::nullopt;
+    }
+
+    bool isValid = false;
+    std::unique_ptr<std::byte[]> data;
+    if (static_cast<size_t>(file.tellg()) == fileSize) {
+        data = std::unique_ptr<std::byte[]>(new std::byte[fileSize]);
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.get()), fileSize);
+
+        Footer footer;
+        std::memcpy(&footer, data.get() + dataSize, sizeof(Footer));
+        TileMetaData metaData;
+        std::memcpy(&metaData, data.get() + imageSize, sizeof(TileMetaData));
+        isValid = file.good() &&
+            footer.magic == Magic && footer.version == Version &&
+            footer.provider == provider && footer.initDataHash == initData.hashKey &&
+            footer.imageSize == imageSize &&
+            footer.metaDataSize == sizeof(TileMetaData) &&
+            footer.x == tileIndex.x && footer.y == tileIndex.y &&
+            footer.level == tileIndex.level &&
+            footer.checksum == footerChecksum(footer, data.get(), metaData);
+    }
+    file.close();
+
+    std::error_code ec;
+    if (!isValid) {
+        std::lock_guard lock(_mutex);
+        // A concurrent put might have replaced the file after we read it, and the new
+        // file must not be deleted
+        if (forget(name, generation)) {
+            LWARNING(fmt::format("Removing damaged tile {}", path));
+            std::filesystem::remove(path, ec);
+            _stats.nCorrupt++;
+        }
+        _stats.nMisses++;
+        return std::nullopt;
+    }
+
+    // Keep the order of use for the next session
+    std::filesystem::last_write_time(
+        path,
+        std::filesystem::file_time_type::clock::now(),
+        ec
+    );
+
+    RawTile tile;
+    tile.imageData = std::move(data);
+    std::memcpy(
+        &tile.tileMetaData,
+        tile.imageData.get() + imageSize,
+        sizeof(TileMetaData)
+    );
+    tile.textureInitData = initData;
+    tile.tileIndex = tileIndex;
+    tile.error = RawTile::ReadError::None;
+
+    std::lock_guard lock(_mutex);
+    _stats.nHits++;
+    return tile;
+}
+
+void DiskTileCache::put(uint64_t provider, const RawTile& tile) {
+    ghoul_assert(tile.imageData, "Tile must have image data");
+    ghoul_assert(tile.textureInitData.has_value(), "Tile must have texture init data");
+
+    namespace fs = std::filesystem;
+
+    const std::string name = fileName(provider, tile.tileIndex);
+    const size_t imageSize = tile.textureInitData->totalNumBytes;
+
+    Footer footer;
+    footer.provider = provider;
+    footer.initDataHash = tile.textureInitData->hashKey;
+    footer.imageSize = imageSize;
+    footer.metaDataSize = sizeof(TileMetaData);
+    footer.x = tile.tileIndex.x;
+    footer.y = tile.tileIndex.y;
+    footer.level = tile.tileIndex.level;
+    footer.checksum = footerChecksum(footer, tile.imageData.get(), tile.tileMetaData);
+
+    // Write to a temporary file first so that no other thread or later session can see
+    // a partially written tile
+    const fs::path path = _folder / name;
+    fs::path temporaryPath;
+    {
+        std::lock_guard lock(_mutex);
+        temporaryPath = path;
+        temporaryPath += fmt::format(".{}{}", _nextTemporaryFile++, TemporarySuffix);
+    }
+
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(tile.imageData.get()), imageSize);
+        file.write(
+            reinterpret_cast<const char*>(&tile.tileMetaData),
+            sizeof(TileMetaData)
+        );
+        file.write(reinterpret_cast<const char*>(&footer), sizeof(Footer));
+        if (!file.good()) {
+            file.close();
+            LWARNING(fmt::format("Error writing tile {}", temporaryPath));
+            fs::remove(temporaryPath, ec);
+            return;
+        }
+    }
+    // The file is only moved in place and removed while the mutex is held, so that the
+    // files on disk always match the registered entries
+    std::lock_guard lock(_mutex);
+    fs::rename(temporaryPath, path, ec);
+    if (ec) {
+        LWARNING(fmt::format("Error storing tile {}: {}", path, ec.message()));
+        fs::remove(temporaryPath, ec);
+        return;
+    }
+
+    forget(name);
+    _entries.push_front({
+        name,
+        imageSize + sizeof(TileMetaData) + sizeof(Footer),
+        _nextGeneration++
+    });
+    _index[name] = _entries.begin();
+    _size += _entries.front().size;
+    evictEntries();
+}
+
+void DiskTileCache::clear() {
+    std::lock_guard lock(_mutex);
+    std::error_code ec;
+    for (const Entry& e : _entries) {
+        std::filesystem::remove(_folder / e.name, ec);
+    }
+    _entries.clear();
+    _index.clear();
+    _size = 0;
+}
+
+uint64_t DiskTileCache::size() const {
+    std::lock_guard lock(_mutex);
+    return _size;
+}
+
+DiskTileCache::Stats DiskTileCache::stats() const {
+    std::lock_guard lock(_mutex);
+    return _stats;
+}
+
+uint64_t DiskTileCache::checksum(const void* data, size_t size, uint64_t seed) {
+    // FNV-1a on 8 byte words, with an additional shift to mix the high bits of a word
+    // into the low bits of the next step
+    constexpr const uint64_t Prime = 0x100000001b3ULL;
+    const std::byte* bytes = reinterpret_cast<const std::byte*>(data);
+    uint64_t res = seed ^ 0xcbf29ce484222325ULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(uint64_t));
+        res = (res ^ word) * Prime;
+        res ^= res >> 29;
+    }
+    for (; i < size; ++i) {
+        res = (res ^ static_cast<uint64_t>(bytes[i])) * Prime;
+    }
+    return res;
+}
+
+std::string DiskTileCache::fileName(uint64_t provider, const TileIndex& tileIndex) {
+    return fmt::format(
+        "{:016x}/{}/{}_{}{}",
+        provider, tileIndex.level, tileIndex.x, tileIndex.y, TileSuffix
+    );
+}
+
+void DiskTileCache::evictEntries() {
+    std::error_code ec;
+    while (_size > _maxSize && !_entries.empty()) {
+        const Entry& entry = _entries.back();
+        std::filesystem::remove(_folder / entry.name, ec);
+        _size -= entry.size;
+        _index.erase(entry.name);
+        _entries.pop_back();
+        _stats.nEvicted++;
+    }
+}
+
+void DiskTileCache::forget(const std::string& name) {
+    auto it = _index.find(name);
+    if (it != _index.end()) {
+        _size -= it->second->size;
+        _entries.erase(it->second);
+        _index.erase(it);
+    }
+}
+
+bool DiskTileCache::forget(const std::string& name, uint64_t generation) {
+    auto it = _index.find(name);
+    if (it == _index.end() || it->second->generation != generation) {
+        return false;
+    }
+    _size -= it->second->size;
+    _entries.erase(it->second);
+    _index.erase(it);
+    return true;
+}
+
+} // namespace openspace::globebrowsing::cache
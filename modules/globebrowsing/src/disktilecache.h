@@ -0,0 +1,157 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___DISK_TILE_CACHE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___DISK_TILE_CACHE___H__
+
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace openspace::globebrowsing::cache {
+
+/**
+ * A persistent cache of fully processed tiles on disk, which sits behind the
+ * MemoryAwareTileCache so that tiles that were evicted from memory, or loaded in an
+ * earlier session, don't have to be read and resampled by GDAL again.
+ *
+ * Tiles are identified by a 64-bit identifier of the tile provider and the TileIndex.
+ * Every tile is stored in its own file that starts with the texture bytes, followed by
+ * the TileMetaData and a footer that identifies the tile and holds a checksum of the
+ * rest of the file. This way a tile is read with a single read directly into the buffer
+ * that becomes its image data. Files that are truncated, belong to another tile, or
+ * don't match their checksum are deleted and reported as a miss.
+ *
+ * The least recently used tiles are deleted when the files exceed the size budget. The
+ * order of use survives between sessions through the modification times of the files.
+ * All functions can be called from multiple threads at the same time.
+ */
+class DiskTileCache {
+public:
+    struct Stats {
+        size_t nHits = 0;
+        size_t nMisses = 0;
+        /// The number of files that were deleted because they were damaged
+        size_t nCorrupt = 0;
+        /// The number of files that were deleted to stay within the size budget
+        size_t nEvicted = 0;
+    };
+
+    /**
+     * Opens the cache in \p folder, which is created if it doesn't exist, and registers
+     * the tiles that were stored there before. Files that exceed \p maxSize are deleted
+     * right away, starting with the least recently used.
+     *
+     * \param folder The folder that holds the files of the cache
+     * \param maxSize The maximum number of bytes of all tile files
+     */
+    DiskTileCache(std::filesystem::path folder, uint64_t maxSize);
+
+    /**
+     * \return the tile of the provider \p provider at \p tileIndex if it is stored in the
+     *         cache with the texture layout described by \p initData
+     */
+    std::optional<RawTile> get(uint64_t provider, const TileIndex& tileIndex,
+        const TileTextureInitData& initData);
+
+    /**
+     * Stores the \p tile of the provider \p provider. The tile needs to have image data
+     * and TileTextureInitData. Tiles that are already stored are replaced.
+     */
+    void put(uint64_t provider, const RawTile& tile);
+
+    /**
+     * Deletes all tiles of the cache.
+     */
+    void clear();
+
+    /**
+     * \return the number of bytes of all stored tiles
+     */
+    uint64_t size() const;
+
+    Stats stats() const;
+
+    /**
+     * \return a 64-bit checksum of the \p size bytes at \p data, which is also used to
+     *         create identifiers of tile providers that are stable between sessions
+     */
+    static uint64_t checksum(const void* data, size_t size, uint64_t seed = 0);
+
+private:
+    struct Entry {
+        std::string name;
+        uint64_t size = 0;
+        /// Changes whenever the file is replaced, so that a reader can tell whether the
+        /// file it read is still the one that is registered
+        uint64_t generation = 0;
+    };
+
+    /**
+     * \return the name of the file of the tile relative to the cache folder
+     */
+    static std::string fileName(uint64_t provider, const TileIndex& tileIndex);
+
+    /**
+     * Removes the least recently used entries and deletes their files until the cache
+     * fits in the budget. Must be called with the mutex held so that a tile that is put
+     * again concurrently cannot lose its new file.
+     */
+    void evictEntries();
+
+    /**
+     * Removes the entry \p name if it is registered.
+     */
+    void forget(const std::string& name);
+
+    /**
+     * Removes the entry \p name if it is registered with the \p generation.
+     * \return \c true if the entry was removed
+     */
+    bool forget(const std::string& name, uint64_t generation);
+
+    const std::filesystem::path _folder;
+    const uint64_t _maxSize;
+
+    // The front is the most recently used entry
+    std::list<Entry> _entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> _index;
+    uint64_t _size = 0;
+    uint64_t _nextTemporaryFile = 0;
+    uint64_t _nextGeneration = 0;
+    Stats _stats;
+    mutable std::mutex _mutex;
+};
+
+} // namespace openspace::globebrowsing::cache
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___DISK_TILE_CACHE___H__
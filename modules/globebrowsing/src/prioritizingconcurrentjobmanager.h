@@ -25,29 +25,33 @@
 #ifndef __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITIZING_CONCURRENT_JOB_MANAGER___H__
 #define __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITIZING_CONCURRENT_JOB_MANAGER___H__
 
-#include <modules/globebrowsing/src/lruthreadpool.h>
+#include <modules/globebrowsing/src/prioritythreadpool.h>
 #include <openspace/util/concurrentqueue.h>
-#include <mutex>
+#include <memory>
+#include <vector>
 
 namespace openspace { template <typename T> struct Job; }
 
 namespace openspace::globebrowsing {
 
 /**
- * Concurrent job manager which prioritizes which jobs to work on depending on which ones
- * were enqueued latest. The class is templated both on the job type and the key type
- * which is used to identify jobs. In case a job need to be explicitly ended. It can be
- * identified using its key.
+ * Concurrent job manager which prioritizes which jobs to work on depending on a priority
+ * that is provided when the job is enqueued and that can be updated afterwards. The class
+ * is templated both on the job type and the key type which is used to identify jobs. In
+ * case a job need to be explicitly ended. It can be identified using its key.
  */
 template<typename P, typename KeyType>
 class PrioritizingConcurrentJobManager {
 public:
-    PrioritizingConcurrentJobManager(LRUThreadPool<KeyType> pool);
+    PrioritizingConcurrentJobManager(PriorityThreadPool<KeyType> pool,
+        size_t maxFinishedJobs = 256);
+    ~PrioritizingConcurrentJobManager();
 
     /**
-     * Enqueues a job which is identified using a given key
+     * Enqueues a job which is identified using a given key. Jobs with a higher
+     * <code>priority</code> are executed first
      */
-    void enqueueJob(std::shared_ptr<Job<P>> job, KeyType key);
+    void enqueueJob(std::shared_ptr<Job<P>> job, KeyType key, float priority);
 
     /**
      * The keys returned by this function have been popped from the queue and corresponds
@@ -60,13 +64,25 @@ public:
     std::vector<KeyType> keysToEnqueuedJobs();
 
     /**
-     * Bumps the job identified with <code>key</code> to the beginning of the queue.
-     * In case the job was not already enqueued the function simply returns false and
-     * no state is changed.
-     * \param key is the identifier of the job to bump.
+     * Updates the priority of the job identified with <code>key</code> and marks it as
+     * still being requested in the current frame. In case the job was not already
+     * enqueued the function simply returns false and no state is changed.
+     * \param key is the identifier of the job to update
+     * \param priority is the new priority of the job
      * \returns true if the job was found, else returns false.
      */
-    bool touch(KeyType key);
+    bool touch(KeyType key, float priority);
+
+    /**
+     * Sets the number of jobs that are executed at the same time.
+     */
+    void setMaxConcurrency(size_t maxConcurrency);
+
+    /**
+     * Starts a new frame. Enqueued jobs that have not been touched during the previous
+     * frame are cancelled and show up in #keysToUnfinishedJobs.
+     */
+    void beginFrame();
 
     /**
      * Clear all enqueued jobs. Can not end jobs that workers are currently handling.
@@ -80,13 +96,20 @@ public:
      */
     std::shared_ptr<Job<P>> popFinishedJob();
 
+    /**
+     * \returns all jobs that have finished since the last call, in the order in which
+     *          they finished.
+     */
+    std::vector<std::shared_ptr<Job<P>>> popFinishedJobs();
+
     size_t numFinishedJobs() const;
 
 private:
-    ConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
-    std::mutex _finishedJobsMutex;
-    /// An LRU thread pool is used since the jobs can be bumped and hence prioritized.
-    LRUThreadPool<KeyType> _threadPool;
+    /// The workers push their results without waiting for the render thread until twice
+    /// \c maxFinishedJobs results are waiting to be popped
+    OverflowingConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
+    /// A priority thread pool is used since the priorities change from frame to frame
+    PriorityThreadPool<KeyType> _threadPool;
 };
 
 } // namespace openspace::globebrowsing
@@ -28,19 +28,26 @@ namespace openspace::globebrowsing {
 
 template <typename P, typename KeyType>
 PrioritizingConcurrentJobManager<P, KeyType>::PrioritizingConcurrentJobManager(
-                                                              LRUThreadPool<KeyType> pool)
-    : _threadPool(std::move(pool))
+                                                         PriorityThreadPool<KeyType> pool,
+                                                                   size_t maxFinishedJobs)
+    : _finishedJobs(maxFinishedJobs)
+    , _threadPool(std::move(pool))
 {}
 
+template <typename P, typename KeyType>
+PrioritizingConcurrentJobManager<P, KeyType>::~PrioritizingConcurrentJobManager() {
+    // Workers that wait for room must not keep the thread pool from shutting down
+    _finishedJobs.close();
+}
+
 template <typename P, typename KeyType>
 void PrioritizingConcurrentJobManager<P, KeyType>::enqueueJob(std::shared_ptr<Job<P>> job,
-                                                              KeyType key)
+                                                              KeyType key, float priority)
 {
     _threadPool.enqueue([this, job]() {
         job->execute();
-        std::lock_guard lock(_finishedJobsMutex);
         _finishedJobs.push(job);
-    }, key);
+    }, key, priority);
 }
 
 template <typename P, typename KeyType>
@@ -56,8 +63,20 @@ PrioritizingConcurrentJobManager<P, KeyType>::keysToEnqueuedJobs() {
 }
 
 template <typename P, typename KeyType>
-bool PrioritizingConcurrentJobManager<P, KeyType>::touch(KeyType key) {
-    return _threadPool.touch(key);
+bool PrioritizingConcurrentJobManager<P, KeyType>::touch(KeyType key, float priority) {
+    return _threadPool.touch(key, priority);
+}
+
+template <typename P, typename KeyType>
+void PrioritizingConcurrentJobManager<P, KeyType>::setMaxConcurrency(
+                                                                    size_t maxConcurrency)
+{
+    _threadPool.setMaxConcurrency(maxConcurrency);
+}
+
+template <typename P, typename KeyType>
+void PrioritizingConcurrentJobManager<P, KeyType>::beginFrame() {
+    _threadPool.beginFrame();
 }
 
 template <typename P, typename KeyType>
@@ -67,13 +86,19 @@ void PrioritizingConcurrentJobManager<P, KeyType>::clearEnqueuedJobs() {
 
 template <typename P, typename KeyType>
 std::shared_ptr<Job<P>> PrioritizingConcurrentJobManager<P, KeyType>::popFinishedJob() {
-    ghoul_assert(!_finishedJobs.empty(), "There is no finished job to pop!");
+    ghoul_assert(numFinishedJobs() > 0, "There is no finished job to pop!");
 
-    std::lock_guard lock(_finishedJobsMutex);
-    std::shared_ptr<Job<P>> result = _finishedJobs.pop();
+    std::shared_ptr<Job<P>> result;
+    _finishedJobs.tryPop(result);
     return result;
 }
 
+template <typename P, typename KeyType>
+std::vector<std::shared_ptr<Job<P>>>
+PrioritizingConcurrentJobManager<P, KeyType>::popFinishedJobs() {
+    return _finishedJobs.popAll();
+}
+
 template <typename P, typename KeyType>
 size_t PrioritizingConcurrentJobManager<P, KeyType>::numFinishedJobs() const {
     return _finishedJobs.size();
@@ -0,0 +1,115 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_THREAD_POOL___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_THREAD_POOL___H__
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace::globebrowsing {
+
+/**
+ * The <code>PriorityThreadPool</code> will only enqueue a certain number of tasks. The
+ * enqueued task with the highest priority is the one that will be executed first. This
+ * class is templated on a key type which is used as an identifier to determine whether or
+ * not a task with the given key has been enqueued. A second enqueued task with the same
+ * key is ignored and only updates the priority of the first one, so the user must ensure
+ * that tasks with the same key are equal in outcome.
+ *
+ * The priority of an enqueued task is meant to be refreshed every frame through the
+ * #touch function, which is a logarithmic update of the task's position in the queue.
+ * After #beginFrame has been called twice without the task being touched in between, the
+ * task is considered stale and is cancelled instead of executed the next time it would be
+ * picked. The keys of cancelled tasks, and of tasks that were dropped because the queue
+ * was full, can be retrieved through #getUnqueuedTasksKeys.
+ *
+ * The pool does not own any threads. As the tasks are expected to block on file or
+ * network IO, they are executed on the IO threads of the global TaskScheduler
+ * (TaskScheduler::Priority::IO) with at most <code>numThreads</code> of them at the same
+ * time, which can be changed later through #setMaxConcurrency.
+ */
+template<typename KeyType>
+class PriorityThreadPool {
+public:
+    PriorityThreadPool(size_t numThreads, size_t queueSize);
+    PriorityThreadPool(const PriorityThreadPool& toCopy);
+    ~PriorityThreadPool();
+
+    void enqueue(std::function<void()> f, KeyType key, float priority);
+    bool touch(KeyType key, float priority);
+
+    /**
+     * Sets the number of tasks that are executed at the same time. Tasks that are already
+     * running are not interrupted if the number is lowered, but no new task is started
+     * until fewer tasks than \p maxConcurrency are running.
+     */
+    void setMaxConcurrency(size_t maxConcurrency);
+
+    void beginFrame();
+    std::vector<KeyType> getQueuedTasksKeys();
+    std::vector<KeyType> getUnqueuedTasksKeys();
+    void clearEnqueuedTasks();
+
+private:
+    struct Task {
+        KeyType key;
+        float priority;
+        uint64_t lastRequestedFrame;
+        std::function<void()> function;
+    };
+
+    void runNext();
+
+    void updatePriority(size_t index, float priority);
+
+    // Binary max-heap operations on _queuedTasks that keep _positions up-to-date
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+    void swapTasks(size_t lhs, size_t rhs);
+    Task removeTask(size_t index);
+
+    const size_t _queueSize;
+    size_t _maxConcurrency = 0;
+    size_t _nRunning = 0;
+    uint64_t _frame = 0;
+
+    std::vector<Task> _queuedTasks;
+    std::unordered_map<KeyType, size_t> _positions;
+    std::vector<KeyType> _unqueuedTasks;
+    std::mutex _queueMutex;
+    std::condition_variable _condition;
+
+    bool _stop = false;
+};
+
+} // namespace openspace::globebrowsing
+
+#include "prioritythreadpool.inl"
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_THREAD_POOL___H__
@@ -0,0 +1,280 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/engine/globals.h>
+#include <openspace/util/taskscheduler.h>
+#include <algorithm>
+
+namespace openspace::globebrowsing {
+
+template<typename KeyType>
+PriorityThreadPool<KeyType>::PriorityThreadPool(size_t numThreads, size_t queueSize)
+    : _queueSize(std::max<size_t>(queueSize, 1))
+    , _maxConcurrency(std::max<size_t>(numThreads, 1))
+{
+    _queuedTasks.reserve(_queueSize + 1);
+    _positions.reserve(_queueSize + 1);
+}
+
+template<typename KeyType>
+PriorityThreadPool<KeyType>::PriorityThreadPool(const PriorityThreadPool& toCopy)
+    : PriorityThreadPool(toCopy._maxConcurrency, toCopy._queueSize)
+{}
+
+// the destructor waits for the tasks that are currently executing
+template<typename KeyType>
+PriorityThreadPool<KeyType>::~PriorityThreadPool() {
+    std::unique_lock lock(_queueMutex);
+    _stop = true;
+    _queuedTasks.clear();
+    _positions.clear();
+    _condition.wait(lock, [this]() { return _nRunning == 0; });
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::enqueue(std::function<void()> f, KeyType key,
+                                          float priority)
+{
+    {
+        std::unique_lock lock(_queueMutex);
+
+        const auto it = _positions.find(key);
+        if (it != _positions.end()) {
+            // Already enqueued, so this is equivalent to touching the task
+            updatePriority(it->second, priority);
+            return;
+        }
+
+        _queuedTasks.push_back({ key, priority, _frame, std::move(f) });
+        _positions[key] = _queuedTasks.size() - 1;
+        siftUp(_queuedTasks.size() - 1);
+
+        if (_queuedTasks.size() > _queueSize) {
+            // Drop the least important task. The leaves of the heap are in its second
+            // half, so that is where the minimum has to be
+            const size_t firstLeaf = _queuedTasks.size() / 2;
+            const auto lowest = std::min_element(
+                _queuedTasks.begin() + firstLeaf,
+                _queuedTasks.end(),
+                [](const Task& lhs, const Task& rhs) {
+                    return lhs.priority < rhs.priority;
+                }
+            );
+            const size_t index = std::distance(_queuedTasks.begin(), lowest);
+            _unqueuedTasks.push_back(removeTask(index).key);
+        }
+
+        if (_nRunning >= _maxConcurrency) {
+            // One of the running tasks will pick up the new one when it is finished
+            return;
+        }
+        _nRunning++;
+    }
+
+    global::taskScheduler->enqueue([this]() { runNext(); }, TaskScheduler::Priority::IO);
+}
+
+template<typename KeyType>
+bool PriorityThreadPool<KeyType>::touch(KeyType key, float priority) {
+    std::unique_lock lock(_queueMutex);
+    const auto it = _positions.find(key);
+    if (it == _positions.end()) {
+        return false;
+    }
+
+    updatePriority(it->second, priority);
+    return true;
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::setMaxConcurrency(size_t maxConcurrency) {
+    size_t nStarted = 0;
+    {
+        std::unique_lock lock(_queueMutex);
+        _maxConcurrency = std::max<size_t>(maxConcurrency, 1);
+        // If the concurrency is lowered, the surplus tasks stop after their current task.
+        // If it is raised, the queued tasks should not wait for the running ones
+        const size_t nRunning =
+            std::min(_maxConcurrency, _nRunning + _queuedTasks.size());
+        if (nRunning > _nRunning) {
+            nStarted = nRunning - _nRunning;
+            _nRunning = nRunning;
+        }
+    }
+
+    for (size_t i = 0; i < nStarted; ++i) {
+        global::taskScheduler->enqueue(
+            [this]() { runNext(); },
+            TaskScheduler::Priority::IO
+        );
+    }
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::beginFrame() {
+    std::unique_lock lock(_queueMutex);
+    _frame++;
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::runNext() {
+    std::function<void()> function;
+    {
+        std::unique_lock lock(_queueMutex);
+        while (!_stop && _nRunning <= _maxConcurrency && !_queuedTasks.empty()) {
+            Task task = removeTask(0);
+            // Tasks that nobody asked for during the last frame are stale. Cancelling
+            // them here is cheaper than sweeping the queue every frame
+            if (task.lastRequestedFrame + 1 < _frame) {
+                _unqueuedTasks.push_back(task.key);
+                continue;
+            }
+            function = std::move(task.function);
+            break;
+        }
+
+        if (!function) {
+            // The notification has to happen under the lock as the pool might be
+            // destroyed as soon as the destructor sees that nothing is running anymore
+            _nRunning--;
+            _condition.notify_all();
+            return;
+        }
+    }
+
+    function();
+
+    global::taskScheduler->enqueue([this]() { runNext(); }, TaskScheduler::Priority::IO);
+}
+
+template<typename KeyType>
+std::vector<KeyType> PriorityThreadPool<KeyType>::getUnqueuedTasksKeys() {
+    std::unique_lock lock(_queueMutex);
+    std::vector<KeyType> toReturn = std::move(_unqueuedTasks);
+    _unqueuedTasks.clear();
+    return toReturn;
+}
+
+template<typename KeyType>
+std::vector<KeyType> PriorityThreadPool<KeyType>::getQueuedTasksKeys() {
+    std::vector<KeyType> queuedTasks;
+    {
+        std::unique_lock lock(_queueMutex);
+        queuedTasks.reserve(_queuedTasks.size());
+        for (const Task& task : _queuedTasks) {
+            queuedTasks.push_back(task.key);
+        }
+        _queuedTasks.clear();
+        _positions.clear();
+    }
+    return queuedTasks;
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::clearEnqueuedTasks() {
+    std::unique_lock lock(_queueMutex);
+    _queuedTasks.clear();
+    _positions.clear();
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::updatePriority(size_t index, float priority) {
+    Task& task = _queuedTasks[index];
+    const float oldPriority = task.priority;
+    // If the same task is requested multiple times in a frame, the most important
+    // request wins. The first request in a new frame replaces the old priority
+    task.priority = task.lastRequestedFrame == _frame ?
+        std::max(oldPriority, priority) :
+        priority;
+    task.lastRequestedFrame = _frame;
+
+    if (task.priority > oldPriority) {
+        siftUp(index);
+    }
+    else if (task.priority < oldPriority) {
+        siftDown(index);
+    }
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::siftUp(size_t index) {
+    while (index > 0) {
+        const size_t parent = (index - 1) / 2;
+        if (_queuedTasks[parent].priority >= _queuedTasks[index].priority) {
+            return;
+        }
+        swapTasks(parent, index);
+        index = parent;
+    }
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::siftDown(size_t index) {
+    const size_t size = _queuedTasks.size();
+    while (true) {
+        const size_t left = 2 * index + 1;
+        const size_t right = left + 1;
+        size_t largest = index;
+        if (left < size && _queuedTasks[left].priority > _queuedTasks[largest].priority) {
+            largest = left;
+        }
+        if (right < size && _queuedTasks[right].priority > _queuedTasks[largest].priority)
+        {
+            largest = right;
+        }
+        if (largest == index) {
+            return;
+        }
+        swapTasks(index, largest);
+        index = largest;
+    }
+}
+
+template<typename KeyType>
+void PriorityThreadPool<KeyType>::swapTasks(size_t lhs, size_t rhs) {
+    std::swap(_queuedTasks[lhs], _queuedTasks[rhs]);
+    _positions[_queuedTasks[lhs].key] = lhs;
+    _positions[_queuedTasks[rhs].key] = rhs;
+}
+
+template<typename KeyType>
+typename PriorityThreadPool<KeyType>::Task
+PriorityThreadPool<KeyType>::removeTask(size_t index) {
+    const size_t last = _queuedTasks.size() - 1;
+    if (index != last) {
+        swapTasks(index, last);
+    }
+    Task task = std::move(_queuedTasks.back());
+    _queuedTasks.pop_back();
+    _positions.erase(task.key);
+
+    if (index < _queuedTasks.size()) {
+        // The task that was moved into the hole can be out of order in either direction
+        siftUp(index);
+        siftDown(_positions[_queuedTasks[index].key]);
+    }
+    return task;
+}
+
+} // namespace openspace::globebrowsing
@@ -0,0 +1,192 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___PROVIDER_CACHE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___PROVIDER_CACHE___H__
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace openspace { class TaskScheduler; }
+
+namespace openspace::globebrowsing::cache {
+
+/**
+ * Bounded cache for the tile providers that a time-varying layer creates for each of its
+ * timesteps. Every provider keeps its own GDAL datasets open, so the number of cached
+ * providers is limited to #maximumSize and the least recently used providers are evicted
+ * when new ones are added.
+ *
+ * Providers that are handed out by #provider during a frame are never evicted before the
+ * next call to #update, which is where all evictions happen and where the frame ends. The
+ * caller has to request every provider it holds on to once per frame.
+ *
+ * Providers for timesteps that will be needed soon can be requested with #prefetch. As
+ * creating a provider opens its datasets, which can require a network round-trip, they
+ * are created on the IO threads of the TaskScheduler (TaskScheduler::Priority::IO) and
+ * become part of the cache in the next #update. If
+ * a prefetched provider is requested before it has finished, the request waits for the
+ * prefetch rather than creating a second provider. All created providers are handed to
+ * the initializer function on the thread that calls #provider or #update.
+ */
+template <typename Provider>
+class ProviderCache {
+public:
+    /// Creates the provider for one timestep. Prefetches call this on an IO thread
+    using Creator = std::function<std::unique_ptr<Provider>()>;
+    using Initializer = std::function<void(double, Provider&)>;
+
+    struct Statistics {
+        /// Number of requests that were served with a cached provider
+        size_t nHits = 0;
+        /// Number of requests that had to create a provider
+        size_t nMisses = 0;
+        /// Number of providers that were created by a prefetch
+        size_t nPrefetched = 0;
+        /// Number of providers that were evicted from the cache
+        size_t nEvicted = 0;
+    };
+
+    /**
+     * \param maximumSize The maximum number of providers that are kept
+     * \param scheduler The scheduler on which prefetched providers are created
+     * \param initializer Called for every provider before it is added to the cache
+     */
+    ProviderCache(size_t maximumSize, TaskScheduler& scheduler, Initializer initializer);
+
+    /**
+     * Waits for all prefetches that are currently executing. Prefetches that have not
+     * started yet are dropped.
+     */
+    ~ProviderCache();
+
+    ProviderCache(const ProviderCache&) = delete;
+    ProviderCache& operator=(const ProviderCache&) = delete;
+
+    /**
+     * Returns the provider for \p time. If it is not cached, it is created with
+     * \p create, or taken from a pending prefetch for the same timestep. The returned
+     * provider is valid at least until the next call to #update. Exceptions from
+     * \p create are passed on to the caller.
+     */
+    Provider* provider(double time, const Creator& create);
+
+    /**
+     * Starts creating the provider for \p time in the background, unless it is already
+     * cached or pending, a previous prefetch for it failed, or the cache has no room left
+     * that isn't taken by the providers that are in use. Cached providers are moved to
+     * the front of the cache instead.
+     */
+    void prefetch(double time, Creator create);
+
+    /**
+     * Adds all finished prefetches to the cache, evicts the least recently used providers
+     * that were not requested in the current frame until the cache fits its maximum size,
+     * and starts a new frame.
+     */
+    void update();
+
+    /**
+     * Calls \p function for all cached providers that were not requested in the current
+     * frame.
+     */
+    template <typename Func>
+    void forEachIdle(Func&& function);
+
+    /**
+     * Calls \p function for all cached providers.
+     */
+    template <typename Func>
+    void forEach(Func&& function);
+
+    /**
+     * Removes all providers and cancels or waits for all prefetches. No pointer that was
+     * returned from #provider must be used after this.
+     */
+    void clear();
+
+    void setMaximumSize(size_t maximumSize);
+    size_t maximumSize() const;
+    size_t size() const;
+    size_t numPendingPrefetches() const;
+    bool contains(double time) const;
+    Statistics statistics() const;
+
+private:
+    struct Entry {
+        double time = 0.0;
+        std::unique_ptr<Provider> provider;
+        unsigned int lastUsedFrame = 0;
+    };
+    using Entries = std::list<Entry>;
+
+    struct Prefetch {
+        Creator create;
+        std::atomic_bool isClaimed = false;
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool isFinished = false;
+        std::unique_ptr<Provider> provider;
+        std::exception_ptr error;
+    };
+
+    /// Inserts the new provider at the front of the cache and returns it
+    Provider* insert(double time, std::unique_ptr<Provider> provider);
+
+    /// Marks \p entry as being used in the current frame and moves it to the front
+    void use(typename Entries::iterator entry);
+
+    /// Returns the finished provider of \p prefetch, or rethrows its error
+    std::unique_ptr<Provider> waitFor(Prefetch& prefetch);
+    void cancelPrefetches();
+    void evict();
+
+    TaskScheduler& _scheduler;
+    const Initializer _initializer;
+    size_t _maximumSize;
+
+    // The front of the list is the most recently used provider
+    Entries _entries;
+    std::unordered_map<double, typename Entries::iterator> _entryMap;
+    std::unordered_map<double, std::shared_ptr<Prefetch>> _prefetches;
+    std::unordered_set<double> _failedPrefetches;
+
+    unsigned int _frame = 1;
+    size_t _nUsedInFrame = 0;
+    Statistics _statistics;
+};
+
+} // namespace openspace::globebrowsing::cache
+
+#include <modules/globebrowsing/src/providercache.inl>
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___PROVIDER_CACHE___H__
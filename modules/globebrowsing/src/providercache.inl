@@ -0,0 +1,286 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/taskscheduler.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/profiling.h>
+
+namespace openspace::globebrowsing::cache {
+
+template <typename Provider>
+ProviderCache<Provider>::ProviderCache(size_t maximumSize, TaskScheduler& scheduler,
+                                       Initializer initializer)
+    : _scheduler(scheduler)
+    , _initializer(std::move(initializer))
+    , _maximumSize(maximumSize)
+{
+    ghoul_assert(_initializer, "No initializer provided");
+}
+
+template <typename Provider>
+ProviderCache<Provider>::~ProviderCache() {
+    cancelPrefetches();
+}
+
+template <typename Provider>
+Provider* ProviderCache<Provider>::provider(double time, const Creator& create) {
+    ZoneScoped
+
+    if (const auto it = _entryMap.find(time);  it != _entryMap.end()) {
+        _statistics.nHits++;
+        use(it->second);
+        return it->second->provider.get();
+    }
+
+    std::unique_ptr<Provider> provider;
+    if (auto it = _prefetches.find(time);  it != _prefetches.end()) {
+        std::shared_ptr<Prefetch> prefetch = std::move(it->second);
+        _prefetches.erase(it);
+        if (prefetch->isClaimed.exchange(true)) {
+            // The prefetch has already started, so waiting for it is faster than creating
+            // the provider again. If it hasn't started, claiming it keeps it from running
+            provider = waitFor(*prefetch);
+            _statistics.nPrefetched++;
+        }
+    }
+
+    if (!provider) {
+        provider = create();
+        _statistics.nMisses++;
+    }
+
+    Provider* res = insert(time, std::move(provider));
+    use(_entries.begin());
+    return res;
+}
+
+template <typename Provider>
+void ProviderCache<Provider>::prefetch(double time, Creator create) {
+    ZoneScoped
+
+    if (const auto it = _entryMap.find(time);  it != _entryMap.end()) {
+        // Keep the provider from being evicted before it is needed
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+    }
+
+    if (_prefetches.count(time) > 0 || _failedPrefetches.count(time) > 0) {
+        return;
+    }
+
+    if (_nUsedInFrame + _prefetches.size() >= _maximumSize) {
+        // Every finished prefetch would evict a provider that is still in use
+        return;
+    }
+
+    std::shared_ptr<Prefetch> prefetch = std::make_shared<Prefetch>();
+    prefetch->create = std::move(create);
+    _prefetches[time] = prefetch;
+
+    _scheduler.enqueue(
+        [prefetch]() {
+            if (prefetch->isClaimed.exchange(true)) {
+                // The provider has been requested or the prefetch was cancelled before
+                // we got here
+                return;
+            }
+
+            std::unique_ptr<Provider> provider;
+            std::exception_ptr error;
+            try {
+                provider = prefetch->create();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard lock(prefetch->mutex);
+            prefetch->provider = std::move(provider);
+            prefetch->error = error;
+            prefetch->isFinished = true;
+            prefetch->finished.notify_all();
+        },
+        TaskScheduler::Priority::IO
+    );
+}
+
+template <typename Provider>
+void ProviderCache<Provider>::update() {
+    ZoneScoped
+
+    for (auto it = _prefetches.begin(); it != _prefetches.end();) {
+        {
+            std::lock_guard lock(it->second->mutex);
+            if (!it->second->isFinished) {
+                ++it;
+                continue;
+            }
+        }
+
+        const double time = it->first;
+        std::shared_ptr<Prefetch> prefetch = std::move(it->second);
+        it = _prefetches.erase(it);
+        try {
+            insert(time, waitFor(*prefetch));
+            _statistics.nPrefetched++;
+        }
+        catch (const std::exception& e) {
+            // Don't try again, the provider is created when it is requested instead
+            LWARNINGC(
+                "ProviderCache",
+                fmt::format("Could not prefetch provider for time {}: {}", time, e.what())
+            );
+            _failedPrefetches.insert(time);
+        }
+    }
+
+    evict();
+
+    _frame++;
+    _nUsedInFrame = 0;
+}
+
+template <typename Provider>
+template <typename Func>
+void ProviderCache<Provider>::forEachIdle(Func&& function) {
+    for (Entry& entry : _entries) {
+        if (entry.lastUsedFrame != _frame) {
+            function(*entry.provider);
+        }
+    }
+}
+
+template <typename Provider>
+template <typename Func>
+void ProviderCache<Provider>::forEach(Func&& function) {
+    for (Entry& entry : _entries) {
+        function(*entry.provider);
+    }
+}
+
+template <typename Provider>
+void ProviderCache<Provider>::clear() {
+    cancelPrefetches();
+    _entryMap.clear();
+    _entries.clear();
+    _failedPrefetches.clear();
+    _nUsedInFrame = 0;
+}
+
+template <typename Provider>
+void ProviderCache<Provider>::setMaximumSize(size_t maximumSize) {
+    // The providers are evicted in the next update as they might still be in use
+    _maximumSize = maximumSize;
+}
+
+template <typename Provider>
+size_t ProviderCache<Provider>::maximumSize() const {
+    return _maximumSize;
+}
+
+template <typename Provider>
+size_t ProviderCache<Provider>::size() const {
+    return _entries.size();
+}
+
+template <typename Provider>
+size_t ProviderCache<Provider>::numPendingPrefetches() const {
+    return _prefetches.size();
+}
+
+template <typename Provider>
+bool ProviderCache<Provider>::contains(double time) const {
+    return _entryMap.find(time) != _entryMap.end();
+}
+
+template <typename Provider>
+typename ProviderCache<Provider>::Statistics ProviderCache<Provider>::statistics() const {
+    return _statistics;
+}
+
+template <typename Provider>
+Provider* ProviderCache<Provider>::insert(double time, std::unique_ptr<Provider> provider)
+{
+    ghoul_assert(provider, "No provider created");
+    ghoul_assert(_entryMap.find(time) == _entryMap.end(), "Provider already cached");
+
+    _initializer(time, *provider);
+
+    Provider* res = provider.get();
+    _entries.push_front({ time, std::move(provider), 0 });
+    _entryMap[time] = _entries.begin();
+    return res;
+}
+
+template <typename Provider>
+void ProviderCache<Provider>::use(typename Entries::iterator entry) {
+    if (entry->lastUsedFrame != _frame) {
+        entry->lastUsedFrame = _frame;
+        _nUsedInFrame++;
+    }
+    _entries.splice(_entries.begin(), _entries, entry);
+}
+
+template <typename Provider>
+std::unique_ptr<Provider> ProviderCache<Provider>::waitFor(Prefetch& prefetch) {
+    std::unique_lock lock(prefetch.mutex);
+    prefetch.finished.wait(lock, [&prefetch]() { return prefetch.isFinished; });
+    if (prefetch.error) {
+        std::rethrow_exception(prefetch.error);
+    }
+    return std::move(prefetch.provider);
+}
+
+template <typename Provider>
+void ProviderCache<Provider>::cancelPrefetches() {
+    for (std::pair<const double, std::shared_ptr<Prefetch>>& p : _prefetches) {
+        if (p.second->isClaimed.exchange(true)) {
+            // The prefetch is running and might use resources owned by the creator of
+            // this cache, so we have to wait for it
+            std::unique_lock lock(p.second->mutex);
+            p.second->finished.wait(lock, [&p]() { return p.second->isFinished; });
+        }
+    }
+    _prefetches.clear();
+}
+
+template <typename Provider>
+void ProviderCache<Provider>::evict() {
+    auto it = _entries.end();
+    while (_entries.size() > _maximumSize && it != _entries.begin()) {
+        --it;
+        if (it->lastUsedFrame == _frame) {
+            // Providers that were requested in this frame might still be referenced
+            continue;
+        }
+
+        _entryMap.erase(it->time);
+        it = _entries.erase(it);
+        _statistics.nEvicted++;
+    }
+}
+
+} // namespace openspace::globebrowsing::cache
@@ -25,7 +25,9 @@
 #include <modules/globebrowsing/src/rawtiledatareader.h>
 
 #include <modules/globebrowsing/globebrowsingmodule.h>
+#include <modules/globebrowsing/src/disktilecache.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tilepostprocessing.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/moduleengine.h>
 #include <ghoul/fmt.h>
@@ -53,7 +55,10 @@
 #endif // _MSC_VER
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <fstream>
+#include <thread>
 
 namespace openspace::globebrowsing {
 
@@ -123,30 +128,6 @@ enum class Side {
     Bottom
 };
 
-float interpretFloat(GLenum glType, const std::byte* src) {
-    switch (glType) {
-        case GL_UNSIGNED_BYTE:
-            return static_cast<float>(*reinterpret_cast<const GLubyte*>(src));
-        case GL_UNSIGNED_SHORT:
-            return static_cast<float>(*reinterpret_cast<const GLushort*>(src));
-        case GL_SHORT:
-            return static_cast<float>(*reinterpret_cast<const GLshort*>(src));
-        case GL_UNSIGNED_INT:
-            return static_cast<float>(*reinterpret_cast<const GLuint*>(src));
-        case GL_INT:
-            return static_cast<float>(*reinterpret_cast<const GLint*>(src));
-        case GL_HALF_FLOAT:
-            return static_cast<float>(*reinterpret_cast<const GLhalf*>(src));
-        case GL_FLOAT:
-            return static_cast<float>(*reinterpret_cast<const GLfloat*>(src));
-        case GL_DOUBLE:
-            return static_cast<float>(*reinterpret_cast<const GLdouble*>(src));
-        default:
-            ghoul_assert(false, "Unknown data type");
-            throw ghoul::MissingCaseException();
-    }
-}
-
 GDALDataType toGDALDataType(GLenum glType) {
     switch (glType) {
         case GL_UNSIGNED_BYTE:
@@ -416,6 +397,32 @@ RawTile::ReadError postProcessErrorCheck(const RawTile& rawTile,
     return RawTile::ReadError::None;
 }
 
+/**
+ * Local rasters are decoded on the CPU, so more concurrent reads than there are processor
+ * cores don't help. Reads of WMS and other remote datasets mostly wait for the server,
+ * so they can use all \p maxReads concurrent reads.
+ */
+int maxDatasets(const std::string& filePath, int maxReads) {
+    std::error_code ec;
+    const std::filesystem::path path = filePath;
+    const bool isLocalRaster = std::filesystem::is_regular_file(path, ec) &&
+        path.extension() != ".xml" && path.extension() != ".wms";
+    if (!isLocalRaster) {
+        return std::max(maxReads, 1);
+    }
+    const int nCores = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(nCores, 1, std::max(maxReads, 1));
+}
+
+int latencyBucket(std::chrono::microseconds latency) {
+    int bucket = 0;
+    constexpr const int LastBucket = RawTileDataReader::NLatencyBuckets - 1;
+    for (int64_t ms = latency.count() / 1000; ms > 0 && bucket < LastBucket; ms >>= 1) {
+        bucket++;
+    }
+    return bucket;
+}
+
 } // namespace
 
 
@@ -432,11 +439,8 @@ RawTileDataReader::RawTileDataReader(std::string filePath,
 }
 
 RawTileDataReader::~RawTileDataReader() {
-    std::lock_guard lockGuard(_datasetLock);
-    if (_dataset) {
-        GDALClose(_dataset);
-        _dataset = nullptr;
-    }
+    logReadStatistics();
+    closeDatasets();
 }
 
 void RawTileDataReader::initialize() {
@@ -519,16 +523,20 @@ void RawTileDataReader::initialize() {
         }
     }
 
+    _datasetContent = std::move(content);
+    GDALDataset* dataset = openDataset();
+    if (!dataset) {
+        throw ghoul::RuntimeError("Failed to load dataset: " + _datasetFilePath);
+    }
     {
-        ZoneScopedN("GDALOpen")
-        _dataset = static_cast<GDALDataset*>(GDALOpen(content.c_str(), GA_ReadOnly));
-        if (!_dataset) {
-            throw ghoul::RuntimeError("Failed to load dataset: " + _datasetFilePath);
-        }
+        std::lock_guard lock(_datasetLock);
+        _freeDatasets.push_back(dataset);
+        _nDatasets = 1;
+        _maxDatasets = maxDatasets(_datasetFilePath, module.maxConcurrentTileReads());
     }
 
     // Assume all raster bands have the same data type
-    _rasterCount = _dataset->GetRasterCount();
+    _rasterCount = dataset->GetRasterCount();
 
     // calculateTileDepthTransform
     unsigned long long maximumValue = [](GLenum t) {
@@ -547,45 +555,171 @@ void RawTileDataReader::initialize() {
 
 
     _depthTransform.scale = static_cast<float>(
-        _dataset->GetRasterBand(1)->GetScale() * maximumValue
+        dataset->GetRasterBand(1)->GetScale() * maximumValue
     );
     _depthTransform.offset = static_cast<float>(
-        _dataset->GetRasterBand(1)->GetOffset()
+        dataset->GetRasterBand(1)->GetOffset()
     );
-    _rasterXSize = _dataset->GetRasterXSize();
-    _rasterYSize = _dataset->GetRasterYSize();
-    _noDataValue = static_cast<float>(_dataset->GetRasterBand(1)->GetNoDataValue());
+    _rasterXSize = dataset->GetRasterXSize();
+    _rasterYSize = dataset->GetRasterYSize();
+    _noDataValue = static_cast<float>(dataset->GetRasterBand(1)->GetNoDataValue());
     _dataType = toGDALDataType(_initData.glType);
 
-    CPLErr error = _dataset->GetGeoTransform(_padfTransform.data());
+    CPLErr error = dataset->GetGeoTransform(_padfTransform.data());
     if (error == CE_Failure) {
         _padfTransform = geoTransform(_rasterXSize, _rasterYSize);
     }
 
     double tileLevelDifference = calculateTileLevelDifference(
-        _dataset,
+        dataset,
         _initData.dimensions.x
     );
 
-    const int numOverviews = _dataset->GetRasterBand(1)->GetOverviewCount();
+    const int numOverviews = dataset->GetRasterBand(1)->GetOverviewCount();
     _maxChunkLevel = static_cast<int>(-tileLevelDifference);
     if (numOverviews > 0) {
         _maxChunkLevel += numOverviews;
     }
     _maxChunkLevel = std::max(_maxChunkLevel, 2);
+
+    _diskTileCache = module.diskTileCache();
+    if (_diskTileCache) {
+        // The tiles depend on the dataset, their layout, and the preprocessing. Local
+        // files also contribute their size and modification time so that tiles of a
+        // file that has been changed are not used anymore
+        std::array<uint64_t, 4> settings = {
+            _initData.hashKey,
+            _preprocess ? 1ULL : 0ULL,
+            0,
+            0
+        };
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(_datasetFilePath, ec)) {
+            settings[2] = std::filesystem::file_size(_datasetFilePath, ec);
+            settings[3] = static_cast<uint64_t>(
+                std::filesystem::last_write_time(_datasetFilePath, ec)
+                    .time_since_epoch().count()
+            );
+        }
+        _cacheIdentifier = cache::DiskTileCache::checksum(
+            _datasetFilePath.data(),
+            _datasetFilePath.size()
+        );
+        _cacheIdentifier = cache::DiskTileCache::checksum(
+            settings.data(),
+            settings.size() * sizeof(uint64_t),
+            _cacheIdentifier
+        );
+    }
 }
 
 void RawTileDataReader::reset() {
-    std::lock_guard lockGuard(_datasetLock);
+    closeDatasets();
     _maxChunkLevel = -1;
-    if (_dataset) {
-        GDALClose(_dataset);
-        _dataset = nullptr;
-    }
     initialize();
 }
 
-RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
+int RawTileDataReader::maxConcurrentReads() const {
+    std::lock_guard lock(_datasetLock);
+    return _maxDatasets;
+}
+
+RawTileDataReader::ReadStatistics RawTileDataReader::readStatistics() const {
+    ReadStatistics res;
+    for (int i = 0; i < NLatencyBuckets; ++i) {
+        res.latencyHistogram[i] = _latencyHistogram[i];
+        res.nReads += res.latencyHistogram[i];
+    }
+    res.totalLatency = static_cast<double>(_totalLatencyUs) / 1000.0;
+    std::lock_guard lock(_datasetLock);
+    res.nDatasets = _nDatasets;
+    return res;
+}
+
+GDALDataset* RawTileDataReader::openDataset() const {
+    ZoneScopedN("GDALOpen")
+    return static_cast<GDALDataset*>(GDALOpen(_datasetContent.c_str(), GA_ReadOnly));
+}
+
+GDALDataset* RawTileDataReader::acquireDataset() const {
+    std::unique_lock lock(_datasetLock);
+    while (true) {
+        _datasetReleased.wait(lock, [this]() {
+            return !_freeDatasets.empty() || _nDatasets < _maxDatasets;
+        });
+        if (!_freeDatasets.empty()) {
+            GDALDataset* dataset = _freeDatasets.back();
+            _freeDatasets.pop_back();
+            return dataset;
+        }
+
+        // Opening a remote dataset can take a while, so the other threads can continue
+        // to use the datasets that are already open in the meantime
+        _nDatasets++;
+        lock.unlock();
+        GDALDataset* dataset = openDataset();
+        lock.lock();
+        if (dataset) {
+            return dataset;
+        }
+
+        // Some servers limit the number of connections, so we stay with the datasets
+        // that we already have
+        _nDatasets--;
+        _maxDatasets = std::max(_nDatasets, 1);
+        LWARNINGC(_datasetFilePath, fmt::format(
+            "Failed to open another dataset, using {} concurrent reads", _maxDatasets
+        ));
+    }
+}
+
+void RawTileDataReader::releaseDataset(GDALDataset* dataset) const {
+    {
+        std::lock_guard lock(_datasetLock);
+        _freeDatasets.push_back(dataset);
+    }
+    _datasetReleased.notify_one();
+}
+
+void RawTileDataReader::closeDatasets() {
+    std::lock_guard lock(_datasetLock);
+    ghoul_assert(
+        static_cast<int>(_freeDatasets.size()) == _nDatasets,
+        "Datasets must not be closed while they are used"
+    );
+    for (GDALDataset* dataset : _freeDatasets) {
+        GDALClose(dataset);
+    }
+    _freeDatasets.clear();
+    _nDatasets = 0;
+}
+
+void RawTileDataReader::logReadStatistics() const {
+    const ReadStatistics stats = readStatistics();
+    if (stats.nReads == 0) {
+        return;
+    }
+
+    std::string histogram;
+    for (int i = 0; i < NLatencyBuckets; ++i) {
+        if (stats.latencyHistogram[i] == 0) {
+            continue;
+        }
+        if (i == NLatencyBuckets - 1) {
+            const int ms = 1 << (i - 1);
+            histogram += fmt::format(" >={}ms: {}", ms, stats.latencyHistogram[i]);
+        }
+        else {
+            histogram += fmt::format(" <{}ms: {}", 1 << i, stats.latencyHistogram[i]);
+        }
+    }
+    LDEBUGC(_datasetFilePath, fmt::format(
+        "{} reads with {} datasets, mean latency {:.1f} ms,{}",
+        stats.nReads, stats.nDatasets, stats.totalLatency / stats.nReads, histogram
+    ));
+}
+
+RawTile::ReadError RawTileDataReader::rasterRead(GDALDataset* dataset, int rasterBand,
                                                  const IODescription& io,
                                                  char* dataDestination) const
 {
@@ -612,7 +746,7 @@ RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
     dataDest -= io.write.region.start.y * io.write.bytesPerLine;
     dataDest += io.write.region.start.x * _initData.bytesPerPixel;
 
-    GDALRasterBand* gdalRasterBand = _dataset->GetRasterBand(rasterBand);
+    GDALRasterBand* gdalRasterBand = dataset->GetRasterBand(rasterBand);
     CPLErr readError = CE_Failure;
     readError = gdalRasterBand->RasterIO(
         GF_Read,
@@ -640,6 +774,29 @@ RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
 }
 
 RawTile RawTileDataReader::readTileData(TileIndex tileIndex) const {
+    if (!_diskTileCache) {
+        return readTileDataFromDataset(std::move(tileIndex));
+    }
+
+    std::optional<RawTile> cached = _diskTileCache->get(
+        _cacheIdentifier,
+        tileIndex,
+        _initData
+    );
+    if (cached) {
+        return std::move(*cached);
+    }
+
+    RawTile rawTile = readTileDataFromDataset(std::move(tileIndex));
+    // Tiles with errors might be available the next time, for example when a server is
+    // reachable again
+    if (rawTile.error == RawTile::ReadError::None) {
+        _diskTileCache->put(_cacheIdentifier, rawTile);
+    }
+    return rawTile;
+}
+
+RawTile RawTileDataReader::readTileDataFromDataset(TileIndex tileIndex) const {
     size_t numBytes = _initData.totalNumBytes;
 
     RawTile rawTile;
@@ -648,7 +805,27 @@ RawTile RawTileDataReader::readTileData(TileIndex tileIndex) const {
 
     IODescription io = ioDescription(tileIndex);
     RawTile::ReadError worstError = RawTile::ReadError::None;
-    readImageData(io, worstError, reinterpret_cast<char*>(rawTile.imageData.get()));
+    {
+        using namespace std::chrono;
+        const steady_clock::time_point start = steady_clock::now();
+
+        auto release = [this](GDALDataset* d) { releaseDataset(d); };
+        std::unique_ptr<GDALDataset, decltype(release)> dataset(
+            acquireDataset(),
+            release
+        );
+        readImageData(
+            dataset.get(),
+            io,
+            worstError,
+            reinterpret_cast<char*>(rawTile.imageData.get())
+        );
+
+        const microseconds latency =
+            duration_cast<microseconds>(steady_clock::now() - start);
+        _latencyHistogram[latencyBucket(latency)]++;
+        _totalLatencyUs += latency.count();
+    }
 
     for (const MemoryLocation& ml : NoDataAvailableData) {
         std::byte* ptr = rawTile.imageData.get();
@@ -676,16 +853,30 @@ RawTile RawTileDataReader::readTileData(TileIndex tileIndex) const {
     return rawTile;
 }
 
-void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& worstError,
+void RawTileDataReader::readImageData(GDALDataset* dataset, IODescription& io,
+                                      RawTile::ReadError& worstError,
                                       char* imageDataDest) const
 {
     // Only read the minimum number of rasters
     int nRastersToRead = std::min(_rasterCount, static_cast<int>(_initData.nRasters));
 
+    // A grayscale raster is read only once and then copied to the other color channels
+    auto readGrayscale = [&]() {
+        const RawTile::ReadError err = repeatedRasterRead(dataset, 1, io, imageDataDest);
+        worstError = std::max(worstError, err);
+        postprocessing::replicateFirstSample(
+            reinterpret_cast<std::byte*>(imageDataDest),
+            _initData.totalNumBytes / _initData.bytesPerPixel,
+            _initData.bytesPerDatum,
+            _initData.bytesPerPixel,
+            std::min(static_cast<int>(_initData.nRasters) - 1, 2)
+        );
+    };
+
     switch (_initData.ghoulTextureFormat) {
         case ghoul::opengl::Texture::Format::Red: {
             char* dest = imageDataDest;
-            const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
+            const RawTile::ReadError err = repeatedRasterRead(dataset, 1, io, dest);
             worstError = std::max(worstError, err);
             break;
         }
@@ -693,25 +884,13 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
         case ghoul::opengl::Texture::Format::RGB:
         case ghoul::opengl::Texture::Format::RGBA: {
             if (nRastersToRead == 1) { // Grayscale
-                for (int i = 0; i < 3; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
-                    worstError = std::max(worstError, err);
-                }
+                readGrayscale();
             }
             else if (nRastersToRead == 2) { // Grayscale + alpha
-                for (int i = 0; i < 3; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
-                    worstError = std::max(worstError, err);
-                }
+                readGrayscale();
                 // Last read is the alpha channel
                 char* dest = imageDataDest + (3 * _initData.bytesPerDatum);
-                const RawTile::ReadError err = repeatedRasterRead(2, io, dest);
+                const RawTile::ReadError err = repeatedRasterRead(dataset, 2, io, dest);
                 worstError = std::max(worstError, err);
             }
             else { // Three or more rasters
@@ -719,7 +898,8 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
                     // The final destination pointer is offsetted by one datum byte size
                     // for every raster (or data channel, i.e. R in RGB)
                     char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(i + 1, io, dest);
+                    const RawTile::ReadError err =
+                        repeatedRasterRead(dataset, i + 1, io, dest);
                     worstError = std::max(worstError, err);
                 }
             }
@@ -728,25 +908,13 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
         case ghoul::opengl::Texture::Format::BGR:
         case ghoul::opengl::Texture::Format::BGRA: {
             if (nRastersToRead == 1) { // Grayscale
-                for (int i = 0; i < 3; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
-                    worstError = std::max(worstError, err);
-                }
+                readGrayscale();
             }
             else if (nRastersToRead == 2) { // Grayscale + alpha
-                for (int i = 0; i < 3; i++) {
-                    // The final destination pointer is offsetted by one datum byte size
-                    // for every raster (or data channel, i.e. R in RGB)
-                    char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(1, io, dest);
-                    worstError = std::max(worstError, err);
-                }
+                readGrayscale();
                 // Last read is the alpha channel
                 char* dest = imageDataDest + (3 * _initData.bytesPerDatum);
-                const RawTile::ReadError err = repeatedRasterRead(2, io, dest);
+                const RawTile::ReadError err = repeatedRasterRead(dataset, 2, io, dest);
                 worstError = std::max(worstError, err);
             }
             else { // Three or more rasters
@@ -754,14 +922,15 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
                     // The final destination pointer is offsetted by one datum byte size
                     // for every raster (or data channel, i.e. R in RGB)
                     char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = repeatedRasterRead(3 - i, io, dest);
+                    const RawTile::ReadError err =
+                        repeatedRasterRead(dataset, 3 - i, io, dest);
                     worstError = std::max(worstError, err);
                 }
             }
             if (nRastersToRead > 3) { // Alpha channel exists
                 // Last read is the alpha channel
                 char* dest = imageDataDest + (3 * _initData.bytesPerDatum);
-                const RawTile::ReadError err = repeatedRasterRead(4, io, dest);
+                const RawTile::ReadError err = repeatedRasterRead(dataset, 4, io, dest);
                 worstError = std::max(worstError, err);
             }
             break;
@@ -821,7 +990,8 @@ glm::ivec2 RawTileDataReader::fullPixelSize() const {
     return geodeticToPixel(Geodetic2{ 90.0, 180.0 }, _padfTransform);
 }
 
-RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
+RawTile::ReadError RawTileDataReader::repeatedRasterRead(GDALDataset* dataset,
+                                                         int rasterBand,
                                                          const IODescription& fullIO,
                                                          char* dataDestination,
                                                          int depth) const
@@ -918,6 +1088,7 @@ RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
                 // as we can see in this example, it still has a top part outside the
                 // defined gdal region. This is handled through recursion.
                 const RawTile::ReadError err = repeatedRasterRead(
+                    dataset,
                     rasterBand,
                     cutoff,
                     dataDestination,
@@ -929,7 +1100,7 @@ RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
         }
     }
 
-    const RawTile::ReadError err = rasterRead(rasterBand, io, dataDestination);
+    const RawTile::ReadError err = rasterRead(dataset, rasterBand, io, dataDestination);
 
     // The return error from a repeated rasterRead is ONLY based on the main region,
     // which in the usual case will cover the main area of the patch anyway
@@ -939,56 +1110,22 @@ RawTile::ReadError RawTileDataReader::repeatedRasterRead(int rasterBand,
 TileMetaData RawTileDataReader::tileMetaData(RawTile& rawTile,
                                              const PixelRegion& region) const
 {
-    const size_t bytesPerLine = _initData.bytesPerPixel * region.numPixels.x;
-
-    TileMetaData ppData;
     ghoul_assert(_initData.nRasters <= 4, "Unexpected number of rasters");
-    ppData.nValues = static_cast<uint8_t>(_initData.nRasters);
-
-    std::fill(ppData.maxValues.begin(), ppData.maxValues.end(), -FLT_MAX);
-    std::fill(ppData.minValues.begin(), ppData.minValues.end(), FLT_MAX);
-    std::fill(ppData.hasMissingData.begin(), ppData.hasMissingData.end(), false);
-
-    bool allIsMissing = true;
-    for (int y = 0; y < region.numPixels.y; ++y) {
-        const size_t yi =
-            (static_cast<unsigned long long>(region.numPixels.y) - 1 - y) * bytesPerLine;
-        size_t i = 0;
-        for (int x = 0; x < region.numPixels.x; ++x) {
-            for (size_t raster = 0; raster < _initData.nRasters; ++raster) {
-                const float noDataValue = noDataValueAsFloat();
-                const float val = interpretFloat(
-                    _initData.glType,
-                    &(rawTile.imageData.get()[yi + i])
-                );
-                if (val != noDataValue && val == val) {
-                    ppData.maxValues[raster] = std::max(
-                        val,
-                        ppData.maxValues[raster]
-                    );
-                    ppData.minValues[raster] = std::min(
-                        val,
-                        ppData.minValues[raster]
-                    );
-                    allIsMissing = false;
-                }
-                else {
-                    ppData.hasMissingData[raster] = true;
-                    float& floatToRewrite = reinterpret_cast<float&>(
-                        rawTile.imageData[yi + i]
-                    );
-                    floatToRewrite = -std::numeric_limits<float>::max();
-                }
-                i += _initData.bytesPerDatum;
-            }
-        }
-    }
 
-    if (allIsMissing) {
+    const postprocessing::SampleStatistics stats = postprocessing::processSamples(
+        _initData.glType,
+        rawTile.imageData.get(),
+        static_cast<size_t>(region.numPixels.x) * region.numPixels.y,
+        region.numPixels.x,
+        static_cast<int>(_initData.nRasters),
+        noDataValueAsFloat()
+    );
+
+    if (!stats.hasValidData) {
         rawTile.error = RawTile::ReadError::Failure;
     }
 
-    return ppData;
+    return stats.metaData;
 }
 
 int RawTileDataReader::maxChunkLevel() const {
@@ -29,8 +29,12 @@
 #include <modules/globebrowsing/src/rawtile.h>
 #include <modules/globebrowsing/src/tiletextureinitdata.h>
 #include <ghoul/misc/boolean.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <string>
 #include <mutex>
+#include <vector>
 #include <gdal.h>
 
 class GDALDataset;
@@ -39,14 +43,33 @@ class GDALRasterBand;
 namespace openspace::globebrowsing {
 
 class GeodeticPatch;
+namespace cache { class DiskTileCache; }
 
 class RawTileDataReader {
 public:
     BooleanType(PerformPreprocessing);
 
+    /// The number of buckets of the read latency histogram
+    constexpr static const int NLatencyBuckets = 16;
+
+    struct ReadStatistics {
+        /// The number of tiles that were read from the dataset
+        uint64_t nReads = 0;
+        /// The sum of the latencies of all reads in milliseconds
+        double totalLatency = 0.0;
+        /// The number of GDAL datasets that are currently open
+        int nDatasets = 0;
+        /// Bucket 0 counts the reads that took less than 1 ms, bucket i > 0 the reads
+        /// that took at least 2^(i-1) ms and less than 2^i ms. The last bucket also
+        /// counts all slower reads
+        std::array<uint64_t, NLatencyBuckets> latencyHistogram = {};
+    };
+
     /**
      * Opens a GDALDataset in readonly mode and calculates meta data required for
-     * reading tile using a TileIndex.
+     * reading tile using a TileIndex. Concurrent calls to #readTileData read from
+     * separate GDALDatasets, which are opened as they are needed up to the limit
+     * returned by #maxConcurrentReads.
      *
      * \param filePath, a path to a specific file GDAL can read
      * \param config, Configuration used for initialization
@@ -60,18 +83,62 @@ public:
     int maxChunkLevel() const;
     float noDataValueAsFloat() const;
 
+    /**
+     * Returns the tile at \p tileIndex from the disk tile cache if it is enabled and has
+     * the tile, and reads it from the dataset otherwise.
+     */
     RawTile readTileData(TileIndex tileIndex) const;
     const TileDepthTransform& depthTransform() const;
     glm::ivec2 fullPixelSize() const;
 
+    /**
+     * \return the number of tiles that can be read at the same time, which depends on
+     *         the GlobeBrowsingModule settings, the number of processor cores, and
+     *         whether the dataset is a local file. The value is recomputed by #reset and
+     *         lowered if another dataset can not be opened
+     */
+    int maxConcurrentReads() const;
+
+    /**
+     * \return the latencies of the reads from the dataset since the reader was created.
+     *         The latency includes the time waiting for a free GDALDataset
+     */
+    ReadStatistics readStatistics() const;
+
 private:
     void initialize();
 
-    RawTile::ReadError rasterRead(int rasterBand, const IODescription& io,
-        char* dataDestination) const;
+    /**
+     * Opens another GDALDataset for the dataset of this reader.
+     *
+     * \return the new dataset, or nullptr if it could not be opened
+     */
+    GDALDataset* openDataset() const;
 
-    void readImageData(IODescription& io, RawTile::ReadError& worstError,
-        char* imageDataDest) const;
+    /**
+     * Returns a GDALDataset that is not used by any other thread. Another dataset is
+     * opened if all are in use and the limit is not reached yet. The callers are expected
+     * to not issue more than #maxConcurrentReads reads at the same time, so this function
+     * only blocks, until a dataset is released with #releaseDataset, if opening another
+     * dataset failed and the limit has been lowered.
+     */
+    GDALDataset* acquireDataset() const;
+    void releaseDataset(GDALDataset* dataset) const;
+
+    /**
+     * Closes all datasets. Must not be called while tiles are read.
+     */
+    void closeDatasets();
+
+    void logReadStatistics() const;
+
+    RawTile readTileDataFromDataset(TileIndex tileIndex) const;
+
+    RawTile::ReadError rasterRead(GDALDataset* dataset, int rasterBand,
+        const IODescription& io, char* dataDestination) const;
+
+    void readImageData(GDALDataset* dataset, IODescription& io,
+        RawTile::ReadError& worstError, char* imageDataDest) const;
 
     IODescription ioDescription(const TileIndex& tileIndex) const;
 
@@ -79,13 +146,15 @@ private:
      * A recursive function that is able to perform wrapping in case the read region of
      * the given IODescription is outside of the given write region.
      */
-    RawTile::ReadError repeatedRasterRead(int rasterBand, const IODescription& fullIO,
-        char* dataDestination, int depth = 0) const;
+    RawTile::ReadError repeatedRasterRead(GDALDataset* dataset, int rasterBand,
+        const IODescription& fullIO, char* dataDestination, int depth = 0) const;
 
     TileMetaData tileMetaData(RawTile& rawTile, const PixelRegion& region) const;
 
     const std::string _datasetFilePath;
-    GDALDataset* _dataset = nullptr;
+    // The string that is passed to GDAL to open a dataset, which can differ from the
+    // file path if the WMS cache settings are injected
+    std::string _datasetContent;
 
     // Dataset parameters
     int _rasterCount;
@@ -100,7 +169,20 @@ private:
     const PerformPreprocessing _preprocess;
     TileDepthTransform _depthTransform = { 0.f, 0.f };
 
+    // Identifies the tiles of this reader in the disk tile cache between sessions
+    cache::DiskTileCache* _diskTileCache = nullptr;
+    uint64_t _cacheIdentifier = 0;
+
+    // All open datasets that are not used by a read at the moment. The datasets in use
+    // are only referenced by the reading threads
+    mutable std::vector<GDALDataset*> _freeDatasets;
+    mutable int _nDatasets = 0;
+    mutable int _maxDatasets = 1;
     mutable std::mutex _datasetLock;
+    mutable std::condition_variable _datasetReleased;
+
+    mutable std::array<std::atomic<uint64_t>, NLatencyBuckets> _latencyHistogram = {};
+    mutable std::atomic<uint64_t> _totalLatencyUs = 0;
 };
 
 } // namespace openspace::globebrowsing
@@ -25,6 +25,7 @@
 #include <modules/globebrowsing/src/renderableglobe.h>
 
 #include <modules/debugging/rendering/debugrenderer.h>
+#include <modules/globebrowsing/src/asynctiledataprovider.h>
 #include <modules/globebrowsing/src/basictypes.h>
 #include <modules/globebrowsing/src/gpulayergroup.h>
 #include <modules/globebrowsing/src/layer.h>
@@ -40,6 +41,7 @@
 #include <openspace/scene/scene.h>
 #include <openspace/util/memorymanager.h>
 #include <openspace/util/spicemanager.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/util/time.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/filesystem/filesystem.h>
@@ -54,21 +56,7 @@
 #include <queue>
 #include <vector>
 
-#if defined(__APPLE__) || (defined(__linux__) && defined(__clang__))
-#include <experimental/memory_resource>
-namespace std {
-    using namespace experimental;
-} // namespace std
-#else
-#include <memory_resource>
-#endif
-
 namespace {
-    // Global flags to modify the RenderableGlobe
-    constexpr const bool LimitLevelByAvailableData = true;
-    constexpr const bool PerformFrustumCulling = true;
-    constexpr const bool PreformHorizonCulling = true;
-
     // Shadow structure
     struct ShadowRenderingStruct {
         double xu = 0.0;
@@ -80,10 +68,6 @@ namespace {
         bool isShadowing = false;
     };
 
-    const openspace::globebrowsing::AABB3 CullingFrustum{
-        glm::vec3(-1.f, -1.f, 0.f),
-        glm::vec3( 1.f,  1.f, 1e35f)
-    };
     constexpr const float DefaultHeight = 0.f;
 
     // I tried reducing this to 16, but it left the rendering with artifacts when the
@@ -94,7 +78,6 @@ namespace {
     // them at a cutoff level, and I think this might still be the best solution for the
     // time being.  --abock  2018-10-30
     constexpr const int DefaultSkirtedGridSegments = 64;
-    constexpr const int UnknownDesiredLevel = -1;
 
     const openspace::globebrowsing::GeodeticPatch Coverage =
         openspace::globebrowsing::GeodeticPatch(0, 0, 90, 180);
@@ -302,23 +285,15 @@ const Chunk& findChunkNode(const Chunk& node, const Geodetic2& location) {
     return *n;
 }
 
-#if defined(__APPLE__) || (defined(__linux__) && defined(__clang__))
-using ChunkTileVector = std::vector<std::pair<ChunkTile, const LayerRenderSettings*>>;
-#else
 using ChunkTileVector =
-    std::pmr::vector<std::pair<ChunkTile, const LayerRenderSettings*>>;
-#endif
+    FrameVector<std::pair<ChunkTile, const LayerRenderSettings*>>;
 
 ChunkTileVector tilesAndSettingsUnsorted(const LayerGroup& layerGroup,
                                          const TileIndex& tileIndex)
 {
     ZoneScoped
 
-#if defined(__APPLE__) || (defined(__linux__) && defined(__clang__))
-    ChunkTileVector tilesAndSettings;
-#else
-    ChunkTileVector tilesAndSettings(&global::memoryManager->TemporaryMemory);
-#endif
+    ChunkTileVector tilesAndSettings(global::memoryManager->TemporaryMemory.allocator());
     for (Layer* layer : layerGroup.activeLayers()) {
         if (layer->tileProvider()) {
             tilesAndSettings.emplace_back(
@@ -413,93 +388,13 @@ bool colorAvailableForChunk(const Chunk& chunk, const LayerManager& lm) {
     return true;
 }
 
-std::array<glm::dvec4, 8> boundingCornersForChunk(const Chunk& chunk,
-                                                  const Ellipsoid& ellipsoid,
-                                                  const BoundingHeights& heights)
-{
-    ZoneScoped
-
-    // assume worst case
-    const double patchCenterRadius = ellipsoid.maximumRadius();
-
-    const double maxCenterRadius = patchCenterRadius + heights.max;
-    Geodetic2 halfSize = chunk.surfacePatch.halfSize();
-
-    // As the patch is curved, the maximum height offsets at the corners must be long
-    // enough to cover large enough to cover a heights.max at the center of the
-    // patch.
-    // Approximating scaleToCoverCenter by assuming the latitude and longitude angles
-    // of "halfSize" are equal to the angles they create from the center of the
-    // globe to the patch corners. This is true for the longitude direction when
-    // the ellipsoid can be approximated as a sphere and for the latitude for patches
-    // close to the equator. Close to the pole this will lead to a bigger than needed
-    // value for scaleToCoverCenter. However, this is a simple calculation and a good
-    // Approximation.
-    const double y1 = tan(halfSize.lat);
-    const double y2 = tan(halfSize.lon);
-    const double scaleToCoverCenter = sqrt(1 + pow(y1, 2) + pow(y2, 2));
-
-    const double maxCornerHeight = maxCenterRadius * scaleToCoverCenter -
-        patchCenterRadius;
-
-    const bool chunkIsNorthOfEquator = chunk.surfacePatch.isNorthern();
-
-    // The minimum height offset, however, we can simply
-    const double minCornerHeight = heights.min;
-    std::array<glm::dvec4, 8> corners;
-
-    const double latCloseToEquator = chunk.surfacePatch.edgeLatitudeNearestEquator();
-    const Geodetic3 p1Geodetic = {
-        { latCloseToEquator, chunk.surfacePatch.minLon() },
-        maxCornerHeight
-    };
-    const Geodetic3 p2Geodetic = {
-        { latCloseToEquator, chunk.surfacePatch.maxLon() },
-        maxCornerHeight
-    };
-
-    const glm::vec3 p1 = ellipsoid.cartesianPosition(p1Geodetic);
-    const glm::vec3 p2 = ellipsoid.cartesianPosition(p2Geodetic);
-    const glm::vec3 p = 0.5f * (p1 + p2);
-    const Geodetic2 pGeodetic = ellipsoid.cartesianToGeodetic2(p);
-    const double latDiff = latCloseToEquator - pGeodetic.lat;
-
-    for (size_t i = 0; i < 8; ++i) {
-        const Quad q = static_cast<Quad>(i % 4);
-        const double cornerHeight = i < 4 ? minCornerHeight : maxCornerHeight;
-        Geodetic3 cornerGeodetic = { chunk.surfacePatch.corner(q), cornerHeight };
-
-        const bool cornerIsNorthern = !((i / 2) % 2);
-        const bool cornerCloseToEquator = chunkIsNorthOfEquator ^ cornerIsNorthern;
-        if (cornerCloseToEquator) {
-            cornerGeodetic.geodetic2.lat += latDiff;
-        }
-
-        corners[i] = glm::dvec4(ellipsoid.cartesianPosition(cornerGeodetic), 1.0);
-    }
-
-    return corners;
-}
-
 void expand(AABB3& bb, const glm::vec3& p) {
     bb.min = glm::min(bb.min, p);
     bb.max = glm::max(bb.max, p);
 }
 
-bool intersects(const AABB3& bb, const AABB3& o) {
-    return (bb.min.x <= o.max.x) && (o.min.x <= bb.max.x)
-        && (bb.min.y <= o.max.y) && (o.min.y <= bb.max.y)
-        && (bb.min.z <= o.max.z) && (o.min.z <= bb.max.z);
-}
-
 } // namespace
 
-Chunk::Chunk(const TileIndex& ti)
-    : tileIndex(ti)
-    , surfacePatch(ti)
-    , status(Status::DoNothing)
-{}
-
 documentation::Documentation RenderableGlobe::Documentation() {
     return codegen::doc<Parameters>("globebrowsing_renderableglobe");
 }
@@ -636,13 +531,8 @@ RenderableGlobe::RenderableGlobe(const ghoul::Dictionary& dictionary)
     addPropertySubOwner(_debugPropertyOwner);
     addPropertySubOwner(_layerManager);
 
-    _globalChunkBuffer.resize(2048);
-    _localChunkBuffer.resize(2048);
-    _traversalMemory.resize(512);
-
     _labelsDictionary = p.labels.value_or(_labelsDictionary);
 
-
     // Components
     _hasRings = p.rings.has_value();
     if (_hasRings) {
@@ -1027,9 +917,29 @@ void RenderableGlobe::renderChunks(const RenderData& data, RendererTasks&,
         viewTransform;
     const glm::dmat4 mvp = vp * _cachedModelTransform;
 
+    // The tile providers are not thread-safe, so everything that depends on the tiles
+    // is gathered up front. Afterwards the chunks are evaluated in parallel and the
+    // resulting splits and merges are applied to the trees in the original order
+    _chunkEvaluations.clear();
+    collectChunkEvaluations(_leftRoot);
+    collectChunkEvaluations(_rightRoot);
+
+    ChunkEvaluationContext context;
+    context.ellipsoid = &_ellipsoid;
+    // Calculations are done in the reference frame of the globe (model space). Hence,
+    // the camera position needs to be transformed with the inverse model matrix
+    context.cameraPosition = glm::dvec3(
+        _cachedInverseModelTransform * glm::dvec4(data.camera.positionVec3(), 1.0)
+    );
+    context.mvp = mvp;
+    context.lodScaleFactor = _generalProperties.currentLodScaleFactor;
+    context.levelByProjectedArea = _debugProperties.levelByProjectedAreaElseDistance;
+    context.updateCorners = _chunkCornersDirty;
+    evaluateChunks(_chunkEvaluations, context, *global::taskScheduler);
+
     _allChunksAvailable = true;
-    updateChunkTree(_leftRoot, data, mvp);
-    updateChunkTree(_rightRoot, data, mvp);
+    updateChunkTree(_leftRoot);
+    updateChunkTree(_rightRoot);
     _chunkCornersDirty = false;
     _iterationsOfAvailableData =
         (_allChunksAvailable ? _iterationsOfAvailableData + 1 : 0);
@@ -1135,74 +1045,60 @@ void RenderableGlobe::renderChunks(const RenderData& data, RendererTasks&,
         _globalRenderer.program->setIgnoreUniformLocationError(IgnoreError::Yes);
     }
 
-    int globalCount = 0;
-    int localCount = 0;
+    // The chunk lists are rebuilt every frame, so they are allocated from the per-frame
+    // memory instead of being kept around with a fixed size
+    FrameAllocator frameMemory = global::memoryManager->TemporaryMemory.allocator();
+    FrameVector<const Chunk*> globalChunks(frameMemory);
+    FrameVector<const Chunk*> localChunks(frameMemory);
+    FrameVector<const Chunk*> traversalMemory(frameMemory);
 
-    auto traversal = [](const Chunk& node, std::vector<const Chunk*>& global,
-        int& iGlobal, std::vector<const Chunk*>& local, int& iLocal, int cutoff,
-        std::vector<const Chunk*>& traversalMemory)
+    auto traversal = [&globalChunks, &localChunks, &traversalMemory](const Chunk& node,
+                                                                      int cutoff)
     {
         ZoneScopedN("traversal")
 
         traversalMemory.clear();
 
-        // Loop through nodes in breadths first order
+        // Loop through nodes in breadths first order. The vector is used as a queue that
+        // is only appended to, which avoids the cost of erasing from the front
         traversalMemory.push_back(&node);
-        while (!traversalMemory.empty()) {
-            const Chunk* n = traversalMemory.front();
-            traversalMemory.erase(traversalMemory.begin());
-
-            if (isLeaf(*n) && n->isVisible) {
-                if (n->tileIndex.level < cutoff) {
-                    global[iGlobal] = n;
-                    ++iGlobal;
-                }
-                else {
-                    local[iLocal] = n;
-                    ++iLocal;
+        for (size_t i = 0; i < traversalMemory.size(); ++i) {
+            const Chunk* n = traversalMemory[i];
+
+            if (isLeaf(*n)) {
+                if (n->isVisible) {
+                    if (n->tileIndex.level < cutoff) {
+                        globalChunks.push_back(n);
+                    }
+                    else {
+                        localChunks.push_back(n);
+                    }
                 }
             }
-
-            // Add children to queue, if any
-            if (!isLeaf(*n)) {
-                for (int i = 0; i < 4; ++i) {
-                    traversalMemory.push_back(n->children[i]);
+            else {
+                // Add children to queue
+                for (int j = 0; j < 4; ++j) {
+                    traversalMemory.push_back(n->children[j]);
                 }
             }
         }
     };
 
-    traversal(
-        _leftRoot,
-        _globalChunkBuffer,
-        globalCount,
-        _localChunkBuffer,
-        localCount,
-        _debugProperties.modelSpaceRenderingCutoffLevel,
-        _traversalMemory
-    );
-    traversal(
-        _rightRoot,
-        _globalChunkBuffer,
-        globalCount,
-        _localChunkBuffer,
-        localCount,
-        _debugProperties.modelSpaceRenderingCutoffLevel,
-        _traversalMemory
-    );
+    traversal(_leftRoot, _debugProperties.modelSpaceRenderingCutoffLevel);
+    traversal(_rightRoot, _debugProperties.modelSpaceRenderingCutoffLevel);
 
     // Render all chunks that want to be rendered globally
     _globalRenderer.program->activate();
-    for (int i = 0; i < globalCount; ++i) {
-        renderChunkGlobally(*_globalChunkBuffer[i], data, shadowData, renderGeomOnly);
+    for (const Chunk* chunk : globalChunks) {
+        renderChunkGlobally(*chunk, data, shadowData, renderGeomOnly);
     }
     _globalRenderer.program->deactivate();
 
 
     // Render all chunks that need to be rendered locally
     _localRenderer.program->activate();
-    for (int i = 0; i < localCount; ++i) {
-        renderChunkLocally(*_localChunkBuffer[i], data, shadowData, renderGeomOnly);
+    for (const Chunk* chunk : localChunks) {
+        renderChunkLocally(*chunk, data, shadowData, renderGeomOnly);
     }
     _localRenderer.program->deactivate();
 
@@ -1242,6 +1138,8 @@ void RenderableGlobe::renderChunkGlobally(const Chunk& chunk, const RenderData&
     ZoneScoped
     TracyGpuZone("renderChunkGlobally")
 
+    TileRequestPriority priority(chunk.tileRequestPriority, chunk.tileIndex.level);
+
     const TileIndex& tileIndex = chunk.tileIndex;
     ghoul::opengl::ProgramObject& program = *_globalRenderer.program;
 
@@ -1334,6 +1232,8 @@ void RenderableGlobe::renderChunkLocally(const Chunk& chunk, const RenderData& d
     TracyGpuZone("renderChunkLocally")
 
     //PerfMeasure("locally");
+    TileRequestPriority priority(chunk.tileRequestPriority, chunk.tileIndex.level);
+
     const TileIndex& tileIndex = chunk.tileIndex;
     ghoul::opengl::ProgramObject& program = *_localRenderer.program;
 
@@ -1805,36 +1705,6 @@ SurfacePositionHandle RenderableGlobe::calculateSurfacePositionHandle(
     };
 }
 
-bool RenderableGlobe::testIfCullable(const Chunk& chunk,
-                                     const RenderData& renderData,
-                                     const BoundingHeights& heights,
-                                     const glm::dmat4& mvp) const
-{
-    ZoneScoped
-
-    return (PreformHorizonCulling && isCullableByHorizon(chunk, renderData, heights)) ||
-           (PerformFrustumCulling && isCullableByFrustum(chunk, renderData, mvp));
-}
-
-int RenderableGlobe::desiredLevel(const Chunk& chunk, const RenderData& renderData,
-                                  const BoundingHeights& heights) const
-{
-    ZoneScoped
-
-    const int desiredLevel = _debugProperties.levelByProjectedAreaElseDistance ?
-        desiredLevelByProjectedArea(chunk, renderData, heights) :
-        desiredLevelByDistance(chunk, renderData, heights);
-    const int levelByAvailableData = desiredLevelByAvailableTileData(chunk);
-
-    if (LimitLevelByAvailableData && (levelByAvailableData != UnknownDesiredLevel)) {
-        const int l = glm::min(desiredLevel, levelByAvailableData);
-        return glm::clamp(l, MinSplitDepth, MaxSplitDepth);
-    }
-    else {
-        return glm::clamp(desiredLevel, MinSplitDepth, MaxSplitDepth);
-    }
-}
-
 float RenderableGlobe::getHeight(const glm::dvec3& position) const {
     ZoneScoped
 
@@ -2150,127 +2020,6 @@ void RenderableGlobe::calculateEclipseShadows(ghoul::opengl::ProgramObject& prog
 //  Desired Level
 //////////////////////////////////////////////////////////////////////////////////////////
 
-int RenderableGlobe::desiredLevelByDistance(const Chunk& chunk,
-                                            const RenderData& data,
-                                            const BoundingHeights& heights) const
-{
-    ZoneScoped
-
-    // Calculations are done in the reference frame of the globe
-    // (model space). Hence, the camera position needs to be transformed
-    // with the inverse model matrix
-    const glm::dvec3 cameraPosition = glm::dvec3(_cachedInverseModelTransform *
-        glm::dvec4(data.camera.positionVec3(), 1.0));
-
-    const Geodetic2 pointOnPatch = chunk.surfacePatch.closestPoint(
-        _ellipsoid.cartesianToGeodetic2(cameraPosition)
-    );
-    const glm::dvec3 patchNormal = _ellipsoid.geodeticSurfaceNormal(pointOnPatch);
-    glm::dvec3 patchPosition = _ellipsoid.cartesianSurfacePosition(pointOnPatch);
-
-    const double heightToChunk = heights.min;
-
-    // Offset position according to height
-    patchPosition += patchNormal * heightToChunk;
-
-    const glm::dvec3 cameraToChunk = patchPosition - cameraPosition;
-
-    // Calculate desired level based on distance
-    const double distanceToPatch = glm::length(cameraToChunk);
-    const double distance = distanceToPatch;
-
-    const double scaleFactor = _generalProperties.currentLodScaleFactor *
-        _ellipsoid.minimumRadius();
-    const double projectedScaleFactor = scaleFactor / distance;
-    const int desiredLevel = static_cast<int>(ceil(log2(projectedScaleFactor)));
-    return desiredLevel;
-}
-
-int RenderableGlobe::desiredLevelByProjectedArea(const Chunk& chunk,
-                                                 const RenderData& data,
-                                                 const BoundingHeights& heights) const
-{
-    ZoneScoped
-
-    // Calculations are done in the reference frame of the globe
-    // (model space). Hence, the camera position needs to be transformed
-    // with the inverse model matrix
-    const glm::dvec3 cameraPosition = glm::dvec3(
-        _cachedInverseModelTransform * glm::dvec4(data.camera.positionVec3(), 1.0)
-    );
-
-    // Approach:
-    // The projected area of the chunk will be calculated based on a small area that
-    // is close to the camera, and the scaled up to represent the full area.
-    // The advantage of doing this is that it will better handle the cases where the
-    // full patch is very curved (e.g. stretches from latitude 0 to 90 deg).
-
-    const Geodetic2 closestCorner = chunk.surfacePatch.closestCorner(
-        _ellipsoid.cartesianToGeodetic2(cameraPosition)
-    );
-
-    //  Camera
-    //  |
-    //  V
-    //
-    //  oo
-    // [  ]<
-    //                     *geodetic space*
-    //
-    //   closestCorner
-    //    +-----------------+  <-- north east corner
-    //    |                 |
-    //    |      center     |
-    //    |                 |
-    //    +-----------------+  <-- south east corner
-
-    const Geodetic2 center = chunk.surfacePatch.center();
-    const Geodetic3 c = { center, heights.min };
-    const Geodetic3 c1 = { Geodetic2{ center.lat, closestCorner.lon }, heights.min };
-    const Geodetic3 c2 = { Geodetic2{ closestCorner.lat, center.lon }, heights.min };
-
-    //  Camera
-    //  |
-    //  V
-    //
-    //  oo
-    // [  ]<
-    //                     *geodetic space*
-    //
-    //    +--------c2-------+  <-- north east corner
-    //    |                 |
-    //    c1       c        |
-    //    |                 |
-    //    +-----------------+  <-- south east corner
-
-
-    // Go from geodetic to cartesian space and project onto unit sphere
-    const glm::dvec3 camToCenter = -cameraPosition;
-    const glm::dvec3 A = glm::normalize(camToCenter + _ellipsoid.cartesianPosition(c));
-    const glm::dvec3 B = glm::normalize(camToCenter + _ellipsoid.cartesianPosition(c1));
-    const glm::dvec3 C = glm::normalize(camToCenter + _ellipsoid.cartesianPosition(c2));
-
-    // Camera                      *cartesian space*
-    // |                    +--------+---+
-    // V             __--''   __--''    /
-    //              C-------A--------- +
-    // oo          /       /          /
-    //[  ]<       +-------B----------+
-    //
-
-    // If the geodetic patch is small (i.e. has small width), that means the patch in
-    // cartesian space will be almost flat, and in turn, the triangle ABC will roughly
-    // correspond to 1/8 of the full area
-    const glm::dvec3 AB = B - A;
-    const glm::dvec3 AC = C - A;
-    const double areaABC = 0.5 * glm::length(glm::cross(AC, AB));
-    const double projectedChunkAreaApprox = 8 * areaABC;
-
-    const double scaledArea = _generalProperties.currentLodScaleFactor *
-                              projectedChunkAreaApprox;
-    return chunk.tileIndex.level + static_cast<int>(round(scaledArea - 1));
-}
-
 int RenderableGlobe::desiredLevelByAvailableTileData(const Chunk& chunk) const {
     ZoneScoped
 
@@ -2282,7 +2031,7 @@ int RenderableGlobe::desiredLevelByAvailableTileData(const Chunk& chunk) const {
         {
             Tile::Status status = layer->tileStatus(chunk.tileIndex);
             if (status == Tile::Status::OK) {
-                return UnknownDesiredLevel;
+                return ChunkEvaluation::UnknownDesiredLevel;
             }
         }
     }
@@ -2290,101 +2039,6 @@ int RenderableGlobe::desiredLevelByAvailableTileData(const Chunk& chunk) const {
     return currLevel - 1;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////
-//  Culling
-//////////////////////////////////////////////////////////////////////////////////////////
-
-bool RenderableGlobe::isCullableByFrustum(const Chunk& chunk,
-                                          const RenderData&,
-                                          const glm::dmat4& mvp) const
-{
-    ZoneScoped
-
-    const std::array<glm::dvec4, 8>& corners = chunk.corners;
-
-    // Create a bounding box that fits the patch corners
-    AABB3 bounds; // in screen space
-    for (size_t i = 0; i < 8; ++i) {
-        const glm::dvec4 cornerClippingSpace = mvp * corners[i];
-        const glm::dvec3 ndc = glm::dvec3(
-            (1.f / glm::abs(cornerClippingSpace.w)) * cornerClippingSpace
-        );
-        expand(bounds, ndc);
-    }
-
-    return !(intersects(CullingFrustum, bounds));
-}
-
-bool RenderableGlobe::isCullableByHorizon(const Chunk& chunk,
-                                          const RenderData& renderData,
-                                          const BoundingHeights& heights) const
-{
-    ZoneScoped
-
-    // Calculations are done in the reference frame of the globe. Hence, the camera
-    // position needs to be transformed with the inverse model matrix
-    const GeodeticPatch& patch = chunk.surfacePatch;
-    const float maxHeight = heights.max;
-    const glm::dvec3 globePos = glm::dvec3(0.0, 0.0, 0.0); // In model space it is 0
-    const double minimumGlobeRadius = _ellipsoid.minimumRadius();
-
-    const glm::dvec3 cameraPos = glm::dvec3(
-        _cachedInverseModelTransform * glm::dvec4(renderData.camera.positionVec3(), 1.0)
-    );
-
-    const glm::dvec3 globeToCamera = cameraPos;
-
-    const Geodetic2 camPosOnGlobe = _ellipsoid.cartesianToGeodetic2(globeToCamera);
-    const Geodetic2 closestPatchPoint = patch.closestPoint(camPosOnGlobe);
-    glm::dvec3 objectPos = _ellipsoid.cartesianSurfacePosition(closestPatchPoint);
-
-    // objectPosition is closest in latlon space but not guaranteed to be closest in
-    // castesian coordinates. Therefore we compare it to the corners and pick the
-    // real closest point,
-    std::array<glm::dvec3, 4> corners = {
-        _ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(NORTH_WEST)),
-        _ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(NORTH_EAST)),
-        _ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(SOUTH_WEST)),
-        _ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(SOUTH_EAST))
-    };
-
-    for (int i = 0; i < 4; ++i) {
-        const double distance = glm::length(cameraPos - corners[i]);
-        if (distance < glm::length(cameraPos - objectPos)) {
-            objectPos = corners[i];
-        }
-    }
-
-
-    const double objectP = pow(length(objectPos - globePos), 2);
-    const double horizonP = pow(minimumGlobeRadius - maxHeight, 2);
-    if (objectP < horizonP) {
-        return false;
-    }
-
-    const double cameraP = pow(length(cameraPos - globePos), 2);
-    const double minR = pow(minimumGlobeRadius, 2);
-    if (cameraP < minR) {
-        return false;
-    }
-
-    const double minimumAllowedDistanceToObjectFromHorizon = sqrt(objectP - horizonP);
-    const double distanceToHorizon = sqrt(cameraP - minR);
-
-    // Minimum allowed for the object to be occluded
-    const double minimumAllowedDistanceToObjectSquared =
-        pow(distanceToHorizon + minimumAllowedDistanceToObjectFromHorizon, 2) +
-        pow(maxHeight, 2);
-
-    const double distanceToObjectSquared = pow(
-        length(objectPos - cameraPos),
-        2
-    );
-    return distanceToObjectSquared > minimumAllowedDistanceToObjectSquared;
-}
-
-
-
 //////////////////////////////////////////////////////////////////////////////////////////
 //  Chunk node handling
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -2400,6 +2054,14 @@ void RenderableGlobe::splitChunkNode(Chunk& cn, int depth) {
             cn.children[i] = new (memory[i]) Chunk(
                 cn.tileIndex.child(static_cast<Quad>(i))
             );
+            // Until it is updated the first time, a child covers a quarter of the parent
+            Chunk& child = *cn.children[i];
+            child.tileRequestPriority = cn.tileRequestPriority / 4.f;
+            TileRequestPriority priority(
+                child.tileRequestPriority,
+                child.tileIndex.level
+            );
+
             const BoundingHeights& heights = boundingHeightsForChunk(
                 *(cn.children[i]),
                 _layerManager
@@ -2443,9 +2105,30 @@ void RenderableGlobe::mergeChunkNode(Chunk& cn) {
     cn.children.fill(nullptr);
 }
 
-bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
-                                      const glm::dmat4& mvp)
-{
+void RenderableGlobe::collectChunkEvaluations(Chunk& cn) {
+    ZoneScoped
+
+    // The children are visited before their parent, which is the same order in which
+    // updateChunkTree is going to apply the results
+    if (!isLeaf(cn)) {
+        for (Chunk* child : cn.children) {
+            collectChunkEvaluations(*child);
+        }
+    }
+
+    // The tiles requested here use the priority of the previous frame
+    TileRequestPriority priority(cn.tileRequestPriority, cn.tileIndex.level);
+
+    ChunkEvaluation evaluation;
+    evaluation.chunk = &cn;
+    evaluation.heights = boundingHeightsForChunk(cn, _layerManager);
+    evaluation.levelByAvailableData = desiredLevelByAvailableTileData(cn);
+    cn.heightTileOK = evaluation.heights.tileOK;
+    cn.colorTileOK = colorAvailableForChunk(cn, _layerManager);
+    _chunkEvaluations.push_back(evaluation);
+}
+
+bool RenderableGlobe::updateChunkTree(Chunk& cn) {
     ZoneScoped
 
     // abock:  I tried turning this into a queue and use iteration, rather than recursion
@@ -2453,9 +2136,11 @@ bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
     //         requires parents to be passed through the pipe twice (first to add the
     //         children and then again it self to be processed after the children finish).
     //         In addition, this didn't even improve performance ---  2018-10-04
+    //
+    // The status of every chunk has already been evaluated at this point, this pass only
+    // changes the structure of the tree
     if (isLeaf(cn)) {
         ZoneScopedN("leaf")
-        updateChunk(cn, data, mvp);
 
         if (cn.status == Chunk::Status::WantSplit) {
             splitChunkNode(cn, 1);
@@ -2471,13 +2156,12 @@ bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
         ZoneScopedN("!leaf")
         char requestedMergeMask = 0;
         for (int i = 0; i < 4; ++i) {
-            if (updateChunkTree(*cn.children[i], data, mvp)) {
+            if (updateChunkTree(*cn.children[i])) {
                 requestedMergeMask |= (1 << i);
             }
         }
 
         const bool allChildrenWantsMerge = requestedMergeMask == 0xf;
-        updateChunk(cn, data, mvp);
 
         if (allChildrenWantsMerge && (cn.status != Chunk::Status::WantSplit)) {
             mergeChunkNode(cn);
@@ -2493,40 +2177,4 @@ bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
     }
 }
 
-void RenderableGlobe::updateChunk(Chunk& chunk, const RenderData& data,
-                                  const glm::dmat4& mvp) const
-{
-    ZoneScoped
-
-    const BoundingHeights& heights = boundingHeightsForChunk(chunk, _layerManager);
-    chunk.heightTileOK = heights.tileOK;
-    chunk.colorTileOK = colorAvailableForChunk(chunk, _layerManager);
-
-    if (_chunkCornersDirty) {
-        chunk.corners = boundingCornersForChunk(chunk, _ellipsoid, heights);
-
-        // The flag gets set to false globally after the updateChunkTree calls
-    }
-
-    if (testIfCullable(chunk, data, heights, mvp)) {
-        chunk.isVisible = false;
-        chunk.status = Chunk::Status::WantMerge;
-    }
-    else {
-        chunk.isVisible = true;
-    }
-
-    const int dl = desiredLevel(chunk, data, heights);
-
-    if (dl < chunk.tileIndex.level) {
-        chunk.status = Chunk::Status::WantMerge;
-    }
-    else if (chunk.tileIndex.level < dl) {
-        chunk.status = Chunk::Status::WantSplit;
-    }
-    else {
-        chunk.status = Chunk::Status::DoNothing;
-    }
-}
-
 } // namespace openspace::globebrowsing
@@ -27,6 +27,7 @@
 
 #include <openspace/rendering/renderable.h>
 
+#include <modules/globebrowsing/src/chunk.h>
 #include <modules/globebrowsing/src/ellipsoid.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
 #include <modules/globebrowsing/src/globelabelscomponent.h>
@@ -51,38 +52,9 @@ class GPULayerGroup;
 class RenderableGlobe;
 struct TileIndex;
 
-struct BoundingHeights {
-    float min;
-    float max;
-    bool available;
-    bool tileOK;
-};
-
 namespace chunklevelevaluator { class Evaluator; }
 namespace culling { class ChunkCuller; }
 
-struct Chunk {
-    enum class Status : uint8_t {
-        DoNothing,
-        WantMerge,
-        WantSplit
-    };
-
-    Chunk(const TileIndex& tileIndex);
-
-    const TileIndex tileIndex;
-    const GeodeticPatch surfacePatch;
-
-    Status status;
-
-    bool isVisible = true;
-    bool colorTileOK = false;
-    bool heightTileOK = false;
-
-    std::array<glm::dvec4, 8> corners;
-    std::array<Chunk*, 4> children = { { nullptr, nullptr, nullptr, nullptr } };
-};
-
 enum class ShadowCompType {
     GLOBAL_SHADOW,
     LOCAL_SHADOW
@@ -118,9 +90,6 @@ public:
     static documentation::Documentation Documentation();
 
 private:
-    constexpr static const int MinSplitDepth = 2;
-    constexpr static const int MaxSplitDepth = 22;
-
     struct {
         properties::BoolProperty showChunkEdges;
         properties::BoolProperty levelByProjectedAreaElseDistance;
@@ -148,29 +117,6 @@ private:
 
     properties::PropertyOwner _shadowMappingPropertyOwner;
 
-    /**
-     * Test if a specific chunk can safely be culled without affecting the rendered
-     * image.
-     *
-     * Goes through all available <code>ChunkCuller</code>s and check if any of them
-     * allows culling of the <code>Chunk</code>s in question.
-     */
-    bool testIfCullable(const Chunk& chunk, const RenderData& renderData,
-        const BoundingHeights& heights, const glm::dmat4& mvp) const;
-
-    /**
-     * Gets the desired level which can be used to determine if a chunk should split
-     * or merge.
-     *
-     * Using <code>ChunkLevelEvaluator</code>s, the desired level can be higher or
-     * lower than the current level of the <code>Chunks</code>s
-     * <code>TileIndex</code>. If the desired level is higher than that of the
-     * <code>Chunk</code>, it wants to split. If it is lower, it wants to merge with
-     * its siblings.
-     */
-    int desiredLevel(const Chunk& chunk, const RenderData& renderData,
-        const BoundingHeights& heights) const;
-
     /**
      * Calculates the height from the surface of the reference ellipsoid to the
      * height mapped surface.
@@ -218,15 +164,6 @@ private:
     void debugRenderChunk(const Chunk& chunk, const glm::dmat4& mvp,
         bool renderBounds) const;
 
-    bool isCullableByFrustum(const Chunk& chunk, const RenderData& renderData,
-        const glm::dmat4& mvp) const;
-    bool isCullableByHorizon(const Chunk& chunk, const RenderData& renderData,
-        const BoundingHeights& heights) const;
-
-    int desiredLevelByDistance(const Chunk& chunk, const RenderData& data,
-        const BoundingHeights& heights) const;
-    int desiredLevelByProjectedArea(const Chunk& chunk, const RenderData& data,
-        const BoundingHeights& heights) const;
     int desiredLevelByAvailableTileData(const Chunk& chunk) const;
 
 
@@ -242,8 +179,13 @@ private:
 
     void splitChunkNode(Chunk& cn, int depth);
     void mergeChunkNode(Chunk& cn);
-    bool updateChunkTree(Chunk& cn, const RenderData& data, const glm::dmat4& mvp);
-    void updateChunk(Chunk& chunk, const RenderData& data, const glm::dmat4& mvp) const;
+
+    /**
+     * Gathers the tile dependent information of \p cn and all of its descendants into
+     * _chunkEvaluations in the order in which updateChunkTree visits them.
+     */
+    void collectChunkEvaluations(Chunk& cn);
+    bool updateChunkTree(Chunk& cn);
     void freeChunkNode(Chunk* n);
 
     Ellipsoid _ellipsoid;
@@ -255,14 +197,12 @@ private:
 
     ghoul::ReusableTypedMemoryPool<Chunk, 256> _chunkPool;
 
-    std::vector<const Chunk*> _globalChunkBuffer;
-    std::vector<const Chunk*> _localChunkBuffer;
-    std::vector<const Chunk*> _traversalMemory;
-
-
     Chunk _leftRoot;  // Covers all negative longitudes
     Chunk _rightRoot; // Covers all positive longitudes
 
+    // Reused between frames to avoid reallocating the list of chunks every update
+    std::vector<ChunkEvaluation> _chunkEvaluations;
+
     // Two different shader programs. One for global and one for local rendering.
     struct {
         std::unique_ptr<ghoul::opengl::ProgramObject> program;
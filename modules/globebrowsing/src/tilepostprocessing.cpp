@@ -0,0 +1,548 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tilepostprocessing.h>
+
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#define OPENSPACE_TILE_KERNELS_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENSPACE_TILE_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+    using namespace openspace::globebrowsing;
+    using namespace openspace::globebrowsing::postprocessing;
+
+    template <typename T>
+    void processScalar(T* data, size_t begin, size_t end, int nRasters,
+                       float noDataValue, SampleStatistics& stats)
+    {
+        TileMetaData& m = stats.metaData;
+        int raster = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const float val = static_cast<float>(data[i]);
+            if (val != noDataValue && val == val) {
+                m.maxValues[raster] = std::max(val, m.maxValues[raster]);
+                m.minValues[raster] = std::min(val, m.minValues[raster]);
+                stats.hasValidData = true;
+            }
+            else {
+                m.hasMissingData[raster] = true;
+                if constexpr (std::is_floating_point_v<T>) {
+                    data[i] = std::numeric_limits<T>::lowest();
+                }
+            }
+            raster = (raster + 1 == nRasters) ? 0 : raster + 1;
+        }
+    }
+
+    /**
+     * The kernels visit the samples in memory order, which is not the order in which the
+     * lines were visited historically. That only makes a difference if the minimum or
+     * maximum is zero, as then the last zero that was visited decides the sign of the
+     * result. Integer samples never convert to a negative zero.
+     */
+    template <typename T>
+    void restoreSignOfZero(const T* data, size_t nPixels, size_t pixelsPerLine,
+                           int nRasters, float noDataValue, TileMetaData& metaData)
+    {
+        if constexpr (std::is_floating_point_v<T>) {
+            const size_t nLines = nPixels / pixelsPerLine;
+            for (int raster = 0; raster < nRasters; ++raster) {
+                const bool maxIsZero = metaData.maxValues[raster] == 0.f;
+                const bool minIsZero = metaData.minValues[raster] == 0.f;
+                if (!maxIsZero && !minIsZero) {
+                    continue;
+                }
+
+                // The lines were visited bottom to top, so the last zero is the
+                // rightmost zero in the first line that has one
+                float zero = 0.f;
+                bool hasFound = false;
+                for (size_t line = 0; line < nLines && !hasFound; ++line) {
+                    for (size_t x = pixelsPerLine; x > 0 && !hasFound; --x) {
+                        const size_t pixel = line * pixelsPerLine + x - 1;
+                        const size_t sample = pixel * nRasters + raster;
+                        const float val = static_cast<float>(data[sample]);
+                        if (val == 0.f && val != noDataValue) {
+                            zero = val;
+                            hasFound = true;
+                        }
+                    }
+                }
+
+                if (maxIsZero) {
+                    metaData.maxValues[raster] = zero;
+                }
+                if (minIsZero) {
+                    metaData.minValues[raster] = zero;
+                }
+            }
+        }
+    }
+
+    template <typename D>
+    void replicateScalar(std::byte* data, size_t begin, size_t nPixels,
+                         size_t bytesPerPixel, int nCopies)
+    {
+        for (size_t i = begin; i < nPixels; ++i) {
+            std::byte* pixel = data + i * bytesPerPixel;
+            for (int c = 1; c <= nCopies; ++c) {
+                std::memcpy(pixel + c * sizeof(D), pixel, sizeof(D));
+            }
+        }
+    }
+
+#if defined(OPENSPACE_TILE_KERNELS_AVX2)
+
+    struct Simd {
+        using Vec = __m256;
+        using IntVec = __m256i;
+        constexpr static const int Width = 8;
+
+        static Vec set1(float v) { return _mm256_set1_ps(v); }
+        static Vec allOnes() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+        static Vec zero() { return _mm256_setzero_ps(); }
+
+        // NaN is unequal to everything, including the no data value
+        static Vec isValid(Vec v, Vec noDataValue) {
+            return _mm256_and_ps(
+                _mm256_cmp_ps(v, noDataValue, _CMP_NEQ_UQ),
+                _mm256_cmp_ps(v, v, _CMP_ORD_Q)
+            );
+        }
+
+        // Returns a where the mask is set and b otherwise
+        static Vec select(Vec mask, Vec a, Vec b) { return _mm256_blendv_ps(b, a, mask); }
+        static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+        static Vec bitAnd(Vec a, Vec b) { return _mm256_and_ps(a, b); }
+        static Vec bitOr(Vec a, Vec b) { return _mm256_or_ps(a, b); }
+        static int moveMask(Vec mask) { return _mm256_movemask_ps(mask); }
+        static void store(float* dst, Vec v) { _mm256_storeu_ps(dst, v); }
+
+        static Vec load(const float* src) { return _mm256_loadu_ps(src); }
+
+        static Vec load(const double* src) {
+            return _mm256_set_m128(
+                _mm256_cvtpd_ps(_mm256_loadu_pd(src + 4)),
+                _mm256_cvtpd_ps(_mm256_loadu_pd(src))
+            );
+        }
+
+        static Vec load(const int32_t* src) {
+            return _mm256_cvtepi32_ps(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src))
+            );
+        }
+
+        static Vec load(const uint32_t* src) {
+            // There is no conversion from unsigned integers. Both halves convert exactly,
+            // so the sum is rounded only once like in a scalar conversion
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+            const __m256 high = _mm256_cvtepi32_ps(_mm256_srli_epi32(v, 16));
+            const __m256 low = _mm256_cvtepi32_ps(
+                _mm256_and_si256(v, _mm256_set1_epi32(0xFFFF))
+            );
+            return _mm256_add_ps(_mm256_mul_ps(high, _mm256_set1_ps(65536.f)), low);
+        }
+
+        static Vec load(const int16_t* src) {
+            return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src))
+            ));
+        }
+
+        static Vec load(const uint16_t* src) {
+            return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src))
+            ));
+        }
+
+        static Vec load(const uint8_t* src) {
+            return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src))
+            ));
+        }
+
+        static IntVec loadInt(const std::byte* src) {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        }
+
+        static void storeInt(std::byte* dst, IntVec v) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+        }
+
+        static IntVec set1Int(int32_t v) { return _mm256_set1_epi32(v); }
+        static IntVec bitAnd(IntVec a, IntVec b) { return _mm256_and_si256(a, b); }
+        static IntVec bitOr(IntVec a, IntVec b) { return _mm256_or_si256(a, b); }
+        template <int N> static IntVec shiftLeft(IntVec v) {
+            return _mm256_slli_epi32(v, N);
+        }
+    };
+
+#elif defined(OPENSPACE_TILE_KERNELS_SSE2)
+
+    struct Simd {
+        using Vec = __m128;
+        using IntVec = __m128i;
+        constexpr static const int Width = 4;
+
+        static Vec set1(float v) { return _mm_set1_ps(v); }
+        static Vec allOnes() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+        static Vec zero() { return _mm_setzero_ps(); }
+
+        // NaN is unequal to everything, including the no data value
+        static Vec isValid(Vec v, Vec noDataValue) {
+            return _mm_and_ps(_mm_cmpneq_ps(v, noDataValue), _mm_cmpord_ps(v, v));
+        }
+
+        // Returns a where the mask is set and b otherwise
+        static Vec select(Vec mask, Vec a, Vec b) {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+        static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+        static Vec bitAnd(Vec a, Vec b) { return _mm_and_ps(a, b); }
+        static Vec bitOr(Vec a, Vec b) { return _mm_or_ps(a, b); }
+        static int moveMask(Vec mask) { return _mm_movemask_ps(mask); }
+        static void store(float* dst, Vec v) { _mm_storeu_ps(dst, v); }
+
+        static Vec load(const float* src) { return _mm_loadu_ps(src); }
+
+        static Vec load(const double* src) {
+            return _mm_movelh_ps(
+                _mm_cvtpd_ps(_mm_loadu_pd(src)),
+                _mm_cvtpd_ps(_mm_loadu_pd(src + 2))
+            );
+        }
+
+        static Vec load(const int32_t* src) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            return _mm_cvtepi32_ps(v);
+        }
+
+        static Vec load(const uint32_t* src) {
+            // There is no conversion from unsigned integers. Both halves convert exactly,
+            // so the sum is rounded only once like in a scalar conversion
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            const __m128 high = _mm_cvtepi32_ps(_mm_srli_epi32(v, 16));
+            const __m128 low = _mm_cvtepi32_ps(_mm_and_si128(v, _mm_set1_epi32(0xFFFF)));
+            return _mm_add_ps(_mm_mul_ps(high, _mm_set1_ps(65536.f)), low);
+        }
+
+        static Vec load(const int16_t* src) {
+            const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+            // Shifting the values from the upper half back down extends their sign
+            return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+        }
+
+        static Vec load(const uint16_t* src) {
+            const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+            return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+        }
+
+        static Vec load(const uint8_t* src) {
+            int32_t bytes;
+            std::memcpy(&bytes, src, sizeof(int32_t));
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero);
+            return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+        }
+
+        static IntVec loadInt(const std::byte* src) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        }
+
+        static void storeInt(std::byte* dst, IntVec v) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+        }
+
+        static IntVec set1Int(int32_t v) { return _mm_set1_epi32(v); }
+        static IntVec bitAnd(IntVec a, IntVec b) { return _mm_and_si128(a, b); }
+        static IntVec bitOr(IntVec a, IntVec b) { return _mm_or_si128(a, b); }
+        template <int N> static IntVec shiftLeft(IntVec v) {
+            return _mm_slli_epi32(v, N);
+        }
+    };
+
+#endif
+
+#if defined(OPENSPACE_TILE_KERNELS_AVX2) || defined(OPENSPACE_TILE_KERNELS_SSE2)
+
+    /**
+     * Processes the samples in blocks of whole vectors and returns the number of samples
+     * that were processed. Each vector lane always sees the same raster, for three
+     * rasters by cycling through three accumulators.
+     */
+    template <typename T>
+    size_t processVectorized(T* data, size_t nSamples, int nRasters, float noDataValue,
+                             SampleStatistics& stats)
+    {
+        using Vec = Simd::Vec;
+        constexpr const int W = Simd::Width;
+        constexpr const int FullMask = (1 << W) - 1;
+
+        const int nAccumulators = (nRasters == 3) ? 3 : 1;
+        const size_t blockSize = static_cast<size_t>(W) * nAccumulators;
+
+        const Vec noData = Simd::set1(noDataValue);
+        const Vec lowest = Simd::set1(-FLT_MAX);
+        Vec maxValues[3];
+        Vec minValues[3];
+        Vec allValid[3];
+        for (int a = 0; a < 3; ++a) {
+            maxValues[a] = Simd::set1(-FLT_MAX);
+            minValues[a] = Simd::set1(FLT_MAX);
+            allValid[a] = Simd::allOnes();
+        }
+        Vec anyValid = Simd::zero();
+
+        size_t i = 0;
+        for (; i + blockSize <= nSamples; i += blockSize) {
+            for (int a = 0; a < nAccumulators; ++a) {
+                T* samples = data + i + static_cast<size_t>(a) * W;
+                const Vec v = Simd::load(samples);
+                const Vec valid = Simd::isValid(v, noData);
+                const Vec max = Simd::max(maxValues[a], v);
+                const Vec min = Simd::min(minValues[a], v);
+                maxValues[a] = Simd::select(valid, max, maxValues[a]);
+                minValues[a] = Simd::select(valid, min, minValues[a]);
+                allValid[a] = Simd::bitAnd(allValid[a], valid);
+                anyValid = Simd::bitOr(anyValid, valid);
+
+                if constexpr (std::is_floating_point_v<T>) {
+                    const int mask = Simd::moveMask(valid);
+                    if (mask == FullMask) {
+                        continue;
+                    }
+                    if constexpr (std::is_same_v<T, float>) {
+                        Simd::store(samples, Simd::select(valid, v, lowest));
+                    }
+                    else {
+                        for (int j = 0; j < W; ++j) {
+                            if ((mask & (1 << j)) == 0) {
+                                samples[j] = std::numeric_limits<T>::lowest();
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        TileMetaData& m = stats.metaData;
+        for (int a = 0; a < nAccumulators; ++a) {
+            alignas(32) std::array<float, W> maxLanes;
+            alignas(32) std::array<float, W> minLanes;
+            Simd::store(maxLanes.data(), maxValues[a]);
+            Simd::store(minLanes.data(), minValues[a]);
+            const int validMask = Simd::moveMask(allValid[a]);
+            for (int j = 0; j < W; ++j) {
+                const int raster = (a * W + j) % nRasters;
+                m.maxValues[raster] = std::max(maxLanes[j], m.maxValues[raster]);
+                m.minValues[raster] = std::min(minLanes[j], m.minValues[raster]);
+                if ((validMask & (1 << j)) == 0) {
+                    m.hasMissingData[raster] = true;
+                }
+            }
+        }
+        stats.hasValidData |= (Simd::moveMask(anyValid) != 0);
+        return i;
+    }
+
+    /**
+     * Copies the first byte of each 4 byte pixel to the following \p nCopies bytes and
+     * returns the number of pixels that were processed.
+     */
+    size_t replicateVectorized(std::byte* data, size_t nPixels, int nCopies) {
+        using IntVec = Simd::IntVec;
+        constexpr const int W = Simd::Width;
+
+        const IntVec firstByte = Simd::set1Int(0xFF);
+        // The bytes after the copies are kept
+        const uint32_t keepMask = (nCopies >= 3) ? 0 : 0xFFFFFFFFu << (8 * nCopies + 8);
+        const IntVec keep = Simd::set1Int(static_cast<int32_t>(keepMask));
+
+        size_t i = 0;
+        for (; i + W <= nPixels; i += W) {
+            std::byte* pixels = data + i * 4;
+            const IntVec v = Simd::loadInt(pixels);
+            const IntVec first = Simd::bitAnd(v, firstByte);
+            IntVec res = Simd::bitOr(Simd::bitAnd(v, keep), first);
+            res = Simd::bitOr(res, Simd::shiftLeft<8>(first));
+            if (nCopies >= 2) {
+                res = Simd::bitOr(res, Simd::shiftLeft<16>(first));
+            }
+            if (nCopies >= 3) {
+                res = Simd::bitOr(res, Simd::shiftLeft<24>(first));
+            }
+            Simd::storeInt(pixels, res);
+        }
+        return i;
+    }
+
+#endif
+} // namespace
+
+namespace openspace::globebrowsing::postprocessing {
+
+template <typename T>
+SampleStatistics processSamples(T* data, size_t nPixels, size_t pixelsPerLine,
+                                int nRasters, float noDataValue, ForceScalar forceScalar)
+{
+    ghoul_assert(nRasters >= 1 && nRasters <= 4, "Unexpected number of rasters");
+    ghoul_assert(nPixels % pixelsPerLine == 0, "Pixels must consist of whole lines");
+
+    SampleStatistics stats;
+    stats.metaData.nValues = static_cast<uint8_t>(nRasters);
+    std::fill(stats.metaData.maxValues.begin(), stats.metaData.maxValues.end(), -FLT_MAX);
+    std::fill(stats.metaData.minValues.begin(), stats.metaData.minValues.end(), FLT_MAX);
+    std::fill(
+        stats.metaData.hasMissingData.begin(),
+        stats.metaData.hasMissingData.end(),
+        false
+    );
+
+    const size_t nSamples = nPixels * nRasters;
+    size_t nProcessed = 0;
+#if defined(OPENSPACE_TILE_KERNELS_AVX2) || defined(OPENSPACE_TILE_KERNELS_SSE2)
+    if (!forceScalar) {
+        nProcessed = processVectorized(data, nSamples, nRasters, noDataValue, stats);
+    }
+#else
+    (void)forceScalar;
+#endif
+    processScalar(data, nProcessed, nSamples, nRasters, noDataValue, stats);
+
+    restoreSignOfZero(
+        data,
+        nPixels,
+        pixelsPerLine,
+        nRasters,
+        noDataValue,
+        stats.metaData
+    );
+    return stats;
+}
+
+template SampleStatistics processSamples(uint8_t*, size_t, size_t, int, float,
+    ForceScalar);
+template SampleStatistics processSamples(uint16_t*, size_t, size_t, int, float,
+    ForceScalar);
+template SampleStatistics processSamples(int16_t*, size_t, size_t, int, float,
+    ForceScalar);
+template SampleStatistics processSamples(uint32_t*, size_t, size_t, int, float,
+    ForceScalar);
+template SampleStatistics processSamples(int32_t*, size_t, size_t, int, float,
+    ForceScalar);
+template SampleStatistics processSamples(float*, size_t, size_t, int, float,
+    ForceScalar);
+template SampleStatistics processSamples(double*, size_t, size_t, int, float,
+    ForceScalar);
+
+SampleStatistics processSamples(GLenum glType, std::byte* data, size_t nPixels,
+                                size_t pixelsPerLine, int nRasters, float noDataValue,
+                                ForceScalar forceScalar)
+{
+    auto process = [&](auto* samples) {
+        return processSamples(
+            samples,
+            nPixels,
+            pixelsPerLine,
+            nRasters,
+            noDataValue,
+            forceScalar
+        );
+    };
+
+    switch (glType) {
+        case GL_UNSIGNED_BYTE:
+            return process(reinterpret_cast<uint8_t*>(data));
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return process(reinterpret_cast<uint16_t*>(data));
+        case GL_SHORT:
+            return process(reinterpret_cast<int16_t*>(data));
+        case GL_UNSIGNED_INT:
+            return process(reinterpret_cast<uint32_t*>(data));
+        case GL_INT:
+            return process(reinterpret_cast<int32_t*>(data));
+        case GL_FLOAT:
+            return process(reinterpret_cast<float*>(data));
+        case GL_DOUBLE:
+            return process(reinterpret_cast<double*>(data));
+        default:
+            ghoul_assert(false, "Unknown data type");
+            throw ghoul::MissingCaseException();
+    }
+}
+
+void replicateFirstSample(std::byte* data, size_t nPixels, size_t bytesPerDatum,
+                          size_t bytesPerPixel, int nCopies, ForceScalar forceScalar)
+{
+    ghoul_assert(
+        (nCopies + 1) * bytesPerDatum <= bytesPerPixel,
+        "Copies must stay within the pixel"
+    );
+
+    size_t nProcessed = 0;
+#if defined(OPENSPACE_TILE_KERNELS_AVX2) || defined(OPENSPACE_TILE_KERNELS_SSE2)
+    if (!forceScalar && bytesPerDatum == 1 && bytesPerPixel == 4) {
+        nProcessed = replicateVectorized(data, nPixels, nCopies);
+    }
+#else
+    (void)forceScalar;
+#endif
+
+    switch (bytesPerDatum) {
+        case 1:
+            replicateScalar<uint8_t>(data, nProcessed, nPixels, bytesPerPixel, nCopies);
+            break;
+        case 2:
+            replicateScalar<uint16_t>(data, nProcessed, nPixels, bytesPerPixel, nCopies);
+            break;
+        case 4:
+            replicateScalar<uint32_t>(data, nProcessed, nPixels, bytesPerPixel, nCopies);
+            break;
+        case 8:
+            replicateScalar<uint64_t>(data, nProcessed, nPixels, bytesPerPixel, nCopies);
+            break;
+        default:
+            throw ghoul::MissingCaseException();
+    }
+}
+
+} // namespace openspace::globebrowsing::postprocessing
@@ -0,0 +1,103 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILE_POST_PROCESSING___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILE_POST_PROCESSING___H__
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <ghoul/misc/boolean.h>
+#include <ghoul/opengl/ghoul_gl.h>
+#include <cstddef>
+
+/**
+ * The kernels that process the samples of a tile after it has been read by GDAL. Each
+ * kernel is instantiated for every data type that a tile can have and uses AVX2 or SSE2
+ * if the compiler targets them, and plain loops otherwise. All implementations produce
+ * bit-identical results.
+ */
+namespace openspace::globebrowsing::postprocessing {
+
+BooleanType(ForceScalar);
+
+struct SampleStatistics {
+    TileMetaData metaData;
+    /// Whether any of the samples was valid
+    bool hasValidData = false;
+};
+
+/**
+ * Computes the minimum and maximum value of every raster for the samples at \p data,
+ * which consist of \p nPixels pixels with \p nRasters interleaved samples of type
+ * \p T each. Samples that are equal to \p noDataValue or NaN are not considered and are
+ * marked as missing data. Missing floating point samples are replaced by the lowest
+ * value of their type; other samples are never changed.
+ *
+ * The samples are converted to float before they are compared. If several samples are
+ * equal to the minimum or maximum, the result is the one that comes last when the lines
+ * of \p pixelsPerLine pixels are visited bottom to top, which is the order in which
+ * tiles have always been processed. This only matters for the sign of zero.
+ *
+ * \param data The samples that are processed in place
+ * \param nPixels The number of pixels, which has to be a multiple of \p pixelsPerLine
+ * \param pixelsPerLine The number of pixels per line
+ * \param nRasters The number of samples per pixel, between 1 and 4
+ * \param noDataValue The value that marks missing data
+ * \param forceScalar If this is \c Yes, the plain loops are used even if vector
+ *        instructions are available
+ * \return The minimum and maximum value of every raster and whether it is missing data.
+ *         Rasters without valid samples have a minimum of <code>FLT_MAX</code> and a
+ *         maximum of <code>-FLT_MAX</code>
+ */
+template <typename T>
+SampleStatistics processSamples(T* data, size_t nPixels, size_t pixelsPerLine,
+    int nRasters, float noDataValue, ForceScalar forceScalar = ForceScalar::No);
+
+/**
+ * Calls the processSamples instantiation for the data type \p glType. The half float
+ * type is processed as 16 bit unsigned integers. Throws a ghoul::MissingCaseException
+ * for data types that are not supported.
+ */
+SampleStatistics processSamples(GLenum glType, std::byte* data, size_t nPixels,
+    size_t pixelsPerLine, int nRasters, float noDataValue,
+    ForceScalar forceScalar = ForceScalar::No);
+
+/**
+ * Copies the first sample of each of the \p nPixels pixels at \p data to the following
+ * \p nCopies samples of the same pixel, for example to turn a grayscale image into an
+ * RGB image without reading the same raster several times.
+ *
+ * \param data The interleaved samples
+ * \param nPixels The number of pixels
+ * \param bytesPerDatum The size of a single sample, which can be 1, 2, 4, or 8 bytes
+ * \param bytesPerPixel The distance between two pixels in bytes
+ * \param nCopies The number of samples following the first one that are overwritten
+ * \param forceScalar If this is \c Yes, the plain loops are used even if vector
+ *        instructions are available
+ */
+void replicateFirstSample(std::byte* data, size_t nPixels, size_t bytesPerDatum,
+    size_t bytesPerPixel, int nCopies, ForceScalar forceScalar = ForceScalar::No);
+
+} // namespace openspace::globebrowsing::postprocessing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_POST_PROCESSING___H__
@@ -33,11 +33,13 @@
 #include <openspace/rendering/renderengine.h>
 #include <openspace/util/memorymanager.h>
 #include <openspace/util/spicemanager.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/util/timemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/io/texture/texturereader.h>
 #include <ghoul/opengl/openglstatecache.h>
 #include <ghoul/opengl/textureunit.h>
+#include <algorithm>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
@@ -47,6 +49,9 @@ namespace {
     constexpr const char* KeyBasePath = "BasePath";
 
     constexpr const char* TimePlaceholder = "${OpenSpaceTimeId}";
+
+    // The number of seconds of wall-clock time for which the timesteps are prefetched
+    constexpr const double PrefetchHorizon = 2.0;
     
     constexpr openspace::properties::Property::PropertyInfo FilePathInfo = {
         "FilePath",
@@ -70,6 +75,23 @@ namespace {
         "time taken from OpenSpace for the displayed tiles."
     };
 
+    constexpr openspace::properties::Property::PropertyInfo MaxCachedProvidersInfo = {
+        "MaxCachedProviders",
+        "Maximum Cached Providers",
+        "The maximum number of timesteps for which the image data is kept open. If more "
+        "timesteps are needed, the least recently used ones are closed. The loaded tiles "
+        "are not affected by this value, as they are stored in the shared tile cache."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchCountInfo = {
+        "PrefetchCount",
+        "Prefetch Count",
+        "The maximum number of timesteps that are opened in the background ahead of the "
+        "current time, in the direction in which the time is moving. How many of these "
+        "are used depends on how fast the time is moving. A value of 0 disables the "
+        "prefetching."
+    };
+
     struct [[codegen::Dictionary(TemporalTileProvider)]] Parameters {
         // [[codegen::verbatim(UseFixedTimeInfo.description)]]
         std::optional<bool> useFixedTime;
@@ -77,6 +99,12 @@ namespace {
         // [[codegen::verbatim(FixedTimeInfo.description)]]
         std::optional<std::string> fixedTime;
 
+        // [[codegen::verbatim(MaxCachedProvidersInfo.description)]]
+        std::optional<int> maxCachedProviders [[codegen::inrange(8, 128)]];
+
+        // [[codegen::verbatim(PrefetchCountInfo.description)]]
+        std::optional<int> prefetchCount [[codegen::inrange(0, 16)]];
+
         enum class Mode {
             Prototyped,
             Folder
@@ -173,6 +201,15 @@ TemporalTileProvider::TemporalTileProvider(const ghoul::Dictionary& dictionary)
     : _initDict(dictionary)
     , _useFixedTime(UseFixedTimeInfo, false)
     , _fixedTime(FixedTimeInfo)
+    , _maxCachedProviders(MaxCachedProvidersInfo, 16, 8, 128)
+    , _prefetchCount(PrefetchCountInfo, 4, 0, 16)
+    , _tileProviderCache(
+        static_cast<size_t>(_maxCachedProviders.value()),
+        *global::taskScheduler,
+        [this](double time, DefaultTileProvider& tileProvider) {
+            initializeTileProvider(time, tileProvider);
+        }
+    )
 {
     ZoneScoped
 
@@ -199,6 +236,18 @@ TemporalTileProvider::TemporalTileProvider(const ghoul::Dictionary& dictionary)
     _fixedTime.onChange([this]() { _fixedTimeDirty = true; });
     addProperty(_fixedTime);
 
+    _maxCachedProviders = p.maxCachedProviders.value_or(_maxCachedProviders);
+    _maxCachedProviders.onChange([this]() {
+        _tileProviderCache.setMaximumSize(
+            static_cast<size_t>(_maxCachedProviders.value())
+        );
+    });
+    _tileProviderCache.setMaximumSize(static_cast<size_t>(_maxCachedProviders.value()));
+    addProperty(_maxCachedProviders);
+
+    _prefetchCount = p.prefetchCount.value_or(_prefetchCount);
+    addProperty(_prefetchCount);
+
     _colormap = p.colormap.value_or(_colormap);
 
     if (p.prototyped.has_value()) {
@@ -222,6 +271,9 @@ TemporalTileProvider::TemporalTileProvider(const ghoul::Dictionary& dictionary)
             );
             _prototyped.timeQuantizer.setResolution(p.prototyped->temporalResolution);
             _prototyped.temporalResolution = p.prototyped->temporalResolution;
+            _prototyped.resolution = _prototyped.timeQuantizer.parseTimeResolutionStr(
+                p.prototyped->temporalResolution
+            );
         }
         catch (const ghoul::RuntimeError& e) {
             throw ghoul::RuntimeError(fmt::format(
@@ -327,13 +379,16 @@ void TemporalTileProvider::update() {
         if (_useFixedTime && !_fixedTime.value().empty()) {
             if (_fixedTimeDirty) {
                 std::string fixedTime = _fixedTime.value();
-                double et = SpiceManager::ref().ephemerisTimeFromDate(fixedTime);
-                newCurr = retrieveTileProvider(Time(et));
+                _fixedTimeJ2000 = SpiceManager::ref().ephemerisTimeFromDate(fixedTime);
                 _fixedTimeDirty = false;
             }
+            // The provider has to be requested every frame to keep it in the cache
+            newCurr = retrieveTileProvider(Time(_fixedTimeJ2000));
         }
         else {
-            newCurr = tileProvider(global::timeManager->time());
+            const Time& time = global::timeManager->time();
+            newCurr = tileProvider(time);
+            prefetchTileProviders(time.j2000Seconds(), global::timeManager->deltaTime());
         }
     }
     catch (const ghoul::RuntimeError& e) {
@@ -346,12 +401,26 @@ void TemporalTileProvider::update() {
     if (_currentTileProvider) {
         _currentTileProvider->update();
     }
+
+    // The providers that are not in use pass on the tiles they have finished loading and
+    // load the coarsest tiles, so that a prefetched timestep can be shown immediately
+    _tileProviderCache.forEachIdle([](DefaultTileProvider& tileProvider) {
+        tileProvider.tile(TileIndex(0, 0, 1));
+        tileProvider.tile(TileIndex(1, 0, 1));
+        tileProvider.update();
+    });
+
+    // Providers are only evicted when all providers that are in use have been requested
+    // in this frame. Otherwise we might remove one that we are still holding on to
+    if (newCurr) {
+        _tileProviderCache.update();
+    }
 }
 
 void TemporalTileProvider::reset() {
-    for (std::pair<const double, DefaultTileProvider>& it : _tileProviderMap) {
-        it.second.reset();
-    }
+    _tileProviderCache.forEach([](DefaultTileProvider& tileProvider) {
+        tileProvider.reset();
+    });
 }
 
 int TemporalTileProvider::maxLevel() {
@@ -365,9 +434,7 @@ float TemporalTileProvider::noDataValueAsFloat() {
     return std::numeric_limits<float>::min();
 }
 
-DefaultTileProvider TemporalTileProvider::createTileProvider(
-                                                           std::string_view timekey) const
-{
+ghoul::Dictionary TemporalTileProvider::providerDictionary(double time) const {
     ZoneScoped
 
     std::string value;
@@ -378,6 +445,7 @@ DefaultTileProvider TemporalTileProvider::createTileProvider(
                 "${x}", "${y}", "${z}", "${version}" "${format}", "${layer}"
             };
 
+            std::string_view timekey = timeStringify(_prototyped.timeFormat, Time(time));
             value = _prototyped.prototype;
             while (true) {
                 const size_t pos = value.find(TimePlaceholder);
@@ -394,51 +462,152 @@ DefaultTileProvider TemporalTileProvider::createTileProvider(
             break;
         }
         case Mode::Folder: {
-            value = std::string(timekey);
+            auto it = std::lower_bound(
+                _folder.files.cbegin(),
+                _folder.files.cend(),
+                time,
+                [](const std::pair<double, std::string>& p, double t) {
+                    return p.first < t;
+                }
+            );
+            value = it->second;
             break;
         }
     }
 
     ghoul::Dictionary dict = _initDict;
     dict.setValue("FilePath", value);
-    return DefaultTileProvider(dict);
+    return dict;
+}
+
+TemporalTileProvider::ProviderCache::Creator TemporalTileProvider::providerCreator(
+                                                                        double time) const
+{
+    // The dictionary has to be created on this thread as it needs Spice and the path
+    // tokens, the provider itself can be created on any thread
+    auto dict = std::make_shared<const ghoul::Dictionary>(providerDictionary(time));
+    return [dict]() { return std::make_unique<DefaultTileProvider>(*dict); };
 }
 
 DefaultTileProvider* TemporalTileProvider::retrieveTileProvider(const Time& t) {
     ZoneScoped
 
     const double time = t.j2000Seconds();
-    if (const auto it = _tileProviderMap.find(time);  it != _tileProviderMap.end()) {
-        return &it->second;
+    return _tileProviderCache.provider(
+        time,
+        [this, time]() {
+            return std::make_unique<DefaultTileProvider>(providerDictionary(time));
+        }
+    );
+}
+
+void TemporalTileProvider::initializeTileProvider(double time,
+                                                  DefaultTileProvider& tileProvider)
+{
+    tileProvider.initialize();
+
+    const auto it = _providerIdentifiers.find(time);
+    if (it != _providerIdentifiers.end()) {
+        tileProvider.uniqueIdentifier = it->second;
+    }
+    else {
+        _providerIdentifiers[time] = tileProvider.uniqueIdentifier;
     }
+}
 
-    std::string_view timeStr = [this, time]() {
-        switch (_mode) {
-            case Mode::Prototype:
-                return timeStringify(_prototyped.timeFormat, Time(time));
-            case Mode::Folder: {
-                // Yes this will have to be done twice since we do the check previously
-                // but it is only happening when the images change, so I think that should
-                // be fine
-                auto it = std::lower_bound(
-                    _folder.files.cbegin(),
-                    _folder.files.cend(),
-                    time,
-                    [](const std::pair<double, std::string>& p, double time) {
-                        return p.first < time;
-                    }
-                );
-                return std::string_view(it->second);
-            }
-            default:  throw ghoul::MissingCaseException();
-        };
-    }();
+void TemporalTileProvider::prefetchTileProviders(double time, double deltaTime) {
+    ZoneScoped
 
-    DefaultTileProvider tileProvider = createTileProvider(timeStr);
-    tileProvider.initialize();
+    // Each prefetched provider evicts another one from the cache, so we don't want to
+    // prefetch more than a fraction of it
+    const int nTargets = std::min(
+        _prefetchCount.value(),
+        _maxCachedProviders.value() / 2
+    );
+    if (nTargets == 0 || deltaTime == 0.0) {
+        return;
+    }
+
+    const bool isForward = deltaTime > 0.0;
+    if (_prefetch.timestep != _currentTimestep || _prefetch.isForward != isForward ||
+        _prefetch.nTargets != nTargets)
+    {
+        _prefetch.timestep = _currentTimestep;
+        _prefetch.isForward = isForward;
+        _prefetch.nTargets = nTargets;
+        _prefetch.targets.clear();
+        for (double t : nextTimesteps(isForward, nTargets)) {
+            _prefetch.targets.push_back({ t, providerCreator(t) });
+        }
+    }
+
+    // The next timestep is always prefetched, the ones after that only if the time will
+    // reach them within the prefetch horizon
+    const double horizon = time + deltaTime * PrefetchHorizon;
+    double boundary = _currentTimestep;
+    for (size_t i = 0; i < _prefetch.targets.size(); ++i) {
+        const PrefetchTarget& target = _prefetch.targets[i];
+        const bool isReached = isForward ? horizon >= target.time : horizon < boundary;
+        if (i > 0 && !isReached) {
+            break;
+        }
+
+        _tileProviderCache.prefetch(target.time, target.create);
+        boundary = target.time;
+    }
+}
+
+std::vector<double> TemporalTileProvider::nextTimesteps(bool isForward, int n) {
+    ZoneScoped
 
-    auto it = _tileProviderMap.insert({ time, std::move(tileProvider) });
-    return &it.first->second;
+    std::vector<double> res;
+    switch (_mode) {
+        case Mode::Prototype: {
+            // Moving by one and a half resolution from the start of a timestep lands in
+            // the next timestep and half a resolution back in the previous one, even if
+            // the timesteps are of different length, like months
+            const double step = (isForward ? 1.5 : -0.5) * _prototyped.resolution;
+            double t = _currentTimestep;
+            for (int i = 0; i < n; ++i) {
+                Time next = Time(t + step);
+                if (!_prototyped.timeQuantizer.quantize(next, true) ||
+                    next.j2000Seconds() == t)
+                {
+                    // We have reached the end of the dataset
+                    break;
+                }
+                t = next.j2000Seconds();
+                res.push_back(t);
+            }
+            break;
+        }
+        case Mode::Folder: {
+            using It = std::vector<std::pair<double, std::string>>::const_iterator;
+            It it = std::lower_bound(
+                _folder.files.cbegin(),
+                _folder.files.cend(),
+                _currentTimestep,
+                [](const std::pair<double, std::string>& p, double t) {
+                    return p.first < t;
+                }
+            );
+            if (it == _folder.files.cend()) {
+                break;
+            }
+
+            const ptrdiff_t index = std::distance(_folder.files.cbegin(), it);
+            const ptrdiff_t nFiles = static_cast<ptrdiff_t>(_folder.files.size());
+            for (int i = 1; i <= n; ++i) {
+                const ptrdiff_t next = isForward ? index + i : index - i;
+                if (next < 0 || next >= nFiles) {
+                    break;
+                }
+                res.push_back(_folder.files[next].first);
+            }
+            break;
+        }
+    }
+    return res;
 }
 
 template <>
@@ -463,8 +632,8 @@ TemporalTileProvider::tileProvider<TemporalTileProvider::Mode::Folder, false>(
         it -= 1;
     }
 
-    double t = it->first;
-    return retrieveTileProvider(Time(t));
+    _currentTimestep = it->first;
+    return retrieveTileProvider(Time(_currentTimestep));
 }
 
 template <>
@@ -486,6 +655,7 @@ TemporalTileProvider::tileProvider<TemporalTileProvider::Mode::Folder, true>(
     It nextNext = next != _folder.files.end() ? next + 1 : curr;
     It prev = curr != _folder.files.begin() ? curr - 1 : curr;
 
+    _currentTimestep = curr->first;
     _interpolateTileProvider->t1 = retrieveTileProvider(Time(curr->first));
     _interpolateTileProvider->t2 = retrieveTileProvider(Time(next->first));
     _interpolateTileProvider->future = retrieveTileProvider(Time(nextNext->first));
@@ -510,6 +680,7 @@ TemporalTileProvider::tileProvider<TemporalTileProvider::Mode::Prototype, false>
 {
     Time tCopy(time);
     if (_prototyped.timeQuantizer.quantize(tCopy, true)) {
+        _currentTimestep = tCopy.j2000Seconds();
         return retrieveTileProvider(tCopy);
     }
     else {
@@ -533,6 +704,7 @@ TemporalTileProvider::tileProvider<TemporalTileProvider::Mode::Prototype, true>(
     Time secondToLast = Time(_prototyped.endTimeJ2000);
     Time secondToFirst = Time(_prototyped.startTimeJ2000);
 
+    _currentTimestep = tCopy.j2000Seconds();
     _interpolateTileProvider->t1 = retrieveTileProvider(tCopy);
     
     // if the images are for each hour
@@ -27,8 +27,11 @@
 
 #include <modules/globebrowsing/src/tileprovider/tileprovider.h>
 
+#include <modules/globebrowsing/src/providercache.h>
 #include <modules/globebrowsing/src/tileprovider/defaulttileprovider.h>
 #include <modules/globebrowsing/src/tileprovider/singleimagetileprovider.h>
+#include <limits>
+#include <vector>
 
 namespace openspace::globebrowsing {
 
@@ -86,8 +89,30 @@ private:
         std::unique_ptr<ghoul::opengl::Texture> colormap;
     };
 
-    DefaultTileProvider createTileProvider(std::string_view timekey) const;
+    using ProviderCache = cache::ProviderCache<DefaultTileProvider>;
+
+    struct PrefetchTarget {
+        double time = 0.0;
+        ProviderCache::Creator create;
+    };
+
+    ghoul::Dictionary providerDictionary(double time) const;
+    ProviderCache::Creator providerCreator(double time) const;
     DefaultTileProvider* retrieveTileProvider(const Time& t);
+    void initializeTileProvider(double time, DefaultTileProvider& tileProvider);
+
+    /**
+     * Starts loading the tile providers for the timesteps that follow the current one in
+     * the direction of \p deltaTime. The number of timesteps depends on how many of them
+     * will be passed within the next few seconds at the current rate.
+     */
+    void prefetchTileProviders(double time, double deltaTime);
+
+    /**
+     * Returns up to \p n timesteps that follow the current timestep in the direction of
+     * time, sorted by the order in which they will be reached.
+     */
+    std::vector<double> nextTimesteps(bool isForward, int n);
 
     template <Mode mode, bool interpolation>
     TileProvider* tileProvider(const Time& time);
@@ -101,6 +126,7 @@ private:
         double endTimeJ2000 = 0.0;
 
         std::string temporalResolution;
+        double resolution = 0.0;
         std::string timeFormat;
         TimeQuantizer timeQuantizer;
         std::string prototype;
@@ -117,9 +143,24 @@ private:
     properties::BoolProperty _useFixedTime;
     properties::StringProperty _fixedTime;
     bool _fixedTimeDirty = true;
+    double _fixedTimeJ2000 = 0.0;
+    properties::IntProperty _maxCachedProviders;
+    properties::IntProperty _prefetchCount;
 
     TileProvider* _currentTileProvider = nullptr;
-    std::unordered_map<double, DefaultTileProvider> _tileProviderMap;
+    double _currentTimestep = 0.0;
+    ProviderCache _tileProviderCache;
+
+    // Evicted providers are recreated with the same identifier, so that the tiles they
+    // had loaded can be found in the tile cache again
+    std::unordered_map<double, uint16_t> _providerIdentifiers;
+
+    struct {
+        double timestep = std::numeric_limits<double>::quiet_NaN();
+        bool isForward = true;
+        int nTargets = 0;
+        std::vector<PrefetchTarget> targets;
+    } _prefetch;
 
     bool _isInterpolating = false;
 
@@ -36,6 +36,7 @@
 #include <openspace/rendering/luaconsole.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/scene/scene.h>
+#include <openspace/util/memorymanager.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/profiling.h>
 
@@ -57,7 +58,8 @@ ImGUIModule::ImGUIModule() : OpenSpaceModule(Name) {
                 global::renderEngine,
                 global::parallelPeer,
                 global::luaConsole,
-                global::dashboard
+                global::dashboard,
+                global::memoryManager
             };
             return res;
         }
@@ -26,6 +26,7 @@
 
 #include <modules/imgui/include/imgui_include.h>
 #include <openspace/engine/globals.h>
+#include <openspace/engine/syncengine.h>
 #include <openspace/util/memorymanager.h>
 
 namespace {
@@ -68,8 +69,24 @@ void GuiMemoryComponent::render() {
     ImGui::Text("%s", "Persistent Memory Pool");
     renderMemoryPoolInformation(global::memoryManager->PersistentMemory);
 
-    //ImGui::Text("%s", "Temporary Memory Pool");
-    //renderMemoryPoolInformation(global::memoryManager.TemporaryMemory);
+    const FrameArena& arena = global::memoryManager->TemporaryMemory;
+    ImGui::Text("%s", "Temporary Memory Arena");
+    ImGui::Text("  Capacity: %.2f kiB", arena.capacity() / 1024.f);
+    ImGui::Text("  Last frame: %.2f kiB", arena.lastFrameUsage() / 1024.f);
+    ImGui::Text("  High-water mark: %.2f kiB", arena.highWaterMark() / 1024.f);
+    ImGui::Text(
+        "  Overflows: %i (last frame: %i)",
+        static_cast<int>(arena.totalOverflows()),
+        static_cast<int>(arena.lastFrameOverflows())
+    );
+
+    const SyncEngine::Statistics& sync = global::syncEngine->statistics();
+    ImGui::Text("%s", "Synchronization Buffer");
+    ImGui::Text("  Last frame: %.2f kiB", sync.nBytes / 1024.f);
+    ImGui::Text("  Largest frame: %.2f kiB", sync.nBytesMax / 1024.f);
+    ImGui::Text("  Skipped Syncables: %i", static_cast<int>(sync.nSkipped));
+    ImGui::Text("  Encoding: %.3f ms", sync.encodeTime * 1000.0);
+    ImGui::Text("  Decoding: %.3f ms", sync.decodeTime * 1000.0);
     ImGui::End();
 }
 
@@ -34,6 +34,7 @@
 #include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
 #include <ghoul/misc/templatefactory.h>
 #include <ghoul/io/texture/texturereader.h>
 #include <ghoul/opengl/openglstatecache.h>
@@ -978,7 +979,7 @@ void RenderableStars::renderPSFToTexture() {
 }
 
 void RenderableStars::render(const RenderData& data, RendererTasks&) {
-    if (_dataset.entries.empty()) {
+    if (_dataset.nEntries() == 0) {
         return;
     }
 
@@ -1078,7 +1079,7 @@ void RenderableStars::render(const RenderData& data, RendererTasks&) {
 
 
     glBindVertexArray(_vao);
-    const GLsizei nStars = static_cast<GLsizei>(_dataset.entries.size());
+    const GLsizei nStars = static_cast<GLsizei>(_dataset.nEntries());
     glDrawArrays(GL_POINTS, 0, nStars);
 
     glBindVertexArray(0);
@@ -1096,7 +1097,7 @@ void RenderableStars::update(const UpdateData&) {
         _dataIsDirty = true;
     }
 
-    if (_dataset.entries.empty()) {
+    if (_dataset.nEntries() == 0) {
         return;
     }
 
@@ -1127,7 +1128,7 @@ void RenderableStars::update(const UpdateData&) {
             "in_bvLumAbsMagAppMag"
         );
 
-        const size_t nStars = _dataset.entries.size();
+        const size_t nStars = _dataset.nEntries();
         const size_t nValues = slice.size() / nStars;
 
         GLsizei stride = static_cast<GLsizei>(sizeof(GLfloat) * nValues);
@@ -1306,8 +1307,8 @@ void RenderableStars::loadData() {
         return;
     }
 
-    _dataset = speck::data::loadFileWithCache(file);
-    if (_dataset.entries.empty()) {
+    _dataset = speck::data::loadColumnarFileWithCache(file);
+    if (_dataset.nEntries() == 0) {
         return;
     }
 
@@ -1349,9 +1350,25 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
 
     std::vector<float> result;
     // 7 for the default Color option of 3 positions + bv + lum + abs + app magnitude
-    result.reserve(_dataset.entries.size() * 7);
-    for (const speck::Dataset::Entry& e : _dataset.entries) {
-        glm::dvec3 position = glm::dvec3(e.position) * distanceconstants::Parsec;
+    result.reserve(_dataset.nEntries() * 7);
+    // Resolve the columns once; the slice is then assembled directly from them
+    const glm::vec3* positions = _dataset.positions();
+    const float* bv = _dataset.column(bvIdx);
+    const float* lum = _dataset.column(lumIdx);
+    const float* absMag = _dataset.column(absMagIdx);
+    const float* appMag = _dataset.column(appMagIdx);
+    const float* vx = _dataset.column(vxIdx);
+    const float* vy = _dataset.column(vyIdx);
+    const float* vz = _dataset.column(vzIdx);
+    const float* speed = _dataset.column(speedIdx);
+    const float* other = _dataset.column(_otherDataOption.value());
+    ghoul_assert(
+        bv && lum && absMag && appMag && vx && vy && vz && speed,
+        "All data value indices must refer to existing columns"
+    );
+
+    for (size_t i = 0; i < _dataset.nEntries(); i++) {
+        glm::dvec3 position = glm::dvec3(positions[i]) * distanceconstants::Parsec;
         maxRadius = std::max(maxRadius, glm::length(position));
 
         switch (option) {
@@ -1369,10 +1386,10 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                     static_cast<float>(position[2])
                 }};
 
-                layout.value.value = e.data[bvIdx];
-                layout.value.luminance = e.data[lumIdx];
-                layout.value.absoluteMagnitude = e.data[absMagIdx];
-                layout.value.apparentMagnitude = e.data[appMagIdx];
+                layout.value.value = bv[i];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
                 result.insert(result.end(), layout.data.begin(), layout.data.end());
                 break;
@@ -1390,14 +1407,14 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                     static_cast<float>(position[2])
                 }};
 
-                layout.value.value = e.data[bvIdx];
-                layout.value.luminance = e.data[lumIdx];
-                layout.value.absoluteMagnitude = e.data[absMagIdx];
-                layout.value.apparentMagnitude = e.data[appMagIdx];
+                layout.value.value = bv[i];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
-                layout.value.vx = e.data[vxIdx];
-                layout.value.vy = e.data[vyIdx];
-                layout.value.vz = e.data[vzIdx];
+                layout.value.vx = vx[i];
+                layout.value.vy = vy[i];
+                layout.value.vz = vz[i];
 
                 result.insert(result.end(), layout.data.begin(), layout.data.end());
                 break;
@@ -1415,11 +1432,11 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                     static_cast<float>(position[2])
                 }};
 
-                layout.value.value = e.data[bvIdx];
-                layout.value.luminance = e.data[lumIdx];
-                layout.value.absoluteMagnitude = e.data[absMagIdx];
-                layout.value.apparentMagnitude = e.data[appMagIdx];
-                layout.value.speed = e.data[speedIdx];
+                layout.value.value = bv[i];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
+                layout.value.speed = speed[i];
 
                 result.insert(result.end(), layout.data.begin(), layout.data.end());
                 break;
@@ -1437,12 +1454,10 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                     static_cast<float>(position[2])
                 }};
 
-                int index = _otherDataOption.value();
-                // plus 3 because of the position
-                layout.value.value = e.data[index];
+                ghoul_assert(other, "Other data option must refer to a column");
+                layout.value.value = other[i];
 
-                if (_staticFilterValue.has_value() && e.data[index] == _staticFilterValue)
-                {
+                if (_staticFilterValue.has_value() && other[i] == _staticFilterValue) {
                     layout.value.value = _staticFilterReplacementValue;
                 }
 
@@ -1453,9 +1468,9 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                 _otherDataRange.setMinValue(glm::vec2(range.x));
                 _otherDataRange.setMaxValue(glm::vec2(range.y));
 
-                layout.value.luminance = e.data[lumIdx];
-                layout.value.absoluteMagnitude = e.data[absMagIdx];
-                layout.value.apparentMagnitude = e.data[appMagIdx];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
                 result.insert(result.end(), layout.data.begin(), layout.data.end());
                 break;
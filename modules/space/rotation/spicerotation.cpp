@@ -145,11 +145,15 @@ glm::dmat3 SpiceRotation::matrix(const UpdateData& data) const {
     if (_fixedEphemerisTime.has_value()) {
         time = *_fixedEphemerisTime;
     }
-    return SpiceManager::ref().positionTransformMatrix(
+    return SpiceManager::ref().cachedPositionTransformMatrix(
         _sourceFrame,
         _destinationFrame,
         time
     );
 }
 
+bool SpiceRotation::isThreadSafe() const {
+    return true;
+}
+
 } // namespace openspace
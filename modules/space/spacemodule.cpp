@@ -39,12 +39,16 @@
 #include <modules/space/translation/horizonstranslation.h>
 #include <modules/space/rotation/spicerotation.h>
 #include <openspace/documentation/documentation.h>
+#include <openspace/engine/globals.h>
+#include <openspace/engine/globalscallbacks.h>
 #include <openspace/rendering/renderable.h>
 #include <openspace/rendering/screenspacerenderable.h>
 #include <openspace/scripting/lualibrary.h>
 #include <openspace/util/factorymanager.h>
 #include <openspace/util/spicemanager.h>
+#include <openspace/util/timemanager.h>
 #include <ghoul/misc/assert.h>
+#include <ghoul/misc/profiling.h>
 #include <ghoul/misc/templatefactory.h>
 
 #include "spacemodule_lua.inl"
@@ -56,6 +60,28 @@ namespace {
         "If enabled, errors from SPICE will be thrown and show up in the log. If "
         "disabled, the errors will be ignored silently."
     };
+
+    constexpr openspace::properties::Property::PropertyInfo EphemerisCacheInfo = {
+        "UseEphemerisCache",
+        "Use Ephemeris Cache",
+        "If enabled, positions and rotations that are computed by SPICE are "
+        "interpolated from adaptively sampled values instead of being requested from "
+        "SPICE in every frame. Disabling this option will query SPICE directly."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PositionToleranceInfo = {
+        "EphemerisPositionTolerance",
+        "Ephemeris Position Tolerance (m)",
+        "The maximum error, in meters, that an interpolated position from the "
+        "ephemeris cache is allowed to have compared to the value computed by SPICE"
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo RotationToleranceInfo = {
+        "EphemerisRotationTolerance",
+        "Ephemeris Rotation Tolerance (rad)",
+        "The maximum angular error, in radians, that an interpolated rotation from the "
+        "ephemeris cache is allowed to have compared to the value computed by SPICE"
+    };
 } // namespace
 
 namespace openspace {
@@ -65,11 +91,34 @@ ghoul::opengl::ProgramObjectManager SpaceModule::ProgramObjectManager;
 SpaceModule::SpaceModule()
     : OpenSpaceModule(Name)
     , _showSpiceExceptions(SpiceExceptionInfo, true)
+    , _useEphemerisCache(EphemerisCacheInfo, true)
+    , _positionTolerance(PositionToleranceInfo, 1.0, 1e-6, 1e6)
+    , _rotationTolerance(RotationToleranceInfo, 1e-7, 1e-12, 1e-2)
 {
     _showSpiceExceptions.onChange([&t = _showSpiceExceptions](){
         SpiceManager::ref().setExceptionHandling(SpiceManager::UseException(t));
     });
     addProperty(_showSpiceExceptions);
+
+    _useEphemerisCache.onChange([this]() { updateEphemerisCacheSettings(); });
+    addProperty(_useEphemerisCache);
+
+    _positionTolerance.setExponent(10.f);
+    _positionTolerance.onChange([this]() { updateEphemerisCacheSettings(); });
+    addProperty(_positionTolerance);
+
+    _rotationTolerance.setExponent(10.f);
+    _rotationTolerance.onChange([this]() { updateEphemerisCacheSettings(); });
+    addProperty(_rotationTolerance);
+}
+
+void SpaceModule::updateEphemerisCacheSettings() {
+    SpiceManager::EphemerisCacheSettings settings;
+    settings.isEnabled = _useEphemerisCache;
+    // SPICE positions are in kilometers
+    settings.positionTolerance = _positionTolerance / 1000.0;
+    settings.rotationTolerance = _rotationTolerance;
+    SpiceManager::ref().setEphemerisCacheSettings(settings);
 }
 
 void SpaceModule::internalInitialize(const ghoul::Dictionary& dictionary) {
@@ -116,6 +165,20 @@ void SpaceModule::internalInitialize(const ghoul::Dictionary& dictionary) {
     if (dictionary.hasValue<bool>(SpiceExceptionInfo.identifier)) {
         _showSpiceExceptions = dictionary.value<bool>(SpiceExceptionInfo.identifier);
     }
+    if (dictionary.hasValue<bool>(EphemerisCacheInfo.identifier)) {
+        _useEphemerisCache = dictionary.value<bool>(EphemerisCacheInfo.identifier);
+    }
+    updateEphemerisCacheSettings();
+
+    // Evaluate the ephemerides that will be needed in the next few frames ahead of time
+    // so that the scene update is less likely to have to call into SPICE
+    global::callback::preSync->emplace_back([]() {
+        ZoneScopedN("SpaceModule::preSync")
+
+        const double time = global::timeManager->time().j2000Seconds();
+        const double previous = global::timeManager->integrateFromTime().j2000Seconds();
+        SpiceManager::ref().prefetchEphemerides(time, time - previous);
+    });
 }
 
 void SpaceModule::internalDeinitializeGL() {
@@ -28,6 +28,7 @@
 #include <openspace/util/openspacemodule.h>
 
 #include <openspace/properties/scalar/boolproperty.h>
+#include <openspace/properties/scalar/doubleproperty.h>
 #include <ghoul/opengl/programobjectmanager.h>
 
 namespace openspace {
@@ -48,7 +49,12 @@ private:
     void internalInitialize(const ghoul::Dictionary&) override;
     void internalDeinitializeGL() override;
 
+    void updateEphemerisCacheSettings();
+
     properties::BoolProperty _showSpiceExceptions;
+    properties::BoolProperty _useEphemerisCache;
+    properties::DoubleProperty _positionTolerance;
+    properties::DoubleProperty _rotationTolerance;
 };
 
 } // namespace openspace
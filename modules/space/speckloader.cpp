@@ -29,14 +29,32 @@
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
+#include <openspace/engine/globals.h>
+#include <openspace/util/taskscheduler.h>
 #include <ghoul/misc/assert.h>
+#include <ghoul/misc/profiling.h>
+#include <array>
 #include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <functional>
+#include <iterator>
 #include <string_view>
+#include <utility>
+
+#ifdef WIN32
+#include <windows.h>
+#else // ^^^^ WIN32 // !WIN32 vvvv
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
 
 namespace {
-    constexpr const int8_t DataCacheFileVersion = 10;
+    constexpr const int8_t DataCacheFileVersion = 12;
     constexpr const int8_t LabelCacheFileVersion = 10;
     constexpr const int8_t ColorCacheFileVersion = 10;
 
@@ -47,27 +65,166 @@ namespace {
         return (rhs.size() <= lhs.size()) && (lhs.substr(0, rhs.size()) == rhs);
     }
 
-    void strip(std::string& line) noexcept {
+    void strip(std::string_view& line) noexcept {
         // 1. Remove all spaces from the beginning
         // 2. Remove #
         // 3. Remove all spaces from the new beginning
         // 4. Remove all spaces from the end
 
         while (!line.empty() && (line[0] == ' ' || line[0] == '\t')) {
-            line = line.substr(1);
+            line.remove_prefix(1);
         }
 
         if (!line.empty() && line[0] == '#') {
-            line = line.substr(1);
+            line.remove_prefix(1);
         }
 
         while (!line.empty() && (line[0] == ' ' || line[0] == '\t')) {
-            line = line.substr(1);
+            line.remove_prefix(1);
         }
 
         while (!line.empty() && (line.back() == ' ' || line.back() == '\t')) {
-            line = line.substr(0, line.size() - 1);
+            line.remove_suffix(1);
+        }
+    }
+
+    void strip(std::string& line) noexcept {
+        std::string_view view = line;
+        strip(view);
+        line = std::string(view);
+    }
+
+    // Returns the line starting at \p pos and advances \p pos to the beginning of the
+    // next line. This splits the same way as std::getline does
+    std::string_view nextLine(std::string_view buffer, size_t& pos) {
+        const size_t end = buffer.find('\n', pos);
+        std::string_view line;
+        if (end == std::string_view::npos) {
+            line = buffer.substr(pos);
+            pos = buffer.size();
+        }
+        else {
+            line = buffer.substr(pos, end - pos);
+            pos = end + 1;
+        }
+        return line;
+    }
+
+    bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    // Reads a floating point value the same way that operator>> of a stream does:
+    // leading whitespace is skipped and reading stops at the first character that is not
+    // part of the number. In contrast to std::from_chars, a leading '+' is accepted,
+    // 'inf' or 'nan' and incomplete exponents are rejected, values that are too large
+    // are clamped to the largest float and too small values become 0. If no value could
+    // be read, \p value is 0 and \c false is returned
+    bool readFloat(const char*& ptr, const char* end, float& value) {
+        while (ptr != end && (*ptr == ' ' || (*ptr >= '\t' && *ptr <= '\r'))) {
+            ptr++;
+        }
+
+        const char* begin = ptr;
+        if (begin != end && *begin == '+') {
+            begin++;
+        }
+        const char* digits = (begin != end && *begin == '-') ? begin + 1 : begin;
+        if (digits == end || !(isDigit(*digits) || *digits == '.')) {
+            value = 0.f;
+            return false;
+        }
+
+        auto [next, ec] = std::from_chars(begin, end, value);
+        if (ec == std::errc::result_out_of_range) {
+            double v = 0.0;
+            const std::from_chars_result r = std::from_chars(begin, end, v);
+            next = r.ptr;
+            if (r.ec == std::errc() && std::abs(v) <= std::numeric_limits<float>::max())
+            {
+                value = static_cast<float>(v);
+            }
+            else {
+                const bool isNegative = *begin == '-';
+                value = isNegative ?
+                    -std::numeric_limits<float>::max() :
+                    std::numeric_limits<float>::max();
+                ptr = next;
+                return false;
+            }
         }
+        else if (ec != std::errc() ||
+                 (next != end && (*next == 'e' || *next == 'E')))
+        {
+            value = 0.f;
+            return false;
+        }
+        ptr = next;
+        return true;
+    }
+
+    // Size in bytes of the pieces of the data section that are parsed in parallel
+    constexpr const size_t SpeckParseChunkSize = 4 * 1024 * 1024;
+
+    // Parses a single line from the data section of a speck file and appends the result
+    // to \p entries. Returns false if the line is not a valid data line
+    bool parseDataLine(std::string_view line, int nDataValues,
+                       openspace::speck::SkipAllZeroLines skipAllZeroLines,
+                       std::vector<openspace::speck::Dataset::Entry>& entries)
+    {
+        using namespace openspace::speck;
+
+        // Ignore empty line or commented-out lines
+        if (line.empty() || line[0] == '#') {
+            return true;
+        }
+
+        // Guard against wrong line endings (copying files from Windows to Mac) causes
+        // lines to have a final \r
+        if (line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        strip(line);
+
+        if (line.empty()) {
+            return true;
+        }
+
+        if (!isDigit(line[0]) && line[0] != '-') {
+            return false;
+        }
+
+        const char* ptr = line.data();
+        const char* end = line.data() + line.size();
+
+        // Once a value could not be read, all remaining values stay 0 and the rest of
+        // the line is not used as a comment, which is how the previous stream-based
+        // parsing behaved
+        Dataset::Entry entry;
+        bool success = readFloat(ptr, end, entry.position.x);
+        success = success && readFloat(ptr, end, entry.position.y);
+        success = success && readFloat(ptr, end, entry.position.z);
+        bool allZero = (entry.position == glm::vec3(0.0));
+
+        entry.data.resize(nDataValues);
+        for (int i = 0; i < nDataValues; i += 1) {
+            success = success && readFloat(ptr, end, entry.data[i]);
+            allZero &= (entry.data[i] == 0.0);
+        }
+
+        if (skipAllZeroLines && allZero) {
+            return true;
+        }
+
+        if (success && ptr != end) {
+            std::string_view rest = std::string_view(ptr, end - ptr);
+            strip(rest);
+            entry.comment = std::string(rest);
+        }
+
+        entries.push_back(std::move(entry));
+        return true;
     }
 
     template <typename T, typename U>
@@ -77,6 +234,282 @@ namespace {
         }
     }
 
+    // The data cache file stores a dataset column by column so that it can be memory
+    // mapped and used without any parsing. The file starts with this header, followed by
+    // the variables and textures, the positions of all entries, one column per data
+    // value, and optionally a table of comment offsets, one byte per entry that is 1 if
+    // the entry has a comment, and the comment characters. The sections up to the comment
+    // offsets start at a multiple of DataCacheAlignment bytes
+    struct DataCacheHeader {
+        int8_t version = DataCacheFileVersion;
+        std::array<int8_t, 7> padding = {};
+        uint64_t fileSize = 0;
+        uint64_t nEntries = 0;
+        uint32_t nValues = 0;
+        uint32_t nVariables = 0;
+        uint32_t nTextures = 0;
+        int32_t textureDataIndex = -1;
+        int32_t orientationDataIndex = -1;
+        uint32_t padding2 = 0;
+        uint64_t metaDataOffset = 0;
+        uint64_t positionsOffset = 0;
+        uint64_t columnsOffset = 0;
+        // Both are 0 if none of the entries has a comment
+        uint64_t commentOffsetsOffset = 0;
+        uint64_t commentsOffset = 0;
+    };
+    static_assert(std::is_trivially_copyable_v<DataCacheHeader>);
+
+    constexpr const uint64_t DataCacheAlignment = 64;
+
+    // Number of values that are collected before they are passed on when writing a cache
+    constexpr const size_t DataCacheWriteBatchSize = 16384;
+
+    using WriteFunc = std::function<void(const void*, size_t)>;
+
+    using MappedStorage = std::unique_ptr<std::byte, std::function<void(std::byte*)>>;
+
+    uint64_t alignedOffset(uint64_t offset) {
+        const uint64_t a = DataCacheAlignment;
+        return (offset + a - 1) / a * a;
+    }
+
+    DataCacheHeader dataCacheLayout(const openspace::speck::Dataset& dataset) {
+        using namespace openspace::speck;
+
+        DataCacheHeader header;
+        header.nEntries = dataset.entries.size();
+        header.nValues = dataset.entries.empty() ?
+            0 :
+            static_cast<uint32_t>(dataset.entries.front().data.size());
+        header.nVariables = static_cast<uint32_t>(dataset.variables.size());
+        header.nTextures = static_cast<uint32_t>(dataset.textures.size());
+        header.textureDataIndex = dataset.textureDataIndex;
+        header.orientationDataIndex = dataset.orientationDataIndex;
+
+        uint64_t offset = alignedOffset(sizeof(DataCacheHeader));
+        header.metaDataOffset = offset;
+        for (const Dataset::Variable& var : dataset.variables) {
+            offset += 2 * sizeof(uint32_t) + var.name.size();
+        }
+        for (const Dataset::Texture& tex : dataset.textures) {
+            offset += 2 * sizeof(uint32_t) + tex.file.size();
+        }
+
+        offset = alignedOffset(offset);
+        header.positionsOffset = offset;
+        offset += header.nEntries * sizeof(glm::vec3);
+
+        offset = alignedOffset(offset);
+        header.columnsOffset = offset;
+        offset += header.nEntries * header.nValues * sizeof(float);
+
+        // An empty comment is stored as well so that it doesn't turn into no comment
+        bool hasComments = false;
+        uint64_t commentsSize = 0;
+        for (const Dataset::Entry& e : dataset.entries) {
+            hasComments |= e.comment.has_value();
+            commentsSize += e.comment.has_value() ? e.comment->size() : 0;
+        }
+        if (hasComments) {
+            offset = alignedOffset(offset);
+            header.commentOffsetsOffset = offset;
+            offset += (header.nEntries + 1) * sizeof(uint64_t);
+            offset += header.nEntries * sizeof(uint8_t);
+            header.commentsOffset = offset;
+            offset += commentsSize;
+        }
+
+        header.fileSize = offset;
+        return header;
+    }
+
+    void writeDataCache(const openspace::speck::Dataset& dataset, const WriteFunc& write)
+    {
+        using namespace openspace::speck;
+
+        for (const Dataset::Entry& e : dataset.entries) {
+            if (e.data.size() != dataset.entries.front().data.size()) {
+                throw ghoul::RuntimeError(
+                    "Error saving file: Entries have different number of data values"
+                );
+            }
+        }
+
+        const DataCacheHeader header = dataCacheLayout(dataset);
+
+        uint64_t written = 0;
+        auto writeBytes = [&write, &written](const void* data, size_t size) {
+            if (size > 0) {
+                write(data, size);
+                written += size;
+            }
+        };
+        auto padTo = [&writeBytes, &written](uint64_t offset) {
+            constexpr std::array<char, DataCacheAlignment> Zeros = {};
+            ghoul_assert(offset - written <= Zeros.size(), "Invalid padding");
+            writeBytes(Zeros.data(), offset - written);
+        };
+
+        writeBytes(&header, sizeof(DataCacheHeader));
+
+        //
+        // Store variables and textures
+        padTo(header.metaDataOffset);
+        for (const Dataset::Variable& var : dataset.variables) {
+            const int32_t idx = var.index;
+            writeBytes(&idx, sizeof(int32_t));
+            const uint32_t len = static_cast<uint32_t>(var.name.size());
+            writeBytes(&len, sizeof(uint32_t));
+            writeBytes(var.name.data(), len);
+        }
+        for (const Dataset::Texture& tex : dataset.textures) {
+            const int32_t idx = tex.index;
+            writeBytes(&idx, sizeof(int32_t));
+            const uint32_t len = static_cast<uint32_t>(tex.file.size());
+            writeBytes(&len, sizeof(uint32_t));
+            writeBytes(tex.file.data(), len);
+        }
+
+        //
+        // Store positions
+        padTo(header.positionsOffset);
+        std::vector<glm::vec3> positions;
+        positions.reserve(
+            std::min<size_t>(dataset.entries.size(), DataCacheWriteBatchSize)
+        );
+        for (const Dataset::Entry& e : dataset.entries) {
+            positions.push_back(e.position);
+            if (positions.size() == DataCacheWriteBatchSize) {
+                writeBytes(positions.data(), positions.size() * sizeof(glm::vec3));
+                positions.clear();
+            }
+        }
+        writeBytes(positions.data(), positions.size() * sizeof(glm::vec3));
+
+        //
+        // Store one column per data value
+        padTo(header.columnsOffset);
+        std::vector<float> values;
+        values.reserve(std::min<size_t>(dataset.entries.size(), DataCacheWriteBatchSize));
+        for (uint32_t i = 0; i < header.nValues; i += 1) {
+            for (const Dataset::Entry& e : dataset.entries) {
+                values.push_back(e.data[i]);
+                if (values.size() == DataCacheWriteBatchSize) {
+                    writeBytes(values.data(), values.size() * sizeof(float));
+                    values.clear();
+                }
+            }
+            writeBytes(values.data(), values.size() * sizeof(float));
+            values.clear();
+        }
+
+        //
+        // Store comments
+        if (header.commentOffsetsOffset != 0) {
+            padTo(header.commentOffsetsOffset);
+            uint64_t commentOffset = 0;
+            writeBytes(&commentOffset, sizeof(uint64_t));
+            for (const Dataset::Entry& e : dataset.entries) {
+                commentOffset += e.comment.has_value() ? e.comment->size() : 0;
+                writeBytes(&commentOffset, sizeof(uint64_t));
+            }
+            std::vector<uint8_t> hasComment;
+            hasComment.reserve(
+                std::min<size_t>(dataset.entries.size(), DataCacheWriteBatchSize)
+            );
+            for (const Dataset::Entry& e : dataset.entries) {
+                hasComment.push_back(e.comment.has_value() ? 1 : 0);
+                if (hasComment.size() == DataCacheWriteBatchSize) {
+                    writeBytes(hasComment.data(), hasComment.size());
+                    hasComment.clear();
+                }
+            }
+            writeBytes(hasComment.data(), hasComment.size());
+            for (const Dataset::Entry& e : dataset.entries) {
+                if (e.comment.has_value()) {
+                    writeBytes(e.comment->data(), e.comment->size());
+                }
+            }
+        }
+
+        ghoul_assert(written == header.fileSize, "Wrong file size calculation");
+    }
+
+    // Maps the file as copy-on-write so that the contents can be changed in memory
+    // without modifying the file on disk
+    std::pair<MappedStorage, size_t> mapFile(const std::filesystem::path& path) {
+#ifdef WIN32
+        HANDLE file = CreateFileW(
+            path.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr
+        );
+        if (file == INVALID_HANDLE_VALUE) {
+            return { nullptr, 0 };
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return { nullptr, 0 };
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) {
+            return { nullptr, 0 };
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        // The view keeps a reference to the mapping, so we can close our handle here
+        CloseHandle(mapping);
+        if (!data) {
+            return { nullptr, 0 };
+        }
+
+        const size_t size = static_cast<size_t>(fileSize.QuadPart);
+        return {
+            MappedStorage(
+                static_cast<std::byte*>(data),
+                [](std::byte* ptr) { UnmapViewOfFile(ptr); }
+            ),
+            size
+        };
+#else // ^^^^ WIN32 // !WIN32 vvvv
+        const int file = open(path.c_str(), O_RDONLY);
+        if (file == -1) {
+            return { nullptr, 0 };
+        }
+
+        struct stat fileStat;
+        if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+            close(file);
+            return { nullptr, 0 };
+        }
+
+        const size_t size = static_cast<size_t>(fileStat.st_size);
+        void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        // The mapping keeps a reference to the file, so we can close it here
+        close(file);
+        if (data == MAP_FAILED) {
+            return { nullptr, 0 };
+        }
+
+        return {
+            MappedStorage(
+                static_cast<std::byte*>(data),
+                [size](std::byte* ptr) { munmap(ptr, size); }
+            ),
+            size
+        };
+#endif // WIN32
+    }
+
     template <typename T>
     using LoadCacheFunc = std::function<std::optional<T>(std::filesystem::path)>;
 
@@ -135,20 +568,33 @@ namespace openspace::speck {
 namespace data {
 
 Dataset loadFile(std::filesystem::path path, SkipAllZeroLines skipAllZeroLines) {
+    ZoneScoped
+
     ghoul_assert(std::filesystem::exists(path), "File must exist");
 
-    std::ifstream file(path);
-    if (!file.good()) {
-        throw ghoul::RuntimeError(fmt::format("Failed to open speck file {}", path));
+    Dataset res;
+    if (std::filesystem::file_size(path) == 0) {
+        return res;
     }
 
-    Dataset res;
+    auto [storage, size] = mapFile(path);
+    if (!storage) {
+        throw ghoul::RuntimeError(fmt::format("Failed to open speck file {}", path));
+    }
+    const std::string_view buffer = std::string_view(
+        reinterpret_cast<const char*>(storage.get()),
+        size
+    );
 
     int nDataValues = 0;
 
-    std::string line;
     // First phase: Loading the header information
-    while (std::getline(file, line)) {
+    size_t dataBegin = buffer.size();
+    size_t pos = 0;
+    while (pos < buffer.size()) {
+        const size_t lineBegin = pos;
+        std::string line = std::string(nextLine(buffer, pos));
+
         // Ignore empty line or commented-out lines
         if (line.empty() || line[0] == '#') {
             continue;
@@ -164,7 +610,8 @@ Dataset loadFile(std::filesystem::path path, SkipAllZeroLines skipAllZeroLines)
 
         // If the first character is a digit, we have left the preamble and are in the
         // data section of the file
-        if (std::isdigit(line[0]) || line[0] == '-') {
+        if (isDigit(line[0]) || line[0] == '-') {
+            dataBegin = lineBegin;
             break;
         }
 
@@ -276,64 +723,64 @@ Dataset loadFile(std::filesystem::path path, SkipAllZeroLines skipAllZeroLines)
         }
     );
 
-    // For the first line, we already loaded it and rejected it above, so if we do another
-    // std::getline, we'd miss the first data value line
-    bool isFirst = true;
-    while (isFirst || std::getline(file, line)) {
-        isFirst = false;
-
-        // Ignore empty line or commented-out lines
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
+    // Second phase: Split the data section into chunks that start at line boundaries
+    // and parse them in parallel. The chunks are merged in order afterwards so that the
+    // result is the same as parsing the file line by line
+    std::vector<size_t> chunkBegins;
+    for (size_t b = dataBegin; b < buffer.size();) {
+        chunkBegins.push_back(b);
+        if (buffer.size() - b <= SpeckParseChunkSize) {
+            break;
         }
+        const size_t lineEnd = buffer.find('\n', b + SpeckParseChunkSize);
+        b = (lineEnd == std::string_view::npos) ? buffer.size() : lineEnd + 1;
+    }
+    chunkBegins.push_back(buffer.size());
 
-        strip(line);
+    const size_t nChunks = chunkBegins.size() - 1;
+    std::vector<std::vector<Dataset::Entry>> chunks(nChunks);
+    std::vector<char> chunkIsValid(nChunks, 1);
+    auto parseChunk = [&](size_t i) {
+        ZoneScopedN("Parse chunk")
 
-        if (line.empty()) {
-            continue;
+        const std::string_view chunk = buffer.substr(
+            chunkBegins[i],
+            chunkBegins[i + 1] - chunkBegins[i]
+        );
+        size_t p = 0;
+        while (p < chunk.size()) {
+            const std::string_view line = nextLine(chunk, p);
+            if (!parseDataLine(line, nDataValues, skipAllZeroLines, chunks[i])) {
+                chunkIsValid[i] = 0;
+                return;
+            }
+        }
+    };
+    if (global::taskScheduler && nChunks > 1) {
+        global::taskScheduler->parallelFor(0, nChunks, 1, parseChunk);
+    }
+    else {
+        for (size_t i = 0; i < nChunks; i += 1) {
+            parseChunk(i);
         }
+    }
 
-        // If the first character is a digit, we have left the preamble and are in the
-        // data section of the file
-        if (!std::isdigit(line[0]) && line[0] != '-') {
+    size_t nEntries = 0;
+    for (size_t i = 0; i < nChunks; i += 1) {
+        // A chunk is invalid if one of its lines does not start with a number
+        if (!chunkIsValid[i]) {
             throw ghoul::RuntimeError(fmt::format(
                 "Error loading speck file {}: Header information and datasegment "
                 "intermixed", path
             ));
         }
+        nEntries += chunks[i].size();
+    }
 
-        bool allZero = true;
-
-        std::stringstream str(line);
-        Dataset::Entry entry;
-        str >> entry.position.x >> entry.position.y >> entry.position.z;
-        allZero &= (entry.position == glm::vec3(0.0));
-
-        entry.data.resize(nDataValues);
-        for (int i = 0; i < nDataValues; i += 1) {
-            str >> entry.data[i];
-            allZero &= (entry.data[i] == 0.0);
-        }
-
-        if (skipAllZeroLines && allZero) {
-            continue;
-        }
-
-        std::string rest;
-        std::getline(str, rest);
-        if (!rest.empty()) {
-
-            strip(rest);
-            entry.comment = rest;
-        }
-
-        res.entries.push_back(std::move(entry));
+    res.entries.reserve(nEntries);
+    for (std::vector<Dataset::Entry>& chunk : chunks) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(res.entries));
+        chunk = std::vector<Dataset::Entry>();
     }
 
 #ifdef _DEBUG
@@ -353,178 +800,21 @@ Dataset loadFile(std::filesystem::path path, SkipAllZeroLines skipAllZeroLines)
 }
 
 std::optional<Dataset> loadCachedFile(std::filesystem::path path) {
-    std::ifstream file(path, std::ios::binary);
-    if (!file.good()) {
-        return std::nullopt;
-    }
-
-    Dataset result;
-
-    int8_t fileVersion;
-    file.read(reinterpret_cast<char*>(&fileVersion), sizeof(int8_t));
-    if (fileVersion != DataCacheFileVersion) {
-        // Incompatible version and we won't be able to read the file
+    std::optional<ColumnarDataset> dataset = loadColumnarCachedFile(path);
+    if (!dataset.has_value()) {
         return std::nullopt;
     }
-
-    //
-    // Read variables
-    uint16_t nVariables;
-    file.read(reinterpret_cast<char*>(&nVariables), sizeof(uint16_t));
-    result.variables.resize(nVariables);
-    for (int i = 0; i < nVariables; i += 1) {
-        Dataset::Variable var;
-
-        int16_t idx;
-        file.read(reinterpret_cast<char*>(&idx), sizeof(int16_t));
-        var.index = idx;
-
-        uint16_t len;
-        file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
-        var.name.resize(len);
-        file.read(var.name.data(), len);
-
-        result.variables[i] = std::move(var);
-    }
-
-    //
-    // Read textures
-    uint16_t nTextures;
-    file.read(reinterpret_cast<char*>(&nTextures), sizeof(uint16_t));
-    result.textures.resize(nTextures);
-    for (int i = 0; i < nTextures; i += 1) {
-        Dataset::Texture tex;
-
-        int16_t idx;
-        file.read(reinterpret_cast<char*>(&idx), sizeof(int16_t));
-        tex.index = idx;
-
-        uint16_t len;
-        file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
-        tex.file.resize(len);
-        file.read(tex.file.data(), len);
-
-        result.textures[i] = std::move(tex);
-    }
-
-    //
-    // Read indices
-    int16_t texDataIdx;
-    file.read(reinterpret_cast<char*>(&texDataIdx), sizeof(int16_t));
-    result.textureDataIndex = texDataIdx;
-
-    int16_t oriDataIdx;
-    file.read(reinterpret_cast<char*>(&oriDataIdx), sizeof(int16_t));
-    result.orientationDataIndex = oriDataIdx;
-
-    //
-    // Read entries
-    uint64_t nEntries;
-    file.read(reinterpret_cast<char*>(&nEntries), sizeof(uint64_t));
-    result.entries.reserve(nEntries);
-    for (uint64_t i = 0; i < nEntries; i += 1) {
-        Dataset::Entry e;
-        file.read(reinterpret_cast<char*>(&e.position.x), sizeof(float));
-        file.read(reinterpret_cast<char*>(&e.position.y), sizeof(float));
-        file.read(reinterpret_cast<char*>(&e.position.z), sizeof(float));
-
-        uint16_t nValues;
-        file.read(reinterpret_cast<char*>(&nValues), sizeof(uint16_t));
-        e.data.resize(nValues);
-        file.read(reinterpret_cast<char*>(e.data.data()), nValues * sizeof(float));
-
-        uint16_t len;
-        file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
-        if (len > 0) {
-            std::string comment;
-            comment.resize(len);
-            file.read(comment.data(), len);
-            e.comment = std::move(comment);
-        }
-
-        result.entries.push_back(std::move(e));
-    }
-
-    return result;
+    return dataset->toDataset();
 }
 
 void saveCachedFile(const Dataset& dataset, std::filesystem::path path) {
     std::ofstream file(path, std::ofstream::binary);
-
-    file.write(reinterpret_cast<const char*>(&DataCacheFileVersion), sizeof(int8_t));
-
-    //
-    // Store variables
-    checkSize<uint16_t>(dataset.variables.size(), "Too many variables");
-    uint16_t nVariables = static_cast<uint16_t>(dataset.variables.size());
-    file.write(reinterpret_cast<const char*>(&nVariables), sizeof(uint16_t));
-    for (const Dataset::Variable& var : dataset.variables) {
-        checkSize<int16_t>(var.index, "Variable index too large");
-        int16_t idx = static_cast<int16_t>(var.index);
-        file.write(reinterpret_cast<const char*>(&idx), sizeof(int16_t));
-
-        checkSize<uint16_t>(var.name.size(), "Variable name too long");
-        uint16_t len = static_cast<uint16_t>(var.name.size());
-        file.write(reinterpret_cast<const char*>(&len), sizeof(uint16_t));
-        file.write(var.name.data(), len);
-    }
-
-    //
-    // Store textures
-    checkSize<uint16_t>(dataset.textures.size(), "Too many textures");
-    uint16_t nTextures = static_cast<uint16_t>(dataset.textures.size());
-    file.write(reinterpret_cast<const char*>(&nTextures), sizeof(uint16_t));
-    for (const Dataset::Texture& tex : dataset.textures) {
-        checkSize<int16_t>(tex.index, "Texture index too large");
-        int16_t idx = static_cast<int16_t>(tex.index);
-        file.write(reinterpret_cast<const char*>(&idx), sizeof(int16_t));
-
-
-        checkSize<uint16_t>(tex.file.size(), "Texture file too long");
-        uint16_t len = static_cast<uint16_t>(tex.file.size());
-        file.write(reinterpret_cast<const char*>(&len), sizeof(uint16_t));
-        file.write(tex.file.data(), len);
-    }
-
-    //
-    // Store indices
-    checkSize<int16_t>(dataset.textureDataIndex, "Texture index too large");
-    int16_t texIdx = static_cast<int16_t>(dataset.textureDataIndex);
-    file.write(reinterpret_cast<const char*>(&texIdx), sizeof(int16_t));
-
-    checkSize<int16_t>(dataset.orientationDataIndex, "Orientation index too large");
-    int16_t orientationIdx = static_cast<int16_t>(dataset.orientationDataIndex);
-    file.write(reinterpret_cast<const char*>(&orientationIdx), sizeof(int16_t));
-
-    //
-    // Store entries
-    checkSize<uint64_t>(dataset.entries.size(), "Too many entries");
-    uint64_t nEntries = static_cast<uint64_t>(dataset.entries.size());
-    file.write(reinterpret_cast<const char*>(&nEntries), sizeof(uint64_t));
-    for (const Dataset::Entry& e : dataset.entries) {
-        file.write(reinterpret_cast<const char*>(&e.position.x), sizeof(float));
-        file.write(reinterpret_cast<const char*>(&e.position.y), sizeof(float));
-        file.write(reinterpret_cast<const char*>(&e.position.z), sizeof(float));
-
-        checkSize<uint16_t>(e.data.size(), "Too many data variables");
-        uint16_t nValues = static_cast<uint16_t>(e.data.size());
-        file.write(reinterpret_cast<const char*>(&nValues), sizeof(uint16_t));
-        file.write(
-            reinterpret_cast<const char*>(e.data.data()),
-            e.data.size() * sizeof(float)
-        );
-
-        if (e.comment.has_value()) {
-            checkSize<uint16_t>(e.comment->size(), "Comment too long");
-        }
-        uint16_t commentLen = e.comment.has_value() ?
-            static_cast<uint16_t>(e.comment->size()) :
-            0;
-        file.write(reinterpret_cast<const char*>(&commentLen), sizeof(uint16_t));
-        if (e.comment.has_value()) {
-            file.write(e.comment->data(), e.comment->size());
+    writeDataCache(
+        dataset,
+        [&file](const void* data, size_t size) {
+            file.write(reinterpret_cast<const char*>(data), size);
         }
-    }
+    );
 }
 
 Dataset loadFileWithCache(std::filesystem::path speckPath,
@@ -539,6 +829,50 @@ Dataset loadFileWithCache(std::filesystem::path speckPath,
     );
 }
 
+std::optional<ColumnarDataset> loadColumnarCachedFile(std::filesystem::path path) {
+    auto [storage, size] = mapFile(path);
+    if (!storage) {
+        return std::nullopt;
+    }
+    return ColumnarDataset::fromStorage(std::move(storage), size);
+}
+
+ColumnarDataset loadColumnarFileWithCache(std::filesystem::path speckPath,
+                                          SkipAllZeroLines skipAllZeroLines)
+{
+    std::filesystem::path cached = FileSys.cacheManager()->cachedFilename(speckPath);
+
+    if (std::filesystem::exists(cached)) {
+        LINFOC(
+            "SpeckLoader",
+            fmt::format("Cached file {} used for file {}", cached, speckPath)
+        );
+
+        std::optional<ColumnarDataset> dataset = loadColumnarCachedFile(cached);
+        if (dataset.has_value()) {
+            return std::move(*dataset);
+        }
+        else {
+            FileSys.cacheManager()->removeCacheFile(cached);
+        }
+    }
+    LINFOC("SpeckLoader", fmt::format("Loading file {}", speckPath));
+    Dataset dataset = loadFile(speckPath, skipAllZeroLines);
+
+    if (!dataset.entries.empty()) {
+        LINFOC("SpeckLoader", "Saving cache");
+        saveCachedFile(dataset, cached);
+
+        // Use the file we just wrote so that the memory of the parsed dataset can be
+        // released and only the pages that are actually used are loaded
+        std::optional<ColumnarDataset> res = loadColumnarCachedFile(cached);
+        if (res.has_value()) {
+            return std::move(*res);
+        }
+    }
+    return ColumnarDataset::fromDataset(dataset);
+}
+
 } // namespace data
 
 namespace label {
@@ -903,4 +1237,281 @@ bool Dataset::normalizeVariable(std::string_view variableName) {
     return true;
 }
 
+ColumnarDataset ColumnarDataset::fromDataset(const Dataset& dataset) {
+    const DataCacheHeader header = dataCacheLayout(dataset);
+    Storage storage = Storage(
+        new std::byte[header.fileSize],
+        [](std::byte* ptr) { delete[] ptr; }
+    );
+
+    std::byte* ptr = storage.get();
+    writeDataCache(
+        dataset,
+        [&ptr](const void* data, size_t size) {
+            std::memcpy(ptr, data, size);
+            ptr += size;
+        }
+    );
+
+    std::optional<ColumnarDataset> res = fromStorage(std::move(storage), header.fileSize);
+    ghoul_assert(res.has_value(), "Error creating columnar dataset");
+    return std::move(*res);
+}
+
+std::optional<ColumnarDataset> ColumnarDataset::fromStorage(Storage storage, size_t size)
+{
+    if (size < sizeof(DataCacheHeader)) {
+        return std::nullopt;
+    }
+
+    DataCacheHeader header;
+    std::memcpy(&header, storage.get(), sizeof(DataCacheHeader));
+    if (header.version != DataCacheFileVersion) {
+        // Incompatible version and we won't be able to read the file
+        return std::nullopt;
+    }
+
+    // Verify that all sections lie inside the file before we hand out any pointers into
+    // it. Every section is compared against the remaining bytes of the file instead of
+    // computing the section end to prevent overflows for corrupted headers
+    if (header.fileSize != size || header.metaDataOffset > header.positionsOffset ||
+        header.positionsOffset > header.columnsOffset || header.columnsOffset > size)
+    {
+        return std::nullopt;
+    }
+    // The positions and columns are accessed in place, which requires them to be aligned
+    if (header.positionsOffset % alignof(glm::vec3) != 0 ||
+        header.columnsOffset % alignof(float) != 0)
+    {
+        return std::nullopt;
+    }
+    const uint64_t positionsSpace = header.columnsOffset - header.positionsOffset;
+    if (header.nEntries > positionsSpace / sizeof(glm::vec3)) {
+        return std::nullopt;
+    }
+    const uint64_t columnsSpace = size - header.columnsOffset;
+    if (header.nValues > 0 &&
+        header.nEntries > columnsSpace / sizeof(float) / header.nValues)
+    {
+        return std::nullopt;
+    }
+
+    // The comment offsets have to follow the column data, followed directly by the flags
+    // of which entries have a comment and the comment characters up to the end of the
+    // file
+    const bool hasComments = header.commentOffsetsOffset != 0;
+    if (hasComments) {
+        const uint64_t columnsEnd =
+            header.columnsOffset + header.nEntries * header.nValues * sizeof(float);
+        if (header.commentOffsetsOffset < columnsEnd ||
+            header.commentOffsetsOffset % alignof(uint64_t) != 0 ||
+            header.commentOffsetsOffset > size ||
+            header.nEntries + 1 >
+                (size - header.commentOffsetsOffset) / sizeof(uint64_t) ||
+            header.commentsOffset > size ||
+            header.commentOffsetsOffset + (header.nEntries + 1) * sizeof(uint64_t) +
+                header.nEntries * sizeof(uint8_t) != header.commentsOffset)
+        {
+            return std::nullopt;
+        }
+    }
+
+    ColumnarDataset res;
+    res.textureDataIndex = header.textureDataIndex;
+    res.orientationDataIndex = header.orientationDataIndex;
+
+    //
+    // Read variables and textures
+    const std::byte* meta = storage.get() + header.metaDataOffset;
+    const std::byte* metaEnd = storage.get() + header.positionsOffset;
+    auto readMeta = [&meta, metaEnd]() -> std::optional<std::pair<int, std::string>> {
+        if (metaEnd - meta < static_cast<ptrdiff_t>(2 * sizeof(uint32_t))) {
+            return std::nullopt;
+        }
+        int32_t idx;
+        std::memcpy(&idx, meta, sizeof(int32_t));
+        uint32_t len;
+        std::memcpy(&len, meta + sizeof(int32_t), sizeof(uint32_t));
+        meta += 2 * sizeof(uint32_t);
+        if (metaEnd - meta < static_cast<ptrdiff_t>(len)) {
+            return std::nullopt;
+        }
+        std::string str = std::string(reinterpret_cast<const char*>(meta), len);
+        meta += len;
+        return std::make_pair(idx, std::move(str));
+    };
+
+    res.variables.reserve(header.nVariables);
+    for (uint32_t i = 0; i < header.nVariables; i += 1) {
+        std::optional<std::pair<int, std::string>> v = readMeta();
+        if (!v.has_value()) {
+            return std::nullopt;
+        }
+        res.variables.push_back({ v->first, std::move(v->second) });
+    }
+    res.textures.reserve(header.nTextures);
+    for (uint32_t i = 0; i < header.nTextures; i += 1) {
+        std::optional<std::pair<int, std::string>> t = readMeta();
+        if (!t.has_value()) {
+            return std::nullopt;
+        }
+        res.textures.push_back({ t->first, std::move(t->second) });
+    }
+
+    //
+    // Bind the columns
+    res._nEntries = header.nEntries;
+    res._nValues = header.nValues;
+    res._positions = reinterpret_cast<glm::vec3*>(
+        storage.get() + header.positionsOffset
+    );
+    res._columns = reinterpret_cast<float*>(storage.get() + header.columnsOffset);
+    if (hasComments) {
+        res._commentOffsets = reinterpret_cast<const uint64_t*>(
+            storage.get() + header.commentOffsetsOffset
+        );
+        res._hasComment = reinterpret_cast<const uint8_t*>(
+            res._commentOffsets + header.nEntries + 1
+        );
+        res._comments = reinterpret_cast<const char*>(
+            storage.get() + header.commentsOffset
+        );
+
+        // Each comment has to lie inside the comment characters, which is the case if
+        // the offsets start at 0, never decrease, and end at the end of the file. Entries
+        // without a comment must not have any characters
+        if (res._commentOffsets[0] != 0 ||
+            res._commentOffsets[header.nEntries] != size - header.commentsOffset)
+        {
+            return std::nullopt;
+        }
+        for (uint64_t i = 0; i < header.nEntries; i += 1) {
+            if (res._commentOffsets[i] > res._commentOffsets[i + 1] ||
+                res._hasComment[i] > 1 ||
+                (res._hasComment[i] == 0 &&
+                 res._commentOffsets[i] != res._commentOffsets[i + 1]))
+            {
+                return std::nullopt;
+            }
+        }
+    }
+    res._storage = std::move(storage);
+    return res;
+}
+
+ColumnarDataset::ColumnarDataset(ColumnarDataset&& other) noexcept {
+    *this = std::move(other);
+}
+
+ColumnarDataset& ColumnarDataset::operator=(ColumnarDataset&& other) noexcept {
+    variables = std::move(other.variables);
+    textures = std::move(other.textures);
+    textureDataIndex = std::exchange(other.textureDataIndex, -1);
+    orientationDataIndex = std::exchange(other.orientationDataIndex, -1);
+    _storage = std::move(other._storage);
+    _nEntries = std::exchange(other._nEntries, 0);
+    _nValues = std::exchange(other._nValues, 0);
+    _positions = std::exchange(other._positions, nullptr);
+    _columns = std::exchange(other._columns, nullptr);
+    _commentOffsets = std::exchange(other._commentOffsets, nullptr);
+    _hasComment = std::exchange(other._hasComment, nullptr);
+    _comments = std::exchange(other._comments, nullptr);
+    return *this;
+}
+
+Dataset ColumnarDataset::toDataset() const {
+    Dataset res;
+    res.variables = variables;
+    res.textures = textures;
+    res.textureDataIndex = textureDataIndex;
+    res.orientationDataIndex = orientationDataIndex;
+
+    res.entries.resize(_nEntries);
+    for (size_t i = 0; i < _nEntries; i += 1) {
+        Dataset::Entry& e = res.entries[i];
+        e.position = _positions[i];
+        e.data.resize(_nValues);
+        for (size_t j = 0; j < _nValues; j += 1) {
+            e.data[j] = _columns[j * _nEntries + i];
+        }
+        if (hasComment(i)) {
+            e.comment = std::string(comment(i));
+        }
+    }
+    return res;
+}
+
+size_t ColumnarDataset::nEntries() const {
+    return _nEntries;
+}
+
+size_t ColumnarDataset::nValues() const {
+    return _nValues;
+}
+
+const glm::vec3* ColumnarDataset::positions() const {
+    return _positions;
+}
+
+const float* ColumnarDataset::column(int index) const {
+    if (index < 0 || static_cast<size_t>(index) >= _nValues) {
+        return nullptr;
+    }
+    return _columns + static_cast<size_t>(index) * _nEntries;
+}
+
+float* ColumnarDataset::column(int index) {
+    if (index < 0 || static_cast<size_t>(index) >= _nValues) {
+        return nullptr;
+    }
+    return _columns + static_cast<size_t>(index) * _nEntries;
+}
+
+bool ColumnarDataset::hasComment(size_t entry) const {
+    ghoul_assert(entry < _nEntries, "Entry out of range");
+    return _hasComment && _hasComment[entry] != 0;
+}
+
+std::string_view ColumnarDataset::comment(size_t entry) const {
+    ghoul_assert(entry < _nEntries, "Entry out of range");
+    if (!_commentOffsets) {
+        return std::string_view();
+    }
+
+    // The offsets were validated when the dataset was created
+    const uint64_t begin = _commentOffsets[entry];
+    const uint64_t end = _commentOffsets[entry + 1];
+    return std::string_view(_comments + begin, end - begin);
+}
+
+int ColumnarDataset::index(std::string_view variableName) const {
+    for (const Dataset::Variable& v : variables) {
+        if (v.name == variableName) {
+            return v.index;
+        }
+    }
+    return -1;
+}
+
+bool ColumnarDataset::normalizeVariable(std::string_view variableName) {
+    float* values = column(index(variableName));
+    if (!values) {
+        // We didn't find the variable that was specified
+        return false;
+    }
+
+    float minValue = std::numeric_limits<float>::max();
+    float maxValue = -std::numeric_limits<float>::max();
+    for (size_t i = 0; i < _nEntries; i += 1) {
+        minValue = std::min(minValue, values[i]);
+        maxValue = std::max(maxValue, values[i]);
+    }
+
+    for (size_t i = 0; i < _nEntries; i += 1) {
+        values[i] = (values[i] - minValue) / (maxValue - minValue);
+    }
+
+    return true;
+}
+
 } // namespace openspace::speck
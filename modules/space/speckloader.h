@@ -28,8 +28,11 @@
 #include <ghoul/glm.h>
 #include <ghoul/misc/boolean.h>
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace openspace::speck {
@@ -63,6 +66,92 @@ struct Dataset {
     bool normalizeVariable(std::string_view variableName);
 };
 
+class ColumnarDataset;
+
+namespace data {
+    std::optional<ColumnarDataset> loadColumnarCachedFile(std::filesystem::path path);
+} // namespace data
+
+/**
+ * A dataset whose values are stored as columns rather than as one entry per row. All
+ * positions are stored contiguously, followed by one contiguous column per data value,
+ * and the comments in a string table. The storage is a single block of memory that is
+ * either a copy-on-write memory mapping of a cache file or, if no cache file could be
+ * used, an in-memory copy with the same layout. Modifications, for example through
+ * #normalizeVariable, are never written back to the cache file.
+ */
+class ColumnarDataset {
+public:
+    ColumnarDataset() = default;
+    ColumnarDataset(ColumnarDataset&& other) noexcept;
+    ColumnarDataset& operator=(ColumnarDataset&& other) noexcept;
+
+    /**
+     * Creates a columnar copy of the provided \p dataset.
+     */
+    static ColumnarDataset fromDataset(const Dataset& dataset);
+
+    /**
+     * Converts this columnar dataset back into a Dataset with one Entry per row.
+     */
+    Dataset toDataset() const;
+
+    /// Returns the number of entries, that is the length of every column
+    size_t nEntries() const;
+
+    /// Returns the number of data values per entry, that is the number of columns
+    size_t nValues() const;
+
+    /// Returns a pointer to the #nEntries positions of this dataset
+    const glm::vec3* positions() const;
+
+    /**
+     * Returns a pointer to the #nEntries values of the data value with the provided
+     * \p index or \c nullptr if the \p index does not refer to a data value.
+     */
+    const float* column(int index) const;
+    float* column(int index);
+
+    /// Returns whether the entry at \p entry has a comment, which might be empty
+    bool hasComment(size_t entry) const;
+
+    /**
+     * Returns the comment of the entry at \p entry or an empty string if the entry does
+     * not have a comment.
+     */
+    std::string_view comment(size_t entry) const;
+
+    int index(std::string_view variableName) const;
+    bool normalizeVariable(std::string_view variableName);
+
+    std::vector<Dataset::Variable> variables;
+    std::vector<Dataset::Texture> textures;
+    int textureDataIndex = -1;
+    int orientationDataIndex = -1;
+
+private:
+    using Storage = std::unique_ptr<std::byte, std::function<void(std::byte*)>>;
+
+    friend std::optional<ColumnarDataset> data::loadColumnarCachedFile(
+        std::filesystem::path path);
+
+    /**
+     * Creates a ColumnarDataset that takes ownership of the \p storage, which contains
+     * \p size bytes in the cache file layout. Returns \c std::nullopt if the storage
+     * does not contain a valid columnar dataset.
+     */
+    static std::optional<ColumnarDataset> fromStorage(Storage storage, size_t size);
+
+    Storage _storage;
+    size_t _nEntries = 0;
+    size_t _nValues = 0;
+    glm::vec3* _positions = nullptr;
+    float* _columns = nullptr;
+    const uint64_t* _commentOffsets = nullptr;
+    const uint8_t* _hasComment = nullptr;
+    const char* _comments = nullptr;
+};
+
 struct Labelset {
     int textColorIndex = -1;
 
@@ -88,6 +177,21 @@ namespace data {
     Dataset loadFileWithCache(std::filesystem::path speckPath,
         SkipAllZeroLines skipAllZeroLines = SkipAllZeroLines::Yes);
 
+    /**
+     * Memory maps the cache file at \p path without parsing any of the entries. Returns
+     * \c std::nullopt if the file does not exist, has a different version, or is
+     * truncated.
+     */
+    std::optional<ColumnarDataset> loadColumnarCachedFile(std::filesystem::path path);
+
+    /**
+     * Loads the speck file at \p speckPath as a ColumnarDataset. If a cache file exists,
+     * it is memory mapped directly, otherwise the speck file is parsed and the cache
+     * file is created first.
+     */
+    ColumnarDataset loadColumnarFileWithCache(std::filesystem::path speckPath,
+        SkipAllZeroLines skipAllZeroLines = SkipAllZeroLines::Yes);
+
 } // namespace data
 
 namespace label {
@@ -276,4 +276,9 @@ void HorizonsTranslation::saveCachedFile(const std::filesystem::path& file) cons
         );
     }
 }
+
+bool HorizonsTranslation::isThreadSafe() const {
+    return true;
+}
+
 } // namespace openspace
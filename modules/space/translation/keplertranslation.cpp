@@ -364,4 +364,8 @@ void KeplerTranslation::setKeplerElements(double eccentricity, double semiMajorA
     computeOrbitPlane();
 }
 
+bool KeplerTranslation::isThreadSafe() const {
+    return true;
+}
+
 } // namespace openspace
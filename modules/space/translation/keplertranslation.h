@@ -70,6 +70,14 @@ public:
     */
     glm::dvec3 position(const UpdateData& data) const override;
 
+    /**
+     * The position only depends on the Keplerian elements of this translation, so it can
+     * be computed concurrently to other scene graph nodes.
+     *
+     * \return Always \c true
+     */
+    bool isThreadSafe() const override;
+
     /**
      * Method returning the openspace::Documentation that describes the ghoul::Dictinoary
      * that can be passed to the constructor.
@@ -170,20 +170,21 @@ SpiceTranslation::SpiceTranslation(const ghoul::Dictionary& dictionary)
 }
 
 glm::dvec3 SpiceTranslation::position(const UpdateData& data) const {
-    double lightTime = 0.0;
-
     double time = data.time.j2000Seconds();
     if (_fixedEphemerisTime.has_value()) {
         time = *_fixedEphemerisTime;
     }
-    return SpiceManager::ref().targetPosition(
+    return SpiceManager::ref().cachedTargetPosition(
         _cachedTarget,
         _cachedObserver,
         _cachedFrame,
-        {},
-        time,
-        lightTime
+        time
     ) * 1000.0;
 }
 
+bool SpiceTranslation::isThreadSafe() const {
+    // The SpiceManager serializes all calls into SPICE made by the cached lookups
+    return true;
+}
+
 } // namespace openspace
@@ -53,6 +53,7 @@
 #include <openspace/scripting/scriptengine.h>
 #include <openspace/scripting/scriptscheduler.h>
 #include <openspace/util/memorymanager.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/util/timemanager.h>
 #include <openspace/util/versionchecker.h>
 #include <ghoul/misc/assert.h>
@@ -72,6 +73,7 @@ namespace {
     // in some random global randoms
 #ifdef WIN32
     constexpr const int TotalSize =
+        sizeof(TaskScheduler) +
         sizeof(MemoryManager) +
         sizeof(EventEngine) +
         sizeof(ghoul::fontrendering::FontManager) +
@@ -121,6 +123,14 @@ void create() {
     std::byte* currentPos = DataStorage.data();
 #endif // WIN32
 
+#ifdef WIN32
+    taskScheduler = new (currentPos) TaskScheduler;
+    ghoul_assert(taskScheduler, "No taskScheduler");
+    currentPos += sizeof(TaskScheduler);
+#else // ^^^ WIN32 / !WIN32 vvv
+    taskScheduler = new TaskScheduler;
+#endif // WIN32
+
 #ifdef WIN32
     memoryManager = new (currentPos) MemoryManager;
     ghoul_assert(memoryManager, "No memoryManager");
@@ -399,6 +409,7 @@ void initialize() {
     rootPropertyOwner->addPropertySubOwner(global::parallelPeer);
     rootPropertyOwner->addPropertySubOwner(global::luaConsole);
     rootPropertyOwner->addPropertySubOwner(global::dashboard);
+    rootPropertyOwner->addPropertySubOwner(global::memoryManager);
 
     syncEngine->addSyncable(global::scriptEngine);
 }
@@ -633,6 +644,13 @@ void destroy() {
     delete memoryManager;
 #endif // WIN32
 
+    LDEBUGC("Globals", "Destroying 'TaskScheduler'");
+#ifdef WIN32
+    taskScheduler->~TaskScheduler();
+#else // ^^^ WIN32 / !WIN32 vvv
+    delete taskScheduler;
+#endif // WIN32
+
     callback::destroy();
 }
 
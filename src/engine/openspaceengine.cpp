@@ -87,10 +87,12 @@
 #include <ghoul/systemcapabilities/openglcapabilitiescomponent.h>
 #include <glbinding/glbinding.h>
 #include <glbinding-aux/types_to_string.h>
+#include <chrono>
 #include <filesystem>
 #include <future>
 #include <numeric>
 #include <sstream>
+#include <thread>
 
 #ifdef __APPLE__
 #include <openspace/interaction/touchbar.h>
@@ -754,12 +756,18 @@ void OpenSpaceEngine::loadAssets() {
         _assetManager->add(a);
     }
 
-    _loadingScreen->setPhase(LoadingScreen::Phase::Construction);
-    _loadingScreen->postMessage("Loading assets");
+    // There is no loading screen if we are running without a window
+    const bool hasLoadingScreen = (_loadingScreen != nullptr);
+    if (hasLoadingScreen) {
+        _loadingScreen->setPhase(LoadingScreen::Phase::Construction);
+        _loadingScreen->postMessage("Loading assets");
+    }
 
     bool loading = true;
     while (true) {
-        _loadingScreen->render();
+        if (hasLoadingScreen) {
+            _loadingScreen->render();
+        }
         _assetManager->update();
 
         std::vector<const Asset*> allAssets = _assetManager->allAssets();
@@ -767,42 +775,46 @@ void OpenSpaceEngine::loadAssets() {
         std::vector<const ResourceSynchronization*> allSyncs =
             _assetManager->allSynchronizations();
 
-        for (const ResourceSynchronization* sync : allSyncs) {
-            ZoneScopedN("Update resource synchronization")
-
-            if (sync->isSyncing()) {
-                LoadingScreen::ProgressInfo progressInfo;
+        if (hasLoadingScreen) {
+            for (const ResourceSynchronization* sync : allSyncs) {
+                ZoneScopedN("Update resource synchronization")
+
+                if (sync->isSyncing()) {
+                    LoadingScreen::ProgressInfo progressInfo;
+
+                    progressInfo.progress = [](const ResourceSynchronization* sync) {
+                        if (!sync->nTotalBytesIsKnown()) {
+                            return 0.f;
+                        }
+                        if (sync->nTotalBytes() == 0) {
+                            return 1.f;
+                        }
+                        return
+                            static_cast<float>(sync->nSynchronizedBytes()) /
+                            static_cast<float>(sync->nTotalBytes());
+                    }(sync);
+
+                    _loadingScreen->updateItem(
+                        sync->identifier(),
+                        sync->name(),
+                        LoadingScreen::ItemStatus::Started,
+                        progressInfo
+                    );
+                }
 
-                progressInfo.progress = [](const ResourceSynchronization* sync) {
-                    if (!sync->nTotalBytesIsKnown()) {
-                        return 0.f;
-                    }
-                    if (sync->nTotalBytes() == 0) {
-                        return 1.f;
-                    }
-                    return
-                        static_cast<float>(sync->nSynchronizedBytes()) /
-                        static_cast<float>(sync->nTotalBytes());
-                }(sync);
-                
-                _loadingScreen->updateItem(
-                    sync->identifier(),
-                    sync->name(),
-                    LoadingScreen::ItemStatus::Started,
-                    progressInfo
-                );
+                if (sync->isRejected()) {
+                    _loadingScreen->updateItem(
+                        sync->identifier(),
+                        sync->name(),
+                        LoadingScreen::ItemStatus::Failed,
+                        LoadingScreen::ProgressInfo()
+                    );
+                }
             }
 
-            if (sync->isRejected()) {
-                _loadingScreen->updateItem(
-                    sync->identifier(), sync->name(), LoadingScreen::ItemStatus::Failed,
-                    LoadingScreen::ProgressInfo()
-                );
-            }
+            _loadingScreen->setItemNumber(static_cast<int>(allSyncs.size()));
         }
 
-        _loadingScreen->setItemNumber(static_cast<int>(allSyncs.size()));
-
         if (_shouldAbortLoading) {
             global::windowDelegate->terminate();
             break;
@@ -818,6 +830,12 @@ void OpenSpaceEngine::loadAssets() {
             break;
         }
 
+        if (!hasLoadingScreen) {
+            // There are no items to update, so wait for the assets to finish loading
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
         loading = false;
         auto it = allSyncs.begin();
         while (it != allSyncs.end()) {
@@ -877,17 +895,24 @@ void OpenSpaceEngine::loadAssets() {
         return;
     }
 
-    _loadingScreen->setPhase(LoadingScreen::Phase::Initialization);
+    if (hasLoadingScreen) {
+        _loadingScreen->setPhase(LoadingScreen::Phase::Initialization);
 
-    _loadingScreen->postMessage("Initializing scene");
-    while (_scene->isInitializing()) {
-        _loadingScreen->render();
-    }
+        _loadingScreen->postMessage("Initializing scene");
+        while (_scene->isInitializing()) {
+            _loadingScreen->render();
+        }
 
-    _loadingScreen->postMessage("Initializing OpenGL");
-    _loadingScreen->finalize();
+        _loadingScreen->postMessage("Initializing OpenGL");
+        _loadingScreen->finalize();
 
-    _loadingScreen = nullptr;
+        _loadingScreen = nullptr;
+    }
+    else {
+        while (_scene->isInitializing()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
 
     global::renderEngine->updateScene();
 
@@ -1137,7 +1162,7 @@ void OpenSpaceEngine::preSynchronization() {
     FileSys.triggerFilesystemEvents();
 
     // Reset the temporary, frame-based storage
-    global::memoryManager->TemporaryMemory.reset();
+    global::memoryManager->resetTemporaryMemory();
 
     if (_isRenderingFirstFrame) {
         global::profile->ignoreUpdates = true;
@@ -1211,14 +1236,17 @@ void OpenSpaceEngine::postSynchronizationPreDraw() {
     bool master = global::windowDelegate->isMaster();
     global::syncEngine->postSynchronization(SyncEngine::IsMaster(master));
 
-    // This probably doesn't have to be done here every frame, but doing it earlier gives
-    // weird results when using side_by_side stereo --- abock
-    using FR = ghoul::fontrendering::FontRenderer;
-    FR::defaultRenderer().setFramebufferSize(global::renderEngine->fontResolution());
+    const bool isHeadless = global::windowDelegate->isHeadless();
+    if (!isHeadless) {
+        // This probably doesn't have to be done here every frame, but doing it earlier
+        // gives weird results when using side_by_side stereo --- abock
+        using FR = ghoul::fontrendering::FontRenderer;
+        FR::defaultRenderer().setFramebufferSize(global::renderEngine->fontResolution());
 
-    FR::defaultProjectionRenderer().setFramebufferSize(
-        global::renderEngine->renderingResolution()
-    );
+        FR::defaultProjectionRenderer().setFramebufferSize(
+            global::renderEngine->renderingResolution()
+        );
+    }
 
     if (_shutdown.inShutdown) {
         if (_shutdown.timer <= 0.f) {
@@ -1234,9 +1262,11 @@ void OpenSpaceEngine::postSynchronizationPreDraw() {
     _assetManager->update();
 
     global::renderEngine->updateScene();
-    global::renderEngine->updateRenderer();
-    global::renderEngine->updateScreenSpaceRenderables();
-    global::renderEngine->updateShaderPrograms();
+    if (!isHeadless) {
+        global::renderEngine->updateRenderer();
+        global::renderEngine->updateScreenSpaceRenderables();
+        global::renderEngine->updateShaderPrograms();
+    }
 
     if (!master) {
         _scene->camera()->invalidateCache();
@@ -1365,7 +1395,7 @@ void OpenSpaceEngine::postDraw() {
 void OpenSpaceEngine::resetPropertyChangeFlags() {
     ZoneScoped
 
-    std::vector<SceneGraphNode*> nodes =
+    const std::vector<SceneGraphNode*>& nodes =
         global::renderEngine->scene()->allSceneGraphNodes();
     for (SceneGraphNode* n : nodes) {
         resetPropertyChangeFlagsOfSubowners(n);
@@ -1573,17 +1603,16 @@ void OpenSpaceEngine::handleDragDrop(const std::string& file) {
     );
 }
 
-std::vector<std::byte> OpenSpaceEngine::encode() {
+SyncBuffer::View OpenSpaceEngine::encode() {
     ZoneScoped
 
-    std::vector<std::byte> buffer = global::syncEngine->encodeSyncables();
-    return buffer;
+    return global::syncEngine->encodeSyncables();
 }
 
-void OpenSpaceEngine::decode(std::vector<std::byte> data) {
+void OpenSpaceEngine::decode(SyncBuffer::View data) {
     ZoneScoped
 
-    global::syncEngine->decodeSyncables(std::move(data));
+    global::syncEngine->decodeSyncables(data);
 }
 
 void OpenSpaceEngine::toggleShutdownMode() {
@@ -25,9 +25,20 @@
 #include <openspace/engine/syncengine.h>
 
 #include <openspace/util/syncdata.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/profiling.h>
 #include <algorithm>
+#include <chrono>
+
+namespace {
+    constexpr const char* _loggerCat = "SyncEngine";
+
+    bool isPresent(const std::vector<uint8_t>& presence, size_t i) {
+        return presence[i / 8] & (1 << (i % 8));
+    }
+} // namespace
 
 namespace openspace {
 
@@ -38,24 +49,82 @@ SyncEngine::SyncEngine(unsigned int syncBufferSize)
 }
 
 // Should be called on sgct master
-std::vector<std::byte> SyncEngine::encodeSyncables() {
-    for (Syncable* syncable : _syncables) {
-        syncable->encode(&_syncBuffer);
+SyncBuffer::View SyncEngine::encodeSyncables() {
+    ZoneScoped
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Resizing the bitmask only allocates if Syncables were added since the last frame
+    _presence.assign((_syncables.size() + 7) / 8, 0);
+    size_t nSkipped = 0;
+    for (size_t i = 0; i < _syncables.size(); ++i) {
+        if (_syncables[i]->isDirty()) {
+            _presence[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+        }
+        else {
+            nSkipped++;
+        }
     }
 
-    std::vector<std::byte> data = _syncBuffer.data();
     _syncBuffer.reset();
+    _syncBuffer.encode(static_cast<uint32_t>(_syncables.size()));
+    for (uint8_t p : _presence) {
+        _syncBuffer.encode(p);
+    }
+    for (size_t i = 0; i < _syncables.size(); ++i) {
+        if (isPresent(_presence, i)) {
+            _syncables[i]->encode(&_syncBuffer);
+        }
+    }
+
+    const SyncBuffer::View data = _syncBuffer.encodedData();
+    _statistics.nBytes = data.size;
+    _statistics.nBytesMax = std::max(_statistics.nBytesMax, data.size);
+    _statistics.nSkipped = nSkipped;
+    _statistics.encodeTime = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start
+    ).count();
     return data;
 }
 
 // Should be called on sgct slaves
-void SyncEngine::decodeSyncables(std::vector<std::byte> data) {
-    _syncBuffer.setData(std::move(data));
-    for (Syncable* syncable : _syncables) {
-        syncable->decode(&_syncBuffer);
+void SyncEngine::decodeSyncables(SyncBuffer::View data) {
+    ZoneScoped
+
+    const auto start = std::chrono::steady_clock::now();
+
+    _syncBuffer.setData(data);
+    const uint32_t nSyncables = _syncBuffer.decode<uint32_t>();
+    if (nSyncables != _syncables.size()) {
+        LERROR(fmt::format(
+            "Received data for {} Syncables, but {} Syncables are registered",
+            nSyncables, _syncables.size()
+        ));
+        _syncBuffer.reset();
+        return;
     }
 
+    _presence.resize((_syncables.size() + 7) / 8);
+    for (uint8_t& p : _presence) {
+        _syncBuffer.decode(p);
+    }
+    size_t nSkipped = 0;
+    for (size_t i = 0; i < _syncables.size(); ++i) {
+        if (isPresent(_presence, i)) {
+            _syncables[i]->decode(&_syncBuffer);
+        }
+        else {
+            nSkipped++;
+        }
+    }
     _syncBuffer.reset();
+
+    _statistics.nBytes = data.size;
+    _statistics.nBytesMax = std::max(_statistics.nBytesMax, data.size);
+    _statistics.nSkipped = nSkipped;
+    _statistics.decodeTime = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start
+    ).count();
 }
 
 void SyncEngine::preSynchronization(IsMaster isMaster) {
@@ -100,4 +169,8 @@ void SyncEngine::removeSyncables(const std::vector<Syncable*>& syncables) {
     }
 }
 
+const SyncEngine::Statistics& SyncEngine::statistics() const {
+    return _statistics;
+}
+
 } // namespace openspace
@@ -28,6 +28,7 @@
 #include <openspace/engine/globals.h>
 #include <openspace/engine/windowdelegate.h>
 #include <openspace/events/eventengine.h>
+#include <openspace/interaction/tasks/convertrecdirectorytask.h>
 #include <openspace/interaction/tasks/convertrecfileversiontask.h>
 #include <openspace/interaction/tasks/convertrecformattask.h>
 #include <openspace/navigation/keyframenavigator.h>
@@ -41,6 +42,7 @@
 #include <openspace/scripting/scriptscheduler.h>
 #include <openspace/util/factorymanager.h>
 #include <openspace/util/task.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/util/timemanager.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
@@ -51,6 +53,8 @@
 #include <algorithm>
 #include <filesystem>
 #include <iomanip>
+#include <mutex>
+#include <set>
 
 #ifdef WIN32
 #include <windows.h>
@@ -75,6 +79,34 @@ namespace {
 
     constexpr const bool UsingTimeKeyframes = false;
 
+    // Number of keyframes that are read from an indexed recording at once during
+    // playback, and the number of these pages that are kept in memory
+    constexpr const size_t PlaybackPageSize = 256;
+    constexpr const size_t MaxPlaybackPages = 8;
+
+    // Recordings for which an index is currently being built in the background
+    std::mutex IndexBuildMutex;
+    std::set<std::string> IndexBuildsInProgress;
+
+    void buildIndexInBackground(std::string recording) {
+        {
+            std::lock_guard lock(IndexBuildMutex);
+            if (!IndexBuildsInProgress.insert(recording).second) {
+                return;
+            }
+        }
+
+        LINFO(fmt::format("Building index for session recording {}", recording));
+        openspace::global::taskScheduler->enqueue(
+            [recording]() {
+                openspace::interaction::SessionRecordingIndex::build(recording);
+                std::lock_guard lock(IndexBuildMutex);
+                IndexBuildsInProgress.erase(recording);
+            },
+            openspace::TaskScheduler::Priority::IO
+        );
+    }
+
 } // namespace
 
 #include "sessionrecording_lua.inl"
@@ -101,6 +133,7 @@ SessionRecording::SessionRecording(bool isGlobal)
         ghoul_assert(fTask, "No task factory existed");
         fTask->registerClass<ConvertRecFormatTask>("ConvertRecFormatTask");
         fTask->registerClass<ConvertRecFileVersionTask>("ConvertRecFileVersionTask");
+        fTask->registerClass<ConvertRecDirectoryTask>("ConvertRecDirectoryTask");
         addProperty(_renderPlaybackInformation);
         addProperty(_ignoreRecordedScale);
     }
@@ -184,15 +217,12 @@ bool SessionRecording::handleRecordingFile(std::string filenameIn) {
         ));
         return false;
     }
-    if (_recordingDataMode == DataMode::Binary) {
-        _recordFile.open(absFilename, std::ios::binary);
-    }
-    else {
-        _recordFile.open(absFilename);
-    }
+    _recordWriter = std::make_unique<SessionRecordingWriter>(absFilename);
+    _recordFilename = absFilename;
 
-    if (!_recordFile.is_open() || !_recordFile.good()) {
+    if (!_recordWriter->isOpen()) {
         LERROR(fmt::format("Unable to open file {} for keyframe recording", absFilename));
+        _recordWriter = nullptr;
         return false;
     }
     return true;
@@ -222,17 +252,6 @@ bool SessionRecording::startRecording(const std::string& filename) {
         _propertyBaselinesSaved.clear();
         _keyframesSavePropertiesBaseline_scripts.clear();
         _keyframesSavePropertiesBaseline_timeline.clear();
-        _recordingEntryNum = 1;
-
-        _recordFile << FileHeaderTitle;
-        _recordFile.write(FileHeaderVersion, FileHeaderVersionLength);
-        if (_recordingDataMode == DataMode::Binary) {
-            _recordFile << DataFormatBinaryTag;
-        }
-        else {
-            _recordFile << DataFormatAsciiTag;
-        }
-        _recordFile << '\n';
 
         _timestampRecordStarted = global::windowDelegate->applicationTime();
 
@@ -268,85 +287,64 @@ void SessionRecording::recordCurrentTimeRate() {
 
 void SessionRecording::stopRecording() {
     if (_state == SessionState::Recording) {
-        //Add all property baseline scripts to the beginning of the recording file
+        // The keyframes have been written during the recording already, but the file
+        // header and the property baselines, which are only complete now, precede them
+        std::ostringstream prefix;
+        prefix << FileHeaderTitle;
+        prefix.write(FileHeaderVersion, FileHeaderVersionLength);
+        if (_recordingDataMode == DataMode::Binary) {
+            prefix << DataFormatBinaryTag;
+        }
+        else {
+            prefix << DataFormatAsciiTag;
+        }
+        prefix << '\n';
+
+        std::vector<SessionRecordingIndex::Entry> baselineEntries;
         datamessagestructures::ScriptMessage smTmp;
         for (timelineEntry initPropScripts : _keyframesSavePropertiesBaseline_timeline) {
             if (initPropScripts.keyframeType == RecordedType::Script) {
+                SessionRecordingIndex::Entry e;
+                e.timeOs = _timestamps3RecordStarted.timeOs;
+                e.timeRec = _timestamps3RecordStarted.timeRec;
+                e.timeSim = _timestamps3RecordStarted.timeSim;
+                e.offset = static_cast<uint64_t>(prefix.tellp());
+                e.type = HeaderScriptBinary;
+                baselineEntries.push_back(e);
+
                 smTmp._script = _keyframesSavePropertiesBaseline_scripts
                     [initPropScripts.idxIntoKeyframeTypeArray];
                 saveSingleKeyframeScript(
                     smTmp,
                     _timestamps3RecordStarted,
                     _recordingDataMode,
-                    _recordFile,
+                    prefix,
                     _keyframeBuffer
                 );
             }
         }
-        for (timelineEntry entry : _timeline) {
-            switch (entry.keyframeType) {
-            case RecordedType::Camera:
-                {
-                    interaction::KeyframeNavigator::CameraPose kf
-                        = _keyframesCamera[entry.idxIntoKeyframeTypeArray];
-                    glm::dquat tmpRotation(
-                        std::move(kf.rotation.w),
-                        std::move(kf.rotation.x),
-                        std::move(kf.rotation.y),
-                        std::move(kf.rotation.z)
-                    );
-                    datamessagestructures::CameraKeyframe kfMsg(
-                        std::move(kf.position),
-                        std::move(tmpRotation),
-                        std::move(kf.focusNode),
-                        std::move(kf.followFocusNodeRotation),
-                        std::move(kf.scale)
-                    );
-                    saveSingleKeyframeCamera(
-                        kfMsg,
-                        entry.t3stamps,
-                        _recordingDataMode,
-                        _recordFile,
-                        _keyframeBuffer
-                    );
-                    break;
-                }
-            case RecordedType::Time:
-                {
-                    datamessagestructures::TimeKeyframe tf
-                        = _keyframesTime[entry.idxIntoKeyframeTypeArray];
-                    saveSingleKeyframeTime(
-                        tf,
-                        entry.t3stamps,
-                        _recordingDataMode,
-                        _recordFile,
-                        _keyframeBuffer
-                    );
-                    break;
-                }
-            case RecordedType::Script:
-                {
-                    smTmp._script = _keyframesScript[entry.idxIntoKeyframeTypeArray];
-                    saveSingleKeyframeScript(
-                        smTmp,
-                        entry.t3stamps,
-                        _recordingDataMode,
-                        _recordFile,
-                        _keyframeBuffer
-                    );
-                    break;
-                }
-            default:
-                {
-                    break;
-                }
-            }
+
+        const bool success = _recordWriter->finish(
+            prefix.str(),
+            std::move(baselineEntries)
+        );
+        const SessionRecordingWriter::Stats stats = _recordWriter->stats();
+        _recordWriter = nullptr;
+
+        if (stats.nDropped > 0 || stats.nBlocksLate > 0) {
+            LWARNING(fmt::format(
+                "Writing the recording fell behind {} times, {} camera keyframes were "
+                "dropped", stats.nBlocksLate, stats.nDropped
+            ));
         }
         _state = SessionState::Idle;
-        LINFO("Session recording stopped");
+        if (success) {
+            LINFO(fmt::format(
+                "Session recording stopped, {} keyframes written to {}",
+                stats.nKeyframes - stats.nDropped, _recordFilename
+            ));
+        }
     }
-    // Close the recording file
-    _recordFile.close();
     _cleanupNeeded = true;
 }
 
@@ -362,9 +360,11 @@ bool SessionRecording::startPlayback(std::string& filename,
     else {
         absFilename = absPath("${RECORDINGS}/" + filename).string();
     }
-    // Run through conversion in case file is older. Does nothing if the file format
-    // is up-to-date
-    absFilename = convertFile(absFilename);
+    // Run through conversion in case file is older. Only the header is inspected for an
+    // up-to-date file so that starting a playback does not depend on the file length
+    if (readVersionFromHeader(absFilename) != fileFormatVersion()) {
+        absFilename = convertFile(absFilename);
+    }
 
     if (_state == SessionState::Recording) {
         LERROR("Unable to start playback while in session recording mode");
@@ -443,9 +443,15 @@ bool SessionRecording::startPlayback(std::string& filename,
     _loadedNodes.clear();
     populateListofLoadedSceneGraphNodes();
 
-    if (!playbackAddEntriesToTimeline()) {
-        cleanUpPlayback();
-        return false;
+    // Indexed recordings are streamed during playback, all others are read in full
+    // while an index is built for the next time they are played back
+    _playbackIndex = SessionRecordingIndex::load(_playbackFilename);
+    if (!_playbackIndex) {
+        buildIndexInBackground(_playbackFilename);
+        if (!playbackAddEntriesToTimeline()) {
+            cleanUpPlayback();
+            return false;
+        }
     }
 
     initializePlayback_modeFlags();
@@ -457,9 +463,9 @@ bool SessionRecording::startPlayback(std::string& filename,
     LINFO(fmt::format(
         "Playback session started: ({:8.3f},0.0,{:13.3f}) with {}/{}/{} entries, "
         "forceTime={}",
-        now, _timestampPlaybackStarted_simulation, _keyframesCamera.size(),
-        _keyframesTime.size(), _keyframesScript.size(),
-        (_playbackForceSimTimeAtStart ? 1 : 0)
+        now, _timestampPlaybackStarted_simulation,
+        numKeyframes(RecordedType::Camera), numKeyframes(RecordedType::Time),
+        numKeyframes(RecordedType::Script), (_playbackForceSimTimeAtStart ? 1 : 0)
     ));
 
     global::eventEngine->publishEvent<events::EventSessionRecordingPlayback>(
@@ -501,7 +507,7 @@ bool SessionRecording::initializePlayback_timeline() {
         return false;
     }
     if (_playbackForceSimTimeAtStart) {
-        Timestamps times = _timeline[_idxTimeline_cameraFirstInTimeline].t3stamps;
+        Timestamps times = timelineEntryAt(_idxTimeline_cameraFirstInTimeline).t3stamps;
         global::timeManager->setTimeNextFrame(Time(times.timeSim));
         _saveRenderingCurrentRecordedTime = times.timeRec;
     }
@@ -546,15 +552,72 @@ void SessionRecording::setPlaybackPause(bool pause) {
     }
 }
 
+bool SessionRecording::seekPlayback(double recordedTime) {
+    if (_state != SessionState::Playback && _state != SessionState::PlaybackPaused) {
+        LERROR("Unable to seek while no playback is in progress");
+        return false;
+    }
+    if (timelineSize() == 0) {
+        return false;
+    }
+
+    const unsigned int idx = std::min(
+        timelineIndexAtRecordedTime(recordedTime),
+        lastTimelineIndex()
+    );
+    const Timestamps target = timelineEntryAt(idx).t3stamps;
+
+    // Resume interpolating from the last camera keyframe at or before the target
+    unsigned int cameraIdx = idx;
+    while (cameraIdx > _idxTimeline_cameraFirstInTimeline &&
+           (!doesTimelineEntryContainCamera(cameraIdx) ||
+            timelineEntryAt(cameraIdx).t3stamps.timeRec > recordedTime))
+    {
+        cameraIdx--;
+    }
+
+    initializePlayback_modeFlags();
+    if (numKeyframes(RecordedType::Camera) == 0) {
+        _playbackActive_camera = false;
+    }
+    _idxTimeline_nonCamera = idx;
+    _idxTimeline_cameraPtrPrev = cameraIdx;
+    _idxTimeline_cameraPtrNext = cameraIdx;
+
+    // Move the playback clock so that the current time corresponds to the target
+    const double now = global::windowDelegate->applicationTime();
+    double time = recordedTime;
+    if (_playbackTimeReferenceMode == KeyframeTimeRef::Relative_recordedStart) {
+        _timestampPlaybackStarted_application = now - _playbackPauseOffset - time;
+    }
+    else if (_playbackTimeReferenceMode == KeyframeTimeRef::Absolute_simTimeJ2000) {
+        time = target.timeSim;
+        global::timeManager->setTimeNextFrame(Time(time));
+    }
+    else {
+        time = recordedTime + (target.timeOs - target.timeRec);
+        _playbackPauseOffset = now - time;
+    }
+    if (isSavingFramesDuringPlayback()) {
+        _saveRenderingCurrentRecordedTime = time;
+    }
+
+    LINFO(fmt::format(
+        "Playback seeked to {:.3f} s (keyframe {} of {})",
+        recordedTime, idx, timelineSize()
+    ));
+    return true;
+}
+
 bool SessionRecording::findFirstCameraKeyframeInTimeline() {
     bool foundCameraKeyframe = false;
-    for (unsigned int i = 0; i < _timeline.size(); i++) {
+    for (unsigned int i = 0; i < timelineSize(); i++) {
         if (doesTimelineEntryContainCamera(i)) {
             _idxTimeline_cameraFirstInTimeline = i;
             _idxTimeline_cameraPtrPrev = _idxTimeline_cameraFirstInTimeline;
             _idxTimeline_cameraPtrNext = _idxTimeline_cameraFirstInTimeline;
             _cameraFirstInTimeline_timestamp = appropriateTimestamp(
-                _timeline[_idxTimeline_cameraFirstInTimeline].t3stamps);
+                timelineEntryAt(_idxTimeline_cameraFirstInTimeline).t3stamps);
             foundCameraKeyframe = true;
             break;
         }
@@ -632,23 +695,21 @@ void SessionRecording::cleanUpPlayback() {
     Camera* camera = global::navigationHandler->camera();
     ghoul_assert(camera != nullptr, "Camera must not be nullptr");
     Scene* scene = camera->parent()->scene();
-    if (!_timeline.empty()) {
-        if (_timeline.size() > 0) {
-            unsigned int p =
-                _timeline[_idxTimeline_cameraPtrPrev].idxIntoKeyframeTypeArray;
-            if (_keyframesCamera.size() > 0) {
-                const SceneGraphNode* n = scene->sceneGraphNode(
-                    _keyframesCamera[p].focusNode);
-                if (n) {
-                    global::navigationHandler->orbitalNavigator().setFocusNode(
-                        n->identifier());
-                }
-            }
+    if (timelineSize() > 0 && numKeyframes(RecordedType::Camera) > 0) {
+        const SceneGraphNode* n = scene->sceneGraphNode(
+            cameraKeyframeAt(_idxTimeline_cameraPtrPrev).focusNode
+        );
+        if (n) {
+            global::navigationHandler->orbitalNavigator().setFocusNode(n->identifier());
         }
     }
     global::scriptScheduler->stopPlayback();
 
     _playbackFile.close();
+    _playbackIndex = nullptr;
+    _playbackPages.clear();
+    _playbackPageAccess = 0;
+    _playbackStreamFailed = false;
 
     // Clear all timelines and keyframes
     _timeline.clear();
@@ -713,7 +774,7 @@ void SessionRecording::writeToFileBuffer(unsigned char* buf,
 void SessionRecording::saveStringToFile(const std::string& s,
                                         unsigned char* kfBuffer,
                                         size_t& idx,
-                                        std::ofstream& file)
+                                        std::ostream& file)
 {
     size_t strLen = s.size();
     size_t writeSize_bytes = sizeof(size_t);
@@ -766,8 +827,15 @@ void SessionRecording::saveCameraKeyframeToTimeline() {
     datamessagestructures::CameraKeyframe kf = _externInteract.generateCameraKeyframe();
 
     Timestamps times = generateCurrentTimestamp3(kf._timestamp);
-    interaction::KeyframeNavigator::CameraPose pbFrame(std::move(kf));
-    addKeyframe(times, pbFrame, _recordingEntryNum++);
+    _recordKeyframe.str(std::string());
+    saveSingleKeyframeCamera(
+        kf,
+        times,
+        _recordingDataMode,
+        _recordKeyframe,
+        _keyframeBuffer
+    );
+    appendKeyframeToRecording(HeaderCameraBinary, times);
 }
 
 void SessionRecording::saveHeaderBinary(Timestamps& times,
@@ -794,7 +862,7 @@ void SessionRecording::saveHeaderAscii(Timestamps& times,
 void SessionRecording::saveCameraKeyframeBinary(Timestamps& times,
                                                 datamessagestructures::CameraKeyframe& kf,
                                                 unsigned char* kfBuffer,
-                                                std::ofstream& file)
+                                                std::ostream& file)
 {
     // Writing to a binary session recording file
     size_t idx = 0;
@@ -808,7 +876,7 @@ void SessionRecording::saveCameraKeyframeBinary(Timestamps& times,
 
 void SessionRecording::saveCameraKeyframeAscii(Timestamps& times,
                                                datamessagestructures::CameraKeyframe& kf,
-                                               std::ofstream& file)
+                                               std::ostream& file)
 {
     std::stringstream keyframeLine = std::stringstream();
     saveHeaderAscii(times, HeaderCameraAscii, keyframeLine);
@@ -821,13 +889,21 @@ void SessionRecording::saveTimeKeyframeToTimeline() {
     datamessagestructures::TimeKeyframe kf = _externInteract.generateTimeKeyframe();
 
     Timestamps times = generateCurrentTimestamp3(kf._timestamp);
-    addKeyframe(times, kf, _recordingEntryNum++);
+    _recordKeyframe.str(std::string());
+    saveSingleKeyframeTime(
+        kf,
+        times,
+        _recordingDataMode,
+        _recordKeyframe,
+        _keyframeBuffer
+    );
+    appendKeyframeToRecording(HeaderTimeBinary, times);
 }
 
 void SessionRecording::saveTimeKeyframeBinary(Timestamps& times,
                                               datamessagestructures::TimeKeyframe& kf,
                                               unsigned char* kfBuffer,
-                                              std::ofstream& file)
+                                              std::ostream& file)
 {
     size_t idx = 0;
     saveHeaderBinary(times, HeaderTimeBinary, kfBuffer, idx);
@@ -839,7 +915,7 @@ void SessionRecording::saveTimeKeyframeBinary(Timestamps& times,
 
 void SessionRecording::saveTimeKeyframeAscii(Timestamps& times,
                                              datamessagestructures::TimeKeyframe& kf,
-                                             std::ofstream& file)
+                                             std::ostream& file)
 {
     std::stringstream keyframeLine = std::stringstream();
     saveHeaderAscii(times, HeaderTimeAscii, keyframeLine);
@@ -863,7 +939,28 @@ void SessionRecording::saveScriptKeyframeToTimeline(std::string script)
         = _externInteract.generateScriptMessage(script);
 
     Timestamps times = generateCurrentTimestamp3(sm._timestamp);
-    addKeyframe(times, sm._script, _playbackLineNum);
+    _recordKeyframe.str(std::string());
+    saveSingleKeyframeScript(
+        sm,
+        times,
+        _recordingDataMode,
+        _recordKeyframe,
+        _keyframeBuffer
+    );
+    appendKeyframeToRecording(HeaderScriptBinary, times);
+}
+
+void SessionRecording::appendKeyframeToRecording(char type, const Timestamps& times) {
+    if (!_recordWriter) {
+        return;
+    }
+
+    SessionRecordingIndex::Entry entry;
+    entry.timeOs = times.timeOs;
+    entry.timeRec = times.timeRec;
+    entry.timeSim = times.timeSim;
+    entry.type = type;
+    _recordWriter->append(entry, _recordKeyframe.str());
 }
 
 bool SessionRecording::doesStartWithSubstring(const std::string& s,
@@ -912,7 +1009,7 @@ void SessionRecording::replaceCommandsFromScriptIfFound(std::string& script)
 void SessionRecording::saveScriptKeyframeBinary(Timestamps& times,
                                                 datamessagestructures::ScriptMessage& sm,
                                                 unsigned char* smBuffer,
-                                                std::ofstream& file)
+                                                std::ostream& file)
 {
     size_t idx = 0;
     saveHeaderBinary(times, HeaderScriptBinary, smBuffer, idx);
@@ -925,7 +1022,7 @@ void SessionRecording::saveScriptKeyframeBinary(Timestamps& times,
 
 void SessionRecording::saveScriptKeyframeAscii(Timestamps& times,
                                                datamessagestructures::ScriptMessage& sm,
-                                               std::ofstream& file)
+                                               std::ostream& file)
 {
 
     std::stringstream keyframeLine = std::stringstream();
@@ -1270,7 +1367,7 @@ bool SessionRecording::readSingleKeyframeCamera(datamessagestructures::CameraKey
 
 void SessionRecording::saveSingleKeyframeCamera(datamessagestructures::CameraKeyframe& kf,
                                                 Timestamps& times, DataMode mode,
-                                                std::ofstream& file,
+                                                std::ostream& file,
                                                 unsigned char* buffer)
 {
     if (mode == DataMode::Binary) {
@@ -1404,7 +1501,7 @@ bool SessionRecording::readSingleKeyframeTime(datamessagestructures::TimeKeyfram
 
 void SessionRecording::saveSingleKeyframeTime(datamessagestructures::TimeKeyframe& kf,
                                               Timestamps& times, DataMode mode,
-                                              std::ofstream& file, unsigned char* buffer)
+                                              std::ostream& file, unsigned char* buffer)
 {
     if (mode == DataMode::Binary) {
         saveTimeKeyframeBinary(times, kf, buffer, file);
@@ -1594,9 +1691,8 @@ std::string SessionRecording::getNameFromSurroundingQuotes(std::string& s) {
 }
 
 bool SessionRecording::checkIfInitialFocusNodeIsLoaded(unsigned int camIdx1) {
-    if (_keyframesCamera.size() > 0) {
-        std::string startFocusNode
-            = _keyframesCamera[_timeline[camIdx1].idxIntoKeyframeTypeArray].focusNode;
+    if (numKeyframes(RecordedType::Camera) > 0) {
+        std::string startFocusNode = cameraKeyframeAt(camIdx1).focusNode;
         auto it = std::find(_loadedNodes.begin(), _loadedNodes.end(), startFocusNode);
         if (it == _loadedNodes.end()) {
             LERROR(fmt::format(
@@ -1652,7 +1748,7 @@ bool SessionRecording::readSingleKeyframeScript(datamessagestructures::ScriptMes
 
 void SessionRecording::saveSingleKeyframeScript(datamessagestructures::ScriptMessage& kf,
                                                 Timestamps& times, DataMode mode,
-                                                std::ofstream& file,
+                                                std::ostream& file,
                                                 unsigned char* buffer)
 {
     if (mode == DataMode::Binary) {
@@ -1803,6 +1899,13 @@ void SessionRecording::moveAheadInTime() {
     double currTime = currentTime();
     lookForNonCameraKeyframesThatHaveComeDue(currTime);
     updateCameraWithOrWithoutNewKeyframes(currTime);
+    if (_playbackStreamFailed) {
+        LERROR(fmt::format(
+            "Stopping playback after failing to read from {}", _playbackFilename
+        ));
+        stopPlayback();
+        return;
+    }
     //Unfortunately the first frame is sometimes rendered because globebrowsing reports
     // that all chunks are rendered when they apparently are not.
     if (_saveRendering_isFirstFrame) {
@@ -1834,7 +1937,7 @@ void SessionRecording::lookForNonCameraKeyframesThatHaveComeDue(double currTime)
             break;
         }
 
-        if (++_idxTimeline_nonCamera >= _timeline.size()) {
+        if (++_idxTimeline_nonCamera >= timelineSize()) {
             _idxTimeline_nonCamera--;
             if (_playbackActive_time) {
                 signalPlaybackFinishedForComponent(RecordedType::Time);
@@ -1876,17 +1979,18 @@ bool SessionRecording::findNextFutureCameraIndex(double currTime) {
     unsigned int seekAheadIndex = _idxTimeline_cameraPtrPrev;
     while (true) {
         seekAheadIndex++;
-        if (seekAheadIndex >= static_cast<unsigned int>(_timeline.size())) {
-            seekAheadIndex = static_cast<unsigned int>(_timeline.size()) - 1;
+        if (seekAheadIndex >= static_cast<unsigned int>(timelineSize())) {
+            seekAheadIndex = static_cast<unsigned int>(timelineSize()) - 1;
         }
 
-        if (doesTimelineEntryContainCamera(seekAheadIndex)) {
+        const timelineEntry seekAheadEntry = timelineEntryAt(seekAheadIndex);
+        if (seekAheadEntry.keyframeType == RecordedType::Camera) {
             unsigned int indexIntoCameraKeyframes =
-                _timeline[seekAheadIndex].idxIntoKeyframeTypeArray;
+                seekAheadEntry.idxIntoKeyframeTypeArray;
             double seekAheadKeyframeTimestamp
-                = appropriateTimestamp(_timeline[seekAheadIndex].t3stamps);
+                = appropriateTimestamp(seekAheadEntry.t3stamps);
 
-            if (indexIntoCameraKeyframes >= (_keyframesCamera.size() - 1)) {
+            if (indexIntoCameraKeyframes >= (numKeyframes(RecordedType::Camera) - 1)) {
                 _hasHitEndOfCameraKeyframes = true;
             }
 
@@ -1904,22 +2008,22 @@ bool SessionRecording::findNextFutureCameraIndex(double currTime) {
         }
 
         double interpolationUpperBoundTimestamp =
-            appropriateTimestamp(_timeline[_idxTimeline_cameraPtrNext].t3stamps);
+            appropriateTimestamp(timelineEntryAt(_idxTimeline_cameraPtrNext).t3stamps);
         if ((currTime > interpolationUpperBoundTimestamp) && _hasHitEndOfCameraKeyframes)
         {
             _idxTimeline_cameraPtrPrev = _idxTimeline_cameraPtrNext;
             return false;
         }
 
-        if (seekAheadIndex == (_timeline.size() - 1)) {
+        if (seekAheadIndex == (timelineSize() - 1)) {
             break;
         }
     }
     return true;
 }
 
-bool SessionRecording::doesTimelineEntryContainCamera(unsigned int index) const {
-    return (_timeline[index].keyframeType == RecordedType::Camera);
+bool SessionRecording::doesTimelineEntryContainCamera(unsigned int index) {
+    return (timelineEntryAt(index).keyframeType == RecordedType::Camera);
 }
 
 bool SessionRecording::processNextNonCameraKeyframeAheadInTime() {
@@ -1928,15 +2032,15 @@ bool SessionRecording::processNextNonCameraKeyframeAheadInTime() {
             // Just return true since this function no longer handles camera keyframes
             return true;
         case RecordedType::Time:
-            _idxTime = _timeline[_idxTimeline_nonCamera].idxIntoKeyframeTypeArray;
-            if (_keyframesTime.empty()) {
+            _idxTime = timelineEntryAt(_idxTimeline_nonCamera).idxIntoKeyframeTypeArray;
+            if (numKeyframes(RecordedType::Time) == 0) {
                 return false;
             }
             LINFO("Time keyframe type");
             // TBD: the TimeManager restricts setting time directly
             return false;
         case RecordedType::Script:
-            _idxScript = _timeline[_idxTimeline_nonCamera].idxIntoKeyframeTypeArray;
+            _idxScript = timelineEntryAt(_idxTimeline_nonCamera).idxIntoKeyframeTypeArray;
             return processScriptKeyframe();
         default:
             LERROR(fmt::format(
@@ -1950,9 +2054,9 @@ bool SessionRecording::processNextNonCameraKeyframeAheadInTime() {
 //void SessionRecording::moveBackInTime() { } //for future use
 
 unsigned int SessionRecording::findIndexOfLastCameraKeyframeInTimeline() {
-    unsigned int i = static_cast<unsigned int>(_timeline.size()) - 1;
+    unsigned int i = static_cast<unsigned int>(timelineSize()) - 1;
     for (; i > 0; i--) {
-        if (_timeline[i].keyframeType == RecordedType::Camera) {
+        if (doesTimelineEntryContainCamera(i)) {
             break;
         }
     }
@@ -1963,28 +2067,24 @@ bool SessionRecording::processCameraKeyframe(double now) {
     interaction::KeyframeNavigator::CameraPose nextPose;
     interaction::KeyframeNavigator::CameraPose prevPose;
 
-    unsigned int prevIdx;
-    unsigned int nextIdx;
     if (!_playbackActive_camera) {
         return false;
     }
-    else if (_keyframesCamera.empty()) {
+    else if (numKeyframes(RecordedType::Camera) == 0) {
         return false;
     }
     else {
-        prevIdx = _timeline[_idxTimeline_cameraPtrPrev].idxIntoKeyframeTypeArray;
-        prevPose = _keyframesCamera[prevIdx];
-        nextIdx = _timeline[_idxTimeline_cameraPtrNext].idxIntoKeyframeTypeArray;
-        nextPose = _keyframesCamera[nextIdx];
+        prevPose = cameraKeyframeAt(_idxTimeline_cameraPtrPrev);
+        nextPose = cameraKeyframeAt(_idxTimeline_cameraPtrNext);
     }
 
     // getPrevTimestamp();
     double prevTime = appropriateTimestamp(
-        _timeline[_idxTimeline_cameraPtrPrev].t3stamps
+        timelineEntryAt(_idxTimeline_cameraPtrPrev).t3stamps
     );
     // getNextTimestamp();
     double nextTime = appropriateTimestamp(
-        _timeline[_idxTimeline_cameraPtrNext].t3stamps
+        timelineEntryAt(_idxTimeline_cameraPtrNext).t3stamps
     );
 
     double t;
@@ -2006,7 +2106,7 @@ bool SessionRecording::processCameraKeyframe(double now) {
     Camera* camera = global::navigationHandler->camera();
     Scene* scene = camera->parent()->scene();
 
-    const SceneGraphNode* n = scene->sceneGraphNode(_keyframesCamera[prevIdx].focusNode);
+    const SceneGraphNode* n = scene->sceneGraphNode(prevPose.focusNode);
 
     if (n) {
         global::navigationHandler->orbitalNavigator().setFocusNode(n->identifier());
@@ -2025,15 +2125,16 @@ bool SessionRecording::processScriptKeyframe() {
     if (!_playbackActive_script) {
         return false;
     }
-    else if (_keyframesScript.empty()) {
+    else if (numKeyframes(RecordedType::Script) == 0) {
         return false;
     }
     else {
-        std::string nextScript = nextKeyframeObj(
-            _idxScript,
-            _keyframesScript,
-            ([this]() { signalPlaybackFinishedForComponent(RecordedType::Script); })
-        );
+        // The script has to be copied before signalling the end of the playback, which
+        // might start over from the beginning in loop mode
+        std::string nextScript = scriptKeyframeAt(_idxTimeline_nonCamera);
+        if (_idxScript == (numKeyframes(RecordedType::Script) - 1)) {
+            signalPlaybackFinishedForComponent(RecordedType::Script);
+        }
         global::scriptEngine->queueScript(
             nextScript,
             scripting::ScriptEngine::RemoteScripting::Yes
@@ -2044,69 +2145,297 @@ bool SessionRecording::processScriptKeyframe() {
 }
 
 double SessionRecording::getNextTimestamp() {
-    if (_timeline.empty()) {
+    if (timelineSize() == 0) {
         return 0.0;
     }
-    else if (_idxTimeline_nonCamera < _timeline.size()) {
-        return appropriateTimestamp(_timeline[_idxTimeline_nonCamera].t3stamps);
+    else if (_idxTimeline_nonCamera < timelineSize()) {
+        return appropriateTimestamp(timelineEntryAt(_idxTimeline_nonCamera).t3stamps);
     }
     else {
-        return appropriateTimestamp(_timeline.back().t3stamps);
+        return appropriateTimestamp(timelineEntryAt(lastTimelineIndex()).t3stamps);
     }
 }
 
 double SessionRecording::getPrevTimestamp() {
-    if (_timeline.empty()) {
+    if (timelineSize() == 0) {
         return 0.0;
     }
     else if (_idxTimeline_nonCamera == 0) {
-        return appropriateTimestamp(_timeline.front().t3stamps);
+        return appropriateTimestamp(timelineEntryAt(0).t3stamps);
     }
-    else if (_idxTimeline_nonCamera < _timeline.size()) {
-        return appropriateTimestamp(_timeline[_idxTimeline_nonCamera - 1].t3stamps);
+    else if (_idxTimeline_nonCamera < timelineSize()) {
+        return appropriateTimestamp(timelineEntryAt(_idxTimeline_nonCamera - 1).t3stamps);
     }
     else {
-        return appropriateTimestamp(_timeline.back().t3stamps);
+        return appropriateTimestamp(timelineEntryAt(lastTimelineIndex()).t3stamps);
     }
 }
 
 SessionRecording::RecordedType SessionRecording::getNextKeyframeType() {
-    if (_timeline.empty()) {
+    if (timelineSize() == 0) {
         return RecordedType::Invalid;
     }
-    else if (_idxTimeline_nonCamera < _timeline.size()) {
-        return _timeline[_idxTimeline_nonCamera].keyframeType;
+    else if (_idxTimeline_nonCamera < timelineSize()) {
+        return timelineEntryAt(_idxTimeline_nonCamera).keyframeType;
     }
     else {
-        return _timeline.back().keyframeType;
+        return timelineEntryAt(lastTimelineIndex()).keyframeType;
     }
 }
 
 SessionRecording::RecordedType SessionRecording::getPrevKeyframeType() {
-    if (_timeline.empty()) {
+    if (timelineSize() == 0) {
         return RecordedType::Invalid;
     }
-    else if (_idxTimeline_nonCamera < _timeline.size()) {
+    else if (_idxTimeline_nonCamera < timelineSize()) {
         if (_idxTimeline_nonCamera > 0) {
-            return _timeline[_idxTimeline_nonCamera - 1].keyframeType;
+            return timelineEntryAt(_idxTimeline_nonCamera - 1).keyframeType;
         }
         else {
-            return _timeline.front().keyframeType;
+            return timelineEntryAt(0).keyframeType;
         }
     }
     else {
-        return _timeline.back().keyframeType;
+        return timelineEntryAt(lastTimelineIndex()).keyframeType;
+    }
+}
+
+size_t SessionRecording::timelineSize() const {
+    return _playbackIndex ? _playbackIndex->size() : _timeline.size();
+}
+
+unsigned int SessionRecording::lastTimelineIndex() const {
+    return static_cast<unsigned int>(timelineSize()) - 1;
+}
+
+size_t SessionRecording::numKeyframes(RecordedType type) const {
+    if (_playbackIndex) {
+        switch (type) {
+            case RecordedType::Camera:
+                return _playbackIndex->numEntries(HeaderCameraBinary);
+            case RecordedType::Time:
+                return _playbackIndex->numEntries(HeaderTimeBinary);
+            case RecordedType::Script:
+                return _playbackIndex->numEntries(HeaderScriptBinary);
+            default:
+                return 0;
+        }
+    }
+
+    switch (type) {
+        case RecordedType::Camera:
+            return _keyframesCamera.size();
+        case RecordedType::Time:
+            return _keyframesTime.size();
+        case RecordedType::Script:
+            return _keyframesScript.size();
+        default:
+            return 0;
+    }
+}
+
+SessionRecording::timelineEntry SessionRecording::timelineEntryAt(unsigned int index) {
+    if (!_playbackIndex) {
+        return _timeline[index];
+    }
+
+    const PlaybackKeyframe* kf = playbackKeyframe(index);
+    return kf ? kf->entry : timelineEntry{ RecordedType::Invalid, 0, { 0.0, 0.0, 0.0 } };
+}
+
+interaction::KeyframeNavigator::CameraPose SessionRecording::cameraKeyframeAt(
+                                                                      unsigned int index)
+{
+    if (!_playbackIndex) {
+        return _keyframesCamera[_timeline[index].idxIntoKeyframeTypeArray];
+    }
+
+    const PlaybackKeyframe* kf = playbackKeyframe(index);
+    return kf ? kf->camera : interaction::KeyframeNavigator::CameraPose();
+}
+
+std::string SessionRecording::scriptKeyframeAt(unsigned int index) {
+    if (!_playbackIndex) {
+        return _keyframesScript[_timeline[index].idxIntoKeyframeTypeArray];
+    }
+
+    const PlaybackKeyframe* kf = playbackKeyframe(index);
+    return kf ? kf->script : std::string();
+}
+
+const SessionRecording::PlaybackKeyframe* SessionRecording::playbackKeyframe(
+                                                                      unsigned int index)
+{
+    ghoul_assert(_playbackIndex, "Keyframes are only streamed for indexed recordings");
+
+    const size_t first = (index / PlaybackPageSize) * PlaybackPageSize;
+    auto it = std::find_if(
+        _playbackPages.begin(),
+        _playbackPages.end(),
+        [first](const PlaybackPage& page) { return page.first == first; }
+    );
+    if (it == _playbackPages.end()) {
+        if (_playbackStreamFailed) {
+            return nullptr;
+        }
+
+        PlaybackPage page;
+        if (!loadPlaybackPage(first, page)) {
+            _playbackStreamFailed = true;
+            return nullptr;
+        }
+
+        if (_playbackPages.size() < MaxPlaybackPages) {
+            _playbackPages.push_back(std::move(page));
+            it = _playbackPages.end() - 1;
+        }
+        else {
+            // Replace the page that has not been used for the longest time
+            it = std::min_element(
+                _playbackPages.begin(),
+                _playbackPages.end(),
+                [](const PlaybackPage& lhs, const PlaybackPage& rhs) {
+                    return lhs.lastUsed < rhs.lastUsed;
+                }
+            );
+            *it = std::move(page);
+        }
+    }
+
+    it->lastUsed = ++_playbackPageAccess;
+    const size_t i = index - first;
+    return i < it->keyframes.size() ? &it->keyframes[i] : nullptr;
+}
+
+bool SessionRecording::loadPlaybackPage(size_t first, PlaybackPage& page) {
+    const size_t count = std::min(PlaybackPageSize, _playbackIndex->size() - first);
+    std::vector<SessionRecordingIndex::Entry> entries =
+        _playbackIndex->entries(first, count);
+    if (entries.size() != count) {
+        return false;
+    }
+
+    // Keyframes are stored consecutively in the recording, so the page can be read in
+    // one sweep starting at the first of its keyframes
+    _playbackFile.clear();
+    _playbackFile.seekg(entries.front().offset);
+
+    page.first = first;
+    page.keyframes.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const SessionRecordingIndex::Entry& e = entries[i];
+        const int lineNum = static_cast<int>(first + i) + 1;
+
+        char type = 0;
+        if (_recordingDataMode == DataMode::Binary) {
+            type = readFromPlayback<char>(_playbackFile);
+        }
+        else {
+            // Comments can be interspersed between the keyframes of ASCII recordings
+            std::string entryType;
+            while (entryType.empty() || entryType[0] == HeaderCommentAscii[0]) {
+                if (!std::getline(_playbackFile, _playbackLineParsing)) {
+                    break;
+                }
+                entryType.clear();
+                std::istringstream iss(_playbackLineParsing);
+                iss >> entryType;
+            }
+
+            if (entryType == HeaderCameraAscii) {
+                type = HeaderCameraBinary;
+            }
+            else if (entryType == HeaderTimeAscii) {
+                type = HeaderTimeBinary;
+            }
+            else if (entryType == HeaderScriptAscii) {
+                type = HeaderScriptBinary;
+            }
+        }
+        if (!_playbackFile || type != e.type) {
+            LERROR(fmt::format(
+                "Keyframe {} of playback file {} does not match its index",
+                lineNum, _playbackFilename
+            ));
+            return false;
+        }
+
+        PlaybackKeyframe& kf = page.keyframes[i];
+        Timestamps times;
+        bool success = false;
+        if (type == HeaderCameraBinary) {
+            datamessagestructures::CameraKeyframe cameraKf;
+            success = readSingleKeyframeCamera(
+                cameraKf,
+                times,
+                _recordingDataMode,
+                _playbackFile,
+                _playbackLineParsing,
+                lineNum
+            );
+            kf.entry.keyframeType = RecordedType::Camera;
+            kf.camera = interaction::KeyframeNavigator::CameraPose(std::move(cameraKf));
+        }
+        else if (type == HeaderTimeBinary) {
+            datamessagestructures::TimeKeyframe timeKf;
+            success = readSingleKeyframeTime(
+                timeKf,
+                times,
+                _recordingDataMode,
+                _playbackFile,
+                _playbackLineParsing,
+                lineNum
+            );
+            kf.entry.keyframeType = RecordedType::Time;
+        }
+        else {
+            datamessagestructures::ScriptMessage scriptKf;
+            success = readSingleKeyframeScript(
+                scriptKf,
+                times,
+                _recordingDataMode,
+                _playbackFile,
+                _playbackLineParsing,
+                lineNum
+            );
+            success = success && checkIfScriptUsesScenegraphNode(scriptKf._script);
+            kf.entry.keyframeType = RecordedType::Script;
+            kf.script = std::move(scriptKf._script);
+        }
+        if (!success) {
+            return false;
+        }
+        kf.entry.idxIntoKeyframeTypeArray = e.typeIndex;
+        kf.entry.t3stamps = times;
+    }
+    return true;
+}
+
+unsigned int SessionRecording::timelineIndexAtRecordedTime(double recordedTime) {
+    if (_playbackIndex) {
+        return static_cast<unsigned int>(_playbackIndex->lowerBound(
+            recordedTime,
+            &SessionRecordingIndex::Entry::timeRec
+        ));
     }
+
+    auto it = std::lower_bound(
+        _timeline.begin(),
+        _timeline.end(),
+        recordedTime,
+        [](const timelineEntry& entry, double t) { return entry.t3stamps.timeRec < t; }
+    );
+    return static_cast<unsigned int>(std::distance(_timeline.begin(), it));
 }
 
 void SessionRecording::saveKeyframeToFileBinary(unsigned char* buffer,
                                                 size_t size,
-                                                std::ofstream& file)
+                                                std::ostream& file)
 {
     file.write(reinterpret_cast<char*>(buffer), size);
 }
 
-void SessionRecording::saveKeyframeToFile(std::string entry, std::ofstream& file) {
+void SessionRecording::saveKeyframeToFile(std::string entry, std::ostream& file) {
     file << std::move(entry) << std::endl;
 }
 
@@ -2154,8 +2483,9 @@ std::vector<std::string> SessionRecording::playbackList() const {
 #else
             bool isHidden = filename.find(".") == 0;
 #endif // WIN32
-            if (!isHidden) {
-                // Don't add hidden files
+            bool isSpool = e.path().extension() == SessionRecordingWriter::SpoolExtension;
+            if (!isHidden && !isSpool) {
+                // Don't add hidden files or the spool files of recordings in progress
                 fileList.push_back(filename);
             }
         }
@@ -2217,6 +2547,19 @@ SessionRecording::DataMode SessionRecording::readModeFromHeader(std::string file
     return mode;
 }
 
+std::string SessionRecording::readVersionFromHeader(const std::string& filename) {
+    std::ifstream inputFile(filename, std::ifstream::in | std::ios::binary);
+    std::string readBackHeaderString = readHeaderElement(
+        inputFile,
+        FileHeaderTitle.length()
+    );
+    if (!inputFile || readBackHeaderString != FileHeaderTitle) {
+        return "";
+    }
+    std::string version = readHeaderElement(inputFile, FileHeaderVersionLength);
+    return inputFile ? version : "";
+}
+
 void SessionRecording::readFileIntoStringStream(std::string filename,
                                                 std::ifstream& inputFstream,
                                                 std::stringstream& stream)
@@ -2275,11 +2618,9 @@ std::string SessionRecording::convertFile(std::string filename, int depth)
         // version, then proceed with conversion from there.
         if (fileVersion.compare(fileFormatVersion()) != 0) {
             //conversionInStream.seekg(conversionInStream.beg);
+            // The result is kept as a full path, as it does not have to be located in
+            // the recordings folder
             newFilename = getLegacyConversionResult(filename, depth + 1);
-            removeTrailingPathSlashes(newFilename);
-            if (isPath(newFilename)) {
-                extractFilenameFromPath(newFilename);
-            }
             if (filename == newFilename) {
                 return filename;
             }
@@ -2324,7 +2665,7 @@ std::string SessionRecording::convertFile(std::string filename, int depth)
                 conversionOutFile << DataFormatAsciiTag;
             }
             conversionOutFile << '\n';
-            convertEntries(
+            const bool success = convertEntries(
                 newFilename,
                 conversionInStream,
                 mode,
@@ -2332,6 +2673,10 @@ std::string SessionRecording::convertFile(std::string filename, int depth)
                 conversionOutFile
             );
             conversionOutFile.close();
+            if (!success) {
+                LERROR(fmt::format("Conversion of file {} failed", newFilename));
+                return "";
+            }
         }
         conversionInFile.close();
     }
@@ -2484,6 +2829,7 @@ bool SessionRecording::convertEntries(std::string& inFilename,
 
 std::string SessionRecording::getLegacyConversionResult(std::string filename, int depth) {
     SessionRecording_legacy_0085 legacy;
+    legacy.setConversionDirectory(_conversionDirectory);
     return legacy.convertFile(filename, depth);
 }
 
@@ -2512,15 +2858,21 @@ std::string SessionRecording::targetFileFormatVersion() {
 std::string SessionRecording::determineConversionOutFilename(const std::string filename,
                                                              DataMode mode)
 {
-    std::string filenameSansExtension = filename;
     std::string fileExtension = (mode == DataMode::Binary) ?
         FileExtensionBinary : FileExtensionAscii;
 
-    if (filename.find_last_of(".") != std::string::npos) {
-        filenameSansExtension = filename.substr(0, filename.find_last_of("."));
-    }
+    // Only the name of the source file is used, as the source might be located anywhere
+    std::string filenameSansExtension = std::filesystem::path(filename).stem().string();
     filenameSansExtension += "_" + fileFormatVersion() + "-" + targetFileFormatVersion();
-    return absPath("${RECORDINGS}/" + filenameSansExtension + fileExtension).string();
+
+    const std::filesystem::path directory = _conversionDirectory.empty() ?
+        absPath("${RECORDINGS}") :
+        _conversionDirectory;
+    return (directory / (filenameSansExtension + fileExtension)).string();
+}
+
+void SessionRecording::setConversionDirectory(std::filesystem::path directory) {
+    _conversionDirectory = std::move(directory);
 }
 
 bool SessionRecording_legacy_0085::convertScript(std::stringstream& inStream,
@@ -2655,6 +3007,13 @@ scripting::LuaLibrary SessionRecording::luaLibrary() {
                 "bool",
                 "Pauses or resumes the playback progression through keyframes"
             },
+            {
+                "seekPlayback",
+                &luascriptfunctions::seekPlayback,
+                "number",
+                "Moves the playback in progress to the provided number of seconds since "
+                "the start of the recording"
+            },
             {
                 "togglePlaybackPause",
                 &luascriptfunctions::togglePlaybackPause,
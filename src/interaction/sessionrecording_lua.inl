@@ -142,6 +142,14 @@ int setPlaybackPause(lua_State* L) {
     return 0;
 }
 
+int seekPlayback(lua_State* L) {
+    ghoul::lua::checkArgumentsAndThrow(L, 1, "lua::seekPlayback");
+    const double recordedTime = ghoul::lua::value<double>(L);
+
+    global::sessionRecording->seekPlayback(recordedTime);
+    return 0;
+}
+
 int togglePlaybackPause(lua_State* L) {
     ghoul::lua::checkArgumentsAndThrow(L, 0, "lua::togglePlaybackPause");
     bool isPlaybackPaused = global::sessionRecording->isPlaybackPaused();
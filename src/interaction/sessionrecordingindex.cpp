@@ -0,0 +1,478 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <openspace/interaction/sessionrecordingindex.h>
+
+#include <openspace/interaction/sessionrecording.h>
+#include <openspace/network/messagestructures.h>
+#include <ghoul/filesystem/cachemanager.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace {
+    constexpr const char* _loggerCat = "SessionRecordingIndex";
+
+    constexpr const char IndexMagic[8] = { 'O', 'S', 'R', 'E', 'C', 'I', 'D', 'X' };
+
+    constexpr const char* IndexExtension = ".osrecidx";
+
+    // Header title, version, data format tag, and the terminating newline
+    const size_t RecordingHeaderSize = openspace::interaction::SessionRecording::
+        FileHeaderTitle.length() +
+        openspace::interaction::SessionRecording::FileHeaderVersionLength + 2;
+
+    using Entry = openspace::interaction::SessionRecordingIndex::Entry;
+
+    struct Trailer {
+        uint64_t nEntries = 0;
+        uint64_t recordingSize = 0;
+        int64_t recordingTime = 0;
+        uint32_t nCamera = 0;
+        uint32_t nTime = 0;
+        uint32_t nScript = 0;
+    };
+
+    template <typename T>
+    void writeValue(char*& p, T value) {
+        std::memcpy(p, &value, sizeof(T));
+        p += sizeof(T);
+    }
+
+    template <typename T>
+    T readValue(const char*& p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+
+    // The size and the modification time identify the version of a recording that an
+    // index was built for
+    bool recordingVersion(const std::filesystem::path& recording, uint64_t& size,
+                          int64_t& time)
+    {
+        std::error_code ec;
+        size = static_cast<uint64_t>(std::filesystem::file_size(recording, ec));
+        if (ec) {
+            return false;
+        }
+        const std::filesystem::file_time_type t =
+            std::filesystem::last_write_time(recording, ec);
+        time = static_cast<int64_t>(t.time_since_epoch().count());
+        return !ec;
+    }
+
+    void writeIndex(std::ostream& out, const std::vector<Entry>& entries,
+                    uint64_t recordingSize, int64_t recordingTime)
+    {
+        using SR = openspace::interaction::SessionRecording;
+        using SRI = openspace::interaction::SessionRecordingIndex;
+
+        Trailer trailer;
+        trailer.nEntries = entries.size();
+        trailer.recordingSize = recordingSize;
+        trailer.recordingTime = recordingTime;
+
+        std::vector<char> buffer(entries.size() * SRI::EntrySize + SRI::TrailerSize);
+        char* p = buffer.data();
+        for (const Entry& e : entries) {
+            writeValue(p, e.timeOs);
+            writeValue(p, e.timeRec);
+            writeValue(p, e.timeSim);
+            writeValue(p, e.offset);
+            writeValue(p, e.typeIndex);
+            writeValue(p, e.type);
+
+            trailer.nCamera += (e.type == SR::HeaderCameraBinary) ? 1 : 0;
+            trailer.nTime += (e.type == SR::HeaderTimeBinary) ? 1 : 0;
+            trailer.nScript += (e.type == SR::HeaderScriptBinary) ? 1 : 0;
+        }
+        writeValue(p, trailer.nEntries);
+        writeValue(p, trailer.recordingSize);
+        writeValue(p, trailer.recordingTime);
+        writeValue(p, trailer.nCamera);
+        writeValue(p, trailer.nTime);
+        writeValue(p, trailer.nScript);
+        std::memcpy(p, IndexMagic, sizeof(IndexMagic));
+
+        out.write(buffer.data(), buffer.size());
+    }
+
+    bool scanBinaryRecording(std::ifstream& file, std::vector<Entry>& entries) {
+        using namespace openspace::datamessagestructures;
+        using SR = openspace::interaction::SessionRecording;
+
+        uint32_t counts[3] = { 0, 0, 0 };
+        while (true) {
+            Entry e;
+            e.offset = static_cast<uint64_t>(file.tellg());
+            file.read(&e.type, sizeof(char));
+            if (!file) {
+                // Reached the end of the recording
+                return true;
+            }
+            file.read(reinterpret_cast<char*>(&e.timeOs), sizeof(double));
+            file.read(reinterpret_cast<char*>(&e.timeRec), sizeof(double));
+            file.read(reinterpret_cast<char*>(&e.timeSim), sizeof(double));
+
+            if (e.type == SR::HeaderCameraBinary) {
+                CameraKeyframe kf;
+                kf.read(&file);
+                e.typeIndex = counts[0]++;
+            }
+            else if (e.type == SR::HeaderTimeBinary) {
+                TimeKeyframe kf;
+                kf.read(&file);
+                e.typeIndex = counts[1]++;
+            }
+            else if (e.type == SR::HeaderScriptBinary) {
+                ScriptMessage kf;
+                kf.read(&file);
+                e.typeIndex = counts[2]++;
+            }
+            else {
+                LERROR(fmt::format(
+                    "Unknown frame type {} @ index {}", e.type, entries.size()
+                ));
+                return false;
+            }
+
+            if (!file) {
+                LERROR(fmt::format("Truncated keyframe @ index {}", entries.size()));
+                return false;
+            }
+            entries.push_back(e);
+        }
+    }
+
+    bool scanAsciiRecording(std::ifstream& file, std::vector<Entry>& entries) {
+        using SR = openspace::interaction::SessionRecording;
+
+        uint32_t counts[3] = { 0, 0, 0 };
+        std::string line;
+        int lineNum = 1;
+        while (true) {
+            Entry e;
+            e.offset = static_cast<uint64_t>(file.tellg());
+            if (!std::getline(file, line)) {
+                return true;
+            }
+            lineNum++;
+
+            std::istringstream iss(line);
+            std::string entryType;
+            if (!(iss >> entryType)) {
+                // Playback stops at the first empty line, so the index does as well
+                return true;
+            }
+
+            if (entryType == SR::HeaderCameraAscii) {
+                e.type = SR::HeaderCameraBinary;
+                e.typeIndex = counts[0]++;
+            }
+            else if (entryType == SR::HeaderTimeAscii) {
+                e.type = SR::HeaderTimeBinary;
+                e.typeIndex = counts[1]++;
+            }
+            else if (entryType == SR::HeaderScriptAscii) {
+                e.type = SR::HeaderScriptBinary;
+                e.typeIndex = counts[2]++;
+            }
+            else if (entryType.substr(0, 1) == SR::HeaderCommentAscii) {
+                continue;
+            }
+            else {
+                LERROR(fmt::format(
+                    "Unknown frame type {} @ line {}", entryType, lineNum
+                ));
+                return false;
+            }
+
+            if (!(iss >> e.timeOs >> e.timeRec >> e.timeSim)) {
+                LERROR(fmt::format("Error parsing timestamps @ line {}", lineNum));
+                return false;
+            }
+            entries.push_back(e);
+        }
+    }
+} // namespace
+
+namespace openspace::interaction {
+
+std::unique_ptr<SessionRecordingIndex> SessionRecordingIndex::load(
+                                                   const std::filesystem::path& recording)
+{
+    uint64_t recordingSize = 0;
+    int64_t recordingTime = 0;
+    if (!recordingVersion(recording, recordingSize, recordingTime)) {
+        return nullptr;
+    }
+
+    const std::filesystem::path path = cachePath(recording);
+    if (path.empty()) {
+        return nullptr;
+    }
+    std::error_code ec;
+    const uintmax_t indexSize = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return nullptr;
+    }
+    auto index = std::unique_ptr<SessionRecordingIndex>(new SessionRecordingIndex);
+    if (index->open(path, indexSize, recordingSize, recordingTime)) {
+        return index;
+    }
+    LWARNING(fmt::format("Ignoring outdated index {} of {}", path, recording));
+    return nullptr;
+}
+
+bool SessionRecordingIndex::build(const std::filesystem::path& recording) {
+    std::ifstream header(recording, std::ios::binary);
+    std::string headerString(RecordingHeaderSize, '\0');
+    header.read(headerString.data(), RecordingHeaderSize);
+    if (!header || headerString.find(SessionRecording::FileHeaderTitle) != 0) {
+        LERROR(fmt::format("File {} is not a session recording", recording));
+        return false;
+    }
+    header.close();
+    const bool isBinary = headerString[RecordingHeaderSize - 2] ==
+        SessionRecording::DataFormatBinaryTag;
+
+    std::vector<Entry> entries;
+    try {
+        if (isBinary) {
+            std::ifstream file(recording, std::ios::binary);
+            file.seekg(RecordingHeaderSize);
+            if (!scanBinaryRecording(file, entries)) {
+                LERROR(fmt::format("Unable to index session recording {}", recording));
+                return false;
+            }
+        }
+        else {
+            // Use the same mode in which playback opens ASCII recordings, so that the
+            // stored offsets are valid positions for that stream
+            std::ifstream file(recording);
+            std::string headerLine;
+            std::getline(file, headerLine);
+            if (!scanAsciiRecording(file, entries)) {
+                LERROR(fmt::format("Unable to index session recording {}", recording));
+                return false;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        LERROR(fmt::format(
+            "Unable to index session recording {}: {}", recording, e.what()
+        ));
+        return false;
+    }
+
+    const bool success = save(recording, entries);
+    if (success) {
+        LINFO(fmt::format(
+            "Built index with {} entries for session recording {}",
+            entries.size(), recording
+        ));
+    }
+    return success;
+}
+
+bool SessionRecordingIndex::save(const std::filesystem::path& recording,
+                                 const std::vector<Entry>& entries)
+{
+    uint64_t recordingSize = 0;
+    int64_t recordingTime = 0;
+    if (!recordingVersion(recording, recordingSize, recordingTime)) {
+        LERROR(fmt::format("Unable to index missing recording {}", recording));
+        return false;
+    }
+
+    const std::filesystem::path path = cachePath(recording);
+    if (path.empty()) {
+        LERROR(fmt::format("No cache directory to store the index of {}", recording));
+        return false;
+    }
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    std::error_code ec;
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        writeIndex(out, entries, recordingSize, recordingTime);
+        if (!out.good()) {
+            LERROR(fmt::format("Unable to write index {}", tmp));
+            out.close();
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        LERROR(fmt::format("Unable to move index {} to {}", tmp, path));
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+std::filesystem::path SessionRecordingIndex::cachePath(
+                                                   const std::filesystem::path& recording)
+{
+    if (!FileSys.cacheManager()) {
+        return std::filesystem::path();
+    }
+
+    std::filesystem::path res = FileSys.cacheManager()->cachedFilename(
+        std::filesystem::absolute(recording),
+        "SessionRecordingIndex"
+    );
+    res += IndexExtension;
+    return res;
+}
+
+bool SessionRecordingIndex::open(const std::filesystem::path& file, uint64_t fileSize,
+                                 uint64_t recordingSize, int64_t recordingTime)
+{
+    if (fileSize < TrailerSize) {
+        return false;
+    }
+
+    _file.open(file, std::ios::binary);
+    _file.seekg(fileSize - TrailerSize);
+    std::vector<char> buffer(TrailerSize);
+    _file.read(buffer.data(), TrailerSize);
+    if (!_file || std::memcmp(buffer.data() + TrailerSize - sizeof(IndexMagic),
+                              IndexMagic, sizeof(IndexMagic)) != 0)
+    {
+        return false;
+    }
+
+    const char* p = buffer.data();
+    Trailer trailer;
+    trailer.nEntries = readValue<uint64_t>(p);
+    trailer.recordingSize = readValue<uint64_t>(p);
+    trailer.recordingTime = readValue<int64_t>(p);
+    trailer.nCamera = readValue<uint32_t>(p);
+    trailer.nTime = readValue<uint32_t>(p);
+    trailer.nScript = readValue<uint32_t>(p);
+
+    // Reject indices that do not belong to the recording in its current form
+    const bool isValid =
+        trailer.recordingSize == recordingSize &&
+        trailer.recordingTime == recordingTime &&
+        trailer.nEntries == static_cast<uint64_t>(trailer.nCamera) + trailer.nTime +
+                            trailer.nScript &&
+        trailer.nEntries * EntrySize + TrailerSize == fileSize;
+    if (!isValid) {
+        return false;
+    }
+
+    _nEntries = trailer.nEntries;
+    _nCamera = trailer.nCamera;
+    _nTime = trailer.nTime;
+    _nScript = trailer.nScript;
+    return true;
+}
+
+size_t SessionRecordingIndex::size() const {
+    return static_cast<size_t>(_nEntries);
+}
+
+size_t SessionRecordingIndex::numEntries(char type) const {
+    switch (type) {
+        case SessionRecording::HeaderCameraBinary:
+            return _nCamera;
+        case SessionRecording::HeaderTimeBinary:
+            return _nTime;
+        case SessionRecording::HeaderScriptBinary:
+            return _nScript;
+        default:
+            return 0;
+    }
+}
+
+SessionRecordingIndex::Entry SessionRecordingIndex::entry(size_t i) {
+    ghoul_assert(i < _nEntries, "Index out of range");
+
+    const size_t block = i / BlockSize;
+    if (block != _cachedBlock) {
+        const size_t first = block * BlockSize;
+        _blockCache = entries(first, std::min<size_t>(BlockSize, size() - first));
+        _cachedBlock = block;
+    }
+
+    const size_t idx = i % BlockSize;
+    return idx < _blockCache.size() ? _blockCache[idx] : Entry();
+}
+
+std::vector<SessionRecordingIndex::Entry> SessionRecordingIndex::entries(size_t first,
+                                                                         size_t count)
+{
+    ghoul_assert(first + count <= _nEntries, "Index out of range");
+
+    std::vector<char> buffer(count * EntrySize);
+    _file.clear();
+    _file.seekg(first * EntrySize);
+    _file.read(buffer.data(), buffer.size());
+    if (!_file) {
+        LERROR(fmt::format("Unable to read {} index entries at {}", count, first));
+        return std::vector<Entry>();
+    }
+
+    std::vector<Entry> res(count);
+    const char* p = buffer.data();
+    for (Entry& e : res) {
+        e.timeOs = readValue<double>(p);
+        e.timeRec = readValue<double>(p);
+        e.timeSim = readValue<double>(p);
+        e.offset = readValue<uint64_t>(p);
+        e.typeIndex = readValue<uint32_t>(p);
+        e.type = readValue<char>(p);
+    }
+    return res;
+}
+
+size_t SessionRecordingIndex::lowerBound(double time, double Entry::* timestamp) {
+    size_t first = 0;
+    size_t count = size();
+    while (count > 0) {
+        const size_t step = count / 2;
+        const size_t mid = first + step;
+        if (entry(mid).*timestamp < time) {
+            first = mid + 1;
+            count -= step + 1;
+        }
+        else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+} // namespace openspace::interaction
@@ -0,0 +1,284 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/interaction/sessionrecordingwriter.h>
+
+#include <openspace/engine/globals.h>
+#include <openspace/interaction/sessionrecording.h>
+#include <openspace/util/taskscheduler.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif // WIN32
+
+namespace {
+    constexpr const char* _loggerCat = "SessionRecordingWriter";
+
+    // Size of the chunks in which the spooled keyframes are copied into the recording
+    constexpr const size_t CopyChunkSize = 1024 * 1024;
+
+    bool syncToDisk(std::FILE* file) {
+        if (std::fflush(file) != 0) {
+            return false;
+        }
+#ifdef WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif // WIN32
+    }
+} // namespace
+
+namespace openspace::interaction {
+
+SessionRecordingWriter::SessionRecordingWriter(std::filesystem::path recording,
+                                               size_t blockSize, size_t nBlocks)
+    : _recording(std::move(recording))
+    , _blockSize(blockSize)
+{
+    ghoul_assert(blockSize > 0, "Block size must be positive");
+    ghoul_assert(nBlocks >= 2, "Need at least two blocks");
+
+    _spoolPath = _recording;
+    _spoolPath += SpoolExtension;
+    _spool = std::fopen(_spoolPath.string().c_str(), "w+b");
+    if (!_spool) {
+        LERROR(fmt::format("Unable to create spool file {}", _spoolPath));
+        return;
+    }
+
+    _currentBlock.reserve(_blockSize);
+    _freeBlocks.resize(nBlocks - 1);
+    for (std::vector<char>& block : _freeBlocks) {
+        block.reserve(_blockSize);
+    }
+    _isStopped = false;
+}
+
+SessionRecordingWriter::~SessionRecordingWriter() {
+    if (!_isStopped) {
+        stopWriting();
+    }
+    closeSpool();
+}
+
+bool SessionRecordingWriter::isOpen() const {
+    return _spool != nullptr;
+}
+
+bool SessionRecordingWriter::append(SessionRecordingIndex::Entry entry,
+                                    std::string_view keyframe)
+{
+    ghoul_assert(!_isStopped, "Writer is not open or already finished");
+
+    if (!_currentBlock.empty() && _currentBlock.size() + keyframe.size() > _blockSize) {
+        // Camera keyframes are created every frame, so it is better to lose one of them
+        // than to stall the frame until a block has been written
+        const bool canWait = entry.type != SessionRecording::HeaderCameraBinary;
+        if (!submitCurrentBlock(canWait)) {
+            _nDropped++;
+            return false;
+        }
+    }
+
+    entry.offset = _dataSize;
+    _entries.push_back(entry);
+    _currentBlock.insert(_currentBlock.end(), keyframe.begin(), keyframe.end());
+    _dataSize += keyframe.size();
+    _nKeyframes++;
+    return true;
+}
+
+bool SessionRecordingWriter::finish(
+                                  std::string_view prefix,
+                                  std::vector<SessionRecordingIndex::Entry> prefixEntries)
+{
+    ghoul_assert(!_isStopped, "Writer is not open or already finished");
+
+    stopWriting();
+    if (_hasError) {
+        closeSpool();
+        return false;
+    }
+
+    // The offsets of the appended keyframes are relative to the start of the spool file
+    // and the type indices have to account for the keyframes in the prefix
+    std::vector<SessionRecordingIndex::Entry> entries = std::move(prefixEntries);
+    entries.reserve(entries.size() + _entries.size());
+    for (SessionRecordingIndex::Entry e : _entries) {
+        e.offset += prefix.size();
+        entries.push_back(e);
+    }
+    _entries = std::vector<SessionRecordingIndex::Entry>();
+    uint32_t nCamera = 0;
+    uint32_t nTime = 0;
+    uint32_t nScript = 0;
+    for (SessionRecordingIndex::Entry& e : entries) {
+        switch (e.type) {
+            case SessionRecording::HeaderCameraBinary:
+                e.typeIndex = nCamera++;
+                break;
+            case SessionRecording::HeaderTimeBinary:
+                e.typeIndex = nTime++;
+                break;
+            case SessionRecording::HeaderScriptBinary:
+                e.typeIndex = nScript++;
+                break;
+        }
+    }
+
+    std::FILE* out = std::fopen(_recording.string().c_str(), "wb");
+    if (!out) {
+        LERROR(fmt::format("Unable to open file {} for keyframe recording", _recording));
+        closeSpool();
+        return false;
+    }
+
+    bool success = std::fwrite(prefix.data(), 1, prefix.size(), out) == prefix.size();
+    std::rewind(_spool);
+    std::vector<char> buffer(CopyChunkSize);
+    while (success) {
+        const size_t n = std::fread(buffer.data(), 1, buffer.size(), _spool);
+        if (n == 0) {
+            success = std::ferror(_spool) == 0;
+            break;
+        }
+        success = std::fwrite(buffer.data(), 1, n, out) == n;
+    }
+
+    success = success && syncToDisk(out);
+    success = (std::fclose(out) == 0) && success;
+    closeSpool();
+
+    if (!success) {
+        LERROR(fmt::format("Error writing session recording {}", _recording));
+        return false;
+    }
+    SessionRecordingIndex::save(_recording, entries);
+    return true;
+}
+
+SessionRecordingWriter::Stats SessionRecordingWriter::stats() const {
+    std::lock_guard lock(_mutex);
+    Stats res;
+    res.nKeyframes = _nKeyframes;
+    res.nDropped = _nDropped;
+    res.nBlocksWritten = _nBlocksWritten;
+    res.nBlocksLate = _nBlocksLate;
+    res.bytesWritten = _bytesWritten;
+    return res;
+}
+
+bool SessionRecordingWriter::submitCurrentBlock(bool canWait) {
+    std::unique_lock lock(_mutex);
+    if (_freeBlocks.empty()) {
+        _nBlocksLate++;
+        if (!canWait) {
+            return false;
+        }
+        _hasFreeBlock.wait(lock, [this]() { return !_freeBlocks.empty(); });
+    }
+
+    _fullBlocks.push_back(std::move(_currentBlock));
+    _currentBlock = std::move(_freeBlocks.back());
+    _freeBlocks.pop_back();
+    startWriting();
+    return true;
+}
+
+void SessionRecordingWriter::startWriting() {
+    // Has to be called with the mutex locked. A single task writes all blocks that are
+    // waiting, so that they end up in the spool file in the order they were submitted
+    if (_isWriting) {
+        return;
+    }
+    _isWriting = true;
+    global::taskScheduler->enqueue(
+        [this]() { writeBlocks(); },
+        TaskScheduler::Priority::IO
+    );
+}
+
+void SessionRecordingWriter::stopWriting() {
+    std::unique_lock lock(_mutex);
+    if (!_currentBlock.empty()) {
+        _fullBlocks.push_back(std::move(_currentBlock));
+        _currentBlock = std::vector<char>();
+        startWriting();
+    }
+    _isIdle.wait(lock, [this]() { return !_isWriting; });
+    _isStopped = true;
+}
+
+void SessionRecordingWriter::closeSpool() {
+    if (!_spool) {
+        return;
+    }
+
+    std::fclose(_spool);
+    _spool = nullptr;
+    std::error_code ec;
+    std::filesystem::remove(_spoolPath, ec);
+}
+
+void SessionRecordingWriter::writeBlocks() {
+    std::unique_lock lock(_mutex);
+    while (!_fullBlocks.empty()) {
+        std::vector<char> block = std::move(_fullBlocks.front());
+        _fullBlocks.pop_front();
+        const bool hadError = _hasError;
+
+        lock.unlock();
+        // Flushing after each block keeps the keyframes on disk in case the application
+        // terminates before the recording is finished
+        const bool success = !hadError &&
+            std::fwrite(block.data(), 1, block.size(), _spool) == block.size() &&
+            std::fflush(_spool) == 0;
+        lock.lock();
+
+        if (success) {
+            _nBlocksWritten++;
+            _bytesWritten += block.size();
+        }
+        else if (!hadError) {
+            LERROR(fmt::format("Error writing to spool file {}", _spoolPath));
+            _hasError = true;
+        }
+        block.clear();
+        _freeBlocks.push_back(std::move(block));
+        _hasFreeBlock.notify_one();
+    }
+
+    // The notification has to happen under the lock as the writer might be destroyed as
+    // soon as the waiting thread sees that no blocks are being written anymore
+    _isWriting = false;
+    _isIdle.notify_all();
+}
+
+} // namespace openspace::interaction
@@ -0,0 +1,565 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/interaction/tasks/convertrecdirectorytask.h>
+
+#include <openspace/documentation/verifier.h>
+#include <openspace/engine/globals.h>
+#include <openspace/interaction/sessionrecording.h>
+#include <openspace/interaction/sessionrecordingindex.h>
+#include <openspace/util/taskscheduler.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+    constexpr const char* _loggerCat = "ConvertRecDirectoryTask";
+
+    constexpr const char* KeyInDirectory = "InputDirectory";
+    constexpr const char* KeyOutDirectory = "OutputDirectory";
+    constexpr const char* KeySummaryFile = "SummaryFilePath";
+    constexpr const char* KeyOverwrite = "Overwrite";
+
+    // Folder in the output directory that holds the intermediate results of version
+    // conversions while they are in progress
+    constexpr const char* ConversionFolder = ".conversion";
+
+    // Number of the slowest recordings that are listed in the summary
+    constexpr const size_t NumSlowestRecordings = 5;
+
+    using openspace::interaction::ConversionError;
+    using openspace::interaction::SessionRecording;
+    using openspace::interaction::SessionRecordingIndex;
+
+    enum class Status {
+        Converted = 0,
+        Skipped,
+        Failed
+    };
+
+    struct Result {
+        std::filesystem::path input;
+        std::filesystem::path output;
+        Status status = Status::Failed;
+        std::string version;
+        size_t nKeyframes = 0;
+        double seconds = 0.0;
+        std::string error;
+    };
+
+    bool isInDirectory(const std::filesystem::path& path,
+                       const std::filesystem::path& directory)
+    {
+        const std::filesystem::path rel = path.lexically_relative(directory);
+        return !rel.empty() && *rel.begin() != "..";
+    }
+
+    bool readHeader(std::ifstream& file, std::string& version,
+                    SessionRecording::DataMode& mode)
+    {
+        const std::string title = SessionRecording::readHeaderElement(
+            file,
+            SessionRecording::FileHeaderTitle.length()
+        );
+        if (!file || title != SessionRecording::FileHeaderTitle) {
+            return false;
+        }
+        version = SessionRecording::readHeaderElement(
+            file,
+            SessionRecording::FileHeaderVersionLength
+        );
+        const std::string dataMode = SessionRecording::readHeaderElement(file, 1);
+        // Read to throw out newline at end of header
+        SessionRecording::readHeaderElement(file, 1);
+        if (!file) {
+            return false;
+        }
+
+        if (dataMode[0] == SessionRecording::DataFormatAsciiTag) {
+            mode = SessionRecording::DataMode::Ascii;
+        }
+        else if (dataMode[0] == SessionRecording::DataFormatBinaryTag) {
+            mode = SessionRecording::DataMode::Binary;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+    // Parses every keyframe of the recording at source, which has to be of the current
+    // file format version, writes them to output in binary format, and saves the index
+    // of output to the cache. Returns the number of keyframes
+    size_t writeIndexedRecording(SessionRecording& sessRec,
+                                 const std::filesystem::path& source,
+                                 const std::filesystem::path& output)
+    {
+        using namespace openspace::datamessagestructures;
+
+        std::ifstream in(source, std::ifstream::in | std::ifstream::binary);
+        std::string version;
+        SessionRecording::DataMode mode;
+        if (!readHeader(in, version, mode)) {
+            throw ConversionError(fmt::format("File {} has no valid header", source));
+        }
+        if (version != sessRec.fileFormatVersion()) {
+            throw ConversionError(fmt::format(
+                "File {} has version {} instead of {} after conversion",
+                source, version, sessRec.fileFormatVersion()
+            ));
+        }
+
+        std::filesystem::path tmp = output;
+        tmp += ".tmp";
+        std::ofstream out(tmp, std::ios::binary);
+        if (!out.good()) {
+            throw ConversionError(fmt::format("Unable to open file {} for writing", tmp));
+        }
+        out << SessionRecording::FileHeaderTitle;
+        out.write(version.c_str(), SessionRecording::FileHeaderVersionLength);
+        out << SessionRecording::DataFormatBinaryTag << '\n';
+
+        SessionRecording::Timestamps times;
+        CameraKeyframe ckf;
+        TimeKeyframe tkf;
+        ScriptMessage skf;
+        unsigned char keyframeBuffer[SessionRecording::_saveBufferMaxSize_bytes];
+        std::vector<SessionRecordingIndex::Entry> entries;
+        uint32_t nKeyframesPerType[3] = { 0, 0, 0 };
+        int lineNum = 1;
+        std::string line;
+        while (true) {
+            char type = 0;
+            bool isValid = false;
+            if (mode == SessionRecording::DataMode::Binary) {
+                type = static_cast<char>(
+                    openspace::interaction::readFromPlayback<unsigned char>(in)
+                );
+                if (!in) {
+                    break;
+                }
+
+                if (type == SessionRecording::HeaderCameraBinary) {
+                    isValid = sessRec.readCameraKeyframeBinary(times, ckf, in, lineNum);
+                }
+                else if (type == SessionRecording::HeaderTimeBinary) {
+                    isValid = sessRec.readTimeKeyframeBinary(times, tkf, in, lineNum);
+                }
+                else if (type == SessionRecording::HeaderScriptBinary) {
+                    isValid = sessRec.readScriptKeyframeBinary(times, skf, in, lineNum);
+                }
+                else {
+                    throw ConversionError(fmt::format(
+                        "Unknown frame type {} @ index {}", static_cast<int>(type),
+                        lineNum - 1
+                    ));
+                }
+            }
+            else {
+                if (!std::getline(in, line)) {
+                    break;
+                }
+                lineNum++;
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+
+                std::istringstream iss(line);
+                std::string entryType;
+                if (!(iss >> entryType) ||
+                    entryType.substr(0, 1) == SessionRecording::HeaderCommentAscii)
+                {
+                    continue;
+                }
+
+                if (entryType == SessionRecording::HeaderCameraAscii) {
+                    type = SessionRecording::HeaderCameraBinary;
+                    isValid = sessRec.readCameraKeyframeAscii(times, ckf, line, lineNum);
+                }
+                else if (entryType == SessionRecording::HeaderTimeAscii) {
+                    type = SessionRecording::HeaderTimeBinary;
+                    isValid = sessRec.readTimeKeyframeAscii(times, tkf, line, lineNum);
+                }
+                else if (entryType == SessionRecording::HeaderScriptAscii) {
+                    type = SessionRecording::HeaderScriptBinary;
+                    isValid = sessRec.readScriptKeyframeAscii(times, skf, line, lineNum);
+                }
+                else {
+                    throw ConversionError(fmt::format(
+                        "Unknown frame type {} @ line {}", entryType, lineNum
+                    ));
+                }
+            }
+            if (!isValid) {
+                throw ConversionError(
+                    fmt::format("Invalid keyframe @ entry {}", lineNum)
+                );
+            }
+
+            SessionRecordingIndex::Entry e;
+            e.timeOs = times.timeOs;
+            e.timeRec = times.timeRec;
+            e.timeSim = times.timeSim;
+            e.offset = static_cast<uint64_t>(out.tellp());
+            e.type = type;
+            if (type == SessionRecording::HeaderCameraBinary) {
+                e.typeIndex = nKeyframesPerType[0]++;
+                sessRec.saveCameraKeyframeBinary(times, ckf, keyframeBuffer, out);
+            }
+            else if (type == SessionRecording::HeaderTimeBinary) {
+                e.typeIndex = nKeyframesPerType[1]++;
+                sessRec.saveTimeKeyframeBinary(times, tkf, keyframeBuffer, out);
+            }
+            else {
+                if (skf._script.size() > SessionRecording::saveBufferStringSize_max) {
+                    throw ConversionError(fmt::format(
+                        "Script @ entry {} exceeds the maximum length of {}",
+                        lineNum, SessionRecording::saveBufferStringSize_max
+                    ));
+                }
+                e.typeIndex = nKeyframesPerType[2]++;
+                sessRec.saveScriptKeyframeBinary(times, skf, keyframeBuffer, out);
+            }
+            entries.push_back(e);
+
+            if (mode == SessionRecording::DataMode::Binary) {
+                lineNum++;
+            }
+        }
+
+        out.close();
+        if (!out) {
+            throw ConversionError(fmt::format("Error writing file {}", tmp));
+        }
+        std::filesystem::rename(tmp, output);
+        SessionRecordingIndex::save(output, entries);
+        return entries.size();
+    }
+
+    Result convertRecording(const std::filesystem::path& input,
+                            const std::filesystem::path& output,
+                            const std::filesystem::path& workDirectory)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        Result res;
+        res.input = input;
+        res.output = output;
+        SessionRecording sessRec(false);
+        try {
+            std::ifstream in(input, std::ifstream::in | std::ifstream::binary);
+            SessionRecording::DataMode mode;
+            if (!readHeader(in, res.version, mode)) {
+                throw ConversionError("File does not contain a session recording header");
+            }
+            in.close();
+
+            std::filesystem::path source = input;
+            if (res.version != sessRec.fileFormatVersion()) {
+                // Older recordings go through the same legacy converters as in playback,
+                // with the intermediate files in a folder used only by this recording
+                std::filesystem::create_directories(workDirectory);
+                sessRec.setConversionDirectory(workDirectory);
+                source = sessRec.getLegacyConversionResult(input.string(), 1);
+                if (source.empty() || source == input ||
+                    !std::filesystem::is_regular_file(source))
+                {
+                    throw ConversionError(fmt::format(
+                        "Conversion from version {} failed", res.version
+                    ));
+                }
+            }
+
+            std::filesystem::create_directories(output.parent_path());
+            res.nKeyframes = writeIndexedRecording(sessRec, source, output);
+            res.status = Status::Converted;
+        }
+        catch (const ConversionError& e) {
+            res.error = e.message;
+        }
+        catch (const std::exception& e) {
+            res.error = e.what();
+        }
+
+        std::error_code ec;
+        std::filesystem::remove_all(workDirectory, ec);
+        if (res.status == Status::Failed) {
+            std::filesystem::path tmp = output;
+            tmp += ".tmp";
+            std::filesystem::remove(tmp, ec);
+        }
+
+        res.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        return res;
+    }
+
+    std::string csvField(const std::string& value) {
+        std::string res = "\"";
+        for (char c : value) {
+            res += c;
+            if (c == '"') {
+                res += '"';
+            }
+        }
+        return res + "\"";
+    }
+
+    void writeSummary(const std::filesystem::path& file,
+                      const std::vector<Result>& results)
+    {
+        std::ofstream out(file);
+        if (!out.good()) {
+            LERROR(fmt::format("Unable to write summary file {}", file));
+            return;
+        }
+
+        out << "Input,Output,Status,Version,Keyframes,Seconds,Error\n";
+        for (const Result& r : results) {
+            std::string status;
+            switch (r.status) {
+                case Status::Converted: status = "Converted"; break;
+                case Status::Skipped:   status = "Skipped";   break;
+                case Status::Failed:    status = "Failed";    break;
+            }
+            out << csvField(r.input.string()) << ',' << csvField(r.output.string())
+                << ',' << status << ',' << csvField(r.version) << ',' << r.nKeyframes
+                << ',' << fmt::format("{:.3f}", r.seconds) << ',' << csvField(r.error)
+                << '\n';
+        }
+    }
+} // namespace
+
+namespace openspace::interaction {
+
+ConvertRecDirectoryTask::ConvertRecDirectoryTask(const ghoul::Dictionary& dictionary) {
+    openspace::documentation::testSpecificationAndThrow(
+        documentation(),
+        dictionary,
+        "ConvertRecDirectoryTask"
+    );
+
+    _inDirectory = absPath(dictionary.value<std::string>(KeyInDirectory));
+    _outDirectory = absPath(dictionary.value<std::string>(KeyOutDirectory));
+    if (dictionary.hasValue<std::string>(KeySummaryFile)) {
+        _summaryFile = absPath(dictionary.value<std::string>(KeySummaryFile));
+    }
+    if (dictionary.hasValue<bool>(KeyOverwrite)) {
+        _overwrite = dictionary.value<bool>(KeyOverwrite);
+    }
+}
+
+std::string ConvertRecDirectoryTask::description() {
+    return fmt::format(
+        "Convert all session recordings in {} to the current file format version in "
+        "binary format and write them to {}",
+        _inDirectory, _outDirectory
+    );
+}
+
+void ConvertRecDirectoryTask::perform(const Task::ProgressCallback& progressCallback) {
+    progressCallback(0.f);
+    const auto start = std::chrono::steady_clock::now();
+
+    if (!std::filesystem::is_directory(_inDirectory)) {
+        LERROR(fmt::format("Input directory {} does not exist", _inDirectory));
+        return;
+    }
+
+    std::vector<std::filesystem::path> inputs;
+    namespace fs = std::filesystem;
+    for (const fs::directory_entry& e : fs::recursive_directory_iterator(_inDirectory)) {
+        const std::filesystem::path extension = e.path().extension();
+        const bool isRecording = extension == SessionRecording::FileExtensionBinary ||
+            extension == SessionRecording::FileExtensionAscii;
+        // Don't pick up our own results if the output is located inside the input
+        if (e.is_regular_file() && isRecording &&
+            !isInDirectory(e.path(), _outDirectory))
+        {
+            inputs.push_back(e.path());
+        }
+    }
+    std::sort(inputs.begin(), inputs.end());
+
+    // The output mirrors the input directory structure, but recordings in both formats
+    // end up with the same extension and might collide
+    std::vector<Result> results(inputs.size());
+    std::map<std::filesystem::path, size_t> outputs;
+    std::vector<size_t> jobs;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        Result& r = results[i];
+        r.input = inputs[i];
+        r.output = _outDirectory / inputs[i].lexically_relative(_inDirectory);
+        r.output.replace_extension(SessionRecording::FileExtensionBinary);
+
+        auto it = outputs.find(r.output);
+        if (it != outputs.end()) {
+            r.error = fmt::format(
+                "Output file {} is already used for {}", r.output, inputs[it->second]
+            );
+            continue;
+        }
+        outputs[r.output] = i;
+
+        if (!_overwrite && std::filesystem::exists(r.output)) {
+            r.status = Status::Skipped;
+            continue;
+        }
+        jobs.push_back(i);
+    }
+    LINFO(fmt::format(
+        "Converting {} of {} session recordings in {}",
+        jobs.size(), inputs.size(), _inDirectory
+    ));
+
+    const std::filesystem::path workDirectory = _outDirectory / ConversionFolder;
+    std::mutex progressMutex;
+    size_t nFinished = 0;
+    {
+        // The conversions spend most of their time reading and writing files, so they are
+        // executed on the IO threads of the scheduler
+        TaskGroup group(*global::taskScheduler, TaskScheduler::Priority::IO);
+        for (size_t i : jobs) {
+            group.run([&, i]() {
+                results[i] = convertRecording(
+                    results[i].input,
+                    results[i].output,
+                    workDirectory / std::to_string(i)
+                );
+
+                std::lock_guard lock(progressMutex);
+                nFinished++;
+                progressCallback(static_cast<float>(nFinished) / jobs.size());
+            });
+        }
+        group.wait();
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(workDirectory, ec);
+
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+
+    size_t nConverted = 0;
+    size_t nSkipped = 0;
+    size_t nFailed = 0;
+    size_t nKeyframes = 0;
+    double conversionSeconds = 0.0;
+    for (const Result& r : results) {
+        switch (r.status) {
+            case Status::Converted:
+                nConverted++;
+                nKeyframes += r.nKeyframes;
+                break;
+            case Status::Skipped:
+                nSkipped++;
+                break;
+            case Status::Failed:
+                nFailed++;
+                LERROR(fmt::format("Failed to convert {}: {}", r.input, r.error));
+                break;
+        }
+        conversionSeconds += r.seconds;
+    }
+
+    std::vector<const Result*> slowest;
+    for (const Result& r : results) {
+        if (r.status == Status::Converted) {
+            slowest.push_back(&r);
+        }
+    }
+    std::sort(
+        slowest.begin(),
+        slowest.end(),
+        [](const Result* lhs, const Result* rhs) { return lhs->seconds > rhs->seconds; }
+    );
+    slowest.resize(std::min(slowest.size(), NumSlowestRecordings));
+    for (const Result* r : slowest) {
+        LINFO(fmt::format(
+            "Converted {} with {} keyframes in {:.3f} s", r->input, r->nKeyframes,
+            r->seconds
+        ));
+    }
+
+    LINFO(fmt::format(
+        "Converted {} session recordings with {} keyframes, skipped {}, failed {}. "
+        "Took {:.3f} s, {:.3f} s spent converting", nConverted, nKeyframes, nSkipped,
+        nFailed, seconds, conversionSeconds
+    ));
+
+    if (!_summaryFile.empty()) {
+        writeSummary(_summaryFile, results);
+    }
+    progressCallback(1.f);
+}
+
+documentation::Documentation ConvertRecDirectoryTask::documentation() {
+    using namespace documentation;
+    return {
+        "ConvertRecDirectoryTask",
+        "convert_directory_task",
+        {
+            {
+                KeyInDirectory,
+                new StringAnnotationVerifier("A valid directory"),
+                Optional::No,
+                "The directory that is searched recursively for session recordings to "
+                "convert.",
+            },
+            {
+                KeyOutDirectory,
+                new StringAnnotationVerifier("A valid directory"),
+                Optional::No,
+                "The directory that the converted recordings are written to, using the "
+                "same directory structure as in the input directory.",
+            },
+            {
+                KeySummaryFile,
+                new StringAnnotationVerifier("A valid filename"),
+                Optional::Yes,
+                "If this value is specified, a CSV file with the result and the time "
+                "taken for each recording is written to this file.",
+            },
+            {
+                KeyOverwrite,
+                new BoolVerifier,
+                Optional::Yes,
+                "If this value is true, recordings that already exist in the output "
+                "directory are converted again. Otherwise they are skipped, which makes "
+                "it possible to resume an interrupted conversion.",
+            },
+        },
+    };
+}
+
+} // namespace openspace::interaction
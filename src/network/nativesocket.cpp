@@ -0,0 +1,314 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/network/nativesocket.h>
+
+#include <mutex>
+
+#ifdef WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else // ^^^ WIN32 / !WIN32 vvv
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif // WIN32
+
+namespace {
+#ifdef WIN32
+    using NativeHandle = SOCKET;
+    using PollFd = WSAPOLLFD;
+
+    void initializeNetworkApi() {
+        static std::once_flag initialized;
+        std::call_once(initialized, []() {
+            WSADATA data;
+            WSAStartup(MAKEWORD(2, 2), &data);
+        });
+    }
+
+    bool wouldBlock() {
+        const int error = WSAGetLastError();
+        return error == WSAEWOULDBLOCK || error == WSAEINTR;
+    }
+
+    void closeHandle(NativeHandle handle) {
+        closesocket(handle);
+    }
+
+    bool setNonBlocking(NativeHandle handle) {
+        u_long mode = 1;
+        return ioctlsocket(handle, FIONBIO, &mode) == 0;
+    }
+
+    int pollHandles(PollFd* fds, size_t n, int timeout) {
+        return WSAPoll(fds, static_cast<ULONG>(n), timeout);
+    }
+
+    constexpr int SendFlags = 0;
+#else // ^^^ WIN32 / !WIN32 vvv
+    using NativeHandle = int;
+    using PollFd = pollfd;
+
+    void initializeNetworkApi() {}
+
+    bool wouldBlock() {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+
+    void closeHandle(NativeHandle handle) {
+        ::close(handle);
+    }
+
+    bool setNonBlocking(NativeHandle handle) {
+        const int flags = fcntl(handle, F_GETFL, 0);
+        return flags != -1 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    int pollHandles(PollFd* fds, size_t n, int timeout) {
+        return ::poll(fds, static_cast<nfds_t>(n), timeout);
+    }
+
+#ifdef MSG_NOSIGNAL
+    constexpr int SendFlags = MSG_NOSIGNAL;
+#else // ^^^ MSG_NOSIGNAL / !MSG_NOSIGNAL vvv
+    constexpr int SendFlags = 0;
+#endif // MSG_NOSIGNAL
+#endif // WIN32
+
+    NativeHandle toNative(openspace::NativeSocket::Handle handle) {
+        return static_cast<NativeHandle>(handle);
+    }
+
+    // Small messages such as camera keyframes should go out immediately rather than
+    // being held back until more data is available
+    void configureConnection(NativeHandle handle) {
+        int flag = 1;
+        setsockopt(
+            handle,
+            IPPROTO_TCP,
+            TCP_NODELAY,
+            reinterpret_cast<const char*>(&flag),
+            sizeof(int)
+        );
+#ifdef SO_NOSIGPIPE
+        setsockopt(
+            handle,
+            SOL_SOCKET,
+            SO_NOSIGPIPE,
+            reinterpret_cast<const char*>(&flag),
+            sizeof(int)
+        );
+#endif // SO_NOSIGPIPE
+    }
+} // namespace
+
+namespace openspace {
+
+NativeSocket NativeSocket::listen(int port) {
+    initializeNetworkApi();
+
+    NativeHandle handle = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    NativeSocket res = NativeSocket(static_cast<Handle>(handle));
+    if (!res.isValid()) {
+        return NativeSocket();
+    }
+
+    int flag = 1;
+    setsockopt(
+        handle,
+        SOL_SOCKET,
+        SO_REUSEADDR,
+        reinterpret_cast<const char*>(&flag),
+        sizeof(int)
+    );
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    const bool success =
+        ::bind(handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+        ::listen(handle, SOMAXCONN) == 0 &&
+        setNonBlocking(handle);
+    return success ? std::move(res) : NativeSocket();
+}
+
+NativeSocket NativeSocket::connect(const std::string& address, int port) {
+    initializeNetworkApi();
+
+    NativeHandle handle = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    NativeSocket res = NativeSocket(static_cast<Handle>(handle));
+    if (!res.isValid()) {
+        return NativeSocket();
+    }
+
+    sockaddr_in remote = {};
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address.c_str(), &remote.sin_addr) != 1) {
+        return NativeSocket();
+    }
+    const bool success =
+        ::connect(handle, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) == 0 &&
+        setNonBlocking(handle);
+    if (!success) {
+        return NativeSocket();
+    }
+    configureConnection(handle);
+    return res;
+}
+
+int NativeSocket::poll(std::vector<PollItem>& items, int timeout) {
+    // The array is kept between calls as it is needed in every iteration of an event
+    // loop and always has about the same size
+    thread_local std::vector<PollFd> fds;
+    fds.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        fds[i].fd = toNative(items[i].socket->handle());
+        fds[i].events = 0;
+        fds[i].revents = 0;
+        if (items[i].events & Readable) {
+            fds[i].events |= POLLIN;
+        }
+        if (items[i].events & Writable) {
+            fds[i].events |= POLLOUT;
+        }
+    }
+
+    const int res = pollHandles(fds.data(), fds.size(), timeout);
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i].revents = 0;
+        if (res <= 0) {
+            continue;
+        }
+        // A closed connection is signalled as readable, as receiving is where the
+        // closing is detected
+        if (fds[i].revents & (POLLIN | POLLHUP)) {
+            items[i].revents |= Readable;
+        }
+        if (fds[i].revents & POLLOUT) {
+            items[i].revents |= Writable;
+        }
+        if (fds[i].revents & (POLLERR | POLLNVAL)) {
+            items[i].revents |= Error;
+        }
+    }
+    return res;
+}
+
+NativeSocket::NativeSocket(Handle handle)
+    : _handle(handle)
+{}
+
+NativeSocket::NativeSocket(NativeSocket&& other) noexcept
+    : _handle(other._handle)
+{
+    other._handle = InvalidHandle;
+}
+
+NativeSocket& NativeSocket::operator=(NativeSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        _handle = other._handle;
+        other._handle = InvalidHandle;
+    }
+    return *this;
+}
+
+NativeSocket::~NativeSocket() {
+    close();
+}
+
+bool NativeSocket::isValid() const {
+    return _handle != InvalidHandle;
+}
+
+NativeSocket::Handle NativeSocket::handle() const {
+    return _handle;
+}
+
+NativeSocket NativeSocket::accept(std::string& address) {
+    sockaddr_in remote = {};
+    socklen_t length = sizeof(remote);
+    NativeHandle handle = ::accept(
+        toNative(_handle),
+        reinterpret_cast<sockaddr*>(&remote),
+        &length
+    );
+    NativeSocket res = NativeSocket(static_cast<Handle>(handle));
+    if (!res.isValid() || !setNonBlocking(handle)) {
+        return NativeSocket();
+    }
+    configureConnection(handle);
+
+    char buffer[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &remote.sin_addr, buffer, INET_ADDRSTRLEN);
+    address = buffer;
+    return res;
+}
+
+std::ptrdiff_t NativeSocket::send(const char* data, size_t size) {
+    const auto res = ::send(toNative(_handle), data, static_cast<int>(size), SendFlags);
+    if (res < 0) {
+        return wouldBlock() ? 0 : -1;
+    }
+    return static_cast<std::ptrdiff_t>(res);
+}
+
+std::ptrdiff_t NativeSocket::receive(char* data, size_t size) {
+    const auto res = ::recv(toNative(_handle), data, static_cast<int>(size), 0);
+    if (res == 0) {
+        // An orderly shutdown of the remote end
+        return -1;
+    }
+    if (res < 0) {
+        return wouldBlock() ? 0 : -1;
+    }
+    return static_cast<std::ptrdiff_t>(res);
+}
+
+void NativeSocket::setReceiveBufferSize(int size) {
+    setsockopt(
+        toNative(_handle),
+        SOL_SOCKET,
+        SO_RCVBUF,
+        reinterpret_cast<const char*>(&size),
+        sizeof(int)
+    );
+}
+
+void NativeSocket::close() {
+    if (isValid()) {
+        closeHandle(toNative(_handle));
+        _handle = InvalidHandle;
+    }
+}
+
+} // namespace openspace
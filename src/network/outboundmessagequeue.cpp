@@ -0,0 +1,101 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/network/outboundmessagequeue.h>
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+
+namespace openspace {
+
+OutboundMessageQueue::OutboundMessageQueue(size_t maxBytes)
+    : _maxBytes(maxBytes)
+{}
+
+bool OutboundMessageQueue::push(Message message, IsSupersedable isSupersedable) {
+    ghoul_assert(message, "Message must not be nullptr");
+
+    if (isSupersedable) {
+        // Every push removes the previous supersedable message, so there is at most one
+        // waiting that has not been started. The first message might have been sent
+        // partially, in which case it has to be completed
+        const auto begin = _frontOffset > 0 ? _entries.begin() + 1 : _entries.begin();
+        const auto it = std::find_if(
+            begin,
+            _entries.end(),
+            [](const Entry& e) { return e.isSupersedable; }
+        );
+        if (it != _entries.end()) {
+            _nBytes -= it->message->size();
+            _entries.erase(it);
+            _nSuperseded++;
+        }
+    }
+
+    if (!_entries.empty() && _nBytes + message->size() > _maxBytes) {
+        return false;
+    }
+
+    _nBytes += message->size();
+    _entries.push_back({ std::move(message), isSupersedable });
+    return true;
+}
+
+std::string_view OutboundMessageQueue::front() const {
+    if (_entries.empty()) {
+        return std::string_view();
+    }
+
+    const std::vector<char>& message = *_entries.front().message;
+    return std::string_view(
+        message.data() + _frontOffset,
+        message.size() - _frontOffset
+    );
+}
+
+void OutboundMessageQueue::pop(size_t nBytes) {
+    ghoul_assert(!_entries.empty(), "Queue must not be empty");
+    ghoul_assert(nBytes <= front().size(), "Popping more bytes than available");
+
+    _frontOffset += nBytes;
+    _nBytes -= nBytes;
+    if (_frontOffset == _entries.front().message->size()) {
+        _entries.pop_front();
+        _frontOffset = 0;
+    }
+}
+
+bool OutboundMessageQueue::isEmpty() const {
+    return _entries.empty();
+}
+
+size_t OutboundMessageQueue::nBytes() const {
+    return _nBytes;
+}
+
+size_t OutboundMessageQueue::nSuperseded() const {
+    return _nSuperseded;
+}
+
+} // namespace openspace
@@ -90,36 +90,37 @@ void ParallelConnection::sendDataMessage(const DataMessage& dataMessage) {
 }
 
 bool ParallelConnection::sendMessage(const Message& message) {
+    const std::vector<char> data = encodeMessage(message);
+    return _socket->put<char>(data.data(), data.size());
+}
+
+std::vector<char> ParallelConnection::encodeMessage(const Message& message) {
     const uint32_t messageTypeOut = static_cast<uint32_t>(message.type);
     const uint32_t messageSizeOut = static_cast<uint32_t>(message.content.size());
-    std::vector<char> header;
+    std::vector<char> data;
+    data.reserve(HeaderSize + message.content.size());
 
     //insert header into buffer
-    header.push_back('O');
-    header.push_back('S');
+    data.push_back('O');
+    data.push_back('S');
 
-    header.insert(header.end(),
+    data.insert(data.end(),
         reinterpret_cast<const char*>(&ProtocolVersion),
         reinterpret_cast<const char*>(&ProtocolVersion) + sizeof(uint32_t)
     );
 
-    header.insert(header.end(),
+    data.insert(data.end(),
         reinterpret_cast<const char*>(&messageTypeOut),
         reinterpret_cast<const char*>(&messageTypeOut) + sizeof(uint32_t)
     );
 
-    header.insert(header.end(),
+    data.insert(data.end(),
         reinterpret_cast<const char*>(&messageSizeOut),
         reinterpret_cast<const char*>(&messageSizeOut) + sizeof(uint32_t)
     );
 
-    if (!_socket->put<char>(header.data(), header.size())) {
-        return false;
-    }
-    if (!_socket->put<char>(message.content.data(), message.content.size())) {
-        return false;
-    }
-    return true;
+    data.insert(data.end(), message.content.begin(), message.content.end());
+    return data;
 }
 
 void ParallelConnection::disconnect() {
@@ -133,11 +134,6 @@ ghoul::io::TcpSocket* ParallelConnection::socket() {
 }
 
 ParallelConnection::Message ParallelConnection::receiveMessage() {
-    // Header consists of...
-    constexpr size_t HeaderSize =
-        2 * sizeof(char) + // OS
-        3 * sizeof(uint32_t); // Protocol version, message type and message size
-
     // Create basic buffer for receiving first part of messages
     std::vector<char> headerBuffer(HeaderSize);
     std::vector<char> messageBuffer;
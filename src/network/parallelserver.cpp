@@ -25,28 +25,70 @@
 #include <openspace/network/parallelserver.h>
 
 #include <ghoul/fmt.h>
-#include <ghoul/io/socket/tcpsocket.h>
 #include <ghoul/logging/logmanager.h>
+#include <array>
+#include <cstring>
 #include <functional>
-
-// @TODO(abock): In the entire class remove std::shared_ptr<Peer> by const Peer& where
-//               possible to simplify the interface
+#include <sstream>
 
 namespace {
     constexpr const char* _loggerCat = "ParallelServer";
+
+    // The time in milliseconds that the event loop waits for a socket to become ready
+    // before checking whether the server should stop
+    constexpr int PollTimeout = 100;
+
+    // The number of bytes that can wait to be sent to a single peer before the peer is
+    // considered to be unable to keep up and is disconnected. Camera keyframes are
+    // superseded while waiting, so this is only reached if a peer stalls completely
+    constexpr size_t MaxQueuedBytes = 16 * 1024 * 1024;
+
+    // Messages larger than this are considered to be a corrupted stream
+    constexpr uint32_t MaxMessageSize = 64 * 1024 * 1024;
+
+    // The number of bytes that are read from a single peer before the other peers are
+    // served, so that a peer that sends a lot of data cannot starve the others
+    constexpr size_t ReceiveBudget = 1024 * 1024;
+
+    bool isCameraKeyframe(std::string_view content) {
+        using namespace openspace::datamessagestructures;
+
+        if (content.size() < sizeof(uint32_t)) {
+            return false;
+        }
+        uint32_t type;
+        std::memcpy(&type, content.data(), sizeof(uint32_t));
+        return type == static_cast<uint32_t>(Type::CameraData);
+    }
 } // namespace
 
 namespace openspace {
 
-void ParallelServer::start(int port, const std::string& password,
+ParallelServer::Peer::Peer(size_t id_, NativeSocket socket_, std::string address_)
+    : id(id_)
+    , address(std::move(address_))
+    , socket(std::move(socket_))
+    , outputQueue(MaxQueuedBytes)
+{}
+
+ParallelServer::~ParallelServer() {
+    stop();
+}
+
+bool ParallelServer::start(int port, const std::string& password,
                            const std::string& changeHostPassword)
 {
-    _socketServer.listen(port);
+    _listenSocket = NativeSocket::listen(port);
+    if (!_listenSocket.isValid()) {
+        LERROR(fmt::format("Unable to listen on port {}", port));
+        return false;
+    }
     _passwordHash = std::hash<std::string>{}(password);
     _changeHostPasswordHash = std::hash<std::string>{}(changeHostPassword);
 
-    _serverThread = std::thread([this](){ handleNewPeers(); });
+    _shouldStop = false;
     _eventLoopThread = std::thread([this]() { eventLoop(); });
+    return true;
 }
 
 void ParallelServer::setDefaultHostAddress(std::string defaultHostAddress) {
@@ -61,100 +103,216 @@ std::string ParallelServer::defaultHostAddress() const {
 
 void ParallelServer::stop() {
     _shouldStop = true;
-    _socketServer.close();
+    if (_eventLoopThread.joinable()) {
+        _eventLoopThread.join();
+    }
 }
 
-void ParallelServer::handleNewPeers() {
+void ParallelServer::eventLoop() {
+    std::vector<NativeSocket::PollItem> items;
+    std::vector<Peer*> polledPeers;
     while (!_shouldStop) {
-        std::unique_ptr<ghoul::io::TcpSocket> s = _socketServer.awaitPendingTcpSocket();
+        items.clear();
+        polledPeers.clear();
+        items.push_back({ &_listenSocket, NativeSocket::Readable });
+        for (std::pair<const size_t, std::unique_ptr<Peer>>& it : _peers) {
+            Peer& p = *it.second;
+            int events = NativeSocket::Readable;
+            if (!p.outputQueue.isEmpty()) {
+                events |= NativeSocket::Writable;
+            }
+            items.push_back({ &p.socket, events });
+            polledPeers.push_back(&p);
+        }
+
+        const int nReady = NativeSocket::poll(items, PollTimeout);
+        if (nReady < 0) {
+            LERROR("Error while waiting for connections");
+            break;
+        }
+        if (nReady == 0) {
+            continue;
+        }
 
-        s->startStreams();
+        if (items[0].revents & NativeSocket::Readable) {
+            acceptPeers();
+        }
+        for (size_t i = 0; i < polledPeers.size(); ++i) {
+            Peer& p = *polledPeers[i];
+            const int revents = items[i + 1].revents;
+            // Errors are detected when trying to receive from the socket
+            if (revents & (NativeSocket::Readable | NativeSocket::Error)) {
+                receive(p);
+            }
+            if ((revents & NativeSocket::Writable) && !p.isDisconnected) {
+                flush(p);
+            }
+        }
+        removeDisconnectedPeers();
+    }
+
+    _peers.clear();
+    _listenSocket.close();
+    _nConnections = 0;
+}
+
+void ParallelServer::acceptPeers() {
+    while (true) {
+        std::string address;
+        NativeSocket s = _listenSocket.accept(address);
+        if (!s.isValid()) {
+            return;
+        }
 
         const size_t id = _nextConnectionId++;
-        std::shared_ptr<Peer> p = std::make_shared<Peer>(Peer{
-            id,
-            "",
-            ParallelConnection(std::move(s)),
-            ParallelConnection::Status::Connecting,
-            std::thread()
-        });
-        auto it = _peers.emplace(p->id, p);
-        it.first->second->thread = std::thread([this, id]() { handlePeer(id); });
+        _peers.emplace(id, std::make_unique<Peer>(id, std::move(s), std::move(address)));
     }
 }
 
-std::shared_ptr<ParallelServer::Peer> ParallelServer::peer(size_t id) {
-    std::lock_guard lock(_peerListMutex);
+ParallelServer::Peer* ParallelServer::peer(size_t id) {
     const auto it = _peers.find(id);
     if (it == _peers.end()) {
         return nullptr;
     }
-    return it->second;
+    return it->second.get();
 }
 
-void ParallelServer::handlePeer(size_t id) {
-    while (!_shouldStop) {
-        std::shared_ptr<Peer> p = peer(id);
-        if (!p) {
-            return;
+void ParallelServer::receive(Peer& peer) {
+    std::array<char, 16 * 1024> buffer;
+    size_t nReceived = 0;
+    while (nReceived < ReceiveBudget) {
+        const std::ptrdiff_t n = peer.socket.receive(buffer.data(), buffer.size());
+        if (n < 0) {
+            // The messages that arrived before the connection was closed are still
+            // handled, the peer is disconnected afterwards
+            peer.isLost = true;
+            break;
+        }
+        if (n == 0) {
+            break;
         }
+        peer.inputBuffer.insert(peer.inputBuffer.end(), buffer.data(), buffer.data() + n);
+        nReceived += n;
+    }
 
-        if (!p->parallelConnection.isConnectedOrConnecting()) {
+    constexpr size_t HeaderSize = ParallelConnection::HeaderSize;
+    size_t offset = 0;
+    while (!peer.isDisconnected && peer.inputBuffer.size() - offset >= HeaderSize) {
+        const char* header = peer.inputBuffer.data() + offset;
+        if (!(header[0] == 'O' && header[1] == 'S')) {
+            LERROR(fmt::format(
+                "Expected to read message header 'OS' from connection {}", peer.id
+            ));
+            disconnect(peer);
             return;
         }
-        try {
-            ParallelConnection::Message m = p->parallelConnection.receiveMessage();
-            PeerMessage msg;
-            msg.peerId = id;
-            msg.message = m;
-            _incomingMessages.push(msg);
+
+        uint32_t protocolVersion = 0;
+        std::memcpy(&protocolVersion, header + 2, sizeof(uint32_t));
+        if (protocolVersion != ParallelConnection::ProtocolVersion) {
+            LERROR(fmt::format(
+                "Protocol versions do not match. Remote version: {}, Local version: {}",
+                protocolVersion, ParallelConnection::ProtocolVersion
+            ));
+            disconnect(peer);
+            return;
         }
-        catch (const ParallelConnection::ConnectionLostError&) {
-            LERROR(fmt::format("Connection lost to {}", p->id));
-            PeerMessage msg;
-            msg.peerId = id;
-            msg.message = ParallelConnection::Message(
-                ParallelConnection::MessageType::Disconnection, std::vector<char>()
-            );
-            _incomingMessages.push(msg);
+
+        uint32_t type = 0;
+        std::memcpy(&type, header + 2 + sizeof(uint32_t), sizeof(uint32_t));
+        uint32_t size = 0;
+        std::memcpy(&size, header + 2 + 2 * sizeof(uint32_t), sizeof(uint32_t));
+        if (size > MaxMessageSize) {
+            LERROR(fmt::format(
+                "Message of {} bytes from connection {} is too large", size, peer.id
+            ));
+            disconnect(peer);
             return;
         }
+        if (peer.inputBuffer.size() - offset < HeaderSize + size) {
+            // The rest of the message has not arrived yet
+            break;
+        }
+
+        handlePeerMessage(
+            peer,
+            static_cast<ParallelConnection::MessageType>(type),
+            std::string_view(header, HeaderSize + size)
+        );
+        offset += HeaderSize + size;
+    }
+    if (!peer.isDisconnected) {
+        peer.inputBuffer.erase(
+            peer.inputBuffer.begin(),
+            peer.inputBuffer.begin() + offset
+        );
     }
 }
 
-void ParallelServer::eventLoop() {
-    while (!_shouldStop) {
-        PeerMessage pm = _incomingMessages.pop();
-        handlePeerMessage(std::move(pm));
+void ParallelServer::flush(Peer& peer) {
+    while (!peer.outputQueue.isEmpty()) {
+        const std::string_view data = peer.outputQueue.front();
+        const std::ptrdiff_t n = peer.socket.send(data.data(), data.size());
+        if (n < 0) {
+            // The peer is disconnected after the current message has been handled, as
+            // this might be called while the peers are being iterated over
+            peer.isLost = true;
+            return;
+        }
+        if (n == 0) {
+            // The socket is full, the rest is sent once it becomes writable again
+            return;
+        }
+        peer.outputQueue.pop(static_cast<size_t>(n));
     }
 }
 
-void ParallelServer::handlePeerMessage(PeerMessage peerMessage) {
-    const size_t peerId = peerMessage.peerId;
-    auto it = _peers.find(peerId);
-    if (it == _peers.end()) {
-        return;
+void ParallelServer::removeDisconnectedPeers() {
+    // Disconnecting a peer notifies the other peers, which might reveal more lost
+    // connections
+    bool hasLostPeers = true;
+    while (hasLostPeers) {
+        hasLostPeers = false;
+        for (std::pair<const size_t, std::unique_ptr<Peer>>& it : _peers) {
+            Peer& p = *it.second;
+            if (p.isLost && !p.isDisconnected) {
+                LERROR(fmt::format("Connection lost to {}", p.id));
+                disconnect(p);
+                hasLostPeers = true;
+            }
+        }
     }
 
-    std::shared_ptr<Peer>& peer = it->second;
+    for (auto it = _peers.begin(); it != _peers.end();) {
+        if (it->second->isDisconnected) {
+            it = _peers.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
 
-    const ParallelConnection::MessageType type = peerMessage.message.type;
-    std::vector<char>& data = peerMessage.message.content;
+void ParallelServer::handlePeerMessage(Peer& peer, ParallelConnection::MessageType type,
+                                       std::string_view encodedMessage)
+{
+    const std::string_view content =
+        encodedMessage.substr(ParallelConnection::HeaderSize);
     switch (type) {
         case ParallelConnection::MessageType::Authentication:
-            handleAuthentication(peer, std::move(data));
+            handleAuthentication(peer, content);
             break;
         case ParallelConnection::MessageType::Data:
-            handleData(*peer, std::move(data));
+            handleData(peer, encodedMessage);
             break;
         case ParallelConnection::MessageType::HostshipRequest:
-            handleHostshipRequest(peer, std::move(data));
+            handleHostshipRequest(peer, content);
             break;
         case ParallelConnection::MessageType::HostshipResignation:
-            handleHostshipResignation(*peer);
+            handleHostshipResignation(peer);
             break;
         case ParallelConnection::MessageType::Disconnection:
-            disconnect(*peer);
+            disconnect(peer);
             break;
         default:
             LERROR(fmt::format("Unsupported message type: {}", static_cast<int>(type)));
@@ -162,9 +320,7 @@ void ParallelServer::handlePeerMessage(PeerMessage peerMessage) {
     }
 }
 
-void ParallelServer::handleAuthentication(std::shared_ptr<Peer> peer,
-                                          std::vector<char> message)
-{
+void ParallelServer::handleAuthentication(Peer& peer, std::string_view message) {
     std::stringstream input(std::string(message.begin(), message.end()));
 
     // 8 bytes passcode
@@ -172,8 +328,8 @@ void ParallelServer::handleAuthentication(std::shared_ptr<Peer> peer,
     input.read(reinterpret_cast<char*>(&passwordHash), sizeof(uint64_t));
 
     if (passwordHash != _passwordHash) {
-        LERROR(fmt::format("Connection {} provided incorrect passcode.", peer->id));
-        disconnect(*peer);
+        LERROR(fmt::format("Connection {} provided incorrect passcode.", peer.id));
+        disconnect(peer);
         return;
     }
 
@@ -183,77 +339,81 @@ void ParallelServer::handleAuthentication(std::shared_ptr<Peer> peer,
 
     // <nameSize> bytes name
     std::string name(nameSize, static_cast<char>(0));
-    input.read(&name[0], nameSize);
+    input.read(name.data(), nameSize);
 
     if (nameSize == 0) {
         name = "Anonymous";
     }
 
-    setName(*peer, name);
+    setName(peer, name);
 
-    LINFO(fmt::format("Connection established with {} ('{}')", peer->id, name));
+    LINFO(fmt::format("Connection established with {} ('{}')", peer.id, name));
 
     std::string defaultHostAddress;
     {
         std::lock_guard _hostMutex(_hostInfoMutex);
         defaultHostAddress = _defaultHostAddress;
     }
-    if (_hostPeerId == 0 &&
-        peer->parallelConnection.socket()->address() == defaultHostAddress)
-    {
+    if (_hostPeerId == 0 && peer.address == defaultHostAddress) {
         // Directly promote the conenction to host (initialize) if there is no host, and
-        // ip matches default host ip.
-        LINFO(fmt::format("Connection {} directly promoted to host", peer->id));
+        // ip matches default host ip. This sends the new status to all peers
+        LINFO(fmt::format("Connection {} directly promoted to host", peer.id));
         assignHost(peer);
-        for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
-            // sendConnectionStatus(it->second) ?
-            sendConnectionStatus(*peer);
-        }
     }
     else {
-        setToClient(*peer);
+        setToClient(peer);
     }
 
     setNConnections(nConnections() + 1);
 }
 
-void ParallelServer::handleData(const Peer& peer, std::vector<char> data) {
+void ParallelServer::handleData(const Peer& peer, std::string_view encodedMessage) {
     if (peer.id != _hostPeerId) {
         LINFO(fmt::format(
             "Ignoring connection {} trying to send data without being host", peer.id
         ));
+        return;
+    }
+
+    // The message is forwarded as it was received and its encoding is shared between
+    // the queues of all clients
+    const OutboundMessageQueue::Message message =
+        std::make_shared<const std::vector<char>>(
+            encodedMessage.begin(),
+            encodedMessage.end()
+        );
+    const OutboundMessageQueue::IsSupersedable isSupersedable =
+        OutboundMessageQueue::IsSupersedable(
+            isCameraKeyframe(encodedMessage.substr(ParallelConnection::HeaderSize))
+        );
+    for (std::pair<const size_t, std::unique_ptr<Peer>>& it : _peers) {
+        if (it.second->status == ParallelConnection::Status::ClientWithHost) {
+            sendEncodedMessage(*it.second, message, isSupersedable);
+        }
     }
-    sendMessageToClients(ParallelConnection::MessageType::Data, data);
 }
 
-void ParallelServer::handleHostshipRequest(std::shared_ptr<Peer> peer,
-                                           std::vector<char> message)
-{
+void ParallelServer::handleHostshipRequest(Peer& peer, std::string_view message) {
     std::stringstream input(std::string(message.begin(), message.end()));
 
-    LINFO(fmt::format("Connection {} requested hostship", peer->id));
+    LINFO(fmt::format("Connection {} requested hostship", peer.id));
 
     uint64_t passwordHash = 0;
     input.read(reinterpret_cast<char*>(&passwordHash), sizeof(uint64_t));
 
     if (passwordHash != _changeHostPasswordHash) {
-        LERROR(fmt::format("Connection {} provided incorrect host password", peer->id));
+        LERROR(fmt::format("Connection {} provided incorrect host password", peer.id));
         return;
     }
 
-    size_t oldHostPeerId = 0;
-    {
-        std::lock_guard lock(_hostInfoMutex);
-        oldHostPeerId = _hostPeerId;
-    }
-
-    if (oldHostPeerId == peer->id) {
-        LINFO(fmt::format("Connection {} is already the host", peer->id));
+    const size_t oldHostPeerId = _hostPeerId;
+    if (oldHostPeerId == peer.id) {
+        LINFO(fmt::format("Connection {} is already the host", peer.id));
         return;
     }
 
     assignHost(peer);
-    LINFO(fmt::format("Switched host from {} to {}", oldHostPeerId, peer->id));
+    LINFO(fmt::format("Switched host from {} to {}", oldHostPeerId, peer.id));
 }
 
 void ParallelServer::handleHostshipResignation(Peer& peer) {
@@ -272,88 +432,111 @@ bool ParallelServer::isConnected(const Peer& peer) const {
 void ParallelServer::sendMessage(Peer& peer, ParallelConnection::MessageType messageType,
                                  const std::vector<char>& message)
 {
-    peer.parallelConnection.sendMessage({ messageType, message });
+    sendEncodedMessage(
+        peer,
+        std::make_shared<const std::vector<char>>(
+            ParallelConnection::encodeMessage({ messageType, message })
+        ),
+        OutboundMessageQueue::IsSupersedable::No
+    );
 }
 
 void ParallelServer::sendMessageToAll(ParallelConnection::MessageType messageType,
                                       const std::vector<char>& message)
 {
-    for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
+    const OutboundMessageQueue::Message m = std::make_shared<const std::vector<char>>(
+        ParallelConnection::encodeMessage({ messageType, message })
+    );
+    for (std::pair<const size_t, std::unique_ptr<Peer>>& it : _peers) {
         if (isConnected(*it.second)) {
-            it.second->parallelConnection.sendMessage({ messageType, message });
+            sendEncodedMessage(*it.second, m, OutboundMessageQueue::IsSupersedable::No);
         }
     }
 }
 
-void ParallelServer::sendMessageToClients(ParallelConnection::MessageType messageType,
-                                          const std::vector<char>& message)
+void ParallelServer::sendEncodedMessage(Peer& peer,
+                                    OutboundMessageQueue::Message message,
+                                    OutboundMessageQueue::IsSupersedable isSupersedable)
 {
-    for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
-        if (it.second->status == ParallelConnection::Status::ClientWithHost) {
-            it.second->parallelConnection.sendMessage({ messageType, message });
-        }
+    if (peer.isDisconnected || peer.isLost) {
+        return;
+    }
+
+    const bool wasEmpty = peer.outputQueue.isEmpty();
+    const size_t nSuperseded = peer.outputQueue.nSuperseded();
+    if (!peer.outputQueue.push(std::move(message), isSupersedable)) {
+        LWARNING(fmt::format(
+            "Disconnecting {} ('{}') as it does not keep up with the messages",
+            peer.id, peer.name
+        ));
+        _nOverflows++;
+        peer.isLost = true;
+        return;
+    }
+    _nSupersededKeyframes += peer.outputQueue.nSuperseded() - nSuperseded;
+    if (peer.outputQueue.nBytes() > _maxQueuedBytes) {
+        _maxQueuedBytes = peer.outputQueue.nBytes();
+    }
+
+    // If messages are waiting already, the socket is full and the new message is sent
+    // once the socket becomes writable
+    if (wasEmpty) {
+        flush(peer);
     }
 }
 
 void ParallelServer::disconnect(Peer& peer) {
-    if (isConnected(peer)) {
-        setNConnections(nConnections() - 1);
+    if (peer.isDisconnected) {
+        return;
     }
+    // Marking the peer first prevents any of the following messages to be sent to it
+    peer.isDisconnected = true;
 
-    size_t hostPeerId = 0;
-    {
-        std::lock_guard lock(_hostInfoMutex);
-        hostPeerId = _hostPeerId;
+    if (isConnected(peer)) {
+        setNConnections(nConnections() - 1);
     }
 
     // Make sure any disconnecting host is first degraded to client, in order to notify
     // other clients about host disconnection.
-    if (peer.id == hostPeerId) {
+    if (peer.id == _hostPeerId) {
         setToClient(peer);
     }
 
-    peer.parallelConnection.disconnect();
-    peer.thread.join();
-    _peers.erase(peer.id);
+    peer.status = ParallelConnection::Status::Disconnected;
+    peer.socket.close();
 }
 
 void ParallelServer::setName(Peer& peer, std::string name) {
     peer.name = std::move(name);
-    size_t hostPeerId = 0;
-    {
-        std::lock_guard lock(_hostInfoMutex);
-        hostPeerId = _hostPeerId;
-    }
 
     // Make sure everyone gets the new host name.
-    if (peer.id == hostPeerId) {
+    if (peer.id == _hostPeerId) {
         {
             std::lock_guard lock(_hostInfoMutex);
             _hostName = peer.name;
         }
 
-        for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
-            // sendConnectionStatus(it->second) ?
-            sendConnectionStatus(peer);
+        for (std::pair<const size_t, std::unique_ptr<Peer>>& it : _peers) {
+            sendConnectionStatus(*it.second);
         }
     }
 }
 
-void ParallelServer::assignHost(std::shared_ptr<Peer> newHost) {
+void ParallelServer::assignHost(Peer& newHost) {
     {
         std::lock_guard lock(_hostInfoMutex);
-        std::shared_ptr<ParallelServer::Peer> oldHost = peer(_hostPeerId);
+        Peer* oldHost = peer(_hostPeerId);
 
         if (oldHost) {
             oldHost->status = ParallelConnection::Status::ClientWithHost;
         }
-        _hostPeerId = newHost->id;
-        _hostName = newHost->name;
+        _hostPeerId = newHost.id;
+        _hostName = newHost.name;
     }
-    newHost->status = ParallelConnection::Status::Host;
+    newHost.status = ParallelConnection::Status::Host;
 
-    for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
-        if (it.second != newHost) {
+    for (std::pair<const size_t, std::unique_ptr<Peer>>& it : _peers) {
+        if (it.second.get() != &newHost) {
             it.second->status = ParallelConnection::Status::ClientWithHost;
         }
         sendConnectionStatus(*it.second);
@@ -369,7 +552,7 @@ void ParallelServer::setToClient(Peer& peer) {
         }
 
         // If host becomes client, make all clients hostless.
-        for (std::pair<const size_t, std::shared_ptr<Peer>>& it : _peers) {
+        for (std::pair<const size_t, std::unique_ptr<Peer>>& it : _peers) {
             it.second->status = ParallelConnection::Status::ClientWithoutHost;
             sendConnectionStatus(*it.second);
         }
@@ -423,4 +606,12 @@ size_t ParallelServer::nConnections() const {
     return _nConnections;
 }
 
+ParallelServer::Statistics ParallelServer::statistics() const {
+    Statistics res;
+    res.nSupersededKeyframes = _nSupersededKeyframes;
+    res.nOverflows = _nOverflows;
+    res.maxQueuedBytes = _maxQueuedBytes;
+    return res;
+}
+
 } // namespace openspace
@@ -53,6 +53,8 @@ const char* Property::JsonValueKey = "Value";
 const char* Property::MetaDataKey = "MetaData";
 const char* Property::AdditionalDataKey = "AdditionalData";
 
+std::atomic<uint64_t> Property::ChangeGeneration = 0;
+
 
 std::string sanitizeString(const std::string& s) {
     std::string result;
@@ -300,6 +302,7 @@ void Property::setPropertyOwner(PropertyOwner* owner) {
 }
 
 void Property::notifyChangeListeners() {
+    ChangeGeneration.fetch_add(1, std::memory_order_relaxed);
     for (const std::pair<OnChangeHandle, std::function<void()>>& p : _onChangeCallbacks) {
         p.second();
     }
@@ -319,6 +322,10 @@ void Property::resetToUnchanged() {
     _isValueDirty = false;
 }
 
+uint64_t Property::changeGeneration() {
+    return ChangeGeneration.load(std::memory_order_relaxed);
+}
+
 std::string Property::generateBaseJsonDescription() const {
     std::string cName = className();
     std::string cNameSan = sanitizeString(cName);
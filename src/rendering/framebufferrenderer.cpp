@@ -34,6 +34,7 @@
 #include <openspace/rendering/renderengine.h>
 #include <openspace/rendering/volumeraycaster.h>
 #include <openspace/scene/scene.h>
+#include <openspace/util/memorymanager.h>
 #include <openspace/util/timemanager.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/filesystem/filesystem.h>
@@ -1168,7 +1169,11 @@ void FramebufferRenderer::render(Scene* scene, Camera* camera, float blackoutFac
         0,
         {}
     };
-    RendererTasks tasks;
+    FrameAllocator frameMemory = global::memoryManager->TemporaryMemory.allocator();
+    RendererTasks tasks = {
+        FrameVector<RaycasterTask>(frameMemory),
+        FrameVector<DeferredcasterTask>(frameMemory)
+    };
 
     {
         TracyGpuZone("Background")
@@ -1265,7 +1270,7 @@ void FramebufferRenderer::render(Scene* scene, Camera* camera, float blackoutFac
     }
 }
 
-void FramebufferRenderer::performRaycasterTasks(const std::vector<RaycasterTask>& tasks,
+void FramebufferRenderer::performRaycasterTasks(const FrameVector<RaycasterTask>& tasks,
                                                 const glm::ivec4& viewport)
 {
     ZoneScoped
@@ -1402,7 +1407,7 @@ void FramebufferRenderer::performRaycasterTasks(const std::vector<RaycasterTask>
 }
 
 void FramebufferRenderer::performDeferredTasks(
-                                             const std::vector<DeferredcasterTask>& tasks,
+                                             const FrameVector<DeferredcasterTask>& tasks,
                                                                const glm::ivec4& viewport)
 {
     ZoneScoped
@@ -1115,7 +1115,9 @@ void RenderEngine::addScreenSpaceRenderable(std::unique_ptr<ScreenSpaceRenderabl
     }
 
     s->initialize();
-    s->initializeGL();
+    if (!global::windowDelegate->isHeadless()) {
+        s->initializeGL();
+    }
 
     ScreenSpaceRenderable* ssr = s.get();
     global::screenSpaceRootPropertyOwner->addPropertySubOwner(ssr);
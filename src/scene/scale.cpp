@@ -75,6 +75,10 @@ bool Scale::initialize() {
     return true;
 }
 
+bool Scale::isThreadSafe() const {
+    return false;
+}
+
 glm::dvec3 Scale::scaleValue() const {
     return _cachedScale;
 }
@@ -36,11 +36,15 @@
 #include <openspace/scene/sceneinitializer.h>
 #include <openspace/scripting/lualibrary.h>
 #include <openspace/scripting/scriptengine.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/misc.h>
 #include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
 #include <string>
 #include <stack>
 
@@ -51,6 +55,35 @@ namespace {
     constexpr const char* KeyIdentifier = "Identifier";
     constexpr const char* KeyParent = "Parent";
 
+    // The minimum number of nodes of a level that are handed to a single worker thread.
+    // Updating the transformation of a node is cheap, so levels with fewer nodes are not
+    // worth the overhead of distributing them
+    constexpr const size_t ParallelUpdateGrainSize = 64;
+
+    constexpr openspace::properties::Property::PropertyInfo ParallelUpdateInfo = {
+        "ParallelUpdate",
+        "Parallel update",
+        "If this value is enabled, the transformations of scene graph nodes that do not "
+        "depend on each other are updated concurrently on the worker threads of the "
+        "task scheduler. Nodes whose transformations are not thread-safe, for example "
+        "because they access SPICE, are always updated on the main thread."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo NodesRecomputedInfo = {
+        "NodesRecomputed",
+        "Nodes recomputed",
+        "The number of scene graph node updates in the last frame that had to recompute "
+        "the world transform of the node."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo NodesSkippedInfo = {
+        "NodesSkipped",
+        "Nodes skipped",
+        "The number of scene graph node updates in the last frame that could reuse the "
+        "cached world transform of the node, either because the transformations of the "
+        "node did not change or because the entire scene update was skipped."
+    };
+
 #ifdef TRACY_ENABLE
     constexpr const char* renderBinToString(int renderBin) {
         // Synced with Renderable::RenderBin
@@ -88,9 +121,20 @@ Scene::InvalidSceneError::InvalidSceneError(std::string msg, std::string comp)
 Scene::Scene(std::unique_ptr<SceneInitializer> initializer)
     : properties::PropertyOwner({"Scene", "Scene"})
     , _initializer(std::move(initializer))
+    , _parallelUpdate(ParallelUpdateInfo, true)
+    , _nNodesRecomputed(NodesRecomputedInfo, 0, 0, std::numeric_limits<int>::max())
+    , _nNodesSkipped(NodesSkippedInfo, 0, 0, std::numeric_limits<int>::max())
 {
     _rootDummy.setIdentifier(SceneGraphNode::RootNodeIdentifier);
     _rootDummy.setScene(this);
+
+    addProperty(_parallelUpdate);
+
+    _nNodesRecomputed.setReadOnly(true);
+    addProperty(_nNodesRecomputed);
+
+    _nNodesSkipped.setReadOnly(true);
+    addProperty(_nNodesSkipped);
 }
 
 Scene::~Scene() {
@@ -173,6 +217,8 @@ void Scene::sortTopologically() {
     );
 
     if (_topologicallySortedNodes.empty()) {
+        _updateOrder.clear();
+        _updateLevels.clear();
         return;
     }
 
@@ -191,6 +237,12 @@ void Scene::sortTopologically() {
         }
     }
 
+    // The level of a node is one more than the highest level of its parent and its
+    // dependencies. All nodes of a level can therefore be updated independently of each
+    // other once all previous levels have been updated
+    std::unordered_map<SceneGraphNode*, size_t> levels;
+    levels[root] = 0;
+
     std::stack<SceneGraphNode*> zeroInDegreeNodes;
     zeroInDegreeNodes.push(root);
 
@@ -201,21 +253,23 @@ void Scene::sortTopologically() {
         nodes.push_back(node);
         zeroInDegreeNodes.pop();
 
-        for (SceneGraphNode* n : node->dependentNodes()) {
+        const size_t childLevel = levels[node] + 1;
+        auto visit = [&](SceneGraphNode* n) {
+            size_t& level = levels[n];
+            level = std::max(level, childLevel);
+
             const auto it = inDegrees.find(n);
             it->second -= 1;
             if (it->second == 0) {
                 zeroInDegreeNodes.push(n);
                 inDegrees.erase(it);
             }
+        };
+        for (SceneGraphNode* n : node->dependentNodes()) {
+            visit(n);
         }
         for (SceneGraphNode* n : node->children()) {
-            const auto it = inDegrees.find(n);
-            it->second -= 1;
-            if (it->second == 0) {
-                zeroInDegreeNodes.push(n);
-                inDegrees.erase(it);
-            }
+            visit(n);
         }
     }
     if (!inDegrees.empty()) {
@@ -230,6 +284,46 @@ void Scene::sortTopologically() {
     }
 
     _topologicallySortedNodes = nodes;
+
+    // The update order is sorted by level and within each level the thread-safe nodes
+    // come first. The stable sort keeps the topological order within each group, which
+    // makes the order deterministic
+    struct UpdateEntry {
+        SceneGraphNode* node;
+        size_t level;
+        bool isThreadSafe;
+    };
+    std::vector<UpdateEntry> updateOrder;
+    updateOrder.reserve(nodes.size());
+    for (SceneGraphNode* node : nodes) {
+        updateOrder.push_back({ node, levels[node], node->isTransformThreadSafe() });
+    }
+    std::stable_sort(
+        updateOrder.begin(),
+        updateOrder.end(),
+        [](const UpdateEntry& lhs, const UpdateEntry& rhs) {
+            if (lhs.level != rhs.level) {
+                return lhs.level < rhs.level;
+            }
+            return lhs.isThreadSafe && !rhs.isThreadSafe;
+        }
+    );
+
+    _updateOrder.clear();
+    _updateOrder.reserve(updateOrder.size());
+    _updateLevels.clear();
+    for (size_t i = 0; i < updateOrder.size(); ++i) {
+        const UpdateEntry& entry = updateOrder[i];
+        if (i == 0 || entry.level != updateOrder[i - 1].level) {
+            _updateLevels.push_back({ i, i, i });
+        }
+        UpdateLevel& level = _updateLevels.back();
+        if (entry.isThreadSafe) {
+            level.parallelEnd = i + 1;
+        }
+        level.end = i + 1;
+        _updateOrder.push_back(entry.node);
+    }
 }
 
 void Scene::initializeNode(SceneGraphNode* node) {
@@ -312,26 +406,111 @@ void Scene::initializeGL() {
 void Scene::update(const UpdateData& data) {
     ZoneScoped
 
+    const uint64_t frameNumber = global::renderEngine->frameNumber();
+    const bool isNewFrame = frameNumber != _updateStatistics.frameNumber;
+    const int nRecomputedLastFrame = _updateStatistics.nRecomputed;
+    const int nSkippedLastFrame = _updateStatistics.nSkipped;
+    if (isNewFrame) {
+        _updateStatistics.frameNumber = frameNumber;
+        _updateStatistics.nRecomputed = 0;
+        _updateStatistics.nSkipped = 0;
+    }
+
     std::vector<SceneGraphNode*> initializedNodes = _initializer->takeInitializedNodes();
-    for (SceneGraphNode* node : initializedNodes) {
-        try {
-            node->initializeGL();
-        }
-        catch (const ghoul::RuntimeError& e) {
-            LERRORC(e.component, e.message);
+    // Without an OpenGL context, the nodes stay in the initialized state, which means
+    // that they are updated but never rendered
+    if (!global::windowDelegate->isHeadless()) {
+        for (SceneGraphNode* node : initializedNodes) {
+            try {
+                node->initializeGL();
+            }
+            catch (const ghoul::RuntimeError& e) {
+                LERRORC(e.component, e.message);
+            }
         }
     }
+    const bool hasNewNodes = !initializedNodes.empty() || _dirtyNodeRegistry;
     if (_dirtyNodeRegistry) {
         updateNodeRegistry();
     }
-    for (SceneGraphNode* node : _topologicallySortedNodes) {
-        try {
-            node->update(data);
+
+    // Any change to a property could influence the transformation or renderable of a
+    // node, so we have to be conservative and only skip if nothing has changed at all.
+    // Renderables might also depend on things other than the simulation time, such as
+    // data that is loaded asynchronously, so the first update in each frame always runs
+    const bool hasSameInputs =
+        !isNewFrame && _lastUpdate.isValid && !hasNewNodes &&
+        _lastUpdate.time == data.time.j2000Seconds() &&
+        _lastUpdate.previousFrameTime == data.previousFrameTime.j2000Seconds() &&
+        _lastUpdate.propertyGeneration == properties::Property::changeGeneration();
+    if (hasSameInputs) {
+        _updateStatistics.nSkipped += static_cast<int>(_topologicallySortedNodes.size());
+    }
+    else {
+        std::atomic_int nRecomputed = 0;
+        std::atomic_int nSkipped = 0;
+        auto updateTransform = [&](SceneGraphNode* node) {
+            try {
+                const bool recomputed = node->updateTransform(data);
+                if (recomputed) {
+                    nRecomputed++;
+                }
+                else {
+                    nSkipped++;
+                }
+            }
+            catch (const ghoul::RuntimeError& e) {
+                LERRORC(e.component, e.what());
+            }
+        };
+
+        for (const UpdateLevel& level : _updateLevels) {
+            const size_t nParallel = level.parallelEnd - level.begin;
+            if (_parallelUpdate && nParallel > ParallelUpdateGrainSize) {
+                global::taskScheduler->parallelFor(
+                    level.begin,
+                    level.parallelEnd,
+                    ParallelUpdateGrainSize,
+                    [&](size_t i) { updateTransform(_updateOrder[i]); }
+                );
+            }
+            else {
+                for (size_t i = level.begin; i < level.parallelEnd; ++i) {
+                    updateTransform(_updateOrder[i]);
+                }
+            }
+
+            for (size_t i = level.parallelEnd; i < level.end; ++i) {
+                updateTransform(_updateOrder[i]);
+            }
         }
-        catch (const ghoul::RuntimeError& e) {
-            LERRORC(e.component, e.what());
+        _updateStatistics.nRecomputed += nRecomputed;
+        _updateStatistics.nSkipped += nSkipped;
+
+        // Renderables can access OpenGL, SPICE, and other nodes, so they are always
+        // updated serially after all transformations are known
+        for (SceneGraphNode* node : _topologicallySortedNodes) {
+            try {
+                node->updateRenderable(data);
+            }
+            catch (const ghoul::RuntimeError& e) {
+                LERRORC(e.component, e.what());
+            }
         }
     }
+
+    if (isNewFrame) {
+        _nNodesRecomputed = nRecomputedLastFrame;
+        _nNodesSkipped = nSkippedLastFrame;
+    }
+
+    // Property changes that happen as part of the update itself, including the statistics
+    // above, are not considered as they have already been seen by all nodes that come
+    // after the change
+    _lastUpdate.time = data.time.j2000Seconds();
+    _lastUpdate.previousFrameTime = data.previousFrameTime.j2000Seconds();
+    _lastUpdate.propertyGeneration = properties::Property::changeGeneration();
+    _lastUpdate.isValid = true;
 }
 
 void Scene::render(const RenderData& data, RendererTasks& tasks) {
@@ -653,17 +653,26 @@ void SceneGraphNode::traversePostOrder(const std::function<void(SceneGraphNode*)
     fn(this);
 }
 
-void SceneGraphNode::update(const UpdateData& data) {
+bool SceneGraphNode::update(const UpdateData& data) {
+    const bool recomputed = updateTransform(data);
+    updateRenderable(data);
+    return recomputed;
+}
+
+bool SceneGraphNode::updateTransform(const UpdateData& data) {
     ZoneScoped
     ZoneName(identifier().c_str(), identifier().size())
 
+    _isActiveInUpdate = false;
+
     State s = _state;
-    if (s != State::Initialized && _state != State::GLInitialized) {
-        return;
+    if (s != State::Initialized && s != State::GLInitialized) {
+        return false;
     }
     if (!isTimeFrameActive(data.time)) {
-        return;
+        return false;
     }
+    _isActiveInUpdate = true;
 
     if (_transform.translation) {
         _transform.translation->update(data);
@@ -676,36 +685,70 @@ void SceneGraphNode::update(const UpdateData& data) {
     if (_transform.scale) {
         _transform.scale->update(data);
     }
-    UpdateData newUpdateData = data;
 
-    // Assumes _worldRotationCached and _worldScaleCached have been calculated for parent
-    _worldPositionCached = calculateWorldPosition();
-    _worldRotationCached = calculateWorldRotation();
-    _worldScaleCached = calculateWorldScale();
-
-    newUpdateData.modelTransform.translation = _worldPositionCached;
-    newUpdateData.modelTransform.rotation = _worldRotationCached;
-    newUpdateData.modelTransform.scale = _worldScaleCached;
+    // The transformations cache their values, so this does not cause any recomputations
+    const glm::dvec3 localPosition = position();
+    const glm::dmat3& localRotation = rotationMatrix();
+    const glm::dvec3 localScale = scale();
+    const uint64_t parentGeneration = _parent ? _parent->_worldTransformGeneration : 0;
+
+    const bool isDirty =
+        !_worldTransformInputs.isValid ||
+        _worldTransformInputs.parent != _parent ||
+        _worldTransformInputs.parentGeneration != parentGeneration ||
+        _worldTransformInputs.position != localPosition ||
+        _worldTransformInputs.rotation != localRotation ||
+        _worldTransformInputs.scale != localScale;
+
+    if (isDirty) {
+        // Assumes _worldRotationCached and _worldScaleCached have been calculated for
+        // parent
+        _worldPositionCached = calculateWorldPosition();
+        _worldRotationCached = calculateWorldRotation();
+        _worldScaleCached = calculateWorldScale();
+
+        glm::dmat4 translation = glm::translate(glm::dmat4(1.0), _worldPositionCached);
+        glm::dmat4 rotation = glm::dmat4(_worldRotationCached);
+        glm::dmat4 scaling = glm::scale(glm::dmat4(1.0), _worldScaleCached);
+        _modelTransformCached = translation * rotation * scaling;
+
+        _worldTransformInputs.position = localPosition;
+        _worldTransformInputs.rotation = localRotation;
+        _worldTransformInputs.scale = localScale;
+        _worldTransformInputs.parent = _parent;
+        _worldTransformInputs.parentGeneration = parentGeneration;
+        _worldTransformInputs.isValid = true;
+        ++_worldTransformGeneration;
+    }
+
+    return isDirty;
+}
 
-    glm::dmat4 translation = glm::translate(
-        glm::dmat4(1.0),
-        newUpdateData.modelTransform.translation
-    );
-    glm::dmat4 rotation = glm::dmat4(newUpdateData.modelTransform.rotation);
-    glm::dmat4 scaling = glm::scale(
-        glm::dmat4(1.0),
-        newUpdateData.modelTransform.scale
-    );
+void SceneGraphNode::updateRenderable(const UpdateData& data) {
+    ZoneScoped
+    ZoneName(identifier().c_str(), identifier().size())
 
-    _modelTransformCached = translation * rotation * scaling;
+    if (!_isActiveInUpdate) {
+        return;
+    }
 
     if (_renderable && _renderable->isReady() &&
         (_renderable->isEnabled() || _renderable->shouldUpdateIfDisabled()))
     {
+        UpdateData newUpdateData = data;
+        newUpdateData.modelTransform.translation = _worldPositionCached;
+        newUpdateData.modelTransform.rotation = _worldRotationCached;
+        newUpdateData.modelTransform.scale = _worldScaleCached;
         _renderable->update(newUpdateData);
     }
 }
 
+bool SceneGraphNode::isTransformThreadSafe() const {
+    return (!_transform.translation || _transform.translation->isThreadSafe()) &&
+           (!_transform.rotation || _transform.rotation->isThreadSafe()) &&
+           (!_transform.scale || _transform.scale->isThreadSafe());
+}
+
 void SceneGraphNode::render(const RenderData& data, RendererTasks& tasks) {
     ZoneScoped
     ZoneName(identifier().c_str(), identifier().size())
@@ -46,8 +46,10 @@ bool SingleThreadedSceneInitializer::isInitializing() const {
     return false;
 }
 
+// Initializing a node loads its data from disk, so it must not end up on a thread that is
+// waiting for compute work in the middle of a frame
 MultiThreadedSceneInitializer::MultiThreadedSceneInitializer(unsigned int nThreads)
-    : _threadPool(nThreads)
+    : _threadPool(nThreads, TaskScheduler::Priority::IO)
 {}
 
 void MultiThreadedSceneInitializer::initializeNode(SceneGraphNode* node) {
@@ -68,6 +68,10 @@ bool Translation::initialize() {
     return true;
 }
 
+bool Translation::isThreadSafe() const {
+    return false;
+}
+
 void Translation::update(const UpdateData& data) {
     if (!_needsUpdate && data.time.j2000Seconds() == _cachedTime) {
         return;
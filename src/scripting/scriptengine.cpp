@@ -704,6 +704,10 @@ void ScriptEngine::preSync(bool isMaster) {
     }
 }
 
+bool ScriptEngine::isDirty() {
+    return !_scriptsToSync.empty();
+}
+
 void ScriptEngine::encode(SyncBuffer* syncBuffer) {
     ZoneScoped
 
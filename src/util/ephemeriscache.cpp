@@ -0,0 +1,332 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/ephemeriscache.h>
+
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace {
+    // The relative positions inside an interval at which the interpolation error is
+    // tested. The second test point is not a dyadic fraction so that periodic motions
+    // whose period divides the interval length do not go unnoticed
+    constexpr const double MidPoint = 0.5;
+    constexpr const double TestPoint = 0.381966011250105;
+} // namespace
+
+namespace openspace {
+
+EphemerisCache::EphemerisCache(Type type, SampleFunction function, double tolerance,
+                               double segmentLength, double minimumStep,
+                               size_t maxSegments)
+    : _type(type)
+    , _function(std::move(function))
+    , _segmentLength(segmentLength)
+    , _minimumStep(minimumStep)
+    , _maxSegments(maxSegments)
+    , _tolerance(tolerance)
+{
+    ghoul_assert(_function, "Function must not be empty");
+    ghoul_assert(tolerance > 0.0, "Tolerance must be positive");
+    ghoul_assert(minimumStep > 0.0, "Minimum step must be positive");
+    ghoul_assert(segmentLength > minimumStep, "Segment must be longer than minimum step");
+    ghoul_assert(maxSegments >= 1, "At least one segment must be stored");
+}
+
+std::optional<EphemerisCache::Sample> EphemerisCache::value(double time) {
+    _wasUsed = true;
+    return lookup(time);
+}
+
+void EphemerisCache::prefetch(double time, double deltaTime, int nSteps) {
+    ZoneScoped
+
+    if (!_wasUsed.exchange(false)) {
+        return;
+    }
+
+    for (int i = 0; i <= nSteps; ++i) {
+        lookup(time + i * deltaTime);
+        if (deltaTime == 0.0) {
+            break;
+        }
+    }
+}
+
+void EphemerisCache::clear() {
+    std::unique_lock lock(_mutex);
+    _segments.clear();
+}
+
+void EphemerisCache::setTolerance(double tolerance) {
+    ghoul_assert(tolerance > 0.0, "Tolerance must be positive");
+
+    std::unique_lock lock(_mutex);
+    _tolerance = tolerance;
+    _segments.clear();
+}
+
+EphemerisCache::Type EphemerisCache::type() const {
+    return _type;
+}
+
+EphemerisCache::Statistics EphemerisCache::statistics() const {
+    Statistics stats;
+    stats.nHits = _nHits;
+    stats.nMisses = _nMisses;
+    stats.nEvaluations = _nEvaluations;
+
+    std::shared_lock lock(_mutex);
+    stats.nSegments = _segments.size();
+    return stats;
+}
+
+std::optional<EphemerisCache::Sample> EphemerisCache::lookup(double time) {
+    if (!std::isfinite(time)) {
+        return std::nullopt;
+    }
+
+    const int64_t key = static_cast<int64_t>(std::floor(time / _segmentLength));
+
+    {
+        std::shared_lock lock(_mutex);
+        const auto it = _segments.find(key);
+        if (it != _segments.end()) {
+            const Segment& segment = it->second;
+            const Interval& interval = segment.intervals[findLeaf(segment, time)];
+            if (interval.state != Interval::State::Unrefined) {
+                it->second.lastUse = ++_useCounter;
+                _nHits++;
+                if (interval.state == Interval::State::NoData) {
+                    return std::nullopt;
+                }
+                return interpolate(segment, interval, time);
+            }
+        }
+    }
+
+    // The requested interval has not been refined yet, which requires new samples
+    std::unique_lock lock(_mutex);
+    _nMisses++;
+
+    auto it = _segments.find(key);
+    Segment& segment = it != _segments.end() ? it->second : createSegment(key);
+    segment.lastUse = ++_useCounter;
+
+    size_t leaf = findLeaf(segment, time);
+    while (segment.intervals[leaf].state == Interval::State::Unrefined) {
+        refine(segment, leaf);
+        leaf = findLeaf(segment, time);
+    }
+    evictSegments(key);
+
+    const Interval& interval = segment.intervals[leaf];
+    if (interval.state == Interval::State::NoData) {
+        return std::nullopt;
+    }
+    return interpolate(segment, interval, time);
+}
+
+size_t EphemerisCache::findLeaf(const Segment& segment, double time) {
+    size_t index = 0;
+    while (segment.intervals[index].firstChild != -1) {
+        const size_t first = static_cast<size_t>(segment.intervals[index].firstChild);
+        index = time < segment.intervals[first].end ? first : first + 1;
+    }
+    return index;
+}
+
+EphemerisCache::Segment& EphemerisCache::createSegment(int64_t key) {
+    ZoneScoped
+
+    const double begin = static_cast<double>(key) * _segmentLength;
+    const double end = static_cast<double>(key + 1) * _segmentLength;
+    std::optional<Sample> beginSample = evaluate(begin);
+    std::optional<Sample> endSample = evaluate(end);
+
+    Segment& segment = _segments.try_emplace(key).first->second;
+    Interval root;
+    root.begin = begin;
+    root.end = end;
+    if (beginSample.has_value() && endSample.has_value()) {
+        segment.samples = { *beginSample, *endSample };
+        root.beginSample = 0;
+        root.endSample = 1;
+    }
+    else {
+        root.state = Interval::State::NoData;
+    }
+    segment.intervals.push_back(root);
+    return segment;
+}
+
+void EphemerisCache::refine(Segment& segment, size_t interval) {
+    ZoneScoped
+
+    // Copy the interval as adding new intervals below invalidates references
+    const Interval iv = segment.intervals[interval];
+    const double length = iv.end - iv.begin;
+    const double midTime = iv.begin + MidPoint * length;
+    const double testTime = iv.begin + TestPoint * length;
+
+    std::optional<Sample> mid = evaluate(midTime);
+    if (!mid.has_value()) {
+        segment.intervals[interval].state = Interval::State::NoData;
+        return;
+    }
+
+    const bool canSplit = 0.5 * length >= _minimumStep;
+    bool isValid = error(interpolate(segment, iv, midTime), *mid) <= _tolerance;
+    // The second test point is only needed if the interval is not split anyway
+    if (isValid) {
+        std::optional<Sample> test = evaluate(testTime);
+        if (!test.has_value()) {
+            segment.intervals[interval].state = Interval::State::NoData;
+            return;
+        }
+        isValid = error(interpolate(segment, iv, testTime), *test) <= _tolerance;
+    }
+
+    if (isValid || !canSplit) {
+        segment.intervals[interval].state = Interval::State::Valid;
+        return;
+    }
+
+    const size_t midSample = segment.samples.size();
+    segment.samples.push_back(*mid);
+
+    Interval first;
+    first.begin = iv.begin;
+    first.end = midTime;
+    first.beginSample = iv.beginSample;
+    first.endSample = midSample;
+
+    Interval second;
+    second.begin = midTime;
+    second.end = iv.end;
+    second.beginSample = midSample;
+    second.endSample = iv.endSample;
+
+    segment.intervals[interval].firstChild = static_cast<int>(segment.intervals.size());
+    segment.intervals.push_back(first);
+    segment.intervals.push_back(second);
+}
+
+EphemerisCache::Sample EphemerisCache::interpolate(const Segment& segment,
+                                                   const Interval& interval,
+                                                   double time) const
+{
+    const Sample& a = segment.samples[interval.beginSample];
+    const Sample& b = segment.samples[interval.endSample];
+    const double h = interval.end - interval.begin;
+    const double s = (time - interval.begin) / h;
+
+    Sample result;
+    switch (_type) {
+        case Type::Position:
+        {
+            // Cubic Hermite basis functions and their derivatives
+            const double s2 = s * s;
+            const double s3 = s2 * s;
+            const double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+            const double h10 = s3 - 2.0 * s2 + s;
+            const double h01 = -2.0 * s3 + 3.0 * s2;
+            const double h11 = s3 - s2;
+            result.position = h00 * a.position + h10 * h * a.velocity +
+                h01 * b.position + h11 * h * b.velocity;
+
+            const double d00 = 6.0 * s2 - 6.0 * s;
+            const double d10 = 3.0 * s2 - 4.0 * s + 1.0;
+            const double d01 = -6.0 * s2 + 6.0 * s;
+            const double d11 = 3.0 * s2 - 2.0 * s;
+            result.velocity = (d00 * a.position + d01 * b.position) / h +
+                d10 * a.velocity + d11 * b.velocity;
+            break;
+        }
+        case Type::Rotation:
+        {
+            // q and -q describe the same rotation, but only the one closer to the
+            // first quaternion results in the shortest interpolation path
+            const glm::dquat q = glm::dot(a.rotation, b.rotation) < 0.0 ?
+                -b.rotation :
+                b.rotation;
+            result.rotation = glm::normalize(glm::slerp(a.rotation, q, s));
+            break;
+        }
+    }
+    return result;
+}
+
+double EphemerisCache::error(const Sample& interpolated, const Sample& exact) const {
+    switch (_type) {
+        case Type::Position:
+            return glm::distance(interpolated.position, exact.position);
+        case Type::Rotation:
+        {
+            // The angle between two rotations is 4 * asin(|q1 - q2| / 2) for aligned unit
+            // quaternions, which is more precise for small angles than using acos
+            const glm::dquat q = glm::dot(interpolated.rotation, exact.rotation) < 0.0 ?
+                -exact.rotation :
+                exact.rotation;
+            const glm::dquat diff = interpolated.rotation - q;
+            const double d = std::sqrt(glm::dot(diff, diff));
+            return 4.0 * std::asin(std::min(d / 2.0, 1.0));
+        }
+    }
+    return std::numeric_limits<double>::max();
+}
+
+std::optional<EphemerisCache::Sample> EphemerisCache::evaluate(double time) {
+    _nEvaluations++;
+    std::optional<Sample> sample = _function(time);
+    if (sample.has_value() && _type == Type::Rotation) {
+        sample->rotation = glm::normalize(sample->rotation);
+    }
+    return sample;
+}
+
+void EphemerisCache::evictSegments(int64_t keep) {
+    while (_segments.size() > _maxSegments) {
+        auto oldest = _segments.end();
+        for (auto it = _segments.begin(); it != _segments.end(); ++it) {
+            if (it->first == keep) {
+                continue;
+            }
+            if (oldest == _segments.end() || it->second.lastUse < oldest->second.lastUse)
+            {
+                oldest = it;
+            }
+        }
+        if (oldest == _segments.end()) {
+            return;
+        }
+        _segments.erase(oldest);
+    }
+}
+
+} // namespace openspace
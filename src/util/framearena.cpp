@@ -0,0 +1,161 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/framearena.h>
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace {
+    constexpr size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+} // namespace
+
+namespace openspace {
+
+FrameArena::FrameArena(size_t capacity)
+    : _buffer(std::make_unique<std::byte[]>(capacity))
+    , _capacity(capacity)
+    , _requestedCapacity(capacity)
+{}
+
+FrameArena::~FrameArena() {
+    releaseOverflows();
+}
+
+void FrameArena::reset() {
+    const size_t usage = _offset + _overflowBytes;
+    _lastFrameUsage = usage;
+    _highWaterMark = std::max(_highWaterMark, usage);
+
+    {
+        std::lock_guard lock(_overflowMutex);
+        _lastFrameOverflows = _overflows.size();
+        _totalOverflows += _overflows.size();
+    }
+    releaseOverflows();
+
+    const size_t requested = _requestedCapacity;
+    if (requested != _capacity) {
+        _buffer = std::make_unique<std::byte[]>(requested);
+        _capacity = requested;
+    }
+
+    _offset = 0;
+    _overflowBytes = 0;
+}
+
+void FrameArena::setCapacity(size_t capacity) {
+    _requestedCapacity = capacity;
+}
+
+FrameAllocator FrameArena::allocator() {
+#ifdef __cpp_lib_memory_resource
+    return FrameAllocator(this);
+#else // ^^^ __cpp_lib_memory_resource / !__cpp_lib_memory_resource vvv
+    return FrameAllocator();
+#endif // __cpp_lib_memory_resource
+}
+
+size_t FrameArena::capacity() const {
+    return _capacity;
+}
+
+size_t FrameArena::usage() const {
+    return _offset + _overflowBytes;
+}
+
+size_t FrameArena::lastFrameUsage() const {
+    return _lastFrameUsage;
+}
+
+size_t FrameArena::highWaterMark() const {
+    return _highWaterMark;
+}
+
+size_t FrameArena::lastFrameOverflows() const {
+    return _lastFrameOverflows;
+}
+
+size_t FrameArena::totalOverflows() const {
+    return _totalOverflows;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    ghoul_assert(
+        alignment > 0 && (alignment & (alignment - 1)) == 0,
+        "Alignment must be a power of two"
+    );
+
+    // The alignment has to be computed on the actual address as the buffer itself is
+    // only guaranteed to be aligned to the default new alignment
+    const uintptr_t base = reinterpret_cast<uintptr_t>(_buffer.get());
+    size_t offset = _offset.load(std::memory_order_relaxed);
+    while (true) {
+        const size_t begin = alignUp(base + offset, alignment) - base;
+        const size_t end = begin + bytes;
+        if (end > _capacity) {
+            return allocateOverflow(bytes, alignment);
+        }
+
+        const bool success = _offset.compare_exchange_weak(
+            offset,
+            end,
+            std::memory_order_relaxed
+        );
+        if (success) {
+            return _buffer.get() + begin;
+        }
+    }
+}
+
+void FrameArena::do_deallocate(void*, size_t, size_t) {
+    // Memory is only ever released all at once in the reset function
+}
+
+bool FrameArena::do_is_equal(const FrameMemoryResource& other) const noexcept {
+    return this == &other;
+}
+
+void* FrameArena::allocateOverflow(size_t bytes, size_t alignment) {
+    void* ptr = ::operator new(bytes, std::align_val_t(alignment));
+    _overflowBytes += bytes;
+
+    std::lock_guard lock(_overflowMutex);
+    _overflows.push_back({ ptr, alignment });
+    return ptr;
+}
+
+void FrameArena::releaseOverflows() {
+    std::lock_guard lock(_overflowMutex);
+    for (const OverflowAllocation& a : _overflows) {
+        ::operator delete(a.pointer, std::align_val_t(a.alignment));
+    }
+    _overflows.clear();
+}
+
+} // namespace openspace
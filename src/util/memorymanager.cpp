@@ -0,0 +1,105 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/memorymanager.h>
+
+#include <limits>
+
+namespace {
+    constexpr const int DefaultTemporaryMemorySize = 400; // KiB
+    constexpr const int MaxTemporaryMemorySize = 1024 * 1024; // KiB
+
+    constexpr openspace::properties::Property::PropertyInfo TemporaryMemorySizeInfo = {
+        "TemporaryMemorySize",
+        "Temporary memory size (KiB)",
+        "The size of the per-frame memory arena in KiB. Allocations that do not fit into "
+        "the arena fall back to the regular heap, so this value should be larger than "
+        "the high-water mark. A changed value takes effect at the beginning of the next "
+        "frame."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo TemporaryMemoryUsageInfo = {
+        "TemporaryMemoryUsage",
+        "Temporary memory usage (KiB)",
+        "The amount of per-frame memory in KiB that was requested during the last frame."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo HighWaterMarkInfo = {
+        "TemporaryMemoryHighWaterMark",
+        "Temporary memory high-water mark (KiB)",
+        "The largest amount of per-frame memory in KiB that was requested in a single "
+        "frame since the application was started."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo OverflowsInfo = {
+        "TemporaryMemoryOverflows",
+        "Temporary memory overflows",
+        "The number of per-frame allocations that did not fit into the arena and had to "
+        "be served from the heap since the application was started."
+    };
+
+    int toKiB(size_t bytes) {
+        return static_cast<int>((bytes + 1023) / 1024);
+    }
+} // namespace
+
+namespace openspace {
+
+MemoryManager::MemoryManager()
+    : properties::PropertyOwner({ "MemoryManager" })
+    , TemporaryMemory(DefaultTemporaryMemorySize * 1024)
+    , _temporaryMemorySize(
+        TemporaryMemorySizeInfo,
+        DefaultTemporaryMemorySize,
+        4,
+        MaxTemporaryMemorySize
+    )
+    , _temporaryMemoryUsage(TemporaryMemoryUsageInfo, 0, 0, MaxTemporaryMemorySize)
+    , _temporaryMemoryHighWaterMark(HighWaterMarkInfo, 0, 0, MaxTemporaryMemorySize)
+    , _temporaryMemoryOverflows(OverflowsInfo, 0, 0, std::numeric_limits<int>::max())
+{
+    _temporaryMemorySize.onChange([this]() {
+        TemporaryMemory.setCapacity(static_cast<size_t>(_temporaryMemorySize) * 1024);
+    });
+    addProperty(_temporaryMemorySize);
+
+    _temporaryMemoryUsage.setReadOnly(true);
+    addProperty(_temporaryMemoryUsage);
+
+    _temporaryMemoryHighWaterMark.setReadOnly(true);
+    addProperty(_temporaryMemoryHighWaterMark);
+
+    _temporaryMemoryOverflows.setReadOnly(true);
+    addProperty(_temporaryMemoryOverflows);
+}
+
+void MemoryManager::resetTemporaryMemory() {
+    TemporaryMemory.reset();
+
+    _temporaryMemoryUsage = toKiB(TemporaryMemory.lastFrameUsage());
+    _temporaryMemoryHighWaterMark = toKiB(TemporaryMemory.highWaterMark());
+    _temporaryMemoryOverflows = static_cast<int>(TemporaryMemory.totalOverflows());
+}
+
+} // namespace openspace
@@ -32,7 +32,9 @@
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/profiling.h>
 #include <algorithm>
+#include <array>
 #include <filesystem>
+#include <optional>
 #include "SpiceUsr.h"
 #include "SpiceZpr.h"
 
@@ -44,6 +46,13 @@ namespace {
     // as the maximum message length
     constexpr const unsigned SpiceErrorBufferSize = 1841;
 
+    // The length of the segments of the ephemeris caches in seconds. Each segment is
+    // subdivided as far as necessary to reach the requested tolerance
+    constexpr const double EphemerisSegmentLength = 86400.0;
+
+    // The number of frames for which the ephemerides are sampled ahead of time
+    constexpr const int EphemerisPrefetchSteps = 3;
+
     const char* toString(openspace::SpiceManager::FieldOfViewMethod m) {
         using SM = openspace::SpiceManager;
         switch (m) {
@@ -61,6 +70,39 @@ namespace {
             default:                            throw ghoul::MissingCaseException();
         }
     }
+
+    // Returns the absolute paths of all kernels of the provided kind (for example "SPK"
+    // or "CK") that were loaded through the meta-kernel at the provided path. Relative
+    // paths are resolved against the current working directory
+    std::vector<std::filesystem::path> kernelsLoadedBy(const std::string& metaKernel,
+                                                       const char* kind)
+    {
+        // The lengths were taken from the example in
+        // https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/kdata_c.html
+        constexpr const int FileLength = 256;
+        constexpr const int TypeLength = 33;
+        constexpr const int SourceLength = 256;
+
+        SpiceInt count = 0;
+        ktotal_c(kind, &count);
+
+        std::vector<std::filesystem::path> result;
+        for (SpiceInt i = 0; i < count; ++i) {
+            std::array<char, FileLength> file;
+            std::array<char, TypeLength> type;
+            std::array<char, SourceLength> source;
+            SpiceInt handle = 0;
+            SpiceBoolean found = SPICEFALSE;
+            kdata_c(
+                i, kind, FileLength, TypeLength, SourceLength,
+                file.data(), type.data(), source.data(), &handle, &found
+            );
+            if (found && metaKernel == source.data()) {
+                result.push_back(std::filesystem::absolute(file.data()));
+            }
+        }
+        return result;
+    }
 } // namespace
 
 #include "spicemanager_lua.inl"
@@ -226,32 +268,55 @@ SpiceManager::KernelHandle SpiceManager::loadKernel(std::string filePath) {
         return it->id;
     }
 
-    // We need to set the current directory as meta-kernels are usually defined relative
-    // to the directory they reside in. The directory change is not necessary for regular
-    // kernels
-    std::filesystem::path currentDirectory = std::filesystem::current_path();
-
-    std::filesystem::path p = path.parent_path();
-    std::filesystem::current_path(p);
+    {
+        std::lock_guard lock(_spiceMutex);
+
+        // We need to set the current directory as meta-kernels are usually defined
+        // relative to the directory they reside in. The directory change is not
+        // necessary for regular kernels
+        std::filesystem::path currentDirectory = std::filesystem::current_path();
+
+        std::filesystem::path p = path.parent_path();
+        std::filesystem::current_path(p);
+
+        LINFO(fmt::format("Loading SPICE kernel {}", path));
+        // Load the kernel
+        furnsh_c(path.string().c_str());
+
+        // Kernels loaded through a meta-kernel are listed with the meta-kernel as their
+        // source. Their paths are relative to the meta-kernel, so they have to be
+        // resolved before the directory is reset
+        std::vector<std::filesystem::path> spkKernels;
+        std::vector<std::filesystem::path> ckKernels;
+        if (!failed_c()) {
+            spkKernels = kernelsLoadedBy(path.string(), "SPK");
+            ckKernels = kernelsLoadedBy(path.string(), "CK");
+        }
 
-    LINFO(fmt::format("Loading SPICE kernel {}", path));
-    // Load the kernel
-    furnsh_c(path.string().c_str());
+        // Reset the current directory to the previous one
+        std::filesystem::current_path(currentDirectory);
 
-    // Reset the current directory to the previous one
-    std::filesystem::current_path(currentDirectory);
+        if (failed_c()) {
+            throwSpiceError("Kernel loading");
+        }
 
-    if (failed_c()) {
-        throwSpiceError("Kernel loading");
-    }
+        std::filesystem::path fileExtension = path.extension();
+        if (fileExtension == ".bc" || fileExtension == ".BC") {
+            findCkCoverage(path.string()); // binary ck kernel
+        }
+        else if (fileExtension == ".bsp" || fileExtension == ".BSP") {
+            findSpkCoverage(path.string()); // binary spk kernel
+        }
 
-    std::filesystem::path fileExtension = path.extension();
-    if (fileExtension == ".bc" || fileExtension == ".BC") {
-        findCkCoverage(path.string()); // binary ck kernel
-    }
-    else if (fileExtension == ".bsp" || fileExtension == ".BSP") {
-        findSpkCoverage(path.string()); // binary spk kernel
+        for (const std::filesystem::path& kernel : spkKernels) {
+            findSpkCoverage(kernel.string());
+        }
+        for (const std::filesystem::path& kernel : ckKernels) {
+            findCkCoverage(kernel.string());
+        }
     }
+    // The new kernel might change the positions or rotations that were cached before
+    clearEphemerisCache();
 
     KernelHandle kernelId = ++_lastAssignedKernel;
     ghoul_assert(kernelId != 0, fmt::format("Kernel Handle wrapped around to 0"));
@@ -274,8 +339,12 @@ void SpiceManager::unloadKernel(KernelHandle kernelId) {
         if (it->refCount == 1) {
             // No need to check for errors as we do not allow empty path names
             LINFO(fmt::format("Unloading SPICE kernel {}", it->path));
-            unload_c(it->path.c_str());
+            {
+                std::lock_guard lock(_spiceMutex);
+                unload_c(it->path.c_str());
+            }
             _loadedKernels.erase(it);
+            clearEphemerisCache();
         }
         // Otherwise, we hold on to it, but reduce the reference counter by 1
         else {
@@ -310,8 +379,12 @@ void SpiceManager::unloadKernel(std::string filePath) {
         // If there was only one part interested in the kernel, we can unload it
         if (it->refCount == 1) {
             LINFO(fmt::format("Unloading SPICE kernel {}", path));
-            unload_c(path.string().c_str());
+            {
+                std::lock_guard lock(_spiceMutex);
+                unload_c(path.string().c_str());
+            }
             _loadedKernels.erase(it);
+            clearEphemerisCache();
         }
         else {
             // Otherwise, we hold on to it, but reduce the reference counter by 1
@@ -907,6 +980,217 @@ glm::dmat3 SpiceManager::positionTransformMatrix(const std::string& sourceFrame,
     return glm::transpose(result);
 }
 
+glm::dvec3 SpiceManager::cachedTargetPosition(const std::string& target,
+                                              const std::string& observer,
+                                              const std::string& referenceFrame,
+                                              double ephemerisTime) const
+{
+    ghoul_assert(!target.empty(), "Target is not empty");
+    ghoul_assert(!observer.empty(), "Observer is not empty");
+    ghoul_assert(!referenceFrame.empty(), "Reference frame is not empty");
+
+    if (_isEphemerisCacheEnabled) {
+        EphemerisCache& cache = ephemerisCache(
+            EphemerisCache::Type::Position,
+            target,
+            observer,
+            referenceFrame
+        );
+        std::optional<EphemerisCache::Sample> sample = cache.value(ephemerisTime);
+        if (sample.has_value()) {
+            return sample->position;
+        }
+    }
+
+    // Outside of the coverage of the kernels, targetPosition estimates the position
+    std::lock_guard lock(_spiceMutex);
+    return targetPosition(
+        target,
+        observer,
+        referenceFrame,
+        AberrationCorrection(),
+        ephemerisTime
+    );
+}
+
+glm::dmat3 SpiceManager::cachedPositionTransformMatrix(const std::string& sourceFrame,
+                                                   const std::string& destinationFrame,
+                                                       double ephemerisTime) const
+{
+    ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
+    ghoul_assert(!destinationFrame.empty(), "destinationFrame must not be empty");
+
+    if (_isEphemerisCacheEnabled) {
+        EphemerisCache& cache = ephemerisCache(
+            EphemerisCache::Type::Rotation,
+            sourceFrame,
+            destinationFrame,
+            ""
+        );
+        std::optional<EphemerisCache::Sample> sample = cache.value(ephemerisTime);
+        if (sample.has_value()) {
+            return glm::mat3_cast(sample->rotation);
+        }
+    }
+
+    std::lock_guard lock(_spiceMutex);
+    return positionTransformMatrix(sourceFrame, destinationFrame, ephemerisTime);
+}
+
+void SpiceManager::setEphemerisCacheSettings(EphemerisCacheSettings settings) {
+    ghoul_assert(settings.positionTolerance > 0.0, "Tolerance must be positive");
+    ghoul_assert(settings.rotationTolerance > 0.0, "Tolerance must be positive");
+
+    _isEphemerisCacheEnabled = settings.isEnabled;
+
+    std::unique_lock lock(_ephemerisCacheMutex);
+    const bool positionChanged =
+        settings.positionTolerance != _ephemerisCacheSettings.positionTolerance;
+    const bool rotationChanged =
+        settings.rotationTolerance != _ephemerisCacheSettings.rotationTolerance;
+    _ephemerisCacheSettings = settings;
+
+    for (const std::pair<const std::string, std::unique_ptr<EphemerisCache>>& p :
+         _ephemerisCaches)
+    {
+        if (p.second->type() == EphemerisCache::Type::Position && positionChanged) {
+            p.second->setTolerance(settings.positionTolerance);
+        }
+        else if (p.second->type() == EphemerisCache::Type::Rotation && rotationChanged) {
+            p.second->setTolerance(settings.rotationTolerance);
+        }
+    }
+}
+
+void SpiceManager::prefetchEphemerides(double ephemerisTime, double deltaTime) {
+    ZoneScoped
+
+    if (!_isEphemerisCacheEnabled) {
+        return;
+    }
+
+    std::vector<EphemerisCache*> caches;
+    {
+        std::shared_lock lock(_ephemerisCacheMutex);
+        caches.reserve(_ephemerisCaches.size());
+        for (const std::pair<const std::string, std::unique_ptr<EphemerisCache>>& p :
+             _ephemerisCaches)
+        {
+            caches.push_back(p.second.get());
+        }
+    }
+
+    // Caches are never removed, so the pointers stay valid after releasing the lock
+    for (EphemerisCache* cache : caches) {
+        cache->prefetch(ephemerisTime, deltaTime, EphemerisPrefetchSteps);
+    }
+}
+
+void SpiceManager::clearEphemerisCache() {
+    std::shared_lock lock(_ephemerisCacheMutex);
+    for (const std::pair<const std::string, std::unique_ptr<EphemerisCache>>& p :
+         _ephemerisCaches)
+    {
+        p.second->clear();
+    }
+}
+
+EphemerisCache& SpiceManager::ephemerisCache(EphemerisCache::Type type,
+                                             const std::string& from,
+                                             const std::string& to,
+                                             const std::string& frame) const
+{
+    const std::string key = fmt::format(
+        "{}|{}|{}|{}", static_cast<int>(type), from, to, frame
+    );
+    {
+        std::shared_lock lock(_ephemerisCacheMutex);
+        const auto it = _ephemerisCaches.find(key);
+        if (it != _ephemerisCaches.end()) {
+            return *it->second;
+        }
+    }
+
+    std::unique_lock lock(_ephemerisCacheMutex);
+    const auto it = _ephemerisCaches.find(key);
+    if (it != _ephemerisCaches.end()) {
+        return *it->second;
+    }
+
+    using Sample = EphemerisCache::Sample;
+
+    // The sample functions return std::nullopt for all errors, including missing
+    // coverage, in which case the cached methods fall back to the direct computation
+    // that either estimates the value or reports the error
+    EphemerisCache::SampleFunction function;
+    double tolerance = 0.0;
+    if (type == EphemerisCache::Type::Position) {
+        function = [this, from, to, frame](double t) -> std::optional<Sample> {
+            std::lock_guard spiceLock(_spiceMutex);
+            try {
+                if (!hasSpkCoverage(from, t) || !hasSpkCoverage(to, t)) {
+                    return std::nullopt;
+                }
+            }
+            catch (const SpiceException&) {
+                return std::nullopt;
+            }
+
+            double state[6];
+            double lightTime = 0.0;
+            spkezr_c(
+                from.c_str(),
+                t,
+                frame.c_str(),
+                "NONE",
+                to.c_str(),
+                state,
+                &lightTime
+            );
+            if (failed_c()) {
+                reset_c();
+                return std::nullopt;
+            }
+
+            Sample sample;
+            sample.position = glm::dvec3(state[0], state[1], state[2]);
+            sample.velocity = glm::dvec3(state[3], state[4], state[5]);
+            return sample;
+        };
+        tolerance = _ephemerisCacheSettings.positionTolerance;
+    }
+    else {
+        function = [this, from, to](double t) -> std::optional<Sample> {
+            std::lock_guard spiceLock(_spiceMutex);
+            glm::dmat3 m = glm::dmat3(1.0);
+            pxform_c(
+                from.c_str(),
+                to.c_str(),
+                t,
+                reinterpret_cast<double(*)[3]>(glm::value_ptr(m))
+            );
+            if (failed_c()) {
+                reset_c();
+                return std::nullopt;
+            }
+
+            Sample sample;
+            sample.rotation = glm::quat_cast(glm::transpose(m));
+            return sample;
+        };
+        tolerance = _ephemerisCacheSettings.rotationTolerance;
+    }
+
+    std::unique_ptr<EphemerisCache>& cache = _ephemerisCaches[key];
+    cache = std::make_unique<EphemerisCache>(
+        type,
+        std::move(function),
+        tolerance,
+        EphemerisSegmentLength
+    );
+    return *cache;
+}
+
 SpiceManager::FieldOfViewResult
 SpiceManager::fieldOfView(const std::string& instrument) const
 {
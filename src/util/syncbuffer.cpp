@@ -25,6 +25,7 @@
 #include <openspace/util/syncbuffer.h>
 
 #include <ghoul/misc/profiling.h>
+#include <algorithm>
 
 namespace openspace {
 
@@ -39,21 +40,15 @@ SyncBuffer::~SyncBuffer() {} // NOLINT
 void SyncBuffer::encode(const std::string& s) {
     ZoneScoped
 
-    int32_t anticpatedBufferSize = static_cast<int32_t>(
-        _encodeOffset + (sizeof(char) * s.size()) + sizeof(int32_t)
-    );
-    if (anticpatedBufferSize >= static_cast<int32_t>(_n)) {
-        _dataStream.resize(anticpatedBufferSize);
+    const size_t length = s.size() * sizeof(char);
+    if (_encodeOffset + sizeof(int32_t) + length > _dataStream.size()) {
+        ensureCapacity(sizeof(int32_t) + length);
     }
 
-    int32_t length = static_cast<int32_t>(s.size() * sizeof(char));
-    memcpy(
-        _dataStream.data() + _encodeOffset,
-        reinterpret_cast<const char*>(&length),
-        sizeof(int32_t)
-    );
+    const int32_t l = static_cast<int32_t>(length);
+    std::memcpy(_dataStream.data() + _encodeOffset, &l, sizeof(int32_t));
     _encodeOffset += sizeof(int32_t);
-    memcpy(_dataStream.data() + _encodeOffset, s.c_str(), length);
+    std::memcpy(_dataStream.data() + _encodeOffset, s.data(), length);
     _encodeOffset += length;
 }
 
@@ -61,17 +56,16 @@ std::string SyncBuffer::decode() {
     ZoneScoped
 
     int32_t length;
-    memcpy(
-        reinterpret_cast<char*>(&length),
-        _dataStream.data() + _decodeOffset,
-        sizeof(int32_t)
+    decode(length);
+    ghoul_assert(
+        _decodeOffset + length <= _decodeData.size,
+        "Reading past the data"
+    );
+    std::string ret(
+        reinterpret_cast<const char*>(_decodeData.data + _decodeOffset),
+        length
     );
-    std::vector<char> tmp(length + 1);
-    _decodeOffset += sizeof(int32_t);
-    memcpy(tmp.data(), _dataStream.data() + _decodeOffset, length);
     _decodeOffset += length;
-    tmp[length] = '\0';
-    std::string ret(tmp.data());
     return ret;
 }
 
@@ -81,46 +75,51 @@ void SyncBuffer::decode(std::string& s) {
 
 void SyncBuffer::decode(glm::quat& value) {
     const size_t size = sizeof(glm::quat);
-    ghoul_assert(_decodeOffset + size < _n, "");
-    std::memcpy(glm::value_ptr(value), _dataStream.data() + _decodeOffset, size);
+    ghoul_assert(_decodeOffset + size <= _decodeData.size, "Reading past the data");
+    std::memcpy(glm::value_ptr(value), _decodeData.data + _decodeOffset, size);
     _decodeOffset += size;
 }
 
 void SyncBuffer::decode(glm::dquat& value) {
     const size_t size = sizeof(glm::dquat);
-    ghoul_assert(_decodeOffset + size < _n, "");
-    std::memcpy(glm::value_ptr(value), _dataStream.data() + _decodeOffset, size);
+    ghoul_assert(_decodeOffset + size <= _decodeData.size, "Reading past the data");
+    std::memcpy(glm::value_ptr(value), _decodeData.data + _decodeOffset, size);
     _decodeOffset += size;
 }
 
 void SyncBuffer::decode(glm::vec3& value) {
     const size_t size = sizeof(glm::vec3);
-    ghoul_assert(_decodeOffset + size < _n, "");
-    std::memcpy(glm::value_ptr(value), _dataStream.data() + _decodeOffset, size);
+    ghoul_assert(_decodeOffset + size <= _decodeData.size, "Reading past the data");
+    std::memcpy(glm::value_ptr(value), _decodeData.data + _decodeOffset, size);
     _decodeOffset += size;
 }
 
 void SyncBuffer::decode(glm::dvec3& value) {
     const size_t size = sizeof(glm::dvec3);
-    ghoul_assert(_decodeOffset + size < _n, "");
-    std::memcpy(glm::value_ptr(value), _dataStream.data() + _decodeOffset, size);
+    ghoul_assert(_decodeOffset + size <= _decodeData.size, "Reading past the data");
+    std::memcpy(glm::value_ptr(value), _decodeData.data + _decodeOffset, size);
     _decodeOffset += size;
 }
 
-void SyncBuffer::setData(std::vector<std::byte> data) {
-    _dataStream = std::move(data);
+void SyncBuffer::setData(View data) {
+    _decodeData = data;
+    _decodeOffset = 0;
 }
 
-std::vector<std::byte> SyncBuffer::data() {
-    _dataStream.resize(_encodeOffset);
-
-    return _dataStream;
+SyncBuffer::View SyncBuffer::encodedData() const {
+    return { _dataStream.data(), _encodeOffset };
 }
 
 void SyncBuffer::reset() {
-    _dataStream.resize(_n);
     _encodeOffset = 0;
     _decodeOffset = 0;
+    _decodeData = View();
+}
+
+void SyncBuffer::ensureCapacity(size_t size) {
+    // Growing geometrically keeps the number of reallocations logarithmic in the size of
+    // the largest frame, after which the buffer is reused without any allocation
+    _dataStream.resize(std::max(_encodeOffset + size, 2 * _dataStream.size()));
 }
 
 } // namespace openspace
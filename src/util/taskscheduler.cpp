@@ -0,0 +1,380 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/util/taskscheduler.h>
+
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace {
+    constexpr const char* _loggerCat = "TaskScheduler";
+
+    // The scheduler and worker index of the calling thread, if it is a worker thread
+    thread_local const openspace::TaskScheduler* CurrentScheduler = nullptr;
+    thread_local int CurrentWorker = -1;
+
+    void executeTask(const std::function<void()>& task) {
+        try {
+            task();
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.message);
+        }
+        catch (const std::exception& e) {
+            LERROR(e.what());
+        }
+        catch (...) {
+            LERROR("Unknown exception in task");
+        }
+    }
+} // namespace
+
+namespace openspace {
+
+TaskScheduler::TaskScheduler(unsigned int nThreads, unsigned int nIoThreads) {
+    if (nThreads == 0) {
+        nThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    }
+    if (nIoThreads == 0) {
+        nIoThreads = 2 * nThreads;
+    }
+
+    _workers.reserve(nThreads);
+    for (unsigned int i = 0; i < nThreads; ++i) {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+    // The threads are started only after all workers exist as they steal from each other
+    for (unsigned int i = 0; i < nThreads; ++i) {
+        const int index = static_cast<int>(i);
+        _workers[i]->thread = std::thread([this, index]() { workerLoop(index); });
+    }
+
+    _ioThreads.reserve(nIoThreads);
+    for (unsigned int i = 0; i < nIoThreads; ++i) {
+        _ioThreads.emplace_back([this]() { ioLoop(); });
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard lock(_sleepMutex);
+        _shouldStop = true;
+    }
+    _wakeUp.notify_all();
+    {
+        std::lock_guard lock(_ioMutex);
+        _ioTasks.clear();
+        _nPendingIoTasks = 0;
+    }
+    _ioWakeUp.notify_all();
+
+    for (std::unique_ptr<Worker>& w : _workers) {
+        if (w->thread.joinable()) {
+            w->thread.join();
+        }
+    }
+    for (std::thread& t : _ioThreads) {
+        t.join();
+    }
+}
+
+void TaskScheduler::enqueue(std::function<void()> task, Priority priority) {
+    ghoul_assert(task, "Task must not be empty");
+
+    if (priority == Priority::IO) {
+        {
+            std::lock_guard lock(_ioMutex);
+            _ioTasks.push_back(std::move(task));
+            _nPendingIoTasks++;
+        }
+        _ioWakeUp.notify_one();
+        return;
+    }
+
+    // The counter has to be incremented before the task is published, otherwise a worker
+    // could pick up the task and decrement the counter first
+    _nPendingTasks++;
+
+    const int p = static_cast<int>(priority);
+    const int w = currentWorkerIndex();
+    if (w != -1) {
+        // Tasks spawned from within a worker stay local until someone steals them
+        std::lock_guard lock(_workers[w]->mutex);
+        _workers[w]->tasks[p].push_back(std::move(task));
+    }
+    else {
+        const unsigned int target = _nextWorker++ % _workers.size();
+        std::lock_guard lock(_workers[target]->mutex);
+        _workers[target]->tasks[p].push_back(std::move(task));
+    }
+
+    if (_nSleepingWorkers > 0) {
+        // Taking the lock here prevents a lost wakeup with a worker that has just checked
+        // the number of pending tasks but not started waiting yet
+        {
+            std::lock_guard lock(_sleepMutex);
+        }
+        _wakeUp.notify_one();
+    }
+}
+
+bool TaskScheduler::runPendingTask(Priority lowestPriority) {
+    std::function<void()> task;
+    const int w = currentWorkerIndex();
+    // IO tasks are never executed by a thread that is helping out
+    int lowest = std::min(static_cast<int>(lowestPriority), NumPriorities - 1);
+    if (w == -1) {
+        // Low priority tasks might block on IO and must never stall a foreign thread
+        lowest = std::min(lowest, static_cast<int>(Priority::Normal));
+    }
+    const bool hasTask = (w != -1) ?
+        popTask(w, task, lowest) :
+        stealTask(-1, task, lowest);
+    if (hasTask) {
+        executeTask(task);
+    }
+    return hasTask;
+}
+
+unsigned int TaskScheduler::numThreads() const {
+    return static_cast<unsigned int>(_workers.size());
+}
+
+unsigned int TaskScheduler::numIoThreads() const {
+    return static_cast<unsigned int>(_ioThreads.size());
+}
+
+size_t TaskScheduler::numPendingTasks() const {
+    return _nPendingTasks + _nPendingIoTasks;
+}
+
+size_t TaskScheduler::numStolenTasks() const {
+    return _nStolenTasks;
+}
+
+int TaskScheduler::currentWorkerIndex() const {
+    return CurrentScheduler == this ? CurrentWorker : -1;
+}
+
+void TaskScheduler::workerLoop(int index) {
+    CurrentScheduler = this;
+    CurrentWorker = index;
+
+    std::function<void()> task;
+    while (!_shouldStop) {
+        if (popTask(index, task, NumPriorities - 1)) {
+            executeTask(task);
+            task = nullptr;
+            continue;
+        }
+
+        if (_nPendingTasks > 0) {
+            // The counter is incremented before a task is published, so the enqueuing
+            // thread is about to finish. Waiting on the condition variable would return
+            // immediately, so we let the other thread run instead of spinning
+            std::this_thread::yield();
+            continue;
+        }
+
+        // The sleeping counter is incremented before the pending tasks are checked, so
+        // either we see the new task here or the enqueuing thread sees us sleeping
+        std::unique_lock lock(_sleepMutex);
+        _nSleepingWorkers++;
+        _wakeUp.wait(lock, [this]() { return _shouldStop || _nPendingTasks > 0; });
+        _nSleepingWorkers--;
+    }
+
+    CurrentScheduler = nullptr;
+    CurrentWorker = -1;
+}
+
+void TaskScheduler::ioLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(_ioMutex);
+            _ioWakeUp.wait(lock, [this]() { return _shouldStop || !_ioTasks.empty(); });
+            if (_shouldStop) {
+                return;
+            }
+            task = std::move(_ioTasks.front());
+            _ioTasks.pop_front();
+            _nPendingIoTasks--;
+        }
+        executeTask(task);
+    }
+}
+
+bool TaskScheduler::popTask(int index, std::function<void()>& task, int lowestPriority) {
+    ghoul_assert(index >= 0 && index < static_cast<int>(_workers.size()), "Bad index");
+
+    {
+        Worker& w = *_workers[index];
+        std::lock_guard lock(w.mutex);
+        for (int p = 0; p <= lowestPriority; ++p) {
+            std::deque<std::function<void()>>& queue = w.tasks[p];
+            if (!queue.empty()) {
+                task = std::move(queue.back());
+                queue.pop_back();
+                _nPendingTasks--;
+                return true;
+            }
+        }
+    }
+
+    return stealTask(index, task, lowestPriority);
+}
+
+bool TaskScheduler::stealTask(int thief, std::function<void()>& task,
+                              int lowestPriority)
+{
+    if (_nPendingTasks == 0) {
+        return false;
+    }
+
+    const int nWorkers = static_cast<int>(_workers.size());
+    // Start with the neighbor so that not all thieves hammer the first worker
+    const int start = thief == -1 ? 0 : thief + 1;
+    // The first pass skips the workers that are busy with their deque. If any of them was
+    // skipped, a second pass waits for their locks, as reporting that there is no task
+    // while tasks are pending would make the caller spin on the pending counter
+    bool wasContended = false;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int p = 0; p <= lowestPriority; ++p) {
+            for (int i = 0; i < nWorkers; ++i) {
+                const int victim = (start + i) % nWorkers;
+                if (victim == thief) {
+                    continue;
+                }
+
+                Worker& w = *_workers[victim];
+                std::unique_lock lock(w.mutex, std::defer_lock);
+                if (pass == 0 && !lock.try_lock()) {
+                    wasContended = true;
+                    continue;
+                }
+                if (pass == 1) {
+                    lock.lock();
+                }
+                if (w.tasks[p].empty()) {
+                    continue;
+                }
+
+                task = std::move(w.tasks[p].front());
+                w.tasks[p].pop_front();
+                _nPendingTasks--;
+                _nStolenTasks++;
+                return true;
+            }
+        }
+
+        if (!wasContended) {
+            break;
+        }
+    }
+
+    return false;
+}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler, TaskScheduler::Priority priority)
+    : _scheduler(scheduler)
+    , _priority(priority)
+{}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    }
+    catch (...) {
+        // The exception has been reported by the time a group is destroyed implicitly
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    _nPendingTasks++;
+    _scheduler.enqueue(
+        [this, t = std::move(task)]() {
+            try {
+                t();
+            }
+            catch (...) {
+                std::lock_guard lock(_mutex);
+                if (!_exception) {
+                    _exception = std::current_exception();
+                }
+            }
+
+            // Only the last task takes the lock. The final decrement has to happen under
+            // the lock as the group might be destroyed as soon as the waiting thread
+            // observes that no tasks are pending anymore
+            int pending = _nPendingTasks;
+            while (pending > 1 &&
+                   !_nPendingTasks.compare_exchange_weak(pending, pending - 1))
+            {}
+            if (pending > 1) {
+                return;
+            }
+
+            std::lock_guard lock(_mutex);
+            if (--_nPendingTasks == 0) {
+                _finished.notify_all();
+            }
+        },
+        _priority
+    );
+}
+
+void TaskGroup::wait() {
+    ZoneScoped
+
+    while (_nPendingTasks > 0) {
+        // Only tasks that are at least as important as our own are executed here so that
+        // a thread waiting for short compute tasks is not stalled by a long IO task
+        if (_scheduler.runPendingTask(_priority)) {
+            continue;
+        }
+
+        // Nothing left to help with, so the remaining tasks are executing on other
+        // workers. The timeout covers tasks that are enqueued while we are waiting
+        std::unique_lock lock(_mutex);
+        _finished.wait_for(
+            lock,
+            std::chrono::milliseconds(1),
+            [this]() { return _nPendingTasks == 0; }
+        );
+    }
+
+    std::lock_guard lock(_mutex);
+    if (_exception) {
+        std::exception_ptr e = std::exchange(_exception, nullptr);
+        std::rethrow_exception(e);
+    }
+}
+
+} // namespace openspace
@@ -24,79 +24,99 @@
 
 #include <openspace/util/threadpool.h>
 
-namespace openspace {
-
-Worker::Worker(ThreadPool& p) : pool(p) {}
+#include <openspace/engine/globals.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <utility>
 
-void Worker::operator()() {
-    std::function<void()> task;
-    while (true) {
-        // acquire lock
-        {
-            std::unique_lock<std::mutex> lock(pool.queue_mutex);
+namespace {
+    constexpr const char* _loggerCat = "ThreadPool";
 
-            // look for a work item
-            while (!pool.stop && pool.tasks.empty()) {
-                // if there are none wait for notification
-                pool.condition.wait(lock);
-            }
+    // The state of the pool whose task is executing on the calling thread, if any
+    thread_local const void* CurrentPoolState = nullptr;
+} // namespace
 
-            if (pool.stop) { // exit if the pool is stopped
-                return;
-            }
+namespace openspace {
 
-            // get the task from the queue
-            task = pool.tasks.front();
-            pool.tasks.pop_front();
+ThreadPool::ThreadPool(size_t numThreads, TaskScheduler::Priority priority)
+    : _maxConcurrency(std::max<size_t>(numThreads, 1))
+    , _state(std::make_shared<State>())
+{
+    ghoul_assert(global::taskScheduler, "No task scheduler");
+    _state->priority = priority;
+}
 
-        } // release lock
+ThreadPool::ThreadPool(const ThreadPool& toCopy)
+    : ThreadPool(toCopy._maxConcurrency, toCopy._state->priority)
+{}
 
-        // execute the task
-        task();
-    }
+ThreadPool::~ThreadPool() {
+    ghoul_assert(
+        CurrentPoolState != _state.get(),
+        "A ThreadPool must not be destroyed by one of its own tasks"
+    );
+
+    // Tasks that have not started yet are discarded, but the ones that are running might
+    // refer to the owner of this pool, so we have to wait for them to finish
+    std::unique_lock lock(_state->mutex);
+    _state->stop = true;
+    _state->tasks.clear();
+    _state->idle.wait(lock, [this]() { return _state->nRunning == 0; });
 }
 
-ThreadPool::ThreadPool(size_t numThreads) : stop(false) {
-    for (size_t i = 0; i < numThreads; ++i) {
-        workers.emplace_back(std::thread(Worker(*this)));
+void ThreadPool::enqueue(std::function<void()> f) {
+    {
+        std::lock_guard lock(_state->mutex);
+        _state->tasks.push_back(std::move(f));
+        if (_state->nRunning >= _maxConcurrency) {
+            // One of the running tasks will pick up the new task when it is done
+            return;
+        }
+        _state->nRunning++;
     }
+
+    std::shared_ptr<State> state = _state;
+    global::taskScheduler->enqueue([state]() { runNext(state); }, state->priority);
 }
 
-ThreadPool::ThreadPool(const ThreadPool& toCopy) : ThreadPool(toCopy.workers.size()) {}
+void ThreadPool::clearTasks() {
+    std::lock_guard lock(_state->mutex);
+    _state->tasks.clear();
+}
 
-// the destructor joins all threads
-ThreadPool::~ThreadPool() {
-    // stop all threads
+void ThreadPool::runNext(std::shared_ptr<State> state) {
+    std::function<void()> task;
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        stop = true;
+        std::lock_guard lock(state->mutex);
+        if (state->stop || state->tasks.empty()) {
+            state->nRunning--;
+            state->idle.notify_all();
+            return;
+        }
+        task = std::move(state->tasks.front());
+        state->tasks.pop_front();
     }
-    condition.notify_all();
 
-    // join them
-    for (std::thread& w : workers) {
-        w.join();
+    const void* previousState = std::exchange(CurrentPoolState, state.get());
+    try {
+        task();
     }
-}
-
-// add new work item to the pool
-void ThreadPool::enqueue(std::function<void()> f) {
-    { // acquire lock
-        std::unique_lock<std::mutex> lock(queue_mutex);
-
-        // add the task
-        tasks.push_back(std::move(f));
-    } // release lock
-
-    // wake up one thread
-    condition.notify_one();
-}
+    catch (const ghoul::RuntimeError& e) {
+        LERRORC(e.component, e.message);
+    }
+    catch (const std::exception& e) {
+        LERROR(e.what());
+    }
+    catch (...) {
+        LERROR("Unknown exception in task");
+    }
+    CurrentPoolState = previousState;
 
-void ThreadPool::clearTasks() {
-    { // acquire lock
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        tasks.clear();
-    } // release lock
+    // Instead of looping here, the continuation is handed back to the scheduler so that
+    // a long queue does not monopolize a worker thread that could steal other work
+    global::taskScheduler->enqueue([state]() { runNext(state); }, state->priority);
 }
 
 } // namespace openspace
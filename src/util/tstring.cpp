@@ -26,25 +26,28 @@
 
 #include <openspace/engine/globals.h>
 #include <openspace/util/memorymanager.h>
+#include <cstring>
 
 namespace openspace {
 
 tstring temporaryString(const std::string& str) {
-    void* ptr = global::memoryManager->TemporaryMemory.do_allocate(str.size(), 8);
-    std::strcpy(reinterpret_cast<char*>(ptr), str.data());
+    void* ptr = global::memoryManager->TemporaryMemory.allocate(str.size() + 1, 8);
+    std::memcpy(ptr, str.c_str(), str.size() + 1);
     return tstring(reinterpret_cast<char*>(ptr), str.size());
 }
 
 tstring temporaryString(std::string_view str) {
-    void* ptr = global::memoryManager->TemporaryMemory.do_allocate(str.size(), 8);
-    std::strcpy(reinterpret_cast<char*>(ptr), str.data());
+    // A std::string_view is not necessarily null-terminated
+    void* ptr = global::memoryManager->TemporaryMemory.allocate(str.size() + 1, 8);
+    std::memcpy(ptr, str.data(), str.size());
+    reinterpret_cast<char*>(ptr)[str.size()] = '\0';
     return tstring(reinterpret_cast<char*>(ptr), str.size());
 }
 
 tstring temporaryString(const char str[]) {
     size_t size = strlen(str);
-    void* ptr = global::memoryManager->TemporaryMemory.do_allocate(size, 8);
-    std::strcpy(reinterpret_cast<char*>(ptr), str);
+    void* ptr = global::memoryManager->TemporaryMemory.allocate(size + 1, 8);
+    std::memcpy(ptr, str, size + 1);
     return tstring(reinterpret_cast<char*>(ptr), size);
 }
 
@@ -0,0 +1,15 @@
+KPL/MK
+
+   Meta-kernel that loads the kernels that are needed to compute the position of the
+   Cassini spacecraft. The paths are relative to the directory of this file.
+
+\begindata
+
+   KERNELS_TO_LOAD = (
+      'naif0008.tls'
+      '981005_PLTEPH-DE405S.bsp'
+      '020514_SE_SAT105.bsp'
+      '030201AP_SK_SM546_T45.bsp'
+   )
+
+\begintext
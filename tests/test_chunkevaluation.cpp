@@ -0,0 +1,359 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/chunk.h>
+#include <modules/globebrowsing/src/ellipsoid.h>
+#include <openspace/util/taskscheduler.h>
+#include <ghoul/glm.h>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace {
+    using namespace openspace::globebrowsing;
+
+    constexpr const double EarthRadius = 6378137.0;
+
+    const Ellipsoid Earth = Ellipsoid(glm::dvec3(EarthRadius, EarthRadius, 6356752.0));
+
+    // Deterministic height ranges standing in for the values of a height layer
+    BoundingHeights heightsForTile(const TileIndex& ti) {
+        const float min = -100.f * static_cast<float>((ti.x + ti.y) % 4);
+        const float max = 500.f + 250.f * static_cast<float>((ti.x * 3 + ti.y) % 5);
+        return { min, max, true, true };
+    }
+
+    // Only the tile data up to a level that depends on the location is "available"
+    int levelByAvailableData(const TileIndex& ti) {
+        return (ti.x % 3 == 0) ?
+            ChunkEvaluation::UnknownDesiredLevel :
+            static_cast<int>(ti.level) + 1 + static_cast<int>(ti.y % 2);
+    }
+
+    // A stripped down version of the chunk trees of a RenderableGlobe without the tile
+    // providers. The split/merge logic is the same as in RenderableGlobe::updateChunkTree
+    class ChunkTree {
+    public:
+        using Evaluator = std::function<
+            void(const std::vector<ChunkEvaluation>&, const ChunkEvaluationContext&)
+        >;
+
+        ChunkTree()
+            : _leftRoot(TileIndex(0, 0, 1))
+            , _rightRoot(TileIndex(1, 0, 1))
+        {
+            initialize(_leftRoot);
+            initialize(_rightRoot);
+        }
+
+        ~ChunkTree() {
+            merge(_leftRoot);
+            merge(_rightRoot);
+        }
+
+        void update(const ChunkEvaluationContext& context, const Evaluator& evaluator) {
+            _evaluations.clear();
+            collect(_leftRoot);
+            collect(_rightRoot);
+            evaluator(_evaluations, context);
+            apply(_leftRoot);
+            apply(_rightRoot);
+        }
+
+        size_t numEvaluatedChunks() const {
+            return _evaluations.size();
+        }
+
+        const Chunk& leftRoot() const {
+            return _leftRoot;
+        }
+
+        const Chunk& rightRoot() const {
+            return _rightRoot;
+        }
+
+    private:
+        static bool isLeaf(const Chunk& cn) {
+            return cn.children[0] == nullptr;
+        }
+
+        static void initialize(Chunk& cn) {
+            cn.corners = boundingCornersForChunk(cn, Earth, heightsForTile(cn.tileIndex));
+        }
+
+        void collect(Chunk& cn) {
+            if (!isLeaf(cn)) {
+                for (Chunk* child : cn.children) {
+                    collect(*child);
+                }
+            }
+
+            ChunkEvaluation evaluation;
+            evaluation.chunk = &cn;
+            evaluation.heights = heightsForTile(cn.tileIndex);
+            evaluation.levelByAvailableData = levelByAvailableData(cn.tileIndex);
+            _evaluations.push_back(evaluation);
+        }
+
+        static void split(Chunk& cn) {
+            for (size_t i = 0; i < cn.children.size(); ++i) {
+                cn.children[i] = new Chunk(cn.tileIndex.child(static_cast<Quad>(i)));
+                cn.children[i]->tileRequestPriority = cn.tileRequestPriority / 4.f;
+                initialize(*cn.children[i]);
+            }
+        }
+
+        static void merge(Chunk& cn) {
+            for (Chunk*& child : cn.children) {
+                if (child) {
+                    merge(*child);
+                    delete child;
+                    child = nullptr;
+                }
+            }
+        }
+
+        bool apply(Chunk& cn) {
+            if (isLeaf(cn)) {
+                if (cn.status == Chunk::Status::WantSplit) {
+                    split(cn);
+                }
+                return cn.status == Chunk::Status::WantMerge;
+            }
+
+            char requestedMergeMask = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (apply(*cn.children[i])) {
+                    requestedMergeMask |= (1 << i);
+                }
+            }
+
+            if (requestedMergeMask == 0xf && (cn.status != Chunk::Status::WantSplit)) {
+                merge(cn);
+            }
+            return false;
+        }
+
+        Chunk _leftRoot;
+        Chunk _rightRoot;
+        std::vector<ChunkEvaluation> _evaluations;
+    };
+
+    ChunkEvaluationContext cameraContext(const glm::dvec3& position) {
+        const glm::dmat4 projection = glm::perspective(
+            glm::radians(60.0),
+            16.0 / 9.0,
+            1.0,
+            1e10
+        );
+        const glm::dmat4 view = glm::lookAt(
+            position,
+            glm::dvec3(0.0),
+            glm::dvec3(0.0, 0.0, 1.0)
+        );
+
+        ChunkEvaluationContext context;
+        context.ellipsoid = &Earth;
+        context.cameraPosition = position;
+        context.mvp = projection * view;
+        context.lodScaleFactor = 15.0;
+        context.updateCorners = false;
+        return context;
+    }
+
+    // A camera that circles the globe at twice its radius in an inclined orbit
+    glm::dvec3 orbitPosition(int frame) {
+        const double t = 0.05 * frame;
+        return 2.0 * EarthRadius * glm::dvec3(
+            std::cos(t),
+            std::sin(t) * std::cos(0.4),
+            std::sin(t) * std::sin(0.4)
+        );
+    }
+
+    // A camera that approaches the surface until it hovers a few hundred meters above it
+    glm::dvec3 approachPosition(int frame) {
+        const double altitude = 1e7 * std::pow(0.9, frame) + 300.0;
+        const glm::dvec3 direction = glm::normalize(glm::dvec3(0.6, 0.2, 0.5));
+        return (EarthRadius + altitude) * direction;
+    }
+
+    void evaluateSerially(const std::vector<ChunkEvaluation>& evaluations,
+                          const ChunkEvaluationContext& context)
+    {
+        for (const ChunkEvaluation& evaluation : evaluations) {
+            evaluateChunk(evaluation, context);
+        }
+    }
+
+    void requireEqual(const Chunk& lhs, const Chunk& rhs) {
+        REQUIRE(lhs.tileIndex == rhs.tileIndex);
+        REQUIRE(lhs.status == rhs.status);
+        REQUIRE(lhs.isVisible == rhs.isVisible);
+        REQUIRE(lhs.tileRequestPriority == rhs.tileRequestPriority);
+        for (size_t i = 0; i < lhs.corners.size(); ++i) {
+            REQUIRE(lhs.corners[i] == rhs.corners[i]);
+        }
+
+        for (size_t i = 0; i < lhs.children.size(); ++i) {
+            REQUIRE((lhs.children[i] == nullptr) == (rhs.children[i] == nullptr));
+            if (lhs.children[i]) {
+                requireEqual(*lhs.children[i], *rhs.children[i]);
+            }
+        }
+    }
+
+    int maximumLevel(const Chunk& cn) {
+        int res = cn.tileIndex.level;
+        for (const Chunk* child : cn.children) {
+            if (child) {
+                res = std::max(res, maximumLevel(*child));
+            }
+        }
+        return res;
+    }
+} // namespace
+
+TEST_CASE("ChunkEvaluation: Parallel evaluation matches serial", "[chunkevaluation]") {
+    openspace::TaskScheduler scheduler(4);
+    auto evaluateParallel = [&scheduler](const std::vector<ChunkEvaluation>& e,
+                                         const ChunkEvaluationContext& context)
+    {
+        evaluateChunks(e, context, scheduler);
+    };
+
+    using Path = glm::dvec3(*)(int);
+    for (Path path : { &orbitPosition, &approachPosition }) {
+        ChunkTree serial;
+        ChunkTree parallel;
+
+        for (int frame = 0; frame < 80; ++frame) {
+            ChunkEvaluationContext context = cameraContext(path(frame));
+            context.levelByProjectedArea = (frame % 10) != 9;
+            context.updateCorners = (frame % 20) == 0;
+
+            serial.update(context, &evaluateSerially);
+            parallel.update(context, evaluateParallel);
+
+            REQUIRE(serial.numEvaluatedChunks() == parallel.numEvaluatedChunks());
+            requireEqual(serial.leftRoot(), parallel.leftRoot());
+            requireEqual(serial.rightRoot(), parallel.rightRoot());
+        }
+    }
+}
+
+TEST_CASE("ChunkEvaluation: Horizon culling", "[chunkevaluation]") {
+    // The camera is located above longitude 0 at three times the radius, so the horizon
+    // is at ~70 degrees from the point below the camera
+    const ChunkEvaluationContext context = cameraContext(
+        glm::dvec3(3.0 * EarthRadius, 0.0, 0.0)
+    );
+
+    // Chunks on level 3 are 45 degrees wide
+    for (uint32_t x = 0; x < 8; ++x) {
+        for (uint32_t y = 0; y < 4; ++y) {
+            Chunk chunk = Chunk(TileIndex(x, y, 3));
+            ChunkEvaluation evaluation;
+            evaluation.chunk = &chunk;
+            evaluation.heights = { 0.f, 0.f, true, true };
+            chunk.corners = boundingCornersForChunk(chunk, Earth, evaluation.heights);
+
+            evaluateChunk(evaluation, context);
+
+            const GeodeticPatch& p = chunk.surfacePatch;
+            const bool isBehindGlobe = p.maxLon() < -glm::half_pi<double>() ||
+                                       p.minLon() > glm::half_pi<double>();
+            if (isBehindGlobe) {
+                REQUIRE_FALSE(chunk.isVisible);
+                REQUIRE(chunk.tileRequestPriority == 0.f);
+            }
+
+            const Geodetic2 subCameraPoint = { 0.0, 0.0 };
+            if (p.contains(subCameraPoint)) {
+                REQUIRE(chunk.isVisible);
+                REQUIRE(chunk.tileRequestPriority > 0.f);
+            }
+        }
+    }
+}
+
+TEST_CASE("ChunkEvaluation: Level increases when approaching", "[chunkevaluation]") {
+    ChunkTree tree;
+
+    int previousLevel = 0;
+    for (int frame = 0; frame < 120; frame += 20) {
+        // Let the trees converge as only one level is split per update
+        for (int i = 0; i < 30; ++i) {
+            tree.update(cameraContext(approachPosition(frame)), &evaluateSerially);
+        }
+
+        const int level = std::max(
+            maximumLevel(tree.leftRoot()),
+            maximumLevel(tree.rightRoot())
+        );
+        REQUIRE(level >= previousLevel);
+        previousLevel = level;
+    }
+    REQUIRE(previousLevel > 10);
+}
+
+TEST_CASE("ChunkEvaluation: Benchmark", "[.benchmark][chunkevaluation]") {
+    constexpr const int NumFrames = 400;
+
+    openspace::TaskScheduler scheduler;
+    auto evaluateParallel = [&scheduler](const std::vector<ChunkEvaluation>& e,
+                                         const ChunkEvaluationContext& context)
+    {
+        evaluateChunks(e, context, scheduler);
+    };
+
+    auto measureMs = [](const ChunkTree::Evaluator& evaluator, glm::dvec3(*path)(int)) {
+        ChunkTree tree;
+        size_t nChunks = 0;
+        auto begin = std::chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < NumFrames; ++frame) {
+            tree.update(cameraContext(path(frame % 100)), evaluator);
+            nChunks += tree.numEvaluatedChunks();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::make_pair(
+            std::chrono::duration<double, std::milli>(end - begin).count(),
+            nChunks / NumFrames
+        );
+    };
+
+    std::cout << "Threads: " << scheduler.numThreads() << '\n';
+    using Path = glm::dvec3(*)(int);
+    for (Path path : { &orbitPosition, &approachPosition }) {
+        const auto [serialMs, nChunks] = measureMs(&evaluateSerially, path);
+        const auto [parallelMs, _] = measureMs(evaluateParallel, path);
+        std::cout << "Chunks: " << nChunks << '\n'
+            << "Serial:   " << serialMs / NumFrames << " ms/frame\n"
+            << "Parallel: " << parallelMs / NumFrames << " ms/frame\n";
+    }
+}
@@ -77,6 +77,18 @@ namespace {
         VerboseProduct _product;
     };
 
+    struct IndexJob : public openspace::Job<int> {
+        explicit IndexJob(int index) : _index(index) {}
+
+        virtual void execute() override {}
+
+        virtual int product() override {
+            return _index;
+        }
+
+        int _index;
+    };
+
 } // namespace
 
 TEST_CASE("ConcurrentJobmanager: Basic", "[concurrentjobmanager]") {
@@ -127,3 +139,54 @@ TEST_CASE("ConcurrentJobmanager: Job Creation", "[concurrentjobmanager]") {
         auto product = finishedJob->product();
     }
 }
+
+TEST_CASE("ConcurrentJobmanager: Overflow", "[concurrentjobmanager]") {
+    using namespace openspace;
+
+    // More jobs finish than fit into the queue of finished jobs. The worker is allowed to
+    // get ahead by twice the queue size before it has to wait for the jobs to be popped
+    ConcurrentJobManager<int> jobManager(ThreadPool(1), 4);
+    constexpr const int NumJobs = 20;
+    for (int i = 0; i < NumJobs; ++i) {
+        jobManager.enqueueJob(std::make_shared<IndexJob>(i));
+    }
+
+    for (int i = 0; i < 200 && jobManager.numFinishedJobs() < 8; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(jobManager.numFinishedJobs() == 8);
+
+    REQUIRE(jobManager.popFinishedJob()->product() == 0);
+    REQUIRE(jobManager.popFinishedJob()->product() == 1);
+
+    // Popping makes room for the remaining jobs, which have to arrive in order
+    int next = 2;
+    for (int i = 0; i < 200 && next < NumJobs; ++i) {
+        std::vector<std::shared_ptr<Job<int>>> jobs = jobManager.popFinishedJobs();
+        for (const std::shared_ptr<Job<int>>& job : jobs) {
+            REQUIRE(job->product() == next);
+            next++;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(next == NumJobs);
+    REQUIRE(jobManager.numFinishedJobs() == 0);
+}
+
+TEST_CASE("ConcurrentJobmanager: Destroy While Full", "[concurrentjobmanager]") {
+    using namespace openspace;
+
+    // The worker is waiting for room when the manager is destroyed and must not keep the
+    // thread pool from shutting down
+    {
+        ConcurrentJobManager<int> jobManager(ThreadPool(1), 2);
+        for (int i = 0; i < 10; ++i) {
+            jobManager.enqueueJob(std::make_shared<IndexJob>(i));
+        }
+        for (int i = 0; i < 200 && jobManager.numFinishedJobs() < 4; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        REQUIRE(jobManager.numFinishedJobs() == 4);
+    }
+}
@@ -25,6 +25,48 @@
 #include "catch2/catch.hpp"
 
 #include <openspace/util/concurrentqueue.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Pushes nItems items from each of nProducers threads while a single consumer (the
+    // render thread in our use cases) drains the queue in batches. Returns the elapsed
+    // time in milliseconds
+    template <typename Queue>
+    double measureThroughput(Queue& queue, int nProducers, int nItems) {
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < nProducers; ++p) {
+            producers.emplace_back([&queue, nItems]() {
+                for (int i = 0; i < nItems; ++i) {
+                    queue.push(i);
+                }
+            });
+        }
+
+        long long nReceived = 0;
+        const long long nTotal = static_cast<long long>(nProducers) * nItems;
+        while (nReceived < nTotal) {
+            const size_t n = queue.popAll().size();
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            nReceived += static_cast<long long>(n);
+        }
+
+        for (std::thread& t : producers) {
+            t.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+} // namespace
 
 TEST_CASE("ConcurrentQueue: Basic", "[concurrentqueue]") {
     using namespace openspace;
@@ -34,3 +76,217 @@ TEST_CASE("ConcurrentQueue: Basic", "[concurrentqueue]") {
     int val = q1.pop();
     REQUIRE(val == 4);
 }
+
+TEST_CASE("ConcurrentQueue: TryPop and PopAll", "[concurrentqueue]") {
+    using namespace openspace;
+
+    ConcurrentQueue<int> q;
+    int val = 0;
+    REQUIRE_FALSE(q.tryPop(val));
+
+    q.push(1);
+    q.push(2);
+    q.push(3);
+    REQUIRE(q.tryPop(val));
+    REQUIRE(val == 1);
+    REQUIRE(q.popAll() == std::vector<int>{ 2, 3 });
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("BoundedConcurrentQueue: Basic", "[concurrentqueue]") {
+    using namespace openspace;
+
+    BoundedConcurrentQueue<int> q(4);
+    REQUIRE(q.capacity() == 4);
+    REQUIRE(q.empty());
+
+    q.push(4);
+    REQUIRE(q.size() == 1);
+    int val = q.pop();
+    REQUIRE(val == 4);
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("BoundedConcurrentQueue: Capacity", "[concurrentqueue]") {
+    using namespace openspace;
+
+    BoundedConcurrentQueue<int> q(3);
+    REQUIRE(q.capacity() == 4);
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(q.tryPush(i));
+    }
+    REQUIRE_FALSE(q.tryPush(4));
+    REQUIRE(q.size() == 4);
+
+    int val = -1;
+    REQUIRE(q.tryPop(val));
+    REQUIRE(val == 0);
+    REQUIRE(q.tryPush(4));
+
+    // Wrapping around the ring buffer has to preserve the order
+    REQUIRE(q.popAll() == std::vector<int>{ 1, 2, 3, 4 });
+    REQUIRE_FALSE(q.tryPop(val));
+}
+
+TEST_CASE("BoundedConcurrentQueue: Ownership", "[concurrentqueue]") {
+    using namespace openspace;
+
+    BoundedConcurrentQueue<std::shared_ptr<int>> q(2);
+    std::shared_ptr<int> item = std::make_shared<int>(5);
+    q.push(item);
+    REQUIRE(item.use_count() == 2);
+
+    std::shared_ptr<int> popped = q.pop();
+    // The queue must not keep the popped item alive
+    REQUIRE(item.use_count() == 2);
+    REQUIRE(*popped == 5);
+}
+
+TEST_CASE("BoundedConcurrentQueue: Producers and Consumers", "[concurrentqueue]") {
+    using namespace openspace;
+
+    constexpr const int NumProducers = 4;
+    constexpr const int NumConsumers = 3;
+    constexpr const int NumItems = 20000;
+
+    BoundedConcurrentQueue<int> q(64);
+    std::atomic<long long> sum = 0;
+    std::atomic<int> nReceived = 0;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < NumProducers; ++p) {
+        threads.emplace_back([&q]() {
+            for (int i = 1; i <= NumItems; ++i) {
+                q.push(i);
+            }
+        });
+    }
+    for (int c = 0; c < NumConsumers; ++c) {
+        threads.emplace_back([&]() {
+            int val = 0;
+            while (nReceived < NumProducers * NumItems) {
+                if (q.tryPop(val)) {
+                    sum += val;
+                    nReceived++;
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    const long long expected =
+        static_cast<long long>(NumProducers) * NumItems * (NumItems + 1) / 2;
+    REQUIRE(nReceived == NumProducers * NumItems);
+    REQUIRE(sum == expected);
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("OverflowingConcurrentQueue: Overflow", "[concurrentqueue]") {
+    using namespace openspace;
+
+    OverflowingConcurrentQueue<int> q(2);
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(q.push(i));
+    }
+    REQUIRE(q.size() == 4);
+
+    // Popping from the lock-free queue makes room in it, but the next item still has to
+    // go behind the ones that overflowed
+    int val = -1;
+    REQUIRE(q.tryPop(val));
+    REQUIRE(val == 0);
+    REQUIRE(q.push(4));
+    REQUIRE(q.tryPop(val));
+    REQUIRE(val == 1);
+    REQUIRE(q.popAll() == std::vector<int>{ 2, 3, 4 });
+    REQUIRE_FALSE(q.tryPop(val));
+}
+
+TEST_CASE("OverflowingConcurrentQueue: Producers", "[concurrentqueue]") {
+    using namespace openspace;
+
+    constexpr const int NumProducers = 4;
+    constexpr const int NumItems = 5000;
+
+    OverflowingConcurrentQueue<std::pair<int, int>> q(16);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < NumProducers; ++p) {
+        producers.emplace_back([&q, p]() {
+            for (int i = 0; i < NumItems; ++i) {
+                q.push({ p, i });
+            }
+        });
+    }
+
+    // The items of each producer have to arrive in the order in which they were pushed
+    // and the producers have to wait rather than letting the queue grow
+    std::vector<int> next(NumProducers, 0);
+    size_t maxSize = 0;
+    int nReceived = 0;
+    std::pair<int, int> item;
+    while (nReceived < NumProducers * NumItems) {
+        maxSize = std::max(maxSize, q.size());
+        if (q.tryPop(item)) {
+            REQUIRE(item.second == next[item.first]);
+            next[item.first]++;
+            nReceived++;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    for (std::thread& t : producers) {
+        t.join();
+    }
+    REQUIRE(maxSize <= 32);
+    REQUIRE(q.size() == 0);
+}
+
+TEST_CASE("OverflowingConcurrentQueue: Close", "[concurrentqueue]") {
+    using namespace openspace;
+
+    OverflowingConcurrentQueue<int> q(2);
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(q.push(i));
+    }
+
+    // The producer waits for room until the queue is closed and then drops the item
+    std::atomic_bool hasPushed = false;
+    std::thread producer([&]() {
+        REQUIRE_FALSE(q.push(4));
+        hasPushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE_FALSE(hasPushed);
+    q.close();
+    producer.join();
+    REQUIRE(hasPushed);
+    REQUIRE(q.size() == 4);
+}
+
+TEST_CASE("ConcurrentQueue: Throughput Benchmark", "[.benchmark][concurrentqueue]") {
+    using namespace openspace;
+
+    constexpr const int NumItems = 200000;
+    const int maxProducers =
+        std::max(static_cast<int>(std::thread::hardware_concurrency()), 2);
+
+    for (int nProducers = 1; nProducers <= maxProducers; nProducers *= 2) {
+        ConcurrentQueue<int> locked;
+        const double lockedMs = measureThroughput(locked, nProducers, NumItems);
+
+        BoundedConcurrentQueue<int> lockFree(4096);
+        const double lockFreeMs = measureThroughput(lockFree, nProducers, NumItems);
+
+        const double nTotal = static_cast<double>(nProducers) * NumItems;
+        std::cout << nProducers << " producer(s): "
+            << "ConcurrentQueue " << nTotal / lockedMs / 1000.0 << " Mitems/s, "
+            << "BoundedConcurrentQueue " << nTotal / lockFreeMs / 1000.0 << " Mitems/s\n";
+    }
+}
@@ -0,0 +1,302 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/disktilecache.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace {
+    using openspace::globebrowsing::RawTile;
+    using openspace::globebrowsing::TileIndex;
+    using openspace::globebrowsing::TileTextureInitData;
+    using openspace::globebrowsing::cache::DiskTileCache;
+
+    TileTextureInitData initData() {
+        return TileTextureInitData(
+            64,
+            64,
+            GL_UNSIGNED_BYTE,
+            ghoul::opengl::Texture::Format::RGBA,
+            TileTextureInitData::PadTiles::No
+        );
+    }
+
+    // The size of the file of one tile with the init data above, including the 56 byte
+    // footer that identifies the tile
+    uint64_t tileFileSize() {
+        return initData().totalNumBytes + sizeof(openspace::globebrowsing::TileMetaData) +
+            56;
+    }
+
+    RawTile createTile(const TileIndex& tileIndex, int seed) {
+        const TileTextureInitData data = initData();
+        RawTile tile;
+        tile.imageData = std::unique_ptr<std::byte[]>(new std::byte[data.totalNumBytes]);
+        for (size_t i = 0; i < data.totalNumBytes; ++i) {
+            tile.imageData[i] = static_cast<std::byte>((i * 7 + seed) % 251);
+        }
+        tile.tileMetaData.nValues = 4;
+        for (int i = 0; i < 4; ++i) {
+            tile.tileMetaData.minValues[i] = static_cast<float>(seed - i);
+            tile.tileMetaData.maxValues[i] = static_cast<float>(seed + i);
+            tile.tileMetaData.hasMissingData[i] = (i % 2 == 0);
+        }
+        tile.textureInitData = data;
+        tile.tileIndex = tileIndex;
+        return tile;
+    }
+
+    bool isSameTile(const RawTile& lhs, const RawTile& rhs) {
+        const size_t size = initData().totalNumBytes;
+        return lhs.tileIndex == rhs.tileIndex &&
+            std::equal(
+                lhs.imageData.get(), lhs.imageData.get() + size,
+                rhs.imageData.get()
+            ) &&
+            lhs.tileMetaData.nValues == rhs.tileMetaData.nValues &&
+            lhs.tileMetaData.minValues == rhs.tileMetaData.minValues &&
+            lhs.tileMetaData.maxValues == rhs.tileMetaData.maxValues &&
+            lhs.tileMetaData.hasMissingData == rhs.tileMetaData.hasMissingData;
+    }
+
+    std::filesystem::path emptyFolder(const std::string& name) {
+        const std::filesystem::path folder = absPath("${TESTDIR}/" + name);
+        std::filesystem::remove_all(folder);
+        return folder;
+    }
+
+    size_t countFiles(const std::filesystem::path& folder) {
+        namespace fs = std::filesystem;
+        size_t res = 0;
+        for (const fs::directory_entry& e : fs::recursive_directory_iterator(folder)) {
+            res += e.is_regular_file() ? 1 : 0;
+        }
+        return res;
+    }
+} // namespace
+
+TEST_CASE("DiskTileCache: Put And Get", "[disktilecache]") {
+    const std::filesystem::path folder = emptyFolder("disktilecache_putget");
+    const TileIndex index = TileIndex(3, 5, 4);
+    const RawTile tile = createTile(index, 1);
+
+    {
+        DiskTileCache cache(folder, 1 << 30);
+        CHECK_FALSE(cache.get(1, index, initData()).has_value());
+        cache.put(1, tile);
+        CHECK(cache.size() == tileFileSize());
+
+        std::optional<RawTile> read = cache.get(1, index, initData());
+        REQUIRE(read.has_value());
+        CHECK(isSameTile(*read, tile));
+        REQUIRE(read->textureInitData.has_value());
+        CHECK(read->textureInitData->hashKey == initData().hashKey);
+        CHECK(read->error == RawTile::ReadError::None);
+
+        // Other providers and other tiles of the same provider are not found
+        CHECK_FALSE(cache.get(2, index, initData()).has_value());
+        CHECK_FALSE(cache.get(1, TileIndex(3, 5, 5), initData()).has_value());
+        CHECK_FALSE(cache.get(1, TileIndex(5, 3, 4), initData()).has_value());
+
+        // Replacing a tile doesn't change the size
+        const RawTile replacement = createTile(index, 2);
+        cache.put(1, replacement);
+        CHECK(cache.size() == tileFileSize());
+        read = cache.get(1, index, initData());
+        REQUIRE(read.has_value());
+        CHECK(isSameTile(*read, replacement));
+
+        const DiskTileCache::Stats stats = cache.stats();
+        CHECK(stats.nHits == 2);
+        CHECK(stats.nMisses == 4);
+    }
+
+    // The tiles are still there in the next session
+    DiskTileCache cache(folder, 1 << 30);
+    CHECK(cache.size() == tileFileSize());
+    std::optional<RawTile> read = cache.get(1, index, initData());
+    REQUIRE(read.has_value());
+    CHECK(isSameTile(*read, createTile(index, 2)));
+
+    cache.clear();
+    CHECK(cache.size() == 0);
+    CHECK_FALSE(cache.get(1, index, initData()).has_value());
+    CHECK(countFiles(folder) == 0);
+}
+
+TEST_CASE("DiskTileCache: Least Recently Used", "[disktilecache]") {
+    const std::filesystem::path folder = emptyFolder("disktilecache_lru");
+    const uint64_t budget = 3 * tileFileSize();
+
+    {
+        DiskTileCache cache(folder, budget);
+        for (uint32_t i = 0; i < 3; ++i) {
+            cache.put(7, createTile(TileIndex(i, 0, 2), i));
+        }
+        CHECK(cache.size() == budget);
+
+        // Using the first tile makes the second one the least recently used
+        CHECK(cache.get(7, TileIndex(0, 0, 2), initData()).has_value());
+        cache.put(7, createTile(TileIndex(3, 0, 2), 3));
+        CHECK(cache.size() == budget);
+        CHECK(cache.stats().nEvicted == 1);
+        CHECK(countFiles(folder) == 3);
+
+        CHECK_FALSE(cache.get(7, TileIndex(1, 0, 2), initData()).has_value());
+        CHECK(cache.get(7, TileIndex(0, 0, 2), initData()).has_value());
+        CHECK(cache.get(7, TileIndex(2, 0, 2), initData()).has_value());
+        CHECK(cache.get(7, TileIndex(3, 0, 2), initData()).has_value());
+    }
+
+    // A smaller budget in the next session removes the tiles right away
+    DiskTileCache cache(folder, tileFileSize());
+    CHECK(cache.size() == tileFileSize());
+    CHECK(countFiles(folder) == 1);
+}
+
+TEST_CASE("DiskTileCache: Damaged Files", "[disktilecache]") {
+    namespace fs = std::filesystem;
+
+    const fs::path folder = emptyFolder("disktilecache_damaged");
+    DiskTileCache cache(folder, 1 << 30);
+    const TileIndex index = TileIndex(1, 2, 3);
+    cache.put(9, createTile(index, 4));
+
+    fs::path file;
+    for (const fs::directory_entry& e : fs::recursive_directory_iterator(folder)) {
+        if (e.is_regular_file()) {
+            file = e.path();
+        }
+    }
+    REQUIRE(!file.empty());
+
+    SECTION("Changed byte") {
+        std::fstream stream(file, std::ios::binary | std::ios::in | std::ios::out);
+        stream.seekp(100);
+        stream.put('x');
+    }
+
+    SECTION("Truncated") {
+        fs::resize_file(file, fs::file_size(file) - 1);
+    }
+
+    SECTION("Other tile") {
+        // A valid file of another tile in the place of this one
+        DiskTileCache other(emptyFolder("disktilecache_other"), 1 << 30);
+        other.put(9, createTile(TileIndex(2, 2, 3), 4));
+        fs::path otherFile;
+        for (const fs::directory_entry& e :
+             fs::recursive_directory_iterator(absPath("${TESTDIR}/disktilecache_other")))
+        {
+            if (e.is_regular_file()) {
+                otherFile = e.path();
+            }
+        }
+        fs::copy_file(otherFile, file, fs::copy_options::overwrite_existing);
+    }
+
+    CHECK_FALSE(cache.get(9, index, initData()).has_value());
+    CHECK(cache.stats().nCorrupt == 1);
+    CHECK(cache.size() == 0);
+    CHECK_FALSE(fs::exists(file));
+}
+
+TEST_CASE("DiskTileCache: Concurrent Access", "[disktilecache]") {
+    constexpr const int NThreads = 4;
+    constexpr const uint32_t NTiles = 16;
+
+    const std::filesystem::path folder = emptyFolder("disktilecache_concurrent");
+    // Room for half of the tiles, so that tiles are evicted while others are read
+    DiskTileCache cache(folder, NTiles / 2 * tileFileSize());
+
+    std::vector<std::thread> threads;
+    std::vector<int> nWrong(NThreads, 0);
+    for (int t = 0; t < NThreads; ++t) {
+        threads.emplace_back([&cache, &nWrong, t]() {
+            for (int round = 0; round < 8; ++round) {
+                // Every tile is requested twice in a row to get hits in between the
+                // evictions
+                for (uint32_t i = 0; i < 2 * NTiles; ++i) {
+                    const TileIndex index = TileIndex(i / 2, t % 2, 6);
+                    const RawTile expected = createTile(index, static_cast<int>(i / 2));
+                    std::optional<RawTile> tile = cache.get(3, index, initData());
+                    if (!tile) {
+                        cache.put(3, expected);
+                    }
+                    else if (!isSameTile(*tile, expected)) {
+                        nWrong[t]++;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    for (int n : nWrong) {
+        CHECK(n == 0);
+    }
+    CHECK(cache.size() <= NTiles / 2 * tileFileSize());
+    CHECK(cache.size() == countFiles(folder) * tileFileSize());
+    CHECK(cache.stats().nCorrupt == 0);
+    CHECK(cache.stats().nHits > 0);
+}
+
+TEST_CASE("DiskTileCache: Concurrent Eviction", "[disktilecache]") {
+    constexpr const int NThreads = 4;
+
+    const std::filesystem::path folder = emptyFolder("disktilecache_eviction");
+    // Room for a single tile, so that every put evicts the tile that another thread
+    // might be putting again at the same time
+    DiskTileCache cache(folder, tileFileSize());
+    const RawTile tiles[2] = {
+        createTile(TileIndex(0, 0, 2), 0),
+        createTile(TileIndex(1, 0, 2), 1)
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NThreads; ++t) {
+        threads.emplace_back([&cache, &tiles, t]() {
+            for (int i = 0; i < 200; ++i) {
+                cache.put(5, tiles[(i + t) % 2]);
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    // The registered tile still has its file
+    REQUIRE(cache.size() == tileFileSize());
+    CHECK(countFiles(folder) == 1);
+    const bool hasTile = cache.get(5, tiles[0].tileIndex, initData()).has_value() ||
+        cache.get(5, tiles[1].tileIndex, initData()).has_value();
+    CHECK(hasTile);
+}
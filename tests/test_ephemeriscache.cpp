@@ -0,0 +1,217 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/util/ephemeriscache.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Sample = openspace::EphemerisCache::Sample;
+
+    // A circular orbit with a radius of 7000 and a period of 5400 seconds
+    constexpr const double Radius = 7000.0;
+    constexpr const double AngularVelocity = 2.0 * 3.14159265358979323846 / 5400.0;
+
+    std::optional<Sample> orbit(double time) {
+        const double angle = AngularVelocity * time;
+        Sample s;
+        s.position = Radius * glm::dvec3(std::cos(angle), std::sin(angle), 0.0);
+        s.velocity = Radius * AngularVelocity *
+            glm::dvec3(-std::sin(angle), std::cos(angle), 0.0);
+        return s;
+    }
+
+    // A body that spins around the z axis exactly twice per hour
+    std::optional<Sample> spin(double time) {
+        Sample s;
+        s.rotation = glm::angleAxis(
+            2.0 * 2.0 * 3.14159265358979323846 / 3600.0 * time,
+            glm::dvec3(0.0, 0.0, 1.0)
+        );
+        return s;
+    }
+
+    double angleBetween(const glm::dquat& a, const glm::dquat& b) {
+        const glm::dquat q = glm::dot(a, b) < 0.0 ? -b : b;
+        const glm::dquat diff = a - q;
+        return 4.0 * std::asin(std::min(std::sqrt(glm::dot(diff, diff)) / 2.0, 1.0));
+    }
+
+    std::vector<double> testTimes(size_t n, double begin, double end) {
+        std::mt19937 gen(1337);
+        std::uniform_real_distribution<double> dist(begin, end);
+        std::vector<double> times(n);
+        std::generate(times.begin(), times.end(), [&]() { return dist(gen); });
+        return times;
+    }
+} // namespace
+
+TEST_CASE("EphemerisCache: Position Within Tolerance", "[ephemeriscache]") {
+    using namespace openspace;
+
+    constexpr const double Tolerance = 1e-3;
+    EphemerisCache cache(EphemerisCache::Type::Position, orbit, Tolerance, 86400.0);
+
+    for (double t : testTimes(2000, -100000.0, 100000.0)) {
+        std::optional<Sample> value = cache.value(t);
+        REQUIRE(value.has_value());
+        // The error is measured at test points, so it can be slightly exceeded elsewhere
+        REQUIRE(glm::distance(value->position, orbit(t)->position) < 2.0 * Tolerance);
+    }
+
+}
+
+TEST_CASE("EphemerisCache: Fewer Evaluations Than Requests", "[ephemeriscache]") {
+    using namespace openspace;
+
+    EphemerisCache cache(EphemerisCache::Type::Position, orbit, 1e-3, 86400.0);
+
+    // Simulate 2000 frames in which the time advances by one second each
+    for (int i = 0; i < 2000; ++i) {
+        REQUIRE(cache.value(static_cast<double>(i)).has_value());
+    }
+
+    const EphemerisCache::Statistics stats = cache.statistics();
+    CHECK(stats.nHits > 0);
+    CHECK(stats.nMisses > 0);
+    CHECK(stats.nEvaluations < 2000 / 4);
+}
+
+TEST_CASE("EphemerisCache: Exact At Samples", "[ephemeriscache]") {
+    using namespace openspace;
+
+    EphemerisCache cache(EphemerisCache::Type::Position, orbit, 1e-3, 86400.0);
+    std::optional<Sample> value = cache.value(0.0);
+    REQUIRE(value.has_value());
+    CHECK(value->position == orbit(0.0)->position);
+    CHECK(value->velocity == orbit(0.0)->velocity);
+}
+
+TEST_CASE("EphemerisCache: Rotation Within Tolerance", "[ephemeriscache]") {
+    using namespace openspace;
+
+    constexpr const double Tolerance = 1e-7;
+    EphemerisCache cache(EphemerisCache::Type::Rotation, spin, Tolerance, 3600.0);
+
+    // A full segment contains exactly two revolutions, so the start and end samples
+    // and the center of the segment have the same orientation
+    for (double t : testTimes(2000, 0.0, 7200.0)) {
+        std::optional<Sample> value = cache.value(t);
+        REQUIRE(value.has_value());
+        REQUIRE(angleBetween(value->rotation, spin(t)->rotation) < 2.0 * Tolerance);
+    }
+}
+
+TEST_CASE("EphemerisCache: Independent Of Request Order", "[ephemeriscache]") {
+    using namespace openspace;
+
+    std::vector<double> times = testTimes(500, 0.0, 5.0 * 86400.0);
+
+    EphemerisCache forward(EphemerisCache::Type::Position, orbit, 1e-3, 86400.0);
+    std::vector<glm::dvec3> forwardResults;
+    for (double t : times) {
+        forwardResults.push_back(forward.value(t)->position);
+    }
+
+    // Evicting segments and using a different order must not change the results
+    EphemerisCache backward(EphemerisCache::Type::Position, orbit, 1e-3, 86400.0, 1.0, 1);
+    for (size_t i = times.size(); i > 0; --i) {
+        REQUIRE(backward.value(times[i - 1])->position == forwardResults[i - 1]);
+    }
+    CHECK(backward.statistics().nSegments == 1);
+}
+
+TEST_CASE("EphemerisCache: Missing Data", "[ephemeriscache]") {
+    using namespace openspace;
+
+    auto function = [](double time) -> std::optional<Sample> {
+        if (time < 0.0) {
+            return std::nullopt;
+        }
+        return orbit(time);
+    };
+    EphemerisCache cache(EphemerisCache::Type::Position, function, 1e-3, 86400.0);
+
+    CHECK_FALSE(cache.value(-100.0).has_value());
+    CHECK_FALSE(cache.value(-200.0).has_value());
+    CHECK(cache.value(100.0).has_value());
+
+    // The second request for the missing segment must not sample again
+    const uint64_t nEvaluations = cache.statistics().nEvaluations;
+    CHECK_FALSE(cache.value(-300.0).has_value());
+    CHECK(cache.statistics().nEvaluations == nEvaluations);
+}
+
+TEST_CASE("EphemerisCache: Prefetch", "[ephemeriscache]") {
+    using namespace openspace;
+
+    EphemerisCache cache(EphemerisCache::Type::Position, orbit, 1e-3, 86400.0);
+
+    // An unused cache is not prefetched
+    cache.prefetch(0.0, 60.0, 4);
+    CHECK(cache.statistics().nEvaluations == 0);
+
+    cache.value(0.0);
+    cache.prefetch(0.0, 60.0, 4);
+    const uint64_t nEvaluations = cache.statistics().nEvaluations;
+    for (int i = 1; i <= 4; ++i) {
+        cache.value(i * 60.0);
+    }
+    CHECK(cache.statistics().nEvaluations == nEvaluations);
+}
+
+TEST_CASE("EphemerisCache: Concurrent Access", "[ephemeriscache]") {
+    using namespace openspace;
+
+    std::vector<double> times = testTimes(4000, 0.0, 10.0 * 86400.0);
+
+    EphemerisCache serial(EphemerisCache::Type::Position, orbit, 1e-3, 86400.0);
+    std::vector<glm::dvec3> expected;
+    for (double t : times) {
+        expected.push_back(serial.value(t)->position);
+    }
+
+    EphemerisCache cache(EphemerisCache::Type::Position, orbit, 1e-3, 86400.0, 1.0, 4);
+    std::vector<glm::dvec3> results(times.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&, i]() {
+            for (size_t j = i; j < times.size(); j += 4) {
+                results[j] = cache.value(times[j])->position;
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    for (size_t i = 0; i < times.size(); ++i) {
+        REQUIRE(results[i] == expected[i]);
+    }
+}
@@ -0,0 +1,154 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/util/framearena.h>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace openspace;
+
+TEST_CASE("FrameArena: Alignment", "[framearena]") {
+    FrameArena arena(4096);
+
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(8, 8);
+    void* c = arena.allocate(1, 64);
+    REQUIRE(reinterpret_cast<uintptr_t>(b) % 8 == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(c) % 64 == 0);
+    REQUIRE(a != b);
+    REQUIRE(b != c);
+    REQUIRE(arena.usage() >= 12);
+}
+
+TEST_CASE("FrameArena: Reset and High-Water Mark", "[framearena]") {
+    FrameArena arena(4096);
+
+    [[maybe_unused]] void* a = arena.allocate(1000, 8);
+    arena.reset();
+    REQUIRE(arena.usage() == 0);
+    REQUIRE(arena.lastFrameUsage() == 1000);
+    REQUIRE(arena.highWaterMark() == 1000);
+
+    void* p = arena.allocate(100, 8);
+    arena.reset();
+    REQUIRE(arena.lastFrameUsage() == 100);
+    REQUIRE(arena.highWaterMark() == 1000);
+
+    // After a reset, the memory is reused from the beginning
+    void* q = arena.allocate(100, 8);
+    REQUIRE(p == q);
+}
+
+TEST_CASE("FrameArena: Overflow", "[framearena]") {
+    FrameArena arena(256);
+
+    void* a = arena.allocate(200, 8);
+    void* b = arena.allocate(200, 8);
+    REQUIRE(a != nullptr);
+    REQUIRE(b != nullptr);
+    std::memset(b, 0, 200);
+    REQUIRE(arena.usage() == 400);
+
+    arena.reset();
+    REQUIRE(arena.lastFrameOverflows() == 1);
+    REQUIRE(arena.totalOverflows() == 1);
+    REQUIRE(arena.highWaterMark() == 400);
+
+    arena.reset();
+    REQUIRE(arena.lastFrameOverflows() == 0);
+    REQUIRE(arena.totalOverflows() == 1);
+}
+
+TEST_CASE("FrameArena: Capacity Change", "[framearena]") {
+    FrameArena arena(256);
+    arena.setCapacity(1024);
+    REQUIRE(arena.capacity() == 256);
+
+    arena.reset();
+    REQUIRE(arena.capacity() == 1024);
+    [[maybe_unused]] void* p = arena.allocate(1000, 1);
+    arena.reset();
+    REQUIRE(arena.lastFrameOverflows() == 0);
+}
+
+TEST_CASE("FrameArena: Containers", "[framearena]") {
+    FrameArena arena(64 * 1024);
+
+    FrameVector<int> v(arena.allocator());
+    for (int i = 0; i < 1000; ++i) {
+        v.push_back(i);
+    }
+    REQUIRE(v.size() == 1000);
+    REQUIRE(v[999] == 999);
+
+    FrameString s(
+        "a string that is too long for the small string buffer",
+        arena.allocator()
+    );
+    s.append(" and some more");
+    REQUIRE(s.size() == 67);
+
+#ifdef __cpp_lib_memory_resource
+    REQUIRE(arena.usage() > 4000);
+#else // ^^^ __cpp_lib_memory_resource / !__cpp_lib_memory_resource vvv
+    // Without memory resources, the containers use the heap
+    REQUIRE(arena.usage() == 0);
+#endif // __cpp_lib_memory_resource
+}
+
+TEST_CASE("FrameArena: Concurrent Allocations", "[framearena]") {
+    constexpr const int NThreads = 4;
+    constexpr const int NAllocations = 1000;
+    FrameArena arena(NThreads * NAllocations * 16);
+
+    std::vector<std::vector<int*>> pointers(NThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NThreads; ++t) {
+        threads.emplace_back([&arena, &pointers, t]() {
+            for (int i = 0; i < NAllocations; ++i) {
+                int* p = reinterpret_cast<int*>(arena.allocate(16, 16));
+                *p = t * NAllocations + i;
+                pointers[t].push_back(p);
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    // Every allocation has to be distinct, so no value may have been overwritten
+    for (int t = 0; t < NThreads; ++t) {
+        for (int i = 0; i < NAllocations; ++i) {
+            REQUIRE(*pointers[t][i] == t * NAllocations + i);
+        }
+    }
+    REQUIRE(arena.usage() == NThreads * NAllocations * 16);
+
+    arena.reset();
+    REQUIRE(arena.lastFrameOverflows() == 0);
+}
@@ -0,0 +1,1064 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,   *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/gaia/rendering/nodeioscheduler.h>
+#include <modules/gaia/rendering/octreeculler.h>
+#include <modules/gaia/rendering/octreemanager.h>
+#include <modules/gaia/rendering/starencoding.h>
+#include <modules/gaia/tasks/octreebuilder.h>
+#include <openspace/util/distanceconstants.h>
+#include <openspace/util/taskscheduler.h>
+#include <ghoul/fmt.h>
+#include <ghoul/glm.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+    constexpr const int MaxDist = 10;
+    constexpr const size_t ValuesPerStar = 8;
+
+    // Stars with clustered positions (to get a deep tree), magnitudes and velocities
+    std::vector<float> createStars(size_t nStars, unsigned int seed = 1337) {
+        std::mt19937 gen(seed);
+        std::normal_distribution<float> pos(0.f, MaxDist / 8.f);
+        std::uniform_real_distribution<float> mag(-5.f, 20.f);
+        std::uniform_real_distribution<float> values(-1.f, 1.f);
+
+        std::vector<float> stars;
+        stars.reserve(nStars * ValuesPerStar);
+        for (size_t i = 0; i < nStars; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                stars.push_back(std::clamp(pos(gen), -0.99f * MaxDist, 0.99f * MaxDist));
+            }
+            stars.push_back(mag(gen));
+            for (int j = 0; j < 4; ++j) {
+                stars.push_back(values(gen));
+            }
+        }
+        return stars;
+    }
+
+    void buildOctree(openspace::OctreeManager& octree, const std::vector<float>& stars,
+                     int maxStarsPerNode)
+    {
+        octree.initOctree(0, MaxDist, maxStarsPerNode);
+        std::vector<float> starValues(ValuesPerStar);
+        for (size_t i = 0; i < stars.size(); i += ValuesPerStar) {
+            std::copy_n(stars.begin() + i, ValuesPerStar, starValues.begin());
+            octree.insert(starValues);
+        }
+        octree.sliceLodData();
+    }
+
+    // Maps the whole octree into the visible part of normalized device coordinates
+    glm::dmat4 fullViewMatrix() {
+        using namespace openspace::distanceconstants;
+        const double scale = 1.0 / (MaxDist * 1000.0 * Parsec);
+        glm::dmat4 mvp = glm::dmat4(scale);
+        mvp[2][2] = 0.5 * scale;
+        mvp[3][2] = 1.0;
+        mvp[3][3] = 1.0;
+        return mvp;
+    }
+
+    // Zooms in on the octree by a factor of zoom and moves it in normalized device
+    // coordinates by offset
+    glm::dmat4 viewMatrix(double zoom, const glm::dvec2& offset) {
+        glm::dmat4 mvp = fullViewMatrix();
+        mvp[0][0] *= zoom;
+        mvp[1][1] *= zoom;
+        mvp[3][0] = offset.x;
+        mvp[3][1] = offset.y;
+        return mvp;
+    }
+
+    // Sorted by the values of each star to compare sets of stars
+    std::vector<std::vector<float>> sortedStars(const std::vector<float>& positions) {
+        std::vector<std::vector<float>> stars;
+        for (size_t i = 0; i < positions.size(); i += 3) {
+            stars.emplace_back(positions.begin() + i, positions.begin() + i + 3);
+        }
+        std::sort(stars.begin(), stars.end());
+        return stars;
+    }
+
+    // Reads one node of a file written by OctreeManager::writeToFile with data and checks
+    // that the LOD cache of inner nodes holds the brightest stars of the subtree. Returns
+    // the magnitudes of all stars in the leaves of the subtree
+    std::vector<float> checkLodNode(std::ifstream& file, size_t maxStarsPerNode) {
+        bool isLeaf = false;
+        int32_t numStars = 0;
+        int32_t nDataSize = 0;
+        file.read(reinterpret_cast<char*>(&isLeaf), sizeof(bool));
+        file.read(reinterpret_cast<char*>(&numStars), sizeof(int32_t));
+        file.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
+        std::vector<float> data(nDataSize);
+        file.read(reinterpret_cast<char*>(data.data()), nDataSize * sizeof(float));
+
+        const size_t nStars = nDataSize / ValuesPerStar;
+        REQUIRE(nStars == static_cast<size_t>(numStars));
+        std::vector<float> mags(nStars);
+        for (size_t i = 0; i < nStars; ++i) {
+            mags[i] = data[nStars * 3 + i * 2];
+        }
+        if (isLeaf) {
+            return mags;
+        }
+
+        std::vector<float> subtreeMags;
+        for (int i = 0; i < 8; ++i) {
+            std::vector<float> childMags = checkLodNode(file, maxStarsPerNode);
+            subtreeMags.insert(subtreeMags.end(), childMags.begin(), childMags.end());
+        }
+        std::sort(subtreeMags.begin(), subtreeMags.end());
+        subtreeMags.resize(maxStarsPerNode);
+
+        // The LOD cache is sorted by magnitude
+        CHECK(mags == subtreeMags);
+        return subtreeMags;
+    }
+
+    // Writes the stars into files with the format of ReadFitsTask, which are the input
+    // of the OctreeBuilder. Returns the paths of the files
+    std::vector<std::filesystem::path> writeInputFiles(const std::vector<float>& stars,
+                                                   const std::filesystem::path& folder,
+                                                                      size_t nFiles)
+    {
+        std::filesystem::remove_all(folder);
+        std::filesystem::create_directories(folder);
+
+        const size_t nStars = stars.size() / ValuesPerStar;
+        std::vector<std::filesystem::path> paths;
+        for (size_t i = 0; i < nFiles; ++i) {
+            const size_t first = nStars * i / nFiles;
+            const size_t last = nStars * (i + 1) / nFiles;
+
+            paths.push_back(folder / fmt::format("stars{}.bin", i));
+            std::ofstream file(paths.back(), std::ios::binary);
+            const int32_t nValuesPerStar = static_cast<int32_t>(ValuesPerStar);
+            file.write(reinterpret_cast<const char*>(&nValuesPerStar), sizeof(int32_t));
+            file.write(
+                reinterpret_cast<const char*>(&stars[first * ValuesPerStar]),
+                (last - first) * ValuesPerStar * sizeof(float)
+            );
+        }
+        return paths;
+    }
+
+    // Returns the names and contents of all files in the folder
+    std::map<std::string, std::vector<char>> readFolder(
+                                                      const std::filesystem::path& folder)
+    {
+        std::map<std::string, std::vector<char>> files;
+        for (const std::filesystem::directory_entry& e :
+             std::filesystem::directory_iterator(folder))
+        {
+            std::ifstream file(e.path(), std::ios::binary);
+            files[e.path().filename().string()] = std::vector<char>(
+                std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>()
+            );
+        }
+        return files;
+    }
+} // namespace
+
+TEST_CASE("GaiaOctree: Construction", "[gaiaoctree]") {
+    constexpr const size_t NStars = 20000;
+    constexpr const int MaxStarsPerNode = 64;
+    const std::vector<float> stars = createStars(NStars);
+
+    openspace::OctreeManager octree;
+    buildOctree(octree, stars, MaxStarsPerNode);
+
+    CHECK(octree.totalNodes() == octree.numLeafNodes() + octree.numInnerNodes());
+    CHECK((octree.numLeafNodes() - 8) == 7 * octree.numInnerNodes());
+    CHECK(octree.totalDepth() > 2);
+
+    // Leaves hold every star exactly once
+    const std::vector<float> all =
+        octree.getAllData(openspace::gaia::RenderOption::Static);
+    REQUIRE(all.size() == NStars * 3);
+    std::vector<float> inserted;
+    for (size_t i = 0; i < stars.size(); i += ValuesPerStar) {
+        inserted.insert(inserted.end(), stars.begin() + i, stars.begin() + i + 3);
+    }
+    CHECK(sortedStars(all) == sortedStars(inserted));
+
+    const std::vector<float> motion = octree.getAllData(
+        openspace::gaia::RenderOption::Motion
+    );
+    CHECK(motion.size() == NStars * ValuesPerStar);
+}
+
+TEST_CASE("GaiaOctree: LOD Cache", "[gaiaoctree]") {
+    constexpr const int MaxStarsPerNode = 32;
+    const std::vector<float> stars = createStars(10000, 42);
+
+    openspace::OctreeManager octree;
+    buildOctree(octree, stars, MaxStarsPerNode);
+
+    const std::filesystem::path path = absPath("${TESTDIR}/gaiaoctree_lod.bin");
+    {
+        std::ofstream file(path, std::ios::binary);
+        octree.writeToFile(file, true);
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    int32_t header[3];
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    CHECK(header[0] == static_cast<int32_t>(ValuesPerStar));
+    CHECK(header[1] == MaxStarsPerNode);
+    CHECK(header[2] == MaxDist);
+    for (int i = 0; i < 8; ++i) {
+        checkLodNode(file, MaxStarsPerNode);
+    }
+    CHECK(file.peek() == std::ifstream::traits_type::eof());
+}
+
+TEST_CASE("GaiaOctree: Write And Read", "[gaiaoctree]") {
+    constexpr const int MaxStarsPerNode = 50;
+    const std::vector<float> stars = createStars(15000, 7);
+
+    openspace::OctreeManager octree;
+    buildOctree(octree, stars, MaxStarsPerNode);
+
+    SECTION("With data") {
+        const std::filesystem::path path = absPath("${TESTDIR}/gaiaoctree_data.bin");
+        {
+            std::ofstream file(path, std::ios::binary);
+            octree.writeToFile(file, true);
+        }
+
+        openspace::OctreeManager read;
+        read.initOctree();
+        std::ifstream file(path, std::ios::binary);
+        const int nStars = read.readFromFile(file, true);
+        CHECK(nStars == static_cast<int>(stars.size() / ValuesPerStar));
+        CHECK(read.maxStarsPerNode() == MaxStarsPerNode);
+        CHECK(read.maxDist() == MaxDist);
+        CHECK(read.numLeafNodes() == octree.numLeafNodes());
+        CHECK(read.numInnerNodes() == octree.numInnerNodes());
+
+        using openspace::gaia::RenderOption;
+        CHECK(read.getAllData(RenderOption::Motion) ==
+              octree.getAllData(RenderOption::Motion));
+    }
+
+    SECTION("Structure only") {
+        const std::filesystem::path path = absPath("${TESTDIR}/gaiaoctree_index.bin");
+        {
+            std::ofstream file(path, std::ios::binary);
+            octree.writeToFile(file, false);
+        }
+
+        openspace::OctreeManager read;
+        read.initOctree();
+        std::ifstream file(path, std::ios::binary);
+        const int nStars = read.readFromFile(file, false);
+        CHECK(nStars == static_cast<int>(stars.size() / ValuesPerStar));
+        CHECK(read.totalNodes() == octree.totalNodes());
+    }
+}
+
+TEST_CASE("GaiaOctree: Stream From Files", "[gaiaoctree]") {
+    using openspace::gaia::RenderOption;
+
+    constexpr const int MaxStarsPerNode = 50;
+    const std::vector<float> stars = createStars(15000, 11);
+
+    openspace::OctreeManager octree;
+    buildOctree(octree, stars, MaxStarsPerNode);
+    const std::vector<float> allStars = octree.getAllData(RenderOption::Static);
+
+    // Write the structure to one file and the data of every node to its own file
+    const std::filesystem::path folder = absPath("${TESTDIR}/gaiaoctree_stream");
+    std::filesystem::create_directories(folder);
+    const std::string prefix = folder.string() + "/";
+    const std::filesystem::path indexPath = folder / "index.bin";
+    {
+        std::ofstream file(indexPath, std::ios::binary);
+        octree.writeToFile(file, false);
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        octree.writeToMultipleFiles(prefix, i);
+    }
+
+    openspace::OctreeManager streamed;
+    streamed.initOctree(std::numeric_limits<long long>::max() / 2);
+    std::ifstream file(indexPath, std::ios::binary);
+    streamed.readFromFile(file, false, prefix);
+    streamed.initBufferIndexStack(streamed.totalNodes(), false, true);
+    CHECK(streamed.getAllData(RenderOption::Static).empty());
+
+    // The whole dataset fits in memory, so all nodes are requested at once
+    streamed.fetchSurroundingNodes(glm::dvec3(0.0), MaxStarsPerNode * 8, glm::ivec2(1));
+    openspace::NodeIoScheduler::Stats stats = streamed.ioStats();
+    while (stats.nQueued > 0 || stats.nInFlight > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        stats = streamed.ioStats();
+    }
+
+    CHECK(stats.nCompleted > 0);
+    CHECK(stats.bytesRead > allStars.size() * sizeof(float));
+    CHECK(sortedStars(streamed.getAllData(RenderOption::Static)) ==
+          sortedStars(allStars));
+}
+
+TEST_CASE("GaiaOctree: Out-Of-Core Construction", "[gaiaoctree]") {
+    constexpr const int MaxStarsPerNode = 40;
+    constexpr const float MaxMagnitude = 15.f;
+    const std::vector<float> stars = createStars(30000, 23);
+    const std::filesystem::path folder = absPath("${TESTDIR}/gaiaoctree_outofcore");
+    const std::vector<std::filesystem::path> inputFiles =
+        writeInputFiles(stars, folder / "input", 3);
+
+    // The octree constructed in memory from the stars that pass the filter
+    std::vector<float> filteredStars;
+    for (size_t i = 0; i < stars.size(); i += ValuesPerStar) {
+        if (stars[i + 3] <= MaxMagnitude) {
+            filteredStars.insert(
+                filteredStars.end(),
+                stars.begin() + i,
+                stars.begin() + i + ValuesPerStar
+            );
+        }
+    }
+    openspace::OctreeManager octree;
+    buildOctree(octree, filteredStars, MaxStarsPerNode);
+    const std::filesystem::path expectedFolder = folder / "expected";
+    std::filesystem::create_directories(expectedFolder);
+    {
+        std::ofstream index(expectedFolder / "index.bin", std::ios::binary);
+        octree.writeToFile(index, false);
+    }
+    const size_t nNodes = octree.totalNodes();
+    for (size_t i = 0; i < 8; ++i) {
+        octree.writeToMultipleFiles(expectedFolder.string() + "/", i);
+    }
+    const std::map<std::string, std::vector<char>> expected = readFolder(expectedFolder);
+
+    // A budget of 0 keeps the fewest stars in memory, so most nodes are spilled to disk
+    const size_t memoryBudget = GENERATE(size_t(0), size_t(1) << 30);
+    INFO(fmt::format("Memory budget: {}", memoryBudget));
+
+    const std::filesystem::path outFolder = folder / "octree";
+    std::filesystem::remove_all(outFolder);
+    std::filesystem::create_directories(outFolder);
+    openspace::TaskScheduler scheduler(4);
+    openspace::OctreeBuilder builder(
+        scheduler,
+        MaxDist,
+        MaxStarsPerNode,
+        memoryBudget,
+        folder / "spill"
+    );
+    float lastProgress = 0.f;
+    const openspace::OctreeBuilder::Result res = builder.build(
+        inputFiles,
+        outFolder.string() + "/",
+        [](const std::vector<float>& values) { return values[3] > MaxMagnitude; },
+        [&lastProgress](float progress) {
+            CHECK(progress >= lastProgress);
+            lastProgress = progress;
+        }
+    );
+
+    CHECK(res.nStars == filteredStars.size() / ValuesPerStar);
+    CHECK(res.nFilteredStars == (stars.size() - filteredStars.size()) / ValuesPerStar);
+    CHECK(res.nDroppedStars == 0);
+    CHECK(res.nInnerNodes + res.nLeafNodes == nNodes);
+    CHECK(res.nSpilledBytes > 0);
+    CHECK(lastProgress == 1.f);
+    CHECK(std::filesystem::is_empty(folder / "spill"));
+
+    // Same index and node files, byte by byte
+    const std::map<std::string, std::vector<char>> files = readFolder(outFolder);
+    REQUIRE(files.size() == expected.size());
+    for (const auto& [name, contents] : expected) {
+        INFO(name);
+        REQUIRE(files.count(name) == 1);
+        CHECK(files.at(name) == contents);
+    }
+
+    openspace::OctreeManager streamed;
+    streamed.initOctree();
+    std::ifstream index(outFolder / "index.bin", std::ios::binary);
+    const int nStars = streamed.readFromFile(index, false, outFolder.string() + "/");
+    CHECK(nStars == static_cast<int>(res.nStars));
+    CHECK(streamed.totalNodes() == nNodes);
+}
+
+TEST_CASE("GaiaOctree: Half Floats", "[gaiaoctree]") {
+    using namespace openspace::gaia;
+
+    // Every finite 16-bit float survives the conversion in both directions
+    std::vector<uint16_t> halfs;
+    for (uint32_t h = 0; h <= 0xffff; ++h) {
+        if ((h & 0x7c00) != 0x7c00) {
+            halfs.push_back(static_cast<uint16_t>(h));
+        }
+    }
+    std::vector<float> floats(halfs.size());
+    halfToFloat(halfs.data(), halfs.size(), floats.data());
+    for (size_t i = 0; i < halfs.size(); ++i) {
+        INFO(halfs[i]);
+        CHECK(floatToHalf(floats[i]) == halfs[i]);
+    }
+
+    float value = 0.f;
+    uint16_t h = floatToHalf(1.f);
+    halfToFloat(&h, 1, &value);
+    CHECK(value == 1.f);
+    h = floatToHalf(-0.5f);
+    halfToFloat(&h, 1, &value);
+    CHECK(value == -0.5f);
+    h = floatToHalf(6e-8f);
+    halfToFloat(&h, 1, &value);
+    CHECK(value == std::ldexp(1.f, -24));
+
+    // Ties are rounded to the even mantissa
+    h = floatToHalf(1.f + std::ldexp(1.f, -11));
+    halfToFloat(&h, 1, &value);
+    CHECK(value == 1.f);
+    h = floatToHalf(1.f + 3.f * std::ldexp(1.f, -11));
+    halfToFloat(&h, 1, &value);
+    CHECK(value == 1.f + std::ldexp(1.f, -9));
+
+    // Values that don't fit are clamped
+    h = floatToHalf(1e6f);
+    halfToFloat(&h, 1, &value);
+    CHECK(value == 65504.f);
+    h = floatToHalf(-std::numeric_limits<float>::infinity());
+    halfToFloat(&h, 1, &value);
+    CHECK(value == -65504.f);
+    CHECK(floatToHalf(std::numeric_limits<float>::quiet_NaN()) == 0);
+}
+
+TEST_CASE("GaiaOctree: Quantized Encoding", "[gaiaoctree]") {
+    using namespace openspace::gaia;
+
+    constexpr const int MaxStarsPerNode = 50;
+    const std::vector<float> stars = createStars(15000, 29);
+
+    SECTION("Node") {
+        constexpr const size_t NStars = 1000;
+        std::vector<float> positions;
+        std::vector<float> colors;
+        std::vector<float> velocities;
+        for (size_t i = 0; i < NStars; ++i) {
+            const float* star = &stars[i * ValuesPerStar];
+            positions.insert(positions.end(), star, star + 3);
+            colors.insert(colors.end(), star + 3, star + 5);
+            velocities.insert(velocities.end(), star + 5, star + 8);
+        }
+
+        std::vector<std::byte> encoded(encodedNodeSize(StarEncoding::Quantized, NStars));
+        CHECK(encoded.size() < encodedNodeSize(StarEncoding::Float32, NStars) / 2 + 64);
+        EncodingReport report;
+        encodeQuantizedNode(
+            positions.data(),
+            colors.data(),
+            velocities.data(),
+            NStars,
+            encoded.data(),
+            &report
+        );
+
+        std::vector<float> decoded(NStars * ValuesPerStar);
+        float* dPositions = decoded.data();
+        float* dColors = dPositions + 3 * NStars;
+        float* dVelocities = dColors + 2 * NStars;
+        REQUIRE_FALSE(decodeQuantizedNode(
+            encoded.data(),
+            encoded.size() - 1,
+            NStars,
+            dPositions,
+            dColors,
+            dVelocities
+        ));
+        REQUIRE(decodeQuantizedNode(
+            encoded.data(),
+            encoded.size(),
+            NStars,
+            dPositions,
+            dColors,
+            dVelocities
+        ));
+
+        // The report holds the largest of the actual errors, which are at most half a
+        // quantization step of the range of the values
+        float maxPositionError = 0.f;
+        float maxMagnitudeError = 0.f;
+        float maxVelocityError = 0.f;
+        for (size_t i = 0; i < 3 * NStars; ++i) {
+            maxPositionError = std::max(
+                maxPositionError,
+                std::abs(dPositions[i] - positions[i])
+            );
+            maxVelocityError = std::max(
+                maxVelocityError,
+                std::abs(dVelocities[i] - velocities[i])
+            );
+        }
+        for (size_t i = 0; i < NStars; ++i) {
+            maxMagnitudeError = std::max(
+                maxMagnitudeError,
+                std::abs(dColors[2 * i] - colors[2 * i])
+            );
+        }
+        CHECK(report.nStars == NStars);
+        CHECK(report.nEncodedBytes == encoded.size());
+        CHECK(report.maxPositionError == maxPositionError);
+        CHECK(report.maxMagnitudeError == maxMagnitudeError);
+        CHECK(report.maxVelocityError == maxVelocityError);
+        CHECK(report.maxPositionError <= 2.f * MaxDist / 65535.f);
+        CHECK(report.maxMagnitudeError <= 25.f / 65535.f);
+        CHECK(report.maxColorError <= 2.f / 65535.f);
+        CHECK(report.maxRelativeVelocityError <= std::ldexp(1.f, -11));
+    }
+
+    SECTION("File") {
+        openspace::OctreeManager octree;
+        buildOctree(octree, stars, MaxStarsPerNode);
+        const std::filesystem::path floatPath =
+            absPath("${TESTDIR}/gaiaoctree_float.bin");
+        const std::filesystem::path quantizedPath =
+            absPath("${TESTDIR}/gaiaoctree_quantized.bin");
+        {
+            std::ofstream file(floatPath, std::ios::binary);
+            octree.writeToFile(file, true);
+        }
+        octree.setStarEncoding(StarEncoding::Quantized);
+        {
+            std::ofstream file(quantizedPath, std::ios::binary);
+            octree.writeToFile(file, true);
+        }
+        CHECK(octree.encodingReport().nStars > 0);
+
+        // Files with 32-bit floats keep the header without a version
+        std::ifstream floatFile(floatPath, std::ios::binary);
+        int32_t valuesPerStar = 0;
+        floatFile.read(reinterpret_cast<char*>(&valuesPerStar), sizeof(int32_t));
+        CHECK(valuesPerStar == ValuesPerStar);
+        floatFile.seekg(0);
+
+        const uintmax_t floatSize = std::filesystem::file_size(floatPath);
+        const uintmax_t quantizedSize = std::filesystem::file_size(quantizedPath);
+        CHECK(quantizedSize < floatSize * 6 / 10);
+
+        using openspace::gaia::RenderOption;
+        const std::vector<float> allStars = octree.getAllData(RenderOption::Motion);
+        openspace::OctreeManager floatRead;
+        floatRead.initOctree();
+        floatRead.readFromFile(floatFile, true);
+        CHECK(floatRead.starEncoding() == StarEncoding::Float32);
+        CHECK(floatRead.getAllData(RenderOption::Motion) == allStars);
+
+        openspace::OctreeManager quantizedRead;
+        quantizedRead.initOctree();
+        std::ifstream quantizedFile(quantizedPath, std::ios::binary);
+        const int nStars = quantizedRead.readFromFile(quantizedFile, true);
+        CHECK(nStars == static_cast<int>(stars.size() / ValuesPerStar));
+        CHECK(quantizedRead.starEncoding() == StarEncoding::Quantized);
+        CHECK(quantizedRead.totalNodes() == octree.totalNodes());
+        const std::vector<float> quantizedStars =
+            quantizedRead.getAllData(RenderOption::Motion);
+        REQUIRE(quantizedStars.size() == allStars.size());
+        for (size_t i = 0; i < allStars.size(); ++i) {
+            CHECK(std::abs(quantizedStars[i] - allStars[i]) < 1e-3f);
+        }
+    }
+
+    SECTION("Streamed") {
+        const std::filesystem::path folder = absPath("${TESTDIR}/gaiaoctree_quantized");
+        const std::vector<std::filesystem::path> inputFiles =
+            writeInputFiles(stars, folder / "input", 2);
+
+        openspace::OctreeManager octree;
+        buildOctree(octree, stars, MaxStarsPerNode);
+        octree.setStarEncoding(StarEncoding::Quantized);
+        const std::filesystem::path path = folder / "octree.bin";
+        {
+            std::ofstream out(path, std::ios::binary);
+            octree.writeToFile(out, true);
+        }
+        const EncodingReport report = octree.encodingReport();
+        const std::filesystem::path expectedFolder = folder / "expected";
+        std::filesystem::create_directories(expectedFolder);
+        {
+            std::ofstream index(expectedFolder / "index.bin", std::ios::binary);
+            octree.writeToFile(index, false);
+        }
+        for (size_t i = 0; i < 8; ++i) {
+            octree.writeToMultipleFiles(expectedFolder.string() + "/", i);
+        }
+
+        // The builder encodes the same nodes into the same files
+        const std::filesystem::path outFolder = folder / "octree";
+        std::filesystem::remove_all(outFolder);
+        std::filesystem::create_directories(outFolder);
+        openspace::TaskScheduler scheduler(2);
+        openspace::OctreeBuilder builder(
+            scheduler,
+            MaxDist,
+            MaxStarsPerNode,
+            size_t(1) << 30,
+            folder / "spill",
+            StarEncoding::Quantized
+        );
+        const openspace::OctreeBuilder::Result res = builder.build(
+            inputFiles,
+            outFolder.string() + "/",
+            [](const std::vector<float>&) { return false; },
+            nullptr
+        );
+        CHECK(res.encodingReport.nStars == report.nStars);
+        CHECK(res.encodingReport.maxPositionError == report.maxPositionError);
+        CHECK(readFolder(outFolder) == readFolder(expectedFolder));
+
+        openspace::OctreeManager streamed;
+        streamed.initOctree(std::numeric_limits<long long>::max() / 2);
+        std::ifstream file(outFolder / "index.bin", std::ios::binary);
+        streamed.readFromFile(file, false, outFolder.string() + "/");
+        CHECK(streamed.starEncoding() == StarEncoding::Quantized);
+        using openspace::gaia::RenderOption;
+        streamed.initBufferIndexStack(streamed.totalNodes(), false, true);
+        streamed.fetchSurroundingNodes(
+            glm::dvec3(0.0),
+            MaxStarsPerNode * 8,
+            glm::ivec2(1)
+        );
+        openspace::NodeIoScheduler::Stats stats = streamed.ioStats();
+        while (stats.nQueued > 0 || stats.nInFlight > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            stats = streamed.ioStats();
+        }
+
+        // Every node file is read once and decoded to the same values as a single file
+        size_t nodeBytes = 0;
+        for (const auto& [name, contents] : readFolder(outFolder)) {
+            if (name != "index.bin") {
+                nodeBytes += contents.size();
+            }
+        }
+        CHECK(stats.bytesRead == nodeBytes);
+
+        openspace::OctreeManager read;
+        read.initOctree();
+        std::ifstream in(path, std::ios::binary);
+        read.readFromFile(in, true);
+        CHECK(sortedStars(streamed.getAllData(RenderOption::Static)) ==
+              sortedStars(read.getAllData(RenderOption::Static)));
+    }
+}
+
+TEST_CASE("GaiaOctree: IO Scheduler", "[gaiaoctree]") {
+    openspace::NodeIoScheduler scheduler(1);
+
+    // Keep the only concurrent request busy so that the following requests have to wait
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    scheduler.enqueue(0, 0.0, [&started, released]() -> size_t {
+        started.set_value();
+        released.wait();
+        return 1;
+    });
+    started.get_future().wait();
+
+    std::mutex mutex;
+    std::vector<unsigned long long> order;
+    auto request = [&mutex, &order](unsigned long long key) {
+        return [&mutex, &order, key]() -> size_t {
+            std::lock_guard lock(mutex);
+            order.push_back(key);
+            return 10;
+        };
+    };
+
+    SECTION("Priority") {
+        scheduler.enqueue(1, 3.0, request(1));
+        scheduler.enqueue(2, 1.0, request(2));
+        scheduler.enqueue(3, 2.0, request(3));
+        // Requesting a waiting node again only changes its priority
+        scheduler.enqueue(1, 0.5, request(1));
+        scheduler.enqueue(3, 5.0, request(3));
+
+        openspace::NodeIoScheduler::Stats stats = scheduler.stats();
+        CHECK(stats.nQueued == 3);
+        CHECK(stats.nInFlight == 1);
+        CHECK(stats.nCoalesced == 2);
+
+        release.set_value();
+        scheduler.waitUntilIdle();
+        CHECK(order == std::vector<unsigned long long>{ 1, 2, 3 });
+
+        stats = scheduler.stats();
+        CHECK(stats.nQueued == 0);
+        CHECK(stats.nInFlight == 0);
+        CHECK(stats.nCompleted == 4);
+        CHECK(stats.bytesRead == 31);
+    }
+
+    SECTION("Cancel stale requests") {
+        scheduler.enqueue(1, 1.0, request(1));
+        scheduler.enqueue(2, 2.0, request(2));
+        scheduler.beginPass();
+        scheduler.enqueue(2, 2.0, request(2));
+        scheduler.enqueue(3, 3.0, request(3));
+        CHECK(scheduler.cancelStaleRequests() == 1);
+
+        release.set_value();
+        scheduler.waitUntilIdle();
+        CHECK(order == std::vector<unsigned long long>{ 2, 3 });
+        CHECK(scheduler.stats().nCancelled == 1);
+    }
+
+    SECTION("Cancel all") {
+        scheduler.enqueue(1, 1.0, request(1));
+        scheduler.enqueue(2, 2.0, request(2));
+        scheduler.cancelAll();
+
+        // A request that was cancelled can be made again
+        scheduler.enqueue(2, 2.0, request(2));
+
+        release.set_value();
+        scheduler.waitUntilIdle();
+        CHECK(order == std::vector<unsigned long long>{ 2 });
+        CHECK(scheduler.stats().nCancelled == 2);
+    }
+}
+
+TEST_CASE("GaiaOctree: Traverse Data", "[gaiaoctree]") {
+    using openspace::gaia::RenderOption;
+    using Updates = openspace::OctreeManager::BufferUpdates;
+
+    constexpr const size_t NStars = 8000;
+    constexpr const int MaxStarsPerNode = 40;
+    const std::vector<float> stars = createStars(NStars, 3);
+
+    openspace::OctreeManager octree;
+    buildOctree(octree, stars, MaxStarsPerNode);
+    octree.initBufferIndexStack(octree.totalNodes(), false, true);
+
+    const glm::dmat4 mvp = fullViewMatrix();
+    const glm::vec2 screenSize = glm::vec2(1000.f, 1000.f);
+
+    SECTION("All leaves") {
+        int deltaStars = 0;
+        const Updates& updates = octree.traverseData(
+            mvp,
+            screenSize,
+            deltaStars,
+            RenderOption::Color,
+            0.f
+        );
+        CHECK(deltaStars == static_cast<int>(NStars));
+
+        std::vector<float> positions;
+        size_t nValues = 0;
+        for (const openspace::OctreeManager::ChunkUpdate& chunk : updates.chunks) {
+            // Chunks contain all positions followed by all colors
+            CHECK(chunk.nValues == chunk.nStars * 5);
+            const float* values = updates.stagingData.data() + chunk.offset;
+            positions.insert(positions.end(), values, values + chunk.nStars * 3);
+            nValues += chunk.nValues;
+        }
+        CHECK(nValues == NStars * 5);
+        CHECK(sortedStars(positions) ==
+              sortedStars(octree.getAllData(RenderOption::Static)));
+
+        // Nothing has changed so nothing should be uploaded again
+        int secondDelta = 0;
+        const Updates& second = octree.traverseData(
+            mvp,
+            screenSize,
+            secondDelta,
+            RenderOption::Color,
+            0.f
+        );
+        CHECK(second.chunks.empty());
+        CHECK(second.stagingData.empty());
+        CHECK(secondDelta == 0);
+    }
+
+    SECTION("Level of detail") {
+        int deltaStars = 0;
+        const Updates& updates = octree.traverseData(
+            mvp,
+            screenSize,
+            deltaStars,
+            RenderOption::Static,
+            5000.f
+        );
+        CHECK(!updates.chunks.empty());
+        CHECK(deltaStars > 0);
+        CHECK(deltaStars < static_cast<int>(NStars));
+
+        // Switching to full detail removes the inner nodes and adds their children
+        int fullDelta = 0;
+        octree.traverseData(mvp, screenSize, fullDelta, RenderOption::Static, 0.f);
+        CHECK(deltaStars + fullDelta == static_cast<int>(NStars));
+    }
+
+    SECTION("Too small to see") {
+        int deltaStars = 0;
+        const Updates& updates = octree.traverseData(
+            mvp,
+            screenSize,
+            deltaStars,
+            RenderOption::Static,
+            1e12f
+        );
+        CHECK(updates.chunks.empty());
+        CHECK(deltaStars == 0);
+    }
+}
+
+TEST_CASE("GaiaOctree: Moving Camera", "[gaiaoctree]") {
+    using openspace::gaia::RenderOption;
+    using Updates = openspace::OctreeManager::BufferUpdates;
+
+    constexpr const int MaxStarsPerNode = 40;
+    const std::vector<float> stars = createStars(20000, 5);
+    const glm::vec2 screenSize = glm::vec2(1000.f, 1000.f);
+
+    openspace::OctreeManager octree;
+    buildOctree(octree, stars, MaxStarsPerNode);
+    octree.initBufferIndexStack(octree.totalNodes(), false, true);
+
+    // Stand-in for the streaming buffer, every chunk holds the positions of one node
+    std::vector<std::vector<float>> buffer(octree.totalNodes());
+    int nStars = 0;
+
+    for (int frame = 0; frame < 40; ++frame) {
+        // Fly towards one side of the octree and move across it
+        const double zoom = 1.0 + frame * 0.25;
+        const glm::dvec2 offset = glm::dvec2(0.02 * frame, -0.01 * frame);
+        const glm::dmat4 mvp = viewMatrix(zoom, offset);
+
+        int deltaStars = 0;
+        const Updates& updates = octree.traverseData(
+            mvp,
+            screenSize,
+            deltaStars,
+            RenderOption::Static,
+            2000.f
+        );
+        nStars += deltaStars;
+
+        // Every chunk is changed at most once per frame
+        std::vector<int> changedChunks;
+        for (const openspace::OctreeManager::ChunkUpdate& chunk : updates.chunks) {
+            changedChunks.push_back(chunk.bufferIndex);
+            const float* values = updates.stagingData.data() + chunk.offset;
+            buffer[chunk.bufferIndex].assign(values, values + chunk.nValues);
+        }
+        std::sort(changedChunks.begin(), changedChunks.end());
+        CHECK(
+            std::adjacent_find(changedChunks.begin(), changedChunks.end()) ==
+            changedChunks.end()
+        );
+
+        // Applying the changes gives the same stars as traversing a new octree
+        std::vector<float> incremental;
+        for (const std::vector<float>& chunk : buffer) {
+            incremental.insert(incremental.end(), chunk.begin(), chunk.end());
+        }
+        CHECK(incremental.size() == static_cast<size_t>(nStars) * 3);
+
+        openspace::OctreeManager reference;
+        buildOctree(reference, stars, MaxStarsPerNode);
+        reference.initBufferIndexStack(reference.totalNodes(), false, true);
+        int referenceStars = 0;
+        const Updates& full = reference.traverseData(
+            mvp,
+            screenSize,
+            referenceStars,
+            RenderOption::Static,
+            2000.f
+        );
+        CHECK(referenceStars == nStars);
+        CHECK(sortedStars(incremental) == sortedStars(full.stagingData));
+    }
+}
+
+TEST_CASE("GaiaOctree: Benchmark", "[.benchmark][gaiaoctree]") {
+    using openspace::gaia::RenderOption;
+
+    const std::vector<float> stars = createStars(1000000);
+    const glm::dmat4 mvp = fullViewMatrix();
+    const glm::vec2 screenSize = glm::vec2(1920.f, 1080.f);
+
+    // Fewer stars per node results in more nodes
+    for (int maxStarsPerNode : { 20000, 2000, 200 }) {
+        openspace::OctreeManager octree;
+        BENCHMARK(fmt::format("Construct 1M stars, {} stars per node", maxStarsPerNode)) {
+            buildOctree(octree, stars, maxStarsPerNode);
+            return octree.totalNodes();
+        };
+
+        INFO(fmt::format("Number of nodes: {}", octree.totalNodes()));
+        BENCHMARK(fmt::format("Traverse {} nodes", octree.totalNodes())) {
+            octree.initBufferIndexStack(octree.totalNodes(), false, true);
+            int deltaStars = 0;
+            return octree.traverseData(
+                mvp,
+                screenSize,
+                deltaStars,
+                RenderOption::Motion,
+                0.f
+            ).chunks.size();
+        };
+
+        // Only the chunks that changed since the previous frame are updated
+        octree.initBufferIndexStack(octree.totalNodes(), false, true);
+        size_t nFrames = 0;
+        size_t nBytes = 0;
+        BENCHMARK(fmt::format("Moving camera, {} nodes", octree.totalNodes())) {
+            const double t = static_cast<double>(nFrames % 100) / 100.0;
+            nFrames++;
+            int deltaStars = 0;
+            const openspace::OctreeManager::BufferUpdates& updates = octree.traverseData(
+                viewMatrix(1.0 + 4.0 * t, glm::dvec2(t, -0.5 * t)),
+                screenSize,
+                deltaStars,
+                RenderOption::Motion,
+                250.f
+            );
+            nBytes += updates.stagingData.size() * sizeof(float);
+            return updates.chunks.size();
+        };
+        WARN(fmt::format(
+            "Moving camera, {} nodes: {} bytes per frame",
+            octree.totalNodes(), nBytes / std::max<size_t>(nFrames, 1)
+        ));
+    }
+}
+
+TEST_CASE("GaiaOctree: Out-Of-Core Benchmark", "[.benchmark][gaiaoctree]") {
+    constexpr const int MaxStarsPerNode = 2000;
+    const std::vector<float> stars = createStars(4000000);
+    const std::filesystem::path folder =
+        absPath("${TESTDIR}/gaiaoctree_outofcore_benchmark");
+    const std::vector<std::filesystem::path> inputFiles =
+        writeInputFiles(stars, folder / "input", 8);
+    const std::filesystem::path outFolder = folder / "octree";
+    std::filesystem::create_directories(outFolder);
+    const std::string prefix = outFolder.string() + "/";
+
+    BENCHMARK("Insert 4M stars and write octree") {
+        openspace::OctreeManager octree;
+        buildOctree(octree, stars, MaxStarsPerNode);
+        std::ofstream index(outFolder / "index.bin", std::ios::binary);
+        octree.writeToFile(index, false);
+        for (size_t i = 0; i < 8; ++i) {
+            octree.writeToMultipleFiles(prefix, i);
+        }
+        return octree.totalNodes();
+    };
+
+    for (unsigned int nThreads : { 1u, 2u, 4u, 8u }) {
+        openspace::TaskScheduler scheduler(nThreads);
+        // The smaller budget spills most nodes to disk before they are constructed
+        for (size_t budget : { size_t(64) << 20, size_t(1) << 30 }) {
+            openspace::OctreeBuilder builder(
+                scheduler,
+                MaxDist,
+                MaxStarsPerNode,
+                budget,
+                folder / "spill"
+            );
+            BENCHMARK(fmt::format(
+                "Out-of-core 4M stars, {} threads, {} MB", nThreads, budget >> 20
+            )) {
+                return builder.build(inputFiles, prefix, nullptr, nullptr).nStars;
+            };
+        }
+    }
+}
+
+TEST_CASE("GaiaOctree: Quantized Encoding Benchmark", "[.benchmark][gaiaoctree]") {
+    using namespace openspace::gaia;
+
+    // One full node of the largest datasets
+    constexpr const size_t NStars = 150000;
+    const std::vector<float> stars = createStars(NStars);
+    std::vector<float> values(NStars * ValuesPerStar);
+    for (size_t i = 0; i < NStars; ++i) {
+        std::copy_n(&stars[i * ValuesPerStar], 3, &values[i * 3]);
+        std::copy_n(&stars[i * ValuesPerStar + 3], 2, &values[NStars * 3 + i * 2]);
+        std::copy_n(&stars[i * ValuesPerStar + 5], 3, &values[NStars * 5 + i * 3]);
+    }
+    std::vector<std::byte> encoded(encodedNodeSize(StarEncoding::Quantized, NStars));
+    encodeQuantizedNode(
+        &values[0],
+        &values[NStars * 3],
+        &values[NStars * 5],
+        NStars,
+        encoded.data()
+    );
+    std::vector<float> decoded(values.size());
+
+    BENCHMARK("Copy 150k stars of 32-bit floats") {
+        std::memcpy(decoded.data(), values.data(), values.size() * sizeof(float));
+        return decoded[0];
+    };
+
+    BENCHMARK("Decode 150k quantized stars") {
+        decodeQuantizedNode(
+            encoded.data(),
+            encoded.size(),
+            NStars,
+            &decoded[0],
+            &decoded[NStars * 3],
+            &decoded[NStars * 5]
+        );
+        return decoded[0];
+    };
+
+    BENCHMARK("Encode 150k quantized stars") {
+        encodeQuantizedNode(
+            &values[0],
+            &values[NStars * 3],
+            &values[NStars * 5],
+            NStars,
+            encoded.data()
+        );
+        return encoded[0];
+    };
+}
@@ -0,0 +1,136 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/network/outboundmessagequeue.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace openspace;
+
+namespace {
+    using IsSupersedable = OutboundMessageQueue::IsSupersedable;
+
+    OutboundMessageQueue::Message message(const std::string& content) {
+        return std::make_shared<const std::vector<char>>(content.begin(), content.end());
+    }
+
+    // Sends everything in the queue in chunks of at most chunkSize bytes
+    std::string drain(OutboundMessageQueue& queue, size_t chunkSize) {
+        std::string res;
+        while (!queue.isEmpty()) {
+            const std::string_view front = queue.front();
+            const size_t n = std::min(chunkSize, front.size());
+            res += front.substr(0, n);
+            queue.pop(n);
+        }
+        return res;
+    }
+} // namespace
+
+TEST_CASE("OutboundMessageQueue: Order", "[outboundmessagequeue]") {
+    OutboundMessageQueue queue(1024);
+    REQUIRE(queue.isEmpty());
+    REQUIRE(queue.front().empty());
+
+    REQUIRE(queue.push(message("abc"), IsSupersedable::No));
+    REQUIRE(queue.push(message("defg"), IsSupersedable::No));
+    REQUIRE(queue.push(message("h"), IsSupersedable::No));
+    REQUIRE(queue.nBytes() == 8);
+
+    REQUIRE(drain(queue, 3) == "abcdefgh");
+    REQUIRE(queue.nBytes() == 0);
+}
+
+TEST_CASE("OutboundMessageQueue: Superseding", "[outboundmessagequeue]") {
+    OutboundMessageQueue queue(1024);
+
+    REQUIRE(queue.push(message("c1"), IsSupersedable::Yes));
+    REQUIRE(queue.push(message("s1"), IsSupersedable::No));
+    REQUIRE(queue.push(message("c2"), IsSupersedable::Yes));
+    REQUIRE(queue.push(message("s2"), IsSupersedable::No));
+    REQUIRE(queue.push(message("c3"), IsSupersedable::Yes));
+    REQUIRE(queue.nSuperseded() == 2);
+    REQUIRE(queue.nBytes() == 6);
+
+    // Messages that are not supersedable are all kept in order
+    REQUIRE(drain(queue, 64) == "s1s2c3");
+}
+
+TEST_CASE("OutboundMessageQueue: Partially Sent", "[outboundmessagequeue]") {
+    OutboundMessageQueue queue(1024);
+
+    REQUIRE(queue.push(message("camera1"), IsSupersedable::Yes));
+    queue.pop(3);
+    REQUIRE(queue.front() == "era1");
+
+    // A message that has been sent partially has to be completed to keep the stream
+    // intact
+    REQUIRE(queue.push(message("camera2"), IsSupersedable::Yes));
+    REQUIRE(queue.nSuperseded() == 0);
+    REQUIRE(queue.push(message("camera3"), IsSupersedable::Yes));
+    REQUIRE(queue.nSuperseded() == 1);
+    REQUIRE(queue.nBytes() == 4 + 7);
+
+    REQUIRE(drain(queue, 5) == "era1camera3");
+}
+
+TEST_CASE("OutboundMessageQueue: Limit", "[outboundmessagequeue]") {
+    OutboundMessageQueue queue(10);
+
+    // A message that is larger than the limit still fits into an empty queue
+    REQUIRE(queue.push(message("0123456789abc"), IsSupersedable::No));
+    REQUIRE_FALSE(queue.push(message("d"), IsSupersedable::No));
+    REQUIRE(drain(queue, 64) == "0123456789abc");
+
+    REQUIRE(queue.push(message("01234"), IsSupersedable::No));
+    REQUIRE(queue.push(message("56789"), IsSupersedable::Yes));
+    REQUIRE_FALSE(queue.push(message("a"), IsSupersedable::No));
+
+    // Superseding makes room for the newer message
+    REQUIRE(queue.push(message("ABCDE"), IsSupersedable::Yes));
+    REQUIRE(drain(queue, 64) == "01234ABCDE");
+}
+
+TEST_CASE("OutboundMessageQueue: Shared Messages", "[outboundmessagequeue]") {
+    OutboundMessageQueue a(1024);
+    OutboundMessageQueue b(1024);
+
+    const OutboundMessageQueue::Message m = message("shared");
+    REQUIRE(a.push(m, IsSupersedable::No));
+    REQUIRE(b.push(m, IsSupersedable::No));
+    REQUIRE(m.use_count() == 3);
+
+    a.pop(2);
+    REQUIRE(a.front() == "ared");
+    REQUIRE(b.front() == "shared");
+
+    a.pop(4);
+    REQUIRE(m.use_count() == 2);
+    REQUIRE(drain(b, 1) == "shared");
+    REQUIRE(m.use_count() == 1);
+}
@@ -0,0 +1,201 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/prioritythreadpool.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace {
+    using Pool = openspace::globebrowsing::PriorityThreadPool<uint64_t>;
+
+    // Keeps the single worker of a pool busy until release is called so that the tasks
+    // enqueued in the meantime queue up behind it
+    struct Blocker {
+        explicit Blocker(Pool& pool) : lock(mutex) {
+            pool.enqueue([this]() {
+                isBlocking = true;
+                std::lock_guard g(mutex);
+            }, 0, 1e9f);
+            while (!isBlocking) {
+                std::this_thread::yield();
+            }
+        }
+
+        void release() {
+            lock.unlock();
+        }
+
+        std::mutex mutex;
+        std::unique_lock<std::mutex> lock;
+        std::atomic_bool isBlocking = false;
+    };
+
+    struct Recorder {
+        std::function<void()> task(uint64_t key) {
+            return [this, key]() {
+                std::lock_guard g(mutex);
+                order.push_back(key);
+            };
+        }
+
+        std::vector<uint64_t> waitFor(size_t n) {
+            while (true) {
+                {
+                    std::lock_guard g(mutex);
+                    if (order.size() >= n) {
+                        return order;
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        std::mutex mutex;
+        std::vector<uint64_t> order;
+    };
+} // namespace
+
+TEST_CASE("PriorityThreadPool: Priority Order", "[prioritythreadpool]") {
+    Pool pool(1, 10);
+    Recorder recorder;
+    Blocker blocker(pool);
+
+    pool.enqueue(recorder.task(1), 1, 1.f);
+    pool.enqueue(recorder.task(2), 2, 3.f);
+    pool.enqueue(recorder.task(3), 3, 2.f);
+    blocker.release();
+
+    REQUIRE(recorder.waitFor(3) == std::vector<uint64_t>{ 2, 3, 1 });
+}
+
+TEST_CASE("PriorityThreadPool: Touch Updates Priority", "[prioritythreadpool]") {
+    Pool pool(1, 10);
+    Recorder recorder;
+    Blocker blocker(pool);
+
+    pool.enqueue(recorder.task(1), 1, 1.f);
+    pool.enqueue(recorder.task(2), 2, 2.f);
+    pool.enqueue(recorder.task(3), 3, 3.f);
+
+    // Within one frame, the highest requested priority wins
+    REQUIRE(pool.touch(1, 5.f));
+    REQUIRE(pool.touch(1, 0.5f));
+
+    // In a new frame, the priority is replaced
+    pool.beginFrame();
+    REQUIRE(pool.touch(3, 0.1f));
+    REQUIRE(pool.touch(1, 5.f));
+    REQUIRE(pool.touch(2, 2.f));
+    REQUIRE_FALSE(pool.touch(4, 1.f));
+    blocker.release();
+
+    REQUIRE(recorder.waitFor(3) == std::vector<uint64_t>{ 1, 2, 3 });
+}
+
+TEST_CASE("PriorityThreadPool: Stale Requests Are Cancelled", "[prioritythreadpool]") {
+    Pool pool(1, 10);
+    Recorder recorder;
+    Blocker blocker(pool);
+
+    pool.enqueue(recorder.task(1), 1, 1.f);
+    pool.enqueue(recorder.task(2), 2, 2.f);
+
+    // Only the first task is still requested after two frames
+    pool.beginFrame();
+    pool.touch(1, 1.f);
+    pool.beginFrame();
+    pool.touch(1, 1.f);
+    blocker.release();
+
+    REQUIRE(recorder.waitFor(1) == std::vector<uint64_t>{ 1 });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(recorder.waitFor(1).size() == 1);
+    REQUIRE(pool.getUnqueuedTasksKeys() == std::vector<uint64_t>{ 2 });
+}
+
+TEST_CASE("PriorityThreadPool: Full Queue Drops Lowest", "[prioritythreadpool]") {
+    Pool pool(1, 3);
+    Recorder recorder;
+    Blocker blocker(pool);
+
+    pool.enqueue(recorder.task(1), 1, 4.f);
+    pool.enqueue(recorder.task(2), 2, 1.f);
+    pool.enqueue(recorder.task(3), 3, 3.f);
+    pool.enqueue(recorder.task(4), 4, 2.f);
+    REQUIRE(pool.getUnqueuedTasksKeys() == std::vector<uint64_t>{ 2 });
+    blocker.release();
+
+    REQUIRE(recorder.waitFor(3) == std::vector<uint64_t>{ 1, 3, 4 });
+}
+
+TEST_CASE("PriorityThreadPool: Max Concurrency", "[prioritythreadpool]") {
+    std::atomic<int> running = 0;
+    std::atomic<int> maxRunning = 0;
+    std::atomic<int> finished = 0;
+    auto task = [&]() {
+        const int r = ++running;
+        int m = maxRunning;
+        while (r > m && !maxRunning.compare_exchange_weak(m, r)) {}
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        running--;
+        finished++;
+    };
+
+    Pool pool(4, 100);
+    pool.setMaxConcurrency(2);
+    for (uint64_t i = 0; i < 20; ++i) {
+        pool.enqueue(task, i, 1.f);
+    }
+    while (finished < 20) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(maxRunning == 2);
+
+    // Raising the concurrency above the initial one lets more tasks run at once
+    maxRunning = 0;
+    pool.setMaxConcurrency(6);
+    for (uint64_t i = 20; i < 60; ++i) {
+        pool.enqueue(task, i, 1.f);
+    }
+    while (finished < 60) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(maxRunning > 2);
+    REQUIRE(maxRunning <= 6);
+
+    // Lowering the concurrency again retires the surplus tasks
+    maxRunning = 0;
+    pool.setMaxConcurrency(1);
+    for (uint64_t i = 60; i < 80; ++i) {
+        pool.enqueue(task, i, 1.f);
+    }
+    while (finished < 80) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(maxRunning == 1);
+}
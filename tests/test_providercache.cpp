@@ -0,0 +1,303 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/providercache.h>
+#include <openspace/util/taskscheduler.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    using openspace::TaskScheduler;
+    using openspace::globebrowsing::cache::ProviderCache;
+
+    struct Provider {
+        explicit Provider(double t) : time(t), createdOn(std::this_thread::get_id()) {}
+
+        double time = 0.0;
+        std::thread::id createdOn;
+        bool isInitialized = false;
+    };
+
+    struct Counter {
+        ProviderCache<Provider>::Creator creator(double time) {
+            return [this, time]() {
+                nCreated++;
+                return std::make_unique<Provider>(time);
+            };
+        }
+
+        ProviderCache<Provider>::Initializer initializer() {
+            return [this](double, Provider& provider) {
+                CHECK(std::this_thread::get_id() == mainThread);
+                provider.isInitialized = true;
+                nInitialized++;
+            };
+        }
+
+        std::thread::id mainThread = std::this_thread::get_id();
+        std::atomic_int nCreated = 0;
+        int nInitialized = 0;
+    };
+
+    // Calls update until all prefetches have been added to the cache
+    void finishPrefetches(ProviderCache<Provider>& cache) {
+        using namespace std::chrono;
+        const auto start = steady_clock::now();
+        while (cache.numPendingPrefetches() > 0) {
+            REQUIRE(steady_clock::now() - start < seconds(10));
+            std::this_thread::sleep_for(milliseconds(1));
+            cache.update();
+        }
+    }
+} // namespace
+
+TEST_CASE("ProviderCache: Least Recently Used", "[providercache]") {
+    TaskScheduler scheduler(2);
+    Counter counter;
+    ProviderCache<Provider> cache(3, scheduler, counter.initializer());
+
+    for (int i = 0; i < 5; ++i) {
+        Provider* p = cache.provider(i, counter.creator(i));
+        REQUIRE(p);
+        CHECK(p->time == i);
+        CHECK(p->isInitialized);
+        cache.update();
+    }
+    CHECK(counter.nCreated == 5);
+    CHECK(counter.nInitialized == 5);
+    CHECK(cache.size() == 3);
+    CHECK_FALSE(cache.contains(0));
+    CHECK_FALSE(cache.contains(1));
+    CHECK(cache.contains(2));
+    CHECK(cache.contains(4));
+
+    // Using the oldest entry makes the next one the least recently used
+    cache.provider(2, counter.creator(2));
+    cache.update();
+    cache.provider(5, counter.creator(5));
+    cache.update();
+    CHECK(cache.contains(2));
+    CHECK_FALSE(cache.contains(3));
+    CHECK(counter.nCreated == 6);
+
+    const ProviderCache<Provider>::Statistics stats = cache.statistics();
+    CHECK(stats.nHits == 1);
+    CHECK(stats.nMisses == 6);
+    CHECK(stats.nEvicted == 3);
+    CHECK(stats.nPrefetched == 0);
+}
+
+TEST_CASE("ProviderCache: Providers In Use", "[providercache]") {
+    TaskScheduler scheduler(2);
+    Counter counter;
+    ProviderCache<Provider> cache(2, scheduler, counter.initializer());
+
+    // All providers that are requested in the same frame stay valid, even though there
+    // are more of them than fit into the cache
+    Provider* p0 = cache.provider(0.0, counter.creator(0.0));
+    Provider* p1 = cache.provider(1.0, counter.creator(1.0));
+    Provider* p2 = cache.provider(2.0, counter.creator(2.0));
+    Provider* p3 = cache.provider(3.0, counter.creator(3.0));
+    CHECK(cache.size() == 4);
+    cache.update();
+    CHECK(cache.size() == 4);
+    CHECK(p0->time == 0.0);
+    CHECK(p3->time == 3.0);
+
+    // The providers that are not requested in the next frame are evicted
+    CHECK(cache.provider(1.0, counter.creator(1.0)) == p1);
+    CHECK(cache.provider(2.0, counter.creator(2.0)) == p2);
+    cache.update();
+    CHECK(cache.size() == 2);
+    CHECK(cache.contains(1.0));
+    CHECK(cache.contains(2.0));
+
+    // Changing the maximum size takes effect in the next update
+    cache.setMaximumSize(1);
+    cache.provider(2.0, counter.creator(2.0));
+    CHECK(cache.size() == 2);
+    cache.update();
+    CHECK(cache.size() == 1);
+    CHECK(cache.contains(2.0));
+    CHECK(counter.nCreated == 4);
+}
+
+TEST_CASE("ProviderCache: Prefetch", "[providercache]") {
+    TaskScheduler scheduler(2);
+    Counter counter;
+    ProviderCache<Provider> cache(8, scheduler, counter.initializer());
+
+    cache.provider(0.0, counter.creator(0.0));
+    for (int i = 1; i <= 4; ++i) {
+        cache.prefetch(i, counter.creator(i));
+    }
+    // Prefetching a provider twice doesn't create it twice
+    cache.prefetch(1.0, counter.creator(1.0));
+    CHECK(cache.numPendingPrefetches() == 4);
+
+    finishPrefetches(cache);
+    CHECK(counter.nCreated == 5);
+    CHECK(counter.nInitialized == 5);
+    CHECK(cache.statistics().nPrefetched == 4);
+
+    for (int i = 1; i <= 4; ++i) {
+        REQUIRE(cache.contains(i));
+        Provider* p = cache.provider(i, counter.creator(i));
+        CHECK(p->isInitialized);
+        CHECK(p->createdOn != counter.mainThread);
+    }
+    CHECK(counter.nCreated == 5);
+    CHECK(cache.statistics().nHits == 4);
+
+    // Prefetching a cached provider only keeps it from being evicted
+    cache.update();
+    cache.prefetch(1.0, counter.creator(1.0));
+    CHECK(cache.numPendingPrefetches() == 0);
+}
+
+TEST_CASE("ProviderCache: Prefetch On IO Threads", "[providercache]") {
+    TaskScheduler scheduler(2);
+    Counter counter;
+    ProviderCache<Provider> cache(4, scheduler, counter.initializer());
+
+    // Creating a provider opens its datasets, which must never block a compute worker
+    std::atomic_int workerIndex = 0;
+    cache.prefetch(1.0, [&]() {
+        workerIndex = scheduler.currentWorkerIndex();
+        return counter.creator(1.0)();
+    });
+    finishPrefetches(cache);
+    CHECK(cache.contains(1.0));
+    CHECK(workerIndex == -1);
+}
+
+TEST_CASE("ProviderCache: Prefetch Budget", "[providercache]") {
+    TaskScheduler scheduler(2);
+    Counter counter;
+    ProviderCache<Provider> cache(4, scheduler, counter.initializer());
+
+    // With three providers in use, there is only room for one prefetch
+    cache.provider(0.0, counter.creator(0.0));
+    cache.provider(1.0, counter.creator(1.0));
+    cache.provider(2.0, counter.creator(2.0));
+    cache.prefetch(3.0, counter.creator(3.0));
+    cache.prefetch(4.0, counter.creator(4.0));
+    CHECK(cache.numPendingPrefetches() == 1);
+
+    // The providers in use are not evicted by the finished prefetch
+    finishPrefetches(cache);
+    CHECK(cache.contains(0.0));
+    CHECK(cache.contains(1.0));
+    CHECK(cache.contains(2.0));
+    CHECK(cache.contains(3.0));
+    CHECK_FALSE(cache.contains(4.0));
+}
+
+TEST_CASE("ProviderCache: Prefetch Failure", "[providercache]") {
+    TaskScheduler scheduler(2);
+    Counter counter;
+    ProviderCache<Provider> cache(4, scheduler, counter.initializer());
+
+    std::atomic_int nAttempts = 0;
+    auto failing = [&nAttempts]() -> std::unique_ptr<Provider> {
+        nAttempts++;
+        throw std::runtime_error("Missing file");
+    };
+    cache.prefetch(1.0, failing);
+    finishPrefetches(cache);
+    CHECK_FALSE(cache.contains(1.0));
+    CHECK(nAttempts == 1);
+
+    // A failed prefetch is not tried again
+    cache.prefetch(1.0, failing);
+    CHECK(cache.numPendingPrefetches() == 0);
+
+    // But requesting the provider still works and passes on the error
+    CHECK_THROWS_AS(cache.provider(1.0, failing), std::runtime_error);
+    CHECK(nAttempts == 2);
+    Provider* p = cache.provider(1.0, counter.creator(1.0));
+    REQUIRE(p);
+    CHECK(p->time == 1.0);
+}
+
+TEST_CASE("ProviderCache: Request During Prefetch", "[providercache]") {
+    TaskScheduler scheduler(2);
+    Counter counter;
+
+    std::atomic_bool hasStarted = false;
+    std::atomic_bool mayFinish = false;
+    auto slow = [&]() {
+        hasStarted = true;
+        while (!mayFinish) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return counter.creator(1.0)();
+    };
+
+    SECTION("Provider") {
+        ProviderCache<Provider> cache(4, scheduler, counter.initializer());
+        cache.prefetch(1.0, slow);
+        while (!hasStarted) {
+            std::this_thread::yield();
+        }
+
+        // The request waits for the running prefetch instead of creating the provider
+        std::thread release([&mayFinish]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            mayFinish = true;
+        });
+        Provider* p = cache.provider(1.0, counter.creator(1.0));
+        release.join();
+
+        REQUIRE(p);
+        CHECK(p->createdOn != counter.mainThread);
+        CHECK(counter.nCreated == 1);
+        CHECK(cache.numPendingPrefetches() == 0);
+    }
+
+    SECTION("Destruction") {
+        std::thread release;
+        {
+            ProviderCache<Provider> cache(4, scheduler, counter.initializer());
+            cache.prefetch(1.0, slow);
+            while (!hasStarted) {
+                std::this_thread::yield();
+            }
+            release = std::thread([&mayFinish]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                mayFinish = true;
+            });
+        }
+        // The cache has waited for the prefetch before it was destroyed
+        CHECK(mayFinish);
+        CHECK(counter.nCreated == 1);
+        CHECK(counter.nInitialized == 0);
+        release.join();
+    }
+}
@@ -0,0 +1,181 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/engine/globals.h>
+#include <openspace/scene/scene.h>
+#include <openspace/scene/scenegraphnode.h>
+#include <openspace/scene/sceneinitializer.h>
+#include <openspace/util/taskscheduler.h>
+#include <openspace/util/time.h>
+#include <openspace/util/updatestructures.h>
+#include <ghoul/fmt.h>
+#include <ghoul/misc/dictionary.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace {
+    ghoul::Dictionary nodeDictionary(const std::string& identifier,
+                                     const std::string& parent, int index)
+    {
+        ghoul::Dictionary translation;
+        translation.setValue("Type", std::string("StaticTranslation"));
+        translation.setValue(
+            "Position",
+            glm::dvec3(1.0 + index, 0.5 * index, -0.25 * index)
+        );
+
+        ghoul::Dictionary rotation;
+        rotation.setValue("Type", std::string("ConstantRotation"));
+        rotation.setValue("RotationAxis", glm::dvec3(0.0, 1.0 + 0.1 * index, 1.0));
+        rotation.setValue("RotationRate", 0.01 * (index % 17 + 1));
+
+        ghoul::Dictionary transform;
+        transform.setValue("Translation", translation);
+        transform.setValue("Rotation", rotation);
+
+        ghoul::Dictionary node;
+        node.setValue("Identifier", identifier);
+        node.setValue("Parent", parent);
+        node.setValue("Transform", transform);
+        return node;
+    }
+
+    // Creates nGroups nodes attached to the root, each with nChildren children. In
+    // addition, every group except the first one gets a node that depends on a child of
+    // the previous group, which pushes these nodes into their own update levels
+    void createScene(openspace::Scene& scene, int nGroups, int nChildren) {
+        using namespace openspace;
+
+        for (int i = 0; i < nGroups; ++i) {
+            const std::string group = fmt::format("Group{}", i);
+            SceneGraphNode* groupNode = scene.loadNode(
+                nodeDictionary(group, SceneGraphNode::RootNodeIdentifier, i)
+            );
+            REQUIRE(groupNode);
+            groupNode->initialize();
+
+            for (int j = 0; j < nChildren; ++j) {
+                const std::string child = fmt::format("{}_Child{}", group, j);
+                SceneGraphNode* childNode = scene.loadNode(
+                    nodeDictionary(child, group, i * nChildren + j)
+                );
+                REQUIRE(childNode);
+                childNode->initialize();
+            }
+
+            if (i > 0 && nChildren > 0) {
+                ghoul::Dictionary dependencies;
+                dependencies.setValue("1", fmt::format("Group{}_Child0", i - 1));
+
+                ghoul::Dictionary dict = nodeDictionary(
+                    fmt::format("{}_Dependent", group),
+                    fmt::format("{}_Child{}", group, nChildren - 1),
+                    i
+                );
+                dict.setValue(SceneGraphNode::KeyDependencies, dependencies);
+                SceneGraphNode* dependentNode = scene.loadNode(dict);
+                REQUIRE(dependentNode);
+                dependentNode->initialize();
+            }
+        }
+    }
+
+    void updateScene(openspace::Scene& scene, int frame) {
+        using namespace openspace;
+
+        scene.update({
+            TransformData{ glm::dvec3(0.0), glm::dmat3(1.0), glm::dvec3(1.0) },
+            Time(100.0 * (frame + 1)),
+            Time(100.0 * frame)
+        });
+    }
+} // namespace
+
+TEST_CASE("SceneUpdate: Parallel Update Matches Serial Update", "[sceneupdate]") {
+    using namespace openspace;
+
+    Scene serialScene(std::make_unique<SingleThreadedSceneInitializer>());
+    serialScene.property("ParallelUpdate")->set(false);
+    createScene(serialScene, 10, 150);
+
+    Scene parallelScene(std::make_unique<SingleThreadedSceneInitializer>());
+    parallelScene.property("ParallelUpdate")->set(true);
+    createScene(parallelScene, 10, 150);
+
+    REQUIRE(
+        serialScene.allSceneGraphNodes().size() ==
+        parallelScene.allSceneGraphNodes().size()
+    );
+
+    for (int frame = 0; frame < 10; ++frame) {
+        updateScene(serialScene, frame);
+        updateScene(parallelScene, frame);
+
+        for (SceneGraphNode* node : serialScene.allSceneGraphNodes()) {
+            const SceneGraphNode* other =
+                parallelScene.sceneGraphNode(node->identifier());
+            REQUIRE(other);
+            // The same operations are executed in the same order for each node, so the
+            // results have to be bit-identical
+            REQUIRE(node->modelTransform() == other->modelTransform());
+        }
+    }
+}
+
+TEST_CASE("SceneUpdate: Benchmark", "[.benchmark][sceneupdate]") {
+    using namespace openspace;
+
+    constexpr const int NumGroups = 100;
+    constexpr const int NumChildren = 99;
+    constexpr const int NumFrames = 200;
+
+    Scene scene(std::make_unique<SingleThreadedSceneInitializer>());
+    createScene(scene, NumGroups, NumChildren);
+
+    auto measureMs = [&scene](int firstFrame) {
+        auto begin = std::chrono::high_resolution_clock::now();
+        for (int frame = firstFrame; frame < firstFrame + NumFrames; ++frame) {
+            updateScene(scene, frame);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    };
+
+    // The first update recomputes everything regardless of the time, so it is excluded
+    updateScene(scene, 0);
+
+    scene.property("ParallelUpdate")->set(false);
+    const double serialMs = measureMs(1);
+
+    scene.property("ParallelUpdate")->set(true);
+    const double parallelMs = measureMs(1 + NumFrames);
+
+    std::cout << "Nodes: " << scene.allSceneGraphNodes().size() << ", Threads: "
+        << global::taskScheduler->numThreads() << '\n'
+        << "Serial:   " << serialMs / NumFrames << " ms/frame\n"
+        << "Parallel: " << parallelMs / NumFrames << " ms/frame\n";
+}
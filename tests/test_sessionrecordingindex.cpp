@@ -0,0 +1,281 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include "catch2/catch.hpp"
+
+#include <openspace/interaction/sessionrecording.h>
+#include <openspace/interaction/sessionrecordingindex.h>
+#include <openspace/network/messagestructures.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+    using openspace::interaction::SessionRecording;
+    using openspace::interaction::SessionRecordingIndex;
+    using Entry = SessionRecordingIndex::Entry;
+
+    std::filesystem::path emptyFolder(const std::string& name) {
+        const std::filesystem::path folder = absPath("${TESTDIR}/" + name);
+        std::filesystem::remove_all(folder);
+        std::filesystem::create_directories(folder);
+        return folder;
+    }
+
+    char keyframeType(size_t i) {
+        if (i % 7 == 3) {
+            return SessionRecording::HeaderTimeBinary;
+        }
+        else if (i % 5 == 1) {
+            return SessionRecording::HeaderScriptBinary;
+        }
+        else {
+            return SessionRecording::HeaderCameraBinary;
+        }
+    }
+
+    // Writes a recording with nKeyframes keyframes of mixed types and returns the index
+    // entries that describe it
+    std::vector<Entry> writeRecording(std::ofstream& file, size_t nKeyframes,
+                                      bool isBinary)
+    {
+        using namespace openspace::datamessagestructures;
+
+        file << SessionRecording::FileHeaderTitle << "01.00";
+        file << (isBinary ?
+            SessionRecording::DataFormatBinaryTag :
+            SessionRecording::DataFormatAsciiTag
+        );
+        file << '\n';
+
+        std::vector<Entry> entries;
+        uint32_t counts[3] = { 0, 0, 0 };
+        for (size_t i = 0; i < nKeyframes; ++i) {
+            if (!isBinary && i % 10 == 5) {
+                file << "# Comments are not part of the index\n";
+            }
+
+            Entry e;
+            e.timeOs = 100.0 + 0.5 * i;
+            e.timeRec = 0.5 * i;
+            e.timeSim = 1e8 + 2.0 * i;
+            e.offset = static_cast<uint64_t>(file.tellp());
+            e.type = keyframeType(i);
+
+            std::vector<char> payload;
+            std::stringstream line;
+            if (e.type == SessionRecording::HeaderCameraBinary) {
+                e.typeIndex = counts[0]++;
+                CameraKeyframe kf;
+                kf._position = glm::dvec3(static_cast<double>(i), 1.0, 2.0);
+                kf._focusNode = "Earth";
+                kf._scale = 1.f;
+                kf._timestamp = e.timeOs;
+                kf.serialize(payload);
+                line << SessionRecording::HeaderCameraAscii;
+                line << ' ' << e.timeOs << ' ' << e.timeRec << ' ' << e.timeSim << ' ';
+                kf.write(line);
+            }
+            else if (e.type == SessionRecording::HeaderTimeBinary) {
+                e.typeIndex = counts[1]++;
+                TimeKeyframe kf;
+                kf._dt = static_cast<double>(i);
+                kf.serialize(payload);
+                line << SessionRecording::HeaderTimeAscii;
+                line << ' ' << e.timeOs << ' ' << e.timeRec << ' ' << e.timeSim;
+                kf.write(line);
+            }
+            else {
+                e.typeIndex = counts[2]++;
+                ScriptMessage kf;
+                kf._script = "openspace.printInfo('" + std::to_string(i) + "')";
+                kf.serialize(payload);
+                line << SessionRecording::HeaderScriptAscii;
+                line << ' ' << e.timeOs << ' ' << e.timeRec << ' ' << e.timeSim;
+                kf.write(line);
+            }
+
+            if (isBinary) {
+                file.write(&e.type, sizeof(char));
+                file.write(reinterpret_cast<const char*>(&e.timeOs), sizeof(double));
+                file.write(reinterpret_cast<const char*>(&e.timeRec), sizeof(double));
+                file.write(reinterpret_cast<const char*>(&e.timeSim), sizeof(double));
+                file.write(payload.data(), payload.size());
+            }
+            else {
+                file << line.str() << '\n';
+            }
+            entries.push_back(e);
+        }
+        return entries;
+    }
+
+    bool isSameEntry(const Entry& lhs, const Entry& rhs) {
+        return lhs.timeOs == rhs.timeOs && lhs.timeRec == rhs.timeRec &&
+            lhs.timeSim == rhs.timeSim && lhs.offset == rhs.offset &&
+            lhs.typeIndex == rhs.typeIndex && lhs.type == rhs.type;
+    }
+
+    void checkIndex(SessionRecordingIndex& index, const std::vector<Entry>& entries) {
+        REQUIRE(index.size() == entries.size());
+        const size_t nCamera = std::count_if(
+            entries.begin(), entries.end(),
+            [](const Entry& e) { return e.type == SessionRecording::HeaderCameraBinary; }
+        );
+        const size_t nTime = std::count_if(
+            entries.begin(), entries.end(),
+            [](const Entry& e) { return e.type == SessionRecording::HeaderTimeBinary; }
+        );
+        CHECK(index.numEntries(SessionRecording::HeaderCameraBinary) == nCamera);
+        CHECK(index.numEntries(SessionRecording::HeaderTimeBinary) == nTime);
+        CHECK(
+            index.numEntries(SessionRecording::HeaderScriptBinary) ==
+            entries.size() - nCamera - nTime
+        );
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            CHECK(isSameEntry(index.entry(i), entries[i]));
+        }
+        const std::vector<Entry> bulk = index.entries(3, 10);
+        REQUIRE(bulk.size() == 10);
+        for (size_t i = 0; i < bulk.size(); ++i) {
+            CHECK(isSameEntry(bulk[i], entries[i + 3]));
+        }
+    }
+} // namespace
+
+TEST_CASE("SessionRecordingIndex: Save", "[sessionrecordingindex]") {
+    const std::filesystem::path folder = emptyFolder("sessionrecordingindex_save");
+    const std::filesystem::path path = folder / "recording.osrectxt";
+
+    std::vector<Entry> entries;
+    {
+        std::ofstream file(path);
+        entries = writeRecording(file, 300, false);
+    }
+    CHECK_FALSE(SessionRecordingIndex::load(path));
+
+    REQUIRE(SessionRecordingIndex::save(path, entries));
+    std::unique_ptr<SessionRecordingIndex> index = SessionRecordingIndex::load(path);
+    REQUIRE(index);
+    checkIndex(*index, entries);
+
+    // The index is kept in the cache and not next to the recording
+    const std::filesystem::path cached = SessionRecordingIndex::cachePath(path);
+    CHECK(std::filesystem::is_regular_file(cached));
+    CHECK(cached.parent_path() != folder);
+    const auto nFiles = std::distance(
+        std::filesystem::directory_iterator(folder),
+        std::filesystem::directory_iterator()
+    );
+    CHECK(nFiles == 1);
+
+    // The index is ignored once the recording has been changed
+    {
+        std::ofstream file(path, std::ios::app);
+        file << "# Appended\n";
+    }
+    CHECK_FALSE(SessionRecordingIndex::load(path));
+}
+
+TEST_CASE("SessionRecordingIndex: Build", "[sessionrecordingindex]") {
+    const std::filesystem::path folder = emptyFolder("sessionrecordingindex_build");
+
+    SECTION("Binary") {
+        const std::filesystem::path path = folder / "recording.osrec";
+        std::vector<Entry> entries;
+        {
+            std::ofstream file(path, std::ios::binary);
+            entries = writeRecording(file, 500, true);
+        }
+
+        REQUIRE(SessionRecordingIndex::build(path));
+        std::unique_ptr<SessionRecordingIndex> index = SessionRecordingIndex::load(path);
+        REQUIRE(index);
+        checkIndex(*index, entries);
+    }
+
+    SECTION("Ascii") {
+        const std::filesystem::path path = folder / "recording.osrectxt";
+        std::vector<Entry> entries;
+        {
+            std::ofstream file(path);
+            entries = writeRecording(file, 500, false);
+        }
+
+        REQUIRE(SessionRecordingIndex::build(path));
+        std::unique_ptr<SessionRecordingIndex> index = SessionRecordingIndex::load(path);
+        REQUIRE(index);
+        REQUIRE(index->size() == entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const Entry e = index->entry(i);
+            CHECK(e.offset == entries[i].offset);
+            CHECK(e.type == entries[i].type);
+            CHECK(e.typeIndex == entries[i].typeIndex);
+            CHECK(e.timeRec == Approx(entries[i].timeRec));
+        }
+    }
+
+    SECTION("Damaged") {
+        const std::filesystem::path path = folder / "damaged.osrec";
+        {
+            std::ofstream file(path, std::ios::binary);
+            writeRecording(file, 50, true);
+            file << "garbage";
+        }
+        CHECK_FALSE(SessionRecordingIndex::build(path));
+        CHECK_FALSE(SessionRecordingIndex::load(path));
+    }
+}
+
+TEST_CASE("SessionRecordingIndex: Lower Bound", "[sessionrecordingindex]") {
+    const std::filesystem::path path = emptyFolder("sessionrecordingindex_lowerbound") /
+        "recording.osrec";
+
+    std::vector<Entry> entries;
+    {
+        std::ofstream file(path, std::ios::binary);
+        entries = writeRecording(file, 2000, true);
+    }
+    REQUIRE(SessionRecordingIndex::save(path, entries));
+    std::unique_ptr<SessionRecordingIndex> index = SessionRecordingIndex::load(path);
+    REQUIRE(index);
+
+    for (double t = -1.0; t < 1001.0; t += 0.37) {
+        auto it = std::lower_bound(
+            entries.begin(),
+            entries.end(),
+            t,
+            [](const Entry& e, double time) { return e.timeRec < time; }
+        );
+        const size_t expected = std::distance(entries.begin(), it);
+        CHECK(index->lowerBound(t, &Entry::timeRec) == expected);
+    }
+    CHECK(index->lowerBound(1e8 + 20.0, &Entry::timeSim) == 10);
+    CHECK(index->lowerBound(1e9, &Entry::timeSim) == entries.size());
+}
@@ -0,0 +1,194 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/interaction/sessionrecording.h>
+#include <openspace/interaction/sessionrecordingindex.h>
+#include <openspace/interaction/sessionrecordingwriter.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+    using openspace::interaction::SessionRecording;
+    using openspace::interaction::SessionRecordingIndex;
+    using openspace::interaction::SessionRecordingWriter;
+    using Entry = SessionRecordingIndex::Entry;
+
+    std::filesystem::path emptyFolder(const std::string& name) {
+        const std::filesystem::path folder = absPath("${TESTDIR}/" + name);
+        std::filesystem::remove_all(folder);
+        std::filesystem::create_directories(folder);
+        return folder;
+    }
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()
+        );
+    }
+
+    struct Recording {
+        std::string prefix;
+        std::vector<Entry> prefixEntries;
+        // All keyframes that were accepted by the writer, in recording order
+        std::vector<Entry> entries;
+        std::vector<std::string> keyframes;
+        size_t nDropped = 0;
+    };
+
+    // Appends nKeyframes keyframes of mixed types and with varying sizes, which span
+    // many of the small blocks that are used by the writers in these tests
+    Recording record(SessionRecordingWriter& writer, size_t nKeyframes) {
+        Recording res;
+        res.prefix = SessionRecording::FileHeaderTitle + "01.00B\n";
+        for (int i = 0; i < 2; ++i) {
+            Entry e;
+            e.offset = res.prefix.size();
+            e.type = SessionRecording::HeaderScriptBinary;
+            res.prefixEntries.push_back(e);
+            res.prefix += "s baseline script " + std::to_string(i) + '\n';
+        }
+
+        for (size_t i = 0; i < nKeyframes; ++i) {
+            Entry e;
+            e.timeOs = 100.0 + 0.5 * i;
+            e.timeRec = 0.5 * i;
+            e.timeSim = 1e8 + 2.0 * i;
+            e.type = i % 3 == 0 ?
+                SessionRecording::HeaderScriptBinary :
+                SessionRecording::HeaderCameraBinary;
+            const std::string keyframe =
+                std::string(1, e.type) + std::string(i % 50, 'x') + std::to_string(i);
+
+            if (writer.append(e, keyframe)) {
+                res.entries.push_back(e);
+                res.keyframes.push_back(keyframe);
+            }
+            else {
+                res.nDropped++;
+            }
+        }
+        return res;
+    }
+
+    void checkRecording(const std::filesystem::path& path, const Recording& rec) {
+        std::string data = rec.prefix;
+        for (const std::string& keyframe : rec.keyframes) {
+            data += keyframe;
+        }
+        const std::string content = readFile(path);
+        CHECK(content == data);
+
+        std::unique_ptr<SessionRecordingIndex> index = SessionRecordingIndex::load(path);
+        REQUIRE(index);
+        REQUIRE(index->size() == rec.prefixEntries.size() + rec.entries.size());
+
+        uint32_t nScripts = 0;
+        uint32_t nCameras = 0;
+        for (size_t i = 0; i < index->size(); ++i) {
+            const Entry e = index->entry(i);
+            const bool isPrefix = i < rec.prefixEntries.size();
+            const Entry& expected = isPrefix ?
+                rec.prefixEntries[i] :
+                rec.entries[i - rec.prefixEntries.size()];
+            CHECK(e.type == expected.type);
+            CHECK(e.timeRec == expected.timeRec);
+            if (isPrefix) {
+                CHECK(e.offset == expected.offset);
+            }
+            else {
+                const std::string& keyframe = rec.keyframes[i - rec.prefixEntries.size()];
+                CHECK(content.substr(e.offset, keyframe.size()) == keyframe);
+            }
+
+            if (e.type == SessionRecording::HeaderScriptBinary) {
+                CHECK(e.typeIndex == nScripts++);
+            }
+            else {
+                CHECK(e.typeIndex == nCameras++);
+            }
+        }
+    }
+} // namespace
+
+TEST_CASE("SessionRecordingWriter: Write", "[sessionrecordingwriter]") {
+    const std::filesystem::path path = emptyFolder("recwriter-write") / "rec.osrec";
+    const std::filesystem::path spool =
+        path.string() + SessionRecordingWriter::SpoolExtension;
+
+    SessionRecordingWriter writer(path, 128, 3);
+    REQUIRE(writer.isOpen());
+    CHECK(std::filesystem::is_regular_file(spool));
+    CHECK_FALSE(std::filesystem::exists(path));
+
+    Recording rec = record(writer, 2000);
+    const bool success = writer.finish(rec.prefix, rec.prefixEntries);
+    REQUIRE(success);
+    CHECK_FALSE(std::filesystem::exists(spool));
+
+    const SessionRecordingWriter::Stats stats = writer.stats();
+    CHECK(stats.nKeyframes == rec.entries.size());
+    CHECK(stats.nDropped == rec.nDropped);
+    CHECK(stats.nBlocksWritten > 10);
+    checkRecording(path, rec);
+}
+
+TEST_CASE("SessionRecordingWriter: Index In Cache", "[sessionrecordingwriter]") {
+    const std::filesystem::path folder = emptyFolder("recwriter-index");
+    const std::filesystem::path path = folder / "rec.osrectxt";
+
+    SessionRecordingWriter writer(path, 256, 2);
+    REQUIRE(writer.isOpen());
+    Recording rec = record(writer, 1000);
+    REQUIRE(writer.finish(rec.prefix, rec.prefixEntries));
+    CHECK(std::filesystem::is_regular_file(SessionRecordingIndex::cachePath(path)));
+    checkRecording(path, rec);
+
+    // The recording is the only file that is left in the recordings folder
+    const auto nFiles = std::distance(
+        std::filesystem::directory_iterator(folder),
+        std::filesystem::directory_iterator()
+    );
+    CHECK(nFiles == 1);
+}
+
+TEST_CASE("SessionRecordingWriter: Discard", "[sessionrecordingwriter]") {
+    const std::filesystem::path path = emptyFolder("recwriter-discard") / "rec.osrec";
+    const std::filesystem::path spool =
+        path.string() + SessionRecordingWriter::SpoolExtension;
+    {
+        SessionRecordingWriter writer(path, 64, 2);
+        REQUIRE(writer.isOpen());
+        record(writer, 100);
+    }
+    CHECK_FALSE(std::filesystem::exists(path));
+    CHECK_FALSE(std::filesystem::exists(spool));
+}
@@ -0,0 +1,465 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/space/speckloader.h>
+#include <ghoul/fmt.h>
+#include <ghoul/glm.h>
+#include <ghoul/filesystem/cachemanager.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <fstream>
+
+namespace {
+    // Byte positions of section offsets in the header of a cache file
+    constexpr const uint64_t PositionsOffsetPosition = 56;
+    constexpr const uint64_t ColumnsOffsetPosition = 64;
+    constexpr const uint64_t CommentOffsetsOffsetPosition = 72;
+
+    constexpr const char* SpeckContent = R"(# A small test file
+datavar 0 colorb_v
+datavar 1 lum
+datavar 2 absmag
+texturevar 2
+texture -M 1 halo.sgi
+texture 2 point.sgi
+
+1.0 2.0 3.0 0.5 10.0 1.0 # Sirius
+-4.0 5.5 -6.25 0.75 20.0 2.0
+0 0 0 0 0 0
+7.0 8.0 9.0 1.25 40.0 3.0 # Vega
+)";
+
+    std::filesystem::path createSpeckFile(std::string_view name) {
+        std::filesystem::path path = absPath(fmt::format("${{TESTDIR}}/{}", name));
+        std::ofstream file(path);
+        file << SpeckContent;
+        return path;
+    }
+
+    uint64_t readValue(const std::filesystem::path& path, uint64_t position) {
+        std::ifstream file(path, std::ios::binary);
+        file.seekg(position);
+        uint64_t value = 0;
+        file.read(reinterpret_cast<char*>(&value), sizeof(uint64_t));
+        return value;
+    }
+
+    void writeValue(const std::filesystem::path& path, uint64_t position, uint64_t value)
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(position);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(uint64_t));
+    }
+
+    void checkEqual(const openspace::speck::ColumnarDataset& columns,
+                    const openspace::speck::Dataset& dataset)
+    {
+        using namespace openspace::speck;
+
+        REQUIRE(columns.nEntries() == dataset.entries.size());
+        REQUIRE(columns.variables.size() == dataset.variables.size());
+        for (size_t i = 0; i < dataset.variables.size(); i += 1) {
+            CHECK(columns.variables[i].index == dataset.variables[i].index);
+            CHECK(columns.variables[i].name == dataset.variables[i].name);
+        }
+        REQUIRE(columns.textures.size() == dataset.textures.size());
+        for (size_t i = 0; i < dataset.textures.size(); i += 1) {
+            CHECK(columns.textures[i].index == dataset.textures[i].index);
+            CHECK(columns.textures[i].file == dataset.textures[i].file);
+        }
+        CHECK(columns.textureDataIndex == dataset.textureDataIndex);
+        CHECK(columns.orientationDataIndex == dataset.orientationDataIndex);
+
+        for (size_t i = 0; i < dataset.entries.size(); i += 1) {
+            const Dataset::Entry& e = dataset.entries[i];
+            CHECK(columns.positions()[i] == e.position);
+            REQUIRE(columns.nValues() == e.data.size());
+            for (size_t j = 0; j < e.data.size(); j += 1) {
+                CHECK(columns.column(static_cast<int>(j))[i] == e.data[j]);
+            }
+            CHECK(columns.hasComment(i) == e.comment.has_value());
+            CHECK(columns.comment(i) == e.comment.value_or(""));
+        }
+    }
+} // namespace
+
+TEST_CASE("SpeckLoader: Parse Data Lines", "[speckloader]") {
+    using namespace openspace::speck;
+
+    const std::filesystem::path path = absPath("${TESTDIR}/datalines.speck");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "datavar 1 second\n"
+             << "datavar 0 first\n"
+             << "1 2 3 4 5 # A comment\n"
+             << "\t-1.5e2  +2 3.25 .5 -.5\r\n"
+             << "# Commented out line\n"
+             << "\n"
+             << "0 0 0 0 0 # All zero\n"
+             << "  6 7 8 9 10   #   Spaces   \n"
+             << "11 12 13 14 15 text without hash\n"
+             << "16 17 18 abc 19 # Not a number\n"
+             << "20 21 22 23";
+    }
+
+    SECTION("Skip all-zero lines") {
+        const Dataset dataset = data::loadFile(path);
+        REQUIRE(dataset.variables.size() == 2);
+        CHECK(dataset.variables[0].name == "first");
+        CHECK(dataset.variables[1].name == "second");
+
+        REQUIRE(dataset.entries.size() == 6);
+        CHECK(dataset.entries[0].position == glm::vec3(1.f, 2.f, 3.f));
+        CHECK(dataset.entries[0].data == std::vector<float>{ 4.f, 5.f });
+        CHECK(dataset.entries[0].comment == "A comment");
+
+        CHECK(dataset.entries[1].position == glm::vec3(-150.f, 2.f, 3.25f));
+        CHECK(dataset.entries[1].data == std::vector<float>{ 0.5f, -0.5f });
+        CHECK_FALSE(dataset.entries[1].comment.has_value());
+
+        CHECK(dataset.entries[2].position == glm::vec3(6.f, 7.f, 8.f));
+        CHECK(dataset.entries[2].comment == "Spaces");
+
+        CHECK(dataset.entries[3].comment == "text without hash");
+
+        // Values after the first value that is not a number are 0 and there is no
+        // comment, which is what extracting the values with a stream results in
+        CHECK(dataset.entries[4].position == glm::vec3(16.f, 17.f, 18.f));
+        CHECK(dataset.entries[4].data == std::vector<float>{ 0.f, 0.f });
+        CHECK_FALSE(dataset.entries[4].comment.has_value());
+
+        // Missing values at the end of the file are 0
+        CHECK(dataset.entries[5].position == glm::vec3(20.f, 21.f, 22.f));
+        CHECK(dataset.entries[5].data == std::vector<float>{ 23.f, 0.f });
+    }
+
+    SECTION("Keep all-zero lines") {
+        const Dataset dataset = data::loadFile(path, SkipAllZeroLines::No);
+        REQUIRE(dataset.entries.size() == 7);
+        CHECK(dataset.entries[2].position == glm::vec3(0.f));
+        CHECK(dataset.entries[2].comment == "All zero");
+    }
+}
+
+TEST_CASE("SpeckLoader: Intermixed Header", "[speckloader]") {
+    using namespace openspace::speck;
+
+    const std::filesystem::path path = absPath("${TESTDIR}/intermixed.speck");
+    {
+        std::ofstream file(path);
+        file << "datavar 0 value\n1 2 3 4\ndatavar 1 other\n5 6 7 8\n";
+    }
+    CHECK_THROWS(data::loadFile(path));
+}
+
+TEST_CASE("SpeckLoader: Parallel Parsing", "[speckloader]") {
+    using namespace openspace::speck;
+
+    // Large enough to be split into multiple chunks that are parsed concurrently
+    constexpr int NEntries = 400000;
+    const std::filesystem::path path = absPath("${TESTDIR}/parallel.speck");
+    {
+        std::ofstream file(path);
+        file << "datavar 0 index\ndatavar 1 half\n";
+        for (int i = 0; i < NEntries; i += 1) {
+            file << fmt::format("{} {} {} {} {}", i, -i, 0.25f * i, i % 5, 0.5f * i);
+            if (i % 7 == 0) {
+                file << fmt::format(" # Entry {}", i);
+            }
+            file << '\n';
+        }
+    }
+
+    const Dataset dataset = data::loadFile(path, SkipAllZeroLines::No);
+    REQUIRE(dataset.entries.size() == NEntries);
+    for (int i = 0; i < NEntries; i += 1) {
+        const Dataset::Entry& e = dataset.entries[i];
+        REQUIRE(e.position == glm::vec3(i, -i, 0.25f * i));
+        REQUIRE(e.data[0] == static_cast<float>(i % 5));
+        REQUIRE(e.data[1] == 0.5f * i);
+        if (i % 7 == 0) {
+            REQUIRE(e.comment == fmt::format("Entry {}", i));
+        }
+        else {
+            REQUIRE_FALSE(e.comment.has_value());
+        }
+    }
+
+    // The first line is all zero
+    CHECK(data::loadFile(path).entries.size() == NEntries - 1);
+}
+
+TEST_CASE("SpeckLoader: Parse Benchmark", "[.benchmark][speckloader]") {
+    using namespace openspace::speck;
+
+    constexpr int NEntries = 2000000;
+    const std::filesystem::path path = absPath("${TESTDIR}/benchmark.speck");
+    {
+        std::ofstream file(path);
+        file << "datavar 0 colorb_v\ndatavar 1 lum\ndatavar 2 absmag\n"
+             << "datavar 3 appmag\ndatavar 4 vx\ndatavar 5 vy\ndatavar 6 vz\n";
+        for (int i = 0; i < NEntries; i += 1) {
+            file << fmt::format(
+                "{} {} {} {} {} {} {} {} {} {} # HIP {}\n",
+                0.001f * i, -0.002f * i, 1.5f + i, 0.65f, 1.2e3f, 4.83f, 11.2f,
+                -12.5f, 3.25f, 0.125f, i
+            );
+        }
+    }
+
+    BENCHMARK("Parse 2M lines") {
+        return data::loadFile(path).entries.size();
+    };
+}
+
+TEST_CASE("SpeckLoader: Columnar Cache Roundtrip", "[speckloader]") {
+    using namespace openspace::speck;
+
+    const std::filesystem::path speck = createSpeckFile("columnar.speck");
+    const std::filesystem::path cache = absPath("${TESTDIR}/columnar.speck.cache");
+
+    const Dataset dataset = data::loadFile(speck);
+    REQUIRE(dataset.entries.size() == 3);
+    data::saveCachedFile(dataset, cache);
+
+    std::optional<ColumnarDataset> columns = data::loadColumnarCachedFile(cache);
+    REQUIRE(columns.has_value());
+    checkEqual(*columns, dataset);
+    CHECK(columns->index("lum") == 1);
+    CHECK(columns->column(3) == nullptr);
+    CHECK(columns->column(-1) == nullptr);
+
+    // The row-based cache loading has to go through the same file
+    std::optional<Dataset> rows = data::loadCachedFile(cache);
+    REQUIRE(rows.has_value());
+    checkEqual(*columns, *rows);
+}
+
+TEST_CASE("SpeckLoader: Columnar From Dataset", "[speckloader]") {
+    using namespace openspace::speck;
+
+    const std::filesystem::path speck = createSpeckFile("fromdataset.speck");
+    const Dataset dataset = data::loadFile(speck, SkipAllZeroLines::No);
+    REQUIRE(dataset.entries.size() == 4);
+
+    const ColumnarDataset columns = ColumnarDataset::fromDataset(dataset);
+    checkEqual(columns, dataset);
+    checkEqual(columns, columns.toDataset());
+}
+
+TEST_CASE("SpeckLoader: Columnar Cache Without Comments", "[speckloader]") {
+    using namespace openspace::speck;
+
+    Dataset dataset;
+    dataset.variables.push_back({ 0, "value" });
+    for (int i = 0; i < 100; i += 1) {
+        Dataset::Entry e;
+        e.position = glm::vec3(static_cast<float>(i), 1.f, 2.f);
+        e.data.push_back(static_cast<float>(i * i));
+        dataset.entries.push_back(e);
+    }
+
+    const std::filesystem::path cache = absPath("${TESTDIR}/nocomments.cache");
+    data::saveCachedFile(dataset, cache);
+
+    std::optional<ColumnarDataset> columns = data::loadColumnarCachedFile(cache);
+    REQUIRE(columns.has_value());
+    checkEqual(*columns, dataset);
+}
+
+TEST_CASE("SpeckLoader: Columnar Cache Empty Comments", "[speckloader]") {
+    using namespace openspace::speck;
+
+    // An empty comment has to stay a comment instead of turning into no comment
+    Dataset dataset;
+    for (int i = 0; i < 3; i += 1) {
+        Dataset::Entry e;
+        e.position = glm::vec3(static_cast<float>(i), 1.f, 2.f);
+        dataset.entries.push_back(e);
+    }
+    dataset.entries[0].comment = "";
+    dataset.entries[2].comment = "Vega";
+
+    const std::filesystem::path cache = absPath("${TESTDIR}/emptycomments.cache");
+    data::saveCachedFile(dataset, cache);
+
+    std::optional<ColumnarDataset> columns = data::loadColumnarCachedFile(cache);
+    REQUIRE(columns.has_value());
+    checkEqual(*columns, dataset);
+    const Dataset rows = columns->toDataset();
+    REQUIRE(rows.entries[0].comment.has_value());
+    CHECK(rows.entries[0].comment->empty());
+    CHECK_FALSE(rows.entries[1].comment.has_value());
+    CHECK(rows.entries[2].comment == "Vega");
+
+    // Only an empty comment is stored as well
+    dataset.entries[2].comment = std::nullopt;
+    data::saveCachedFile(dataset, cache);
+    columns = data::loadColumnarCachedFile(cache);
+    REQUIRE(columns.has_value());
+    checkEqual(*columns, dataset);
+}
+
+TEST_CASE("SpeckLoader: Columnar Cache Rejects Invalid Files", "[speckloader]") {
+    using namespace openspace::speck;
+
+    const std::filesystem::path speck = createSpeckFile("invalid.speck");
+    const std::filesystem::path cache = absPath("${TESTDIR}/invalid.speck.cache");
+    data::saveCachedFile(data::loadFile(speck), cache);
+    const uintmax_t size = std::filesystem::file_size(cache);
+
+    SECTION("Truncated") {
+        std::filesystem::resize_file(cache, size - 1);
+        CHECK_FALSE(data::loadColumnarCachedFile(cache).has_value());
+    }
+
+    SECTION("Wrong version") {
+        std::fstream file(cache, std::ios::binary | std::ios::in | std::ios::out);
+        const int8_t version = 10;
+        file.write(reinterpret_cast<const char*>(&version), sizeof(int8_t));
+        file.close();
+        CHECK_FALSE(data::loadColumnarCachedFile(cache).has_value());
+    }
+
+    SECTION("Missing") {
+        std::filesystem::remove(cache);
+        CHECK_FALSE(data::loadColumnarCachedFile(cache).has_value());
+    }
+
+    SECTION("Misaligned positions") {
+        const uint64_t offset = readValue(cache, PositionsOffsetPosition);
+        writeValue(cache, PositionsOffsetPosition, offset + 2);
+        CHECK_FALSE(data::loadColumnarCachedFile(cache).has_value());
+    }
+
+    SECTION("Misaligned columns") {
+        const uint64_t offset = readValue(cache, ColumnsOffsetPosition);
+        writeValue(cache, ColumnsOffsetPosition, offset + 2);
+        CHECK_FALSE(data::loadColumnarCachedFile(cache).has_value());
+    }
+
+    // The file contains the comments "Sirius" and "Vega" and the entry in between has
+    // none, so the comment offsets are 0, 6, 6, 10, followed by the flags 1, 0, 1
+    SECTION("Comments overlap columns") {
+        // Move the comment offsets and comments back into the column data
+        const uint64_t offset = readValue(cache, CommentOffsetsOffsetPosition) - 64;
+        const uint64_t commentsOffset = offset + 4 * sizeof(uint64_t) + 3;
+        writeValue(cache, CommentOffsetsOffsetPosition, offset);
+        writeValue(cache, CommentOffsetsOffsetPosition + 8, commentsOffset);
+        CHECK_FALSE(data::loadColumnarCachedFile(cache).has_value());
+    }
+
+    SECTION("Decreasing comment offsets") {
+        const uint64_t offsets = readValue(cache, CommentOffsetsOffsetPosition);
+        writeValue(cache, offsets + sizeof(uint64_t), 8);
+        CHECK_FALSE(data::loadColumnarCachedFile(cache).has_value());
+    }
+
+    SECTION("Characters for an entry without comment") {
+        // Give the entry without a comment the first character of "Vega"
+        const uint64_t offsets = readValue(cache, CommentOffsetsOffsetPosition);
+        writeValue(cache, offsets + 2 * sizeof(uint64_t), 7);
+        CHECK_FALSE(data::loadColumnarCachedFile(cache).has_value());
+    }
+
+    SECTION("Comment offsets not starting at 0") {
+        const uint64_t offsets = readValue(cache, CommentOffsetsOffsetPosition);
+        writeValue(cache, offsets, 2);
+        CHECK_FALSE(data::loadColumnarCachedFile(cache).has_value());
+    }
+}
+
+TEST_CASE("SpeckLoader: Columnar Cache Reparses Invalid Files", "[speckloader]") {
+    using namespace openspace::speck;
+
+    const std::filesystem::path speck = createSpeckFile("reparse.speck");
+    const Dataset dataset = data::loadFile(speck);
+    const std::filesystem::path cache = FileSys.cacheManager()->cachedFilename(speck);
+    data::saveCachedFile(dataset, cache);
+
+    // Make the second comment extend past the end of the file
+    const uint64_t offsets = readValue(cache, CommentOffsetsOffsetPosition);
+    writeValue(cache, offsets + 2 * sizeof(uint64_t), 100);
+    REQUIRE_FALSE(data::loadColumnarCachedFile(cache).has_value());
+
+    const ColumnarDataset columns = data::loadColumnarFileWithCache(speck);
+    checkEqual(columns, dataset);
+    CHECK(data::loadColumnarCachedFile(cache).has_value());
+}
+
+TEST_CASE("SpeckLoader: Columnar Normalize Keeps Cache", "[speckloader]") {
+    using namespace openspace::speck;
+
+    const std::filesystem::path speck = createSpeckFile("normalize.speck");
+    const std::filesystem::path cache = absPath("${TESTDIR}/normalize.speck.cache");
+    const Dataset dataset = data::loadFile(speck);
+    data::saveCachedFile(dataset, cache);
+
+    {
+        std::optional<ColumnarDataset> columns = data::loadColumnarCachedFile(cache);
+        REQUIRE(columns.has_value());
+        REQUIRE(columns->normalizeVariable("lum"));
+        const float* lum = columns->column(columns->index("lum"));
+        CHECK(lum[0] == 0.f);
+        CHECK(lum[1] == Approx(1.f / 3.f));
+        CHECK(lum[2] == 1.f);
+        CHECK_FALSE(columns->normalizeVariable("nonexisting"));
+    }
+
+    // The changes are only made in memory and the cache file still contains the values
+    // from the speck file
+    std::optional<ColumnarDataset> columns = data::loadColumnarCachedFile(cache);
+    REQUIRE(columns.has_value());
+    checkEqual(*columns, dataset);
+}
+
+TEST_CASE("SpeckLoader: Columnar Benchmark", "[.benchmark][speckloader]") {
+    using namespace openspace::speck;
+
+    constexpr int NEntries = 2000000;
+    constexpr int NValues = 8;
+
+    Dataset dataset;
+    for (int i = 0; i < NValues; i += 1) {
+        dataset.variables.push_back({ i, fmt::format("var{}", i) });
+    }
+    dataset.entries.resize(NEntries);
+    for (int i = 0; i < NEntries; i += 1) {
+        Dataset::Entry& e = dataset.entries[i];
+        e.position = glm::vec3(static_cast<float>(i), 0.5f, -0.5f);
+        e.data.resize(NValues, static_cast<float>(i));
+    }
+
+    const std::filesystem::path cache = absPath("${TESTDIR}/benchmark.cache");
+    data::saveCachedFile(dataset, cache);
+
+    BENCHMARK("Row cache") {
+        return data::loadCachedFile(cache)->entries.size();
+    };
+
+    BENCHMARK("Columnar cache") {
+        return data::loadColumnarCachedFile(cache)->nEntries();
+    };
+}
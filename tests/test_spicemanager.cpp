@@ -336,6 +336,39 @@ TEST_CASE("SpiceManager: Get Target Position", "[spicemanager]") {
     openspace::SpiceManager::deinitialize();
 }
 
+TEST_CASE("SpiceManager: Get Cached Target Position From Meta-Kernel", "[spicemanager]") {
+    openspace::SpiceManager::initialize();
+
+    using openspace::SpiceManager;
+    // The SPK kernels are only loaded indirectly through the meta-kernel, but their
+    // coverage has to be available to the ephemeris cache nevertheless
+    const int k = SpiceManager::ref().loadKernel(
+        absPath("${TESTDIR}/SpiceTest/spicekernels/cassini.tm").string()
+    );
+    REQUIRE(k == 1);
+
+    double et = 0.0;
+    double pos[3] = { 0.0, 0.0, 0.0 };
+    double lt = 0.0;
+    char utctime[SRCLEN] = "2004 jun 11 19:32:00";
+
+    str2et_c(utctime, &et);
+    spkpos_c("EARTH", et, "J2000", "NONE", "CASSINI", pos, &lt);
+
+    REQUIRE(SpiceManager::ref().hasSpkCoverage("EARTH", et));
+    REQUIRE(SpiceManager::ref().hasSpkCoverage("CASSINI", et));
+
+    glm::dvec3 targetPosition = glm::dvec3(0.0);
+    REQUIRE_NOTHROW(targetPosition = SpiceManager::ref().cachedTargetPosition(
+        "EARTH", "CASSINI", "J2000", et)
+    );
+    REQUIRE(pos[0] == Approx(targetPosition[0]));
+    REQUIRE(pos[1] == Approx(targetPosition[1]));
+    REQUIRE(pos[2] == Approx(targetPosition[2]));
+
+    openspace::SpiceManager::deinitialize();
+}
+
 TEST_CASE("SpiceManager: Get Target State", "[spicemanager]") {
     openspace::SpiceManager::initialize();
 
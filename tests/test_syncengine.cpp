@@ -0,0 +1,193 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/engine/syncengine.h>
+#include <openspace/util/syncbuffer.h>
+#include <openspace/util/syncdata.h>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace openspace;
+
+namespace {
+    // Mimics the ScriptEngine, which sends a list of messages that is emptied after
+    // every frame
+    class MessageSyncable : public Syncable {
+    public:
+        std::vector<std::string> outgoing;
+        std::vector<std::string> received;
+
+    protected:
+        bool isDirty() override {
+            return !outgoing.empty();
+        }
+
+        void encode(SyncBuffer* syncBuffer) override {
+            syncBuffer->encode(outgoing.size());
+            for (const std::string& s : outgoing) {
+                syncBuffer->encode(s);
+            }
+            outgoing.clear();
+        }
+
+        void decode(SyncBuffer* syncBuffer) override {
+            size_t n;
+            syncBuffer->decode(n);
+            for (size_t i = 0; i < n; ++i) {
+                received.push_back(syncBuffer->decode());
+            }
+        }
+    };
+
+    struct Node {
+        Node() : engine(64) {
+            engine.addSyncables({ &position, &rotation, &scale, &messages });
+        }
+
+        SyncEngine engine;
+        SyncData<glm::dvec3> position = glm::dvec3(0.0);
+        SyncData<glm::dquat> rotation = glm::dquat(1.0, 0.0, 0.0, 0.0);
+        SyncData<float> scale = 1.f;
+        MessageSyncable messages;
+    };
+
+    // Transfers a frame from the master to the slave the same way as SGCT does, that
+    // is, the slave receives a copy of the master's data
+    void synchronize(Node& master, Node& slave) {
+        master.engine.preSynchronization(SyncEngine::IsMaster::Yes);
+        slave.engine.preSynchronization(SyncEngine::IsMaster::No);
+
+        const SyncBuffer::View frame = master.engine.encodeSyncables();
+        const std::vector<std::byte> data(frame.data, frame.data + frame.size);
+        slave.engine.decodeSyncables({ data.data(), data.size() });
+
+        master.engine.postSynchronization(SyncEngine::IsMaster::Yes);
+        slave.engine.postSynchronization(SyncEngine::IsMaster::No);
+    }
+
+    template <typename T>
+    bool isBitIdentical(const SyncData<T>& lhs, const SyncData<T>& rhs) {
+        return std::memcmp(&lhs.data(), &rhs.data(), sizeof(T)) == 0;
+    }
+
+    void checkBitIdentical(const Node& master, const Node& slave) {
+        CHECK(isBitIdentical(master.position, slave.position));
+        CHECK(isBitIdentical(master.rotation, slave.rotation));
+        CHECK(isBitIdentical(master.scale, slave.scale));
+    }
+} // namespace
+
+TEST_CASE("SyncEngine: Bit-Identical Decoding", "[syncengine]") {
+    Node master;
+    Node slave;
+    slave.position = glm::dvec3(-1.0);
+    slave.scale = 42.f;
+
+    master.position = glm::dvec3(1.0 / 3.0, -2.5e12, 6.02214076e23);
+    master.rotation = glm::dquat(0.5, -0.5, 0.5, -0.5);
+    master.scale = 0.1f;
+    synchronize(master, slave);
+    checkBitIdentical(master, slave);
+
+    // Values that only differ in the last bit have to survive as well
+    master.position.data().x = std::nextafter(master.position.data().x, 1.0);
+    master.scale = std::nextafter(0.1f, 0.f);
+    synchronize(master, slave);
+    checkBitIdentical(master, slave);
+
+    // Values that were not sent in a frame keep the last synchronized value
+    synchronize(master, slave);
+    checkBitIdentical(master, slave);
+}
+
+TEST_CASE("SyncEngine: Skip Unchanged Syncables", "[syncengine]") {
+    Node master;
+    Node slave;
+
+    // In the first frame, all values are sent, except for the empty message list
+    synchronize(master, slave);
+    const size_t fullFrame = master.engine.statistics().nBytes;
+    CHECK(master.engine.statistics().nSkipped == 1);
+    CHECK(slave.engine.statistics().nSkipped == 1);
+    CHECK(slave.engine.statistics().nBytes == fullFrame);
+
+    // Without changes, only the number of Syncables and the bitmask are sent
+    synchronize(master, slave);
+    CHECK(master.engine.statistics().nSkipped == 4);
+    CHECK(master.engine.statistics().nBytes == sizeof(uint32_t) + 1);
+    CHECK(master.engine.statistics().nBytesMax == fullFrame);
+
+    master.scale = 2.f;
+    synchronize(master, slave);
+    CHECK(master.engine.statistics().nSkipped == 3);
+    CHECK(master.engine.statistics().nBytes == sizeof(uint32_t) + 1 + sizeof(float));
+    CHECK(slave.scale.data() == 2.f);
+    checkBitIdentical(master, slave);
+}
+
+TEST_CASE("SyncEngine: Messages", "[syncengine]") {
+    Node master;
+    Node slave;
+
+    // Identical messages in consecutive frames must not be mistaken for unchanged data
+    master.messages.outgoing = { "openspace.time.setPause(true)" };
+    synchronize(master, slave);
+    master.messages.outgoing = { "openspace.time.setPause(true)" };
+    synchronize(master, slave);
+    synchronize(master, slave);
+
+    const std::string longMessage(1000, 'x');
+    master.messages.outgoing = { "", longMessage };
+    synchronize(master, slave);
+
+    REQUIRE(slave.messages.received.size() == 4);
+    CHECK(slave.messages.received[0] == "openspace.time.setPause(true)");
+    CHECK(slave.messages.received[1] == "openspace.time.setPause(true)");
+    CHECK(slave.messages.received[2].empty());
+    CHECK(slave.messages.received[3] == longMessage);
+}
+
+TEST_CASE("SyncEngine: Buffer Reuse", "[syncengine]") {
+    SyncBuffer buffer(16);
+
+    const std::string message(100, 'y');
+    buffer.encode(message);
+    const SyncBuffer::View first = buffer.encodedData();
+    REQUIRE(first.size == sizeof(int32_t) + message.size());
+
+    // After growing once, the same memory is used for frames of the same size
+    buffer.reset();
+    buffer.encode(message);
+    const SyncBuffer::View second = buffer.encodedData();
+    CHECK(second.data == first.data);
+    CHECK(second.size == first.size);
+
+    buffer.reset();
+    buffer.setData(second);
+    CHECK(buffer.decode() == message);
+}
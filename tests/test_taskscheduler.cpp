@@ -0,0 +1,372 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <openspace/util/taskscheduler.h>
+#include <openspace/util/threadpool.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+namespace {
+    // The single mutex + condition variable pool that was used before the TaskScheduler
+    // was introduced. It is only kept around as a baseline for the benchmark
+    class MutexQueuePool {
+    public:
+        explicit MutexQueuePool(size_t nThreads) {
+            for (size_t i = 0; i < nThreads; ++i) {
+                _workers.emplace_back([this]() {
+                    while (true) {
+                        std::function<void()> task;
+                        {
+                            std::unique_lock lock(_mutex);
+                            _condition.wait(lock, [this]() {
+                                return _stop || !_tasks.empty();
+                            });
+                            if (_stop && _tasks.empty()) {
+                                return;
+                            }
+                            task = std::move(_tasks.front());
+                            _tasks.pop_front();
+                        }
+                        task();
+                    }
+                });
+            }
+        }
+
+        ~MutexQueuePool() {
+            {
+                std::lock_guard lock(_mutex);
+                _stop = true;
+            }
+            _condition.notify_all();
+            for (std::thread& t : _workers) {
+                t.join();
+            }
+        }
+
+        void enqueue(std::function<void()> f) {
+            {
+                std::lock_guard lock(_mutex);
+                _tasks.push_back(std::move(f));
+            }
+            _condition.notify_one();
+        }
+
+    private:
+        std::vector<std::thread> _workers;
+        std::deque<std::function<void()>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _stop = false;
+    };
+
+    int fibonacci(openspace::TaskScheduler& scheduler, int n) {
+        if (n < 12) {
+            return n < 2 ? n : fibonacci(scheduler, n - 1) + fibonacci(scheduler, n - 2);
+        }
+
+        int a = 0;
+        int b = 0;
+        openspace::TaskGroup group(scheduler);
+        group.run([&]() { a = fibonacci(scheduler, n - 1); });
+        b = fibonacci(scheduler, n - 2);
+        group.wait();
+        return a + b;
+    }
+
+    template <typename Func>
+    double measureMs(Func&& f) {
+        auto begin = std::chrono::high_resolution_clock::now();
+        f();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+} // namespace
+
+TEST_CASE("TaskScheduler: Enqueue", "[taskscheduler]") {
+    using namespace openspace;
+
+    std::atomic<int> counter = 0;
+    {
+        TaskScheduler scheduler(4);
+        REQUIRE(scheduler.numThreads() == 4);
+
+        TaskGroup group(scheduler);
+        for (int i = 0; i < 1000; ++i) {
+            group.run([&counter]() { counter++; });
+        }
+        group.wait();
+    }
+    REQUIRE(counter == 1000);
+}
+
+TEST_CASE("TaskScheduler: Fork/Join", "[taskscheduler]") {
+    using namespace openspace;
+
+    TaskScheduler scheduler(4);
+    REQUIRE(fibonacci(scheduler, 25) == 75025);
+}
+
+TEST_CASE("TaskScheduler: ParallelFor", "[taskscheduler]") {
+    using namespace openspace;
+
+    TaskScheduler scheduler(3);
+    std::vector<int> values(10000, 0);
+    scheduler.parallelFor(0, values.size(), 64, [&values](size_t i) {
+        values[i] = static_cast<int>(i);
+    });
+
+    std::vector<int> expected(10000);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(values == expected);
+}
+
+TEST_CASE("TaskScheduler: Priorities", "[taskscheduler]") {
+    using namespace openspace;
+
+    TaskScheduler scheduler(1);
+
+    // Block the only worker so that the following tasks are queued up behind it
+    std::mutex blockMutex;
+    std::unique_lock block(blockMutex);
+    std::atomic_bool isBlocked = false;
+    scheduler.enqueue([&]() {
+        isBlocked = true;
+        std::lock_guard lock(blockMutex);
+    });
+    while (!isBlocked) {
+        std::this_thread::yield();
+    }
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+    auto record = [&](int v) {
+        return [&, v]() {
+            std::lock_guard lock(orderMutex);
+            order.push_back(v);
+        };
+    };
+    scheduler.enqueue(record(2), TaskScheduler::Priority::Low);
+    scheduler.enqueue(record(1), TaskScheduler::Priority::Normal);
+    scheduler.enqueue(record(0), TaskScheduler::Priority::High);
+    block.unlock();
+
+    while (scheduler.numPendingTasks() > 0) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::lock_guard lock(orderMutex);
+    REQUIRE(order == std::vector<int>{ 0, 1, 2 });
+}
+
+TEST_CASE("TaskScheduler: Helping Skips Low Priority", "[taskscheduler]") {
+    using namespace openspace;
+
+    TaskScheduler scheduler(1);
+
+    std::mutex blockMutex;
+    std::unique_lock block(blockMutex);
+    std::atomic_bool isBlocked = false;
+    scheduler.enqueue([&]() {
+        isBlocked = true;
+        std::lock_guard lock(blockMutex);
+    });
+    while (!isBlocked) {
+        std::this_thread::yield();
+    }
+
+    std::atomic<int> nLow = 0;
+    std::atomic<int> nNormal = 0;
+    scheduler.enqueue([&nLow]() { nLow++; }, TaskScheduler::Priority::Low);
+
+    // A thread that is not a worker must never pick up a low priority task
+    REQUIRE_FALSE(scheduler.runPendingTask(TaskScheduler::Priority::Low));
+    REQUIRE(nLow == 0);
+
+    scheduler.enqueue([&nNormal]() { nNormal++; }, TaskScheduler::Priority::Normal);
+    REQUIRE_FALSE(scheduler.runPendingTask(TaskScheduler::Priority::High));
+    REQUIRE(scheduler.runPendingTask(TaskScheduler::Priority::Normal));
+    REQUIRE(nNormal == 1);
+
+    block.unlock();
+    while (scheduler.numPendingTasks() > 0 || nLow == 0) {
+        std::this_thread::yield();
+    }
+    REQUIRE(nLow == 1);
+}
+
+TEST_CASE("TaskScheduler: IO Lane", "[taskscheduler]") {
+    using namespace openspace;
+
+    TaskScheduler scheduler(1, 1);
+    REQUIRE(scheduler.numIoThreads() == 1);
+
+    // Block the only IO thread, the compute worker has to keep going regardless
+    std::mutex blockMutex;
+    std::unique_lock block(blockMutex);
+    std::atomic_bool isBlocked = false;
+    std::atomic_bool ranOnWorker = false;
+    scheduler.enqueue(
+        [&]() {
+            ranOnWorker = scheduler.currentWorkerIndex() != -1;
+            isBlocked = true;
+            std::lock_guard lock(blockMutex);
+        },
+        TaskScheduler::Priority::IO
+    );
+    while (!isBlocked) {
+        std::this_thread::yield();
+    }
+
+    std::atomic<int> nIo = 0;
+    scheduler.enqueue([&nIo]() { nIo++; }, TaskScheduler::Priority::IO);
+    REQUIRE(scheduler.numPendingTasks() == 1);
+
+    // Neither helping threads nor the workers ever pick up an IO task
+    REQUIRE_FALSE(scheduler.runPendingTask(TaskScheduler::Priority::IO));
+    std::vector<int> values(1000, 0);
+    scheduler.parallelFor(0, values.size(), 16, [&values](size_t i) { values[i] = 1; });
+    REQUIRE(std::accumulate(values.begin(), values.end(), 0) == 1000);
+    REQUIRE(nIo == 0);
+
+    block.unlock();
+    while (scheduler.numPendingTasks() > 0 || nIo == 0) {
+        std::this_thread::yield();
+    }
+    REQUIRE(nIo == 1);
+    REQUIRE_FALSE(ranOnWorker);
+}
+
+TEST_CASE("TaskScheduler: TaskGroup Exception", "[taskscheduler]") {
+    using namespace openspace;
+
+    TaskScheduler scheduler(2);
+    TaskGroup group(scheduler);
+    group.run([]() { throw std::runtime_error("error"); });
+    REQUIRE_THROWS_AS(group.wait(), std::runtime_error);
+}
+
+TEST_CASE("TaskScheduler: ThreadPool Limits Concurrency", "[taskscheduler]") {
+    using namespace openspace;
+
+    std::atomic<int> running = 0;
+    std::atomic<int> maxRunning = 0;
+    std::atomic<int> finished = 0;
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 20; ++i) {
+            pool.enqueue([&]() {
+                const int r = ++running;
+                int m = maxRunning;
+                while (r > m && !maxRunning.compare_exchange_weak(m, r)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                running--;
+                finished++;
+            });
+        }
+        while (finished < 20) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    REQUIRE(maxRunning <= 2);
+    REQUIRE(finished == 20);
+}
+
+TEST_CASE("TaskScheduler: Benchmark", "[.benchmark][taskscheduler]") {
+    using namespace openspace;
+
+    constexpr const int NumTasks = 200000;
+    const unsigned int nThreads = std::max(std::thread::hardware_concurrency(), 2u);
+
+    std::atomic<int> counter = 0;
+    const double baselineMs = measureMs([&]() {
+        MutexQueuePool pool(nThreads);
+        for (int i = 0; i < NumTasks; ++i) {
+            pool.enqueue([&counter]() { counter++; });
+        }
+        while (counter < NumTasks) {
+            std::this_thread::yield();
+        }
+    });
+    REQUIRE(counter == NumTasks);
+
+    counter = 0;
+    TaskScheduler scheduler(nThreads);
+    const double schedulerMs = measureMs([&]() {
+        TaskGroup group(scheduler);
+        for (int i = 0; i < NumTasks; ++i) {
+            group.run([&counter]() { counter++; });
+        }
+        group.wait();
+    });
+    REQUIRE(counter == NumTasks);
+
+    // Tasks that spawn their own subtasks are where work stealing pays off
+    counter = 0;
+    const double baselineNestedMs = measureMs([&]() {
+        MutexQueuePool pool(nThreads);
+        for (int i = 0; i < NumTasks / 100; ++i) {
+            pool.enqueue([&pool, &counter]() {
+                for (int j = 0; j < 100; ++j) {
+                    pool.enqueue([&counter]() { counter++; });
+                }
+            });
+        }
+        while (counter < NumTasks) {
+            std::this_thread::yield();
+        }
+    });
+
+    counter = 0;
+    const double schedulerNestedMs = measureMs([&]() {
+        TaskGroup group(scheduler);
+        for (int i = 0; i < NumTasks / 100; ++i) {
+            group.run([&scheduler, &counter]() {
+                TaskGroup inner(scheduler);
+                for (int j = 0; j < 100; ++j) {
+                    inner.run([&counter]() { counter++; });
+                }
+                inner.wait();
+            });
+        }
+        group.wait();
+    });
+    REQUIRE(counter == NumTasks);
+
+    std::cout << "Threads: " << nThreads << '\n'
+        << "Flat (" << NumTasks << " tasks):   MutexQueuePool " << baselineMs
+        << " ms, TaskScheduler " << schedulerMs << " ms\n"
+        << "Nested (" << NumTasks << " tasks): MutexQueuePool " << baselineNestedMs
+        << " ms, TaskScheduler " << schedulerNestedMs << " ms ("
+        << scheduler.numStolenTasks() << " stolen)\n";
+}
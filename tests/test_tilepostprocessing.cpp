@@ -0,0 +1,345 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2022                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "catch2/catch.hpp"
+
+#include <modules/globebrowsing/src/tilepostprocessing.h>
+#include <ghoul/fmt.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+    using namespace openspace::globebrowsing;
+    using namespace openspace::globebrowsing::postprocessing;
+
+    constexpr const float NoDataValue = -32768.f;
+
+    /**
+     * The per-sample implementation that RawTileDataReader::tileMetaData used before the
+     * kernels. The lines are visited bottom to top and only float samples are replaced,
+     * as the original wrote a float over other types.
+     */
+    template <typename T>
+    SampleStatistics reference(T* data, size_t width, size_t height, int nRasters,
+                               float noDataValue)
+    {
+        SampleStatistics res;
+        TileMetaData& m = res.metaData;
+        m.nValues = static_cast<uint8_t>(nRasters);
+        std::fill(m.maxValues.begin(), m.maxValues.end(), -FLT_MAX);
+        std::fill(m.minValues.begin(), m.minValues.end(), FLT_MAX);
+        std::fill(m.hasMissingData.begin(), m.hasMissingData.end(), false);
+
+        const size_t samplesPerLine = width * nRasters;
+        for (size_t y = 0; y < height; ++y) {
+            const size_t yi = (height - 1 - y) * samplesPerLine;
+            size_t i = 0;
+            for (size_t x = 0; x < width; ++x) {
+                for (int raster = 0; raster < nRasters; ++raster) {
+                    const float val = static_cast<float>(data[yi + i]);
+                    if (val != noDataValue && val == val) {
+                        m.maxValues[raster] = std::max(val, m.maxValues[raster]);
+                        m.minValues[raster] = std::min(val, m.minValues[raster]);
+                        res.hasValidData = true;
+                    }
+                    else {
+                        m.hasMissingData[raster] = true;
+                        if constexpr (std::is_floating_point_v<T>) {
+                            data[yi + i] = std::numeric_limits<T>::lowest();
+                        }
+                    }
+                    i++;
+                }
+            }
+        }
+        return res;
+    }
+
+    template <typename T>
+    std::vector<T> randomSamples(size_t n, bool withMissingData, unsigned int seed) {
+        std::mt19937 engine(seed);
+        std::uniform_int_distribution<int> special(0, 15);
+        std::uniform_real_distribution<double> real(-1000.0, 1000.0);
+
+        std::vector<T> res(n);
+        for (size_t i = 0; i < n; ++i) {
+            if constexpr (std::is_floating_point_v<T>) {
+                const int s = special(engine);
+                if (withMissingData && s == 0) {
+                    res[i] = static_cast<T>(NoDataValue);
+                }
+                else if (withMissingData && s == 1) {
+                    res[i] = std::numeric_limits<T>::quiet_NaN();
+                }
+                else if (s == 2) {
+                    res[i] = static_cast<T>(0.0);
+                }
+                else if (s == 3) {
+                    res[i] = static_cast<T>(-0.0);
+                }
+                else {
+                    res[i] = static_cast<T>(real(engine));
+                }
+            }
+            else {
+                std::uniform_int_distribution<int64_t> dist(
+                    std::numeric_limits<T>::min(),
+                    std::numeric_limits<T>::max()
+                );
+                res[i] = static_cast<T>(dist(engine));
+                if (!withMissingData && static_cast<float>(res[i]) == NoDataValue) {
+                    res[i] = 0;
+                }
+                if constexpr (std::is_signed_v<T>) {
+                    if (withMissingData && special(engine) == 0) {
+                        res[i] = static_cast<T>(NoDataValue);
+                    }
+                }
+            }
+        }
+        return res;
+    }
+
+    bool isBitIdentical(const TileMetaData& lhs, const TileMetaData& rhs) {
+        const size_t n = lhs.nValues;
+        return lhs.nValues == rhs.nValues &&
+            std::memcmp(lhs.maxValues.data(), rhs.maxValues.data(), n * 4) == 0 &&
+            std::memcmp(lhs.minValues.data(), rhs.minValues.data(), n * 4) == 0 &&
+            std::equal(
+                lhs.hasMissingData.begin(), lhs.hasMissingData.begin() + n,
+                rhs.hasMissingData.begin()
+            );
+    }
+
+    template <typename T>
+    void checkAgainstReference(bool withMissingData) {
+        // The odd size leaves remainders after the vectorized blocks
+        const std::vector<std::pair<size_t, size_t>> sizes = {
+            { 1, 1 }, { 7, 3 }, { 61, 61 }, { 64, 64 }
+        };
+        unsigned int seed = 1;
+        for (const std::pair<size_t, size_t>& size : sizes) {
+            for (int nRasters = 1; nRasters <= 4; ++nRasters) {
+                const size_t nPixels = size.first * size.second;
+                const std::vector<T> samples =
+                    randomSamples<T>(nPixels * nRasters, withMissingData, seed++);
+
+                std::vector<T> expected = samples;
+                const SampleStatistics ref = reference(
+                    expected.data(),
+                    size.first,
+                    size.second,
+                    nRasters,
+                    NoDataValue
+                );
+
+                for (ForceScalar scalar : { ForceScalar::No, ForceScalar::Yes }) {
+                    INFO(fmt::format(
+                        "{}x{} pixels, {} rasters, scalar {}",
+                        size.first, size.second, nRasters, static_cast<bool>(scalar)
+                    ));
+                    std::vector<T> data = samples;
+                    const SampleStatistics res = processSamples(
+                        data.data(),
+                        nPixels,
+                        size.first,
+                        nRasters,
+                        NoDataValue,
+                        scalar
+                    );
+                    CHECK(isBitIdentical(res.metaData, ref.metaData));
+                    CHECK(res.hasValidData == ref.hasValidData);
+                    const size_t nBytes = data.size() * sizeof(T);
+                    CHECK(std::memcmp(data.data(), expected.data(), nBytes) == 0);
+                }
+            }
+        }
+    }
+} // namespace
+
+TEST_CASE("TilePostProcessing: Float", "[tilepostprocessing]") {
+    checkAgainstReference<float>(false);
+    checkAgainstReference<float>(true);
+}
+
+TEST_CASE("TilePostProcessing: Double", "[tilepostprocessing]") {
+    checkAgainstReference<double>(false);
+    checkAgainstReference<double>(true);
+}
+
+TEST_CASE("TilePostProcessing: Integers", "[tilepostprocessing]") {
+    checkAgainstReference<uint8_t>(false);
+    checkAgainstReference<uint16_t>(false);
+    checkAgainstReference<int16_t>(false);
+    checkAgainstReference<int16_t>(true);
+    checkAgainstReference<uint32_t>(false);
+    checkAgainstReference<int32_t>(false);
+    checkAgainstReference<int32_t>(true);
+}
+
+TEST_CASE("TilePostProcessing: Unsigned Integer Rounding", "[tilepostprocessing]") {
+    // Values above 2^24 are rounded when they are converted to float
+    std::vector<uint32_t> samples = {
+        16777217, 16777219, 4294967295, 4294967041, 2147483649, 33554435, 1, 0
+    };
+    const SampleStatistics res = processSamples(
+        samples.data(),
+        samples.size(),
+        samples.size(),
+        1,
+        NoDataValue
+    );
+    CHECK(res.metaData.maxValues[0] == static_cast<float>(4294967295u));
+    CHECK(res.metaData.minValues[0] == 0.f);
+
+    const SampleStatistics ref = reference(samples.data(), 8, 1, 1, NoDataValue);
+    CHECK(isBitIdentical(res.metaData, ref.metaData));
+}
+
+TEST_CASE("TilePostProcessing: Sign Of Zero", "[tilepostprocessing]") {
+    // The historical order visits the last line first, so the zero that decides the sign
+    // is the rightmost one in the first line and not the last one in memory
+    std::vector<float> samples = {
+        -0.f, -0.f, 0.f, -5.f,
+        -0.f, -0.f, -0.f, -0.f
+    };
+    std::vector<float> copy = samples;
+    const SampleStatistics ref = reference(copy.data(), 4, 2, 1, NoDataValue);
+    const SampleStatistics res = processSamples(samples.data(), 8, 4, 1, NoDataValue);
+    REQUIRE(ref.metaData.maxValues[0] == 0.f);
+    CHECK_FALSE(std::signbit(ref.metaData.maxValues[0]));
+    CHECK(isBitIdentical(res.metaData, ref.metaData));
+}
+
+TEST_CASE("TilePostProcessing: All Missing", "[tilepostprocessing]") {
+    std::vector<float> samples(64 * 64 * 2, NoDataValue);
+    samples[5] = std::numeric_limits<float>::quiet_NaN();
+    const SampleStatistics res = processSamples(
+        samples.data(),
+        64 * 64,
+        64,
+        2,
+        NoDataValue
+    );
+    CHECK_FALSE(res.hasValidData);
+    CHECK(res.metaData.hasMissingData[0]);
+    CHECK(res.metaData.hasMissingData[1]);
+    CHECK(res.metaData.maxValues[0] == -FLT_MAX);
+    CHECK(res.metaData.minValues[1] == FLT_MAX);
+    CHECK(std::all_of(
+        samples.begin(), samples.end(),
+        [](float v) { return v == -FLT_MAX; }
+    ));
+}
+
+TEST_CASE("TilePostProcessing: Replicate First Sample", "[tilepostprocessing]") {
+    auto check = [](size_t bytesPerDatum, size_t bytesPerPixel, int nCopies) {
+        INFO(fmt::format("{} {} {}", bytesPerDatum, bytesPerPixel, nCopies));
+        const size_t nPixels = 37;
+        std::vector<std::byte> data(nPixels * bytesPerPixel);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<std::byte>(i * 13 + 7);
+        }
+
+        std::vector<std::byte> expected = data;
+        for (size_t p = 0; p < nPixels; ++p) {
+            for (int c = 1; c <= nCopies; ++c) {
+                std::memcpy(
+                    &expected[p * bytesPerPixel + c * bytesPerDatum],
+                    &expected[p * bytesPerPixel],
+                    bytesPerDatum
+                );
+            }
+        }
+
+        for (ForceScalar scalar : { ForceScalar::No, ForceScalar::Yes }) {
+            std::vector<std::byte> res = data;
+            replicateFirstSample(
+                res.data(),
+                nPixels,
+                bytesPerDatum,
+                bytesPerPixel,
+                nCopies,
+                scalar
+            );
+            CHECK(res == expected);
+        }
+    };
+
+    check(1, 4, 1);
+    check(1, 4, 2);
+    check(1, 4, 3);
+    check(1, 3, 2);
+    check(2, 8, 2);
+    check(4, 16, 2);
+    check(4, 12, 2);
+    check(8, 32, 3);
+}
+
+TEST_CASE("TilePostProcessing: Benchmark", "[.benchmark][tilepostprocessing]") {
+    for (size_t size : { 256, 512, 1024 }) {
+        const size_t nPixels = size * size;
+        const std::vector<float> heights = randomSamples<float>(nPixels, true, 7);
+        const std::vector<uint8_t> colors = randomSamples<uint8_t>(nPixels * 4, false, 8);
+
+        BENCHMARK(fmt::format("Height tile {0}x{0}, per sample", size)) {
+            std::vector<float> data = heights;
+            return reference(data.data(), size, size, 1, NoDataValue);
+        };
+        BENCHMARK(fmt::format("Height tile {0}x{0}, scalar", size)) {
+            std::vector<float> data = heights;
+            return processSamples(
+                data.data(), nPixels, size, 1, NoDataValue, ForceScalar::Yes
+            );
+        };
+        BENCHMARK(fmt::format("Height tile {0}x{0}, vectorized", size)) {
+            std::vector<float> data = heights;
+            return processSamples(data.data(), nPixels, size, 1, NoDataValue);
+        };
+
+        BENCHMARK(fmt::format("Color tile {0}x{0}, per sample", size)) {
+            std::vector<uint8_t> data = colors;
+            return reference(data.data(), size, size, 4, NoDataValue);
+        };
+        BENCHMARK(fmt::format("Color tile {0}x{0}, vectorized", size)) {
+            std::vector<uint8_t> data = colors;
+            return processSamples(data.data(), nPixels, size, 4, NoDataValue);
+        };
+
+        std::vector<std::byte> gray(nPixels * 4);
+        BENCHMARK(fmt::format("Grayscale tile {0}x{0}, scalar copies", size)) {
+            replicateFirstSample(gray.data(), nPixels, 1, 4, 2, ForceScalar::Yes);
+            return gray[0];
+        };
+        BENCHMARK(fmt::format("Grayscale tile {0}x{0}, vectorized copies", size)) {
+            replicateFirstSample(gray.data(), nPixels, 1, 4, 2);
+            return gray[0];
+        };
+    }
+}